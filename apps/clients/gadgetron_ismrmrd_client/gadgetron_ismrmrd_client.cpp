@@ -38,8 +38,12 @@
 #include <thread>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
 
 #include "NHLBICompression.h"
+#include "MetaBinaryCodec.h"
 
 #if defined GADGETRON_COMPRESSION_ZFP
 #include "zfp/zfp.h"
@@ -75,6 +79,46 @@ struct NoiseStatistics
     float noise_dwell_time_us;
 };
 
+/**
+Compression of the acquisition data, the same for the serial and the pipelined sending.
+Precision takes priority over tolerance; with neither, the data is sent uncompressed.
+*/
+struct AcquisitionCompression
+{
+    AcquisitionCompression()
+        : precision(0)
+        , tolerance(0.0f)
+        , use_zfp(false)
+        , noise_stats()
+    {
+    }
+
+    unsigned int precision;     ///< bits
+    float tolerance;            ///< fraction of sigma
+    bool use_zfp;
+    NoiseStatistics noise_stats;
+};
+
+/**
+An acquisition message ready to be written to the socket
+*/
+struct EncodedAcquisition
+{
+    EncodedAcquisition()
+        : data(NULL)
+        , data_bytes(0)
+        , uncompressed_bytes(0)
+        , compressed_bytes(0)
+    {
+    }
+
+    std::vector<char> message;
+    const void* data;           ///< uncompressed data written after the message if it was not copied into it
+    size_t data_bytes;
+    double uncompressed_bytes;  ///< data bytes before compression, 0 if not compressed
+    double compressed_bytes;
+};
+
 #if defined GADGETRON_COMPRESSION_ZFP
 size_t compress_zfp_tolerance(float* in, size_t samples, size_t coils, double tolerance, char* buffer, size_t buf_size)
 {
@@ -197,6 +241,7 @@ enum GadgetronMessageID {
     GADGET_MESSAGE_PARAMETER_SCRIPT                       =   3,
     GADGET_MESSAGE_CLOSE                                  =   4,
     GADGET_MESSAGE_TEXT                                   =   5,
+    GADGET_MESSAGE_META_FORMAT                            =   6,
     GADGET_MESSAGE_INT_ID_MAX                             = 999,
     GADGET_MESSAGE_EXT_ID_MIN                             = 1000,
     GADGET_MESSAGE_ACQUISITION                            = 1001, /**< DEPRECATED */
@@ -242,6 +287,16 @@ struct GadgetMessageScript
     uint32_t script_length;
 };
 
+enum GadgetMetaFormat {
+    GADGET_META_FORMAT_XML                                =   0,
+    GADGET_META_FORMAT_BINARY                             =   1
+};
+
+struct GadgetMessageMetaFormat
+{
+    uint32_t format;
+};
+
 class GadgetronClientException : public std::exception
 {
 
@@ -263,6 +318,61 @@ protected:
     std::string msg_;
 };
 
+/**
+Queue between two stages of the pipelined client, push blocks while the queue is full.
+After close, push fails and pop returns the remaining items.
+*/
+template <typename T> class GadgetronClientBoundedQueue
+{
+public:
+    GadgetronClientBoundedQueue(size_t capacity)
+        : capacity_(capacity > 0 ? capacity : 1)
+        , closed_(false)
+    {
+    }
+
+    /// returns false if the queue has been closed
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_full_.wait(lock, [this]{ return closed_ || items_.size() < capacity_; });
+        if (closed_) return false;
+
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /// returns false if the queue has been closed and is empty
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_empty_.wait(lock, [this]{ return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+
+        item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+protected:
+    size_t capacity_;
+    bool closed_;
+    std::deque<T> items_;
+    std::mutex mtx_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+};
+
 class GadgetronClientMessageReader
 {
 public:
@@ -273,8 +383,46 @@ public:
     */
     virtual void read(tcp::socket* s) = 0;
 
+    /**
+    Called when the connection has ended, readers with a stage of their own finish it here.
+    */
+    virtual void close() {}
 };
 
+/**
+Reads the meta attributes of an image, sent as XML or in the binary encoding.
+The decoder keeps the string table of the binary encoding for the connection.
+*/
+void deserialize_meta_attrib(Gadgetron::MetaBinaryDecoder& decoder, const std::string& meta_attrib, ISMRMRD::MetaContainer& meta)
+{
+    if (Gadgetron::is_meta_binary(meta_attrib.c_str(), meta_attrib.size()))
+    {
+        if (!decoder.decode(meta_attrib.c_str(), meta_attrib.size(), meta))
+        {
+            throw GadgetronClientException("Unable to decode binary image meta attributes");
+        }
+    }
+    else
+    {
+        ISMRMRD::deserialize(meta_attrib.c_str(), meta);
+    }
+}
+
+/**
+Returns the XML text of the meta attributes, as stored in the output files.
+*/
+std::string meta_attrib_to_xml(Gadgetron::MetaBinaryDecoder& decoder, const std::string& meta_attrib)
+{
+    if (!Gadgetron::is_meta_binary(meta_attrib.c_str(), meta_attrib.size())) return meta_attrib;
+
+    ISMRMRD::MetaContainer meta;
+    deserialize_meta_attrib(decoder, meta_attrib, meta);
+
+    std::stringstream str;
+    ISMRMRD::serialize(meta, str);
+    return str.str();
+}
+
 class GadgetronClientTextReader : public GadgetronClientMessageReader
 {
   
@@ -384,20 +532,37 @@ class GadgetronClientImageMessageReader : public GadgetronClientMessageReader
 {
 
 public:
-    GadgetronClientImageMessageReader(std::string filename, std::string groupname)
+    /**
+    With an append_queue_length, the images are appended to the file by a stage of its own,
+    so receiving continues while the file is written.
+    */
+    GadgetronClientImageMessageReader(std::string filename, std::string groupname, size_t append_queue_length = 0)
         : file_name_(filename)
         , group_name_(groupname)
+        , append_queue_(append_queue_length)
     {
-
+        if (append_queue_length > 0) {
+            append_thread_ = std::thread(&GadgetronClientImageMessageReader::append_task, this);
+        }
     }
 
     ~GadgetronClientImageMessageReader() {
+        this->close();
     } 
 
+    virtual void close()
+    {
+        append_queue_.close();
+        if (append_thread_.joinable()) {
+            append_thread_.join();
+        }
+    }
+
     template <typename T> 
-    void read_data_attrib(tcp::socket* stream, const ISMRMRD::ImageHeader& h, ISMRMRD::Image<T>& im)
+    void read_data_attrib(tcp::socket* stream, const ISMRMRD::ImageHeader& h)
     {
-        im.setHead(h);
+        std::shared_ptr< ISMRMRD::Image<T> > im = std::make_shared< ISMRMRD::Image<T> >();
+        im->setHead(h);
 
         typedef unsigned long long size_t_type;
 
@@ -409,32 +574,33 @@ public:
         {
             std::string meta_attrib(meta_attrib_length, 0);
             boost::asio::read(*stream, boost::asio::buffer(const_cast<char*>(meta_attrib.c_str()), meta_attrib_length));
-            im.setAttributeString(meta_attrib);
+            im->setAttributeString(meta_attrib_to_xml(meta_decoder_, meta_attrib));
         }
 
         //Read image data
-        boost::asio::read(*stream, boost::asio::buffer(im.getDataPtr(), im.getDataSize()));
-        {
-            if (!dataset_) {
+        boost::asio::read(*stream, boost::asio::buffer(im->getDataPtr(), im->getDataSize()));
 
-                {
-                    mtx.lock();
-                    dataset_ = boost::shared_ptr<ISMRMRD::Dataset>(new ISMRMRD::Dataset(file_name_.c_str(), group_name_.c_str(), true)); // create if necessary 
-                    mtx.unlock();
-                }
-            }
+        if (append_thread_.joinable()) {
+            append_queue_.push([this, im]() { this->append_image(*im); });
+        } else {
+            this->append_image(*im);
+        }
+    }
+
+    template <typename T>
+    void append_image(ISMRMRD::Image<T>& im)
+    {
+        std::stringstream st1;
+        st1 << "image_" << im.getHead().image_series_index;
+        std::string image_varname = st1.str();
 
-            std::stringstream st1;
-            st1 << "image_" << h.image_series_index;
-            std::string image_varname = st1.str();
+        boost::mutex::scoped_lock scoped_lock(mtx);
 
-            {
-                mtx.lock();
-                //TODO should this be wrapped in a try/catch?
-                dataset_->appendImage(image_varname, im);
-                mtx.unlock();
-            }
+        if (!dataset_) {
+            dataset_ = boost::shared_ptr<ISMRMRD::Dataset>(new ISMRMRD::Dataset(file_name_.c_str(), group_name_.c_str(), true)); // create if necessary 
         }
+
+        dataset_->appendImage(image_varname, im);
     }
 
     virtual void read(tcp::socket* stream) 
@@ -445,43 +611,35 @@ public:
 
         if (h.data_type == ISMRMRD::ISMRMRD_USHORT)
         {
-            ISMRMRD::Image<unsigned short> im;
-            this->read_data_attrib(stream, h, im);
+            this->read_data_attrib<unsigned short>(stream, h);
         }
         else if (h.data_type == ISMRMRD::ISMRMRD_SHORT)
         {
-            ISMRMRD::Image<short> im;
-            this->read_data_attrib(stream, h, im);
+            this->read_data_attrib<short>(stream, h);
         }
         else if (h.data_type == ISMRMRD::ISMRMRD_UINT)
         {
-            ISMRMRD::Image<unsigned int> im;
-            this->read_data_attrib(stream, h, im);
+            this->read_data_attrib<unsigned int>(stream, h);
         }
         else if (h.data_type == ISMRMRD::ISMRMRD_INT)
         {
-            ISMRMRD::Image<int> im;
-            this->read_data_attrib(stream, h, im);
+            this->read_data_attrib<int>(stream, h);
         }
         else if (h.data_type == ISMRMRD::ISMRMRD_FLOAT)
         {
-            ISMRMRD::Image<float> im;
-            this->read_data_attrib(stream, h, im);
+            this->read_data_attrib<float>(stream, h);
         }
         else if (h.data_type == ISMRMRD::ISMRMRD_DOUBLE)
         {
-            ISMRMRD::Image<double> im;
-            this->read_data_attrib(stream, h, im);
+            this->read_data_attrib<double>(stream, h);
         }
         else if (h.data_type == ISMRMRD::ISMRMRD_CXFLOAT)
         {
-            ISMRMRD::Image< std::complex<float> > im;
-            this->read_data_attrib(stream, h, im);
+            this->read_data_attrib<std::complex<float>>(stream, h);
         }
         else if (h.data_type == ISMRMRD::ISMRMRD_CXDOUBLE)
         {
-            ISMRMRD::Image< std::complex<double> > im;
-            this->read_data_attrib(stream, h, im);
+            this->read_data_attrib<std::complex<double>>(stream, h);
         }
         else
         {
@@ -493,6 +651,22 @@ protected:
     std::string group_name_;
     std::string file_name_;
     boost::shared_ptr<ISMRMRD::Dataset> dataset_;
+    Gadgetron::MetaBinaryDecoder meta_decoder_;
+
+    void append_task()
+    {
+        std::function<void()> task;
+        while (append_queue_.pop(task)) {
+            try {
+                task();
+            } catch (std::exception& ex) {
+                std::cerr << "Unable to append image: " << ex.what() << std::endl;
+            }
+        }
+    }
+
+    GadgetronClientBoundedQueue< std::function<void()> > append_queue_;
+    std::thread append_thread_;
 };
 
 // ----------------------------------------------------------------
@@ -857,9 +1031,8 @@ public:
             std::string meta_attrib(meta_attrib_length, 0);
             boost::asio::read(*stream, boost::asio::buffer(const_cast<char*>(meta_attrib.c_str()), meta_attrib_length));
 
-            // deserialize the meta attribute
-            ISMRMRD::MetaContainer imgAttrib;
-            ISMRMRD::deserialize(meta_attrib.c_str(), imgAttrib);
+            // the attribute file is XML, whatever the encoding on the wire
+            std::string meta_xml = meta_attrib_to_xml(meta_decoder_, meta_attrib);
 
             std::stringstream st3;
             st3 << filename << ".attrib";
@@ -867,7 +1040,7 @@ public:
 
             std::ofstream outfile;
             outfile.open(meta_varname.c_str(), std::ios::out | std::ios::binary);
-            outfile.write(meta_attrib.c_str(), meta_attrib_length);
+            outfile.write(meta_xml.c_str(), meta_xml.size());
             outfile.close();
         }
 
@@ -965,6 +1138,7 @@ public:
 protected:
 
     std::string prefix_;
+    Gadgetron::MetaBinaryDecoder meta_decoder_;
 };
 
 // ----------------------------------------------------------------
@@ -1073,6 +1247,8 @@ public:
         , timeout_ms_(10000)
         , uncompressed_bytes_sent_(0)
         , compressed_bytes_sent_(0)
+        , acquisition_bytes_sent_(0)
+        , acquisitions_sent_(0)
     {
 
     }
@@ -1093,6 +1269,17 @@ public:
 
         return uncompressed_bytes_sent_/compressed_bytes_sent_;
     }
+
+    /// bytes of the acquisition messages written to the socket
+    double acquisition_bytes_sent()
+    {
+        return acquisition_bytes_sent_;
+    }
+
+    size_t acquisitions_sent()
+    {
+        return acquisitions_sent_;
+    }
     
     void set_timeout(unsigned int t)
     {
@@ -1131,6 +1318,11 @@ public:
 
     void wait() {
         reader_thread_.join();
+
+        //The readers may still be writing what they have received
+        for (maptype::iterator it = readers_.begin(); it != readers_.end(); it++) {
+            it->second->close();
+        }
     }
 
     void connect(std::string hostname, std::string port)
@@ -1149,6 +1341,7 @@ public:
 
         std::condition_variable cv;
         std::mutex cv_m;
+        bool connect_done = false;
         
         boost::system::error_code error = boost::asio::error::host_not_found;
         std::thread t([&](){
@@ -1159,12 +1352,17 @@ public:
                     socket_->close();
                     socket_->connect(*endpoint_iterator++, error);
                 }
+                {
+                    std::lock_guard<std::mutex> lk(cv_m);
+                    connect_done = true;
+                }
                 cv.notify_all();
             });
 
         {
+            //A connection made before we wait must not be taken for a timeout
             std::unique_lock<std::mutex> lk(cv_m);
-            if (std::cv_status::timeout == cv.wait_until(lk, std::chrono::system_clock::now() +std::chrono::milliseconds(timeout_ms_)) ) {
+            if (!cv.wait_until(lk, std::chrono::system_clock::now() +std::chrono::milliseconds(timeout_ms_), [&]{ return connect_done; }) ) {
                 socket_->close();
              }
         }
@@ -1226,258 +1424,275 @@ public:
     }
 
 
-    void  send_gadgetron_parameters(std::string xml_string)
+    /**
+    Asks for the image meta attributes in the given GadgetMetaFormat.
+    Servers without the negotiation close the connection, so XML is not requested explicitly.
+    */
+    void send_gadgetron_meta_format(uint32_t format)
     {
         if (!socket_) {
             throw GadgetronClientException("Invalid socket.");
         }
 
         GadgetMessageIdentifier id;
-        id.id = GADGET_MESSAGE_PARAMETER_SCRIPT;
+        id.id = GADGET_MESSAGE_META_FORMAT;
 
-        GadgetMessageScript conf;
-        conf.script_length = (uint32_t)xml_string.size()+1;
+        GadgetMessageMetaFormat fmt;
+        fmt.format = format;
 
         boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        boost::asio::write(*socket_, boost::asio::buffer(&conf, sizeof(GadgetMessageScript)));
-        boost::asio::write(*socket_, boost::asio::buffer(xml_string.c_str(), conf.script_length));    
+        boost::asio::write(*socket_, boost::asio::buffer(&fmt, sizeof(GadgetMessageMetaFormat)));
     }
 
-    void send_ismrmrd_acquisition(ISMRMRD::Acquisition& acq) 
+    void  send_gadgetron_parameters(std::string xml_string)
     {
         if (!socket_) {
             throw GadgetronClientException("Invalid socket.");
         }
 
         GadgetMessageIdentifier id;
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;;
+        id.id = GADGET_MESSAGE_PARAMETER_SCRIPT;
+
+        GadgetMessageScript conf;
+        conf.script_length = (uint32_t)xml_string.size()+1;
 
         boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        boost::asio::write(*socket_, boost::asio::buffer(&acq.getHead(), sizeof(ISMRMRD::AcquisitionHeader)));
+        boost::asio::write(*socket_, boost::asio::buffer(&conf, sizeof(GadgetMessageScript)));
+        boost::asio::write(*socket_, boost::asio::buffer(xml_string.c_str(), conf.script_length));    
+    }
 
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
+    void send_ismrmrd_acquisition(ISMRMRD::Acquisition& acq) 
+    {
+        AcquisitionCompression compression;
+        this->send_acquisition(acq, compression);
+    }
 
-        if (trajectory_elements) {
-            boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
+    void send_ismrmrd_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
+    {
+        AcquisitionCompression compression;
+        compression.precision = compression_precision;
+        this->send_acquisition(acq, compression);
+    }
 
+    void send_ismrmrd_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat) 
+    {
+        AcquisitionCompression compression;
+        compression.tolerance = compression_tolerance;
+        compression.noise_stats = stat;
+        this->send_acquisition(acq, compression);
+    }
 
-        if (data_elements) {
-            boost::asio::write(*socket_, boost::asio::buffer(&acq.getDataPtr()[0], 2*sizeof(float)*data_elements));
-        }
+    void send_ismrmrd_zfp_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
+    {
+        AcquisitionCompression compression;
+        compression.precision = compression_precision;
+        compression.use_zfp = true;
+        this->send_acquisition(acq, compression);
     }
 
+    void send_ismrmrd_zfp_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat) 
+    {
+        AcquisitionCompression compression;
+        compression.tolerance = compression_tolerance;
+        compression.noise_stats = stat;
+        compression.use_zfp = true;
+        this->send_acquisition(acq, compression);
+    }
 
-    void send_ismrmrd_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
+    /// Compresses and sends the acquisition on the calling thread
+    void send_acquisition(ISMRMRD::Acquisition& acq, const AcquisitionCompression& compression)
     {
         if (!socket_) {
             throw GadgetronClientException("Invalid socket.");
         }
 
-        GadgetMessageIdentifier id;
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
-
-        ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
-        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
-
-        boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
-
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
-
-        if (trajectory_elements) {
-            boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
-
-
-        if (data_elements) {
-            std::vector<float> input_data((float*)&acq.getDataPtr()[0], (float*)&acq.getDataPtr()[0] + acq.getHead().active_channels*acq.getHead().number_of_samples*2);
-
-            CompressedBuffer<float> comp_buffer(input_data, -1.0, compression_precision);
-            std::vector<uint8_t> serialized_buffer = comp_buffer.serialize();
- 
-            compressed_bytes_sent_ += serialized_buffer.size();
-            uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
-                            
-            uint32_t bs = (uint32_t)serialized_buffer.size();
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(&serialized_buffer[0], serialized_buffer.size()));
-        }
-        
+        //The acquisition outlives the write, uncompressed data is sent from it
+        EncodedAcquisition e;
+        encode_acquisition(acq, compression, e, false);
+        this->send_encoded_acquisition(e);
     }
 
-
-    void send_ismrmrd_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat) 
+    /**
+    Sends the acquisitions of the dataset through a pipeline: a reader thread, compression_threads
+    compressors and the calling thread as the sender, joined by queues of queue_length acquisitions.
+    The acquisitions are sent in order. Errors of any stage stop the pipeline and are rethrown here.
+    */
+    void send_acquisitions_pipelined(ISMRMRD::Dataset& dataset, uint32_t acquisitions, const AcquisitionCompression& compression, unsigned int compression_threads, size_t queue_length)
     {
         if (!socket_) {
             throw GadgetronClientException("Invalid socket.");
         }
 
-        GadgetMessageIdentifier id;
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
+        if (compression_threads == 0) compression_threads = 1;
 
-        ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
-        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
+        GadgetronClientBoundedQueue< std::shared_ptr<CompressionJob> > compression_queue(queue_length);
 
-        boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
+        //The sender waits for the acquisitions in the order they were read
+        GadgetronClientBoundedQueue< std::future<EncodedAcquisition> > send_queue(queue_length + compression_threads);
 
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
+        std::exception_ptr read_error;
+        std::exception_ptr send_error;
 
-        if (trajectory_elements) {
-            boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
+        std::thread reader([&]() {
+            try {
+                for (uint32_t i = 0; i < acquisitions; i++) {
+                    std::shared_ptr<CompressionJob> job = std::make_shared<CompressionJob>();
+                    {
+                        boost::mutex::scoped_lock scoped_lock(mtx);
+                        dataset.readAcquisition(i, job->acq);
+                    }
 
+                    if (!send_queue.push(job->encoded.get_future())) break;
+                    if (!compression_queue.push(job)) break;
+                }
+            } catch (...) {
+                read_error = std::current_exception();
+            }
 
-        if (data_elements) {
-            std::vector<float> input_data((float*)&acq.getDataPtr()[0], (float*)&acq.getDataPtr()[0] + acq.getHead().active_channels* acq.getHead().number_of_samples*2);
+            compression_queue.close();
+            send_queue.close();
+        });
+
+        std::vector<std::thread> compressors;
+        for (unsigned int t = 0; t < compression_threads; t++) {
+            compressors.push_back(std::thread([&]() {
+                std::shared_ptr<CompressionJob> job;
+                while (compression_queue.pop(job)) {
+                    try {
+                        EncodedAcquisition e;
+                        encode_acquisition(job->acq, compression, e);
+                        job->encoded.set_value(std::move(e));
+                    } catch (...) {
+                        job->encoded.set_exception(std::current_exception());
+                    }
+                }
+            }));
+        }
 
-            float local_tolerance = compression_tolerance;
-            float sigma = stat.sigma_min; //We use the minimum sigma of all channels to "cap" the error
-            if (stat.status && sigma > 0 && stat.noise_dwell_time_us && acq.getHead().sample_time_us) {
-                local_tolerance = local_tolerance*stat.sigma_min*acq.getHead().sample_time_us*std::sqrt(stat.noise_dwell_time_us/acq.getHead().sample_time_us);
+        try {
+            std::future<EncodedAcquisition> f;
+            while (send_queue.pop(f)) {
+                EncodedAcquisition e = f.get();
+                this->send_encoded_acquisition(e);
             }
-
-            CompressedBuffer<float> comp_buffer(input_data, local_tolerance);
-            std::vector<uint8_t> serialized_buffer = comp_buffer.serialize();
- 
-            compressed_bytes_sent_ += serialized_buffer.size();
-            uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
-                            
-            uint32_t bs = (uint32_t)serialized_buffer.size();
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(&serialized_buffer[0], serialized_buffer.size()));
+        } catch (...) {
+            send_error = std::current_exception();
         }
-    }
 
-    void send_ismrmrd_zfp_compressed_acquisition_precision(ISMRMRD::Acquisition& acq, unsigned int compression_precision) 
-    {
+        //Stops the reader and compressors if the sender failed
+        compression_queue.close();
+        send_queue.close();
 
-#if defined GADGETRON_COMPRESSION_ZFP           
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
+        reader.join();
+        for (size_t t = 0; t < compressors.size(); t++) {
+            compressors[t].join();
         }
 
+        if (send_error) std::rethrow_exception(send_error);
+        if (read_error) std::rethrow_exception(read_error);
+    }
+
+    /**
+    Serializes the acquisition message, with the data compressed as requested.
+    Does not use the connection, so acquisitions can be encoded on several threads.
+    If copy_data is false, uncompressed data is referred to and must outlive the message.
+    */
+    static void encode_acquisition(ISMRMRD::Acquisition& acq, const AcquisitionCompression& compression, EncodedAcquisition& e, bool copy_data = true)
+    {
         GadgetMessageIdentifier id;
-        //TODO: switch data type
         id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
 
         ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
-        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1);
-
-        boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
 
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
+        unsigned long trajectory_elements = h.trajectory_dimensions*h.number_of_samples;
+        unsigned long data_elements = h.active_channels*h.number_of_samples;
 
-        if (trajectory_elements) {
-            boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
-        }
+        bool compress = (compression.precision > 0 || compression.tolerance > 0.0f);
 
-
-        if (data_elements) {
-            size_t comp_buffer_size = 4*sizeof(float)*data_elements;
-            char* comp_buffer = new char[comp_buffer_size];
-            size_t compressed_size = 0;
-            try {
-                compressed_size = compress_zfp_precision((float*)&acq.getDataPtr()[0],
-                                                         acq.getHead().number_of_samples*2, acq.getHead().active_channels,
-                                                         compression_precision, comp_buffer, comp_buffer_size);
-
-                compressed_bytes_sent_ += compressed_size;
-                uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
-                float compression_ratio = (1.0*data_elements*2*sizeof(float))/(float)compressed_size;
-                //std::cout << "Compression ratio: " << compression_ratio << std::endl;
-                
-            } catch (...) {
-                delete [] comp_buffer;
-                std::cout << "Compression failure caught" << std::endl;
-                throw;
+        if (compress) {
+#if !defined GADGETRON_COMPRESSION_ZFP
+            if (compression.use_zfp) {
+                throw GadgetronClientException("Attempting to do ZFP compression, but ZFP not available");
             }
-
-
-            //TODO: Write compressed buffer
-            uint32_t bs = (uint32_t)compressed_size;
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(comp_buffer, compressed_size));
-
-            delete [] comp_buffer;
-        }
-
-#else //GADGETRON_COMPRESSION_ZFP
-        throw GadgetronClientException("Attempting to do ZFP compression, but ZFP not available");
 #endif //GADGETRON_COMPRESSION_ZFP
-    }
-
-    void send_ismrmrd_zfp_compressed_acquisition_tolerance(ISMRMRD::Acquisition& acq, float compression_tolerance, NoiseStatistics& stat) 
-    {
-        
-#if defined GADGETRON_COMPRESSION_ZFP
-        if (!socket_) {
-            throw GadgetronClientException("Invalid socket.");
+            h.setFlag(compression.use_zfp ? ISMRMRD::ISMRMRD_ACQ_COMPRESSION1 : ISMRMRD::ISMRMRD_ACQ_COMPRESSION2);
         }
 
-        GadgetMessageIdentifier id;
-        //TODO: switch data type
-        id.id = GADGET_MESSAGE_ISMRMRD_ACQUISITION;
-
-        ISMRMRD::AcquisitionHeader h = acq.getHead(); //We will make a copy because we will be setting some flags
-        h.setFlag(ISMRMRD::ISMRMRD_ACQ_COMPRESSION1);
+        std::vector<char>& m = e.message;
+        m.clear();
+        append_bytes(m, &id, sizeof(GadgetMessageIdentifier));
+        append_bytes(m, &h, sizeof(ISMRMRD::AcquisitionHeader));
 
-        boost::asio::write(*socket_, boost::asio::buffer(&id, sizeof(GadgetMessageIdentifier)));
-        boost::asio::write(*socket_, boost::asio::buffer(&h, sizeof(ISMRMRD::AcquisitionHeader)));
+        if (trajectory_elements) {
+            append_bytes(m, &acq.getTrajPtr()[0], sizeof(float)*trajectory_elements);
+        }
 
-        unsigned long trajectory_elements = acq.getHead().trajectory_dimensions*acq.getHead().number_of_samples;
-        unsigned long data_elements = acq.getHead().active_channels*acq.getHead().number_of_samples;
+        if (!data_elements) return;
 
-        if (trajectory_elements) {
-            boost::asio::write(*socket_, boost::asio::buffer(&acq.getTrajPtr()[0], sizeof(float)*trajectory_elements));
+        if (!compress) {
+            if (copy_data) {
+                append_bytes(m, &acq.getDataPtr()[0], 2*sizeof(float)*data_elements);
+            } else {
+                e.data = &acq.getDataPtr()[0];
+                e.data_bytes = 2*sizeof(float)*data_elements;
+            }
+            return;
         }
 
-        float local_tolerance = compression_tolerance;
+        float local_tolerance = compression.tolerance;
+        const NoiseStatistics& stat = compression.noise_stats;
         float sigma = stat.sigma_min; //We use the minimum sigma of all channels to "cap" the error
-        if (stat.status && sigma > 0 && stat.noise_dwell_time_us && acq.getHead().sample_time_us) {
-            local_tolerance = local_tolerance*stat.sigma_min*acq.getHead().sample_time_us*std::sqrt(stat.noise_dwell_time_us/acq.getHead().sample_time_us);
+        if (stat.status && sigma > 0 && stat.noise_dwell_time_us && h.sample_time_us) {
+            local_tolerance = local_tolerance*stat.sigma_min*h.sample_time_us*std::sqrt(stat.noise_dwell_time_us/h.sample_time_us);
         }
 
-        if (data_elements) {
+        //The size of the compressed buffer precedes it
+        size_t size_offset = m.size();
+        uint32_t bs = 0;
+        append_bytes(m, &bs, sizeof(uint32_t));
+
+        if (compression.use_zfp) {
+#if defined GADGETRON_COMPRESSION_ZFP
             size_t comp_buffer_size = 4*sizeof(float)*data_elements;
-            char* comp_buffer = new char[comp_buffer_size];
+            m.resize(size_offset + sizeof(uint32_t) + comp_buffer_size);
+            char* comp_buffer = &m[size_offset + sizeof(uint32_t)];
+
             size_t compressed_size = 0;
-            try {
+            if (compression.precision > 0) {
+                compressed_size = compress_zfp_precision((float*)&acq.getDataPtr()[0],
+                                                         h.number_of_samples*2, h.active_channels,
+                                                         compression.precision, comp_buffer, comp_buffer_size);
+            } else {
                 compressed_size = compress_zfp_tolerance((float*)&acq.getDataPtr()[0],
-                                                         acq.getHead().number_of_samples*2, acq.getHead().active_channels,
+                                                         h.number_of_samples*2, h.active_channels,
                                                          local_tolerance, comp_buffer, comp_buffer_size);
-
-                compressed_bytes_sent_ += compressed_size;
-                uncompressed_bytes_sent_ += data_elements*2*sizeof(float);
-                float compression_ratio = (1.0*data_elements*2*sizeof(float))/(float)compressed_size;
-                //std::cout << "Compression ratio: " << compression_ratio << std::endl;
-                
-            } catch (...) {
-                delete [] comp_buffer;
-                std::cout << "Compression failure caught" << std::endl;
-                throw;
             }
 
+            m.resize(size_offset + sizeof(uint32_t) + compressed_size);
+            bs = (uint32_t)compressed_size;
+#endif //GADGETRON_COMPRESSION_ZFP
+        } else {
+            std::vector<float> input_data((float*)&acq.getDataPtr()[0], (float*)&acq.getDataPtr()[0] + data_elements*2);
 
-            //TODO: Write compressed buffer
-            uint32_t bs = (uint32_t)compressed_size;
-            boost::asio::write(*socket_, boost::asio::buffer(&bs, sizeof(uint32_t)));
-            boost::asio::write(*socket_, boost::asio::buffer(comp_buffer, compressed_size));
+            std::vector<uint8_t> serialized_buffer;
+            if (compression.precision > 0) {
+                CompressedBuffer<float> comp_buffer(input_data, -1.0, compression.precision);
+                serialized_buffer = comp_buffer.serialize();
+            } else {
+                CompressedBuffer<float> comp_buffer(input_data, local_tolerance);
+                serialized_buffer = comp_buffer.serialize();
+            }
 
-            delete [] comp_buffer;
+            append_bytes(m, &serialized_buffer[0], serialized_buffer.size());
+            bs = (uint32_t)serialized_buffer.size();
         }
-#else //GADGETRON_COMPRESSION_ZFP
-        throw GadgetronClientException("Attempting to do ZFP compression, but ZFP not available");
-#endif //GADGETRON_COMPRESSION_ZFP
 
+        memcpy(&m[size_offset], &bs, sizeof(uint32_t));
+
+        e.uncompressed_bytes = data_elements*2*sizeof(float);
+        e.compressed_bytes = bs;
     }
-    
+
     void register_reader(unsigned short slot, boost::shared_ptr<GadgetronClientMessageReader> r) {
         readers_[slot] = r;
     }
@@ -1485,6 +1700,35 @@ public:
 protected:
     typedef std::map<unsigned short, boost::shared_ptr<GadgetronClientMessageReader> > maptype;
 
+    struct CompressionJob
+    {
+        ISMRMRD::Acquisition acq;
+        std::promise<EncodedAcquisition> encoded;
+    };
+
+    static void append_bytes(std::vector<char>& buf, const void* data, size_t len)
+    {
+        const char* p = reinterpret_cast<const char*>(data);
+        buf.insert(buf.end(), p, p + len);
+    }
+
+    void send_encoded_acquisition(const EncodedAcquisition& e)
+    {
+        if (e.data) {
+            std::vector<boost::asio::const_buffer> buffers;
+            buffers.push_back(boost::asio::buffer(e.message));
+            buffers.push_back(boost::asio::buffer(e.data, e.data_bytes));
+            boost::asio::write(*socket_, buffers);
+        } else {
+            boost::asio::write(*socket_, boost::asio::buffer(e.message));
+        }
+
+        compressed_bytes_sent_ += e.compressed_bytes;
+        uncompressed_bytes_sent_ += e.uncompressed_bytes;
+        acquisition_bytes_sent_ += e.message.size() + e.data_bytes;
+        acquisitions_sent_++;
+    }
+
     GadgetronClientMessageReader* find_reader(unsigned short r)
     {
         GadgetronClientMessageReader* ret = 0;
@@ -1505,6 +1749,8 @@ protected:
     unsigned int timeout_ms_;
     double uncompressed_bytes_sent_;
     double compressed_bytes_sent_;
+    double acquisition_bytes_sent_;
+    size_t acquisitions_sent_;
 };
 
 
@@ -1642,6 +1888,9 @@ int main(int argc, char **argv)
     unsigned int compression_precision = 0;
     float compression_tolerance = 0.0;
     bool use_zfp_compression = false;
+    std::string meta_format;
+    unsigned int compression_threads = 0;
+    size_t queue_length = 64;
     
     po::options_description desc("Allowed options");
 
@@ -1661,6 +1910,9 @@ int main(int argc, char **argv)
         ("outformat,F", po::value<std::string>(&out_fileformat)->default_value("h5"), "Out format, h5 for hdf5 and hdr for analyze image")
         ("precision,P", po::value<unsigned int>(&compression_precision)->default_value(0), "Compression precision (bits)")
         ("tolerance,T", po::value<float>(&compression_tolerance)->default_value(0.0), "Compression tolerance (fraction of sigma, if no noise stats, assume sigma 1)")
+        ("pipeline,x", po::value<unsigned int>(&compression_threads)->default_value(0), "Compression threads of the pipelined sending, 0 to read, compress and send on one thread")
+        ("queue-length,Q", po::value<size_t>(&queue_length)->default_value(64), "Acquisitions and images queued between the stages of the pipelined sending")
+        ("meta-format,M", po::value<std::string>(&meta_format)->default_value("xml"), "Image meta attributes on the wire, xml or binary (binary needs a server with meta format negotiation)")
 #if defined GADGETRON_COMPRESSION_ZFP
         ("ZFP,Z", po::value<bool>(&use_zfp_compression)->default_value(false), "Use ZFP library for compression");
 #endif //GADGETRON_COMPRESSION_ZFP
@@ -1789,7 +2041,9 @@ int main(int argc, char **argv)
     }
     else
     {
-        con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, boost::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientImageMessageReader(out_filename, hdf5_out_group)));
+        //The pipelined client appends the images to the file on a thread of its own
+        size_t append_queue_length = (compression_threads > 0) ? queue_length : 0;
+        con.register_reader(GADGET_MESSAGE_ISMRMRD_IMAGE, boost::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientImageMessageReader(out_filename, hdf5_out_group, append_queue_length)));
     }
 
     con.register_reader(GADGET_MESSAGE_DICOM_WITHNAME, boost::shared_ptr<GadgetronClientMessageReader>(new GadgetronClientBlobMessageReader(std::string(hdf5_out_group), std::string("dcm"))));
@@ -1805,6 +2059,10 @@ int main(int argc, char **argv)
             con.send_gadgetron_configuration_file(config_file);
         }
 
+        if (meta_format == "binary") {
+            con.send_gadgetron_meta_format(GADGET_META_FORMAT_BINARY);
+        }
+
 	if (open_input_file) {
 	  con.send_gadgetron_parameters(xml_config);
 	  
@@ -1815,30 +2073,33 @@ int main(int argc, char **argv)
             mtx.unlock();
 	  }
 	  
-	  ISMRMRD::Acquisition acq_tmp;
-	  for (uint32_t i = 0; i < acquisitions; i++) {
-            {
+	  AcquisitionCompression compression;
+	  compression.precision = compression_precision;
+	  compression.tolerance = compression_tolerance;
+	  compression.use_zfp = use_zfp_compression;
+	  compression.noise_stats = noise_stats;
+
+	  auto send_start = std::chrono::steady_clock::now();
+
+	  if (compression_threads > 0) {
+	    con.send_acquisitions_pipelined(*ismrmrd_dataset, acquisitions, compression, compression_threads, queue_length);
+	  } else {
+	    ISMRMRD::Acquisition acq_tmp;
+	    for (uint32_t i = 0; i < acquisitions; i++) {
 	      {
 		boost::mutex::scoped_lock scoped_lock(mtx);
 		ismrmrd_dataset->readAcquisition(i, acq_tmp);
 	      }
 
-              if (compression_precision > 0) {
-                  if (use_zfp_compression) {
-                      con.send_ismrmrd_zfp_compressed_acquisition_precision(acq_tmp,compression_precision);
-                  } else {
-                      con.send_ismrmrd_compressed_acquisition_precision(acq_tmp,compression_precision);
-                  }
-              } else if (compression_tolerance > 0.0) {
-                  if (use_zfp_compression) {
-                      con.send_ismrmrd_zfp_compressed_acquisition_tolerance(acq_tmp,compression_tolerance, noise_stats);
-                  } else {
-                      con.send_ismrmrd_compressed_acquisition_tolerance(acq_tmp,compression_tolerance, noise_stats);
-                  }
-              } else {
-                  con.send_ismrmrd_acquisition(acq_tmp);              
-              }
-            }
+	      con.send_acquisition(acq_tmp, compression);
+	    }
+	  }
+
+	  std::chrono::duration<double> send_time = std::chrono::steady_clock::now() - send_start;
+	  if (send_time.count() > 0) {
+	    double mb = con.acquisition_bytes_sent() / (1024.0*1024.0);
+	    std::cout << "Sent " << con.acquisitions_sent() << " readouts, " << mb << " MB in " << send_time.count() << " s: "
+		      << mb / send_time.count() << " MB/s, " << con.acquisitions_sent() / send_time.count() << " readouts/s" << std::endl;
 	  }
 	}
 
@@ -19,6 +19,7 @@ enum GadgetronMessageID {
   GADGET_MESSAGE_PARAMETER_SCRIPT =   3,
   GADGET_MESSAGE_CLOSE            =   4,
   GADGET_MESSAGE_TEXT             =   5,
+  GADGET_MESSAGE_META_FORMAT      =   6,
   GADGET_MESSAGE_INT_ID_MAX       = 999
 };
 
@@ -37,6 +38,20 @@ struct GadgetMessageScript
   ACE_UINT32 script_length;
 };
 
+/**
+   Encoding of the image meta attributes, requested by the client with GADGET_MESSAGE_META_FORMAT.
+   XML is used unless the client asks for the binary encoding.
+ */
+enum GadgetMetaFormat {
+  GADGET_META_FORMAT_XML    = 0,
+  GADGET_META_FORMAT_BINARY = 1
+};
+
+struct GadgetMessageMetaFormat
+{
+  ACE_UINT32 format;
+};
+
 
 /**
    Interface for classes capable of reading a specific message
@@ -68,6 +83,11 @@ class GadgetMessageWriter
      Function must be implemented to write a specific message.
    */
   virtual int write(ACE_SOCK_Stream* stream, ACE_Message_Block* mb) = 0;
+
+  /**
+     Called with the GadgetMetaFormat negotiated with the client, writers of meta attributes may use it.
+   */
+  virtual void set_meta_format(ACE_UINT32 format) {}
 };
 
 class GadgetMessageWriterContainer
@@ -15,6 +15,7 @@
 #include "url_encode.h"
 #include "CloudBus.h"
 
+#include <chrono>
 #include <complex>
 #include <fstream>
 
@@ -24,15 +25,39 @@ GadgetStreamController::GadgetStreamController()
   : GadgetStreamInterface()
   , notifier_ (0, this, ACE_Event_Handler::WRITE_MASK)
   , writer_task_(&this->peer())
+  , reported_queue_length_(0)
 {
   CloudBus::instance()->report_recon_start();    
 }
 
 GadgetStreamController::~GadgetStreamController()
 { 
+  if (reported_queue_length_) {
+    CloudBus::instance()->report_queue_length_change(-(int)reported_queue_length_);
+  }
   CloudBus::instance()->report_recon_end();
 }
 
+void GadgetStreamController::report_queue_length()
+{
+  //Only called from svc, the thread which also closes the stream
+  size_t queue_length = 0;
+  GadgetModule* module = 0;
+  if (stream_.top(module) == 0) {
+    //The last module is the stream tail, which does not queue
+    while (module && module->next()) {
+      ACE_Task<ACE_MT_SYNCH>* task = module->writer();
+      if (task && task->msg_queue()) queue_length += task->msg_queue()->message_count();
+      module = module->next();
+    }
+  }
+
+  if (queue_length != reported_queue_length_) {
+    CloudBus::instance()->report_queue_length_change((int)queue_length - (int)reported_queue_length_);
+    reported_queue_length_ = queue_length;
+  }
+}
+
 int GadgetStreamController::open (void)
 {
 
@@ -92,6 +117,7 @@ int GadgetStreamController::svc(void)
 
     if (id.id == GADGET_MESSAGE_CLOSE) {
       stream_.close(1); //Shutdown gadgets and wait for them
+      report_queue_length();
       GDEBUG("Stream closed\n");
       GDEBUG("Closing writer task\n");
       this->writer_task_.close(1);
@@ -99,6 +125,19 @@ int GadgetStreamController::svc(void)
       continue;
     }
 
+    if (id.id == GADGET_MESSAGE_META_FORMAT) {
+      GadgetMessageMetaFormat fmt;
+      if ((recv_cnt = peer().recv_n (&fmt, sizeof(GadgetMessageMetaFormat))) <= 0) {
+	GERROR("GadgetStreamController, unable to read meta format\n");
+	return -1;
+      }
+
+      //Unknown formats leave the writers with XML
+      this->writer_task_.set_meta_format(fmt.format);
+      GDEBUG("Image meta attributes requested in format %d\n", fmt.format);
+      continue;
+    }
+
     GadgetMessageReader* r = readers_.find(id.id);
 
     if (!r) {
@@ -150,6 +189,13 @@ int GadgetStreamController::svc(void)
       mb->release();
       return GADGET_FAIL;
     }
+
+    //The queues are not walked for every message, the CloudBus sends at most every 100ms
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - queue_length_sampled_ >= std::chrono::milliseconds(100)) {
+      queue_length_sampled_ = now;
+      report_queue_length();
+    }
   }
   return GADGET_OK;
 }
@@ -8,6 +8,7 @@
 #include "ace/Svc_Handler.h"
 #include "ace/Reactor_Notification_Strategy.h"
 
+#include <chrono>
 #include <complex>
 #include <vector>
 
@@ -43,6 +44,11 @@ private:
   GadgetMessageReaderContainer readers_;
   virtual int configure(std::string config_xml_string);
   virtual int configure_from_file(std::string config_xml_filename);
+
+  /// publishes the number of messages waiting in the gadget queues through the CloudBus
+  void report_queue_length();
+  size_t reported_queue_length_;
+  std::chrono::steady_clock::time_point queue_length_sampled_;
 };
 
 }
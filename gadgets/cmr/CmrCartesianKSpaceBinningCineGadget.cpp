@@ -34,6 +34,7 @@ namespace Gadgetron {
         binning_reconer_.use_multiple_channel_recon_                     = this->use_multiple_channel_recon.value();
         binning_reconer_.use_paralell_imaging_binning_recon_             = true;
         binning_reconer_.use_nonlinear_binning_recon_                    = this->use_nonlinear_binning_recon.value();
+        binning_reconer_.pipeline_binning_recon_                         = this->pipeline_binning_recon.value();
 
         binning_reconer_.estimate_respiratory_navigator_                 = true;
         binning_reconer_.respiratory_navigator_moco_reg_strength_        = this->respiratory_navigator_moco_reg_strength.value();
@@ -40,6 +40,7 @@ namespace Gadgetron {
         GADGET_PROPERTY(use_multiple_channel_recon, bool, "Whether to perform multi-channel recon in the raw data step", true);
         GADGET_PROPERTY(use_nonlinear_binning_recon, bool, "Whether to non-linear recon in the binning step", true);
         GADGET_PROPERTY(number_of_output_phases, int, "Number of output phases after binning", 30);
+        GADGET_PROPERTY(pipeline_binning_recon, bool, "Whether to run the binning of a slice while the recon of the previous slice is running", true);
 
         GADGET_PROPERTY(send_out_raw, bool, "Whether to set out raw images", false);
         GADGET_PROPERTY(send_out_multiple_series_by_slice, bool, "Whether to set out binning images as multiple seires", false);
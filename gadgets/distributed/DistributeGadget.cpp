@@ -3,11 +3,13 @@
 #include "gadgetron_xml.h"
 #include "CloudBus.h"
 #include <stdint.h>
+#include <functional>
 
 namespace Gadgetron{
 
   DistributionConnector::DistributionConnector(DistributeGadget* g)
   : distribute_gadget_(g)
+  , finished_(false)
   {
 
   }
@@ -16,10 +18,20 @@ namespace Gadgetron{
     return distribute_gadget_->collector_putq(mb);
   }
 
+  int DistributionConnector::svc(void) {
+    //Returns when the remote node closes the connection
+    int ret = GadgetronConnector::svc();
+    distribute_gadget_->job_finished(this);
+    return ret;
+  }
+
 
   DistributeGadget::DistributeGadget()
   : BasicPropertyGadget()
   , mtx_("distribution_mtx")
+  , connector_mtx_("distribution_connector_mtx")
+  , scheduler_mtx_("distribution_scheduler_mtx")
+  , connector_pool_(this)
   , prev_connector_(0)
   {
   }
@@ -46,6 +58,100 @@ namespace Gadgetron{
     return GADGET_OK;
   }
 
+  DistributionConnector* DistributeGadget::create_connector(const std::string& address, uint32_t port)
+  {
+    GadgetronXML::GadgetStreamConfiguration cfg;
+    try {
+      deserialize(node_xml_config_.c_str(), cfg);
+    }  catch (const std::runtime_error& e) {
+      GERROR("Failed to parse Node Gadget Stream Configuration: %s\n", e.what());
+      return 0;
+    }
+
+    DistributionConnector* con = new DistributionConnector(this);
+
+    connector_mtx_.acquire();
+
+    //Configuration of readers
+    for (auto i = cfg.reader.begin(); i != cfg.reader.end(); ++i) {
+      GadgetMessageReader* r =
+      controller_->load_dll_component<GadgetMessageReader>(i->dll.c_str(),
+      i->classname.c_str());
+      if (!r) {
+        GERROR("Failed to load GadgetMessageReader from DLL\n");
+        connector_mtx_.release();
+        delete con;
+        return 0;
+      }
+      con->register_reader(i->slot, r);
+    }
+
+    for (auto i = cfg.writer.begin(); i != cfg.writer.end(); ++i) {
+      GadgetMessageWriter* w =
+      controller_->load_dll_component<GadgetMessageWriter>(i->dll.c_str(),
+      i->classname.c_str());
+      if (!w) {
+        GERROR("Failed to load GadgetMessageWriter from DLL\n");
+        connector_mtx_.release();
+        delete con;
+        return 0;
+      }
+      con->register_writer(i->slot, w);
+    }
+
+    connector_mtx_.release();
+
+    char buffer[10];
+    sprintf(buffer,"%d",port);
+    if (con->open(address,std::string(buffer)) != 0) {
+      GERROR("Failed to open connection to node %s : %d\n", address.c_str(), port);
+      delete con;
+      return 0;
+    }
+
+    bool configured = true;
+    if (con->send_gadgetron_configuration_script(node_xml_config_) != 0) {
+      GERROR("Failed to send XML configuration to compute node\n");
+      configured = false;
+    } else if (con->send_gadgetron_parameters(node_parameters_) != 0) {
+      GERROR("Failed to send XML parameters to compute node\n");
+      configured = false;
+    }
+
+    if (!configured) {
+      //The connection is open, its reader thread exits once the node has closed the stream
+      release_connector(con);
+      return 0;
+    }
+
+    return con;
+  }
+
+  void DistributeGadget::job_finished(DistributionConnector* con)
+  {
+    scheduler_mtx_.acquire();
+    auto j = jobs_.find(con);
+    if (j != jobs_.end()) {
+      if (scheduler_) scheduler_->job_finished(j->second.node, j->second.cost);
+      jobs_.erase(j);
+    } else {
+      //The job is not registered yet, process() must not start it on the scheduler
+      con->finished_ = true;
+    }
+    scheduler_mtx_.release();
+  }
+
+  void DistributeGadget::release_connector(DistributionConnector* con)
+  {
+    auto mc = new GadgetContainerMessage<GadgetMessageIdentifier>();
+    mc->getObjectPtr()->id = GADGET_MESSAGE_CLOSE;
+    if (con->putq(mc) == -1) {
+      mc->release();
+    }
+    con->wait();
+    delete con;
+  }
+
   int DistributeGadget::process(ACE_Message_Block* m)
   {
     int node_index = this->node_index(m);
@@ -90,23 +196,37 @@ namespace Gadgetron{
       GadgetronNodeInfo me;
       me.address = "127.0.0.1";//We may have to update this
       me.port = CloudBus::instance()->port();
+      me.rest_port = 0;
       me.uuid = CloudBus::instance()->uuid();
+      me.compute_capability = CloudBus::instance()->compute_capability();
       me.active_reconstructions = CloudBus::instance()->active_reconstructions();
+      me.queue_length = CloudBus::instance()->queue_length();
+      me.last_recon = 0;
 
-      //This would give the current node the lowest possible priority
-      if (!use_this_node_for_compute.value()) {
-        me.active_reconstructions = UINT32_MAX;
+      //The current node is only used if allowed or if there are no other nodes
+      std::vector<GadgetronNodeInfo> candidates;
+      if (use_this_node_for_compute.value() || nl.empty()) {
+        candidates.push_back(me);
       }
 
       for (auto it = nl.begin(); it != nl.end(); it++) {
-        if (it->active_reconstructions < me.active_reconstructions) {
-          me = *it;
-        }
+        GadgetronNodeInfo c = *it;
 
-        //Is this a free node
-        if (me.active_reconstructions == 0) break;
+        //Our own pre-warmed chains are counted as active reconstructions on the node
+        size_t idle = connector_pool_.idle_connections(c.address, c.port);
+        c.active_reconstructions = (c.active_reconstructions > idle) ? c.active_reconstructions - (unsigned int)idle : 0;
+
+        candidates.push_back(c);
       }
 
+      double cost = this->job_cost(m);
+
+      scheduler_mtx_.acquire();
+      int selected = scheduler_->select_node(candidates, cost);
+      scheduler_mtx_.release();
+
+      if (selected >= 0) me = candidates[selected];
+
       // first job, send to current node if required
       if (use_this_node_for_compute.value() && node_index==0)
       {
@@ -126,57 +246,47 @@ namespace Gadgetron{
           GDEBUG_STREAM("Send first job to current node : " << me.address);
       }
 
-      con = new DistributionConnector(this);
-
-      GadgetronXML::GadgetStreamConfiguration cfg;
-      try {
-        deserialize(node_xml_config_.c_str(), cfg);
-      }  catch (const std::runtime_error& e) {
-        GERROR("Failed to parse Node Gadget Stream Configuration: %s\n", e.what());
-        return GADGET_FAIL;
-      }
-
-      //Configuration of readers
-      for (auto i = cfg.reader.begin(); i != cfg.reader.end(); ++i) {
-        GadgetMessageReader* r =
-        controller_->load_dll_component<GadgetMessageReader>(i->dll.c_str(),
-        i->classname.c_str());
-        if (!r) {
-          GERROR("Failed to load GadgetMessageReader from DLL\n");
-          return GADGET_FAIL;
+      //The job is registered before any data is sent to the connector; a connection
+      //the node has already closed was reported to job_finished and is not started.
+      //It is released and a new connection is opened once.
+      DistributionConnector* dcon = 0;
+      for (int attempt = 0; attempt < 2 && !dcon; attempt++) {
+        if (attempt == 0 && connection_pool_size.value() > 0) {
+          dcon = connector_pool_.acquire(me.address, me.port);
+        } else {
+          dcon = create_connector(me.address, me.port);
         }
-        con->register_reader(i->slot, r);
-      }
 
-      for (auto i = cfg.writer.begin(); i != cfg.writer.end(); ++i) {
-        GadgetMessageWriter* w =
-        controller_->load_dll_component<GadgetMessageWriter>(i->dll.c_str(),
-        i->classname.c_str());
-        if (!w) {
-          GERROR("Failed to load GadgetMessageWriter from DLL\n");
+        if (!dcon) {
           return GADGET_FAIL;
         }
-        con->register_writer(i->slot, w);
-      }
 
+        bool started = false;
+        scheduler_mtx_.acquire();
+        if (!dcon->finished_) {
+          DistributedJob job;
+          job.node = me;
+          job.cost = cost;
+          jobs_[dcon] = job;
+          scheduler_->job_started(me, cost);
+          started = true;
+        }
+        scheduler_mtx_.release();
 
-      char buffer[10];
-      sprintf(buffer,"%d",me.port);
-      if (con->open(me.address,std::string(buffer)) != 0) {
-        GERROR("Failed to open connection to node %s : %d\n", me.address.c_str(), me.port);
-        return GADGET_FAIL;
+        if (!started) {
+          GWARN("Compute node %s closed the connection before the job was started\n", me.address.c_str());
+          release_connector(dcon);
+          dcon = 0;
+        }
       }
 
-      if (con->send_gadgetron_configuration_script(node_xml_config_) != 0) {
-        GERROR("Failed to send XML configuration to compute node\n");
+      if (!dcon) {
+        GERROR("No open connection to compute node %s for the job\n", me.address.c_str());
         return GADGET_FAIL;
       }
 
-      if (con->send_gadgetron_parameters(node_parameters_) != 0) {
-        GERROR("Failed to send XML parameters to compute node\n");
-        return GADGET_FAIL;
-      }
-      
+      con = dcon;
+
       mtx_.acquire();
       node_map_[node_index] = con;
       mtx_.release();
@@ -265,6 +375,12 @@ namespace Gadgetron{
     started_nodes_ = 0;
     node_parameters_ = std::string(m->rd_ptr());
 
+    scheduler_.reset(DistributeScheduler::create(scheduler.value()));
+    if (!scheduler_) {
+      GERROR("Unknown scheduler %s\n", scheduler.value().c_str());
+      return GADGET_FAIL;
+    }
+
     //Grab the original XML conifguration
     std::string xml = controller_->get_xml_configuration();
 
@@ -321,6 +437,19 @@ namespace Gadgetron{
         GDEBUG_STREAM("--> Local address  : " << ip);
     }
 
+    //Instantiate and configure the node chains ahead of the first jobs
+    if (connection_pool_size.value() > 0) {
+      connector_pool_.open(connection_pool_size.value(), std::hash<std::string>()(node_xml_config_ + node_parameters_));
+
+      std::vector<GadgetronNodeInfo> nl;
+      CloudBus::instance()->get_node_info(nl);
+
+      for (auto it = nl.begin(); it != nl.end(); it++) {
+        if (!use_this_node_for_compute.value() && it->uuid == CloudBus::instance()->uuid()) continue;
+        connector_pool_.prewarm(it->address, it->port);
+      }
+    }
+
     return GADGET_OK;
   }
 
@@ -328,6 +457,11 @@ namespace Gadgetron{
   {
     int ret = Gadget::close(flags);
     if (flags) {
+      if (connection_pool_size.value() > 0) {
+        connector_pool_.close();
+        connector_pool_.print_stats();
+      }
+
       mtx_.acquire();
 
       for (auto n = node_map_.begin(); n != node_map_.end(); n++) {
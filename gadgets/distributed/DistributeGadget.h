@@ -4,8 +4,11 @@
 #include "Gadget.h"
 #include "gadgetron_distributed_gadgets_export.h"
 #include "GadgetronConnector.h"
+#include "DistributionConnectorPool.h"
+#include "DistributeScheduler.h"
 
 #include <complex>
+#include <memory>
 
 namespace Gadgetron{
 
@@ -17,9 +20,15 @@ namespace Gadgetron{
   public:
     DistributionConnector(DistributeGadget* g);
     virtual int process(size_t messageid, ACE_Message_Block* mb);
+    virtual int svc(void);
 
   protected:
+    friend class DistributeGadget;
+
     DistributeGadget* distribute_gadget_;
+
+    /// the remote node closed the connection before the job was registered, guarded by the scheduler mutex of the gadget
+    bool finished_;
   };
 
   class EXPORTDISTRIBUTEDGADGETS DistributeGadget : public BasicPropertyGadget
@@ -29,6 +38,18 @@ namespace Gadgetron{
     DistributeGadget();
     virtual int collector_putq(ACE_Message_Block* m);
 
+    /**
+    Opens a connection to a compute node, sends the node configuration and parameters.
+    Returns 0 if the connection could not be established.
+    */
+    virtual DistributionConnector* create_connector(const std::string& address, uint32_t port);
+
+    /// called when the remote node has finished the job of the connector
+    virtual void job_finished(DistributionConnector* con);
+
+    /// sends a close to a connector which is not used for a job, waits for it and deletes it
+    void release_connector(DistributionConnector* con);
+
   protected:
     GADGET_PROPERTY(collector, std::string,
       "Name of collection Gadget", "Collect");
@@ -38,6 +59,15 @@ namespace Gadgetron{
       "Indicates that data is distributed to one node at a time. When new node becomes active, previous receives close message.", true);
     GADGET_PROPERTY(use_this_node_for_compute, bool,
       "This node can also be used for computation", true);
+    GADGET_PROPERTY(connection_pool_size, size_t,
+      "Number of pre-warmed connections kept per compute node, 0 means connections are opened on demand", 0);
+    GADGET_PROPERTY_LIMITS(scheduler, std::string,
+      "Selection of the compute node for a new job", "least_active",
+      GadgetPropertyLimitsEnumeration,
+      "least_active",
+      "weighted_least_load",
+      "power_of_two_choices",
+      "work_stealing");
 
     virtual int process(ACE_Message_Block* m);
     virtual int process_config(ACE_Message_Block* m);
@@ -59,6 +89,15 @@ namespace Gadgetron{
       return 0; //This is an invalid ID.
     }
 
+    /**
+    Returns the estimated cost of the job starting with this message,
+    relative to the other jobs, e.g. the number of samples.
+    */
+    virtual double job_cost(ACE_Message_Block* m)
+    {
+      return 1.0;
+    }
+
     const char* get_node_xml_config();
 
     Gadget* collect_gadget_;
@@ -66,6 +105,22 @@ namespace Gadgetron{
     size_t started_nodes_;
     ACE_Thread_Mutex mtx_;
 
+    /// guards the loading of readers and writers, connections are opened from the pool thread too
+    ACE_Thread_Mutex connector_mtx_;
+
+    struct DistributedJob
+    {
+      GadgetronNodeInfo node;
+      double cost;
+    };
+
+    /// the jobs are finished on the connector threads
+    ACE_Thread_Mutex scheduler_mtx_;
+    std::unique_ptr<DistributeScheduler> scheduler_;
+    std::map<GadgetronConnector*, DistributedJob> jobs_;
+
+    DistributionConnectorPool connector_pool_;
+
   private:
     std::string node_xml_config_;
     std::string node_parameters_;
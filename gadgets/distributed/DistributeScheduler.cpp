@@ -0,0 +1,166 @@
+#include "DistributeScheduler.h"
+
+#include <sstream>
+
+namespace Gadgetron{
+
+  DistributeScheduler::DistributeScheduler()
+  : started_cost_(0)
+  , started_jobs_(0)
+  {
+  }
+
+  DistributeScheduler::~DistributeScheduler()
+  {
+  }
+
+  std::string DistributeScheduler::node_key(const GadgetronNodeInfo& node)
+  {
+    std::stringstream key;
+    key << node.address << ":" << node.port;
+    return key.str();
+  }
+
+  void DistributeScheduler::job_started(const GadgetronNodeInfo& node, double job_cost)
+  {
+    NodeWork& w = outstanding_[node_key(node)];
+    w.jobs++;
+    w.cost += job_cost;
+
+    started_jobs_++;
+    started_cost_ += job_cost;
+  }
+
+  void DistributeScheduler::job_finished(const GadgetronNodeInfo& node, double job_cost)
+  {
+    auto it = outstanding_.find(node_key(node));
+    if (it == outstanding_.end()) return;
+
+    if (it->second.jobs > 0) it->second.jobs--;
+    it->second.cost -= job_cost;
+    if (it->second.jobs == 0 || it->second.cost < 0) it->second.cost = 0;
+  }
+
+  double DistributeScheduler::estimated_finish(const GadgetronNodeInfo& node, double job_cost)
+  {
+    NodeWork own;
+    auto it = outstanding_.find(node_key(node));
+    if (it != outstanding_.end()) own = it->second;
+
+    double average_cost = (started_jobs_ > 0) ? started_cost_ / started_jobs_ : job_cost;
+    if (average_cost <= 0) average_cost = 1;
+
+    double foreign = (node.active_reconstructions > own.jobs) ? (double)(node.active_reconstructions - own.jobs) : 0;
+    double capability = (node.compute_capability > 0) ? (double)node.compute_capability : 1.0;
+
+    return (own.cost + foreign*average_cost + job_cost) / capability;
+  }
+
+  bool DistributeScheduler::less_loaded(const GadgetronNodeInfo& a, const GadgetronNodeInfo& b, double job_cost)
+  {
+    double fa = estimated_finish(a, job_cost);
+    double fb = estimated_finish(b, job_cost);
+
+    if (fa < fb) return true;
+    if (fa > fb) return false;
+
+    //Same estimate, the queue length tells which node is behind
+    return a.queue_length < b.queue_length;
+  }
+
+  DistributeScheduler* DistributeScheduler::create(const std::string& name)
+  {
+    if (name == "least_active") {
+      return new LeastActiveScheduler();
+    } else if (name == "weighted_least_load") {
+      return new WeightedLeastLoadScheduler();
+    } else if (name == "power_of_two_choices") {
+      return new PowerOfTwoChoicesScheduler();
+    } else if (name == "work_stealing") {
+      return new WorkStealingScheduler();
+    }
+
+    return 0;
+  }
+
+  int LeastActiveScheduler::select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost)
+  {
+    int selected = -1;
+    for (size_t n = 0; n < nodes.size(); n++) {
+      if (selected < 0 || nodes[n].active_reconstructions < nodes[selected].active_reconstructions) {
+        selected = (int)n;
+      }
+
+      //Is this a free node
+      if (nodes[selected].active_reconstructions == 0) break;
+    }
+
+    return selected;
+  }
+
+  int WeightedLeastLoadScheduler::select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost)
+  {
+    int selected = -1;
+    for (size_t n = 0; n < nodes.size(); n++) {
+      if (selected < 0 || less_loaded(nodes[n], nodes[selected], job_cost)) {
+        selected = (int)n;
+      }
+    }
+
+    return selected;
+  }
+
+  PowerOfTwoChoicesScheduler::PowerOfTwoChoicesScheduler(unsigned int seed)
+  : rng_(seed)
+  {
+  }
+
+  int PowerOfTwoChoicesScheduler::select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost)
+  {
+    if (nodes.empty()) return -1;
+    if (nodes.size() == 1) return 0;
+
+    std::uniform_int_distribution<size_t> first(0, nodes.size() - 1);
+    std::uniform_int_distribution<size_t> second(0, nodes.size() - 2);
+
+    size_t a = first(rng_);
+    size_t b = second(rng_);
+    if (b >= a) b++;
+
+    return less_loaded(nodes[b], nodes[a], job_cost) ? (int)b : (int)a;
+  }
+
+  bool WorkStealingScheduler::is_idle(const GadgetronNodeInfo& node)
+  {
+    auto it = outstanding_.find(node_key(node));
+    size_t own = (it != outstanding_.end()) ? it->second.jobs : 0;
+    return (own == 0 && node.active_reconstructions == 0 && node.queue_length == 0);
+  }
+
+  int WorkStealingScheduler::select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost)
+  {
+    if (nodes.empty()) return -1;
+
+    size_t n;
+    size_t home = 0;
+    double total = 0;
+    for (n = 0; n < nodes.size(); n++) {
+      double capability = (nodes[n].compute_capability > 0) ? (double)nodes[n].compute_capability : 1.0;
+      double& w = current_weight_[node_key(nodes[n])];
+      w += capability;
+      total += capability;
+      if (w > current_weight_[node_key(nodes[home])]) home = n;
+    }
+    current_weight_[node_key(nodes[home])] -= total;
+
+    if (is_idle(nodes[home])) return (int)home;
+
+    int thief = -1;
+    for (n = 0; n < nodes.size(); n++) {
+      if (!is_idle(nodes[n])) continue;
+      if (thief < 0 || nodes[n].compute_capability > nodes[thief].compute_capability) thief = (int)n;
+    }
+
+    return (thief >= 0) ? thief : (int)home;
+  }
+}
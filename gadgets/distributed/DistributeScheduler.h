@@ -0,0 +1,106 @@
+#ifndef DISTRIBUTESCHEDULER_H
+#define DISTRIBUTESCHEDULER_H
+
+#include "gadgetron_distributed_gadgets_export.h"
+#include "cloudbus_io.h"
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Gadgetron{
+
+  /**
+  Selects the compute node for a job of the DistributeGadget.
+
+  The node information published through the CloudBus is updated with a delay, so the
+  scheduler also keeps track of the jobs it has sent itself. Job costs are relative,
+  e.g. the number of samples of the job.
+  */
+  class EXPORTDISTRIBUTEDGADGETS DistributeScheduler
+  {
+  public:
+    DistributeScheduler();
+    virtual ~DistributeScheduler();
+
+    /**
+    Returns the index of the node to run a job of the estimated cost on,
+    -1 if the list of nodes is empty.
+    */
+    virtual int select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost) = 0;
+
+    virtual void job_started(const GadgetronNodeInfo& node, double job_cost);
+    virtual void job_finished(const GadgetronNodeInfo& node, double job_cost);
+
+    /**
+    Creates "least_active", "weighted_least_load", "power_of_two_choices" or "work_stealing".
+    Returns 0 for an unknown name.
+    */
+    static DistributeScheduler* create(const std::string& name);
+
+  protected:
+
+    struct NodeWork
+    {
+      NodeWork() : jobs(0), cost(0) {}
+      size_t jobs;
+      double cost;
+    };
+
+    std::string node_key(const GadgetronNodeInfo& node);
+
+    /// estimated time until the node has finished its current work and a new job of job_cost
+    /// the reconstructions not sent by this scheduler are counted with the average job cost
+    double estimated_finish(const GadgetronNodeInfo& node, double job_cost);
+
+    /// true if a is a better choice than b for a job of job_cost
+    bool less_loaded(const GadgetronNodeInfo& a, const GadgetronNodeInfo& b, double job_cost);
+
+    std::map<std::string, NodeWork> outstanding_;
+    double started_cost_;
+    size_t started_jobs_;
+  };
+
+  /// The node with the least active reconstructions, the policy used before the schedulers were pluggable
+  class EXPORTDISTRIBUTEDGADGETS LeastActiveScheduler : public DistributeScheduler
+  {
+  public:
+    virtual int select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost);
+  };
+
+  /// The node with the earliest estimated finish, the work is weighted by the compute capability
+  class EXPORTDISTRIBUTEDGADGETS WeightedLeastLoadScheduler : public DistributeScheduler
+  {
+  public:
+    virtual int select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost);
+  };
+
+  /// The less loaded of two random nodes, avoids that several distributors herd on the same node
+  class EXPORTDISTRIBUTEDGADGETS PowerOfTwoChoicesScheduler : public DistributeScheduler
+  {
+  public:
+    PowerOfTwoChoicesScheduler(unsigned int seed = 5489u);
+    virtual int select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost);
+
+  protected:
+    std::mt19937 rng_;
+  };
+
+  /**
+  Jobs are assigned to a home node by a round robin weighted with the compute capability.
+  If the home node is busy, an idle node steals the job; of several idle nodes the most capable one.
+  */
+  class EXPORTDISTRIBUTEDGADGETS WorkStealingScheduler : public DistributeScheduler
+  {
+  public:
+    virtual int select_node(const std::vector<GadgetronNodeInfo>& nodes, double job_cost);
+
+  protected:
+    bool is_idle(const GadgetronNodeInfo& node);
+
+    /// smooth weighted round robin, the current weight of every node
+    std::map<std::string, double> current_weight_;
+  };
+}
+#endif //DISTRIBUTESCHEDULER_H
@@ -0,0 +1,216 @@
+#include "DistributionConnectorPool.h"
+#include "DistributeGadget.h"
+
+#include <chrono>
+#include <sstream>
+#include <vector>
+
+namespace Gadgetron{
+
+  DistributionConnectorPool::DistributionConnectorPool(DistributeGadget* g)
+  : distribute_gadget_(g)
+  , pool_size_(0)
+  , config_hash_(0)
+  , running_(false)
+  {
+  }
+
+  DistributionConnectorPool::~DistributionConnectorPool()
+  {
+    this->close();
+  }
+
+  std::string DistributionConnectorPool::node_key(const std::string& address, uint32_t port)
+  {
+    std::stringstream key;
+    key << address << ":" << port << ":" << config_hash_;
+    return key.str();
+  }
+
+  void DistributionConnectorPool::open(size_t pool_size, size_t config_hash)
+  {
+    if (running_ && config_hash == config_hash_ && pool_size == pool_size_) return;
+
+    //The pooled chains were configured for a different configuration
+    this->close();
+
+    pool_size_ = pool_size;
+    config_hash_ = config_hash;
+
+    if (pool_size_ == 0) return;
+
+    running_ = true;
+    worker_ = std::thread(&DistributionConnectorPool::warm_up, this);
+  }
+
+  void DistributionConnectorPool::close()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (!running_) return;
+      running_ = false;
+      requests_.clear();
+    }
+
+    request_condition_.notify_all();
+    if (worker_.joinable()) worker_.join();
+
+    std::map<std::string, std::deque<DistributionConnector*> > idle;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      idle.swap(idle_);
+      pending_.clear();
+    }
+
+    for (auto n = idle.begin(); n != idle.end(); n++) {
+      for (auto c = n->second.begin(); c != n->second.end(); c++) {
+        close_connector(*c);
+      }
+    }
+  }
+
+  void DistributionConnectorPool::close_connector(DistributionConnector* con)
+  {
+    auto m1 = new GadgetContainerMessage<GadgetMessageIdentifier>();
+    m1->getObjectPtr()->id = GADGET_MESSAGE_CLOSE;
+
+    if (con->putq(m1) == -1) {
+      GERROR("Unable to put CLOSE package on queue of pooled connection\n");
+      m1->release();
+    }
+
+    con->wait();
+    delete con;
+  }
+
+  DistributionConnector* DistributionConnectorPool::acquire(const std::string& address, uint32_t port)
+  {
+    DistributionConnector* con = 0;
+    std::vector<DistributionConnector*> stale;
+
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      auto n = idle_.find(node_key(address, port));
+      while (n != idle_.end() && !n->second.empty() && !con) {
+        con = n->second.front();
+        n->second.pop_front();
+
+        //The reader thread exits when the remote node drops the connection
+        if (con->thr_count() == 0) {
+          stats_.stale_connections++;
+          stale.push_back(con);
+          con = 0;
+        }
+      }
+
+      if (con) {
+        stats_.warm_hits++;
+      } else {
+        stats_.cold_misses++;
+      }
+    }
+
+    for (auto c = stale.begin(); c != stale.end(); c++) close_connector(*c);
+
+    if (!con) {
+      auto start = std::chrono::steady_clock::now();
+      con = distribute_gadget_->create_connector(address, port);
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+      std::lock_guard<std::mutex> lock(mtx_);
+      stats_.cold_connect_time_ms += elapsed.count();
+      if (!con) stats_.failed_connections++;
+    }
+
+    //Replenish for the next job on this node
+    if (con) this->prewarm(address, port);
+
+    return con;
+  }
+
+  void DistributionConnectorPool::prewarm(const std::string& address, uint32_t port)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (!running_) return;
+
+      std::string key = node_key(address, port);
+      size_t available = idle_[key].size() + pending_[key];
+
+      for (; available < pool_size_; available++) {
+        NodeRequest r;
+        r.address = address;
+        r.port = port;
+        requests_.push_back(r);
+        pending_[key]++;
+      }
+    }
+
+    request_condition_.notify_one();
+  }
+
+  size_t DistributionConnectorPool::idle_connections(const std::string& address, uint32_t port)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto n = idle_.find(node_key(address, port));
+    return (n == idle_.end()) ? 0 : n->second.size();
+  }
+
+  DistributionConnectorPoolStats DistributionConnectorPool::get_stats()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return stats_;
+  }
+
+  void DistributionConnectorPool::print_stats()
+  {
+    DistributionConnectorPoolStats s = this->get_stats();
+
+    GINFO("Connection pool: %zu warm hits, %zu cold misses, %zu warmed, %zu failed, %zu stale\n",
+      s.warm_hits, s.cold_misses, s.connections_warmed, s.failed_connections, s.stale_connections);
+
+    GINFO("Connection pool: %f ms spent warming up, %f ms waited for on demand connections\n",
+      s.warm_up_time_ms, s.cold_connect_time_ms);
+  }
+
+  void DistributionConnectorPool::warm_up()
+  {
+    while (true) {
+      NodeRequest r;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        request_condition_.wait(lock, [this]{ return !running_ || !requests_.empty(); });
+        if (!running_) return;
+
+        r = requests_.front();
+        requests_.pop_front();
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      DistributionConnector* con = distribute_gadget_->create_connector(r.address, r.port);
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+      std::unique_lock<std::mutex> lock(mtx_);
+
+      std::string key = node_key(r.address, r.port);
+      if (pending_[key] > 0) pending_[key]--;
+      stats_.warm_up_time_ms += elapsed.count();
+
+      if (!con) {
+        //Do not retry, the node is asked again when the next job is sent to it
+        stats_.failed_connections++;
+        continue;
+      }
+
+      stats_.connections_warmed++;
+
+      if (!running_) {
+        lock.unlock();
+        close_connector(con);
+        return;
+      }
+
+      idle_[key].push_back(con);
+    }
+  }
+}
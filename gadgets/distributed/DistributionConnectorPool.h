@@ -0,0 +1,103 @@
+#ifndef DISTRIBUTIONCONNECTORPOOL_H
+#define DISTRIBUTIONCONNECTORPOOL_H
+
+#include "gadgetron_distributed_gadgets_export.h"
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Gadgetron{
+
+  class DistributeGadget;
+  class DistributionConnector;
+
+  struct DistributionConnectorPoolStats
+  {
+    DistributionConnectorPoolStats()
+    : warm_hits(0)
+    , cold_misses(0)
+    , connections_warmed(0)
+    , failed_connections(0)
+    , stale_connections(0)
+    , warm_up_time_ms(0)
+    , cold_connect_time_ms(0)
+    {
+    }
+
+    size_t warm_hits;           ///< jobs served by a pre-warmed connection
+    size_t cold_misses;         ///< jobs which had to connect on demand
+    size_t connections_warmed;  ///< connections opened in the background
+    size_t failed_connections;  ///< connections which could not be opened
+    size_t stale_connections;   ///< pre-warmed connections dropped by the remote node before use
+    double warm_up_time_ms;     ///< total time spent opening connections in the background
+    double cold_connect_time_ms;///< total time jobs waited for on demand connections
+  };
+
+  /**
+  Pool of pre-warmed connections to the compute nodes of a DistributeGadget.
+
+  A remote Gadgetron closes its stream when a job ends, so every job needs its own
+  connection and chain. The pool hides the connection and chain instantiation latency
+  by opening connections in the background, sending the node configuration and parameters
+  ahead of time, so the remote chain is instantiated and configured before the job arrives.
+  Connections are keyed by node address, port and a hash of the node configuration.
+  */
+  class EXPORTDISTRIBUTEDGADGETS DistributionConnectorPool
+  {
+  public:
+    DistributionConnectorPool(DistributeGadget* g);
+    virtual ~DistributionConnectorPool();
+
+    /// starts the background thread; pool_size idle connections are kept per node
+    /// config_hash identifies the configuration and parameters sent to the nodes
+    void open(size_t pool_size, size_t config_hash);
+
+    /// stops the background thread and closes the idle connections
+    void close();
+
+    /// returns a connection to the node, pre-warmed if available, otherwise opened on demand
+    /// the pool is replenished in the background; returns 0 if the connection cannot be opened
+    DistributionConnector* acquire(const std::string& address, uint32_t port);
+
+    /// requests the background thread to fill the pool for the node
+    void prewarm(const std::string& address, uint32_t port);
+
+    /// number of idle pre-warmed connections to the node
+    size_t idle_connections(const std::string& address, uint32_t port);
+
+    DistributionConnectorPoolStats get_stats();
+    void print_stats();
+
+  protected:
+
+    struct NodeRequest
+    {
+      std::string address;
+      uint32_t port;
+    };
+
+    std::string node_key(const std::string& address, uint32_t port);
+    void close_connector(DistributionConnector* con);
+    void warm_up();
+
+    DistributeGadget* distribute_gadget_;
+    size_t pool_size_;
+    size_t config_hash_;
+
+    std::map<std::string, std::deque<DistributionConnector*> > idle_;
+    std::map<std::string, size_t> pending_;
+    std::deque<NodeRequest> requests_;
+    DistributionConnectorPoolStats stats_;
+
+    bool running_;
+    std::thread worker_;
+    std::mutex mtx_;
+    std::condition_variable request_condition_;
+  };
+}
+#endif //DISTRIBUTIONCONNECTORPOOL_H
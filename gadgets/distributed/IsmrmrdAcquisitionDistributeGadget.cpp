@@ -1,8 +1,35 @@
 #include "IsmrmrdAcquisitionDistributeGadget.h"
 #include "GadgetMRIHeaders.h"
+#include <ismrmrd/xml.h>
+#include <algorithm>
 
 namespace Gadgetron{
 
+  int IsmrmrdAcquisitionDistributeGadget::process_config(ACE_Message_Block* m)
+  {
+    encoding_lines_ = 1;
+
+    try {
+      ISMRMRD::IsmrmrdHeader h;
+      ISMRMRD::deserialize(m->rd_ptr(), h);
+
+      if (h.encoding.size() > 0) {
+        size_t E1 = h.encoding[0].encodedSpace.matrixSize.y;
+        size_t E2 = h.encoding[0].encodedSpace.matrixSize.z;
+
+        std::string parallel_dimension_local = parallel_dimension.value();
+        if (parallel_dimension_local.compare("kspace_encode_step_1") == 0) E1 = 1;
+        if (parallel_dimension_local.compare("kspace_encode_step_2") == 0) E2 = 1;
+
+        encoding_lines_ = std::max(E1, (size_t)1) * std::max(E2, (size_t)1);
+      }
+    } catch (...) {
+      GWARN("Unable to read the encoding from the header, all jobs are assumed to have the same cost\n");
+    }
+
+    return DistributeGadget::process_config(m);
+  }
+
   int IsmrmrdAcquisitionDistributeGadget::node_index(ACE_Message_Block* m)
   {
     auto h = AsContainerMessage<ISMRMRD::AcquisitionHeader>(m);
@@ -62,6 +89,14 @@ namespace Gadgetron{
     return GADGET_MESSAGE_ISMRMRD_ACQUISITION;
   }
 
+  double IsmrmrdAcquisitionDistributeGadget::job_cost(ACE_Message_Block* m)
+  {
+    auto h = AsContainerMessage<ISMRMRD::AcquisitionHeader>(m);
+    if (!h) return 1.0;
+
+    return (double)h->getObjectPtr()->number_of_samples * h->getObjectPtr()->active_channels * encoding_lines_ / 1e6;
+  }
+
   GADGET_FACTORY_DECLARE(IsmrmrdAcquisitionDistributeGadget)
 
 }
@@ -14,7 +14,7 @@ namespace Gadgetron{
   {
   public:
     GADGET_DECLARE(IsmrmrdAcquisitionDistributeGadget);
-    IsmrmrdAcquisitionDistributeGadget() {}
+    IsmrmrdAcquisitionDistributeGadget() : encoding_lines_(1) {}
     virtual ~IsmrmrdAcquisitionDistributeGadget() {}
 
   protected:
@@ -40,9 +40,16 @@ namespace Gadgetron{
       "user_7");
 
 
+      virtual int process_config(ACE_Message_Block* m);
       virtual int node_index(ACE_Message_Block* m);
       virtual int message_id(ACE_Message_Block* m);
 
+      /// samples of the job in millions, from the encoding matrix and the first acquisition
+      virtual double job_cost(ACE_Message_Block* m);
+
+      /// number of acquisitions per job
+      size_t encoding_lines_;
+
     };
   }
 #endif //ISMRMRDACQUISITIONDISTRIBUTEGADGET_H
@@ -40,6 +40,15 @@ namespace Gadgetron{
     return GADGET_MESSAGE_ISMRMRD_IMAGE;
   }
 
+  double IsmrmrdImageDistributeGadget::job_cost(ACE_Message_Block* m)
+  {
+    auto h = AsContainerMessage<ISMRMRD::ImageHeader>(m);
+    if (!h) return 1.0;
+
+    ISMRMRD::ImageHeader& hdr = *h->getObjectPtr();
+    return (double)hdr.matrix_size[0] * hdr.matrix_size[1] * hdr.matrix_size[2] * hdr.channels / 1e6;
+  }
+
   GADGET_FACTORY_DECLARE(IsmrmrdImageDistributeGadget)
 
 }
@@ -30,6 +30,9 @@ namespace Gadgetron{
 
     virtual int node_index(ACE_Message_Block* m);
     virtual int message_id(ACE_Message_Block* m);
+
+    /// pixels of the image in millions
+    virtual double job_cost(ACE_Message_Block* m);
   };
 }
 #endif //ISMRMRDIMAGEDISTRIBUTEGADGET_H
@@ -0,0 +1,578 @@
+#include "GrappaCalibrationService.h"
+
+#include "hoNDFFT.h"
+#include "hoNDArray_elemwise.h"
+#include "mri_core_grappa.h"
+#include "mri_core_coil_map_estimation.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Gadgetron{
+
+bool GrappaCalibrationService::Key::operator<(const Key& k) const
+{
+  if (hash != k.hash) return hash < k.hash;
+  if (dimensions != k.dimensions) return dimensions < k.dimensions;
+  if (sampled_region != k.sampled_region) return sampled_region < k.sampled_region;
+  if (acceleration_factor != k.acceleration_factor) return acceleration_factor < k.acceleration_factor;
+  if (uncombined_channels != k.uncombined_channels) return uncombined_channels < k.uncombined_channels;
+  return target_coils < k.target_coils;
+}
+
+bool GrappaCalibrationService::Key::operator==(const Key& k) const
+{
+  return hash == k.hash
+    && dimensions == k.dimensions
+    && sampled_region == k.sampled_region
+    && acceleration_factor == k.acceleration_factor
+    && uncombined_channels == k.uncombined_channels
+    && target_coils == k.target_coils;
+}
+
+GrappaCalibrationService* GrappaCalibrationService::instance()
+{
+  static GrappaCalibrationService service;
+  return &service;
+}
+
+GrappaCalibrationService::GrappaCalibrationService()
+  : number_of_threads_(2)
+  , stop_(false)
+  , sequence_(0)
+  , cache_size_(16)
+  , cache_hits_(0)
+  , joined_(0)
+  , calibrations_(0)
+{
+  // the calibration itself uses OpenMP, a few jobs at once are enough to keep the cores busy
+  size_t cores = std::thread::hardware_concurrency();
+  if (cores > 4) number_of_threads_ = cores / 4;
+  if (number_of_threads_ > 8) number_of_threads_ = 8;
+}
+
+GrappaCalibrationService::~GrappaCalibrationService()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  queue_cond_.notify_all();
+
+  for (size_t i = 0; i < threads_.size(); i++) {
+    if (threads_[i].joinable()) threads_[i].join();
+  }
+}
+
+void GrappaCalibrationService::set_number_of_threads(size_t n)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  number_of_threads_ = (n < 1) ? 1 : n;
+}
+
+size_t GrappaCalibrationService::get_number_of_threads()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return number_of_threads_;
+}
+
+void GrappaCalibrationService::set_cache_size(size_t n)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  cache_size_ = n;
+  while (cache_.size() > cache_size_) cache_.pop_back();
+}
+
+size_t GrappaCalibrationService::get_cache_size()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return cache_size_;
+}
+
+size_t GrappaCalibrationService::get_number_of_cache_hits()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return cache_hits_;
+}
+
+size_t GrappaCalibrationService::get_number_of_joined()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return joined_;
+}
+
+size_t GrappaCalibrationService::get_number_of_calibrations()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return calibrations_;
+}
+
+unsigned long long GrappaCalibrationService::hash(const hoNDArray< std::complex<float> >& a)
+{
+  // FNV-1a over 64 bit words, four independent lanes so that the multiplications overlap
+  const unsigned long long prime = 1099511628211ULL;
+  unsigned long long h[4] = { 14695981039346656037ULL, 14695981039346656037ULL ^ 1, 14695981039346656037ULL ^ 2, 14695981039346656037ULL ^ 3 };
+
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(a.begin());
+  size_t bytes = a.get_number_of_bytes();
+  size_t words = bytes / 8;
+
+  size_t n;
+  for (n = 0; n + 4 <= words; n += 4) {
+    for (size_t l = 0; l < 4; l++) {
+      unsigned long long w;
+      memcpy(&w, p + 8*(n+l), 8);
+      h[l] = (h[l] ^ w) * prime;
+    }
+  }
+
+  for (; n < words; n++) {
+    unsigned long long w;
+    memcpy(&w, p + 8*n, 8);
+    h[0] = (h[0] ^ w) * prime;
+  }
+
+  for (size_t b = 8*words; b < bytes; b++) {
+    h[1] = (h[1] ^ p[b]) * prime;
+  }
+
+  unsigned long long r = bytes;
+  for (size_t l = 0; l < 4; l++) {
+    r = (r ^ h[l]) * prime;
+    r ^= r >> 29;
+  }
+
+  return r;
+}
+
+void GrappaCalibrationService::start_threads()
+{
+  while (threads_.size() < number_of_threads_) {
+    threads_.push_back(std::thread(&GrappaCalibrationService::svc, this));
+  }
+}
+
+int GrappaCalibrationService::submit(hoNDArray< std::complex<float> >* ref_data,
+				     const std::vector< std::pair<unsigned int, unsigned int> >& sampled_region,
+				     unsigned int acceleration_factor,
+				     const std::list<unsigned int>& uncombined_channels,
+				     int target_coils,
+				     boost::shared_ptr< GrappaWeights<float> > destination,
+				     int priority)
+{
+  if (!ref_data || !destination) {
+    return -1;
+  }
+
+  Key key;
+  key.hash = hash(*ref_data);
+  ref_data->get_dimensions(key.dimensions);
+  key.sampled_region = sampled_region;
+  key.acceleration_factor = acceleration_factor;
+  key.uncombined_channels = uncombined_channels;
+  key.target_coils = target_coils;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  Destination d;
+  d.weights = destination;
+  d.sequence = ++sequence_;
+
+  // an older queued calibration for the destination is not needed any more
+  for (std::list<JobPtr>::iterator it = jobs_.begin(); it != jobs_.end(); ) {
+    JobPtr job = *it;
+    if (!job->running && !(job->key == key)) {
+      std::vector<Destination>& dst = job->destinations;
+      for (size_t i = 0; i < dst.size(); ) {
+        if (dst[i].weights.get() == destination.get()) dst.erase(dst.begin() + i);
+        else i++;
+      }
+
+      if (dst.empty()) {
+        it = jobs_.erase(it);
+        continue;
+      }
+    }
+    it++;
+  }
+
+  ResultPtr cached = cache_find(key);
+  if (cached) {
+    cache_hits_++;
+    deliver(cached, std::vector<Destination>(1, d));
+    release(destination.get());
+    lock.unlock();
+    done_cond_.notify_all();
+    return 0;
+  }
+
+  for (std::list<JobPtr>::iterator it = jobs_.begin(); it != jobs_.end(); it++) {
+    if ((*it)->key == key) {
+      std::vector<Destination>& dst = (*it)->destinations;
+
+      size_t i;
+      for (i = 0; i < dst.size(); i++) {
+        if (dst[i].weights.get() == destination.get()) {
+          dst[i].sequence = d.sequence;
+          break;
+        }
+      }
+      if (i == dst.size()) dst.push_back(d);
+
+      (*it)->priority = std::max((*it)->priority, priority);
+      joined_++;
+      return 0;
+    }
+  }
+
+  JobPtr job(new Job);
+  job->key = key;
+  job->priority = priority;
+  job->submitted = d.sequence;
+  job->running = false;
+  job->destinations.push_back(d);
+
+  // the copy is made under the lock, the caller reuses its buffer
+  try {
+    job->acs = ResultPtr(new hoNDArray< std::complex<float> >(*ref_data));
+  }
+  catch (std::runtime_error& err) {
+    GEXCEPTION(err, "Unable to copy the GRAPPA calibration data");
+    release(destination.get());
+    return -2;
+  }
+
+  jobs_.push_back(job);
+  start_threads();
+
+  lock.unlock();
+  queue_cond_.notify_one();
+
+  return 0;
+}
+
+void GrappaCalibrationService::wait(const GrappaWeights<float>* destination)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  done_cond_.wait(lock, [&]() {
+    for (std::list<JobPtr>::const_iterator it = jobs_.begin(); it != jobs_.end(); it++) {
+      for (size_t i = 0; i < (*it)->destinations.size(); i++) {
+        if ((*it)->destinations[i].weights.get() == destination) return false;
+      }
+    }
+    return true;
+  });
+}
+
+void GrappaCalibrationService::svc()
+{
+  while (true) {
+    JobPtr job;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+
+      // the highest priority first, the oldest submission among them
+      std::list<JobPtr>::iterator next;
+      queue_cond_.wait(lock, [&]() {
+        if (stop_) return true;
+        next = jobs_.end();
+        for (std::list<JobPtr>::iterator it = jobs_.begin(); it != jobs_.end(); it++) {
+          if ((*it)->running) continue;
+          if (next == jobs_.end() || (*it)->priority > (*next)->priority) next = it;
+        }
+        return next != jobs_.end();
+      });
+
+      if (stop_) return;
+
+      job = *next;
+      job->running = true;
+    }
+
+    ResultPtr result(new hoNDArray< std::complex<float> >());
+    int ret = 0;
+
+    try {
+      hoNDArray< std::complex<float> > acs(*job->acs);
+      acs.squeeze();
+
+      ret = calibrate(acs, job->key.sampled_region, job->key.acceleration_factor, job->key.uncombined_channels, job->key.target_coils, *result);
+
+      if (ret == 0) {
+        std::vector<size_t> dims = job->key.dimensions;
+        if (job->key.uncombined_channels.size()) dims.push_back(job->key.uncombined_channels.size() + 1);
+        result->reshape(&dims);
+      }
+    }
+    catch (...) {
+      ret = -1;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      if (ret == 0) {
+        calibrations_++;
+        cache_insert(job->key, result);
+        deliver(result, job->destinations);
+      }
+      else {
+        GERROR("GRAPPA calibration failed\n");
+      }
+
+      jobs_.remove(job);
+
+      for (size_t i = 0; i < job->destinations.size(); i++) {
+        release(job->destinations[i].weights.get());
+      }
+    }
+
+    done_cond_.notify_all();
+  }
+}
+
+void GrappaCalibrationService::deliver(const ResultPtr& result, const std::vector<Destination>& destinations)
+{
+  for (size_t i = 0; i < destinations.size(); i++) {
+    const GrappaWeights<float>* w = destinations[i].weights.get();
+
+    std::map< const GrappaWeights<float>*, unsigned long long >::iterator it = delivered_.find(w);
+    if (it != delivered_.end() && it->second > destinations[i].sequence) continue;
+
+    if (destinations[i].weights->update(result.get()) < 0) {
+      GDEBUG("Update of GRAPPA weights failed\n");
+      continue;
+    }
+
+    delivered_[w] = destinations[i].sequence;
+  }
+}
+
+void GrappaCalibrationService::release(const GrappaWeights<float>* destination)
+{
+  // an older calibration still running for the destination must find the sequence of the newer delivery
+  for (std::list<JobPtr>::const_iterator it = jobs_.begin(); it != jobs_.end(); it++) {
+    for (size_t i = 0; i < (*it)->destinations.size(); i++) {
+      if ((*it)->destinations[i].weights.get() == destination) return;
+    }
+  }
+
+  delivered_.erase(destination);
+}
+
+void GrappaCalibrationService::cache_insert(const Key& key, const ResultPtr& result)
+{
+  if (cache_size_ == 0) return;
+
+  for (std::list< std::pair<Key, ResultPtr> >::iterator it = cache_.begin(); it != cache_.end(); it++) {
+    if (it->first == key) {
+      cache_.erase(it);
+      break;
+    }
+  }
+
+  cache_.push_front(std::make_pair(key, result));
+  while (cache_.size() > cache_size_) cache_.pop_back();
+}
+
+GrappaCalibrationService::ResultPtr GrappaCalibrationService::cache_find(const Key& key)
+{
+  for (std::list< std::pair<Key, ResultPtr> >::iterator it = cache_.begin(); it != cache_.end(); it++) {
+    if (it->first == key) {
+      cache_.splice(cache_.begin(), cache_, it);
+      return cache_.front().second;
+    }
+  }
+
+  return ResultPtr();
+}
+
+int GrappaCalibrationService::calibrate(const hoNDArray< std::complex<float> >& acs_in,
+					const std::vector< std::pair<unsigned int, unsigned int> >& sampled_region,
+					unsigned int acceleration_factor,
+					const std::list<unsigned int>& uncombined_channels,
+					int target_coils,
+					hoNDArray< std::complex<float> >& unmixing)
+{
+  size_t RO = acs_in.get_size(0);
+  size_t E1 = acs_in.get_size(1);
+  size_t CHA = acs_in.get_size(2);
+
+  size_t ks = 5;
+  size_t power = 3;
+
+  std::vector<size_t> data_dimensions;
+  acs_in.get_dimensions(data_dimensions);
+
+  if (uncombined_channels.size() > 0) {
+    data_dimensions.push_back(uncombined_channels.size() + 1);
+  }
+
+  try{ unmixing.create(data_dimensions); }
+  catch (std::runtime_error &err){
+    GEXCEPTION(err, "Unable to allocate host memory for unmixing coeffcients\n");
+    return -1;
+  }
+
+  hoNDArray< std::complex<float> > complex_im;
+  hoNDArray< std::complex<float> > conv_ker;
+  hoNDArray< std::complex<float> > kIm;
+  hoNDArray< std::complex<float> > coil_map;
+  hoNDArray< float > gFactor;
+
+  // compute the unmixing coefficients
+  size_t numUnCombined = uncombined_channels.size();
+
+  double thres = 0.0005;
+  size_t kRO = 5;
+  size_t kNE1 = 4;
+
+  std::list<unsigned int>::const_iterator it;
+
+  if (numUnCombined==0)
+  {
+    hoNDArray< std::complex<float> > acs(RO, E1, target_coils, const_cast< std::complex<float>* >(acs_in.begin()));
+    hoNDArray< std::complex<float> > target_acs(RO, E1, target_coils, acs.begin());
+
+    // estimate coil map
+    complex_im.create(RO, E1, target_coils);
+
+    hoNDFFT<float>::instance()->ifft2c(target_acs, complex_im);
+    Gadgetron::coil_map_2d_Inati(complex_im, coil_map, ks, power);
+
+    // compute unmixing coefficients
+    if (acceleration_factor == 1)
+    {
+      Gadgetron::conjugate(coil_map, coil_map);
+      Gadgetron::clear(unmixing);
+      memcpy(unmixing.begin(), coil_map.begin(), coil_map.get_number_of_bytes());
+    }
+    else
+    {
+      size_t startRO = sampled_region[0].first;
+      size_t endRO = sampled_region[0].second;
+
+      size_t startE1 = sampled_region[1].first;
+      size_t endE1 = sampled_region[1].second;
+
+      Gadgetron::grappa2d_calib_convolution_kernel(acs, target_acs,
+        (size_t)acceleration_factor,
+        thres, kRO, kNE1, startRO, endRO, startE1, endE1, conv_ker);
+
+      Gadgetron::grappa2d_image_domain_kernel(conv_ker, RO, E1, kIm);
+
+      Gadgetron::clear(unmixing);
+
+      Gadgetron::grappa2d_unmixing_coeff(kIm, coil_map, (size_t)acceleration_factor, unmixing, gFactor);
+    }
+  }
+  else
+  {
+    hoNDArray< std::complex<float> > acs(RO, E1, CHA, const_cast< std::complex<float>* >(acs_in.begin()));
+
+    // handle the case that all channels are reconed
+    size_t target_coils_with_uncombined = target_coils + numUnCombined;
+    if (target_coils_with_uncombined > CHA) target_coils_with_uncombined = CHA;
+
+    if (acceleration_factor == 1)
+    {
+      // if no acceleration, the input data is used for coil map estimation
+      // no need to differentiate combined and uncombined channels
+      complex_im.create(RO, E1, acs.get_size(2));
+
+      hoNDFFT<float>::instance()->ifft2c(acs, complex_im);
+
+      Gadgetron::coil_map_2d_Inati(complex_im, coil_map, ks, power);
+
+      Gadgetron::conjugate(coil_map, coil_map);
+
+      Gadgetron::clear(unmixing);
+
+      // copy back to unmixing
+      memcpy(unmixing.begin(), coil_map.begin(), sizeof(std::complex<float>)*RO*E1*CHA);
+
+      // set uncombined channels
+      size_t ind = 1;
+      for (it = uncombined_channels.begin(); it != uncombined_channels.end(); it++)
+      {
+        std::complex<float>* pUnmixing = unmixing.begin() + ind*RO*E1*CHA + (*it)*RO*E1;
+        for (size_t p = 0; p<RO*E1; p++)
+        {
+          pUnmixing[p] = 1;
+        }
+
+        ind++;
+      }
+    }
+    else
+    {
+      // first, assemble the target_acs
+      // the combined channel comes first and then all uncombined channels
+      hoNDArray< std::complex<float> > target_acs(RO, E1, target_coils_with_uncombined);
+
+      // copy first combined channels and all uncombined channels to target_acs
+      size_t sCha, ind(0), ind_uncombined(0);
+
+      for (sCha = 0; sCha<CHA; sCha++)
+      {
+        bool uncombined = false;
+        for (it = uncombined_channels.begin(); it != uncombined_channels.end(); it++)
+        {
+          if (sCha == *it)
+          {
+            uncombined = true;
+            break;
+          }
+        }
+
+        if (!uncombined)
+        {
+          if ( ind < (target_coils_with_uncombined - numUnCombined) )
+          {
+            memcpy(target_acs.begin() + ind * RO*E1, acs.begin() + sCha * RO*E1, sizeof(std::complex<float>)*RO*E1);
+            ind++;
+          }
+        }
+        else
+        {
+          memcpy(target_acs.begin() + (target_coils_with_uncombined - numUnCombined + ind_uncombined) * RO*E1, acs.begin() + sCha * RO*E1, sizeof(std::complex<float>)*RO*E1);
+          ind_uncombined++;
+        }
+      }
+
+      complex_im.create(RO, E1, target_acs.get_size(2));
+
+      hoNDFFT<float>::instance()->ifft2c(target_acs, complex_im);
+
+      Gadgetron::coil_map_2d_Inati(complex_im, coil_map, ks, power);
+
+      Gadgetron::grappa2d_calib_convolution_kernel(acs, target_acs,
+        (size_t)acceleration_factor,
+        thres, kRO, kNE1, conv_ker);
+
+      Gadgetron::grappa2d_image_domain_kernel(conv_ker, RO, E1, kIm);
+
+      // kIm stored the unwrapping coefficients as [RO E1 CHA target_coils_with_uncombined]
+      // for the target_coils_with_uncombined dimension, combined channels come first and then uncombined channels
+
+      Gadgetron::clear(unmixing);
+
+      hoNDArray< std::complex<float> > unmixing_all_channels(RO, E1, CHA, unmixing.begin());
+      Gadgetron::grappa2d_unmixing_coeff(kIm, coil_map, (size_t)acceleration_factor, unmixing_all_channels, gFactor);
+
+      // set unmixing coefficients for uncombined channels
+      ind = 1;
+      for (it = uncombined_channels.begin(); it != uncombined_channels.end(); it++)
+      {
+        memcpy(unmixing.begin() + ind*RO*E1*CHA, kIm.begin() + (target_coils_with_uncombined - numUnCombined + ind - 1)*RO*E1*CHA, sizeof(std::complex<float>)*RO*E1*CHA);
+        ind++;
+      }
+    }
+  }
+
+  return 0;
+}
+}
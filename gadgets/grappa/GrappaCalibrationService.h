@@ -0,0 +1,151 @@
+/** \file       GrappaCalibrationService.h
+    \brief      Shared CPU calibration of the GRAPPA unmixing weights for all GrappaGadget instances of the process
+
+                Calibrations are run by a pool of threads, interactive chains (e.g. interventional imaging) are served first.
+                Submissions with the same ACS and parameters are computed once: a submission identical to a queued or running one
+                joins it, and the results of recent calibrations are kept in a bounded LRU cache, so scans of the same protocol
+                and slice geometry with the same ACS do not calibrate again.
+*/
+
+#pragma once
+
+#include "gadgetron_grappa_export.h"
+#include "GrappaWeights.h"
+
+#include <boost/shared_ptr.hpp>
+#include <complex>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Gadgetron{
+
+class EXPORTGADGETSGRAPPA GrappaCalibrationService
+{
+ public:
+
+  enum Priority
+  {
+    PRIORITY_BATCH = 0,
+    PRIORITY_INTERACTIVE = 1
+  };
+
+  static GrappaCalibrationService* instance();
+
+  ~GrappaCalibrationService();
+
+  /**
+     Calibrate the weights from ref_data [RO E1 CHA], the result goes to destination.
+     A newer submission for the same destination replaces a queued older one, and the result of an older one
+     never overwrites the result of a newer one.
+  */
+  int submit(hoNDArray< std::complex<float> >* ref_data,
+	     const std::vector< std::pair<unsigned int, unsigned int> >& sampled_region,
+	     unsigned int acceleration_factor,
+	     const std::list<unsigned int>& uncombined_channels,
+	     int target_coils,
+	     boost::shared_ptr< GrappaWeights<float> > destination,
+	     int priority = PRIORITY_BATCH);
+
+  /// waits until no calibration for the destination is queued or running
+  void wait(const GrappaWeights<float>* destination);
+
+  /// the threads are started by the first submission
+  void set_number_of_threads(size_t n);
+  size_t get_number_of_threads();
+
+  /// number of calibrations kept, 0 disables the cache
+  void set_cache_size(size_t n);
+  size_t get_cache_size();
+
+  /// submissions served from the cache, joined to a queued or running calibration, and calibrations computed
+  size_t get_number_of_cache_hits();
+  size_t get_number_of_joined();
+  size_t get_number_of_calibrations();
+
+  /// the computation of the unmixing weights [RO E1 CHA sets] from the ACS [RO E1 CHA] on the calling thread
+  static int calibrate(const hoNDArray< std::complex<float> >& acs,
+		       const std::vector< std::pair<unsigned int, unsigned int> >& sampled_region,
+		       unsigned int acceleration_factor,
+		       const std::list<unsigned int>& uncombined_channels,
+		       int target_coils,
+		       hoNDArray< std::complex<float> >& unmixing);
+
+ protected:
+
+  GrappaCalibrationService();
+
+  /// the ACS content and all parameters of a calibration
+  struct Key
+  {
+    unsigned long long hash;
+    std::vector<size_t> dimensions;
+    std::vector< std::pair<unsigned int, unsigned int> > sampled_region;
+    unsigned int acceleration_factor;
+    std::list<unsigned int> uncombined_channels;
+    int target_coils;
+
+    bool operator<(const Key& k) const;
+    bool operator==(const Key& k) const;
+  };
+
+  struct Destination
+  {
+    boost::shared_ptr< GrappaWeights<float> > weights;
+    unsigned long long sequence;
+  };
+
+  struct Job
+  {
+    Key key;
+    boost::shared_ptr< hoNDArray< std::complex<float> > > acs;
+    int priority;
+    unsigned long long submitted;
+    bool running;
+    std::vector<Destination> destinations;
+  };
+
+  typedef std::shared_ptr<Job> JobPtr;
+  typedef boost::shared_ptr< hoNDArray< std::complex<float> > > ResultPtr;
+
+  static unsigned long long hash(const hoNDArray< std::complex<float> >& a);
+
+  void start_threads();
+  void svc();
+
+  /// delivers a result to the destinations which did not get the result of a newer submission, called with mutex_ held
+  void deliver(const ResultPtr& result, const std::vector<Destination>& destinations);
+
+  /// forgets the delivered sequence of a destination once no queued or running job refers to it, called with mutex_ held
+  void release(const GrappaWeights<float>* destination);
+
+  void cache_insert(const Key& key, const ResultPtr& result);
+  ResultPtr cache_find(const Key& key);
+
+  std::mutex mutex_;
+  std::condition_variable queue_cond_;
+  std::condition_variable done_cond_;
+
+  std::list<JobPtr> jobs_;
+  std::vector<std::thread> threads_;
+  size_t number_of_threads_;
+  bool stop_;
+
+  unsigned long long sequence_;
+
+  /// sequence of the newest delivered result per destination, kept while a job refers to the destination
+  std::map< const GrappaWeights<float>*, unsigned long long > delivered_;
+
+  /// most recently used first
+  std::list< std::pair<Key, ResultPtr> > cache_;
+  size_t cache_size_;
+
+  size_t cache_hits_;
+  size_t joined_;
+  size_t calibrations_;
+};
+}
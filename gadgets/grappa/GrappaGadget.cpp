@@ -1,5 +1,6 @@
 #include "GrappaGadget.h"
 #include "GrappaUnmixingGadget.h"
+#include "hoNDFFT.h"
 #include "ismrmrd/xml.h"
 
 #include <ace/OS_NS_stdlib.h>
@@ -15,6 +16,10 @@ namespace Gadgetron{
     , first_call_(true)
     , target_coils_(0)
     , use_gpu_(true)
+    , latency_sum_(0)
+    , latency_max_(0)
+    , latency_first_sum_(0)
+    , latency_count_(0)
   {
   }
 
@@ -36,6 +41,12 @@ namespace Gadgetron{
     int ret = Gadget::close(flags);
     GDEBUG("Shutting down GRAPPA Gadget\n");
 
+    if (latency_count_ > 0) {
+      GINFO("GRAPPA streaming, %zu images, readout to image latency: mean %f ms, max %f ms; first readout of an image: mean %f ms\n",
+            latency_count_, latency_sum_/latency_count_, latency_max_, latency_first_sum_/latency_count_);
+      latency_count_ = 0;
+    }
+
     if (weights_calculator_.close(flags) < 0) {
       GDEBUG("Failed to close down weights calculator\n");
       return GADGET_FAIL;
@@ -119,6 +130,7 @@ namespace Gadgetron{
     GDEBUG_STREAM("use_gpu_ is " << use_gpu_);
 
     weights_calculator_.set_use_gpu(use_gpu_);
+    weights_calculator_.set_priority(calibration_priority.value());
 
     if (device_channels.value()) {
       GDEBUG("We got the number of device channels from other gadget: %d\n", device_channels.value());
@@ -201,6 +213,11 @@ namespace Gadgetron{
 
     image_series_ = image_series.value();
 
+    if (streaming.value()) {
+      streaming_ = std::vector<GrappaStreamingSlice>(dimensions_[4]);
+      GDEBUG("GRAPPA streaming mode, %f images per second\n", streaming_frame_rate.value());
+    }
+
     return GADGET_OK;
   }
 
@@ -209,6 +226,8 @@ namespace Gadgetron{
   process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
           GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2)
   {
+      GrappaStreamingSlice::Clock::time_point arrival = GrappaStreamingSlice::Clock::now();
+
       bool is_noise = m1->getObjectPtr()->isFlagSet(ISMRMRD::ISMRMRD_ACQ_IS_NOISE_MEASUREMENT);
 
       //We should not be receiving noise here
@@ -259,6 +278,13 @@ namespace Gadgetron{
     std::complex<float>* b = image_data_[slice]->getObjectPtr()->get_data_ptr();
     std::complex<float>* d = m2->getObjectPtr()->get_data_ptr();
 
+    if (streaming.value()) {
+      if (stream_line(slice, line, partition, d, samples) != GADGET_OK) {
+        GDEBUG("Failed to update the streaming image\n");
+        return GADGET_FAIL;
+      }
+    }
+
     size_t offset= 0;
     //Copy the data for all the channels
     for (int c = 0; c < m1->getObjectPtr()->active_channels; c++) {
@@ -279,7 +305,7 @@ namespace Gadgetron{
       time_stamps_[slice] = m1->getObjectPtr()->acquisition_time_stamp;
     }
 
-    if (is_last_scan_in_slice) {
+    if (is_last_scan_in_slice && !streaming.value()) {
 
       GadgetContainerMessage<GrappaUnmixingJob>* cm0 =
         new GadgetContainerMessage<GrappaUnmixingJob>();
@@ -309,31 +335,8 @@ namespace Gadgetron{
         cm1->cont(cm2);
       */
 
-      cm1->getObjectPtr()->matrix_size[0] = image_dimensions_[0];
-      cm1->getObjectPtr()->matrix_size[1] = image_dimensions_[1];
-      cm1->getObjectPtr()->matrix_size[2] = image_dimensions_[2];
-
-      cm1->getObjectPtr()->field_of_view[0] = fov_[0];
-      cm1->getObjectPtr()->field_of_view[1] = fov_[1];
-      cm1->getObjectPtr()->field_of_view[2] = fov_[2];
-
+      set_image_header(m1->getObjectPtr(), cm1->getObjectPtr(), slice);
       cm1->getObjectPtr()->channels       = 1+weights_calculator_.get_number_of_uncombined_channels();
-      cm1->getObjectPtr()->slice              = m1->getObjectPtr()->idx.slice;
-      cm1->getObjectPtr()->acquisition_time_stamp         = time_stamps_[slice];
-
-      memcpy(cm1->getObjectPtr()->position,m1->getObjectPtr()->position,
-             sizeof(float)*3);
-
-      memcpy(cm1->getObjectPtr()->read_dir,m1->getObjectPtr()->read_dir,
-             sizeof(float)*3);
-
-      memcpy(cm1->getObjectPtr()->phase_dir,m1->getObjectPtr()->phase_dir,
-             sizeof(float)*3);
-
-      memcpy(cm1->getObjectPtr()->slice_dir,m1->getObjectPtr()->slice_dir,
-             sizeof(float)*3);
-
-      memcpy(cm1->getObjectPtr()->patient_table_position,m1->getObjectPtr()->patient_table_position, sizeof(float)*3);
 
       cm1->getObjectPtr()->image_index = ++image_counter_;
       cm1->getObjectPtr()->image_series_index = image_series_;
@@ -381,10 +384,226 @@ namespace Gadgetron{
       return GADGET_FAIL;
     }
 
+    if (streaming.value()) {
+      if (streaming_[slice].refresh_ && stream_refresh(slice) != GADGET_OK) {
+        GDEBUG("Failed to compute the streaming image\n");
+        return GADGET_FAIL;
+      }
+
+      if (stream_send(slice, acq_head, arrival) != GADGET_OK) {
+        GDEBUG("Failed to send the streaming image\n");
+        return GADGET_FAIL;
+      }
+    }
+
     m1->release();
     return GADGET_OK;
   }
 
+  void GrappaGadget::set_image_header(ISMRMRD::AcquisitionHeader* acq_head, ISMRMRD::ImageHeader* img_head, unsigned int slice)
+  {
+    img_head->matrix_size[0] = image_dimensions_[0];
+    img_head->matrix_size[1] = image_dimensions_[1];
+    img_head->matrix_size[2] = image_dimensions_[2];
+
+    img_head->field_of_view[0] = fov_[0];
+    img_head->field_of_view[1] = fov_[1];
+    img_head->field_of_view[2] = fov_[2];
+
+    img_head->slice              = acq_head->idx.slice;
+    img_head->acquisition_time_stamp         = time_stamps_[slice];
+
+    memcpy(img_head->position,acq_head->position,
+           sizeof(float)*3);
+
+    memcpy(img_head->read_dir,acq_head->read_dir,
+           sizeof(float)*3);
+
+    memcpy(img_head->phase_dir,acq_head->phase_dir,
+           sizeof(float)*3);
+
+    memcpy(img_head->slice_dir,acq_head->slice_dir,
+           sizeof(float)*3);
+
+    memcpy(img_head->patient_table_position,acq_head->patient_table_position, sizeof(float)*3);
+  }
+
+  int GrappaGadget::stream_line(unsigned int slice, unsigned int line, unsigned int partition, const std::complex<float>* data, size_t samples)
+  {
+    GrappaStreamingSlice& s = streaming_[slice];
+
+    GrappaWeights<float>::SnapshotPtr weights = weights_[slice]->get_snapshot();
+    if (weights && weights->update_count_ != s.weights_update_count_) {
+      s.weights_ = weights;
+      s.weights_update_count_ = weights->update_count_;
+      s.refresh_ = true;
+    }
+
+    size_t RO = image_dimensions_[0];
+    size_t E1 = image_dimensions_[1];
+    size_t E2 = image_dimensions_[2];
+    size_t CHA = image_dimensions_[3];
+    size_t N = RO*E1*E2;
+
+    // the image is computed from the whole k-space once the line is stored, which also removes the rounding errors of the updates
+    if (s.lines_since_refresh_ >= E1*E2) s.refresh_ = true;
+    if (s.refresh_ || s.weights_update_count_ == 0) return GADGET_OK;
+
+    size_t sets = s.image_.get_number_of_elements()/N;
+
+    // the change of the line, in image space along RO
+    hoNDArray< std::complex<float> > delta(RO, CHA);
+    const std::complex<float>* k = image_data_[slice]->getObjectPtr()->begin() + partition*RO*E1 + line*RO;
+    for (size_t c = 0; c < CHA; c++) {
+      for (size_t x = 0; x < RO; x++) {
+        delta(x, c) = data[c*samples + x] - k[c*N + x];
+      }
+    }
+    hoNDFFT<float>::instance()->ifft1c(delta);
+
+    // a line of k-space is a plane wave along E1 and E2 in the centered transform
+    std::vector< std::complex<float> > phase_y(E1), phase_z(E2);
+    double scale = 1.0/std::sqrt((double)(E1*E2));
+    for (size_t y = 0; y < E1; y++) {
+      double p = 2*M_PI*((double)line - (double)(E1/2))*((double)y - (double)(E1/2))/E1;
+      phase_y[y] = std::complex<float>(std::polar(scale, p));
+    }
+    for (size_t z = 0; z < E2; z++) {
+      double p = 2*M_PI*((double)partition - (double)(E2/2))*((double)z - (double)(E2/2))/E2;
+      phase_z[z] = std::complex<float>(std::polar(1.0, p));
+    }
+
+    const std::complex<float>* w = s.weights_->weights_.begin();
+    std::complex<float>* im = s.image_.begin();
+
+    long long n;
+#pragma omp parallel private(n) if (sets*N*CHA > 64*1024)
+    {
+      std::vector< std::complex<float> > acc(RO);
+
+#pragma omp for
+      for (n = 0; n < (long long)(sets*E1*E2); n++) {
+        size_t set = (size_t)n/(E1*E2);
+        size_t yz = (size_t)n%(E1*E2);
+
+        std::fill(acc.begin(), acc.end(), std::complex<float>(0));
+        for (size_t c = 0; c < CHA; c++) {
+          const std::complex<float>* pw = w + (set*CHA + c)*N + yz*RO;
+          const std::complex<float>* pd = delta.begin() + c*RO;
+          for (size_t x = 0; x < RO; x++) acc[x] += pw[x]*pd[x];
+        }
+
+        std::complex<float> e = phase_y[yz%E1]*phase_z[yz/E1];
+        std::complex<float>* pim = im + set*N + yz*RO;
+        for (size_t x = 0; x < RO; x++) pim[x] += e*acc[x];
+      }
+    }
+
+    s.lines_since_refresh_++;
+    return GADGET_OK;
+  }
+
+  int GrappaGadget::stream_refresh(unsigned int slice)
+  {
+    GrappaStreamingSlice& s = streaming_[slice];
+    s.refresh_ = false;
+    s.lines_since_refresh_ = 0;
+
+    if (s.weights_update_count_ == 0) return GADGET_OK;
+
+    size_t RO = image_dimensions_[0];
+    size_t E1 = image_dimensions_[1];
+    size_t E2 = image_dimensions_[2];
+    size_t CHA = image_dimensions_[3];
+    size_t N = RO*E1*E2;
+
+    if (s.weights_->weights_.get_number_of_elements() % (N*CHA)) {
+      GDEBUG("GRAPPA weights do not match the image dimensions\n");
+      return GADGET_FAIL;
+    }
+    size_t sets = s.weights_->weights_.get_number_of_elements()/(N*CHA);
+
+    hoNDArray< std::complex<float> > coil_images;
+    hoNDFFT<float>::instance()->ifft3c(*image_data_[slice]->getObjectPtr(), coil_images);
+
+    s.image_.create(RO, E1, E2, sets);
+
+    int appl_result = GrappaWeights<float>::unmix(s.weights_->weights_, coil_images, s.image_);
+    if (appl_result < 0) {
+      GDEBUG("Failed to apply GRAPPA weights: error code %d\n", appl_result);
+      return GADGET_FAIL;
+    }
+
+    return GADGET_OK;
+  }
+
+  int GrappaGadget::stream_send(unsigned int slice, ISMRMRD::AcquisitionHeader* acq_head, GrappaStreamingSlice::Clock::time_point arrival)
+  {
+    typedef GrappaStreamingSlice::Clock Clock;
+    GrappaStreamingSlice& s = streaming_[slice];
+
+    if (s.pending_lines_ == 0) s.first_pending_ = arrival;
+    s.pending_lines_++;
+
+    if (s.weights_update_count_ == 0 || s.image_.get_number_of_elements() == 0) return GADGET_OK;
+
+    Clock::time_point now = Clock::now();
+    float frame_rate = streaming_frame_rate.value();
+    if (frame_rate > 0 && s.last_sent_.time_since_epoch().count() != 0
+        && std::chrono::duration<double>(now - s.last_sent_).count() < 1.0/frame_rate) {
+      return GADGET_OK;
+    }
+
+    size_t sets = s.image_.get_size(3);
+
+    GadgetContainerMessage<ISMRMRD::ImageHeader>* cm1 = new GadgetContainerMessage<ISMRMRD::ImageHeader>();
+    GadgetContainerMessage< hoNDArray< std::complex<float> > >* cm2 = new GadgetContainerMessage< hoNDArray< std::complex<float> > >();
+    cm1->cont(cm2);
+
+    set_image_header(acq_head, cm1->getObjectPtr(), slice);
+    cm1->getObjectPtr()->channels = sets;
+    cm1->getObjectPtr()->acquisition_time_stamp = acq_head->acquisition_time_stamp;
+    cm1->getObjectPtr()->image_index = ++image_counter_;
+    cm1->getObjectPtr()->image_series_index = image_series_;
+
+    std::vector<size_t> combined_dims(image_dimensions_.begin(), image_dimensions_.begin()+3);
+    if (sets > 1) combined_dims.push_back(sets);
+
+    try {
+      cm2->getObjectPtr()->create(&combined_dims);
+    }
+    catch (std::runtime_error& err) {
+      GEXCEPTION(err, "Unable to create the streaming image");
+      cm1->release();
+      return GADGET_FAIL;
+    }
+    memcpy(cm2->getObjectPtr()->begin(), s.image_.begin(), s.image_.get_number_of_bytes());
+
+    if (this->next()->putq(cm1) < 0) {
+      GDEBUG("Failed to pass image on to next Gadget in chain\n");
+      return GADGET_FAIL;
+    }
+
+    Clock::time_point sent = Clock::now();
+    double latency = std::chrono::duration<double, std::milli>(sent - arrival).count();
+    double latency_first = std::chrono::duration<double, std::milli>(sent - s.first_pending_).count();
+
+    latency_sum_ += latency;
+    latency_first_sum_ += latency_first;
+    if (latency > latency_max_) latency_max_ = latency;
+    latency_count_++;
+
+    if (latency_count_ % 100 == 0) {
+      GDEBUG("GRAPPA streaming, %zu images, readout to image latency: mean %f ms, max %f ms; first readout of an image: mean %f ms\n",
+             latency_count_, latency_sum_/latency_count_, latency_max_, latency_first_sum_/latency_count_);
+    }
+
+    s.last_sent_ = now;
+    s.pending_lines_ = 0;
+
+    return GADGET_OK;
+  }
+
 
   int GrappaGadget::create_image_buffer(unsigned int slice)
   {
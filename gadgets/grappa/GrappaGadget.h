@@ -8,6 +8,7 @@
 #include "gadgetron_grappa_export.h"
 
 #include <ismrmrd/ismrmrd.h>
+#include <chrono>
 #include <complex>
 #include <map>
 
@@ -21,6 +22,30 @@ struct EXPORTGADGETSGRAPPA GrappaBufferInfo
   unsigned int    acceleration_factor;
 };
 
+/// state of the streaming recon of a slice
+struct EXPORTGADGETSGRAPPA GrappaStreamingSlice
+{
+  typedef std::chrono::steady_clock Clock;
+
+  GrappaStreamingSlice() : weights_update_count_(0), lines_since_refresh_(0), refresh_(false), pending_lines_(0) {}
+
+  /// the unmixing weights [RO E1 E2 CHA sets] used for the image and their update count
+  GrappaWeights<float>::SnapshotPtr weights_;
+  unsigned long long weights_update_count_;
+
+  /// the unmixed image [RO E1 E2 sets] of the rolling k-space
+  hoNDArray< std::complex<float> > image_;
+
+  /// lines added incrementally since the image was computed from the whole k-space, and whether it has to be computed again
+  size_t lines_since_refresh_;
+  bool refresh_;
+
+  /// readouts in the image which were not sent yet, and the arrival of the first one
+  size_t pending_lines_;
+  Clock::time_point first_pending_;
+  Clock::time_point last_sent_;
+};
+
 class EXPORTGADGETSGRAPPA GrappaGadget : 
 public Gadget2< ISMRMRD::AcquisitionHeader, hoNDArray< std::complex<float> > >
 {
@@ -39,6 +64,17 @@ public Gadget2< ISMRMRD::AcquisitionHeader, hoNDArray< std::complex<float> > >
 
   virtual int create_image_buffer(unsigned int slice);
 
+  virtual void set_image_header(ISMRMRD::AcquisitionHeader* acq_head, ISMRMRD::ImageHeader* img_head, unsigned int slice);
+
+  /// streaming mode: the change of a line of the rolling k-space is added to the image of the slice, before the line is stored
+  virtual int stream_line(unsigned int slice, unsigned int line, unsigned int partition, const std::complex<float>* data, size_t samples);
+
+  /// streaming mode: the image is computed from the whole rolling k-space
+  virtual int stream_refresh(unsigned int slice);
+
+  /// streaming mode: sends the image if it is due at the frame rate
+  virtual int stream_send(unsigned int slice, ISMRMRD::AcquisitionHeader* acq_head, GrappaStreamingSlice::Clock::time_point arrival);
+
   //We have to overwrite close in this gadget to make sure we wait for the weights calculator.
   virtual int close(unsigned long flags);
 
@@ -51,6 +87,9 @@ public Gadget2< ISMRMRD::AcquisitionHeader, hoNDArray< std::complex<float> > >
   GADGET_PROPERTY(uncombined_channels,std::string,"Uncombined channels (as a comma separated list of channel indices", "");
   GADGET_PROPERTY(uncombined_channels_by_name,std::string,"Uncombined channels (as a comma separated list of channel names", "");
   GADGET_PROPERTY(image_series,int,"Image series number for output images", 0);
+  GADGET_PROPERTY_LIMITS(calibration_priority,int,"Priority of the CPU calibrations among all GRAPPA chains, 1 for interactive chains", 0, GadgetPropertyLimitsRange, 0, 1);
+  GADGET_PROPERTY(streaming,bool,"If true, every readout updates the image of its slice and images are sent at streaming_frame_rate, without GrappaUnmixingGadget", false);
+  GADGET_PROPERTY(streaming_frame_rate,float,"Images per second and slice in the streaming mode, 0 for an image after every readout", 10.0f);
 
  private:
   typedef std::map< std::string, int > map_type_;
@@ -70,6 +109,14 @@ public Gadget2< ISMRMRD::AcquisitionHeader, hoNDArray< std::complex<float> > >
   unsigned int line_offset_;
   map_type_ channel_map_;
   bool use_gpu_;
+
+  std::vector<GrappaStreamingSlice> streaming_;
+
+  /// readout to image latency of the streaming mode: of the last and of the first readout in an image, in ms
+  double latency_sum_;
+  double latency_max_;
+  double latency_first_sum_;
+  size_t latency_count_;
 };
 }
 #endif //GRAPPAGADGET_H
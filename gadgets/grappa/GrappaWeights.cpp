@@ -1,107 +1,162 @@
-#include "../mri_core/GadgetIsmrmrdReadWrite.h"
 #include "GrappaWeights.h"
-#include "hoNDArray_fileio.h"
+#include "log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 
 namespace Gadgetron{
 
 template <class T> int GrappaWeights<T>::
 update(hoNDArray< std::complex<T> >* new_weights)
 {
-  /*
-  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-  if (!guard.locked()) {
-    return -1;
+  std::lock_guard<std::mutex> guard(update_mutex_);
+
+  // readers only find the current weights, once the spare ones are not used any more nobody can take them again
+  std::shared_ptr<Snapshot> next;
+  if (spare_ && spare_.use_count() == 1) {
+    // use_count() is a relaxed load; the fence orders the reuse after the release decrement of the
+    // last reader, whose reads of the old weights must not see the writes below
+    std::atomic_thread_fence(std::memory_order_acquire);
+    next = spare_;
   }
-  */
+  spare_.reset();
 
-  mutex_.acquire();
+  if (!next) {
+    next = std::make_shared<Snapshot>();
+  }
 
-  if (!weights_.dimensions_equal(new_weights)) {
-    try{weights_.create(new_weights->get_dimensions());}
+  if (!next->weights_.dimensions_equal(new_weights)) {
+    try{next->weights_.create(new_weights->get_dimensions());}
     catch (std::runtime_error & err){
       return -2;
     }
   }
 
-  memcpy(weights_.get_data_ptr(), new_weights->get_data_ptr(),
-	 weights_.get_number_of_elements()*sizeof(T)*2);
+  memcpy(next->weights_.get_data_ptr(), new_weights->get_data_ptr(),
+	 next->weights_.get_number_of_elements()*sizeof(T)*2);
 
-  weights_are_valid_ = true;
-  mutex_.release();
-  cond_.broadcast();
+  next->update_count_ = ++update_count_;
+
+  spare_ = std::atomic_exchange(&current_, next);
+
+  // a reader between its check of the weights and the wait holds cond_mutex_, it does not miss the notification
+  {
+    std::lock_guard<std::mutex> cond_guard(cond_mutex_);
+  }
+  cond_.notify_all();
 
   return 0;
 }
 
+template<class T> typename GrappaWeights<T>::SnapshotPtr GrappaWeights<T>::get_snapshot() const
+{
+  return std::atomic_load(&current_);
+}
+
+template<class T> typename GrappaWeights<T>::SnapshotPtr GrappaWeights<T>::wait_for_snapshot()
+{
+  SnapshotPtr snapshot = get_snapshot();
+  if (snapshot) {
+    return snapshot;
+  }
+
+  GDEBUG("Waiting for GRAPPA weights\n");
+  std::unique_lock<std::mutex> lock(cond_mutex_);
+  cond_.wait(lock, [this]() { return bool(std::atomic_load(&current_)); });
+
+  return get_snapshot();
+}
+
 template<class T> int GrappaWeights<T>::
 apply(hoNDArray< std::complex<T> >* data_in,
       hoNDArray< std::complex<T> >* data_out,
       T scale)
 {
-  /*
-  ACE_Guard<ACE_Thread_Mutex> guard(mutex_);
-  if (!guard.locked()) {
-    return -1;
-  }
-  */
-
-  mutex_.acquire();
-  if (!weights_are_valid_) {
-	  GDEBUG("Releasing Mutex to Wait for result\n");
-	  mutex_.release();
-	  cond_.wait();
-	  mutex_.acquire();
- }
-
+  SnapshotPtr snapshot = wait_for_snapshot();
+  return unmix(snapshot->weights_, *data_in, *data_out, scale);
+}
 
-  if (weights_.get_number_of_elements()%data_in->get_number_of_elements()) {
+template<class T> int GrappaWeights<T>::
+unmix(const hoNDArray< std::complex<T> >& weights,
+      const hoNDArray< std::complex<T> >& data_in,
+      hoNDArray< std::complex<T> >& data_out,
+      T scale)
+{
+  if (data_in.get_number_of_elements() == 0 || weights.get_number_of_elements()%data_in.get_number_of_elements()) {
     return -3;
   }
 
-  unsigned int sets = weights_.get_number_of_elements()/data_in->get_number_of_elements();
-  
+  size_t sets = weights.get_number_of_elements()/data_in.get_number_of_elements();
+
   if (sets < 1) {
     return -4;
   }
 
-  if (data_out->get_size(data_out->get_number_of_dimensions()-1) != sets) {
+  if (data_out.get_size(data_out.get_number_of_dimensions()-1) != sets) {
     return -5;
   }
 
-  unsigned long image_elements = data_out->get_number_of_elements()/sets;
-  unsigned int coils = weights_.get_number_of_elements()/(sets*image_elements);
-  
-  if (weights_.get_number_of_elements() != (image_elements*coils*sets)) {
+  size_t image_elements = data_out.get_number_of_elements()/sets;
+  size_t coils = weights.get_number_of_elements()/(sets*image_elements);
+
+  if (weights.get_number_of_elements() != (image_elements*coils*sets)) {
     return -6;
   }
 
-  if (data_in->get_number_of_elements() != (image_elements*coils)) {
+  if (data_in.get_number_of_elements() != (image_elements*coils)) {
     return -7;
   }
 
-  if (data_out->get_number_of_elements() != (image_elements*sets)) {
+  if (data_out.get_number_of_elements() != (image_elements*sets)) {
     return -8;
   }
 
-  std::complex<T>* weights_ptr = weights_.get_data_ptr();
-  std::complex<T>* in_ptr = data_in->get_data_ptr();
-  std::complex<T>* out_ptr = data_out->get_data_ptr();
-
-  for (unsigned int i = 0; i < image_elements*sets; i++) {
-    out_ptr[i] = 0;
-  }
+  // real and imaginary parts, the complex multiplications are written out so that the loops over the pixels vectorize
+  const T* weights_ptr = reinterpret_cast<const T*>(weights.get_data_ptr());
+  const T* in_ptr = reinterpret_cast<const T*>(data_in.get_data_ptr());
+  T* out_ptr = reinterpret_cast<T*>(data_out.get_data_ptr());
+
+  // the accumulators of a tile of pixels stay in L1, every coil is a contiguous run of the tile
+  const size_t tile = 256;
+  long long num_tiles = (long long)((image_elements + tile - 1)/tile);
+
+  long long n;
+#pragma omp parallel for private(n) if (image_elements*coils*sets > 64*1024)
+  for (n = 0; n < num_tiles; n++) {
+    T acc_re[tile];
+    T acc_im[tile];
+
+    size_t p0 = (size_t)n*tile;
+    size_t len = std::min(tile, image_elements - p0);
+
+    for (size_t s = 0; s < sets; s++) {
+      std::fill(acc_re, acc_re+len, T(0));
+      std::fill(acc_im, acc_im+len, T(0));
+
+      for (size_t c = 0; c < coils; c++) {
+        const T* w = weights_ptr + 2*((s*coils + c)*image_elements + p0);
+        const T* x = in_ptr + 2*(c*image_elements + p0);
+
+        for (size_t p = 0; p < len; p++) {
+          T wr = w[2*p];
+          T wi = w[2*p+1];
+          T xr = x[2*p];
+          T xi = x[2*p+1];
+
+          acc_re[p] += wr*xr - wi*xi;
+          acc_im[p] += wr*xi + wi*xr;
+        }
+      }
 
-  for (unsigned int s = 0; s < sets; s++) {
-    for (unsigned int p = 0; p < image_elements; p++) {
-      for (unsigned int c = 0; c < coils; c++) {
-	out_ptr[s*image_elements + p] += 
-	  weights_ptr[s*image_elements*coils + c*image_elements + p] * 
-	  in_ptr[c*image_elements + p]*scale;
+      T* o = out_ptr + 2*(s*image_elements + p0);
+      for (size_t p = 0; p < len; p++) {
+        o[2*p] = scale*acc_re[p];
+        o[2*p+1] = scale*acc_im[p];
       }
     }
   }
 
-  mutex_.release();
   return 0;
 }
 
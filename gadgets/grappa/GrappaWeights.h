@@ -1,37 +1,77 @@
-#pragma once 
+#pragma once
 
 #include "gadgetron_grappa_export.h"
 #include "hoNDArray.h"
 
-#include <ace/Synch.h>
 #include <complex>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 
 namespace Gadgetron{
 
+/**
+   Unmixing weights [RO E1 E2 CHA sets] of a slice.
+
+   The weights are published as immutable snapshots. Readers take the current snapshot without a lock
+   and keep it alive while they use it, so an unmixing never blocks an update and vice versa. An update
+   fills the buffer of the weights before the current ones, if no reader holds it any more, and swaps
+   it in atomically.
+*/
 template <class T> class EXPORTGADGETSGRAPPA GrappaWeights
 {
  public:
+
+  struct Snapshot
+  {
+    hoNDArray< std::complex<T> > weights_;
+    /// number of the update, starting at 1
+    unsigned long long update_count_;
+  };
+
+  typedef std::shared_ptr<const Snapshot> SnapshotPtr;
+
   GrappaWeights()
-  	  : weights_are_valid_(false)
-  	  , cond_(cond_mutex_)
+  	  : update_count_(0)
   	  {
 
   	  }
   virtual ~GrappaWeights() {}
-  
+
   int update(hoNDArray< std::complex<T> >* new_weights);
 
+  /// waits for the first weights
   int apply(hoNDArray< std::complex<T> >* data_in,
-	    hoNDArray< std::complex<T> >* data_out, 
+	    hoNDArray< std::complex<T> >* data_out,
 	    T scale = 1.0);
 
+  /// the current weights, empty before the first update; does not wait
+  SnapshotPtr get_snapshot() const;
+
+  /// the current weights, waits for the first update
+  SnapshotPtr wait_for_snapshot();
+
+  /**
+     data_out[sets] = scale * sum over CHA of weights[CHA sets] .* data_in[CHA], data_in is [image_elements CHA],
+     data_out is [image_elements sets]. Returns the error codes of apply.
+  */
+  static int unmix(const hoNDArray< std::complex<T> >& weights,
+		   const hoNDArray< std::complex<T> >& data_in,
+		   hoNDArray< std::complex<T> >& data_out,
+		   T scale = 1.0);
+
  private:
-  ACE_Thread_Mutex mutex_;
-  bool weights_are_valid_;
+  /// taken by update only
+  std::mutex update_mutex_;
+  unsigned long long update_count_;
+
+  /// accessed with the atomic shared_ptr functions
+  std::shared_ptr<Snapshot> current_;
 
-  ACE_Thread_Mutex cond_mutex_;
-  ACE_Condition_Thread_Mutex cond_;
-  hoNDArray< std::complex<T> > weights_;
+  /// the weights before the current ones, reused by the next update
+  std::shared_ptr<Snapshot> spare_;
 
+  std::mutex cond_mutex_;
+  std::condition_variable cond_;
 };
 }
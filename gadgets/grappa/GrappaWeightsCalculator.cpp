@@ -15,13 +15,46 @@
 
 #include "complext.h"
 
-#include "hoNDFFT.h"
-#include "hoNDArray_elemwise.h"
-#include "mri_core_grappa.h"
-#include "mri_core_coil_map_estimation.h"
+#include "GrappaCalibrationService.h"
 
 namespace Gadgetron{
 
+namespace
+{
+    int submit_calibration(hoNDArray< std::complex<float> >* ref_data,
+                           const std::vector< std::pair<unsigned int, unsigned int> >& sampled_region,
+                           unsigned int acceleration_factor,
+                           const std::list<unsigned int>& uncombined_channels,
+                           int target_coils,
+                           boost::shared_ptr< GrappaWeights<float> > destination,
+                           int priority)
+    {
+        return GrappaCalibrationService::instance()->submit(ref_data, sampled_region, acceleration_factor,
+            uncombined_channels, target_coils, destination, priority);
+    }
+
+    template <class T> int submit_calibration(hoNDArray< std::complex<T> >* ref_data,
+                                              const std::vector< std::pair<unsigned int, unsigned int> >& sampled_region,
+                                              unsigned int acceleration_factor,
+                                              const std::list<unsigned int>& uncombined_channels,
+                                              int target_coils,
+                                              boost::shared_ptr< GrappaWeights<T> > destination,
+                                              int priority)
+    {
+        GERROR("The GRAPPA calibration service only supports single precision\n");
+        return -1;
+    }
+
+    void wait_for_calibration(const GrappaWeights<float>* destination)
+    {
+        GrappaCalibrationService::instance()->wait(destination);
+    }
+
+    template <class T> void wait_for_calibration(const GrappaWeights<T>* destination)
+    {
+    }
+}
+
 template <class T> class EXPORTGADGETSGRAPPA GrappaWeightsDescription
 {
 
@@ -65,9 +98,6 @@ template <class T> int GrappaWeightsCalculator<T>::svc(void)  {
         hoNDArray<float_complext>* host_data =
                 reinterpret_cast< hoNDArray<float_complext>* >(mb2->getObjectPtr());
 
-        size_t ks = 5;
-        size_t power = 3;
-
 #ifndef USE_CUDA
         use_gpu_ = false;
 #endif // USE_CUDA
@@ -161,228 +191,10 @@ template <class T> int GrappaWeightsCalculator<T>::svc(void)  {
         }
         else
         {
-            host_data->squeeze();
-
-            size_t RO = host_data->get_size(0);
-            size_t E1 = host_data->get_size(1);
-            size_t CHA = host_data->get_size(2);
-
-            std::vector<size_t> data_dimensions;
-            host_data->get_dimensions(data_dimensions);
-
-            if (uncombined_channels_.size() > 0) {
-                data_dimensions.push_back(uncombined_channels_.size() + 1);
-            }
-
-            try{ unmixing_.create(data_dimensions); }
-            catch (std::runtime_error &err){
-                GEXCEPTION(err, "Unable to allocate host memory for unmixing coeffcients\n");
-                return GADGET_FAIL;
-            }
-
-            // compute the unmixing coefficients
-            size_t numUnCombined = uncombined_channels_.size();
-
-            double thres = 0.0005;
-            size_t kRO = 5;
-            size_t kNE1 = 4;
-
-            if (numUnCombined==0)
-            {
-                hoNDArray< std::complex<float> > acs(RO, E1, target_coils_, reinterpret_cast< std::complex<float>* >(host_data->begin()));
-                hoNDArray< std::complex<float> > target_acs(RO, E1, target_coils_, acs.begin());
-
-                // estimate coil map
-                if (!complex_im_.dimensions_equal(&target_acs))
-                {
-                    complex_im_.create(RO, E1, target_coils_);
-                }
-
-                hoNDFFT<float>::instance()->ifft2c(target_acs, complex_im_);
-                Gadgetron::coil_map_2d_Inati(complex_im_, coil_map_, ks, power);
-
-                // compute unmixing coefficients
-                if (mb1->getObjectPtr()->acceleration_factor == 1)
-                {
-                    Gadgetron::conjugate(coil_map_, coil_map_);
-                    Gadgetron::clear(unmixing_);
-                    memcpy(unmixing_.begin(), coil_map_.begin(), coil_map_.get_number_of_bytes());
-                }
-                else
-                {
-                    size_t startRO = mb1->getObjectPtr()->sampled_region[0].first;
-                    size_t endRO = mb1->getObjectPtr()->sampled_region[0].second;
-
-                    size_t startE1 = mb1->getObjectPtr()->sampled_region[1].first;
-                    size_t endE1 = mb1->getObjectPtr()->sampled_region[1].second;
-
-                    Gadgetron::grappa2d_calib_convolution_kernel(acs, target_acs,
-                        (size_t)(mb1->getObjectPtr()->acceleration_factor),
-                        thres, kRO, kNE1, startRO, endRO, startE1, endE1, conv_ker_);
-
-                    Gadgetron::grappa2d_image_domain_kernel(conv_ker_, RO, E1, kIm_);
-
-                    Gadgetron::clear(unmixing_);
-
-                    Gadgetron::grappa2d_unmixing_coeff(kIm_, coil_map_, (size_t)(mb1->getObjectPtr()->acceleration_factor), unmixing_, gFactor_);
-
-                    // GDEBUG_STREAM("cpu triggered - unmixing_ : " << Gadgetron::norm2(unmixing_));
-                }
-            }
-            else
-            {
-                hoNDArray< std::complex<float> > acs(RO, E1, CHA, reinterpret_cast< std::complex<float>* >(host_data->begin()));
-
-                // handle the case that all channels are reconed
-                size_t target_coils_with_uncombined = target_coils_ + numUnCombined;
-                if (target_coils_with_uncombined > CHA) target_coils_with_uncombined = CHA;
-
-                std::list<unsigned int>::iterator it;
-
-                // compute unmixing coefficients
-                if (mb1->getObjectPtr()->acceleration_factor == 1)
-                {
-                    // if no acceleration, the input data is used for coil map estimation
-                    // no need to differentiate combined and uncombined channels
-                    if (!complex_im_.dimensions_equal(&acs))
-                    {
-                        complex_im_.create(RO, E1, acs.get_size(2));
-                    }
-
-                    hoNDFFT<float>::instance()->ifft2c(acs, complex_im_);
-
-                    Gadgetron::coil_map_2d_Inati(complex_im_, coil_map_, ks, power);
-
-                    Gadgetron::conjugate(coil_map_, coil_map_);
-
-                    Gadgetron::clear(unmixing_);
-
-                    // copy back to unmixing
-                    memcpy(unmixing_.begin(), coil_map_.begin(), sizeof(std::complex<float>)*RO*E1*CHA);
-
-                    // set uncombined channels
-                    size_t ind = 1;
-                    for (it = uncombined_channels_.begin(); it != uncombined_channels_.end(); it++)
-                    {
-                        std::complex<float>* pUnmixing = unmixing_.begin() + ind*RO*E1*CHA + (*it)*RO*E1;
-                        for (size_t p = 0; p<RO*E1; p++)
-                        {
-                            pUnmixing[p] = 1;
-                        }
-
-                        ind++;
-                    }
-                }
-                else
-                {
-                    // first, assemble the target_acs
-                    // the combined channel comes first and then all uncombined channels
-                    std::vector<size_t> dimTarget(3);
-                    dimTarget[0] = RO;
-                    dimTarget[1] = E1;
-                    dimTarget[2] = target_coils_with_uncombined;
-
-                    if (!target_acs_.dimensions_equal(&dimTarget))
-                    {
-                        target_acs_.create(RO, E1, target_coils_with_uncombined);
-                    }
-
-                    // copy first combined channels and all uncombined channels to target_acs_
-                    size_t sCha, ind(0), ind_uncombined(0);
-
-                    // record from which src channel, a target channel is selected
-                    std::vector<size_t> srcChaLoc(target_coils_with_uncombined);
-                    for (sCha = 0; sCha<CHA; sCha++)
-                    {
-                        bool uncombined = false;
-                        for (it = uncombined_channels_.begin(); it != uncombined_channels_.end(); it++)
-                        {
-                            if (sCha == *it)
-                            {
-                                uncombined = true;
-                                break;
-                            }
-                        }
-
-                        if (!uncombined)
-                        {
-                            if ( ind < (target_coils_with_uncombined - numUnCombined) )
-                            {
-                                memcpy(target_acs_.begin() + ind * RO*E1, acs.begin() + sCha * RO*E1, sizeof(std::complex<float>)*RO*E1);
-                                srcChaLoc[ind] = sCha;
-                                ind++;
-                            }
-                        }
-                        else
-                        {
-                            memcpy(target_acs_.begin() + (target_coils_with_uncombined - numUnCombined + ind_uncombined) * RO*E1, acs.begin() + sCha * RO*E1, sizeof(std::complex<float>)*RO*E1);
-                            srcChaLoc[target_coils_with_uncombined - numUnCombined + ind_uncombined] = sCha;
-                            ind_uncombined++;
-                        }
-                    }
-
-                    if (!complex_im_.dimensions_equal(&target_acs_))
-                    {
-                        complex_im_.create(RO, E1, target_acs_.get_size(2));
-                    }
-
-                    hoNDFFT<float>::instance()->ifft2c(target_acs_, complex_im_);
-
-                    Gadgetron::coil_map_2d_Inati(complex_im_, coil_map_, ks, power);
-
-                    Gadgetron::grappa2d_calib_convolution_kernel(acs, target_acs_,
-                        (size_t)(mb1->getObjectPtr()->acceleration_factor),
-                        thres, kRO, kNE1, conv_ker_);
-
-                    Gadgetron::grappa2d_image_domain_kernel(conv_ker_, RO, E1, kIm_);
-
-                    // kIm_ stored the unwrapping coefficients as [RO E1 CHA target_coils_with_uncombined]
-                    // for the target_coils_with_uncombined dimension, combined channels come first and then uncombined channels
-
-                    Gadgetron::clear(unmixing_);
-
-                    hoNDArray< std::complex<float> > unmixing_all_channels(RO, E1, CHA, unmixing_.begin());
-                    Gadgetron::grappa2d_unmixing_coeff(kIm_, coil_map_, (size_t)(mb1->getObjectPtr()->acceleration_factor), unmixing_all_channels, gFactor_);
-
-                    // set unmixing coefficients for uncombined channels
-                    ind = 1;
-                    for (it = uncombined_channels_.begin(); it != uncombined_channels_.end(); it++)
-                    {
-                        memcpy(unmixing_.begin() + ind*RO*E1*CHA, kIm_.begin() + (target_coils_with_uncombined - numUnCombined + ind - 1)*RO*E1*CHA, sizeof(std::complex<float>)*RO*E1*CHA);
-                        ind++;
-                    }
-                }
-            }
-
-            // pass the unmixing coefficients
-            if (mb1->getObjectPtr()->destination)
-            {
-                boost::shared_ptr< hoNDArray< std::complex<float> > > unmixing_host(new hoNDArray< std::complex<float> >());
-                boost::shared_ptr< std::vector<size_t> > tmp_dims = mb2->getObjectPtr()->get_dimensions();
-                if (uncombined_channels_.size()) tmp_dims->push_back((size_t)(uncombined_channels_.size() + 1));
-
-                try {
-                    unmixing_host->create(tmp_dims.get());
-                    Gadgetron::clear(*unmixing_host);
-                }
-                catch (std::runtime_error &err){
-                    GEXCEPTION(err, "Reshaping of GRAPPA weights failed \n");
-
-                }
-
-                memcpy(unmixing_host->begin(), unmixing_.begin(), unmixing_.get_number_of_bytes());
-
-                // GDEBUG_STREAM("cpu triggered ... : " << Gadgetron::norm2(*unmixing_host));
-
-                if (mb1->getObjectPtr()->destination->update(unmixing_host.get()) < 0) {
-                    GDEBUG("Update of GRAPPA weights failed\n");
-                    return GADGET_FAIL;
-                }
-            }
-            else {
-                GDEBUG("Undefined GRAPPA weights destination\n");
-                return GADGET_FAIL;
-            }
+            // CPU calibrations are submitted to the GrappaCalibrationService by add_job
+            GDEBUG("Undefined GRAPPA weights calculation\n");
+            mb->release();
+            return GADGET_FAIL;
         }
 
         mb->release();
@@ -394,6 +206,13 @@ template <class T> int GrappaWeightsCalculator<T>::svc(void)  {
 template <class T> int GrappaWeightsCalculator<T>::close(unsigned long flags) {
     int rval = 0;
     if (flags == 1) {
+        // the weights of the CPU calibrations still running are not lost
+        typename std::set< GrappaWeights<T>* >::iterator it;
+        for (it = submitted_.begin(); it != submitted_.end(); it++) {
+            wait_for_calibration(*it);
+        }
+        submitted_.clear();
+
         ACE_Message_Block *hangup = new ACE_Message_Block();
         hangup->msg_type( ACE_Message_Block::MB_HANGUP );
         if (this->putq(hangup) == -1) {
@@ -418,6 +237,21 @@ add_job( hoNDArray< std::complex<T> >* ref_data,
         bool include_uncombined_channels_in_combined_weights)
         {
 
+#ifndef USE_CUDA
+    use_gpu_ = false;
+#endif // USE_CUDA
+
+    if (!use_gpu_) {
+        if (!destination) {
+            GDEBUG("Undefined GRAPPA weights destination\n");
+            return -1;
+        }
+
+        submitted_.insert(destination.get());
+        return submit_calibration(ref_data, sampled_region, acceleration_factor,
+            uncombined_channels_, target_coils_, destination, priority_);
+    }
+
     GadgetContainerMessage< GrappaWeightsDescription<T> >* mb1 =
             new GadgetContainerMessage< GrappaWeightsDescription<T> >();
 
@@ -5,6 +5,7 @@
 
 #include <ace/Task.h>
 #include <list>
+#include <set>
 
 namespace Gadgetron{
 
@@ -16,6 +17,7 @@ template <class T> class EXPORTGADGETSGRAPPA GrappaWeightsCalculator : public AC
   GrappaWeightsCalculator() 
     : inherited()
     , target_coils_(0)
+    , priority_(0)
   {
     #ifdef USE_CUDA
       use_gpu_ = true;
@@ -68,18 +70,22 @@ template <class T> class EXPORTGADGETSGRAPPA GrappaWeightsCalculator : public AC
       use_gpu_ = v;
   }
 
+  /// priority of the CPU calibrations in the GrappaCalibrationService, 1 for interactive chains
+  int get_priority() {
+    return priority_;
+  }
+
+  void set_priority(int p) {
+    priority_ = p;
+  }
+
  private:
   std::list<unsigned int> uncombined_channels_;
   int target_coils_;
   bool use_gpu_;
+  int priority_;
 
-  hoNDArray< std::complex<T> > target_acs_;
-
-  hoNDArray< std::complex<T> > complex_im_;
-  hoNDArray< std::complex<T> > conv_ker_;
-  hoNDArray< std::complex<T> > kIm_;
-  hoNDArray< std::complex<T> > coil_map_;
-  hoNDArray< std::complex<T> > unmixing_;
-  hoNDArray< T > gFactor_;
+  /// destinations with CPU calibrations submitted to the GrappaCalibrationService
+  std::set< GrappaWeights<T>* > submitted_;
 };
 }
@@ -7,6 +7,7 @@
 
 #include "GadgetIsmrmrdReadWrite.h"
 #include "AutoScaleGadget.h"
+#include "mri_core_image_conversion.h"
 
 namespace Gadgetron{
 
@@ -23,6 +24,7 @@ AutoScaleGadget::~AutoScaleGadget() {
 
 int AutoScaleGadget::process_config(ACE_Message_Block* mb) {
         max_value_ = max_value.value();
+        histogram_bins_ = histogram_bins.value();
 	return GADGET_OK;
 }
 
@@ -30,41 +32,16 @@ int AutoScaleGadget::process_config(ACE_Message_Block* mb) {
 int AutoScaleGadget::process(GadgetContainerMessage<ISMRMRD::ImageHeader> *m1, GadgetContainerMessage<hoNDArray<float> > *m2)
 {
 	if (m1->getObjectPtr()->image_type == ISMRMRD::ISMRMRD_IMTYPE_MAGNITUDE) { //Only scale magnitude images for now
-		float max = 0.0f;
-		float* d = m2->getObjectPtr()->get_data_ptr();
-		for (unsigned long int i = 0; i < m2->getObjectPtr()->get_number_of_elements(); i++) {
-			if (d[i] > max) max = d[i];
-		}
-
-		if (histogram_.size() != histogram_bins_) {
-			histogram_ = std::vector<size_t>(histogram_bins_);
-		}
-
-		for (size_t i = 0; i < histogram_bins_; i++) {
-			histogram_[i] = 0;
-		}
-
-		for (unsigned long int i = 0; i < m2->getObjectPtr()->get_number_of_elements(); i++) {
-			size_t bin = static_cast<size_t>(floor((d[i]/max)*histogram_bins_));
-			if (bin >= histogram_bins_) {
-				bin = histogram_bins_-1;
-			}
-			histogram_[bin]++;
-		}
-
-		//Find 99th percentile
-		long long cumsum = 0;
-		size_t counter = 0;
-		while (cumsum < (0.99*m2->getObjectPtr()->get_number_of_elements())) {
-			cumsum += (long long)(histogram_[counter++]);
-		}
-		max = (counter+1)*(max/histogram_bins_);
+		float max = Gadgetron::compute_histogram_percentile(*m2->getObjectPtr(), histogram_bins_, 0.99);
 		GDEBUG("Max: %f\n",max);
 
-		current_scale_ = max_value_/max;
+		if (max > 0) current_scale_ = max_value_/max;
 
-		for (unsigned long int i = 0; i < m2->getObjectPtr()->get_number_of_elements(); i++) {
-			d[i] *= current_scale_;
+		float* d = m2->getObjectPtr()->get_data_ptr();
+		long long N = (long long)m2->getObjectPtr()->get_number_of_elements();
+		float scale = current_scale_;
+		for (long long i = 0; i < N; i++) {
+			d[i] *= scale;
 		}
 	}
 
@@ -20,13 +20,13 @@ namespace Gadgetron{
 
   protected:
     GADGET_PROPERTY(max_value, float, "Maximum value (after scaling)", 2048);
+    GADGET_PROPERTY(histogram_bins, size_t, "Number of histogram bins used to find the 99th percentile", 100);
 
     virtual int process(GadgetContainerMessage<ISMRMRD::ImageHeader>* m1,
 			GadgetContainerMessage< hoNDArray< float > >* m2);
     virtual int process_config(ACE_Message_Block *mb);
 
-    unsigned int histogram_bins_;
-    std::vector<size_t> histogram_;
+    size_t histogram_bins_;
     float current_scale_;
     float max_value_;
   };
@@ -1,9 +1,6 @@
 #include "GadgetIsmrmrdReadWrite.h"
 #include "DependencyQueryGadget.h"
-
-#include <boost/version.hpp>
-#include <boost/filesystem.hpp>
-using namespace boost::filesystem;
+#include "NoiseDependencyStore.h"
 
 namespace Gadgetron
 {
@@ -17,11 +14,6 @@ namespace Gadgetron
 
         clean_storage_while_query_ = true;
         time_limit_in_storage_ = 24.0;
-
-        // get current time
-        std::time(&curr_time_UTC_);
-        struct tm* currTm = std::gmtime(&curr_time_UTC_);
-        curr_time_UTC_ = std::mktime(currTm);
     }
 
     DependencyQueryGadget::~DependencyQueryGadget()
@@ -40,8 +32,6 @@ namespace Gadgetron
 
     int DependencyQueryGadget::close(unsigned long flags)
     {
-        typedef unsigned long long size_t_type;
-
         if ( BaseClass::close(flags) != GADGET_OK ) return GADGET_FAIL;
 
         if ( !processed_in_close_ )
@@ -79,107 +69,44 @@ namespace Gadgetron
             }
             GDEBUG_STREAM( "time_limit_in_storage_ is " << time_limit_in_storage_);
 
-            // list the content in the noise dependency folder
-            path p (noise_dependency_folder_);
+            // list the noise dependencies from the index of the store, expired ones are removed by the store in the background
+            NoiseDependencyStore* store = NoiseDependencyStore::instance();
+            store->set_time_limit(noise_dependency_folder_, clean_storage_while_query_ ? time_limit_in_storage_ : 0);
 
-            try
+            std::vector<std::string> names;
+            if ( store->list(noise_dependency_folder_, noise_dependency_prefix_, names) )
             {
-                if ( exists(p) )
+                GDEBUG_STREAM( "A total of " << names.size() << " noise dependency measurements are found ... ");
+
+                // declear the attributes
+                Gadgetron::GadgetContainerMessage<ISMRMRD::MetaContainer>* m1 = new Gadgetron::GadgetContainerMessage<ISMRMRD::MetaContainer>();
+
+                for (size_t n = 0; n < names.size(); n++)
                 {
-                    if ( is_directory(p) )
-                    {
-                        typedef std::vector<path> vec;
-                        vec v;
-                        v.reserve(100);
-
-                        copy(directory_iterator(p), directory_iterator(), back_inserter(v));
-                        sort(v.begin(), v.end());
-
-                        GDEBUG_STREAM( "A total of " << v.size() << " dependency measurements are found ... ");
-
-                        // if needed, clean the storage first
-                        std::string filename;
-
-                        if ( clean_storage_while_query_ )
-                        {
-                            for (vec::const_iterator it (v.begin()); it != v.end(); ++it)
-                            {
-                                filename = it->string();
-
-                                // find the file creation/modification time
-                                std::time_t lastWriteTime = last_write_time(*it);
-                                struct tm* lastWriteTm = std::gmtime(&lastWriteTime);
-                                lastWriteTime = std::mktime(lastWriteTm);
-
-                                if ( std::abs( (double)lastWriteTime - (double)curr_time_UTC_ ) > time_limit_in_storage_*3600.0 )
-                                {
-                                    remove(*it);
-                                }
-                            }
-
-                            // update the file list
-                            v.clear();
-                            copy(directory_iterator(p), directory_iterator(), back_inserter(v));
-                            sort(v.begin(), v.end());
-
-                            GDEBUG_STREAM( "A total of " << v.size() << " dependency measurements are found after cleaning ... ");
-                        }
-
-                        // declear the attributes
-                        Gadgetron::GadgetContainerMessage<ISMRMRD::MetaContainer>* m1 = new Gadgetron::GadgetContainerMessage<ISMRMRD::MetaContainer>();
-
-                        size_t count = 0;
-                        size_t ind;
-
-                        for (vec::const_iterator it (v.begin()); it != v.end(); ++it)
-                        {
-#                       if BOOST_VERSION < 104600
-                            filename = it->filename();
-#                       else
-                            filename = it->filename().string();
-#                       endif
-                            ind = filename.find(noise_dependency_prefix_);
-
-                            if ( ind != std::string::npos )
-                            {
-                                m1->getObjectPtr()->append(noise_dependency_attrib_name_.c_str(), filename.c_str());
-                                count++;
-                            }
-                        }
-
-                        GDEBUG_STREAM( "A total of " << count << " noise dependency measurements are found ... ");
-
-                        if ( count == 0 )
-                        {
-                            // put into a dummy item
-                            m1->getObjectPtr()->set(noise_dependency_attrib_name_.c_str(), "Dummy");
-                        }
-
-                        // send the found dependencies
-                        GadgetContainerMessage<GadgetMessageIdentifier>* mb = new GadgetContainerMessage<GadgetMessageIdentifier>();
-                        mb->getObjectPtr()->id = GADGET_MESSAGE_DEPENDENCY_QUERY;
-                        mb->cont(m1);
-
-                        int ret =  this->controller_->output_ready(mb);
-                        if ( (ret < 0) )
-                        {
-                            GDEBUG("Failed to return massage to controller\n");
-                            return GADGET_FAIL;
-                        }
-                    }
-                    else
-                    {
-                        GERROR_STREAM( noise_dependency_folder_ << " is not a valid folder ... ");
-                    }
+                    m1->getObjectPtr()->append(noise_dependency_attrib_name_.c_str(), names[n].c_str());
                 }
-                else
+
+                if ( names.empty() )
                 {
-                    GERROR_STREAM("Cannot find dependency folder : " << noise_dependency_folder_);
+                    // put into a dummy item
+                    m1->getObjectPtr()->set(noise_dependency_attrib_name_.c_str(), "Dummy");
+                }
+
+                // send the found dependencies
+                GadgetContainerMessage<GadgetMessageIdentifier>* mb = new GadgetContainerMessage<GadgetMessageIdentifier>();
+                mb->getObjectPtr()->id = GADGET_MESSAGE_DEPENDENCY_QUERY;
+                mb->cont(m1);
+
+                int ret =  this->controller_->output_ready(mb);
+                if ( (ret < 0) )
+                {
+                    GDEBUG("Failed to return massage to controller\n");
+                    return GADGET_FAIL;
                 }
             }
-            catch (const filesystem_error& ex)
+            else
             {
-                GERROR_STREAM( ex.what() );
+                GERROR_STREAM("Cannot find dependency folder : " << noise_dependency_folder_);
             }
         }
 
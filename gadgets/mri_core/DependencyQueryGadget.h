@@ -33,15 +33,12 @@ namespace Gadgetron
 	GADGET_PROPERTY(clean_storage_while_query, bool, "Clean storage while querying", false);
 	GADGET_PROPERTY(time_limit_in_storage, float, "Time limit for storing noise dependency", 0);
 
-        // if true, the old stored file will be deleted while querying
+        // if true, the old stored files are not listed and are deleted in the background
         bool clean_storage_while_query_;
 
         // in the unit of hours, how long a file is allowed to be in the storage
         double time_limit_in_storage_;
 
-        // current time, year/month/day/hour/min/second
-        std::time_t curr_time_UTC_;
-
         bool processed_in_close_;
 
         std::string noise_dependency_folder_;
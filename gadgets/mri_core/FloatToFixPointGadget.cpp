@@ -8,6 +8,7 @@
 #include "GadgetIsmrmrdReadWrite.h"
 #include "FloatToFixPointGadget.h"
 #include "mri_core_def.h"
+#include "mri_core_image_conversion.h"
 
 namespace Gadgetron
 {
@@ -15,7 +16,11 @@ namespace Gadgetron
     FloatToFixPointGadget<T>::FloatToFixPointGadget() 
         : max_intensity_value_(std::numeric_limits<T>::max()), 
           min_intensity_value_(std::numeric_limits<T>::min()), 
-          intensity_offset_value_(0)
+          intensity_offset_value_(0),
+          auto_scale_(false),
+          auto_scale_max_value_(2048),
+          auto_scale_histogram_bins_(100),
+          current_scale_(1.0f)
     {
     }
 
@@ -32,6 +37,10 @@ namespace Gadgetron
         min_intensity_value_ = min_intensity.value();
         intensity_offset_value_ = intensity_offset.value();
 
+        auto_scale_ = auto_scale.value();
+        auto_scale_max_value_ = auto_scale_max_value.value();
+        auto_scale_histogram_bins_ = auto_scale_histogram_bins.value();
+
         return GADGET_OK;
     }
 
@@ -49,42 +58,31 @@ namespace Gadgetron
             return GADGET_FAIL;
         }
 
-        float* src = m2->getObjectPtr()->get_data_ptr();
-        T* dst = cm2->getObjectPtr()->get_data_ptr();
-
-        long long i;
-        long long numOfPixels = (long long)cm2->getObjectPtr()->get_number_of_elements();
-
         GadgetContainerMessage<ISMRMRD::MetaContainer>* m3 = AsContainerMessage<ISMRMRD::MetaContainer>(m2->cont());
 
+        hoNDArray< float >& src = *m2->getObjectPtr();
+        hoNDArray< T >& dst = *cm2->getObjectPtr();
+
         switch (m1->getObjectPtr()->image_type)
         {
             case ISMRMRD::ISMRMRD_IMTYPE_MAGNITUDE:
             {
-                #pragma omp parallel for default(none) private(i) shared(numOfPixels, src, dst)
-                for (i=0; i<numOfPixels; i++)
+                if (auto_scale_)
                 {
-                    float pix_val = src[i];
-                    pix_val = std::abs(pix_val);
-                    if (pix_val < (float)min_intensity_value_) pix_val = (float)min_intensity_value_;
-                    if (pix_val > (float)max_intensity_value_) pix_val = (float)max_intensity_value_;
-                    dst[i] = static_cast<T>(pix_val+0.5);
+                    float max_value = Gadgetron::compute_histogram_percentile(src, auto_scale_histogram_bins_, 0.99);
+                    if (max_value > 0) current_scale_ = auto_scale_max_value_ / max_value;
+                    GDEBUG("Max: %f\n", max_value);
                 }
+
+                float scale = auto_scale_ ? current_scale_ : 1.0f;
+                Gadgetron::convert_to_fix_point(src, scale, 0.0f, true, true, min_intensity_value_, max_intensity_value_, dst);
             }
             break;
 
             case ISMRMRD::ISMRMRD_IMTYPE_REAL:
             case ISMRMRD::ISMRMRD_IMTYPE_IMAG:
             {
-                #pragma omp parallel for default(none) private(i) shared(numOfPixels, src, dst)
-                for (i=0; i<numOfPixels; i++)
-                {
-                    float pix_val = src[i];
-                    pix_val = pix_val + intensity_offset_value_;
-                    if (pix_val < (float)min_intensity_value_) pix_val = (float)min_intensity_value_;
-                    if (pix_val > (float)max_intensity_value_) pix_val = (float)max_intensity_value_;
-                    dst[i] = static_cast<T>(pix_val+0.5);
-                }
+                Gadgetron::convert_to_fix_point(src, 1.0f, (float)intensity_offset_value_, false, true, min_intensity_value_, max_intensity_value_, dst);
 
                 if (m3)
                 {
@@ -100,16 +98,7 @@ namespace Gadgetron
 
             case ISMRMRD::ISMRMRD_IMTYPE_PHASE:
             {
-                #pragma omp parallel for default(none) private(i) shared(numOfPixels, src, dst)
-                for (i=0; i<numOfPixels; i++)
-                {
-                    float pix_val = src[i];
-                    pix_val *= (float)(intensity_offset_value_/3.14159265);
-                    pix_val += intensity_offset_value_;
-                    if (pix_val < (float)min_intensity_value_) pix_val = (float)min_intensity_value_;
-                    if (pix_val > (float)max_intensity_value_) pix_val = (float)max_intensity_value_;
-                    dst[i] = static_cast<T>(pix_val);
-                }
+                Gadgetron::convert_to_fix_point(src, (float)(intensity_offset_value_/3.14159265), (float)intensity_offset_value_, false, false, min_intensity_value_, max_intensity_value_, dst);
             }
             break;
 
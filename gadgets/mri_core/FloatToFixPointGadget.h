@@ -19,6 +19,9 @@ namespace Gadgetron
     * Real or Imag: Values below -2048 and above 2047 will be clamped. Zero will be 2048.
     * Phase: -pi will be 0, +pi will be 4095.
     *
+    * If auto_scale is true, magnitude images are scaled as by AutoScaleGadget in the same pass as the conversion,
+    * so the AutoScaleGadget in front of this gadget is not needed.
+    *
     */
 
     template <typename T> 
@@ -35,11 +38,19 @@ namespace Gadgetron
         GADGET_PROPERTY(max_intensity, T, "Maximum intensity value", std::numeric_limits<T>::max() );
         GADGET_PROPERTY(min_intensity, T, "Minimal intensity value", std::numeric_limits<T>::min());
         GADGET_PROPERTY(intensity_offset, T, "Intensity offset", 0);
+        GADGET_PROPERTY(auto_scale, bool, "Whether to scale magnitude images so that the 99th percentile of the histogram is auto_scale_max_value", false);
+        GADGET_PROPERTY(auto_scale_max_value, float, "Maximum value (after auto scaling)", 2048);
+        GADGET_PROPERTY(auto_scale_histogram_bins, size_t, "Number of histogram bins used to find the 99th percentile", 100);
 
         T max_intensity_value_;
         T min_intensity_value_;
         T intensity_offset_value_;
 
+        bool auto_scale_;
+        float auto_scale_max_value_;
+        size_t auto_scale_histogram_bins_;
+        float current_scale_;
+
         virtual int process_config(ACE_Message_Block* mb);
         virtual int process(GadgetContainerMessage<ISMRMRD::ImageHeader>* m1, GadgetContainerMessage< hoNDArray< float > >* m2);
     };
@@ -157,17 +157,21 @@ namespace Gadgetron {
 
             if(recompute_coeff)
             {
+                Gadgetron::KLTMethod klt_method = Gadgetron::KLT_SVD;
+                if (upstream_coil_compression_eigen_solver.value() == "covariance") klt_method = Gadgetron::KLT_COVARIANCE;
+                if (upstream_coil_compression_eigen_solver.value() == "truncated") klt_method = Gadgetron::KLT_TRUNCATED;
+
                 if(rbit.ref_)
                 {
                     // use ref to compute coefficients
                     Gadgetron::compute_eigen_channel_coefficients(rbit.ref_->data_, average_N, average_S,
-                        (calib_mode_[e] == Gadgetron::ISMRMRD_interleaved), N, S, upstream_coil_compression_thres.value(), upstream_coil_compression_num_modesKept.value(), KLT_[e]);
+                        (calib_mode_[e] == Gadgetron::ISMRMRD_interleaved), N, S, upstream_coil_compression_thres.value(), upstream_coil_compression_num_modesKept.value(), KLT_[e], klt_method);
                 }
                 else
                 {
                     // use data to compute coefficients
                     Gadgetron::compute_eigen_channel_coefficients(rbit.data_.data_, average_N, average_S,
-                        (calib_mode_[e] == Gadgetron::ISMRMRD_interleaved), N, S, upstream_coil_compression_thres.value(), upstream_coil_compression_num_modesKept.value(), KLT_[e]);
+                        (calib_mode_[e] == Gadgetron::ISMRMRD_interleaved), N, S, upstream_coil_compression_thres.value(), upstream_coil_compression_num_modesKept.value(), KLT_[e], klt_method);
                 }
 
                 if (verbose.value())
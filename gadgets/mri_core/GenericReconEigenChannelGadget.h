@@ -50,6 +50,11 @@ namespace Gadgetron {
         /// the first N and first S will be used to compute number of channels to keep
         GADGET_PROPERTY(upstream_coil_compression_thres, double, "Threadhold for upstream coil compression", -1);
         GADGET_PROPERTY(upstream_coil_compression_num_modesKept, int, "Number of modes to keep for upstream coil compression", 0);
+        /// svd: svd of the data matrix; covariance: eigen decomposition of the channel covariance matrix
+        /// truncated: only the kept modes are computed from the covariance matrix with the randomized subspace iteration;
+        /// this requires upstream_coil_compression_num_modesKept>0, otherwise the covariance method is used
+        GADGET_PROPERTY_LIMITS(upstream_coil_compression_eigen_solver, std::string, "Method to compute the eigen channels", "svd",
+            GadgetPropertyLimitsEnumeration, "svd", "covariance", "truncated");
 
     protected:
 
@@ -558,6 +558,15 @@ namespace Gadgetron {
 
                 Gadgetron::coil_map_Inati(complex_im_recon_buf_, coil_map, ks, kz, power);
             }
+            else if (coil_map_algorithm.value() == "Inati_Fast")
+            {
+                size_t ks = 7;
+                size_t kz = 5;
+                size_t power = 3;
+                size_t step = (coil_map_step.value() > 1) ? coil_map_step.value() : 1;
+
+                Gadgetron::coil_map_Inati_fast(complex_im_recon_buf_, coil_map, ks, kz, power, step);
+            }
             else
             {
                 size_t ks = 7;
@@ -35,7 +35,10 @@ namespace Gadgetron {
 
         /// coil map estimation method
         GADGET_PROPERTY_LIMITS(coil_map_algorithm, std::string, "Method for coil map estimation", "Inati",
-            GadgetPropertyLimitsEnumeration, "Inati", "Inati_Iter");
+            GadgetPropertyLimitsEnumeration, "Inati", "Inati_Iter", "Inati_Fast");
+
+        /// for Inati_Fast, the coil map is estimated every coil_map_step pixels and interpolated
+        GADGET_PROPERTY(coil_map_step, int, "Downsampling of the coil map estimation for Inati_Fast", 1);
 
     protected:
 
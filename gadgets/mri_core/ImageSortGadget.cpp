@@ -1,11 +1,112 @@
 #include "ImageSortGadget.h"
+#include "ismrmrd/xml.h"
 
 namespace Gadgetron{
 
+  namespace
+  {
+    /// bytes of the image data described by the header
+    size_t image_bytes(const ISMRMRD::ImageHeader& h)
+    {
+      size_t element_size = 0;
+      switch (h.data_type)
+      {
+        case ISMRMRD::ISMRMRD_USHORT:
+        case ISMRMRD::ISMRMRD_SHORT:
+          element_size = 2;
+          break;
+        case ISMRMRD::ISMRMRD_UINT:
+        case ISMRMRD::ISMRMRD_INT:
+        case ISMRMRD::ISMRMRD_FLOAT:
+          element_size = 4;
+          break;
+        case ISMRMRD::ISMRMRD_DOUBLE:
+        case ISMRMRD::ISMRMRD_CXFLOAT:
+          element_size = 8;
+          break;
+        case ISMRMRD::ISMRMRD_CXDOUBLE:
+          element_size = 16;
+          break;
+        default:
+          element_size = 0;
+      }
+
+      return element_size * h.matrix_size[0] * h.matrix_size[1] * h.matrix_size[2] * h.channels;
+    }
+  }
+
+  ImageSortGadget::ImageSortGadget()
+    : streaming_(false)
+    , min_index_(0)
+    , max_index_(0)
+    , window_(0)
+    , next_round_(0)
+    , next_index_(0)
+    , held_bytes_(0)
+    , peak_held_bytes_(0)
+    , peak_held_images_(0)
+    , num_released_(0)
+    , sum_latency_ms_(0)
+    , max_latency_ms_(0)
+  {
+  }
+
+  int ImageSortGadget::process_config(ACE_Message_Block* mb)
+  {
+    streaming_ = false;
+
+    if (!streaming.value()) return GADGET_OK;
+
+    ISMRMRD::IsmrmrdHeader h;
+    ISMRMRD::deserialize(mb->rd_ptr(), h);
+
+    std::string sorting_dimension_local = sorting_dimension.value();
+
+    const ISMRMRD::Optional<ISMRMRD::Limit>* limit = NULL;
+    if (h.encoding.size() > 0) {
+      ISMRMRD::EncodingLimits& e_limits = h.encoding[0].encodingLimits;
+
+      if (sorting_dimension_local.compare("average") == 0) {
+	limit = &e_limits.average;
+      } else if (sorting_dimension_local.compare("slice") == 0) {
+	limit = &e_limits.slice;
+      } else if (sorting_dimension_local.compare("contrast") == 0) {
+	limit = &e_limits.contrast;
+      } else if (sorting_dimension_local.compare("phase") == 0) {
+	limit = &e_limits.phase;
+      } else if (sorting_dimension_local.compare("repetition") == 0) {
+	limit = &e_limits.repetition;
+      } else if (sorting_dimension_local.compare("set") == 0) {
+	limit = &e_limits.set;
+      }
+    }
+
+    if (limit == NULL || !limit->is_present() || (*limit)->maximum < (*limit)->minimum) {
+      GWARN_STREAM("ImageSortGadget: no encoding limit for " << sorting_dimension_local << ", images are sorted at the end of the stream");
+      return GADGET_OK;
+    }
+
+    streaming_ = true;
+    min_index_ = (*limit)->minimum;
+    max_index_ = (*limit)->maximum;
+
+    window_ = (out_of_order_window.value() > 0) ? (size_t)out_of_order_window.value() : (size_t)(max_index_ - min_index_ + 1);
+
+    counts_.clear();
+    counts_.resize(max_index_ - min_index_ + 1, 0);
+
+    next_round_ = 0;
+    next_index_ = min_index_;
+
+    GDEBUG_STREAM("ImageSortGadget: streaming sort of " << sorting_dimension_local << " [" << min_index_ << " " << max_index_ << "], out of order window " << window_);
+
+    return GADGET_OK;
+  }
+
   int ImageSortGadget::index(GadgetContainerMessage<ISMRMRD::ImageHeader>* m1)
   {
     std::string sorting_dimension_local = sorting_dimension.value();
-    
+
     if (sorting_dimension_local.size() == 0) {
       return -1;
     } else if (sorting_dimension_local.compare("average") == 0) {
@@ -27,42 +128,126 @@ namespace Gadgetron{
     return -1;
   }
 
+  int ImageSortGadget::send_image(ImageEntry& entry)
+  {
+    held_bytes_ -= image_bytes(*entry.mb_->getObjectPtr());
+
+    std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - entry.arrival_;
+    sum_latency_ms_ += latency.count();
+    if (latency.count() > max_latency_ms_) max_latency_ms_ = latency.count();
+    num_released_++;
+
+    if (this->next()->putq(entry.mb_) == -1) {
+      entry.mb_->release();
+      GERROR("Error passing data on to next gadget\n");
+      return GADGET_FAIL;
+    }
+
+    return GADGET_OK;
+  }
+
+  void ImageSortGadget::advance_next()
+  {
+    next_index_++;
+    if (next_index_ > max_index_) {
+      next_index_ = min_index_;
+      next_round_++;
+    }
+  }
+
+  int ImageSortGadget::release_images(bool flush)
+  {
+    while (!heap_.empty()) {
+      ImageEntry top = heap_.top();
+
+      // an image whose slot was given up arrives late and is sent at once
+      bool late = (top.round_ < next_round_) || (top.round_ == next_round_ && top.index_ < next_index_);
+      bool due = (top.round_ == next_round_ && top.index_ == next_index_);
+
+      if (!late && !due && !flush && heap_.size() <= window_) break;
+
+      heap_.pop();
+
+      if (!late) {
+	// move on to the successor of the released image; a missing predecessor is skipped and its
+	// index counts the slot, the next image of that index belongs to the following round
+	while (next_round_ < top.round_ || (next_round_ == top.round_ && next_index_ < top.index_)) {
+	  size_t& count = counts_[next_index_ - min_index_];
+	  if (count <= next_round_) count = next_round_ + 1;
+	  advance_next();
+	}
+	advance_next();
+      }
+
+      if (send_image(top) != GADGET_OK) return GADGET_FAIL;
+    }
+
+    return GADGET_OK;
+  }
+
   int ImageSortGadget::close(unsigned long flags)
   {
-    GDEBUG("++++++ close call with %d images\n", images_.size());
+    GDEBUG("++++++ close call with %d images\n", images_.size() + heap_.size());
+
+    if (streaming_) {
+      if (release_images(true) != GADGET_OK) return GADGET_FAIL;
+    }
+
     if (images_.size()) {
-      
+
       std::sort(images_.begin(),images_.end(), image_entry_compare);
-      
+
       for (auto it = images_.begin(); it != images_.end(); it++) {
-	if (this->next()->putq(it->mb_) == -1) {
-	  it->mb_->release();
-	  GERROR("Error passing data on to next gadget\n");
+	if (send_image(*it) != GADGET_OK) {
+	  images_.clear();
 	  return GADGET_FAIL;
 	}
       }
-      
+
       images_.clear();
     }
+
+    if (perform_timing.value() && num_released_ > 0) {
+      GDEBUG_STREAM("ImageSortGadget: " << num_released_ << " images sorted, peak held " << peak_held_images_ << " images, "
+		    << peak_held_bytes_ / (1024.0*1024.0) << " MB, latency mean " << sum_latency_ms_ / num_released_ << " ms, max " << max_latency_ms_ << " ms");
+    }
+
     return GADGET_OK;
   }
-  
+
   int ImageSortGadget::process(GadgetContainerMessage<ISMRMRD::ImageHeader>* m1)
   {
-    
-    if (index(m1) < 0) {
+    int ind = index(m1);
+
+    if (ind < 0 || (streaming_ && (ind < min_index_ || ind > max_index_))) {
       if (this->next()->putq(m1) == -1) {
 	m1->release();
 	GERROR("Error passing data on to next gadget\n");
 	return GADGET_FAIL;
       }
+      return GADGET_OK;
     }
 
     ImageEntry i;
-    i.index_ = index(m1);
+    i.index_ = ind;
     i.mb_ = m1;
+    i.round_ = 0;
+    i.arrival_ = std::chrono::steady_clock::now();
+
+    held_bytes_ += image_bytes(*m1->getObjectPtr());
+    if (held_bytes_ > peak_held_bytes_) peak_held_bytes_ = held_bytes_;
+
+    if (streaming_) {
+      i.round_ = counts_[ind - min_index_]++;
+      heap_.push(i);
+
+      if (heap_.size() > peak_held_images_) peak_held_images_ = heap_.size();
+
+      return release_images(false);
+    }
 
     images_.push_back(i);
+    if (images_.size() > peak_held_images_) peak_held_images_ = images_.size();
 
     return GADGET_OK;
   }
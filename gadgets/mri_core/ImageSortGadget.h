@@ -9,6 +9,8 @@
 
 #include <ismrmrd/ismrmrd.h>
 #include <complex>
+#include <chrono>
+#include <queue>
 
 namespace Gadgetron{
 
@@ -16,21 +18,36 @@ namespace Gadgetron{
   {
     int index_;
     GadgetContainerMessage<ISMRMRD::ImageHeader>* mb_;
+
+    /// streaming mode, how many images with the same index arrived before this one
+    size_t round_;
+    std::chrono::steady_clock::time_point arrival_;
   };
 
-  bool image_entry_compare(const ImageEntry& i, const ImageEntry& j)
+  inline bool image_entry_compare(const ImageEntry& i, const ImageEntry& j)
   {
     return (i.index_<j.index_);
   }
 
+  /// order of the streaming heap, the smallest [round index] is on top
+  struct ImageEntryLater
+  {
+    bool operator()(const ImageEntry& i, const ImageEntry& j) const
+    {
+      return (i.round_ > j.round_) || (i.round_ == j.round_ && i.index_ > j.index_);
+    }
+  };
+
   class EXPORTGADGETSMRICORE ImageSortGadget : public Gadget1 < ISMRMRD::ImageHeader >
   {
   public:
     GADGET_DECLARE(ImageSortGadget);
 
+    ImageSortGadget();
+
   protected:
     GADGET_PROPERTY_LIMITS(sorting_dimension, std::string, "Dimension that data will be sorted by", "slice",
-			   GadgetPropertyLimitsEnumeration, 
+			   GadgetPropertyLimitsEnumeration,
 			   "average",
 			   "slice",
 			   "contrast",
@@ -38,12 +55,48 @@ namespace Gadgetron{
 			   "repetition",
 			   "set");
 
+    GADGET_PROPERTY(streaming, bool, "Release images in order as soon as their predecessors arrived, needs the encoding limits of the sorting dimension", false);
+    GADGET_PROPERTY(out_of_order_window, int, "Streaming mode, maximal number of images held while waiting for a missing index; 0 means one pass over the sorting dimension", 0);
+    GADGET_PROPERTY(perform_timing, bool, "Whether to report the peak memory held and the latency of the images at close", false);
+
+    virtual int process_config(ACE_Message_Block* mb);
     virtual int close(unsigned long flags);
     virtual int process(GadgetContainerMessage<ISMRMRD::ImageHeader>* m1);
     int index(GadgetContainerMessage<ISMRMRD::ImageHeader>* m1);
-    
+
+    /// streaming mode, send the images which are due; if flush is true, send all held images
+    int release_images(bool flush);
+
+    /// streaming mode, move the next slot to be released on by one index
+    void advance_next();
+
+    /// pass an image to the next gadget and record its latency
+    int send_image(ImageEntry& entry);
+
     std::vector<ImageEntry> images_;
-    
+
+    /// streaming mode
+    bool streaming_;
+    int min_index_;
+    int max_index_;
+    size_t window_;
+
+    std::priority_queue<ImageEntry, std::vector<ImageEntry>, ImageEntryLater> heap_;
+
+    /// number of images arrived for every index
+    std::vector<size_t> counts_;
+
+    /// the next [round index] to be released
+    size_t next_round_;
+    int next_index_;
+
+    /// memory and latency measurement
+    size_t held_bytes_;
+    size_t peak_held_bytes_;
+    size_t peak_held_images_;
+    size_t num_released_;
+    double sum_latency_ms_;
+    double max_latency_ms_;
   };
 }
 
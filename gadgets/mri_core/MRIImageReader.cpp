@@ -153,9 +153,21 @@ namespace Gadgetron{
 	return 0;
       }
 
+      buffer[meta_attrib_length] = '\0';
+
       meta = new GadgetContainerMessage<ISMRMRD::MetaContainer>();
 
-      ISMRMRD::deserialize(buffer, *(meta->getObjectPtr()));
+      if (is_meta_binary(buffer, meta_attrib_length)) {
+	if (!meta_decoder_.decode(buffer, meta_attrib_length, *(meta->getObjectPtr()))) {
+	  h->release();
+	  meta->release();
+	  delete [] buffer;
+	  GERROR("Failed to decode binary meta attributes\n");
+	  return 0;
+	}
+      } else {
+	ISMRMRD::deserialize(buffer, *(meta->getObjectPtr()));
+      }
       
       delete [] buffer;
     } 
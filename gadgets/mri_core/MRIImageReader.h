@@ -5,6 +5,7 @@
 #include "GadgetContainerMessage.h"
 #include "GadgetMessageInterface.h"
 #include "hoNDArray.h"
+#include "MetaBinaryCodec.h"
 #include "url_encode.h"
 #include "gadgetron_mricore_export.h"
 
@@ -24,6 +25,10 @@ namespace Gadgetron{
     public:
         GADGETRON_READER_DECLARE(MRIImageReader);
         virtual ACE_Message_Block* read(ACE_SOCK_Stream* stream);
+
+    protected:
+        /// meta attributes are read as XML or binary, the string table of a binary stream is kept here
+        MetaBinaryDecoder meta_decoder_;
     };
 
 }
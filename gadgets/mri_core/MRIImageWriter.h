@@ -8,6 +8,7 @@
 
 #include "GadgetMessageInterface.h"
 #include "GadgetMRIHeaders.h"
+#include "MetaBinaryCodec.h"
 #include "ismrmrd/meta.h"
 #include "gadgetron_mricore_export.h"
 
@@ -19,8 +20,18 @@ namespace Gadgetron{
     class MRIImageWriter : public GadgetMessageWriter
     {
     public:
+        MRIImageWriter() : meta_format_(GADGET_META_FORMAT_XML)
+        {
+        }
+
         virtual int write(ACE_SOCK_Stream* sock, ACE_Message_Block* mb);
 
+        /// the meta attributes are sent binary if the client asked for it, as XML otherwise
+        virtual void set_meta_format(ACE_UINT32 format)
+        {
+            meta_format_ = format;
+        }
+
         template <typename T>
         int write_data_attrib(ACE_SOCK_Stream* sock, GadgetContainerMessage<ISMRMRD::ImageHeader>* header, GadgetContainerMessage< hoNDArray<T> >* data)
         {
@@ -60,24 +71,39 @@ namespace Gadgetron{
             char* buf = NULL;
             size_t_type len(0);
 
+            // the strings interned for this image are taken back if the attributes are not sent
+            bool encoded = false;
+
             if (attribmb)
             {
                 try
                 {
-                    std::stringstream str;
-                    ISMRMRD::serialize(*attribmb->getObjectPtr(), str);
-                    std::string attribContent = str.str();
-                    len = attribContent.length() + 1;
+                    std::string attribContent;
+                    if (meta_format_ == GADGET_META_FORMAT_BINARY)
+                    {
+                        meta_encoder_.encode(*attribmb->getObjectPtr(), attribContent);
+                        encoded = true;
+                        len = attribContent.length();
+                    }
+                    else
+                    {
+                        std::stringstream str;
+                        ISMRMRD::serialize(*attribmb->getObjectPtr(), str);
+                        attribContent = str.str();
+                        len = attribContent.length() + 1;
+                    }
 
                     buf = new char[len];
                     GADGET_CHECK_THROW(buf != NULL);
 
                     memset(buf, '\0', sizeof(char)*len);
-                    memcpy(buf, attribContent.c_str(), len - 1);
+                    memcpy(buf, attribContent.c_str(), attribContent.length());
                 }
                 catch (...)
                 {
                     GERROR("Unable to serialize image meta attributes \n");
+                    if (encoded) meta_encoder_.rollback();
+                    if (buf != NULL) delete[] buf;
                     return -1;
                 }
             }
@@ -87,12 +113,15 @@ namespace Gadgetron{
             if ((send_cnt = sock->send_n(header->getObjectPtr(), sizeof(ISMRMRD::ImageHeader))) <= 0)
             {
                 GERROR("Unable to send image header\n");
+                if (encoded) meta_encoder_.rollback();
+                if (buf != NULL) delete[] buf;
                 return -1;
             }
 
             if ((send_cnt = sock->send_n(&len, sizeof(size_t_type))) <= 0)
             {
                 GERROR("Unable to send image meta attributes length\n");
+                if (encoded) meta_encoder_.rollback();
                 if (buf != NULL) delete[] buf;
                 return -1;
             }
@@ -102,6 +131,7 @@ namespace Gadgetron{
                 if ((send_cnt = sock->send_n(buf, len)) <= 0)
                 {
                     GERROR("Unable to send image meta attributes\n");
+                    if (encoded) meta_encoder_.rollback();
                     if (buf != NULL) delete[] buf;
                     return -1;
                 }
@@ -117,6 +147,12 @@ namespace Gadgetron{
 
             return 0;
         }
+
+    protected:
+        ACE_UINT32 meta_format_;
+
+        /// keeps the string table of the connection
+        MetaBinaryEncoder meta_encoder_;
     };
 
 }
@@ -0,0 +1,380 @@
+/** \file   MetaBinaryCodec.h
+\brief  Compact binary encoding of the image meta attributes on the wire.
+
+The XML text of ISMRMRD::serialize repeats every attribute name and value markup for every image.
+The binary encoding sends length-prefixed typed key/value entries. Strings are interned per
+connection: a string is sent once and referred to by its index in all later images, so the
+attribute names of a many-slice series cost a few bytes per image.
+
+Message layout, all integers are LEB128 varints:
+
+    "GTMB" version
+    table_size num_new_strings { length bytes }
+    num_entries { key num_values { type value } }
+
+table_size is the size of the string table before this message, the decoder checks it against its
+own table to detect a lost or reordered message. Keys and string values are either a table index
+or inline, inline strings are used when the table is full. Integers are zigzag encoded, doubles are
+8 bytes little endian. A value is encoded as integer or double only if its string is reproduced when the
+number is formatted again, so both encodings decode to the same attributes.
+
+The encoder and decoder keep the string table, one pair is needed per connection and message stream.
+The strings added by an encoded message are taken back with rollback() if the message is not sent;
+the decoder leaves its table unchanged if a message is rejected.
+*/
+
+#ifndef META_BINARY_CODEC_H
+#define META_BINARY_CODEC_H
+
+#include <ismrmrd/meta.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Gadgetron
+{
+    static const char GADGETRON_META_BINARY_MAGIC[4] = { 'G', 'T', 'M', 'B' };
+    static const uint8_t GADGETRON_META_BINARY_VERSION = 1;
+
+    /// true if the meta attribute buffer holds the binary encoding, false for XML
+    inline bool is_meta_binary(const char* buf, size_t len)
+    {
+        return (len >= sizeof(GADGETRON_META_BINARY_MAGIC) + 1) && (memcmp(buf, GADGETRON_META_BINARY_MAGIC, sizeof(GADGETRON_META_BINARY_MAGIC)) == 0);
+    }
+
+    class MetaBinaryEncoder
+    {
+    public:
+
+        enum ValueType
+        {
+            META_INTERNED_STRING = 0,
+            META_INLINE_STRING = 1,
+            META_LONG = 2,
+            META_DOUBLE = 3
+        };
+
+        /// strings longer than max_interned_length or beyond max_table_size are sent inline
+        MetaBinaryEncoder(size_t max_table_size = 4096, size_t max_interned_length = 256)
+            : max_table_size_(max_table_size), max_interned_length_(max_interned_length)
+        {
+        }
+
+        /// forgets the string table, the decoder on the other end has to be reset as well
+        void reset()
+        {
+            table_.clear();
+        }
+
+        size_t table_size() const
+        {
+            return table_.size();
+        }
+
+        /// removes the strings added to the table by the last encode, to be called if its buffer was not sent
+        void rollback()
+        {
+            for (size_t n = 0; n < new_strings_.size(); n++)
+            {
+                std::string str(*new_strings_[n]);
+                table_.erase(str);
+            }
+            new_strings_.clear();
+        }
+
+        /// replaces the content of buf with the encoding of meta
+        void encode(const ISMRMRD::MetaContainer& meta, std::string& buf)
+        {
+            new_strings_.clear();
+            body_.clear();
+
+            size_t base = table_.size();
+
+            size_t num_entries = 0;
+            for (auto it = meta.begin(); it != meta.end(); ++it) num_entries++;
+            put_varint(body_, num_entries);
+
+            for (auto it = meta.begin(); it != meta.end(); ++it)
+            {
+                put_string(it->first.c_str(), it->first.size());
+                put_varint(body_, it->second.size());
+
+                for (size_t n = 0; n < it->second.size(); n++)
+                {
+                    const char* s = it->second[n].as_str();
+                    size_t len = strlen(s);
+
+                    long l;
+                    double d;
+                    if (as_long(s, len, l))
+                    {
+                        body_.push_back((char)META_LONG);
+                        put_varint(body_, ((uint64_t)l << 1) ^ (uint64_t)(l >> (8 * sizeof(long) - 1)));
+                    }
+                    else if (as_double(s, len, d))
+                    {
+                        body_.push_back((char)META_DOUBLE);
+                        put_double(body_, d);
+                    }
+                    else
+                    {
+                        put_string(s, len);
+                    }
+                }
+            }
+
+            buf.clear();
+            buf.append(GADGETRON_META_BINARY_MAGIC, sizeof(GADGETRON_META_BINARY_MAGIC));
+            buf.push_back((char)GADGETRON_META_BINARY_VERSION);
+            put_varint(buf, base);
+            put_varint(buf, table_.size() - base);
+            for (size_t n = 0; n < new_strings_.size(); n++)
+            {
+                put_varint(buf, new_strings_[n]->size());
+                buf.append(*new_strings_[n]);
+            }
+            buf.append(body_);
+        }
+
+        static void put_varint(std::string& buf, uint64_t v)
+        {
+            while (v >= 0x80)
+            {
+                buf.push_back((char)((v & 0x7F) | 0x80));
+                v >>= 7;
+            }
+            buf.push_back((char)v);
+        }
+
+    protected:
+
+        void put_string(const char* s, size_t len)
+        {
+            std::string str(s, len);
+
+            auto it = table_.find(str);
+            if (it != table_.end())
+            {
+                body_.push_back((char)META_INTERNED_STRING);
+                put_varint(body_, it->second);
+                return;
+            }
+
+            if (table_.size() >= max_table_size_ || len > max_interned_length_)
+            {
+                body_.push_back((char)META_INLINE_STRING);
+                put_varint(body_, len);
+                body_.append(s, len);
+                return;
+            }
+
+            size_t index = table_.size();
+            it = table_.insert(std::make_pair(str, index)).first;
+            new_strings_.push_back(&it->first);
+
+            body_.push_back((char)META_INTERNED_STRING);
+            put_varint(body_, index);
+        }
+
+        static void put_double(std::string& buf, double d)
+        {
+            uint64_t u;
+            memcpy(&u, &d, sizeof(u));
+            for (size_t b = 0; b < 8; b++) buf.push_back((char)((u >> (8 * b)) & 0xFF));
+        }
+
+        /// the MetaValue of a long has the string "l"
+        static bool as_long(const char* s, size_t len, long& l)
+        {
+            if (len == 0 || len > 20) return false;
+
+            size_t start = (s[0] == '-') ? 1 : 0;
+            if (len == start) return false;
+            if (s[start] == '0' && len > start + 1) return false;
+            for (size_t n = start; n < len; n++)
+            {
+                if (s[n] < '0' || s[n] > '9') return false;
+            }
+
+            char* end;
+            errno = 0;
+            l = strtol(s, &end, 10);
+            if (errno != 0 || (size_t)(end - s) != len) return false;
+
+            return !(start == 1 && l == 0);
+        }
+
+        /// the MetaValue of a double has the string formatted with the default stream precision, i.e. "%g"
+        /// exponents are left to the string encoding, the long of a MetaValue parsed from "1e+06" differs
+        static bool as_double(const char* s, size_t len, double& d)
+        {
+            if (len == 0 || len > 24) return false;
+
+            for (size_t n = 0; n < len; n++)
+            {
+                if ((s[n] < '0' || s[n] > '9') && s[n] != '.' && s[n] != '-') return false;
+            }
+
+            char* end;
+            d = strtod(s, &end);
+            if ((size_t)(end - s) != len) return false;
+
+            char formatted[32];
+            int n = snprintf(formatted, sizeof(formatted), "%g", d);
+            return (n == (int)len) && (memcmp(formatted, s, len) == 0);
+        }
+
+        size_t max_table_size_;
+        size_t max_interned_length_;
+
+        std::unordered_map<std::string, size_t> table_;
+        std::vector<const std::string*> new_strings_;
+        std::string body_;
+    };
+
+    class MetaBinaryDecoder
+    {
+    public:
+
+        void reset()
+        {
+            table_.clear();
+        }
+
+        size_t table_size() const
+        {
+            return table_.size();
+        }
+
+        /// appends the attributes of the encoded buffer to meta, returns false for a malformed buffer
+        /// or if the string table of the encoder is out of step; the string table is unchanged then
+        bool decode(const char* buf, size_t len, ISMRMRD::MetaContainer& meta)
+        {
+            size_t table_size = table_.size();
+            if (decode_message(buf, len, meta)) return true;
+
+            table_.resize(table_size);
+            return false;
+        }
+
+    protected:
+
+        bool decode_message(const char* buf, size_t len, ISMRMRD::MetaContainer& meta)
+        {
+            if (!is_meta_binary(buf, len)) return false;
+
+            const char* p = buf + sizeof(GADGETRON_META_BINARY_MAGIC);
+            const char* end = buf + len;
+
+            if ((uint8_t)*p++ != GADGETRON_META_BINARY_VERSION) return false;
+
+            uint64_t base, num_new;
+            if (!get_varint(p, end, base) || base != table_.size()) return false;
+            if (!get_varint(p, end, num_new)) return false;
+
+            for (uint64_t n = 0; n < num_new; n++)
+            {
+                uint64_t slen;
+                if (!get_varint(p, end, slen) || slen > (uint64_t)(end - p)) return false;
+                table_.push_back(std::string(p, (size_t)slen));
+                p += slen;
+            }
+
+            uint64_t num_entries;
+            if (!get_varint(p, end, num_entries)) return false;
+
+            //Numbers are appended as their string, as from XML; formatting is cheaper than the stream of a MetaValue
+            std::string key, value;
+            char number[32];
+            for (uint64_t e = 0; e < num_entries; e++)
+            {
+                uint8_t type;
+                if (!get_byte(p, end, type) || !get_string(p, end, type, key)) return false;
+
+                uint64_t num_values;
+                if (!get_varint(p, end, num_values)) return false;
+
+                for (uint64_t n = 0; n < num_values; n++)
+                {
+                    if (!get_byte(p, end, type)) return false;
+
+                    if (type == MetaBinaryEncoder::META_LONG)
+                    {
+                        uint64_t z;
+                        if (!get_varint(p, end, z)) return false;
+                        long l = (long)(z >> 1) ^ -(long)(z & 1);
+                        snprintf(number, sizeof(number), "%ld", l);
+                        meta.append(key.c_str(), (const char*)number);
+                    }
+                    else if (type == MetaBinaryEncoder::META_DOUBLE)
+                    {
+                        if (end - p < 8) return false;
+                        uint64_t u = 0;
+                        for (size_t b = 0; b < 8; b++) u |= (uint64_t)(uint8_t)p[b] << (8 * b);
+                        p += 8;
+
+                        double d;
+                        memcpy(&d, &u, sizeof(d));
+                        snprintf(number, sizeof(number), "%g", d);
+                        meta.append(key.c_str(), (const char*)number);
+                    }
+                    else
+                    {
+                        if (!get_string(p, end, type, value)) return false;
+                        meta.append(key.c_str(), value.c_str());
+                    }
+                }
+            }
+
+            return p == end;
+        }
+
+        static bool get_byte(const char*& p, const char* end, uint8_t& b)
+        {
+            if (p >= end) return false;
+            b = (uint8_t)*p++;
+            return true;
+        }
+
+        static bool get_varint(const char*& p, const char* end, uint64_t& v)
+        {
+            v = 0;
+            for (unsigned int shift = 0; shift < 64; shift += 7)
+            {
+                if (p >= end) return false;
+                uint8_t b = (uint8_t)*p++;
+                v |= (uint64_t)(b & 0x7F) << shift;
+                if (!(b & 0x80)) return true;
+            }
+            return false;
+        }
+
+        bool get_string(const char*& p, const char* end, uint8_t type, std::string& s)
+        {
+            uint64_t v;
+            if (!get_varint(p, end, v)) return false;
+
+            if (type == MetaBinaryEncoder::META_INTERNED_STRING)
+            {
+                if (v >= table_.size()) return false;
+                s = table_[(size_t)v];
+                return true;
+            }
+
+            if (type != MetaBinaryEncoder::META_INLINE_STRING || v > (uint64_t)(end - p)) return false;
+            s.assign(p, (size_t)v);
+            p += v;
+            return true;
+        }
+
+        std::vector<std::string> table_;
+    };
+}
+
+#endif // META_BINARY_CODEC_H
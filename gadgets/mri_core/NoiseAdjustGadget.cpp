@@ -4,16 +4,12 @@
 #include "hoMatrix.h"
 #include "hoNDArray_linalg.h"
 #include "hoNDArray_reductions.h"
+#include "NoiseDependencyStore.h"
 
 #ifdef USE_OMP
 #include "omp.h"
 #endif // USE_OMP
 
-#ifndef _WIN32
-#include <sys/types.h>
-#include <sys/stat.h>
-#endif // _WIN32
-
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
 
@@ -26,6 +22,7 @@ namespace Gadgetron{
     , noise_bw_scale_factor_(1.0f)
     , noise_dwell_time_us_(-1.0f)
     , noiseCovarianceLoaded_(false)
+    , noisePrewhitenerLoaded_(false)
     , saved_(false)
   {
     noise_dependency_prefix_ = "GadgetronNoiseCovarianceMatrix";
@@ -107,8 +104,24 @@ namespace Gadgetron{
 	      full_name_stored_noise_dependency_ = this->generateNoiseDependencyFilename(generateMeasurementIdOfNoiseDependency(measurement_id_of_noise_dependency_));
 	      GDEBUG("Stored noise dependency is %s\n", full_name_stored_noise_dependency_.c_str());
 		  
-	      // try to load the precomputed noise prewhitener
-	      if ( !this->loadNoiseCovariance() ) {
+	      // the covariance and the prewhitener computed when the noise was saved, found without reading the folder
+	      NoiseDependencyStore::LoadStatus status = NoiseDependencyStore::instance()->load(full_name_stored_noise_dependency_,
+											      NoiseDependencyStore::coil_signature(current_ismrmrd_header_),
+											      noise_dwell_time_us_,
+											      noise_covariance_matrixf_,
+											      noise_prewhitener_matrixf_);
+	      if ( status == NoiseDependencyStore::COIL_MISMATCH ) {
+		GDEBUG("Noise and measurement coil labels don't match\n");
+		return GADGET_FAIL;
+	      } else if ( status == NoiseDependencyStore::LOADED ) {
+		GDEBUG("Stored noise prewhitener is found : %s\n", full_name_stored_noise_dependency_.c_str());
+		GDEBUG("Stored noise dwell time in us is %f\n", noise_dwell_time_us_);
+		GDEBUG("Stored noise channel number is %d\n", noise_covariance_matrixf_.get_size(0));
+
+		noiseCovarianceLoaded_ = true;
+		noisePrewhitenerLoaded_ = true;
+		number_of_noise_samples_ = 1; //When we load the matrix, it is already scaled.
+	      } else if ( status == NoiseDependencyStore::NOT_FOUND || !this->loadNoiseCovariance() ) {
 		GDEBUG("Stored noise dependency is NOT found : %s\n", full_name_stored_noise_dependency_.c_str());
 		noiseCovarianceLoaded_ = false;
 		noise_dwell_time_us_ = -1;
@@ -202,15 +215,7 @@ namespace Gadgetron{
 
   std::string NoiseAdjustGadget::generateNoiseDependencyFilename(const std::string& measurement_id)
   {
-    std::string full_name_stored_noise_dependency;
-
-    full_name_stored_noise_dependency = noise_dependency_folder_;
-    full_name_stored_noise_dependency.append("/");
-    full_name_stored_noise_dependency.append(noise_dependency_prefix_);
-    full_name_stored_noise_dependency.append("_");
-    full_name_stored_noise_dependency.append(measurement_id);
-
-    return full_name_stored_noise_dependency;
+    return NoiseDependencyStore::dependency_filename(noise_dependency_folder_, noise_dependency_prefix_, measurement_id);
   }
 
   bool NoiseAdjustGadget::loadNoiseCovariance()
@@ -254,9 +259,6 @@ namespace Gadgetron{
 
   bool NoiseAdjustGadget::saveNoiseCovariance()
   {
-    char* buf = NULL;
-    size_t len(0);
-    
     //Do we have any noise?
     if (noise_covariance_matrixf_.get_number_of_elements() == 0) {
       return true;
@@ -269,45 +271,22 @@ namespace Gadgetron{
       covf *= std::complex<float>(1.0/(float)(number_of_noise_samples_-1),0.0);
     }
 
-    if ( !covf.serialize(buf, len) ) {
-      GDEBUG("Noise covariance serialization failed ...\n");
-      return false;
+    //The prewhitener is computed now, scans using this noise do not need to
+    hoNDArray< std::complex<float> > prewhitener(covf);
+    bool has_prewhitener = true;
+    try {
+      computeCholeskyInverse(prewhitener);
+    } catch (...) {
+      GWARN_STREAM("Noise prewhitener cannot be computed, only the noise covariance is saved");
+      has_prewhitener = false;
     }
 
     std::stringstream xml_ss;
     ISMRMRD::serialize(current_ismrmrd_header_, xml_ss);
-    std::string xml_str = xml_ss.str();
-    uint32_t xml_length = static_cast<uint32_t>(xml_str.size());
 
-    std::ofstream outfile;
-    std::string filename  = this->generateNoiseDependencyFilename(measurement_id_);
-    outfile.open (filename.c_str(), std::ios::out|std::ios::binary);
-
-    if (outfile.good())
-      {
-	GDEBUG("write out the noise dependency file : %s\n", filename.c_str());
-	outfile.write( reinterpret_cast<char*>(&xml_length), 4);
-	outfile.write( xml_str.c_str(), xml_length );
-	outfile.write( reinterpret_cast<char*>(&noise_dwell_time_us_), sizeof(float));
-	outfile.write( reinterpret_cast<char*>(&len), sizeof(size_t));
-	outfile.write(buf, len);
-	outfile.close();
-
-	// set the permission for the noise file to be rewritable
-#ifndef _WIN32
-	int res = chmod(filename.c_str(), S_IRUSR|S_IWUSR|S_IXUSR|S_IRGRP|S_IWGRP|S_IXGRP|S_IROTH|S_IWOTH|S_IXOTH);
-	if ( res != 0 ) {
-	  GDEBUG("Changing noise prewhitener file permission failed ...\n");
-	}
-#endif // _WIN32
-      } else {
-      delete [] buf;
-      GERROR_STREAM("Noise prewhitener file is not good for writing");
-      return false;
-    }
-
-    delete [] buf;
-    return true;
+    return NoiseDependencyStore::instance()->save(this->generateNoiseDependencyFilename(measurement_id_), xml_ss.str(), noise_dwell_time_us_,
+						  NoiseDependencyStore::coil_signature(current_ismrmrd_header_),
+						  covf, has_prewhitener ? &prewhitener : NULL);
   }
 
   void NoiseAdjustGadget::computeNoisePrewhitener()
@@ -318,6 +297,14 @@ namespace Gadgetron{
     if (!noise_decorrelation_calculated_) {
       
       if (number_of_noise_samples_ > 0 ) {
+	//The stored prewhitener is valid if no channel is scale only
+	if (noisePrewhitenerLoaded_ && scale_only_channels_.empty()
+	    && noise_prewhitener_matrixf_.dimensions_equal(&noise_covariance_matrixf_)) {
+	  GDEBUG("Using the stored noise prewhitener\n");
+	  noise_decorrelation_calculated_ = true;
+	  return;
+	}
+
 	GDEBUG("Calculating noise decorrelation\n");
 	
 	noise_prewhitener_matrixf_ = noise_covariance_matrixf_;
@@ -335,28 +322,35 @@ namespace Gadgetron{
 	  }
 	}
 
-    float v = Gadgetron::norm1(noise_covariance_matrixf_);
+    computeCholeskyInverse(noise_prewhitener_matrixf_);
+
+    noise_decorrelation_calculated_ = true;
+
+      } else {
+	noise_decorrelation_calculated_ = false;
+      }
+    }
+  }
+
+  void NoiseAdjustGadget::computeCholeskyInverse(hoNDArray< std::complex<float> >& m)
+  {
+    size_t c = m.get_size(0);
+
+    float v = Gadgetron::norm1(m);
     if (v <= 0)
     {
         GDEBUG("Accumulated noise prewhietner is empty\n");
         for (size_t cha = 0; cha < c; cha++)
         {
-            noise_prewhitener_matrixf_(cha, cha) = 1;
+            m(cha, cha) = 1;
         }
     }
     else
     {
         //Cholesky and invert lower triangular
-        arma::cx_fmat noise_covf = as_arma_matrix(&noise_prewhitener_matrixf_);
+        arma::cx_fmat noise_covf = as_arma_matrix(&m);
         noise_covf = arma::inv(arma::trimatu(arma::chol(noise_covf)));
     }
-
-    noise_decorrelation_calculated_ = true;
-
-      } else {
-	noise_decorrelation_calculated_ = false;
-      }
-    }
   }
 
   int NoiseAdjustGadget::process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1, GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2)
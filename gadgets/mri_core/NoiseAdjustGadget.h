@@ -45,6 +45,8 @@ namespace Gadgetron {
       float noise_bw_scale_factor_;
       float receiver_noise_bandwidth_;
       bool noiseCovarianceLoaded_;
+      // the prewhitener loaded from the dependency store, computed from the covariance without scale only channels
+      bool noisePrewhitenerLoaded_;
       bool perform_noise_adjust_;
       bool pass_nonconformant_data_;
       bool saved_;
@@ -66,6 +68,9 @@ namespace Gadgetron {
       bool saveNoiseCovariance();
       void computeNoisePrewhitener();
 
+      // replace the covariance matrix m by the inverse of its Cholesky factor
+      void computeCholeskyInverse(hoNDArray< std::complex<float> >& m);
+
       //We will store/load a copy of the noise scans XML header to enable us to check which coil layout, etc.
       ISMRMRD::IsmrmrdHeader current_ismrmrd_header_;
       ISMRMRD::IsmrmrdHeader noise_ismrmrd_header_;
@@ -0,0 +1,572 @@
+#include "NoiseDependencyStore.h"
+#include "log.h"
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif // _WIN32
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/version.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace Gadgetron{
+
+namespace
+{
+  /// fixed layout of the sidecar, followed by the covariance and the prewhitener [CHA CHA] as complex float
+  struct SidecarHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    float dwell_time_us;
+    uint32_t reserved;
+    unsigned long long coil_signature;
+  };
+
+  const char sidecar_magic[8] = { 'G', 'T', 'N', 'O', 'I', 'S', 'E', '\0' };
+  const uint32_t sidecar_version = 1;
+
+  /// temporary sidecars older than this are removed when the folder is scanned
+  const double stale_tmp_seconds = 600.0;
+
+  std::string filename_of(const boost::filesystem::path& p)
+  {
+#if BOOST_VERSION < 104600
+    return p.filename();
+#else
+    return p.filename().string();
+#endif
+  }
+
+  void set_permission(const std::string& filename)
+  {
+    // set the permission for the noise file to be rewritable
+#ifndef _WIN32
+    int res = chmod(filename.c_str(), S_IRUSR|S_IWUSR|S_IXUSR|S_IRGRP|S_IWGRP|S_IXGRP|S_IROTH|S_IWOTH|S_IXOTH);
+    if ( res != 0 ) {
+      GDEBUG("Changing noise prewhitener file permission failed ...\n");
+    }
+#endif // _WIN32
+  }
+
+  bool ends_with(const std::string& s, const std::string& suffix)
+  {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+  }
+}
+
+struct NoiseDependencyStore::Mapping
+{
+  boost::interprocess::file_mapping file;
+  boost::interprocess::mapped_region region;
+};
+
+NoiseDependencyStore* NoiseDependencyStore::instance()
+{
+  static NoiseDependencyStore store;
+  return &store;
+}
+
+NoiseDependencyStore::NoiseDependencyStore()
+  : stop_(false)
+  , sweep_interval_(300.0)
+  , cache_size_(16)
+  , folder_scans_(0)
+{
+}
+
+NoiseDependencyStore::~NoiseDependencyStore()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = true;
+  }
+  sweep_cond_.notify_all();
+
+  if (thread_.joinable()) thread_.join();
+}
+
+const char* NoiseDependencyStore::sidecar_suffix()
+{
+  return ".prewhitener";
+}
+
+unsigned long long NoiseDependencyStore::coil_signature(const ISMRMRD::IsmrmrdHeader& h)
+{
+  if (!h.acquisitionSystemInformation) return 0;
+
+  // FNV-1a over the number of coils and the number and name of every coil
+  const unsigned long long prime = 1099511628211ULL;
+  unsigned long long s = 14695981039346656037ULL;
+
+  const std::vector<ISMRMRD::CoilLabel>& labels = h.acquisitionSystemInformation->coilLabel;
+
+  unsigned long long n = labels.size();
+  s = (s ^ n) * prime;
+
+  for (size_t l = 0; l < labels.size(); l++) {
+    s = (s ^ (unsigned long long)labels[l].coilNumber) * prime;
+    for (size_t c = 0; c < labels[l].coilName.size(); c++) {
+      s = (s ^ (unsigned char)labels[l].coilName[c]) * prime;
+    }
+    s = (s ^ 0xFF) * prime;
+  }
+
+  return (s == 0) ? 1 : s;
+}
+
+std::string NoiseDependencyStore::dependency_filename(const std::string& folder, const std::string& prefix, const std::string& measurement_id)
+{
+  std::string full_name_stored_noise_dependency;
+
+  full_name_stored_noise_dependency = folder;
+  full_name_stored_noise_dependency.append("/");
+  full_name_stored_noise_dependency.append(prefix);
+  full_name_stored_noise_dependency.append("_");
+  full_name_stored_noise_dependency.append(measurement_id);
+
+  return full_name_stored_noise_dependency;
+}
+
+std::string NoiseDependencyStore::normalize_folder(const std::string& folder)
+{
+  std::string f(folder);
+  while (f.size() > 1 && (f[f.size()-1] == '/' || f[f.size()-1] == '\\')) f.erase(f.size()-1);
+  return f;
+}
+
+void NoiseDependencyStore::split_filename(const std::string& filename, std::string& folder, std::string& name)
+{
+  boost::filesystem::path p(filename);
+  folder = normalize_folder(p.parent_path().string());
+  name = filename_of(p);
+}
+
+void NoiseDependencyStore::set_cache_size(size_t n)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  cache_size_ = n;
+  while (mappings_.size() > cache_size_) mappings_.pop_back();
+}
+
+size_t NoiseDependencyStore::get_cache_size()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return cache_size_;
+}
+
+void NoiseDependencyStore::set_sweep_interval(double seconds)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    sweep_interval_ = (seconds > 1.0) ? seconds : 1.0;
+  }
+  sweep_cond_.notify_all();
+}
+
+size_t NoiseDependencyStore::get_number_of_folder_scans()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  return folder_scans_;
+}
+
+void NoiseDependencyStore::set_time_limit(const std::string& folder, double hours)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  Folder* index = folder_index(normalize_folder(folder));
+  if (index) index->time_limit_in_hours = (hours > 0) ? hours : 0;
+}
+
+bool NoiseDependencyStore::scan_folder(const std::string& folder, Folder& index)
+{
+  using namespace boost::filesystem;
+
+  try {
+    path p(folder);
+    if (!exists(p) || !is_directory(p)) return false;
+
+    std::unordered_map<std::string, Entry> entries;
+    std::string suffix(sidecar_suffix());
+    std::time_t now = std::time(NULL);
+    std::vector<path> stale;
+
+    for (directory_iterator it(p); it != directory_iterator(); ++it) {
+      std::string name = filename_of(it->path());
+      if (ends_with(name, suffix)) continue;
+
+      // a sidecar being written; one not touched for a while was left by a save which failed
+      if (ends_with(name, ".tmp")) {
+	boost::system::error_code ec;
+	std::time_t t = last_write_time(it->path(), ec);
+	if (!ec && std::abs((double)now - (double)t) > stale_tmp_seconds) stale.push_back(it->path());
+	continue;
+      }
+
+      Entry e;
+      e.write_time = last_write_time(it->path());
+      e.has_sidecar = exists(path(it->path().string() + suffix));
+      entries[name] = e;
+    }
+
+    for (size_t n = 0; n < stale.size(); n++) {
+      boost::system::error_code ec;
+      remove(stale[n], ec);
+      GDEBUG_STREAM("NoiseDependencyStore: stale " << stale[n].string() << " removed");
+    }
+
+    index.entries.swap(entries);
+  }
+  catch (const filesystem_error& ex) {
+    GERROR_STREAM(ex.what());
+    return false;
+  }
+
+  return true;
+}
+
+NoiseDependencyStore::Folder* NoiseDependencyStore::folder_index(const std::string& folder)
+{
+  std::map<std::string, Folder>::iterator it = folders_.find(folder);
+  if (it != folders_.end()) return &it->second;
+
+  Folder index;
+  index.time_limit_in_hours = 0;
+  folder_scans_++;
+  if (!scan_folder(folder, index)) return NULL;
+
+  GDEBUG_STREAM("NoiseDependencyStore: " << index.entries.size() << " files indexed in " << folder);
+
+  start_thread();
+
+  return &(folders_[folder] = index);
+}
+
+bool NoiseDependencyStore::expired(const Entry& entry, const Folder& index, std::time_t now) const
+{
+  if (index.time_limit_in_hours <= 0) return false;
+  return std::abs((double)entry.write_time - (double)now) > index.time_limit_in_hours*3600.0;
+}
+
+NoiseDependencyStore::MappingPtr NoiseDependencyStore::map_sidecar(const std::string& filename)
+{
+  for (std::list< std::pair<std::string, MappingPtr> >::iterator it = mappings_.begin(); it != mappings_.end(); ++it) {
+    if (it->first == filename) {
+      mappings_.splice(mappings_.begin(), mappings_, it);
+      return mappings_.front().second;
+    }
+  }
+
+  MappingPtr m(new Mapping());
+  m->file = boost::interprocess::file_mapping(filename.c_str(), boost::interprocess::read_only);
+  m->region = boost::interprocess::mapped_region(m->file, boost::interprocess::read_only);
+
+  if (cache_size_ > 0) {
+    mappings_.push_front(std::make_pair(filename, m));
+    while (mappings_.size() > cache_size_) mappings_.pop_back();
+  }
+
+  return m;
+}
+
+void NoiseDependencyStore::drop_mapping(const std::string& filename)
+{
+  for (std::list< std::pair<std::string, MappingPtr> >::iterator it = mappings_.begin(); it != mappings_.end(); ++it) {
+    if (it->first == filename) {
+      mappings_.erase(it);
+      return;
+    }
+  }
+}
+
+NoiseDependencyStore::LoadStatus NoiseDependencyStore::load(const std::string& filename, unsigned long long coil_signature,
+							    float& dwell_time_us,
+							    hoNDArray< std::complex<float> >& covariance,
+							    hoNDArray< std::complex<float> >& prewhitener)
+{
+  std::string folder, name;
+  split_filename(filename, folder, name);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  Folder* index = folder_index(folder);
+  if (!index) return NOT_FOUND;
+
+  std::unordered_map<std::string, Entry>::iterator it = index->entries.find(name);
+
+  if (it == index->entries.end()) {
+    // written by another process after the folder was indexed
+    try {
+      if (!boost::filesystem::exists(filename)) return NOT_FOUND;
+
+      Entry e;
+      e.write_time = boost::filesystem::last_write_time(filename);
+      e.has_sidecar = boost::filesystem::exists(filename + sidecar_suffix());
+      it = index->entries.insert(std::make_pair(name, e)).first;
+    }
+    catch (const boost::filesystem::filesystem_error& ex) {
+      GERROR_STREAM(ex.what());
+      return NOT_FOUND;
+    }
+  }
+
+  if (!it->second.has_sidecar) return NO_PREWHITENER;
+
+  std::string sidecar = filename + sidecar_suffix();
+
+  try {
+    MappingPtr m = map_sidecar(sidecar);
+
+    const char* p = static_cast<const char*>(m->region.get_address());
+    size_t bytes = m->region.get_size();
+
+    SidecarHeader h;
+    if (bytes < sizeof(SidecarHeader)) {
+      drop_mapping(sidecar);
+      return NO_PREWHITENER;
+    }
+    memcpy(&h, p, sizeof(SidecarHeader));
+
+    size_t num = (size_t)h.channels * h.channels;
+
+    if (memcmp(h.magic, sidecar_magic, sizeof(sidecar_magic)) != 0 || h.version != sidecar_version
+	|| bytes < sizeof(SidecarHeader) + 2*num*sizeof(std::complex<float>)) {
+      GWARN_STREAM("NoiseDependencyStore: invalid sidecar " << sidecar);
+      drop_mapping(sidecar);
+      return NO_PREWHITENER;
+    }
+
+    if (h.coil_signature != coil_signature) return COIL_MISMATCH;
+
+    dwell_time_us = h.dwell_time_us;
+
+    covariance.create(h.channels, h.channels);
+    prewhitener.create(h.channels, h.channels);
+
+    memcpy(covariance.begin(), p + sizeof(SidecarHeader), num*sizeof(std::complex<float>));
+    memcpy(prewhitener.begin(), p + sizeof(SidecarHeader) + num*sizeof(std::complex<float>), num*sizeof(std::complex<float>));
+  }
+  catch (const std::exception& ex) {
+    GERROR_STREAM("NoiseDependencyStore: cannot map " << sidecar << " : " << ex.what());
+    drop_mapping(sidecar);
+    return NO_PREWHITENER;
+  }
+
+  return LOADED;
+}
+
+bool NoiseDependencyStore::save(const std::string& filename, const std::string& xml, float dwell_time_us, unsigned long long coil_signature,
+				const hoNDArray< std::complex<float> >& covariance,
+				const hoNDArray< std::complex<float> >* prewhitener)
+{
+  char* buf = NULL;
+  size_t len(0);
+
+  if ( !covariance.serialize(buf, len) ) {
+    GDEBUG("Noise covariance serialization failed ...\n");
+    return false;
+  }
+
+  uint32_t xml_length = static_cast<uint32_t>(xml.size());
+
+  std::ofstream outfile;
+  outfile.open (filename.c_str(), std::ios::out|std::ios::binary);
+
+  if (outfile.good()) {
+    GDEBUG("write out the noise dependency file : %s\n", filename.c_str());
+    outfile.write( reinterpret_cast<char*>(&xml_length), 4);
+    outfile.write( xml.c_str(), xml_length );
+    outfile.write( reinterpret_cast<char*>(&dwell_time_us), sizeof(float));
+    outfile.write( reinterpret_cast<char*>(&len), sizeof(size_t));
+    outfile.write(buf, len);
+    outfile.close();
+
+    set_permission(filename);
+  } else {
+    delete [] buf;
+    GERROR_STREAM("Noise prewhitener file is not good for writing");
+    return false;
+  }
+
+  delete [] buf;
+
+  std::string sidecar = filename + sidecar_suffix();
+
+  bool has_sidecar = false;
+  if (prewhitener && prewhitener->get_number_of_elements() == covariance.get_number_of_elements()) {
+    SidecarHeader h;
+    memset(&h, 0, sizeof(SidecarHeader));
+    memcpy(h.magic, sidecar_magic, sizeof(sidecar_magic));
+    h.version = sidecar_version;
+    h.channels = (uint32_t)covariance.get_size(0);
+    h.dwell_time_us = dwell_time_us;
+    h.coil_signature = coil_signature;
+
+    // written under a temporary name and renamed, a reader never maps a partial sidecar
+    std::string tmp = sidecar + ".tmp";
+    std::ofstream sidefile(tmp.c_str(), std::ios::out|std::ios::binary);
+
+    if (sidefile.good()) {
+      sidefile.write(reinterpret_cast<const char*>(&h), sizeof(SidecarHeader));
+      sidefile.write(reinterpret_cast<const char*>(covariance.begin()), covariance.get_number_of_bytes());
+      sidefile.write(reinterpret_cast<const char*>(prewhitener->begin()), prewhitener->get_number_of_bytes());
+      sidefile.close();
+
+      if (sidefile.good()) {
+	try {
+	  boost::filesystem::rename(tmp, sidecar);
+	  set_permission(sidecar);
+	  has_sidecar = true;
+	}
+	catch (const boost::filesystem::filesystem_error& ex) {
+	  GERROR_STREAM(ex.what());
+	}
+      } else {
+	GWARN_STREAM("NoiseDependencyStore: cannot write " << tmp);
+      }
+    } else {
+      GWARN_STREAM("NoiseDependencyStore: cannot write " << tmp);
+    }
+
+    if (!has_sidecar) {
+      boost::system::error_code ec;
+      boost::filesystem::remove(tmp, ec);
+    }
+  }
+
+  // the sidecar of an earlier save of the same dependency does not belong to the new file
+  if (!has_sidecar) {
+    boost::system::error_code ec;
+    boost::filesystem::remove(sidecar, ec);
+    if (ec) GWARN_STREAM("NoiseDependencyStore: cannot remove " << sidecar << " : " << ec.message());
+  }
+
+  std::string folder, name;
+  split_filename(filename, folder, name);
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  drop_mapping(sidecar);
+
+  Folder* index = folder_index(folder);
+  if (index) {
+    Entry e;
+    e.write_time = std::time(NULL);
+    e.has_sidecar = has_sidecar;
+    index->entries[name] = e;
+  }
+
+  return true;
+}
+
+bool NoiseDependencyStore::list(const std::string& folder, const std::string& prefix, std::vector<std::string>& names)
+{
+  names.clear();
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  Folder* index = folder_index(normalize_folder(folder));
+  if (!index) return false;
+
+  std::time_t now = std::time(NULL);
+
+  for (std::unordered_map<std::string, Entry>::const_iterator it = index->entries.begin(); it != index->entries.end(); ++it) {
+    if (it->first.find(prefix) == std::string::npos) continue;
+    if (expired(it->second, *index, now)) continue;
+    names.push_back(it->first);
+  }
+
+  std::sort(names.begin(), names.end());
+
+  return true;
+}
+
+void NoiseDependencyStore::start_thread()
+{
+  if (thread_.joinable()) return;
+  thread_ = std::thread(&NoiseDependencyStore::svc, this);
+}
+
+void NoiseDependencyStore::svc()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (!stop_) {
+    sweep_cond_.wait_for(lock, std::chrono::duration<double>(sweep_interval_));
+    if (stop_) break;
+
+    lock.unlock();
+    sweep();
+    lock.lock();
+  }
+}
+
+void NoiseDependencyStore::sweep()
+{
+  std::vector<std::string> folders;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (std::map<std::string, Folder>::const_iterator it = folders_.begin(); it != folders_.end(); ++it) folders.push_back(it->first);
+  }
+
+  for (size_t f = 0; f < folders.size(); f++) {
+
+    // the folder is read without holding the lock, lookups go on meanwhile
+    std::time_t scan_start = std::time(NULL);
+
+    Folder scanned;
+    bool found = scan_folder(folders[f], scanned);
+
+    std::vector<std::string> to_remove;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+
+      Folder& index = folders_[folders[f]];
+      folder_scans_++;
+
+      if (found) {
+	// keep the files saved since the scan started
+	for (std::unordered_map<std::string, Entry>::const_iterator it = index.entries.begin(); it != index.entries.end(); ++it) {
+	  if (it->second.write_time >= scan_start && scanned.entries.find(it->first) == scanned.entries.end()) {
+	    scanned.entries[it->first] = it->second;
+	  }
+	}
+	index.entries.swap(scanned.entries);
+      }
+
+      std::unordered_map<std::string, Entry>::iterator it = index.entries.begin();
+      while (it != index.entries.end()) {
+	if (expired(it->second, index, scan_start)) {
+	  std::string filename = folders[f] + "/" + it->first;
+	  to_remove.push_back(filename);
+	  if (it->second.has_sidecar) {
+	    drop_mapping(filename + sidecar_suffix());
+	    to_remove.push_back(filename + sidecar_suffix());
+	  }
+	  it = index.entries.erase(it);
+	} else {
+	  ++it;
+	}
+      }
+    }
+
+    for (size_t n = 0; n < to_remove.size(); n++) {
+      boost::system::error_code ec;
+      boost::filesystem::remove(to_remove[n], ec);
+      if (ec) GWARN_STREAM("NoiseDependencyStore: cannot remove " << to_remove[n] << " : " << ec.message());
+    }
+
+    if (!to_remove.empty()) GDEBUG_STREAM("NoiseDependencyStore: " << to_remove.size() << " expired files removed from " << folders[f]);
+  }
+}
+
+}
@@ -0,0 +1,144 @@
+/** \file       NoiseDependencyStore.h
+    \brief      Process wide store of the noise dependencies written by NoiseAdjustGadget and listed by DependencyQueryGadget
+
+                A dependency folder is scanned once, after that the stored noise dependencies are found through an in-memory
+                index keyed by file name, i.e. by prefix and measurement ID. Next to the dependency file, whose format is unchanged,
+                a sidecar file keeps the covariance matrix and the prewhitener computed at save time in a fixed binary layout,
+                together with a signature of the coil configuration. Sidecars are memory mapped when loaded; the most recently
+                used mappings are kept open.
+
+                A background thread removes the dependencies older than the time limit of their folder and picks up the files
+                written by other processes.
+*/
+
+#pragma once
+
+#include "gadgetron_mricore_export.h"
+#include "hoNDArray.h"
+
+#include <ismrmrd/xml.h>
+#include <complex>
+#include <condition_variable>
+#include <ctime>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Gadgetron{
+
+class EXPORTGADGETSMRICORE NoiseDependencyStore
+{
+ public:
+
+  enum LoadStatus
+  {
+    NOT_FOUND = 0,
+    /// the dependency file exists, but was written without a sidecar
+    NO_PREWHITENER,
+    COIL_MISMATCH,
+    LOADED
+  };
+
+  static NoiseDependencyStore* instance();
+
+  ~NoiseDependencyStore();
+
+  /// suffix of the sidecar files, they are not listed as dependencies
+  static const char* sidecar_suffix();
+
+  /// hash of the coil labels of the header, 0 if the header has no acquisition system information
+  static unsigned long long coil_signature(const ISMRMRD::IsmrmrdHeader& h);
+
+  /// folder/prefix_measurementID
+  static std::string dependency_filename(const std::string& folder, const std::string& prefix, const std::string& measurement_id);
+
+  /**
+     Load the covariance [CHA CHA] and the prewhitener [CHA CHA] of a dependency file.
+     The prewhitener is the inverse of the Cholesky factor of the covariance, not scaled for the noise bandwidth.
+  */
+  LoadStatus load(const std::string& filename, unsigned long long coil_signature,
+		  float& dwell_time_us,
+		  hoNDArray< std::complex<float> >& covariance,
+		  hoNDArray< std::complex<float> >& prewhitener);
+
+  /**
+     Write the dependency file and its sidecar, and add them to the index.
+     If prewhitener is NULL, only the dependency file is written.
+  */
+  bool save(const std::string& filename, const std::string& xml, float dwell_time_us, unsigned long long coil_signature,
+	    const hoNDArray< std::complex<float> >& covariance,
+	    const hoNDArray< std::complex<float> >* prewhitener);
+
+  /// names of the dependency files in the folder whose name contains the prefix, sorted; false if the folder does not exist
+  bool list(const std::string& folder, const std::string& prefix, std::vector<std::string>& names);
+
+  /// in hours, dependencies older than this are not listed and are removed in the background; 0 keeps them
+  void set_time_limit(const std::string& folder, double hours);
+
+  /// number of memory mapped sidecars kept open
+  void set_cache_size(size_t n);
+  size_t get_cache_size();
+
+  /// in seconds, how often the background thread sweeps the folders
+  void set_sweep_interval(double seconds);
+
+  size_t get_number_of_folder_scans();
+
+ protected:
+
+  NoiseDependencyStore();
+
+  struct Mapping;
+  typedef std::shared_ptr<Mapping> MappingPtr;
+
+  struct Entry
+  {
+    std::time_t write_time;
+    bool has_sidecar;
+  };
+
+  struct Folder
+  {
+    std::unordered_map<std::string, Entry> entries;
+    double time_limit_in_hours;
+  };
+
+  static std::string normalize_folder(const std::string& folder);
+  static void split_filename(const std::string& filename, std::string& folder, std::string& name);
+
+  /// the index of a folder, the folder is scanned at the first call; called with mutex_ held
+  Folder* folder_index(const std::string& folder);
+
+  /// read the file list of the folder into the entries of index, false if the folder does not exist
+  static bool scan_folder(const std::string& folder, Folder& index);
+
+  bool expired(const Entry& entry, const Folder& index, std::time_t now) const;
+
+  /// mapping of the sidecar, opened if not cached; called with mutex_ held
+  MappingPtr map_sidecar(const std::string& filename);
+  void drop_mapping(const std::string& filename);
+
+  void start_thread();
+  void svc();
+  void sweep();
+
+  std::mutex mutex_;
+  std::condition_variable sweep_cond_;
+  std::thread thread_;
+  bool stop_;
+  double sweep_interval_;
+
+  std::map<std::string, Folder> folders_;
+
+  /// most recently used first, keyed by the sidecar file name
+  std::list< std::pair<std::string, MappingPtr> > mappings_;
+  size_t cache_size_;
+
+  size_t folder_scans_;
+};
+}
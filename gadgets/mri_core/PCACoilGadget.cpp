@@ -88,6 +88,10 @@ namespace Gadgetron {
         int samples_per_profile = m1->getObjectPtr()->number_of_samples;
         int channels = m1->getObjectPtr()->active_channels;
 
+        if (streaming.value()) {
+            return process_streaming(m1, location, is_last_scan_in_slice);
+        }
+
         it = buffering_mode_.find(location);
 
         bool is_buffering = true;
@@ -260,5 +264,232 @@ namespace Gadgetron {
         return GADGET_OK;
     }
 
+    int PCACoilGadget::process_streaming(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1, int location, bool is_last_scan_in_slice)
+    {
+        GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2 =
+            AsContainerMessage< hoNDArray< std::complex<float> > >(m1->cont());
+
+        if (!m2) {
+            GDEBUG("Fatal error, readout without data\n");
+            return GADGET_FAIL;
+        }
+
+        pending_[location].push_back(m1);
+
+        if (pca_coefficients_[location] != 0) {
+            if (is_last_scan_in_slice || (pending_[location].size() >= (size_t)streaming_block_size.value())) {
+                return send_pending(location, m1);
+            }
+            return GADGET_OK;
+        }
+
+        //Update the covariance with the central samples of this profile, the readout itself waits for the transform
+        size_t samples_per_profile = m1->getObjectPtr()->number_of_samples;
+        size_t channels = m1->getObjectPtr()->active_channels;
+
+        size_t samples_to_use = samples_per_profile > (size_t)samples_to_use_ ? (size_t)samples_to_use_ : samples_per_profile;
+
+        size_t data_offset = 0;
+        if (m1->getObjectPtr()->center_sample >= (samples_to_use >> 1)) {
+            data_offset = m1->getObjectPtr()->center_sample - (samples_to_use >> 1);
+        }
+        if (data_offset + samples_to_use > samples_per_profile) {
+            data_offset = samples_per_profile - samples_to_use;
+        }
+
+        hoNDKLTCovariance< std::complex<float> >& cov = covariance_[location];
+        if (cov.number_of_slots() != channels) {
+            cov.reset(channels);
+        }
+
+        try {
+            cov.add(m2->getObjectPtr()->begin() + data_offset, samples_to_use, samples_per_profile);
+        }
+        catch (...) {
+            GERROR("Unable to update the covariance for PCA calculation\n");
+            //The readout is released by the caller
+            pending_[location].pop_back();
+            return GADGET_FAIL;
+        }
+
+        size_t profiles = ++profiles_seen_[location];
+
+        if (is_last_scan_in_slice || (profiles >= (size_t)streaming_profiles.value())) {
+            if (prepare_streaming(location) != GADGET_OK) {
+                pending_[location].pop_back();
+                return GADGET_FAIL;
+            }
+            return send_pending(location, m1);
+        }
+
+        return GADGET_OK;
+    }
+
+    int PCACoilGadget::prepare_streaming(int location)
+    {
+        hoNDKLTCovariance< std::complex<float> >& cov = covariance_[location];
+
+        hoNDKLT< std::complex<float> >* VT = new hoNDKLT< std::complex<float> >;
+
+        try {
+            hoNDArray< std::complex<float> > C;
+            cov.covariance(C);
+
+            std::vector<size_t> untransformed(uncombined_channels_.begin(), uncombined_channels_.end());
+            VT->prepare_covariance(C, untransformed, (size_t)0);
+        }
+        catch (...) {
+            GERROR("Unable to compute PCA coefficients from the covariance of %d samples\n", (int)cov.number_of_samples());
+            delete VT;
+            return GADGET_FAIL;
+        }
+
+        GDEBUG("PCA coefficients for location %d computed from %d profiles\n", location, (int)profiles_seen_[location]);
+
+        if (pca_coefficients_[location]) {
+            delete pca_coefficients_[location];
+        }
+        pca_coefficients_[location] = VT;
+
+        //The covariance is not needed anymore
+        covariance_.erase(location);
+
+        return GADGET_OK;
+    }
+
+    int PCACoilGadget::send_pending(int location, GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* current)
+    {
+        std::vector< GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* >& pending = pending_[location];
+        hoNDKLT< std::complex<float> >* VT = pca_coefficients_[location];
+
+        //The readouts which are put are not pending anymore, on a failure the rest is released.
+        //The current readout is the last one and is released by the caller of process.
+        size_t sent = 0;
+        auto fail = [&]() {
+            for (size_t n = sent; n < pending.size(); n++) {
+                if (pending[n] != current) pending[n]->release();
+            }
+            pending.clear();
+            return GADGET_FAIL;
+        };
+
+        size_t block_size = streaming_block_size.value() > 1 ? (size_t)streaming_block_size.value() : 1;
+
+        size_t start = 0;
+        while (start < pending.size()) {
+
+            //Up to block_size readouts of the same size are transformed together
+            hoNDArray< std::complex<float> >* first =
+                AsContainerMessage< hoNDArray< std::complex<float> > >(pending[start]->cont())->getObjectPtr();
+
+            size_t RO = first->get_size(0);
+            size_t CHA = first->get_number_of_elements() / RO;
+
+            size_t end = start + 1;
+            while (end < pending.size() && end - start < block_size) {
+                hoNDArray< std::complex<float> >* d =
+                    AsContainerMessage< hoNDArray< std::complex<float> > >(pending[end]->cont())->getObjectPtr();
+
+                if (d->get_size(0) != RO || d->get_number_of_elements() != RO*CHA) break;
+                end++;
+            }
+
+            size_t K = end - start;
+
+            try {
+                if (K > 1) {
+                    //[RO*K CHA], one matrix product for the whole block
+                    block_in_.create(RO*K, CHA);
+
+                    for (size_t k = 0; k < K; k++) {
+                        const std::complex<float>* d =
+                            AsContainerMessage< hoNDArray< std::complex<float> > >(pending[start + k]->cont())->getObjectPtr()->begin();
+
+                        for (size_t c = 0; c < CHA; c++) {
+                            memcpy(block_in_.begin() + c*RO*K + k*RO, d + c*RO, sizeof(std::complex<float>)*RO);
+                        }
+                    }
+
+                    VT->transform(block_in_, block_out_, 1);
+                }
+            }
+            catch (...) {
+                GERROR("Unable to apply PCA coefficients to %d readouts\n", (int)K);
+                return fail();
+            }
+
+            for (size_t k = 0; k < K; k++) {
+                GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1 = pending[start + k];
+                GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2 =
+                    AsContainerMessage< hoNDArray< std::complex<float> > >(m1->cont());
+
+                GadgetContainerMessage< hoNDArray< std::complex<float> > >* m3 =
+                    new GadgetContainerMessage < hoNDArray< std::complex<float> > > ;
+
+                try {
+                    if (K > 1) {
+                        size_t CHA_out = block_out_.get_size(1);
+                        m3->getObjectPtr()->create(RO, CHA_out);
+
+                        for (size_t c = 0; c < CHA_out; c++) {
+                            memcpy(m3->getObjectPtr()->begin() + c*RO, block_out_.begin() + c*RO*K + k*RO, sizeof(std::complex<float>)*RO);
+                        }
+                    }
+                    else {
+                        VT->transform(*(m2->getObjectPtr()), *(m3->getObjectPtr()), 1);
+                    }
+                }
+                catch (...) {
+                    GERROR("Unable to create storage for PCA coils\n");
+                    m3->release();
+                    return fail();
+                }
+
+                m1->cont(m3);
+
+                //In case there are trajectories attached.
+                m3->cont(m2->cont());
+                m2->cont(0);
+
+                m2->release();
+
+                if (this->next()->putq(m1) < 0) {
+                    GDEBUG("Unable to put message on Q");
+                    return fail();
+                }
+                sent++;
+            }
+
+            start = end;
+        }
+
+        pending.clear();
+
+        return GADGET_OK;
+    }
+
+    int PCACoilGadget::close(unsigned long flags)
+    {
+        int ret = Gadget::close(flags);
+
+        if (flags != 0 && streaming.value()) {
+            //Locations which ended before the transform was computed
+            std::map<int, std::vector< GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* > >::iterator it;
+            for (it = pending_.begin(); it != pending_.end(); it++) {
+                if (it->second.empty()) continue;
+
+                if (pca_coefficients_[it->first] == 0 && prepare_streaming(it->first) != GADGET_OK) {
+                    return GADGET_FAIL;
+                }
+
+                if (send_pending(it->first) != GADGET_OK) {
+                    return GADGET_FAIL;
+                }
+            }
+        }
+
+        return ret;
+    }
+
     GADGET_FACTORY_DECLARE(PCACoilGadget)
 }
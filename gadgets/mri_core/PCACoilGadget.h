@@ -26,10 +26,23 @@ namespace Gadgetron {
     virtual int process_config(ACE_Message_Block* mb);
     virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
 			GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2);
+    virtual int close(unsigned long flags);
+
+    /// streaming mode: accumulate the covariance of a readout, or queue it for the transform
+    int process_streaming(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1, int location, bool is_last_scan_in_slice);
+
+    /// streaming mode: compute the transform of a location from its running covariance
+    int prepare_streaming(int location);
+
+    /// streaming mode: transform the queued readouts of a location and send them, current is the readout of the calling process
+    int send_pending(int location, GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* current = 0);
 
   private:
     GADGET_PROPERTY(uncombined_channels_by_name, std::string, "List of comma separated channels by name", "");
     GADGET_PROPERTY(present_uncombined_channels, int, "Number of uncombined channels found", 0);
+    GADGET_PROPERTY(streaming, bool, "Estimate the transform from a running covariance and send the compressed readouts as soon as it is known", false);
+    GADGET_PROPERTY(streaming_profiles, int, "Number of profiles per location before the transform is computed in the streaming mode", 16);
+    GADGET_PROPERTY(streaming_block_size, int, "Number of readouts transformed together with one matrix product in the streaming mode", 1);
 
     std::vector<unsigned int> uncombined_channels_;
     
@@ -42,6 +55,15 @@ namespace Gadgetron {
     //Map for storing PCA coefficients for each location
     std::map<int, hoNDKLT<std::complex<float> >* > pca_coefficients_;
 
+    //Streaming mode: running covariance and readouts waiting for the transform, for each location
+    std::map<int, hoNDKLTCovariance<std::complex<float> > > covariance_;
+    std::map<int, std::vector< GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* > > pending_;
+    std::map<int, size_t> profiles_seen_;
+
+    //Streaming mode: readouts of a block, stacked along the samples, before and after the transform
+    hoNDArray< std::complex<float> > block_in_;
+    hoNDArray< std::complex<float> > block_out_;
+
     int max_buffered_profiles_;
     int samples_to_use_;
   };
@@ -6,10 +6,11 @@
  */
 
 #include "PseudoReplicatorGadget.h"
-#include <random>
+#include <ace/OS_NS_sys_time.h>
+#include <ace/OS_NS_errno.h>
 namespace Gadgetron {
 
-PseudoReplicatorGadget::PseudoReplicatorGadget() : Gadget1<IsmrmrdReconData>() {
+PseudoReplicatorGadget::PseudoReplicatorGadget() : Gadget1<IsmrmrdReconData>(), repetitions_(0), replicas_in_flight_(0), noise_stream_(0) {
 	// TODO Auto-generated constructor stub
 
 }
@@ -21,17 +22,27 @@ PseudoReplicatorGadget::~PseudoReplicatorGadget() {
 int PseudoReplicatorGadget::process_config(ACE_Message_Block*) {
 
 	repetitions_ = repetitions.value();
+	replicas_in_flight_ = replicas_in_flight.value();
+
+	randn_.seed((unsigned long long)seed.value());
+	randn_.setPara(0, 1);
+	noise_stream_ = 0;
+
 	return GADGET_OK;
 }
 
 int PseudoReplicatorGadget::process(GadgetContainerMessage<IsmrmrdReconData>* m) {
 
-	std::mt19937 engine;
-	std::normal_distribution<float> distribution;
-
 	auto m_copy = *m->getObjectPtr();
+
+	//The queue of the next gadget is full when it holds replicas_in_flight messages, putq blocks until the downstream recon has caught up,
+	//so the replicas are not all in memory at once
+	if (replicas_in_flight_ > 0) {
+		this->next()->msg_queue()->high_water_mark(replicas_in_flight_*m->total_size());
+	}
+
 	//First just send the normal data to obtain standard image
-	if (this->next()->putq(m) == GADGET_FAIL)
+	if (this->put_replica(m) == GADGET_FAIL)
 			return GADGET_FAIL;
 
 	//Now for the noisy projections
@@ -43,21 +54,41 @@ int PseudoReplicatorGadget::process(GadgetContainerMessage<IsmrmrdReconData>* m)
 
 		for (auto & buffer : datasets){
 			auto & data = buffer.data_.data_;
-			auto dataptr = data.get_data_ptr();
-			for (size_t k =0; k <  data.get_number_of_elements(); k++){
-				dataptr[k] += std::complex<float>(distribution(engine),distribution(engine));
-			}
+			randn_.add(data.get_data_ptr(), data.get_number_of_elements(), noise_stream_++);
 		}
 		GDEBUG("Sending out Pseudoreplica\n");
 
-		if (this->next()->putq(cm) == GADGET_FAIL)
-			return GADGET_FAIL;
+		//m is on the queue of the next gadget already and must not be released by a failure, the remaining replicas are dropped
+		if (this->put_replica(cm) == GADGET_FAIL) {
+			cm->release();
+			break;
+		}
 
 	}
 	return GADGET_OK;
 
 }
 
+int PseudoReplicatorGadget::put_replica(ACE_Message_Block* mb) {
+
+	//Waits in steps, so a downstream gadget that stopped or a closed queue does not block the stream forever
+	for (;;) {
+		ACE_Time_Value wait = ACE_OS::gettimeofday() + ACE_Time_Value(0, 100000);
+		if (this->next()->putq(mb, &wait) != -1)
+			return GADGET_OK;
+
+		if (ACE_OS::last_error() != EWOULDBLOCK) {
+			GDEBUG("Queue of the next gadget is closed, replica dropped\n");
+			return GADGET_FAIL;
+		}
+
+		if (this->next()->thr_count() == 0) {
+			GERROR("Next gadget is not running, replica dropped\n");
+			return GADGET_FAIL;
+		}
+	}
+}
+
 GADGET_FACTORY_DECLARE(PseudoReplicatorGadget)
 
 } /* namespace Gadgetron */
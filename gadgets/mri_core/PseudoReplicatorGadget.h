@@ -9,12 +9,15 @@
 #include "Gadget.h"
 #include "mri_core_data.h"
 #include "gadgetron_mricore_export.h"
+#include "hoRandNormGenerator.h"
 
 namespace Gadgetron {
 
 class EXPORTGADGETSMRICORE PseudoReplicatorGadget : public Gadget1<IsmrmrdReconData>{
 public:
 	GADGET_PROPERTY(repetitions,int,"Number of pseudoreplicas to produce",10);
+	GADGET_PROPERTY(seed,int,"Seed of the noise, the replicas are the same for the same seed",0);
+	GADGET_PROPERTY(replicas_in_flight,int,"Maximal number of replicas waiting for the next gadget, replicas are made as they are consumed; 0 to send all at once",0);
 	PseudoReplicatorGadget()  ;
 	virtual ~PseudoReplicatorGadget();
 
@@ -22,7 +25,15 @@ public:
 	virtual int process(GadgetContainerMessage<IsmrmrdReconData>*);
 
 private:
+	/// putq on the next gadget, waits while its queue is full; the caller keeps the message if it cannot be queued
+	int put_replica(ACE_Message_Block* mb);
+
 	int repetitions_;
+	int replicas_in_flight_;
+
+	/// every buffer of every replica gets its own noise stream
+	RandNormGenerator<float> randn_;
+	unsigned long long noise_stream_;
 };
 
 } /* namespace Gadgetron */
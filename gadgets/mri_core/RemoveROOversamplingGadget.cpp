@@ -8,7 +8,7 @@
 
 namespace Gadgetron{
 
-    RemoveROOversamplingGadget::RemoveROOversamplingGadget()
+    RemoveROOversamplingGadget::RemoveROOversamplingGadget() : use_filter_(false)
     {
     }
 
@@ -37,10 +37,28 @@ namespace Gadgetron{
         reconNx_   = r_space.matrixSize.x;
         reconFOV_  = r_space.fieldOfView_mm.x;
 
+        use_filter_ = false;
+        if (use_half_band_filter.value())
+        {
+            if ( (encodeNx_ == 2*reconNx_) && (encodeFOV_ == 2*reconFOV_) )
+            {
+                use_filter_ = true;
+                GDEBUG_STREAM("RemoveROOversamplingGadget: half-band filter with " << half_band_filter_taps.value() << " taps");
+            }
+            else
+            {
+                GWARN_STREAM("RemoveROOversamplingGadget: the half-band filter needs 2x oversampling, ifft and fft are used");
+            }
+        }
+
         // limit the number of threads used to be 1
+        // the half-band filter runs in parallel over channels only for large readouts
 #ifdef USE_OMP
-        omp_set_num_threads(1);
-        GDEBUG_STREAM("RemoveROOversamplingGadget:omp_set_num_threads(1) ... ");
+        if (!use_filter_)
+        {
+            omp_set_num_threads(1);
+            GDEBUG_STREAM("RemoveROOversamplingGadget:omp_set_num_threads(1) ... ");
+        }
 #endif // USE_OMP
 
     // If the encoding and recon matrix size and FOV are the same
@@ -62,8 +80,46 @@ namespace Gadgetron{
         GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2)
     {
 
+      // Half-band filter and decimation in kspace, the result replaces the data of m2
+      if (dowork_ && use_filter_) {
+
+        hoNDArray< std::complex<float> >& data = *m2->getObjectPtr();
+
+        try
+        {
+            if (filter_.len != data.get_size(0))
+            {
+                generate_ro_oversampling_filter(data.get_size(0), (size_t)half_band_filter_taps.value(), (double)half_band_filter_beta.value(), filter_);
+            }
+
+            // filter_res_ is allocated once per readout length
+            remove_ro_oversampling(data, filter_, filter_res_);
+
+            // the decimated readout is copied to the front of the buffer of the data, which is kept with the new size
+            std::complex<float>* pData = data.begin();
+            memcpy(pData, filter_res_.begin(), filter_res_.get_number_of_bytes());
+
+            std::vector<size_t> dims;
+            filter_res_.get_dimensions(dims);
+
+            bool delete_data = data.delete_data_on_destruct();
+            data.delete_data_on_destruct(false);
+            data.create(dims, pData, delete_data);
+        }
+        catch (...)
+        {
+            GERROR("RemoveROOversamplingGadget::process, half-band filter failed\n");
+            m1->release();
+            return GADGET_FAIL;
+        }
+
+        m1->getObjectPtr()->number_of_samples = (uint16_t)data.get_size(0);
+        m1->getObjectPtr()->center_sample = (uint16_t)(m1->getObjectPtr()->center_sample / 2);
+        m1->getObjectPtr()->discard_pre = (uint16_t)(m1->getObjectPtr()->discard_pre / 2);
+        m1->getObjectPtr()->discard_post = (uint16_t)(m1->getObjectPtr()->discard_post / 2);
+      }
       // If we have work to do, do it, otherwise do nothing
-      if (dowork_) {
+      else if (dowork_) {
 
         GadgetContainerMessage< hoNDArray< std::complex<float> > >* m3 
             = new GadgetContainerMessage< hoNDArray< std::complex<float> > >();
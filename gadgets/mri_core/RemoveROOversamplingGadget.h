@@ -3,6 +3,7 @@
 #include "Gadget.h"
 #include "hoNDArray.h"
 #include "gadgetron_mricore_export.h"
+#include "mri_core_kspace_filter.h"
 
 #include <ismrmrd/ismrmrd.h>
 #include <complex>
@@ -25,6 +26,19 @@ namespace Gadgetron{
         virtual int process(GadgetContainerMessage<ISMRMRD::AcquisitionHeader>* m1,
             GadgetContainerMessage< hoNDArray< std::complex<float> > >* m2);
 
+        GADGET_PROPERTY(use_half_band_filter, bool, "Remove the 2x oversampling with a half-band filter in kspace instead of ifft, crop and fft", false);
+        GADGET_PROPERTY(half_band_filter_taps, int, "Number of odd taps on each side of the half-band filter; with fewer taps than RO/2 objects near the edge of the field of view see larger errors, about 8% on white kspace with 24 taps and RO 512", 24);
+        GADGET_PROPERTY(half_band_filter_beta, float, "Kaiser window parameter of the half-band filter", 6.0f);
+
+        /// half-band filter for the current readout length
+        ROOversamplingFilter<float> filter_;
+
+        /// true if the half-band filter is used, requires an oversampling factor of 2
+        bool use_filter_;
+
+        /// result of the half-band filter
+        hoNDArray< std::complex<float> > filter_res_;
+
         hoNDArray< std::complex<float> > fft_res_;
         hoNDArray< std::complex<float> > ifft_res_;
 
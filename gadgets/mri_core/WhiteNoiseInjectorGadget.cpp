@@ -1,88 +1,15 @@
 #include "WhiteNoiseInjectorGadget.h"
 #include "hoNDArray_elemwise.h"
-#include <array>
 #include "ismrmrd/xml.h"
 
 namespace Gadgetron
 {
 
-template <typename T>
-RandNormGenerator<T>::RandNormGenerator()
-{
-    rng_.seed();
-    this->setPara(0, 1);
-}
-
-template <typename T>
-RandNormGenerator<T>::RandNormGenerator(long long s, T mean, T sigma)
-{
-    this->seed(s);
-    this->setPara(mean, sigma);
-}
-
-template <typename T>
-RandNormGenerator<T>::~RandNormGenerator()
-{
-}
-
-template <typename T>
-void RandNormGenerator<T>::seed(unsigned long s)
-{
-    rng_.seed(s);
-}
-
-template <typename T>
-void RandNormGenerator<T>::setPara(T mean, T sigma)
-{
-    typename std::normal_distribution<T>::param_type para(mean, sigma);
-    dist_norm_.param(para);
-}
-
-template <typename T>
-inline void RandNormGenerator<T>::gen(hoNDArray<T>& randNum)
-{
-    try
-    {
-        size_t N = randNum.get_number_of_elements();
-        size_t n;
-        for (n = 0; n<N; n++)
-        {
-            randNum(n) = dist_norm_(rng_);
-        }
-    }
-    catch (...)
-    {
-        GADGET_THROW("Errors in RandNormGenerator<T>::gen(hoNDArray<T>& randNum) ... ");
-    }
-}
-
-template <typename T>
-inline void RandNormGenerator<T>::gen(hoNDArray< std::complex<T> >& randNum)
-{
-    try
-    {
-        size_t N = randNum.get_number_of_elements();
-        size_t n;
-
-        T real, imag;
-        for (n = 0; n<N; n++)
-        {
-            real = dist_norm_(rng_);
-            imag = dist_norm_(rng_);
-
-            randNum(n) = std::complex<T>(real, imag);
-        }
-    }
-    catch (...)
-    {
-        GADGET_THROW("Errors in RandNormGenerator<T>::gen(hoNDArray< std::complex<T> >& randNum) ... ");
-    }
-}
-
 WhiteNoiseInjectorGadget::WhiteNoiseInjectorGadget() : noise_mean_(0), noise_std_(1.0f)
 {
     add_noise_ref_ = true;
     randn_ = new RandGenType();
+    noise_stream_ = 0;
 
     acceFactorE1_ = 1;
     acceFactorE2_ = 1;
@@ -120,24 +47,11 @@ int WhiteNoiseInjectorGadget::process_config(ACE_Message_Block* mb)
 
     long long seed = (long long)(1e10*(timeinfo->tm_year+1900) + 1e8*(timeinfo->tm_mon+1) + 1e6*timeinfo->tm_mday + 1e4*timeinfo->tm_hour + 1e2*timeinfo->tm_min + timeinfo->tm_sec + std::rand());
 
-    std::array<unsigned int, 10> sequence;
-    sequence[0] = (unsigned int)(1e10*(timeinfo->tm_year+1900));
-    sequence[1] = (unsigned int)(1e8*(timeinfo->tm_mon+1));
-    sequence[2] = (unsigned int)(1e6*timeinfo->tm_mday);
-    sequence[3] = (unsigned int)(1e4*timeinfo->tm_hour);
-    sequence[4] = (unsigned int)(1e2*timeinfo->tm_min);
-    sequence[5] = (unsigned int)(timeinfo->tm_sec);
-
-    std::srand( (unsigned int)seed );
-    sequence[6] = (unsigned int)(std::rand());
-    sequence[7] = (unsigned int)(std::rand());
-    sequence[8] = (unsigned int)(std::rand());
-    sequence[9] = (unsigned int)(std::rand());
+    if ( noise_seed.value() != 0 ) seed = noise_seed.value();
+    GDEBUG_STREAM("noise seed is " << seed);
 
-    std::seed_seq seedSeq(sequence.begin(), sequence.end());
-    randn_->getRandomer().seed(seedSeq);
-
-    randn_->seed( (unsigned long)seed );
+    randn_->seed( (unsigned long long)seed );
+    noise_stream_ = 0;
 
     // ---------------------------------------------------------------------------------------------------------
     ISMRMRD::IsmrmrdHeader h;
@@ -225,35 +139,13 @@ int WhiteNoiseInjectorGadget::process(GadgetContainerMessage<ISMRMRD::Acquisitio
 
         if ( add_noise )
         {
-            if ( !noise_.dimensions_equal(m2->getObjectPtr()) )
-            {
-                noise_.create(m2->getObjectPtr()->get_dimensions());
-                noise_fl_.create(m2->getObjectPtr()->get_dimensions());
-            }
-
-            try
-            {
-                randn_->gen(noise_);
-            }
-            catch(...)
-            {
-                GERROR_STREAM("WhiteNoiseInjectorGadget, randn_->gen(noise_) failed ... ");
-                return GADGET_FAIL;
-            }
-
-            if ( !noise_fl_.copyFrom(noise_) )
-            {
-                GERROR_STREAM("WhiteNoiseInjectorGadget, noise_fl_.copyFrom(noise_) failed ... ");
-                return GADGET_FAIL;
-            }
-
             try
             {
-                Gadgetron::add(*m2->getObjectPtr(), noise_fl_, *m2->getObjectPtr());
+                randn_->add(m2->getObjectPtr()->begin(), m2->getObjectPtr()->get_number_of_elements(), noise_stream_++);
             }
             catch(...)
             {
-                GERROR_STREAM("WhiteNoiseInjectorGadget, Gadgetron::add(*m2->getObjectPtr(), noise_, *m2->getObjectPtr()) failed ... ");
+                GERROR_STREAM("WhiteNoiseInjectorGadget, randn_->add(...) failed ... ");
                 return GADGET_FAIL;
             }
         }
@@ -6,37 +6,11 @@
 #include "ismrmrd/ismrmrd.h"
 #include "GadgetIsmrmrdReadWrite.h"
 #include "gadgetron_mricore_export.h"
-#include <random>
+#include "hoRandNormGenerator.h"
 
 namespace Gadgetron
 {
 
-template <typename T>
-class RandNormGenerator
-{
-public:
-
-    typedef std::mt19937 RandomGeneratorType;
-
-    RandNormGenerator();
-    RandNormGenerator(long long seed, T mean = 0, T sigma = 1);
-    ~RandNormGenerator();
-
-    void seed(unsigned long seed);
-    void setPara(T mean = 0, T sigma = 1);
-
-    RandomGeneratorType& getRandomer() { return rng_; }
-    const RandomGeneratorType& getRandomer() const { return rng_; }
-
-    void gen(hoNDArray<T>& randNum);
-    void gen(hoNDArray< std::complex<T> >& randNum);
-
-protected:
-
-    RandomGeneratorType rng_;
-    std::normal_distribution<T> dist_norm_;
-};
-
 /// add white noise to the kspace data
 class EXPORTGADGETSMRICORE WhiteNoiseInjectorGadget : public Gadgetron::Gadget2<ISMRMRD::AcquisitionHeader, hoNDArray< std::complex<float> > >
 {
@@ -44,7 +18,7 @@ public:
 
     GADGET_DECLARE(WhiteNoiseInjectorGadget);
 
-    typedef Gadgetron::RandNormGenerator<double> RandGenType;
+    typedef Gadgetron::RandNormGenerator<float> RandGenType;
 
     WhiteNoiseInjectorGadget();
     virtual ~WhiteNoiseInjectorGadget();
@@ -53,6 +27,7 @@ protected:
     GADGET_PROPERTY(noise_mean, float, "Noise mean", 0.0);
     GADGET_PROPERTY(noise_std, float, "Noise standard deviation", 0.0);
     GADGET_PROPERTY(add_noise_ref, bool, "Add noise to reference scans", false);
+    GADGET_PROPERTY(noise_seed, int, "Seed of the noise; 0 for a seed from the current time", 0);
 
     virtual int process_config(ACE_Message_Block* mb);
 
@@ -66,12 +41,9 @@ protected:
     float noise_mean_;
     float noise_std_;
 
-    /// random noise generator
+    /// random noise generator, every acquisition gets its own stream
     RandGenType* randn_;
-
-    /// helper memory to store noise
-    hoNDArray< std::complex<double> > noise_;
-    hoNDArray< std::complex<float> > noise_fl_;
+    unsigned long long noise_stream_;
 
     /// calibration mode and rate
     size_t acceFactorE1_;
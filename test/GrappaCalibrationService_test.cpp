@@ -0,0 +1,204 @@
+#include "GrappaCalibrationService.h"
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <complex>
+#include <thread>
+
+using namespace Gadgetron;
+
+namespace
+{
+    /// a service of its own for each test, with access to the queue
+    class GrappaCalibrationServiceTest : public GrappaCalibrationService
+    {
+    public:
+        GrappaCalibrationServiceTest()
+        {
+            set_number_of_threads(1);
+        }
+
+        bool any_running()
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            for (std::list<JobPtr>::const_iterator it = jobs_.begin(); it != jobs_.end(); it++)
+            {
+                if ((*it)->running) return true;
+            }
+            return false;
+        }
+
+        size_t number_of_delivered()
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return delivered_.size();
+        }
+    };
+
+    typedef boost::shared_ptr< GrappaWeights<float> > WeightsPtr;
+
+    /// ACS [RO E1 1 CHA], different seeds give different data
+    void make_acs(hoNDArray< std::complex<float> >& acs, size_t RO, size_t E1, size_t CHA, unsigned int seed)
+    {
+        acs.create(RO, E1, 1, CHA);
+        for (size_t n = 0; n < acs.get_number_of_elements(); n++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            float re = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+            seed = seed * 1103515245u + 12345u;
+            float im = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+            acs(n) = std::complex<float>(re, im);
+        }
+    }
+
+    int submit(GrappaCalibrationService& s, hoNDArray< std::complex<float> >& acs, WeightsPtr w, int priority = GrappaCalibrationService::PRIORITY_BATCH)
+    {
+        std::vector< std::pair<unsigned int, unsigned int> > sampled_region(2);
+        sampled_region[0] = std::make_pair(0u, (unsigned int)acs.get_size(0) - 1);
+        sampled_region[1] = std::make_pair(0u, (unsigned int)acs.get_size(1) - 1);
+        std::list<unsigned int> uncombined_channels;
+        return s.submit(&acs, sampled_region, 1, uncombined_channels, (int)acs.get_size(3), w, priority);
+    }
+
+    void wait_until_running(GrappaCalibrationServiceTest& s)
+    {
+        while (!s.any_running()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    bool same_weights(const WeightsPtr& a, const WeightsPtr& b)
+    {
+        GrappaWeights<float>::SnapshotPtr sa = a->get_snapshot(), sb = b->get_snapshot();
+        if (!sa || !sb) return false;
+        if (sa->weights_.get_number_of_elements() != sb->weights_.get_number_of_elements()) return false;
+        for (size_t n = 0; n < sa->weights_.get_number_of_elements(); n++)
+        {
+            if (sa->weights_(n) != sb->weights_(n)) return false;
+        }
+        return true;
+    }
+}
+
+TEST(GrappaCalibrationService, dedup)
+{
+    GrappaCalibrationServiceTest s;
+
+    hoNDArray< std::complex<float> > acs;
+    make_acs(acs, 32, 32, 4, 1);
+
+    WeightsPtr w1(new GrappaWeights<float>), w2(new GrappaWeights<float>), w3(new GrappaWeights<float>);
+    ASSERT_EQ(0, submit(s, acs, w1));
+    ASSERT_EQ(0, submit(s, acs, w2));
+    s.wait(w1.get());
+    s.wait(w2.get());
+
+    // the second submission joined the first or was served from its cached result
+    EXPECT_EQ(1, s.get_number_of_calibrations());
+    EXPECT_EQ(1, s.get_number_of_joined() + s.get_number_of_cache_hits());
+    EXPECT_TRUE(same_weights(w1, w2));
+
+    // the same data in another buffer is found by its content
+    hoNDArray< std::complex<float> > acs_copy(acs);
+    ASSERT_EQ(0, submit(s, acs_copy, w3));
+    s.wait(w3.get());
+    EXPECT_EQ(1, s.get_number_of_calibrations());
+    EXPECT_TRUE(same_weights(w1, w3));
+
+    EXPECT_EQ(0, s.number_of_delivered());
+}
+
+TEST(GrappaCalibrationService, lru_cache)
+{
+    GrappaCalibrationServiceTest s;
+    s.set_cache_size(2);
+
+    hoNDArray< std::complex<float> > a, b, c;
+    make_acs(a, 32, 32, 4, 1);
+    make_acs(b, 32, 32, 4, 2);
+    make_acs(c, 32, 32, 4, 3);
+
+    WeightsPtr w(new GrappaWeights<float>);
+
+    submit(s, a, w); s.wait(w.get());
+    submit(s, b, w); s.wait(w.get());
+    EXPECT_EQ(2, s.get_number_of_calibrations());
+
+    // a becomes the most recently used, c pushes out b
+    submit(s, a, w); s.wait(w.get());
+    EXPECT_EQ(1, s.get_number_of_cache_hits());
+    submit(s, c, w); s.wait(w.get());
+    EXPECT_EQ(3, s.get_number_of_calibrations());
+
+    submit(s, a, w); s.wait(w.get());
+    EXPECT_EQ(2, s.get_number_of_cache_hits());
+    EXPECT_EQ(3, s.get_number_of_calibrations());
+
+    submit(s, b, w); s.wait(w.get());
+    EXPECT_EQ(2, s.get_number_of_cache_hits());
+    EXPECT_EQ(4, s.get_number_of_calibrations());
+
+    // no cache
+    s.set_cache_size(0);
+    submit(s, b, w); s.wait(w.get());
+    EXPECT_EQ(2, s.get_number_of_cache_hits());
+    EXPECT_EQ(5, s.get_number_of_calibrations());
+}
+
+TEST(GrappaCalibrationService, priority)
+{
+    GrappaCalibrationServiceTest s;
+
+    hoNDArray< std::complex<float> > busy, batch, interactive;
+    make_acs(busy, 128, 128, 8, 1);
+    make_acs(batch, 128, 128, 8, 2);
+    make_acs(interactive, 128, 128, 8, 3);
+
+    WeightsPtr w_busy(new GrappaWeights<float>), w_batch(new GrappaWeights<float>), w_interactive(new GrappaWeights<float>);
+
+    // the only thread is busy while the other two are queued
+    submit(s, busy, w_busy);
+    wait_until_running(s);
+    submit(s, batch, w_batch, GrappaCalibrationService::PRIORITY_BATCH);
+    submit(s, interactive, w_interactive, GrappaCalibrationService::PRIORITY_INTERACTIVE);
+
+    // the batch calibration is started only when the interactive one is done
+    s.wait(w_interactive.get());
+    EXPECT_TRUE(w_interactive->get_snapshot());
+    EXPECT_FALSE(w_batch->get_snapshot());
+
+    s.wait(w_batch.get());
+    EXPECT_TRUE(w_batch->get_snapshot());
+    EXPECT_EQ(3, s.get_number_of_calibrations());
+}
+
+TEST(GrappaCalibrationService, out_of_order_delivery)
+{
+    GrappaCalibrationServiceTest s;
+
+    hoNDArray< std::complex<float> > older, newer;
+    make_acs(older, 128, 128, 8, 1);
+    make_acs(newer, 32, 32, 4, 2);
+
+    // the result of the newer submission is in the cache
+    WeightsPtr w_other(new GrappaWeights<float>);
+    submit(s, newer, w_other);
+    s.wait(w_other.get());
+
+    // the older calibration is running when the newer submission is served from the cache
+    WeightsPtr w(new GrappaWeights<float>);
+    submit(s, older, w);
+    wait_until_running(s);
+    submit(s, newer, w);
+    EXPECT_EQ(1, s.get_number_of_cache_hits());
+
+    s.wait(w.get());
+    EXPECT_EQ(2, s.get_number_of_calibrations());
+
+    // the older result arrived last and was dropped
+    GrappaWeights<float>::SnapshotPtr snapshot = w->get_snapshot();
+    ASSERT_TRUE(snapshot);
+    EXPECT_EQ(1, snapshot->update_count_);
+    EXPECT_EQ(32, snapshot->weights_.get_size(0));
+    EXPECT_TRUE(same_weights(w, w_other));
+
+    EXPECT_EQ(0, s.number_of_delivered());
+}
@@ -0,0 +1,120 @@
+#include "GridGraphMaxFlow.h"
+
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef boost::adjacency_list_traits<boost::vecS, boost::vecS, boost::directedS> Traits;
+    typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS,
+        boost::property<boost::vertex_index_t, long,
+        boost::property<boost::vertex_color_t, boost::default_color_type,
+        boost::property<boost::vertex_distance_t, long,
+        boost::property<boost::vertex_predecessor_t, Traits::edge_descriptor> > > >,
+        boost::property<boost::edge_capacity_t, double,
+        boost::property<boost::edge_residual_capacity_t, double,
+        boost::property<boost::edge_reverse_t, Traits::edge_descriptor> > > > Graph;
+
+    void add_boost_edge(Graph& g, size_t a, size_t b, double cap, double rev_cap)
+    {
+        Traits::edge_descriptor e1 = boost::add_edge(a, b, g).first;
+        Traits::edge_descriptor e2 = boost::add_edge(b, a, g).first;
+        boost::put(boost::edge_capacity, g, e1, cap);
+        boost::put(boost::edge_capacity, g, e2, rev_cap);
+        boost::put(boost::edge_reverse, g, e1, e2);
+        boost::put(boost::edge_reverse, g, e2, e1);
+    }
+
+    /// random terminal and neighbour capacities, compared to the boost Boykov-Kolmogorov max-flow
+    void compare_with_boost(size_t X, size_t Y, size_t Z, unsigned int seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> dis(0, 20);
+
+        GridGraphMaxFlow grid(X, Y, Z);
+        size_t N = grid.num_nodes();
+
+        Graph g(N + 2);
+        size_t source = N, sink = N + 1;
+
+        // edges to the neighbours with a larger index, the cut is checked with the same capacities
+        struct Edge { size_t a, b; double cap; };
+        std::vector<Edge> edges;
+        std::vector<double> source_cap(N), sink_cap(N);
+
+        for (size_t z = 0; z < Z; z++)
+        {
+            for (size_t y = 0; y < Y; y++)
+            {
+                for (size_t x = 0; x < X; x++)
+                {
+                    size_t n = grid.node(x, y, z);
+
+                    // only one terminal capacity, the flow is then the flow through the grid
+                    int t = dis(gen) - 10;
+                    source_cap[n] = (t > 0) ? t : 0;
+                    sink_cap[n] = (t < 0) ? -t : 0;
+                    grid.add_terminal_weights(n, (float)sink_cap[n], (float)source_cap[n]);
+                    add_boost_edge(g, source, n, source_cap[n], 0);
+                    add_boost_edge(g, n, sink, sink_cap[n], 0);
+
+                    size_t nb[3] = { x + 1 < X ? grid.node(x + 1, y, z) : N, y + 1 < Y ? grid.node(x, y + 1, z) : N, z + 1 < Z ? grid.node(x, y, z + 1) : N };
+                    for (unsigned int k = 0; k < 3; k++)
+                    {
+                        if (nb[k] == N) continue;
+                        double cap = dis(gen) / 4.0, rev_cap = dis(gen) / 4.0;
+                        grid.add_edge(n, 2 * k, (float)cap, (float)rev_cap);
+                        add_boost_edge(g, n, nb[k], cap, rev_cap);
+                        edges.push_back({ n, nb[k], cap });
+                        edges.push_back({ nb[k], n, rev_cap });
+                    }
+                }
+            }
+        }
+
+        double flow = grid.maxflow();
+        double boost_flow = boost::boykov_kolmogorov_max_flow(g, source, sink);
+        EXPECT_DOUBLE_EQ(boost_flow, flow);
+
+        // the capacity of the cut is the flow
+        double cut = 0;
+        for (size_t n = 0; n < N; n++)
+        {
+            cut += grid.in_sink_set(n) ? source_cap[n] : sink_cap[n];
+        }
+        for (const Edge& e : edges)
+        {
+            if (!grid.in_sink_set(e.a) && grid.in_sink_set(e.b)) cut += e.cap;
+        }
+        EXPECT_DOUBLE_EQ(flow, cut);
+    }
+}
+
+TEST(GridGraphMaxFlow, compare2D)
+{
+    for (unsigned int seed = 0; seed < 10; seed++) compare_with_boost(23, 17, 1, seed);
+}
+
+TEST(GridGraphMaxFlow, compare3D)
+{
+    for (unsigned int seed = 0; seed < 10; seed++) compare_with_boost(11, 9, 7, seed);
+}
+
+TEST(GridGraphMaxFlow, binaryEnergy)
+{
+    // two nodes preferring different labels, a strong pairwise term makes them agree on the cheaper label
+    GridGraphMaxFlow grid(2, 1);
+    grid.add_terminal_weights(0, 0, 3);
+    grid.add_terminal_weights(1, 2, 0);
+    grid.add_pairwise(0, 0, 0, 10, 10, 0);
+    grid.maxflow();
+
+    EXPECT_FALSE(grid.in_sink_set(0));
+    EXPECT_FALSE(grid.in_sink_set(1));
+}
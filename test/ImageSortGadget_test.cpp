@@ -0,0 +1,113 @@
+#include "ImageSortGadget.h"
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Gadgetron;
+
+namespace
+{
+    /// a gadget outside of a stream, its images are put on the queue of a sink
+    class ImageSortGadgetTest : public ImageSortGadget
+    {
+    public:
+        using ImageSortGadget::process_config;
+        using ImageSortGadget::process;
+        using ImageSortGadget::close;
+    };
+
+    /// the encoding limits of the slices [0 3]
+    const char* header_xml =
+        "<?xml version=\"1.0\"?>\n"
+        "<ismrmrdHeader xmlns=\"http://www.ismrm.org/ISMRMRD\">\n"
+        "  <experimentalConditions><H1resonanceFrequency_Hz>63500000</H1resonanceFrequency_Hz></experimentalConditions>\n"
+        "  <encoding>\n"
+        "    <encodedSpace><matrixSize><x>16</x><y>16</y><z>1</z></matrixSize><fieldOfView_mm><x>200</x><y>200</y><z>5</z></fieldOfView_mm></encodedSpace>\n"
+        "    <reconSpace><matrixSize><x>16</x><y>16</y><z>1</z></matrixSize><fieldOfView_mm><x>200</x><y>200</y><z>5</z></fieldOfView_mm></reconSpace>\n"
+        "    <encodingLimits><slice><minimum>0</minimum><maximum>3</maximum><center>0</center></slice></encodingLimits>\n"
+        "    <trajectory>cartesian</trajectory>\n"
+        "  </encoding>\n"
+        "</ismrmrdHeader>\n";
+
+    class ImageSortGadget_test : public ::testing::Test
+    {
+    protected:
+        virtual void SetUp()
+        {
+            gadget_.next(&sink_);
+
+            gadget_.set_parameter("streaming", "true");
+            gadget_.set_parameter("out_of_order_window", "2");
+
+            size_t len = std::strlen(header_xml) + 1;
+            ACE_Message_Block* mb = new ACE_Message_Block(len);
+            std::memcpy(mb->wr_ptr(), header_xml, len);
+            mb->wr_ptr(len);
+            ASSERT_EQ(GADGET_OK, gadget_.process_config(mb));
+            mb->release();
+        }
+
+        virtual void TearDown()
+        {
+            receive();
+        }
+
+        int send(uint16_t repetition, uint16_t slice)
+        {
+            GadgetContainerMessage<ISMRMRD::ImageHeader>* m = new GadgetContainerMessage<ISMRMRD::ImageHeader>();
+            std::memset(m->getObjectPtr(), 0, sizeof(ISMRMRD::ImageHeader));
+            m->getObjectPtr()->repetition = repetition;
+            m->getObjectPtr()->slice = slice;
+            return gadget_.process(m);
+        }
+
+        /// [repetition slice] of the images the gadget has sent
+        std::vector< std::pair<int, int> > receive()
+        {
+            std::vector< std::pair<int, int> > res;
+
+            ACE_Message_Block* mb = 0;
+            ACE_Time_Value nowait(ACE_OS::gettimeofday());
+            while (sink_.msg_queue()->dequeue_head(mb, &nowait) >= 0) {
+                GadgetContainerMessage<ISMRMRD::ImageHeader>* m = AsContainerMessage<ISMRMRD::ImageHeader>(mb);
+                if (m) res.push_back(std::make_pair((int)m->getObjectPtr()->repetition, (int)m->getObjectPtr()->slice));
+                mb->release();
+            }
+
+            return res;
+        }
+
+        ACE_Task<ACE_MT_SYNCH> sink_;
+        ImageSortGadgetTest gadget_;
+    };
+}
+
+TEST_F(ImageSortGadget_test, missing_image)
+{
+    // slice 1 of the first repetition is missing, the slices of the last repetition arrive out of order
+    int arrivals[][2] = { { 0, 0 }, { 0, 2 }, { 0, 3 },
+                          { 1, 0 }, { 1, 1 }, { 1, 2 }, { 1, 3 },
+                          { 2, 1 }, { 2, 0 }, { 2, 2 }, { 2, 3 } };
+    size_t N = sizeof(arrivals) / sizeof(arrivals[0]);
+
+    for (size_t n = 0; n < N; n++) {
+        ASSERT_EQ(GADGET_OK, send(arrivals[n][0], arrivals[n][1]));
+    }
+
+    // the skipped slot counts, slice 1 of the last repetition waits for slice 0
+    std::vector< std::pair<int, int> > sent = receive();
+    ASSERT_EQ(GADGET_OK, gadget_.close(1));
+    std::vector< std::pair<int, int> > rest = receive();
+    sent.insert(sent.end(), rest.begin(), rest.end());
+
+    ASSERT_EQ(N, sent.size());
+    for (size_t n = 1; n < N; n++) {
+        EXPECT_LT(sent[n - 1], sent[n]) << "image " << n;
+    }
+
+    // every image was due before the end of the stream
+    EXPECT_EQ(0, rest.size());
+}
@@ -0,0 +1,192 @@
+#include "MetaBinaryCodec.h"
+
+#include <gtest/gtest.h>
+#include <ismrmrd/meta.h>
+#include <string>
+
+using namespace Gadgetron;
+
+namespace
+{
+    void expect_same_attributes(const ISMRMRD::MetaContainer& a, const ISMRMRD::MetaContainer& b)
+    {
+        size_t num_a = 0, num_b = 0;
+        for (auto it = a.begin(); it != a.end(); ++it) num_a++;
+        for (auto it = b.begin(); it != b.end(); ++it) num_b++;
+        EXPECT_EQ(num_a, num_b);
+
+        for (auto it = a.begin(); it != a.end(); ++it)
+        {
+            const char* name = it->first.c_str();
+            ASSERT_EQ(a.length(name), b.length(name)) << name;
+            for (size_t n = 0; n < a.length(name); n++)
+            {
+                EXPECT_STREQ(a.as_str(name, n), b.as_str(name, n)) << name << " " << n;
+            }
+        }
+    }
+
+    bool round_trip(MetaBinaryEncoder& encoder, MetaBinaryDecoder& decoder, const ISMRMRD::MetaContainer& meta, ISMRMRD::MetaContainer& decoded)
+    {
+        std::string buf;
+        encoder.encode(meta, buf);
+        EXPECT_TRUE(is_meta_binary(buf.c_str(), buf.size()));
+        return decoder.decode(buf.c_str(), buf.size(), decoded);
+    }
+}
+
+TEST(MetaBinaryCodec, numbers)
+{
+    ISMRMRD::MetaContainer meta;
+    meta.set("long", (long)42);
+    meta.append("long", (long)-7);
+    meta.append("long", (long)0);
+    meta.append("long", (long)1234567890123L);
+    meta.set("double", 3.5);
+    meta.append("double", -0.125);
+    meta.append("double", 1.0/3.0);
+    meta.append("double", 2.5e-7);
+    meta.set("string", "GT");
+    meta.append("string", "FLASH");
+
+    MetaBinaryEncoder encoder;
+    MetaBinaryDecoder decoder;
+    ISMRMRD::MetaContainer decoded;
+    ASSERT_TRUE(round_trip(encoder, decoder, meta, decoded));
+    expect_same_attributes(meta, decoded);
+}
+
+TEST(MetaBinaryCodec, non_canonical_numbers)
+{
+    // strings that parse as numbers but are not reproduced by formatting the number again
+    const char* values[] = { "1.50", "-0", "1e+06", "007", "+3", "0.1000", "-0.0", "1.", ".5", "123456789" };
+
+    ISMRMRD::MetaContainer meta;
+    for (size_t n = 0; n < sizeof(values) / sizeof(values[0]); n++)
+    {
+        meta.append("value", values[n]);
+    }
+
+    MetaBinaryEncoder encoder;
+    MetaBinaryDecoder decoder;
+    ISMRMRD::MetaContainer decoded;
+    ASSERT_TRUE(round_trip(encoder, decoder, meta, decoded));
+    expect_same_attributes(meta, decoded);
+}
+
+TEST(MetaBinaryCodec, string_table)
+{
+    MetaBinaryEncoder encoder;
+    MetaBinaryDecoder decoder;
+
+    for (long n = 0; n < 5; n++)
+    {
+        ISMRMRD::MetaContainer meta, decoded;
+        meta.set("ImageNumber", n);
+        meta.set("ImageComment", "GT");
+        meta.append("ImageComment", "T1MAP");
+
+        ASSERT_TRUE(round_trip(encoder, decoder, meta, decoded));
+        expect_same_attributes(meta, decoded);
+
+        EXPECT_EQ(4, encoder.table_size());
+        EXPECT_EQ(4, decoder.table_size());
+    }
+}
+
+TEST(MetaBinaryCodec, table_overflow)
+{
+    // two strings are interned, the others are sent inline
+    MetaBinaryEncoder encoder(2, 8);
+    MetaBinaryDecoder decoder;
+
+    ISMRMRD::MetaContainer meta, decoded;
+    meta.set("a", "first");
+    meta.set("b", "second");
+    meta.set("c", "a string longer than the interned length");
+
+    ASSERT_TRUE(round_trip(encoder, decoder, meta, decoded));
+    expect_same_attributes(meta, decoded);
+    EXPECT_EQ(2, encoder.table_size());
+    EXPECT_EQ(2, decoder.table_size());
+
+    ISMRMRD::MetaContainer decoded_again;
+    ASSERT_TRUE(round_trip(encoder, decoder, meta, decoded_again));
+    expect_same_attributes(meta, decoded_again);
+    EXPECT_EQ(2, decoder.table_size());
+}
+
+TEST(MetaBinaryCodec, out_of_step)
+{
+    MetaBinaryEncoder encoder;
+    MetaBinaryDecoder decoder;
+
+    ISMRMRD::MetaContainer first, second;
+    first.set("a", "x");
+    second.set("b", "y");
+
+    std::string buf_first, buf_second;
+    encoder.encode(first, buf_first);
+    encoder.encode(second, buf_second);
+
+    // the second message refers to the table after the first one
+    ISMRMRD::MetaContainer decoded;
+    EXPECT_FALSE(decoder.decode(buf_second.c_str(), buf_second.size(), decoded));
+    EXPECT_EQ(0, decoder.table_size());
+
+    EXPECT_TRUE(decoder.decode(buf_first.c_str(), buf_first.size(), decoded));
+    EXPECT_TRUE(decoder.decode(buf_second.c_str(), buf_second.size(), decoded));
+    EXPECT_EQ(4, decoder.table_size());
+
+    // a message is not accepted twice
+    EXPECT_FALSE(decoder.decode(buf_first.c_str(), buf_first.size(), decoded));
+    EXPECT_EQ(4, decoder.table_size());
+}
+
+TEST(MetaBinaryCodec, truncated)
+{
+    MetaBinaryEncoder encoder;
+    MetaBinaryDecoder decoder;
+
+    ISMRMRD::MetaContainer meta;
+    meta.set("a", "x");
+    meta.set("b", 2.5);
+
+    std::string buf;
+    encoder.encode(meta, buf);
+
+    // the strings of a rejected message are not kept
+    ISMRMRD::MetaContainer decoded;
+    EXPECT_FALSE(decoder.decode(buf.c_str(), buf.size() - 1, decoded));
+    EXPECT_EQ(0, decoder.table_size());
+
+    ISMRMRD::MetaContainer decoded_again;
+    EXPECT_TRUE(decoder.decode(buf.c_str(), buf.size(), decoded_again));
+    expect_same_attributes(meta, decoded_again);
+}
+
+TEST(MetaBinaryCodec, rollback)
+{
+    MetaBinaryEncoder encoder;
+    MetaBinaryDecoder decoder;
+
+    ISMRMRD::MetaContainer first, second;
+    first.set("a", "x");
+    second.set("a", "x");
+    second.set("b", "y");
+
+    ISMRMRD::MetaContainer decoded;
+    ASSERT_TRUE(round_trip(encoder, decoder, first, decoded));
+
+    // the second message is not sent, its new strings are taken back
+    std::string lost;
+    encoder.encode(second, lost);
+    EXPECT_EQ(4, encoder.table_size());
+    encoder.rollback();
+    EXPECT_EQ(2, encoder.table_size());
+
+    ISMRMRD::MetaContainer decoded_second;
+    ASSERT_TRUE(round_trip(encoder, decoder, second, decoded_second));
+    expect_same_attributes(second, decoded_second);
+    EXPECT_EQ(4, decoder.table_size());
+}
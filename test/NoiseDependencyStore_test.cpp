@@ -0,0 +1,196 @@
+#include "NoiseDependencyStore.h"
+
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <complex>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Gadgetron;
+
+namespace
+{
+    /// a store of its own for each test, with access to the sweep of the background thread
+    class NoiseDependencyStoreTest : public NoiseDependencyStore
+    {
+    public:
+        using NoiseDependencyStore::sweep;
+    };
+
+    class NoiseDependencyStore_test : public ::testing::Test
+    {
+    protected:
+        virtual void SetUp()
+        {
+            folder_ = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("gt_noise_%%%%-%%%%-%%%%")).string();
+            boost::filesystem::create_directories(folder_);
+
+            size_t CHA = 4;
+            covariance_.create(CHA, CHA);
+            prewhitener_.create(CHA, CHA);
+            for (size_t c = 0; c < CHA; c++)
+            {
+                for (size_t r = 0; r < CHA; r++)
+                {
+                    covariance_(r, c) = std::complex<float>((r == c) ? 2.0f + r : 0.1f*(r + c), (r == c) ? 0.0f : 0.05f*((float)r - (float)c));
+                    prewhitener_(r, c) = std::complex<float>((r >= c) ? 1.0f / (1 + r + c) : 0.0f, 0.0f);
+                }
+            }
+        }
+
+        virtual void TearDown()
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(folder_, ec);
+        }
+
+        std::string filename(const std::string& measurement_id)
+        {
+            return NoiseDependencyStore::dependency_filename(folder_, "GadgetronNoiseCovarianceMatrix", measurement_id);
+        }
+
+        bool exists(const std::string& name)
+        {
+            return boost::filesystem::exists(name);
+        }
+
+        void set_age(const std::string& name, double hours)
+        {
+            boost::filesystem::last_write_time(name, std::time(NULL) - (std::time_t)(hours * 3600));
+        }
+
+        std::string folder_;
+        hoNDArray< std::complex<float> > covariance_;
+        hoNDArray< std::complex<float> > prewhitener_;
+    };
+}
+
+TEST_F(NoiseDependencyStore_test, save_load)
+{
+    std::string name = filename("12345_1_1");
+
+    {
+        NoiseDependencyStoreTest store;
+        ASSERT_TRUE(store.save(name, "<xml/>", 2.5f, 77, covariance_, &prewhitener_));
+        EXPECT_TRUE(exists(name));
+        EXPECT_TRUE(exists(name + NoiseDependencyStore::sidecar_suffix()));
+
+        float dwell_time_us = 0;
+        hoNDArray< std::complex<float> > cov, pre;
+        ASSERT_EQ(NoiseDependencyStore::LOADED, store.load(name, 77, dwell_time_us, cov, pre));
+        EXPECT_EQ(2.5f, dwell_time_us);
+        ASSERT_EQ(covariance_.get_number_of_elements(), cov.get_number_of_elements());
+        ASSERT_EQ(prewhitener_.get_number_of_elements(), pre.get_number_of_elements());
+        for (size_t n = 0; n < cov.get_number_of_elements(); n++)
+        {
+            EXPECT_EQ(covariance_(n), cov(n));
+            EXPECT_EQ(prewhitener_(n), pre(n));
+        }
+
+        EXPECT_EQ(NoiseDependencyStore::COIL_MISMATCH, store.load(name, 78, dwell_time_us, cov, pre));
+        EXPECT_EQ(NoiseDependencyStore::NOT_FOUND, store.load(filename("54321_1_1"), 77, dwell_time_us, cov, pre));
+    }
+
+    // a new index is read from the folder, the sidecar is not listed
+    NoiseDependencyStoreTest store;
+
+    std::vector<std::string> names;
+    ASSERT_TRUE(store.list(folder_, "GadgetronNoiseCovarianceMatrix", names));
+    ASSERT_EQ(1, names.size());
+    EXPECT_EQ("GadgetronNoiseCovarianceMatrix_12345_1_1", names[0]);
+
+    float dwell_time_us = 0;
+    hoNDArray< std::complex<float> > cov, pre;
+    ASSERT_EQ(NoiseDependencyStore::LOADED, store.load(name, 77, dwell_time_us, cov, pre));
+    EXPECT_EQ(covariance_(3, 2), cov(3, 2));
+    EXPECT_EQ(prewhitener_(3, 2), pre(3, 2));
+    EXPECT_EQ(1, store.get_number_of_folder_scans());
+}
+
+TEST_F(NoiseDependencyStore_test, no_sidecar)
+{
+    NoiseDependencyStoreTest store;
+
+    float dwell_time_us = 0;
+    hoNDArray< std::complex<float> > cov, pre;
+
+    // saved without a prewhitener
+    std::string name = filename("12345_1_1");
+    ASSERT_TRUE(store.save(name, "<xml/>", 2.5f, 77, covariance_, NULL));
+    EXPECT_FALSE(exists(name + NoiseDependencyStore::sidecar_suffix()));
+    EXPECT_EQ(NoiseDependencyStore::NO_PREWHITENER, store.load(name, 77, dwell_time_us, cov, pre));
+
+    // saved again without a prewhitener, the sidecar of the first save is removed
+    std::string name2 = filename("12345_1_2");
+    ASSERT_TRUE(store.save(name2, "<xml/>", 2.5f, 77, covariance_, &prewhitener_));
+    ASSERT_EQ(NoiseDependencyStore::LOADED, store.load(name2, 77, dwell_time_us, cov, pre));
+    ASSERT_TRUE(store.save(name2, "<xml/>", 2.5f, 77, covariance_, NULL));
+    EXPECT_FALSE(exists(name2 + NoiseDependencyStore::sidecar_suffix()));
+    EXPECT_EQ(NoiseDependencyStore::NO_PREWHITENER, store.load(name2, 77, dwell_time_us, cov, pre));
+
+    // written by an older version, after the folder was indexed
+    std::string name3 = filename("12345_1_3");
+    {
+        std::ofstream f(name3.c_str(), std::ios::out | std::ios::binary);
+        f << "dependency";
+    }
+    EXPECT_EQ(NoiseDependencyStore::NO_PREWHITENER, store.load(name3, 77, dwell_time_us, cov, pre));
+
+    // a sidecar which is not valid
+    std::string name4 = filename("12345_1_4");
+    ASSERT_TRUE(store.save(name4, "<xml/>", 2.5f, 77, covariance_, &prewhitener_));
+    {
+        std::ofstream f((name4 + NoiseDependencyStore::sidecar_suffix()).c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        f << "not a sidecar, but long enough for the header";
+    }
+    NoiseDependencyStoreTest store2;
+    EXPECT_EQ(NoiseDependencyStore::NO_PREWHITENER, store2.load(name4, 77, dwell_time_us, cov, pre));
+}
+
+TEST_F(NoiseDependencyStore_test, expiry)
+{
+    std::string old_name = filename("12345_1_1");
+    std::string new_name = filename("12345_1_2");
+
+    {
+        NoiseDependencyStoreTest store;
+        ASSERT_TRUE(store.save(old_name, "<xml/>", 2.5f, 77, covariance_, &prewhitener_));
+        ASSERT_TRUE(store.save(new_name, "<xml/>", 2.5f, 77, covariance_, &prewhitener_));
+    }
+    set_age(old_name, 3);
+
+    // a sidecar left by a save which failed long ago, and one being written
+    std::string stale_tmp = old_name + NoiseDependencyStore::sidecar_suffix() + ".tmp";
+    std::string fresh_tmp = new_name + NoiseDependencyStore::sidecar_suffix() + ".tmp";
+    {
+        std::ofstream f(stale_tmp.c_str());
+        std::ofstream g(fresh_tmp.c_str());
+    }
+    set_age(stale_tmp, 1);
+
+    NoiseDependencyStoreTest store;
+    store.set_time_limit(folder_, 2);
+
+    std::vector<std::string> names;
+    ASSERT_TRUE(store.list(folder_, "GadgetronNoiseCovarianceMatrix", names));
+    ASSERT_EQ(1, names.size());
+    EXPECT_EQ("GadgetronNoiseCovarianceMatrix_12345_1_2", names[0]);
+
+    EXPECT_FALSE(exists(stale_tmp));
+    EXPECT_TRUE(exists(fresh_tmp));
+
+    // the expired dependency and its sidecar are removed by the sweep
+    EXPECT_TRUE(exists(old_name));
+    store.sweep();
+    EXPECT_FALSE(exists(old_name));
+    EXPECT_FALSE(exists(old_name + NoiseDependencyStore::sidecar_suffix()));
+    EXPECT_TRUE(exists(new_name));
+    EXPECT_TRUE(exists(new_name + NoiseDependencyStore::sidecar_suffix()));
+
+    float dwell_time_us = 0;
+    hoNDArray< std::complex<float> > cov, pre;
+    EXPECT_EQ(NoiseDependencyStore::NOT_FOUND, store.load(old_name, 77, dwell_time_us, cov, pre));
+    EXPECT_EQ(NoiseDependencyStore::LOADED, store.load(new_name, 77, dwell_time_us, cov, pre));
+}
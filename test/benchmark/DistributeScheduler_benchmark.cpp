@@ -0,0 +1,158 @@
+/** \file       DistributeScheduler_benchmark.cpp
+    \brief      Simulated makespan of the DistributeGadget schedulers on synthetic job mixes
+
+    Two distributors send jobs to a heterogeneous cluster. Every node runs its jobs
+    one after the other at a speed given by its compute capability. The node information
+    seen by the schedulers is published periodically, as through the CloudBus. The jobs
+    arrive either as a stream at 85% of the cluster capacity or as a burst at once, e.g.
+    the slices of a protocol in the single package mode.
+*/
+
+#include "DistributeScheduler.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <sstream>
+
+using namespace Gadgetron;
+
+namespace
+{
+    const char* scheduler_names[] = { "least_active", "weighted_least_load", "power_of_two_choices", "work_stealing" };
+
+    struct SimulatedNode
+    {
+        double free_time;
+        std::deque<std::pair<double, double> > jobs; // start and finish time
+    };
+
+    struct JobEnd
+    {
+        double time;
+        size_t node;
+        size_t distributor;
+        double cost;
+
+        bool operator>(const JobEnd& other) const { return time > other.time; }
+    };
+
+    /// range(1): 0 for 2D jobs only, 1 for 90% 2D and 10% 3D jobs, 20 times the cost
+    double job_cost(benchmark::State& state, std::mt19937& gen)
+    {
+        std::uniform_real_distribution<double> dis(0.0, 1.0);
+        if (state.range(1) == 0) return 1.0;
+        return (dis(gen) < 0.1) ? 20.0 : 1.0;
+    }
+
+    /// returns the makespan
+    double simulate(benchmark::State& state, double& mean_flow_time)
+    {
+        const unsigned int capability[] = { 1, 1, 2, 4 };
+        const size_t num_nodes = 4;
+        const size_t num_distributors = 2;
+        const size_t num_jobs = (state.range(2) == 0) ? 2000 : 400;
+        const double publish_interval = 0.5;
+
+        double average_cost = (state.range(1) == 0) ? 1.0 : 0.9 + 0.1*20.0;
+        double arrival_rate = 0.85 * (1 + 1 + 2 + 4) / average_cost;
+
+        std::vector<GadgetronNodeInfo> published(num_nodes);
+        std::vector<SimulatedNode> nodes(num_nodes);
+        size_t n;
+        for (n = 0; n < num_nodes; n++)
+        {
+            std::stringstream address;
+            address << "10.0.0." << n + 1;
+            published[n].address = address.str();
+            published[n].port = 9002;
+            published[n].rest_port = 9080;
+            published[n].compute_capability = capability[n];
+            published[n].active_reconstructions = 0;
+            published[n].queue_length = 0;
+            published[n].last_recon = 0;
+            nodes[n].free_time = 0;
+        }
+
+        std::vector< std::unique_ptr<DistributeScheduler> > schedulers;
+        for (n = 0; n < num_distributors; n++)
+        {
+            schedulers.push_back(std::unique_ptr<DistributeScheduler>(DistributeScheduler::create(scheduler_names[state.range(0)])));
+        }
+
+        std::priority_queue<JobEnd, std::vector<JobEnd>, std::greater<JobEnd> > ends;
+        std::mt19937 gen(1234);
+        std::exponential_distribution<double> interarrival(arrival_rate);
+
+        double t = 0, next_publish = 0, makespan = 0, flow_time = 0;
+        for (size_t j = 0; j < num_jobs; j++)
+        {
+            if (state.range(2) == 0) t += interarrival(gen);
+            double cost = job_cost(state, gen);
+            size_t d = j % num_distributors;
+
+            while (!ends.empty() && ends.top().time <= t)
+            {
+                schedulers[ends.top().distributor]->job_finished(published[ends.top().node], ends.top().cost);
+                ends.pop();
+            }
+
+            if (t >= next_publish)
+            {
+                for (n = 0; n < num_nodes; n++)
+                {
+                    std::deque<std::pair<double, double> >& jobs = nodes[n].jobs;
+                    while (!jobs.empty() && jobs.front().second <= t) jobs.pop_front();
+
+                    published[n].active_reconstructions = (uint32_t)jobs.size();
+                    published[n].queue_length = (uint32_t)std::count_if(jobs.begin(), jobs.end(),
+                        [t](const std::pair<double, double>& job) { return job.first > t; });
+                }
+
+                while (next_publish <= t) next_publish += publish_interval;
+            }
+
+            int selected = schedulers[d]->select_node(published, cost);
+
+            SimulatedNode& node = nodes[selected];
+            double start = std::max(t, node.free_time);
+            double finish = start + cost / capability[selected];
+            node.free_time = finish;
+            node.jobs.push_back(std::make_pair(start, finish));
+
+            JobEnd e;
+            e.time = finish;
+            e.node = selected;
+            e.distributor = d;
+            e.cost = cost;
+            ends.push(e);
+
+            schedulers[d]->job_started(published[selected], cost);
+
+            makespan = std::max(makespan, finish);
+            flow_time += finish - t;
+        }
+
+        mean_flow_time = flow_time / num_jobs;
+        return makespan;
+    }
+
+    /// range(0): scheduler, range(1): job mix, range(2): 0 for a stream of jobs, 1 for a burst
+    void BM_DistributeScheduler_makespan(benchmark::State& state)
+    {
+        double makespan = 0, mean_flow_time = 0;
+        for (auto _ : state)
+        {
+            makespan = simulate(state, mean_flow_time);
+            benchmark::DoNotOptimize(makespan);
+        }
+
+        state.SetLabel(std::string(scheduler_names[state.range(0)]) + (state.range(1) == 0 ? " 2D" : " 2D+3D") + (state.range(2) == 0 ? " stream" : " burst"));
+        state.counters["makespan"] = makespan;
+        state.counters["mean_flow_time"] = mean_flow_time;
+    }
+}
+
+BENCHMARK(BM_DistributeScheduler_makespan)->ArgsProduct({ { 0, 1, 2, 3 }, { 0, 1 }, { 0, 1 } })->Unit(benchmark::kMillisecond);
@@ -0,0 +1,135 @@
+/** \file       FloatToFixPoint_benchmark.cpp
+    \brief      Auto scaling and fix point conversion of magnitude images, the AutoScaleGadget + FloatToFixPointGadget path against the fused kernels
+
+    The reference is the loops of the two gadgets: maximum, histogram and scaling of the float image in AutoScaleGadget,
+    then clamping and conversion in FloatToFixPointGadget.
+    The mismatch counter is the number of pixels which differ from the reference.
+*/
+
+#include "mri_core_image_conversion.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace Gadgetron;
+
+namespace
+{
+    void make_image(hoNDArray<float>& im)
+    {
+        size_t RO = im.get_size(0), E1 = im.get_size(1);
+
+        unsigned int seed = 1;
+        for (size_t y = 0; y < E1; y++)
+            for (size_t r = 0; r < RO; r++)
+            {
+                float px = (float)r / RO - 0.5f, py = (float)y / E1 - 0.5f;
+
+                seed = seed * 1103515245u + 12345u;
+                float noise = (float)((seed >> 8) & 0xFFFF) / 65536;
+
+                float obj = (px*px + py*py < 0.16f) ? 300.0f*(1.0f + 0.5f*std::sin(30 * px)*std::cos(20 * py)) : 0.0f;
+                im(r, y) = obj + 5.0f*noise;
+            }
+
+        // a few bright pixels, the auto scaling ignores them
+        for (size_t n = 0; n < 16; n++) im(n*RO / 16 + RO*E1 / 2) = 5000.0f;
+    }
+
+    template <typename T> void reference(hoNDArray<float>& d, float max_value, T min_intensity, T max_intensity, hoNDArray<T>& res)
+    {
+        size_t N = d.get_number_of_elements();
+        size_t histogram_bins = 100;
+        std::vector<size_t> histogram(histogram_bins);
+
+        // AutoScaleGadget
+        float max = 0.0f;
+        for (size_t i = 0; i < N; i++) {
+            if (d(i) > max) max = d(i);
+        }
+
+        for (size_t i = 0; i < histogram_bins; i++) histogram[i] = 0;
+
+        for (size_t i = 0; i < N; i++) {
+            size_t bin = static_cast<size_t>(std::floor((d(i) / max)*histogram_bins));
+            if (bin >= histogram_bins) bin = histogram_bins - 1;
+            histogram[bin]++;
+        }
+
+        long long cumsum = 0;
+        size_t counter = 0;
+        while (cumsum < (0.99*N)) {
+            cumsum += (long long)(histogram[counter++]);
+        }
+        max = (counter + 1)*(max / histogram_bins);
+
+        float scale = max_value / max;
+        for (size_t i = 0; i < N; i++) d(i) *= scale;
+
+        // FloatToFixPointGadget
+        float* src = d.begin();
+        T* dst = res.begin();
+        long long i;
+        long long numOfPixels = (long long)N;
+
+#pragma omp parallel for default(none) private(i) shared(numOfPixels, src, dst, min_intensity, max_intensity)
+        for (i = 0; i < numOfPixels; i++)
+        {
+            float pix_val = src[i];
+            pix_val = std::abs(pix_val);
+            if (pix_val < (float)min_intensity) pix_val = (float)min_intensity;
+            if (pix_val > (float)max_intensity) pix_val = (float)max_intensity;
+            dst[i] = static_cast<T>(pix_val + 0.5);
+        }
+    }
+
+    template <typename T> void BM_autoscale_reference(benchmark::State& state)
+    {
+        size_t N = state.range(0);
+        hoNDArray<float> im(N, N), d;
+        hoNDArray<T> res(N, N);
+        make_image(im);
+
+        // the gadget scales its input in place, the work does not depend on the values
+        d = im;
+
+        for (auto _ : state)
+        {
+            reference<T>(d, 2048.0f, 0, 4095, res);
+            benchmark::DoNotOptimize(res.begin());
+        }
+
+        state.counters["images/s"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+    }
+
+    template <typename T> void BM_autoscale_fused(benchmark::State& state)
+    {
+        size_t N = state.range(0);
+        hoNDArray<float> im(N, N), d;
+        hoNDArray<T> res(N, N), ref(N, N);
+        make_image(im);
+
+        for (auto _ : state)
+        {
+            float max = compute_histogram_percentile(im, 100, 0.99);
+            convert_to_fix_point(im, 2048.0f / max, 0.0f, true, true, (T)0, (T)4095, res);
+            benchmark::DoNotOptimize(res.begin());
+        }
+
+        d = im;
+        reference<T>(d, 2048.0f, 0, 4095, ref);
+
+        size_t mismatch = 0;
+        for (size_t n = 0; n < res.get_number_of_elements(); n++) mismatch += (res(n) != ref(n));
+
+        state.counters["images/s"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+        state.counters["mismatch"] = (double)mismatch;
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_autoscale_reference, unsigned short)->Arg(256)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_autoscale_fused, unsigned short)->Arg(256)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_autoscale_fused, short)->Arg(256)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_autoscale_fused, unsigned int)->Arg(256)->Arg(512)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_autoscale_fused, int)->Arg(256)->Arg(512)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,113 @@
+/** \file       GrappaWeights_benchmark.cpp
+    \brief      GRAPPA unmixing of a 2D slice, frames per second
+
+    [RO E1 CHA] = [256 256 32] coil images, 2 sets (combined and one uncombined channel).
+    The scalar triple loop the unmixing used to be is the reference, the contended case
+    publishes new weights from a second thread while the frames are unmixed.
+*/
+
+#include "GrappaWeights.h"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <complex>
+#include <thread>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef std::complex<float> T;
+
+    const size_t RO = 256;
+    const size_t E1 = 256;
+    const size_t CHA = 32;
+    const size_t SETS = 2;
+
+    void fill(hoNDArray<T>& x, size_t seed)
+    {
+        for (size_t n = 0; n < x.get_number_of_elements(); n++) x(n) = T((float)((n + seed) % 13) / 13, (float)((n + seed) % 7) / 7);
+    }
+
+    void BM_unmix_reference(benchmark::State& state)
+    {
+        hoNDArray<T> w(RO, E1, 1, CHA, SETS), in(RO, E1, 1, CHA), out(RO, E1, 1, SETS);
+        fill(w, 1);
+        fill(in, 2);
+
+        size_t image_elements = RO*E1;
+        T* weights_ptr = w.begin();
+        T* in_ptr = in.begin();
+        T* out_ptr = out.begin();
+
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < image_elements*SETS; i++) out_ptr[i] = 0;
+
+            for (size_t s = 0; s < SETS; s++)
+                for (size_t p = 0; p < image_elements; p++)
+                    for (size_t c = 0; c < CHA; c++)
+                        out_ptr[s*image_elements + p] += weights_ptr[s*image_elements*CHA + c*image_elements + p] * in_ptr[c*image_elements + p];
+
+            benchmark::DoNotOptimize(out_ptr);
+        }
+
+        state.counters["frames/s"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+    }
+
+    void BM_unmix(benchmark::State& state)
+    {
+        hoNDArray<T> w(RO, E1, 1, CHA, SETS), in(RO, E1, 1, CHA), out(RO, E1, 1, SETS);
+        fill(w, 1);
+        fill(in, 2);
+
+        GrappaWeights<float> weights;
+        weights.update(&w);
+
+        for (auto _ : state)
+        {
+            weights.apply(&in, &out);
+            benchmark::DoNotOptimize(out.begin());
+        }
+
+        state.counters["frames/s"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+    }
+
+    void BM_unmix_during_updates(benchmark::State& state)
+    {
+        hoNDArray<T> w(RO, E1, 1, CHA, SETS), w2(RO, E1, 1, CHA, SETS), in(RO, E1, 1, CHA), out(RO, E1, 1, SETS);
+        fill(w, 1);
+        fill(w2, 3);
+        fill(in, 2);
+
+        GrappaWeights<float> weights;
+        weights.update(&w);
+
+        std::atomic<bool> done(false);
+        std::atomic<size_t> updates(0);
+        std::thread calculator([&]()
+        {
+            while (!done)
+            {
+                weights.update((updates % 2) ? &w : &w2);
+                updates++;
+                std::this_thread::yield();
+            }
+        });
+
+        for (auto _ : state)
+        {
+            weights.apply(&in, &out);
+            benchmark::DoNotOptimize(out.begin());
+        }
+
+        done = true;
+        calculator.join();
+
+        state.counters["frames/s"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+        state.counters["updates"] = (double)updates;
+    }
+}
+
+BENCHMARK(BM_unmix_reference)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_unmix)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_unmix_during_updates)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,159 @@
+/** \file       MetaBinaryCodec_benchmark.cpp
+    \brief      Serialization cost and bytes per image of the XML and binary image meta attributes
+
+    The meta attributes are those of a GenericReconGadget image, with the window and colormap
+    attributes of a parametric map. A series of images is encoded as on one connection, so the
+    string table of the binary encoding is shared by the images.
+*/
+
+#include "MetaBinaryCodec.h"
+#include "mri_core_def.h"
+#include <benchmark/benchmark.h>
+#include <ismrmrd/meta.h>
+#include <sstream>
+
+using namespace Gadgetron;
+
+namespace
+{
+    ISMRMRD::MetaContainer image_meta(size_t n)
+    {
+        ISMRMRD::MetaContainer meta;
+
+        meta.set(GADGETRON_IMAGENUMBER, (long)n);
+        meta.set(GADGETRON_IMAGEPROCESSINGHISTORY, "GT");
+        meta.append(GADGETRON_IMAGEPROCESSINGHISTORY, "T1");
+        meta.set(GADGETRON_IMAGECOMMENT, "GT");
+        meta.append(GADGETRON_IMAGECOMMENT, GADGETRON_IMAGE_T1MAP);
+        meta.set(GADGETRON_SEQUENCEDESCRIPTION, "_GT_T1MAP");
+        meta.set(GADGETRON_DATA_ROLE, GADGETRON_IMAGE_T1MAP);
+        meta.set(GADGETRON_IMAGE_WINDOWCENTER, (long)1300);
+        meta.set(GADGETRON_IMAGE_WINDOWWIDTH, (long)1300);
+        meta.set(GADGETRON_IMAGE_COLORMAP, "Perfusion.pal");
+        meta.set(GADGETRON_IMAGE_SCALE_RATIO, 1.0 / (n + 3));
+        meta.set(GADGETRON_IMAGE_INVERSIONTIME, 100.0 + 80.0 * n);
+
+        meta.set("encoding", (long)0);
+
+        meta.set("encoding_FOV", 360.0);
+        meta.append("encoding_FOV", 270.0);
+        meta.append("encoding_FOV", 8.0);
+
+        meta.set("recon_FOV", 360.0);
+        meta.append("recon_FOV", 270.0);
+        meta.append("recon_FOV", 8.0);
+
+        meta.set("encoded_matrix", (long)256);
+        meta.append("encoded_matrix", (long)144);
+        meta.append("encoded_matrix", (long)1);
+
+        meta.set("recon_matrix", (long)256);
+        meta.append("recon_matrix", (long)192);
+        meta.append("recon_matrix", (long)1);
+
+        meta.set("sampling_limits_RO", (long)0);
+        meta.append("sampling_limits_RO", (long)128);
+        meta.append("sampling_limits_RO", (long)255);
+
+        meta.set("sampling_limits_E1", (long)0);
+        meta.append("sampling_limits_E1", (long)72);
+        meta.append("sampling_limits_E1", (long)143);
+
+        meta.set("sampling_limits_E2", (long)0);
+        meta.append("sampling_limits_E2", (long)0);
+        meta.append("sampling_limits_E2", (long)0);
+
+        return meta;
+    }
+
+    const size_t num_images = 256;
+
+    std::vector<ISMRMRD::MetaContainer> image_series()
+    {
+        std::vector<ISMRMRD::MetaContainer> series;
+        for (size_t n = 0; n < num_images; n++) series.push_back(image_meta(n));
+        return series;
+    }
+
+    void BM_MetaXML_roundtrip(benchmark::State& state)
+    {
+        std::vector<ISMRMRD::MetaContainer> series = image_series();
+
+        size_t bytes = 0;
+        for (auto _ : state)
+        {
+            bytes = 0;
+            for (size_t n = 0; n < num_images; n++)
+            {
+                std::stringstream str;
+                ISMRMRD::serialize(series[n], str);
+                std::string buf = str.str();
+                bytes += buf.length() + 1;
+
+                ISMRMRD::MetaContainer meta;
+                ISMRMRD::deserialize(buf.c_str(), meta);
+                benchmark::DoNotOptimize(meta);
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * num_images);
+        state.counters["bytes_per_image"] = (double)bytes / num_images;
+    }
+
+    void BM_MetaBinary_roundtrip(benchmark::State& state)
+    {
+        std::vector<ISMRMRD::MetaContainer> series = image_series();
+
+        size_t bytes = 0;
+        std::string buf;
+        for (auto _ : state)
+        {
+            //A new connection for every series
+            MetaBinaryEncoder encoder;
+            MetaBinaryDecoder decoder;
+
+            bytes = 0;
+            for (size_t n = 0; n < num_images; n++)
+            {
+                encoder.encode(series[n], buf);
+                bytes += buf.length();
+
+                ISMRMRD::MetaContainer meta;
+                if (!decoder.decode(buf.c_str(), buf.length(), meta))
+                {
+                    state.SkipWithError("Unable to decode binary meta attributes");
+                    return;
+                }
+                benchmark::DoNotOptimize(meta);
+            }
+        }
+
+        //The decoded attributes are the same as those read from XML
+        MetaBinaryEncoder encoder;
+        MetaBinaryDecoder decoder;
+        for (size_t n = 0; n < num_images; n++)
+        {
+            std::stringstream xml, binary_xml;
+            ISMRMRD::serialize(series[n], xml);
+
+            ISMRMRD::MetaContainer from_xml, from_binary;
+            ISMRMRD::deserialize(xml.str().c_str(), from_xml);
+
+            encoder.encode(from_xml, buf);
+            decoder.decode(buf.c_str(), buf.length(), from_binary);
+            ISMRMRD::serialize(from_binary, binary_xml);
+
+            if (xml.str() != binary_xml.str())
+            {
+                state.SkipWithError("Binary meta attributes differ from XML");
+                return;
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * num_images);
+        state.counters["bytes_per_image"] = (double)bytes / num_images;
+    }
+}
+
+BENCHMARK(BM_MetaXML_roundtrip)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_MetaBinary_roundtrip)->Unit(benchmark::kMicrosecond);
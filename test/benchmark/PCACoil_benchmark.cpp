@@ -0,0 +1,192 @@
+/** \file       PCACoil_benchmark.cpp
+    \brief      Latency to the first compressed readout of PCACoilGadget, buffered against streaming
+
+    Readouts are [RO CHA] = [256 CHA], the central 16 samples of every profile are used for the PCA.
+    buffered : the gadget holds 100 profiles, builds the [1600 CHA] data matrix, computes the KLT and transforms the backlog
+    streaming: the covariance is updated for every profile and the KLT is computed from it after 16 profiles
+
+    The time is the compute time from the first readout to the first compressed readout;
+    the readouts held until then (profiles_held) add their acquisition time to the latency.
+    BM_pca_transform is the steady state, readouts per second when 1, 8 or 32 readouts are stacked
+    and transformed with one matrix product (streaming_block_size).
+*/
+
+#include "hoNDKLT.h"
+#include <benchmark/benchmark.h>
+#include <complex>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef std::complex<float> T;
+
+    const size_t RO = 256;
+    const size_t samples_to_use = 16;
+
+    /// num readouts [RO CHA], every channel is a mixture of 8 sources plus noise
+    void make_readouts(size_t CHA, size_t num, std::vector< hoNDArray<T> >& readouts)
+    {
+        std::mt19937 gen(1234);
+        std::normal_distribution<float> dis(0.0f, 1.0f);
+
+        size_t num_sources = 8;
+        hoNDArray<T> mix(num_sources, CHA);
+        for (size_t n = 0; n < mix.get_number_of_elements(); n++) mix(n) = T(dis(gen), dis(gen)) / (float)(1 + n%num_sources);
+
+        readouts.resize(num);
+        std::vector<T> src(num_sources);
+
+        for (size_t p = 0; p < num; p++)
+        {
+            readouts[p].create(RO, CHA);
+
+            for (size_t ro = 0; ro < RO; ro++)
+            {
+                // k-space like decay from the center of the readout
+                float w = 1.0f / (1.0f + 0.1f*std::abs((float)ro - RO / 2));
+                for (size_t s = 0; s < num_sources; s++) src[s] = w*T(dis(gen), dis(gen));
+
+                for (size_t c = 0; c < CHA; c++)
+                {
+                    T v(0.01f*dis(gen), 0.01f*dis(gen));
+                    for (size_t s = 0; s < num_sources; s++) v += src[s] * mix(s, c);
+                    readouts[p](ro, c) = v;
+                }
+            }
+        }
+    }
+
+    void BM_pca_first_output_buffered(benchmark::State& state)
+    {
+        size_t CHA = state.range(0);
+        size_t num_profiles = 100;
+
+        std::vector< hoNDArray<T> > readouts;
+        make_readouts(CHA, num_profiles, readouts);
+
+        size_t data_offset = RO / 2 - samples_to_use / 2;
+        size_t total_samples = samples_to_use*num_profiles;
+
+        for (auto _ : state)
+        {
+            // the loop of PCACoilGadget, once the buffer is full
+            hoNDArray<T> A(total_samples, CHA);
+            std::vector<T> means(CHA, T(0));
+
+            size_t sample_counter = 0;
+            for (size_t p = 0; p < num_profiles; p++)
+            {
+                const T* d = readouts[p].begin();
+                for (size_t s = 0; s < samples_to_use; s++)
+                {
+                    for (size_t c = 0; c < CHA; c++)
+                    {
+                        A(sample_counter, c) = d[c*RO + data_offset + s];
+                        means[c] += d[c*RO + data_offset + s];
+                    }
+                    sample_counter++;
+                }
+            }
+
+            for (size_t c = 0; c < CHA; c++)
+                for (size_t s = 0; s < total_samples; s++) A(s, c) -= means[c] / T((float)total_samples, 0);
+
+            hoNDKLT<T> VT;
+            VT.prepare(A, (size_t)1, (size_t)0, false);
+
+            hoNDArray<T> out;
+            VT.transform(readouts[0], out, 1);
+            benchmark::DoNotOptimize(out.begin());
+        }
+
+        state.counters["profiles_held"] = (double)num_profiles;
+    }
+
+    void BM_pca_first_output_streaming(benchmark::State& state)
+    {
+        size_t CHA = state.range(0);
+        size_t num_profiles = 16;
+
+        std::vector< hoNDArray<T> > readouts;
+        make_readouts(CHA, num_profiles, readouts);
+
+        size_t data_offset = RO / 2 - samples_to_use / 2;
+
+        for (auto _ : state)
+        {
+            hoNDKLTCovariance<T> cov(CHA);
+            for (size_t p = 0; p < num_profiles; p++) cov.add(readouts[p].begin() + data_offset, samples_to_use, RO);
+
+            hoNDArray<T> C;
+            cov.covariance(C);
+
+            std::vector<size_t> untransformed;
+            hoNDKLT<T> VT;
+            VT.prepare_covariance(C, untransformed, 0);
+
+            hoNDArray<T> out;
+            VT.transform(readouts[0], out, 1);
+            benchmark::DoNotOptimize(out.begin());
+        }
+
+        state.counters["profiles_held"] = (double)num_profiles;
+    }
+
+    void BM_pca_transform(benchmark::State& state)
+    {
+        size_t CHA = 32;
+        size_t K = state.range(0);
+        size_t num = 64;
+
+        std::vector< hoNDArray<T> > readouts;
+        make_readouts(CHA, num, readouts);
+
+        hoNDKLTCovariance<T> cov(CHA);
+        for (size_t p = 0; p < num; p++) cov.add(readouts[p].begin() + RO / 2 - samples_to_use / 2, samples_to_use, RO);
+
+        hoNDArray<T> C;
+        cov.covariance(C);
+
+        std::vector<size_t> untransformed;
+        hoNDKLT<T> VT;
+        VT.prepare_covariance(C, untransformed, 0);
+
+        hoNDArray<T> block_in, block_out, out;
+
+        for (auto _ : state)
+        {
+            for (size_t start = 0; start < num; start += K)
+            {
+                if (K == 1)
+                {
+                    VT.transform(readouts[start], out, 1);
+                    benchmark::DoNotOptimize(out.begin());
+                    continue;
+                }
+
+                block_in.create(RO*K, CHA);
+                for (size_t k = 0; k < K; k++)
+                    for (size_t c = 0; c < CHA; c++) memcpy(block_in.begin() + c*RO*K + k*RO, readouts[start + k].begin() + c*RO, sizeof(T)*RO);
+
+                VT.transform(block_in, block_out, 1);
+
+                for (size_t k = 0; k < K; k++)
+                {
+                    out.create(RO, CHA);
+                    for (size_t c = 0; c < CHA; c++) memcpy(out.begin() + c*RO, block_out.begin() + c*RO*K + k*RO, sizeof(T)*RO);
+                    benchmark::DoNotOptimize(out.begin());
+                }
+            }
+        }
+
+        state.counters["readouts/s"] = benchmark::Counter((double)(state.iterations()*num), benchmark::Counter::kIsRate);
+    }
+}
+
+BENCHMARK(BM_pca_first_output_buffered)->Arg(16)->Arg(32)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_pca_first_output_streaming)->Arg(16)->Arg(32)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_pca_transform)->Arg(1)->Arg(8)->Arg(32)->Unit(benchmark::kMicrosecond);
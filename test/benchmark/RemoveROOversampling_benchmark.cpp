@@ -0,0 +1,109 @@
+/** \file       RemoveROOversampling_benchmark.cpp
+    \brief      Removal of 2x readout oversampling per readout, ifft + crop + fft against the half-band filter
+
+    Readouts are [RO CHA] = [512 CHA], CHA = 16, 32.
+    The reference is the loop of RemoveROOversamplingGadget: ifft through hoNDFFT, copy of the central half and fft.
+    The filter cases use 16, 24 and 32 taps; rel_error is the relative l2 difference to the reference in kspace.
+*/
+
+#include "hoNDFFT.h"
+#include "mri_core_kspace_filter.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef std::complex<float> T;
+
+    const size_t RO = 512;
+
+    /// kspace of a centered object with 20% noise free margin on each side of the field of view
+    void make_readout(size_t CHA, hoNDArray<T>& data)
+    {
+        data.create(RO, CHA);
+
+        unsigned int seed = 1;
+        for (size_t c = 0; c < CHA; c++)
+        {
+            for (size_t n = 0; n < RO; n++)
+            {
+                double k = ((double)n - RO / 2) / RO;
+                double s = (k == 0) ? 1.0 : std::sin(M_PI * k * RO * 0.4) / (M_PI * k * RO * 0.4);
+
+                seed = seed * 1103515245u + 12345u;
+                float noise = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+
+                data(n, c) = T((float)(s * std::cos(0.1 * c * n)), (float)(s * std::sin(0.1 * c * n))) + 0.001f*noise;
+            }
+        }
+    }
+
+    void reference(hoNDArray<T>& data, hoNDArray<T>& res)
+    {
+        size_t CHA = data.get_size(1);
+        size_t dRO = RO / 2;
+        size_t start = (RO - dRO) / 2;
+
+        res.create(dRO, CHA);
+
+        hoNDFFT<float>::instance()->ifft(&data, 0);
+        for (size_t c = 0; c < CHA; c++) memcpy(res.begin() + c*dRO, data.begin() + c*RO + start, sizeof(T)*dRO);
+        hoNDFFT<float>::instance()->fft(&res, 0);
+    }
+
+    void BM_remove_ro_oversampling_fft(benchmark::State& state)
+    {
+        size_t CHA = state.range(0);
+
+        hoNDArray<T> readout, data, res;
+        make_readout(CHA, readout);
+
+        for (auto _ : state)
+        {
+            // the gadget transforms its input in place
+            data = readout;
+            reference(data, res);
+            benchmark::DoNotOptimize(res.begin());
+        }
+
+        state.counters["readouts/s"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+    }
+
+    void BM_remove_ro_oversampling_filter(benchmark::State& state)
+    {
+        size_t CHA = state.range(0);
+        size_t num_taps = state.range(1);
+
+        hoNDArray<T> readout, data, res, ref;
+        make_readout(CHA, readout);
+
+        ROOversamplingFilter<float> filter;
+        generate_ro_oversampling_filter(RO, num_taps, 6.0, filter);
+
+        for (auto _ : state)
+        {
+            remove_ro_oversampling(readout, filter, res);
+            benchmark::DoNotOptimize(res.begin());
+        }
+
+        data = readout;
+        reference(data, ref);
+
+        double diff = 0, norm = 0;
+        for (size_t n = 0; n < res.get_number_of_elements(); n++)
+        {
+            diff += std::norm(res(n) - ref(n));
+            norm += std::norm(ref(n));
+        }
+
+        state.counters["readouts/s"] = benchmark::Counter((double)state.iterations(), benchmark::Counter::kIsRate);
+        state.counters["rel_error"] = std::sqrt(diff / norm);
+    }
+}
+
+BENCHMARK(BM_remove_ro_oversampling_fft)->Arg(16)->Arg(32)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_remove_ro_oversampling_filter)->Args({ 16, 16 })->Args({ 16, 24 })->Args({ 16, 32 })->Args({ 32, 16 })->Args({ 32, 24 })->Args({ 32, 32 })->Unit(benchmark::kMicrosecond);
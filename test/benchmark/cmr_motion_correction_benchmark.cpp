@@ -0,0 +1,59 @@
+/** \file       cmr_motion_correction_benchmark.cpp
+    \brief      2D non-rigid registration of an image series to a key frame
+
+    [RO E1 N] = [RO RO 16], RO = 256, 384, 512.
+    The frames are a shifted and breathing phantom, the parameters are those of the respiratory navigator
+    motion correction in cmr_kspace_binning.
+*/
+
+#include "cmr_motion_correction.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+using namespace Gadgetron;
+
+namespace
+{
+    void make_series(hoNDArray<float>& x)
+    {
+        size_t RO = x.get_size(0), E1 = x.get_size(1), N = x.get_size(2);
+
+        for (size_t n = 0; n < N; n++)
+        {
+            float shift = 0.03f*std::sin(6.2832f*n / N);
+            float scale = 1.0f + 0.05f*std::cos(6.2832f*n / N);
+
+            for (size_t e1 = 0; e1 < E1; e1++)
+                for (size_t ro = 0; ro < RO; ro++)
+                {
+                    float px = ((float)ro / RO - 0.5f) * scale, py = (float)e1 / E1 - 0.5f - shift;
+                    float r2 = px*px + py*py;
+                    float v = (r2 < 0.16f) ? 100.0f : 0.0f;
+                    if ((px - 0.1f)*(px - 0.1f) + py*py < 0.01f) v = 300.0f;
+                    x(ro, e1, n) = v + 10.0f*std::cos(40 * px)*std::cos(30 * py);
+                }
+        }
+    }
+
+    void BM_perform_moco_fixed_key_frame_2DT(benchmark::State& state)
+    {
+        size_t RO = state.range(0);
+        hoNDArray<float> series(RO, RO, 16);
+        make_series(series);
+
+        std::vector<unsigned int> iters(4);
+        iters[0] = 1;
+        iters[1] = 32;
+        iters[2] = 100;
+        iters[3] = 100;
+
+        for (auto _ : state)
+        {
+            hoImageRegContainer2DRegistration<hoNDImage<float, 2>, hoNDImage<float, 2>, float> reg;
+            perform_moco_fixed_key_frame_2DT(series, 0, 6.0f, iters, false, false, reg);
+            benchmark::DoNotOptimize(&reg);
+        }
+    }
+}
+
+BENCHMARK(BM_perform_moco_fixed_key_frame_2DT)->Arg(256)->Arg(384)->Arg(512)->Unit(benchmark::kMillisecond);
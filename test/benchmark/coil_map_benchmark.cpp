@@ -0,0 +1,171 @@
+/** \file       coil_map_benchmark.cpp
+    \brief      Inati coil map estimation, the running box sum implementation against coil_map_2d_Inati and coil_map_3d_Inati
+
+    2D: [RO E1 CHA] = [128 128 32]
+    3D: [RO E1 E2 CHA] = [64 64 32 16]
+
+    The error counter is the l2 norm of the difference of the coil maps to the current implementation inside the object,
+    relative to the norm of the current coil maps. The coil images are smooth coil sensitivities times an object, with noise.
+*/
+
+#include "mri_core_coil_map_estimation.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef std::complex<float> T;
+
+    void make_coil_images(hoNDArray<T>& x)
+    {
+        size_t RO = x.get_size(0), E1 = x.get_size(1), E2 = x.get_size(2), CHA = x.get_size(3);
+
+        unsigned int seed = 1;
+        for (size_t c = 0; c < CHA; c++)
+        {
+            float cx = (float)(c % 4) / 3, cy = (float)((c / 4) % 4) / 3, cz = (float)(c / 16);
+            for (size_t z = 0; z < E2; z++)
+                for (size_t y = 0; y < E1; y++)
+                    for (size_t r = 0; r < RO; r++)
+                    {
+                        float px = (float)r / RO, py = (float)y / E1, pz = (E2 > 1) ? (float)z / E2 : 0.5f;
+                        float d2 = (px - cx)*(px - cx) + (py - cy)*(py - cy) + (pz - cz)*(pz - cz);
+                        T sen = std::polar(std::exp(-2 * d2), (float)(3 * px + 2 * c * py));
+
+                        float ox = px - 0.5f, oy = py - 0.5f, oz = pz - 0.5f;
+                        T obj = (ox*ox + oy*oy + oz*oz < 0.16f) ? std::polar(1.0f + 0.3f*std::sin(20 * px), 2 * py) : T(0);
+
+                        seed = seed * 1103515245u + 12345u;
+                        float nr = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+                        seed = seed * 1103515245u + 12345u;
+                        float ni = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+
+                        x(r, y, z, c) = sen*obj + 0.01f*T(nr, ni);
+                    }
+        }
+    }
+
+    // inside the object only, the phase of the coil map is arbitrary where there is only noise
+    float relative_error(const hoNDArray<T>& a, const hoNDArray<T>& ref, const hoNDArray<T>& im)
+    {
+        size_t CHA = im.get_size(im.get_number_of_dimensions() - 1);
+        size_t N = im.get_number_of_elements() / CHA;
+
+        std::vector<float> energy(N, 0);
+        float max_energy = 0;
+        for (size_t n = 0; n < N; n++)
+        {
+            for (size_t c = 0; c < CHA; c++) energy[n] += std::norm(im(n + c*N));
+            max_energy = std::max(max_energy, energy[n]);
+        }
+
+        double err = 0, m = 0;
+        for (size_t n = 0; n < N; n++)
+        {
+            if (energy[n] < 0.1f*max_energy) continue;
+
+            for (size_t c = 0; c < CHA; c++)
+            {
+                err += std::norm(a(n + c*N) - ref(n + c*N));
+                m += std::norm(ref(n + c*N));
+            }
+        }
+        return (float)std::sqrt(err / m);
+    }
+
+    struct CoilMapData
+    {
+        CoilMapData(size_t RO, size_t E1, size_t E2, size_t CHA) : im(RO, E1, E2, CHA)
+        {
+            make_coil_images(im);
+            if (E2 == 1)
+            {
+                hoNDArray<T> im2(RO, E1, CHA, im.begin());
+                coil_map_2d_Inati(im2, ref, 7, 3);
+            }
+            else
+            {
+                coil_map_3d_Inati(im, ref, 7, 5, 3);
+            }
+        }
+
+        hoNDArray<T> im;
+        hoNDArray<T> ref;
+    };
+
+    CoilMapData& data_2d()
+    {
+        static CoilMapData d(128, 128, 1, 32);
+        return d;
+    }
+
+    CoilMapData& data_3d()
+    {
+        static CoilMapData d(64, 64, 32, 16);
+        return d;
+    }
+
+    void BM_coil_map_2d_Inati(benchmark::State& state)
+    {
+        CoilMapData& d = data_2d();
+        hoNDArray<T> im(128, 128, 32, d.im.begin()), cmap;
+
+        for (auto _ : state)
+        {
+            coil_map_2d_Inati(im, cmap, 7, 3);
+            benchmark::DoNotOptimize(cmap.begin());
+        }
+    }
+
+    void BM_coil_map_2d_Inati_fast(benchmark::State& state)
+    {
+        CoilMapData& d = data_2d();
+        hoNDArray<T> im(128, 128, 32, d.im.begin()), cmap;
+        size_t step = state.range(0);
+
+        for (auto _ : state)
+        {
+            coil_map_2d_Inati_fast(im, cmap, 7, 3, step);
+            benchmark::DoNotOptimize(cmap.begin());
+        }
+
+        hoNDArray<T> ref(128, 128, 32, d.ref.begin());
+        state.counters["error"] = relative_error(cmap, ref, im);
+    }
+
+    void BM_coil_map_3d_Inati(benchmark::State& state)
+    {
+        CoilMapData& d = data_3d();
+        hoNDArray<T> cmap;
+
+        for (auto _ : state)
+        {
+            coil_map_3d_Inati(d.im, cmap, 7, 5, 3);
+            benchmark::DoNotOptimize(cmap.begin());
+        }
+    }
+
+    void BM_coil_map_3d_Inati_fast(benchmark::State& state)
+    {
+        CoilMapData& d = data_3d();
+        hoNDArray<T> cmap;
+        size_t step = state.range(0);
+
+        for (auto _ : state)
+        {
+            coil_map_3d_Inati_fast(d.im, cmap, 7, 5, 3, step);
+            benchmark::DoNotOptimize(cmap.begin());
+        }
+
+        state.counters["error"] = relative_error(cmap, d.ref, d.im);
+    }
+}
+
+BENCHMARK(BM_coil_map_2d_Inati)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_coil_map_2d_Inati_fast)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_coil_map_3d_Inati)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_coil_map_3d_Inati_fast)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond);
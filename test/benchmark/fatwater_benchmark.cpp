@@ -0,0 +1,121 @@
+/** \file       fatwater_benchmark.cpp
+    \brief      Timing of the fat-water separation on a synthetic multi-echo volume
+
+    A sphere of water with a shell of fat in a smooth field map, 6 echoes at 3T. The counter
+    fat_fraction_error is the mean absolute error of the fat fraction inside the object, it is
+    large when the graph cut swaps fat and water.
+*/
+
+#include "fatwater.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace
+{
+    FatWaterAlgorithm water_fat_species()
+    {
+        FatWaterAlgorithm a;
+
+        ChemicalSpecies w("water");
+        w.ampFreq_.push_back(std::make_pair(1.0, 0.0));
+
+        ChemicalSpecies f("fat");
+        f.ampFreq_.push_back(std::make_pair(0.087, -3.8));
+        f.ampFreq_.push_back(std::make_pair(0.693, -3.4));
+        f.ampFreq_.push_back(std::make_pair(0.128, -2.6));
+        f.ampFreq_.push_back(std::make_pair(0.004, -1.94));
+        f.ampFreq_.push_back(std::make_pair(0.039, -0.39));
+        f.ampFreq_.push_back(std::make_pair(0.048, 0.60));
+
+        a.species_.push_back(w);
+        a.species_.push_back(f);
+        return a;
+    }
+
+    /// data [X, Y, Z, 1, 1, S, 1] and the true fat fraction
+    void make_phantom(size_t X, size_t Y, size_t Z, const FatWaterParameters& p, const FatWaterAlgorithm& a,
+        hoNDArray< std::complex<float> >& data, hoNDArray<float>& fat_fraction)
+    {
+        size_t S = p.echoTimes_.size();
+        data.create(X, Y, Z, 1, 1, S, 1);
+        fat_fraction.create(X, Y, Z);
+
+        std::mt19937 gen(42);
+        std::normal_distribution<float> noise(0.0f, 0.01f);
+
+        const double two_pi = 6.283185307179586;
+        for (size_t z = 0; z < Z; z++)
+        {
+            for (size_t y = 0; y < Y; y++)
+            {
+                for (size_t x = 0; x < X; x++)
+                {
+                    double dx = (x - X / 2.0) / (X / 2.0), dy = (y - Y / 2.0) / (Y / 2.0), dz = (Z > 1) ? (z - Z / 2.0) / (Z / 2.0) : 0;
+                    double r = std::sqrt(dx*dx + dy*dy + dz*dz);
+
+                    double water = (r < 0.7) ? 1.0 : 0.0;
+                    double fat = (r >= 0.7 && r < 0.9) ? 1.0 : ((r < 0.7 && dx > 0.3) ? 0.5 : 0.0);
+                    fat_fraction(x, y, z) = (water + fat > 0) ? (float)(fat / (water + fat)) : 0.0f;
+
+                    // smooth field map, -60 to 60 Hz
+                    double fm = 60.0*std::sin(1.5*dx + 0.5)*std::cos(1.2*dy);
+
+                    for (size_t s = 0; s < S; s++)
+                    {
+                        double te = p.echoTimes_[s] * 0.001;
+                        std::complex<double> v = water;
+                        for (auto& peak : a.species_[1].ampFreq_)
+                        {
+                            double freq = p.fieldStrengthT_*42.576*peak.second;
+                            v += fat*peak.first*std::exp(std::complex<double>(0, two_pi*freq*te));
+                        }
+                        v *= std::exp(std::complex<double>(0, two_pi*fm*te));
+                        data(x + X*(y + Y*z) + X*Y*Z*s) = std::complex<float>((float)v.real() + noise(gen), (float)v.imag() + noise(gen));
+                    }
+                }
+            }
+        }
+    }
+
+    /// range(0): X and Y, range(1): Z
+    void BM_fatwater_separation(benchmark::State& state)
+    {
+        size_t X = state.range(0), Y = state.range(0), Z = state.range(1);
+
+        FatWaterParameters p;
+        p.fieldStrengthT_ = 2.89f;
+        for (size_t s = 0; s < 6; s++) p.echoTimes_.push_back(1.2f + 1.0f*s);
+
+        FatWaterAlgorithm a = water_fat_species();
+
+        hoNDArray< std::complex<float> > data;
+        hoNDArray<float> fat_fraction;
+        make_phantom(X, Y, Z, p, a, data, fat_fraction);
+
+        hoNDArray< std::complex<float> > out;
+        for (auto _ : state)
+        {
+            out = fatwater_separation(data, p, a);
+            benchmark::DoNotOptimize(out.begin());
+        }
+
+        double error = 0;
+        size_t num = 0;
+        size_t V = X*Y*Z;
+        for (size_t v = 0; v < V; v++)
+        {
+            float w = std::abs(out(v)), f = std::abs(out(v + V));
+            if (w + f < 0.5f) continue;
+            error += std::abs(f / (w + f) - fat_fraction(v));
+            num++;
+        }
+
+        state.SetItemsProcessed(state.iterations() * V);
+        state.counters["fat_fraction_error"] = (num > 0) ? error / num : 0;
+    }
+}
+
+BENCHMARK(BM_fatwater_separation)->Args({ 128, 1 })->Args({ 256, 64 })->Unit(benchmark::kMillisecond)->Iterations(1)->UseRealTime();
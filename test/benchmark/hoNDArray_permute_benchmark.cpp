@@ -0,0 +1,95 @@
+/** \file       hoNDArray_permute_benchmark.cpp
+    \brief      The permutations used by the mri_core toolboxes and gadgets, tiled permute against the index mapping loop
+
+    The buffer is complex float [RO E1 E2 CHA] = [128 128 32 8]:
+        0: [E1 E2 CHA RO], spirit kernel to image domain
+        1: [RO E1 CHA E2], KLT along a dimension and the 2D+T wavelet
+        2: [E1 RO E2 CHA], transpose of the images
+        3: [CHA RO E1 E2], channels first for the coil combination
+*/
+
+#include "hoNDArray_utils.h"
+#include <benchmark/benchmark.h>
+#include <complex>
+
+using namespace Gadgetron;
+
+namespace
+{
+    const size_t RO = 128, E1 = 128, E2 = 32, CHA = 8;
+
+    typedef std::complex<float> T;
+
+    std::vector<size_t> permute_order(int p)
+    {
+        const size_t orders[4][4] = { { 1, 2, 3, 0 }, { 0, 1, 3, 2 }, { 1, 0, 2, 3 }, { 3, 0, 1, 2 } };
+        return std::vector<size_t>(orders[p], orders[p] + 4);
+    }
+
+    void prepare(int p, hoNDArray<T>& in, hoNDArray<T>& out, std::vector<size_t>& order)
+    {
+        in.create(RO, E1, E2, CHA);
+        for (size_t n = 0; n < in.get_number_of_elements(); n++) in(n) = T((float)n, 0);
+
+        order = permute_order(p);
+        std::vector<size_t> dims(4);
+        for (size_t i = 0; i < 4; i++) dims[i] = in.get_size(order[i]);
+        out.create(dims);
+    }
+
+    /// the element by element loop permute used before the tiled one
+    void BM_Permute_index_loop(benchmark::State& state)
+    {
+        hoNDArray<T> in, out;
+        std::vector<size_t> order;
+        prepare((int)state.range(0), in, out, order);
+
+        for (auto _ : state)
+        {
+            ArrayIterator it(in.get_dimensions().get(), &order);
+            T* o = out.begin();
+            for (size_t i = 0; i < in.get_number_of_elements(); i++)
+            {
+                o[i] = in.begin()[it.get_current_idx()];
+                it.advance();
+            }
+            benchmark::DoNotOptimize(o);
+        }
+
+        state.SetBytesProcessed(state.iterations() * in.get_number_of_bytes());
+    }
+
+    void BM_Permute_tiled(benchmark::State& state)
+    {
+        hoNDArray<T> in, out;
+        std::vector<size_t> order;
+        prepare((int)state.range(0), in, out, order);
+
+        for (auto _ : state)
+        {
+            Gadgetron::permute(&in, &out, &order);
+            benchmark::DoNotOptimize(out.begin());
+        }
+
+        state.SetBytesProcessed(state.iterations() * in.get_number_of_bytes());
+    }
+
+    void BM_Permute_in_place_transpose(benchmark::State& state)
+    {
+        hoNDArray<T> in, out;
+        std::vector<size_t> order;
+        prepare(2, in, out, order);
+
+        for (auto _ : state)
+        {
+            Gadgetron::permute(&in, &in, &order);
+            benchmark::DoNotOptimize(in.begin());
+        }
+
+        state.SetBytesProcessed(state.iterations() * in.get_number_of_bytes());
+    }
+}
+
+BENCHMARK(BM_Permute_index_loop)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Permute_tiled)->DenseRange(0, 3)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_Permute_in_place_transpose)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,62 @@
+/** \file       hoNDBSpline_benchmark.cpp
+    \brief      Benchmark of the BSpline coefficient computation, as used by the BSpline interpolator of the image registration
+*/
+
+#include "hoNDBSpline.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace
+{
+    template <typename T>
+    void make_volume(size_t sx, size_t sy, size_t sz, hoNDArray<T>& x)
+    {
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+        x.create(sx, sy, sz);
+        for (size_t n = 0; n < x.get_number_of_elements(); n++) x(n) = (T)dis(gen);
+    }
+
+    /// range(0): BSpline degree
+    template <typename T>
+    void BM_hoNDBSpline_coefficients_3D(benchmark::State& state)
+    {
+        hoNDArray<T> x, coeff;
+        make_volume(192, 160, 96, x);
+
+        hoNDBSpline<T, 3> bspline;
+        for (auto _ : state)
+        {
+            bspline.computeBSplineCoefficients(x, (unsigned int)state.range(0), coeff);
+            benchmark::DoNotOptimize(coeff.begin());
+        }
+
+        state.SetItemsProcessed(state.iterations() * x.get_number_of_elements());
+    }
+
+    /// range(0): BSpline degree
+    template <typename T>
+    void BM_hoNDBSpline_coefficients_2D(benchmark::State& state)
+    {
+        hoNDArray<T> x, coeff;
+        make_volume(512, 512, 1, x);
+        x.squeeze();
+
+        hoNDBSpline<T, 2> bspline;
+        for (auto _ : state)
+        {
+            bspline.computeBSplineCoefficients(x, (unsigned int)state.range(0), coeff);
+            benchmark::DoNotOptimize(coeff.begin());
+        }
+
+        state.SetItemsProcessed(state.iterations() * x.get_number_of_elements());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_hoNDBSpline_coefficients_3D, float)->Arg(3)->Arg(5)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_hoNDBSpline_coefficients_3D, double)->Arg(3)->Arg(5)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_hoNDBSpline_coefficients_2D, float)->Arg(3)->Arg(5)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_hoNDBSpline_coefficients_2D, double)->Arg(3)->Arg(5)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,104 @@
+/** \file       hoNDChunkedArray_benchmark.cpp
+    \brief      Slab by slab coil combination of a 3D buffer in memory and in a memory mapped chunked array
+
+    The buffer is [RO E1 E2 CHA N] = [128 128 64 8 4], 268 MB; a slab is one N.
+    The chunked array is processed with and without prefetching the next slab.
+*/
+
+#include "hoNDChunkedArray.h"
+#include <benchmark/benchmark.h>
+#include <boost/filesystem.hpp>
+#include <complex>
+
+using namespace Gadgetron;
+
+namespace
+{
+    const size_t RO = 128, E1 = 128, E2 = 64, CHA = 8, N = 4;
+
+    typedef std::complex<float> T;
+
+    /// root sum of squares over the channels of a slab
+    void coil_combine(const hoNDArray<T>& slab, hoNDArray<float>& res)
+    {
+        size_t V = RO*E1*E2;
+        const T* pSlab = slab.begin();
+        float* pRes = res.begin();
+
+        for (size_t v = 0; v < V; v++) pRes[v] = 0;
+        for (size_t cha = 0; cha < CHA; cha++)
+        {
+            const T* p = pSlab + cha*V;
+            for (size_t v = 0; v < V; v++) pRes[v] += std::norm(p[v]);
+        }
+        for (size_t v = 0; v < V; v++) pRes[v] = std::sqrt(pRes[v]);
+    }
+
+    std::vector<size_t> buffer_dimensions()
+    {
+        std::vector<size_t> dims(5);
+        dims[0] = RO; dims[1] = E1; dims[2] = E2; dims[3] = CHA; dims[4] = N;
+        return dims;
+    }
+
+    void BM_CoilCombine_in_memory(benchmark::State& state)
+    {
+        hoNDArray<T> data(RO, E1, E2, CHA, N);
+        for (size_t n = 0; n < data.get_number_of_elements(); n++) data(n) = T(1, (float)(n % 7));
+
+        hoNDArray<float> res(RO, E1, E2);
+        std::vector<size_t> slab_dims = buffer_dimensions();
+        slab_dims.resize(4);
+
+        for (auto _ : state)
+        {
+            for (size_t n = 0; n < N; n++)
+            {
+                hoNDArray<T> slab(slab_dims, data.begin() + n*RO*E1*E2*CHA, false);
+                coil_combine(slab, res);
+                benchmark::DoNotOptimize(res.begin());
+            }
+        }
+
+        state.SetBytesProcessed(state.iterations() * data.get_number_of_bytes());
+    }
+
+    void BM_CoilCombine_chunked(benchmark::State& state)
+    {
+        bool prefetch = state.range(0) != 0;
+
+        std::vector<size_t> dims = buffer_dimensions();
+        std::vector<size_t> chunk_dims = dims;
+        chunk_dims[4] = 1;
+
+        std::string filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("hoNDChunkedArray_benchmark_%%%%-%%%%.bin")).string();
+        hoNDChunkedArray<T> data(dims, chunk_dims, filename);
+
+        hoNDArray<T> slab;
+        for (size_t c = 0; c < data.get_number_of_chunks(); c++)
+        {
+            data.get_chunk(c, slab);
+            for (size_t n = 0; n < slab.get_number_of_elements(); n++) slab(n) = T(1, (float)(n % 7));
+            data.release(c);
+        }
+
+        hoNDArray<float> res(RO, E1, E2);
+
+        for (auto _ : state)
+        {
+            for (size_t c = 0; c < data.get_number_of_chunks(); c++)
+            {
+                if (prefetch && c + 1 < data.get_number_of_chunks()) data.prefetch(c + 1);
+                data.get_chunk(c, slab);
+                coil_combine(slab, res);
+                benchmark::DoNotOptimize(res.begin());
+                data.release(c);
+            }
+        }
+
+        state.SetBytesProcessed(state.iterations() * data.get_number_of_elements() * sizeof(T));
+    }
+}
+
+BENCHMARK(BM_CoilCombine_in_memory)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CoilCombine_chunked)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,91 @@
+/** \file       hoNDFFT_benchmark.cpp
+    \brief      Centered 2D and 3D fft, the checkerboard modulated transform against the explicit shifts
+
+    2D: [RO E1 CHA] = [256 256 32], e.g. the unmixing of a GRAPPA slice
+    3D: [RO E1 E2 CHA] = [192 128 64 8], e.g. the SPIRIT 3D kernel to image domain
+*/
+
+#include "hoNDFFT.h"
+#include <benchmark/benchmark.h>
+#include <complex>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef std::complex<float> T;
+
+    void fill(hoNDArray<T>& x)
+    {
+        for (size_t n = 0; n < x.get_number_of_elements(); n++) x(n) = T((float)(n % 13), (float)(n % 7));
+    }
+
+    void BM_fft2c_shift(benchmark::State& state)
+    {
+        hoNDArray<T> x(256, 256, 32);
+        fill(x);
+
+        hoNDFFT<float>* fft = hoNDFFT<float>::instance();
+        for (auto _ : state)
+        {
+            fft->ifftshift2D(x);
+            fft->fft2(x);
+            fft->fftshift2D(x);
+            benchmark::DoNotOptimize(x.begin());
+        }
+
+        state.SetBytesProcessed(state.iterations() * x.get_number_of_bytes());
+    }
+
+    void BM_fft2c_checkerboard(benchmark::State& state)
+    {
+        hoNDArray<T> x(256, 256, 32);
+        fill(x);
+
+        hoNDFFT<float>* fft = hoNDFFT<float>::instance();
+        for (auto _ : state)
+        {
+            fft->fft2c(x);
+            benchmark::DoNotOptimize(x.begin());
+        }
+
+        state.SetBytesProcessed(state.iterations() * x.get_number_of_bytes());
+    }
+
+    void BM_fft3c_shift(benchmark::State& state)
+    {
+        hoNDArray<T> x(192, 128, 64, 8);
+        fill(x);
+
+        hoNDFFT<float>* fft = hoNDFFT<float>::instance();
+        for (auto _ : state)
+        {
+            fft->ifftshift3D(x);
+            fft->fft3(x);
+            fft->fftshift3D(x);
+            benchmark::DoNotOptimize(x.begin());
+        }
+
+        state.SetBytesProcessed(state.iterations() * x.get_number_of_bytes());
+    }
+
+    void BM_fft3c_checkerboard(benchmark::State& state)
+    {
+        hoNDArray<T> x(192, 128, 64, 8);
+        fill(x);
+
+        hoNDFFT<float>* fft = hoNDFFT<float>::instance();
+        for (auto _ : state)
+        {
+            fft->fft3c(x);
+            benchmark::DoNotOptimize(x.begin());
+        }
+
+        state.SetBytesProcessed(state.iterations() * x.get_number_of_bytes());
+    }
+}
+
+BENCHMARK(BM_fft2c_shift)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_fft2c_checkerboard)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_fft3c_shift)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_fft3c_checkerboard)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,130 @@
+/** \file       hoNDInterpolator_benchmark.cpp
+    \brief      Benchmark of the point-wise and batched interpolation, sampled at a smoothly deformed grid as in the image warping
+*/
+
+#include "hoNDInterpolator.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef hoNDArray<float> ArrayType;
+
+    /// image and the deformed sampling grid, range(0) is the number of dimensions
+    void make_data(benchmark::State& state, ArrayType& im, std::vector<float>& x, std::vector<float>& y, std::vector<float>& z)
+    {
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+        size_t sx = 256, sy = 256, sz = 1;
+        if (state.range(0) == 3) { sx = 128; sy = 128; sz = 32; }
+
+        im.create(sx, sy, sz);
+        if (state.range(0) == 2) im.squeeze();
+        for (size_t n = 0; n < im.get_number_of_elements(); n++) im(n) = dis(gen);
+
+        size_t N = sx*sy*sz;
+        x.resize(N); y.resize(N); z.resize(N);
+
+        size_t n = 0;
+        for (size_t k = 0; k < sz; k++)
+        {
+            for (size_t j = 0; j < sy; j++)
+            {
+                for (size_t i = 0; i < sx; i++)
+                {
+                    x[n] = i + 2.5f * std::sin(0.05f*j);
+                    y[n] = j + 2.5f * std::cos(0.05f*i);
+                    z[n] = k + 0.5f * std::sin(0.1f*i);
+                    n++;
+                }
+            }
+        }
+    }
+
+    /// range(1): 0 for linear, 1 for 5th order BSpline
+    hoNDInterpolator<ArrayType>* make_interpolator(benchmark::State& state, ArrayType& im, hoNDBoundaryHandler<ArrayType>& bh)
+    {
+        hoNDInterpolator<ArrayType>* interp;
+        if (state.range(1) == 0)
+        {
+            interp = new hoNDInterpolatorLinear<ArrayType>(im, bh);
+            state.SetLabel(state.range(0) == 2 ? "linear 2D" : "linear 3D");
+        }
+        else if (state.range(0) == 2)
+        {
+            interp = new hoNDInterpolatorBSpline<ArrayType, 2>(im, bh, 5);
+            state.SetLabel("bspline 2D");
+        }
+        else
+        {
+            interp = new hoNDInterpolatorBSpline<ArrayType, 3>(im, bh, 5);
+            state.SetLabel("bspline 3D");
+        }
+
+        return interp;
+    }
+
+    void BM_hoNDInterpolator_pointwise(benchmark::State& state)
+    {
+        ArrayType im, res;
+        std::vector<float> x, y, z;
+        make_data(state, im, x, y, z);
+        res.create(x.size());
+
+        hoNDBoundaryHandlerBorderValue<ArrayType> bh(im);
+        hoNDInterpolator<ArrayType>* interp = make_interpolator(state, im, bh);
+
+        size_t n, N = x.size();
+        for (auto _ : state)
+        {
+            if (state.range(0) == 2)
+            {
+                for (n = 0; n < N; n++) res(n) = (*interp)(x[n], y[n]);
+            }
+            else
+            {
+                for (n = 0; n < N; n++) res(n) = (*interp)(x[n], y[n], z[n]);
+            }
+
+            benchmark::DoNotOptimize(res.begin());
+        }
+
+        state.SetItemsProcessed(state.iterations() * N);
+        delete interp;
+    }
+
+    void BM_hoNDInterpolator_batched(benchmark::State& state)
+    {
+        ArrayType im, res;
+        std::vector<float> x, y, z;
+        make_data(state, im, x, y, z);
+        res.create(x.size());
+
+        hoNDBoundaryHandlerBorderValue<ArrayType> bh(im);
+        hoNDInterpolator<ArrayType>* interp = make_interpolator(state, im, bh);
+
+        size_t N = x.size();
+        for (auto _ : state)
+        {
+            if (state.range(0) == 2)
+            {
+                interp->interpolate(N, &x[0], &y[0], res.begin());
+            }
+            else
+            {
+                interp->interpolate(N, &x[0], &y[0], &z[0], res.begin());
+            }
+
+            benchmark::DoNotOptimize(res.begin());
+        }
+
+        state.SetItemsProcessed(state.iterations() * N);
+        delete interp;
+    }
+}
+
+BENCHMARK(BM_hoNDInterpolator_pointwise)->Args({ 2, 0 })->Args({ 2, 1 })->Args({ 3, 0 })->Args({ 3, 1 })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_hoNDInterpolator_batched)->Args({ 2, 0 })->Args({ 2, 1 })->Args({ 3, 0 })->Args({ 3, 1 })->Unit(benchmark::kMillisecond);
@@ -0,0 +1,62 @@
+/** \file       hoNDKLT_benchmark.cpp
+    \brief      Benchmark of the coil compression with hoNDKLT, 128 channels are compressed to 16 virtual channels
+*/
+
+#include "hoNDArray_elemwise.h"
+#include "hoNDKLT.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace
+{
+    /// [RO E1 CHA] calibration data, every channel is a mixture of num_sources sources plus noise
+    void make_coil_data(size_t RO, size_t E1, size_t CHA, size_t num_sources, hoNDArray< std::complex<float> >& data)
+    {
+        std::mt19937 gen(1234);
+        std::normal_distribution<float> dis(0.0f, 1.0f);
+
+        hoNDArray< std::complex<float> > src(RO*E1, num_sources), mix(num_sources, CHA);
+
+        size_t n;
+        for (n = 0; n < src.get_number_of_elements(); n++) src(n) = std::complex<float>(dis(gen), dis(gen));
+        for (n = 0; n < mix.get_number_of_elements(); n++) mix(n) = std::complex<float>(dis(gen), dis(gen)) / (float)(1 + n%num_sources);
+
+        data.create(RO, E1, CHA);
+
+        size_t p, s, cha;
+        for (cha = 0; cha < CHA; cha++)
+        {
+            for (p = 0; p < RO*E1; p++)
+            {
+                std::complex<float> v(0.01f*dis(gen), 0.01f*dis(gen));
+                for (s = 0; s < num_sources; s++) v += src(p, s) * mix(s, cha);
+                data(p + cha*RO*E1) = v;
+            }
+        }
+    }
+
+    void BM_hoNDKLT_coil_compression(benchmark::State& state)
+    {
+        size_t RO = 192, E1 = 48, CHA = 128, dstCHA = 16;
+
+        hoNDArray< std::complex<float> > data;
+        make_coil_data(RO, E1, CHA, 32, data);
+
+        hoNDArray< std::complex<float> > res;
+
+        for (auto _ : state)
+        {
+            hoNDKLT< std::complex<float> > klt;
+            klt.method((KLTMethod)state.range(0));
+            klt.prepare(data, 2, dstCHA);
+            klt.transform(data, res, 2);
+            benchmark::DoNotOptimize(res.begin());
+        }
+
+        state.SetLabel(state.range(0) == KLT_SVD ? "svd" : (state.range(0) == KLT_COVARIANCE ? "covariance" : "truncated"));
+    }
+}
+
+BENCHMARK(BM_hoNDKLT_coil_compression)->Arg(KLT_SVD)->Arg(KLT_COVARIANCE)->Arg(KLT_TRUNCATED)->Unit(benchmark::kMillisecond);
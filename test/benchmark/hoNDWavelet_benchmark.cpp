@@ -0,0 +1,129 @@
+/** \file       hoNDWavelet_benchmark.cpp
+    \brief      Benchmark of the redundant harr and db wavelets, as used by the L1-SPIRIT 2D+T regularization
+*/
+
+#include "hoNDHarrWavelet.h"
+#include "hoNDRedundantWavelet.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef std::complex<float> T;
+
+    /// [RO E1 E2] image series
+    void make_image(size_t RO, size_t E1, size_t E2, hoNDArray<T>& x)
+    {
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<float> dis(-1.0f, 1.0f);
+
+        x.create(RO, E1, E2);
+        for (size_t n = 0; n < x.get_number_of_elements(); n++) x(n) = T(dis(gen), dis(gen));
+    }
+
+    /// range(0): 0 for harr, 1 for db2; range(1): number of levels
+    void select_wavelet(benchmark::State& state, hoNDHarrWavelet<T>& harr, hoNDRedundantWavelet<T>& db, hoNDWavelet<T>*& wav)
+    {
+        db.compute_wavelet_filter("db2");
+        wav = (state.range(0) == 0) ? (hoNDWavelet<T>*)&harr : (hoNDWavelet<T>*)&db;
+        state.SetLabel(state.range(0) == 0 ? "harr" : "db2");
+    }
+
+    void BM_hoNDWavelet_forward_3D(benchmark::State& state)
+    {
+        hoNDHarrWavelet<T> harr;
+        hoNDRedundantWavelet<T> db;
+        hoNDWavelet<T>* wav;
+        select_wavelet(state, harr, db, wav);
+
+        hoNDArray<T> x, c;
+        make_image(192, 144, 24, x);
+
+        for (auto _ : state)
+        {
+            wav->transform(x, c, 3, state.range(1), true);
+            benchmark::DoNotOptimize(c.begin());
+        }
+    }
+
+    void BM_hoNDWavelet_inverse_3D(benchmark::State& state)
+    {
+        hoNDHarrWavelet<T> harr;
+        hoNDRedundantWavelet<T> db;
+        hoNDWavelet<T>* wav;
+        select_wavelet(state, harr, db, wav);
+
+        hoNDArray<T> x, c, y;
+        make_image(192, 144, 24, x);
+        wav->transform(x, c, 3, state.range(1), true);
+
+        for (auto _ : state)
+        {
+            wav->transform(c, y, 3, state.range(1), false);
+            benchmark::DoNotOptimize(y.begin());
+        }
+    }
+
+    void BM_hoNDWavelet_forward_2D(benchmark::State& state)
+    {
+        hoNDHarrWavelet<T> harr;
+        hoNDRedundantWavelet<T> db;
+        hoNDWavelet<T>* wav;
+        select_wavelet(state, harr, db, wav);
+
+        hoNDArray<T> x, c;
+        make_image(256, 256, 16, x);
+
+        for (auto _ : state)
+        {
+            wav->transform(x, c, 2, state.range(1), true);
+            benchmark::DoNotOptimize(c.begin());
+        }
+    }
+
+    /// forward transform, soft thresholding of the whole coefficient array, inverse transform
+    void BM_hoNDWavelet_shrink_2D(benchmark::State& state)
+    {
+        hoNDHarrWavelet<T> harr;
+        hoNDRedundantWavelet<T> db;
+        hoNDWavelet<T>* wav;
+        select_wavelet(state, harr, db, wav);
+
+        hoNDArray<T> x, c, y;
+        make_image(256, 256, 32, x);
+
+        for (auto _ : state)
+        {
+            wav->transform(x, c, 2, state.range(1), true);
+            wav->shrink(c, 2, state.range(1), 0.1f);
+            wav->transform(c, y, 2, state.range(1), false);
+            benchmark::DoNotOptimize(y.begin());
+        }
+    }
+
+    /// the same as BM_hoNDWavelet_shrink_2D, fused per image
+    void BM_hoNDWavelet_proximity_2D(benchmark::State& state)
+    {
+        hoNDHarrWavelet<T> harr;
+        hoNDRedundantWavelet<T> db;
+        hoNDWavelet<T>* wav;
+        select_wavelet(state, harr, db, wav);
+
+        hoNDArray<T> x, y;
+        make_image(256, 256, 32, x);
+
+        for (auto _ : state)
+        {
+            wav->proximity(x, y, 2, state.range(1), 0.1f);
+            benchmark::DoNotOptimize(y.begin());
+        }
+    }
+}
+
+BENCHMARK(BM_hoNDWavelet_forward_3D)->Args({ 0, 1 })->Args({ 0, 3 })->Args({ 1, 1 })->Args({ 1, 3 })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_hoNDWavelet_inverse_3D)->Args({ 0, 1 })->Args({ 0, 3 })->Args({ 1, 1 })->Args({ 1, 3 })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_hoNDWavelet_forward_2D)->Args({ 0, 1 })->Args({ 0, 3 })->Args({ 1, 1 })->Args({ 1, 3 })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_hoNDWavelet_shrink_2D)->Args({ 0, 1 })->Args({ 1, 1 })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_hoNDWavelet_proximity_2D)->Args({ 0, 1 })->Args({ 1, 1 })->Unit(benchmark::kMillisecond);
@@ -0,0 +1,53 @@
+/** \file       hoRandNormGenerator_benchmark.cpp
+    \brief      Adding complex white noise to a pseudo replica, the sequential std::normal_distribution against the counter based generator
+
+    The data is a 2D buffer of 256 readout, 192 phase encoding and 32 channels.
+*/
+
+#include "hoRandNormGenerator.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+using namespace Gadgetron;
+
+namespace
+{
+    const size_t RO = 256, E1 = 192, CHA = 32;
+
+    void BM_PseudoReplica_std_normal(benchmark::State& state)
+    {
+        hoNDArray< std::complex<float> > data(RO, E1, CHA);
+        std::mt19937 engine;
+        std::normal_distribution<float> distribution;
+
+        for (auto _ : state)
+        {
+            std::complex<float>* dataptr = data.get_data_ptr();
+            for (size_t k = 0; k < data.get_number_of_elements(); k++)
+            {
+                dataptr[k] += std::complex<float>(distribution(engine), distribution(engine));
+            }
+            benchmark::DoNotOptimize(dataptr);
+        }
+
+        state.SetItemsProcessed(state.iterations() * data.get_number_of_elements());
+    }
+
+    void BM_PseudoReplica_philox(benchmark::State& state)
+    {
+        hoNDArray< std::complex<float> > data(RO, E1, CHA);
+        RandNormGenerator<float> randn(1234);
+
+        unsigned long long stream = 0;
+        for (auto _ : state)
+        {
+            randn.add(data.get_data_ptr(), data.get_number_of_elements(), stream++);
+            benchmark::DoNotOptimize(data.get_data_ptr());
+        }
+
+        state.SetItemsProcessed(state.iterations() * data.get_number_of_elements());
+    }
+}
+
+BENCHMARK(BM_PseudoReplica_std_normal)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PseudoReplica_philox)->Unit(benchmark::kMillisecond)->UseRealTime();
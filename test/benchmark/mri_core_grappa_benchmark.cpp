@@ -0,0 +1,148 @@
+/** \file       mri_core_grappa_benchmark.cpp
+    \brief      GRAPPA calibration, image domain kernel and unmixing coefficients, 2D and 3D
+
+    2D: [RO E1 CHA] = [256 256 CHA], 32 ACS lines, R=4, CHA = 16, 32, 64
+    3D: [RO E1 E2 CHA] = [128 128 64 16], 24x24 ACS, R=2x2
+
+    The kernel sizes and regularization are the defaults of GenericReconCartesianGrappaGadget.
+*/
+
+#include "mri_core_grappa.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <complex>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef std::complex<float> T;
+
+    const double thres = 0.0005;
+    const double over_determine_ratio = 45;
+    const size_t kRO = 5;
+    const size_t kNE1 = 4;
+    const size_t kNE2 = 4;
+
+    void fill(hoNDArray<T>& x, unsigned int seed)
+    {
+        for (size_t n = 0; n < x.get_number_of_elements(); n++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            float re = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+            seed = seed * 1103515245u + 12345u;
+            float im = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+            x(n) = T(re, im);
+        }
+    }
+
+    struct Grappa2D
+    {
+        Grappa2D(size_t CHA) : acs(256, 32, CHA), coil_map(256, 256, CHA)
+        {
+            fill(acs, 1);
+            fill(coil_map, 2);
+            grappa2d_calib_convolution_kernel(acs, acs, 4, thres, kRO, kNE1, conv_ker);
+            grappa2d_image_domain_kernel(conv_ker, 256, 256, kIm);
+        }
+
+        hoNDArray<T> acs;
+        hoNDArray<T> coil_map;
+        hoNDArray<T> conv_ker;
+        hoNDArray<T> kIm;
+    };
+
+    Grappa2D& data_2d(size_t CHA)
+    {
+        static Grappa2D d16(16), d32(32), d64(64);
+        return (CHA == 16) ? d16 : ((CHA == 32) ? d32 : d64);
+    }
+
+    void BM_grappa2d_calib_convolution_kernel(benchmark::State& state)
+    {
+        Grappa2D& d = data_2d(state.range(0));
+        hoNDArray<T> conv_ker;
+
+        for (auto _ : state)
+        {
+            grappa2d_calib_convolution_kernel(d.acs, d.acs, 4, thres, kRO, kNE1, conv_ker);
+            benchmark::DoNotOptimize(conv_ker.begin());
+        }
+    }
+
+    void BM_grappa2d_image_domain_kernel(benchmark::State& state)
+    {
+        Grappa2D& d = data_2d(state.range(0));
+        hoNDArray<T> kIm;
+
+        for (auto _ : state)
+        {
+            grappa2d_image_domain_kernel(d.conv_ker, 256, 256, kIm);
+            benchmark::DoNotOptimize(kIm.begin());
+        }
+    }
+
+    void BM_grappa2d_unmixing_coeff(benchmark::State& state)
+    {
+        Grappa2D& d = data_2d(state.range(0));
+        hoNDArray<T> unmixing(256, 256, d.acs.get_size(2));
+        hoNDArray<float> gFactor;
+
+        for (auto _ : state)
+        {
+            grappa2d_unmixing_coeff(d.kIm, d.coil_map, 4, unmixing, gFactor);
+            benchmark::DoNotOptimize(unmixing.begin());
+        }
+    }
+
+    struct Grappa3D
+    {
+        Grappa3D() : acs(128, 24, 24, 16), coil_map(128, 128, 64, 16)
+        {
+            fill(acs, 3);
+            fill(coil_map, 4);
+            grappa3d_calib_convolution_kernel(acs, acs, 2, 2, thres, over_determine_ratio, kRO, kNE1, kNE2, conv_ker);
+        }
+
+        hoNDArray<T> acs;
+        hoNDArray<T> coil_map;
+        hoNDArray<T> conv_ker;
+    };
+
+    Grappa3D& data_3d()
+    {
+        static Grappa3D d;
+        return d;
+    }
+
+    void BM_grappa3d_calib_convolution_kernel(benchmark::State& state)
+    {
+        Grappa3D& d = data_3d();
+        hoNDArray<T> conv_ker;
+
+        for (auto _ : state)
+        {
+            grappa3d_calib_convolution_kernel(d.acs, d.acs, 2, 2, thres, over_determine_ratio, kRO, kNE1, kNE2, conv_ker);
+            benchmark::DoNotOptimize(conv_ker.begin());
+        }
+    }
+
+    void BM_grappa3d_unmixing_coeff(benchmark::State& state)
+    {
+        Grappa3D& d = data_3d();
+        hoNDArray<T> unmixing(128, 128, 64, 16);
+        hoNDArray<float> gFactor(128, 128, 64, 1);
+
+        for (auto _ : state)
+        {
+            grappa3d_unmixing_coeff(d.conv_ker, d.coil_map, 2, 2, unmixing, gFactor);
+            benchmark::DoNotOptimize(unmixing.begin());
+        }
+    }
+}
+
+BENCHMARK(BM_grappa2d_calib_convolution_kernel)->Arg(16)->Arg(32)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_grappa2d_image_domain_kernel)->Arg(16)->Arg(32)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_grappa2d_unmixing_coeff)->Arg(16)->Arg(32)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_grappa3d_calib_convolution_kernel)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_grappa3d_unmixing_coeff)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,131 @@
+/** \file       mri_core_spirit_benchmark.cpp
+    \brief      SPIRIT calibration, image domain kernel and the 2D SPIRIT operator
+
+    2D: [RO E1 CHA] = [256 256 CHA], 32 ACS lines, 5x5 kernel, CHA = 16, 32
+    3D: [RO E1 E2 CHA] = [128 24 24 16] ACS, 5x5x5 kernel
+
+    The operator cases are one evaluation of the SPIRIT term and of its gradient,
+    i.e. one iteration of the linear solver in GenericReconCartesianSpiritGadget.
+*/
+
+#include "mri_core_spirit.h"
+#include "hoSPIRIT2DOperator.h"
+#include <benchmark/benchmark.h>
+#include <complex>
+
+using namespace Gadgetron;
+
+namespace
+{
+    typedef std::complex<float> T;
+
+    const double thres = 0.005;
+    const double over_determine_ratio = 45;
+    const size_t kRO = 5;
+    const size_t kE1 = 5;
+    const size_t kE2 = 5;
+
+    void fill(hoNDArray<T>& x, unsigned int seed)
+    {
+        for (size_t n = 0; n < x.get_number_of_elements(); n++)
+        {
+            seed = seed * 1103515245u + 12345u;
+            float re = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+            seed = seed * 1103515245u + 12345u;
+            float im = (float)((seed >> 8) & 0xFFFF) / 65536 - 0.5f;
+            x(n) = T(re, im);
+        }
+    }
+
+    struct Spirit2D
+    {
+        Spirit2D(size_t CHA) : acs(256, 32, CHA), kspace(256, 256, CHA)
+        {
+            fill(acs, 1);
+            fill(kspace, 2);
+
+            // R=2, every other line acquired
+            for (size_t c = 0; c < CHA; c++)
+                for (size_t e1 = 1; e1 < 256; e1 += 2)
+                    for (size_t ro = 0; ro < 256; ro++) kspace(ro, e1, c) = 0;
+
+            spirit2d_calib_convolution_kernel(acs, acs, thres, kRO, kE1, 1, 1, conv_ker, true);
+            spirit2d_image_domain_kernel(conv_ker, 256, 256, kIm);
+        }
+
+        hoNDArray<T> acs;
+        hoNDArray<T> kspace;
+        hoNDArray<T> conv_ker;
+        hoNDArray<T> kIm;
+    };
+
+    Spirit2D& data_2d(size_t CHA)
+    {
+        static Spirit2D d16(16), d32(32);
+        return (CHA == 16) ? d16 : d32;
+    }
+
+    void BM_spirit2d_calib_convolution_kernel(benchmark::State& state)
+    {
+        Spirit2D& d = data_2d(state.range(0));
+        hoNDArray<T> conv_ker;
+
+        for (auto _ : state)
+        {
+            spirit2d_calib_convolution_kernel(d.acs, d.acs, thres, kRO, kE1, 1, 1, conv_ker, true);
+            benchmark::DoNotOptimize(conv_ker.begin());
+        }
+    }
+
+    void BM_spirit2d_image_domain_kernel(benchmark::State& state)
+    {
+        Spirit2D& d = data_2d(state.range(0));
+        hoNDArray<T> kIm;
+
+        for (auto _ : state)
+        {
+            spirit2d_image_domain_kernel(d.conv_ker, 256, 256, kIm);
+            benchmark::DoNotOptimize(kIm.begin());
+        }
+    }
+
+    void BM_spirit2d_operator(benchmark::State& state)
+    {
+        Spirit2D& d = data_2d(state.range(0));
+
+        std::vector<size_t> dim;
+        d.kspace.get_dimensions(dim);
+
+        hoSPIRIT2DOperator<T> spirit(&dim);
+        spirit.use_non_centered_fft_ = true;
+        spirit.no_null_space_ = false;
+        spirit.set_forward_kernel(d.kIm, false);
+        spirit.set_acquired_points(d.kspace);
+
+        hoNDArray<T> x(d.kspace), y(d.kspace), g(d.kspace);
+
+        for (auto _ : state)
+        {
+            spirit.mult_M(&x, &y);
+            spirit.gradient(&x, &g);
+            benchmark::DoNotOptimize(g.begin());
+        }
+    }
+
+    void BM_spirit3d_calib_convolution_kernel(benchmark::State& state)
+    {
+        hoNDArray<T> acs(128, 24, 24, 16), conv_ker;
+        fill(acs, 3);
+
+        for (auto _ : state)
+        {
+            spirit3d_calib_convolution_kernel(acs, acs, thres, over_determine_ratio, kRO, kE1, kE2, 1, 1, 1, conv_ker, true);
+            benchmark::DoNotOptimize(conv_ker.begin());
+        }
+    }
+}
+
+BENCHMARK(BM_spirit2d_calib_convolution_kernel)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_spirit2d_image_domain_kernel)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_spirit2d_operator)->Arg(16)->Arg(32)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_spirit3d_calib_convolution_kernel)->Unit(benchmark::kMillisecond);
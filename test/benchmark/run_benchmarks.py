@@ -0,0 +1,196 @@
+"""Runs benchmark_all, stores a JSON baseline and compares a run against it.
+
+    run_benchmarks.py baseline -b benchmark_all -o baseline.json
+    run_benchmarks.py compare -b benchmark_all baseline.json
+    run_benchmarks.py compare baseline.json --current current.json
+
+Every benchmark is repeated (--repetitions), the repetitions of the baseline and of the current run
+are compared with a two sided Mann-Whitney U test; at least 8 repetitions are needed to reach p < 0.01.
+A benchmark is a regression if the difference is significant (p < --alpha) and the median time is
+slower by more than --threshold. compare returns 1 if there is a regression.
+
+The baseline is only meaningful on the machine where it was recorded.
+"""
+
+from __future__ import print_function
+
+import json
+import math
+import os
+import subprocess
+import sys
+
+AGGREGATES = ('_mean', '_median', '_stddev', '_cv')
+
+
+def run_benchmark(benchmark, repetitions, benchmark_filter, out_file):
+    cmd = [benchmark,
+           '--benchmark_repetitions=%d' % repetitions,
+           '--benchmark_out=%s' % out_file,
+           '--benchmark_out_format=json']
+    if benchmark_filter:
+        cmd.append('--benchmark_filter=%s' % benchmark_filter)
+
+    print("Running " + " ".join(cmd))
+    subprocess.check_call(cmd)
+
+
+def load_times(json_file):
+    """ Real time of every repetition in ns, per benchmark name """
+    with open(json_file, 'r') as f:
+        report = json.load(f)
+
+    units = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+    times = {}
+    for b in report['benchmarks']:
+        if b.get('run_type', 'iteration') != 'iteration':
+            continue
+        name = b.get('run_name', b['name'])
+        if name.endswith(AGGREGATES):
+            continue
+        if 'error_occurred' in b and b['error_occurred']:
+            continue
+        t = b['real_time'] * units[b.get('time_unit', 'ns')]
+        times.setdefault(name, []).append(t)
+
+    return report.get('context', {}), times
+
+
+def median(x):
+    s = sorted(x)
+    n = len(s)
+    return s[n // 2] if n % 2 else 0.5 * (s[n // 2 - 1] + s[n // 2])
+
+
+def ms(t):
+    return "%.4gms" % (t * 1e-6)
+
+
+def mann_whitney_u(a, b):
+    """ Two sided p value of the Mann-Whitney U test, normal approximation with tie correction """
+    n1 = len(a)
+    n2 = len(b)
+    values = sorted([(v, 0) for v in a] + [(v, 1) for v in b])
+
+    # mid ranks of ties
+    ranks = [0.0] * len(values)
+    tie_term = 0.0
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        r = 0.5 * (i + j) + 1
+        for k in range(i, j + 1):
+            ranks[k] = r
+        t = j - i + 1
+        tie_term += t * t * t - t
+        i = j + 1
+
+    r1 = sum(ranks[k] for k in range(len(values)) if values[k][1] == 0)
+    u = r1 - n1 * (n1 + 1) / 2.0
+
+    n = n1 + n2
+    mu = n1 * n2 / 2.0
+    sigma2 = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if sigma2 <= 0:
+        return 1.0
+
+    z = (abs(u - mu) - 0.5) / math.sqrt(sigma2)
+    return min(1.0, math.erfc(max(z, 0.0) / math.sqrt(2)))
+
+
+def compare(baseline_file, current_file, alpha, threshold):
+    base_context, base = load_times(baseline_file)
+    cur_context, cur = load_times(current_file)
+
+    if base_context.get('host_name') and base_context.get('host_name') != cur_context.get('host_name'):
+        print("Warning: the baseline was recorded on %s, this run is on %s" % (base_context.get('host_name'), cur_context.get('host_name')))
+
+    regressions = []
+    print("%-60s %12s %12s %8s %10s" % ("Benchmark", "Baseline", "Current", "Change", "p"))
+    for name in sorted(cur.keys()):
+        if name not in base:
+            print("%-60s %12s %12s %8s %10s" % (name, "-", ms(median(cur[name])), "new", "-"))
+            continue
+
+        m0 = median(base[name])
+        m1 = median(cur[name])
+        change = m1 / m0 - 1.0 if m0 > 0 else 0.0
+
+        if len(base[name]) < 3 or len(cur[name]) < 3:
+            p = 1.0
+        else:
+            p = mann_whitney_u(base[name], cur[name])
+
+        flag = ""
+        if p < alpha and change > threshold:
+            flag = "  SLOWER"
+            regressions.append(name)
+        elif p < alpha and change < -threshold:
+            flag = "  faster"
+
+        print("%-60s %12s %12s %+7.1f%% %10.2g%s" % (name, ms(m0), ms(m1), 100 * change, p, flag))
+
+    for name in sorted(set(base.keys()) - set(cur.keys())):
+        print("%-60s %12s %12s %8s %10s" % (name, ms(median(base[name])), "-", "missing", "-"))
+
+    if regressions:
+        print("\n%d significant slowdown(s):" % len(regressions))
+        for name in regressions:
+            print("    " + name)
+        return 1
+
+    print("\nNo significant slowdown")
+    return 0
+
+
+def main():
+    import argparse
+
+    parser = argparse.ArgumentParser(description="Gadgetron benchmark baseline and regression check",
+                                     formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    sub = parser.add_subparsers(dest='mode')
+
+    p_base = sub.add_parser('baseline', help="Run the benchmarks and store the baseline")
+    p_base.add_argument('-b', '--benchmark', default='benchmark_all', help="Benchmark executable")
+    p_base.add_argument('-r', '--repetitions', type=int, default=10, help="Repetitions of every benchmark")
+    p_base.add_argument('-f', '--filter', default='', help="Regular expression of the benchmarks to run")
+    p_base.add_argument('-o', '--out', default='benchmark_baseline.json', help="Baseline file")
+
+    p_cmp = sub.add_parser('compare', help="Run the benchmarks and compare against the baseline")
+    p_cmp.add_argument('baseline', help="Baseline file")
+    p_cmp.add_argument('-b', '--benchmark', default='benchmark_all', help="Benchmark executable")
+    p_cmp.add_argument('-r', '--repetitions', type=int, default=10, help="Repetitions of every benchmark")
+    p_cmp.add_argument('-f', '--filter', default='', help="Regular expression of the benchmarks to run")
+    p_cmp.add_argument('-c', '--current', default='', help="Compare this result file instead of running the benchmarks")
+    p_cmp.add_argument('-o', '--out', default='benchmark_current.json', help="Result file of the current run")
+    p_cmp.add_argument('-a', '--alpha', type=float, default=0.01, help="Significance level")
+    p_cmp.add_argument('-t', '--threshold', type=float, default=0.05, help="Relative slowdown of the median which is reported")
+
+    args = parser.parse_args()
+
+    if args.mode == 'baseline':
+        run_benchmark(args.benchmark, args.repetitions, args.filter, args.out)
+        print("Baseline stored in " + os.path.abspath(args.out))
+        return 0
+
+    if args.mode == 'compare':
+        if not os.path.isfile(args.baseline):
+            print("Baseline " + args.baseline + " does not exist, run the baseline mode first")
+            return 2
+
+        current = args.current
+        if not current:
+            run_benchmark(args.benchmark, args.repetitions, args.filter, args.out)
+            current = args.out
+
+        return compare(args.baseline, current, args.alpha, args.threshold)
+
+    parser.print_help()
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
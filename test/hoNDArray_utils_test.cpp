@@ -4,6 +4,7 @@
 #include "GadgetronTimer.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <complex>
 #include <vector>
 
@@ -106,6 +107,57 @@ TYPED_TEST(hoNDArray_utils_TestReal,permuteTest){
   EXPECT_FLOAT_EQ(2, permute(&this->Array,&order)->at(851));
 }
 
+TYPED_TEST(hoNDArray_utils_TestReal,permuteAllOrdersTest){
+
+  // a dimension of size 1 between the others
+  size_t vdims[] = {37, 1, 49, 23, 19};
+  std::vector<size_t> dims(vdims, vdims+5);
+  hoNDArray<TypeParam> x(&dims);
+  for (size_t n = 0; n < x.get_number_of_elements(); n++) x(n) = TypeParam(n);
+
+  std::vector<size_t> order(5), ind(5), ind_out(5);
+  for (size_t i = 0; i < 5; i++) order[i] = i;
+
+  do {
+    boost::shared_ptr< hoNDArray<TypeParam> > y = permute(&x, &order);
+
+    for (size_t n = 0; n < x.get_number_of_elements(); n += 7) {
+      x.calculate_index(n, ind);
+      for (size_t i = 0; i < 5; i++) ind_out[i] = ind[order[i]];
+      ASSERT_EQ(x(n), (*y)(ind_out));
+    }
+  } while (std::next_permutation(order.begin(), order.end()));
+}
+
+TYPED_TEST(hoNDArray_utils_TestReal,permuteInPlaceTest){
+
+  std::vector<size_t> order;
+  order.push_back(1); order.push_back(0); order.push_back(2);
+
+  // square transpose, done in place
+  hoNDArray<TypeParam> x(67, 67, 3);
+  for (size_t n = 0; n < x.get_number_of_elements(); n++) x(n) = TypeParam(n);
+  boost::shared_ptr< hoNDArray<TypeParam> > y = permute(&x, &order);
+
+  TypeParam* data = x.begin();
+  permute(&x, &x, &order);
+  EXPECT_EQ(data, x.begin());
+  for (size_t n = 0; n < x.get_number_of_elements(); n++) EXPECT_EQ((*y)(n), x(n));
+
+  // other permutations are reshaped
+  for (size_t n = 0; n < this->Array.get_number_of_elements(); n++) this->Array(n) = TypeParam(n);
+  order.clear();
+  order.push_back(2); order.push_back(0); order.push_back(1);
+
+  y = permute(&this->Array, &order);
+  permute(&this->Array, &this->Array, &order);
+  EXPECT_EQ(23, this->Array.get_size(0));
+  EXPECT_EQ(37, this->Array.get_size(1));
+  EXPECT_EQ(49, this->Array.get_size(2));
+  EXPECT_EQ(19, this->Array.get_size(3));
+  for (size_t n = 0; n < this->Array.get_number_of_elements(); n++) EXPECT_EQ((*y)(n), this->Array(n));
+}
+
 TYPED_TEST(hoNDArray_utils_TestReal,shiftDimTest){
 
   fill(&this->Array,TypeParam(1));
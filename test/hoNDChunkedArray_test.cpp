@@ -0,0 +1,92 @@
+#include "hoNDChunkedArray.h"
+
+#include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <complex>
+#include <vector>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename T> class hoNDChunkedArray_Test : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    filename = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("hoNDChunkedArray_test_%%%%-%%%%.bin")).string();
+
+    dims.resize(4);
+    dims[0] = 13; dims[1] = 7; dims[2] = 5; dims[3] = 3;
+
+    x.create(dims);
+    for (size_t n = 0; n < x.get_number_of_elements(); n++) x(n) = T(n);
+  }
+  std::string filename;
+  std::vector<size_t> dims;
+  hoNDArray<T> x;
+};
+
+typedef Types<float, double, std::complex<float> > Implementations;
+
+TYPED_TEST_CASE(hoNDChunkedArray_Test, Implementations);
+
+TYPED_TEST(hoNDChunkedArray_Test, copyAndAccess)
+{
+  // chunks do not divide the dimensions
+  std::vector<size_t> chunk_dims(4);
+  chunk_dims[0] = 4; chunk_dims[1] = 3; chunk_dims[2] = 5; chunk_dims[3] = 2;
+
+  hoNDChunkedArray<TypeParam> a(this->dims, chunk_dims, this->filename);
+  EXPECT_EQ(4*3*1*2, a.get_number_of_chunks());
+
+  a.copy_from(this->x);
+
+  std::vector<size_t> ind(4);
+  ind[0] = 12; ind[1] = 6; ind[2] = 4; ind[3] = 2;
+  EXPECT_EQ(this->x(ind), a(ind));
+
+  ind[0] = 5; ind[1] = 3; ind[2] = 0; ind[3] = 1;
+  EXPECT_EQ(this->x(ind), a(ind));
+
+  // the last chunk has the remaining extent
+  hoNDArray<TypeParam> chunk;
+  a.get_chunk(a.get_number_of_chunks() - 1, chunk);
+  EXPECT_EQ(1, chunk.get_size(0));
+  EXPECT_EQ(1, chunk.get_size(1));
+  EXPECT_EQ(5, chunk.get_size(2));
+  EXPECT_EQ(1, chunk.get_size(3));
+  a.release(a.get_number_of_chunks() - 1);
+
+  hoNDArray<TypeParam> y;
+  a.copy_to(y);
+  EXPECT_EQ(this->x.get_number_of_elements(), y.get_number_of_elements());
+  for (size_t n = 0; n < y.get_number_of_elements(); n++) EXPECT_EQ(this->x(n), y(n));
+
+  hoNDArray<TypeParam> view;
+  EXPECT_FALSE(a.get_array_view(view));
+}
+
+TYPED_TEST(hoNDChunkedArray_Test, slabs)
+{
+  std::vector<size_t> chunk_dims(this->dims);
+  chunk_dims[3] = 1;
+
+  hoNDChunkedArray<TypeParam> a(this->dims, chunk_dims, this->filename);
+  EXPECT_EQ(3, a.get_number_of_chunks());
+
+  a.copy_from(this->x);
+
+  // the slabs are processed in place and written back
+  hoNDArray<TypeParam> slab;
+  for (size_t c = 0; c < a.get_number_of_chunks(); c++)
+  {
+    if (c + 1 < a.get_number_of_chunks()) a.prefetch(c + 1);
+    a.get_chunk(c, slab);
+    EXPECT_EQ(13*7*5, slab.get_number_of_elements());
+    for (size_t n = 0; n < slab.get_number_of_elements(); n++) slab(n) += TypeParam(1);
+    a.release(c);
+  }
+
+  hoNDArray<TypeParam> view;
+  EXPECT_TRUE(a.get_array_view(view));
+  EXPECT_EQ(4, view.get_number_of_dimensions());
+  for (size_t n = 0; n < view.get_number_of_elements(); n++) EXPECT_EQ(this->x(n) + TypeParam(1), view(n));
+}
@@ -44,3 +44,103 @@ TYPED_TEST(hoNDFFT_test,ifftNrm2Test){
 	EXPECT_NEAR(nrm2(&this->Array2),nrm2(&this->Array),nrm2(&this->Array)*1e-2);
 
 }
+
+template<typename REAL> class hoNDFFT_centered_test : public ::testing::Test {
+protected:
+	virtual void SetUp(){
+		boost::random::mt19937 rng;
+		boost::random::uniform_real_distribution<REAL> uni(0,1);
+
+		// even sizes, and odd sizes which use the shifts
+		size_t even[] = {14, 12, 6, 3};
+		size_t odd[] = {15, 12, 7, 2};
+
+		std::vector<size_t> dims_even(even, even+4), dims_odd(odd, odd+4);
+		Even.create(dims_even);
+		Odd.create(dims_odd);
+
+		for (size_t i = 0; i < Even.get_number_of_elements(); i++) Even(i) = std::complex<REAL>(uni(rng),uni(rng));
+		for (size_t i = 0; i < Odd.get_number_of_elements(); i++) Odd(i) = std::complex<REAL>(uni(rng),uni(rng));
+	}
+
+	/// the centered transform by explicit shifts
+	void reference(hoNDArray< std::complex<REAL> >& x, size_t rank, bool forward) {
+		hoNDFFT<REAL>* fft = hoNDFFT<REAL>::instance();
+		if (rank == 1) { fft->ifftshift1D(x); if (forward) fft->fft1(x); else fft->ifft1(x); fft->fftshift1D(x); }
+		if (rank == 2) { fft->ifftshift2D(x); if (forward) fft->fft2(x); else fft->ifft2(x); fft->fftshift2D(x); }
+		if (rank == 3) { fft->ifftshift3D(x); if (forward) fft->fft3(x); else fft->ifft3(x); fft->fftshift3D(x); }
+	}
+
+	void check(const hoNDArray< std::complex<REAL> >& x, const hoNDArray< std::complex<REAL> >& y) {
+		ASSERT_EQ(x.get_number_of_elements(), y.get_number_of_elements());
+		for (size_t i = 0; i < x.get_number_of_elements(); i++) {
+			EXPECT_NEAR(std::real(x(i)), std::real(y(i)), 1e-4);
+			EXPECT_NEAR(std::imag(x(i)), std::imag(y(i)), 1e-4);
+		}
+	}
+
+	hoNDArray< std::complex<REAL> > Even;
+	hoNDArray< std::complex<REAL> > Odd;
+};
+
+TYPED_TEST_CASE(hoNDFFT_centered_test, realImplementations);
+
+TYPED_TEST(hoNDFFT_centered_test,centeredTest){
+	hoNDFFT<TypeParam>* fft = hoNDFFT<TypeParam>::instance();
+
+	for (size_t rank = 1; rank <= 3; rank++) {
+		for (int forward = 0; forward < 2; forward++) {
+			hoNDArray< std::complex<TypeParam> >* data[] = {&this->Even, &this->Odd};
+
+			for (size_t d = 0; d < 2; d++) {
+				hoNDArray< std::complex<TypeParam> > ref(*data[d]), x(*data[d]), r, buf;
+				this->reference(ref, rank, forward != 0);
+
+				// in place
+				if (rank == 1) { if (forward) fft->fft1c(x); else fft->ifft1c(x); }
+				if (rank == 2) { if (forward) fft->fft2c(x); else fft->ifft2c(x); }
+				if (rank == 3) { if (forward) fft->fft3c(x); else fft->ifft3c(x); }
+				this->check(ref, x);
+
+				// out of place
+				if (rank == 1) { if (forward) fft->fft1c(*data[d], r, buf); else fft->ifft1c(*data[d], r, buf); }
+				if (rank == 2) { if (forward) fft->fft2c(*data[d], r); else fft->ifft2c(*data[d], r); }
+				if (rank == 3) { if (forward) fft->fft3c(*data[d], r, buf); else fft->ifft3c(*data[d], r, buf); }
+				this->check(ref, r);
+			}
+		}
+	}
+}
+
+TYPED_TEST(hoNDFFT_centered_test,centeredBatchTest){
+	hoNDFFT<TypeParam>* fft = hoNDFFT<TypeParam>::instance();
+
+	// batched images as in the recon, [RO E1 E2 CHA]: even sizes with an odd sum of N/2 and an odd E2
+	size_t sizes[][4] = { {64, 48, 10, 4}, {64, 46, 9, 3} };
+
+	boost::random::mt19937 rng;
+	boost::random::uniform_real_distribution<TypeParam> uni(-1,1);
+
+	for (size_t s = 0; s < 2; s++) {
+		std::vector<size_t> dims(sizes[s], sizes[s]+4);
+		hoNDArray< std::complex<TypeParam> > x(dims);
+		for (size_t i = 0; i < x.get_number_of_elements(); i++) x(i) = std::complex<TypeParam>(uni(rng),uni(rng));
+
+		for (size_t rank = 2; rank <= 3; rank++) {
+			hoNDArray< std::complex<TypeParam> > ref(x), y(x);
+			this->reference(ref, rank, true);
+			if (rank == 2) fft->fft2c(y); else fft->fft3c(y);
+
+			// the transform keeps the norm, compare relative to it
+			TypeParam scale = nrm2(&ref);
+			hoNDArray< std::complex<TypeParam> > diff(y);
+			for (size_t i = 0; i < diff.get_number_of_elements(); i++) diff(i) -= ref(i);
+			EXPECT_LT(nrm2(&diff), scale*1e-5);
+
+			// and back
+			if (rank == 2) fft->ifft2c(y); else fft->ifft3c(y);
+			for (size_t i = 0; i < diff.get_number_of_elements(); i++) diff(i) = y(i) - x(i);
+			EXPECT_LT(nrm2(&diff), scale*1e-5);
+		}
+	}
+}
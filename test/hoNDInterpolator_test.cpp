@@ -0,0 +1,182 @@
+/** \file       hoNDInterpolator_test.cpp
+    \brief      Test case for the batched interpolation of hoNDInterpolatorLinear and hoNDInterpolatorBSpline
+*/
+
+#include "hoNDInterpolator.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template<typename T> class hoNDInterpolator_test : public ::testing::Test
+{
+protected:
+    virtual void SetUp()
+    {
+        std::mt19937 gen(1234);
+        std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+
+        im2D_.create(64, 48);
+        for (size_t n = 0; n < im2D_.get_number_of_elements(); n++) im2D_(n) = (T)dis(gen);
+
+        im3D_.create(32, 24, 16);
+        for (size_t n = 0; n < im3D_.get_number_of_elements(); n++) im3D_(n) = (T)dis(gen);
+
+        // most of points are inside the image, some are close to or outside the boundary
+        std::uniform_real_distribution<float> pos(-2.0f, 1.05f);
+
+        N_ = 1000;
+        x_.resize(N_); y_.resize(N_); z_.resize(N_);
+        for (size_t n = 0; n < N_; n++)
+        {
+            x_[n] = pos(gen) * 32;
+            y_[n] = pos(gen) * 24;
+            z_[n] = pos(gen) * 16;
+
+            if (n < 600)
+            {
+                x_[n] = 8 + 0.5f * std::abs(x_[n]);
+                y_[n] = 6 + 0.5f * std::abs(y_[n]);
+                z_[n] = 4 + 0.25f * std::abs(z_[n]);
+            }
+        }
+    }
+
+    hoNDArray<T> im2D_, im3D_;
+    size_t N_;
+    std::vector<float> x_, y_, z_;
+};
+
+typedef Types<float, double> realImplementations;
+TYPED_TEST_CASE(hoNDInterpolator_test, realImplementations);
+
+TYPED_TEST(hoNDInterpolator_test, linear)
+{
+    hoNDBoundaryHandlerBorderValue< hoNDArray<TypeParam> > bh2D(this->im2D_);
+    hoNDInterpolatorLinear< hoNDArray<TypeParam> > interp2D(this->im2D_, bh2D);
+
+    std::vector<TypeParam> res(this->N_);
+    interp2D.interpolate(this->N_, &this->x_[0], &this->y_[0], &res[0]);
+
+    size_t n;
+    for (n = 0; n < this->N_; n++)
+    {
+        EXPECT_NEAR(res[n], interp2D(this->x_[n], this->y_[n]), 1e-5);
+    }
+
+    hoNDBoundaryHandlerBorderValue< hoNDArray<TypeParam> > bh3D(this->im3D_);
+    hoNDInterpolatorLinear< hoNDArray<TypeParam> > interp3D(this->im3D_, bh3D);
+
+    interp3D.interpolate(this->N_, &this->x_[0], &this->y_[0], &this->z_[0], &res[0]);
+
+    for (n = 0; n < this->N_; n++)
+    {
+        EXPECT_NEAR(res[n], interp3D(this->x_[n], this->y_[n], this->z_[n]), 1e-5);
+    }
+}
+
+TYPED_TEST(hoNDInterpolator_test, bspline)
+{
+    unsigned int order;
+    for (order = 3; order <= 5; order += 2)
+    {
+        hoNDBoundaryHandlerBorderValue< hoNDArray<TypeParam> > bh2D(this->im2D_);
+        hoNDInterpolatorBSpline< hoNDArray<TypeParam>, 2 > interp2D(this->im2D_, bh2D, order);
+
+        std::vector<TypeParam> res(this->N_);
+        interp2D.interpolate(this->N_, &this->x_[0], &this->y_[0], &res[0]);
+
+        size_t n;
+        for (n = 0; n < this->N_; n++)
+        {
+            EXPECT_NEAR(res[n], interp2D(this->x_[n], this->y_[n]), 1e-5);
+        }
+
+        hoNDBoundaryHandlerBorderValue< hoNDArray<TypeParam> > bh3D(this->im3D_);
+        hoNDInterpolatorBSpline< hoNDArray<TypeParam>, 3 > interp3D(this->im3D_, bh3D, order);
+
+        interp3D.interpolate(this->N_, &this->x_[0], &this->y_[0], &this->z_[0], &res[0]);
+
+        for (n = 0; n < this->N_; n++)
+        {
+            EXPECT_NEAR(res[n], interp3D(this->x_[n], this->y_[n], this->z_[n]), 1e-5);
+        }
+    }
+}
+
+TYPED_TEST(hoNDInterpolator_test, bspline_coefficients)
+{
+    // the BSpline interpolation reproduces the samples at the grid points
+    hoNDBSpline<TypeParam, 3> bspline;
+    hoNDArray<TypeParam> coeff;
+
+    unsigned int dx = 0, dy = 0, dz = 0;
+
+    // the high order filters amplify the single precision rounding
+    double tol = (sizeof(TypeParam) == sizeof(float)) ? 1e-3 : 1e-8;
+
+    unsigned int order;
+    for (order = 2; order <= 9; order++)
+    {
+        ASSERT_TRUE(bspline.computeBSplineCoefficients(this->im3D_, order, coeff));
+
+        size_t x, y, z;
+        for (z = 0; z < this->im3D_.get_size(2); z += 3)
+        {
+            for (y = 0; y < this->im3D_.get_size(1); y += 5)
+            {
+                for (x = 0; x < this->im3D_.get_size(0); x++)
+                {
+                    TypeParam v = bspline.evaluateBSpline(coeff.begin(), this->im3D_.get_size(0), this->im3D_.get_size(1), this->im3D_.get_size(2), order, dx, dy, dz, (float)x, (float)y, (float)z);
+                    EXPECT_NEAR(v, this->im3D_(x, y, z), tol);
+                }
+            }
+        }
+    }
+}
+
+TYPED_TEST(hoNDInterpolator_test, bspline_coefficients_5D)
+{
+    // every dimension of a 5D array is filtered, the samples are reproduced at the grid points
+    hoNDArray<TypeParam> data(7, 6, 5, 4, 6);
+
+    std::mt19937 gen(5678);
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    size_t n;
+    for (n = 0; n < data.get_number_of_elements(); n++) data(n) = (TypeParam)dis(gen);
+
+    hoNDBSpline<TypeParam, 5> bspline;
+    hoNDArray<TypeParam> coeff;
+
+    double tol = (sizeof(TypeParam) == sizeof(float)) ? 1e-3 : 1e-8;
+
+    unsigned int order = 3;
+    ASSERT_TRUE(bspline.computeBSplineCoefficients(data, order, coeff));
+
+    for (n = 0; n < coeff.get_number_of_elements(); n++)
+    {
+        ASSERT_TRUE(std::isfinite((double)coeff(n)));
+    }
+
+    size_t x, y, z, t, p;
+    for (p = 0; p < data.get_size(4); p++)
+    {
+        for (t = 0; t < data.get_size(3); t++)
+        {
+            for (z = 0; z < data.get_size(2); z += 2)
+            {
+                for (y = 0; y < data.get_size(1); y += 2)
+                {
+                    for (x = 0; x < data.get_size(0); x++)
+                    {
+                        TypeParam v = bspline.evaluateBSpline(coeff.begin(), data.get_size(0), data.get_size(1), data.get_size(2), data.get_size(3), data.get_size(4),
+                            order, 0, 0, 0, 0, 0, (float)x, (float)y, (float)z, (float)t, (float)p);
+                        EXPECT_NEAR(v, data(x + y*7 + z*7*6 + t*7*6*5 + p*7*6*5*4), tol);
+                    }
+                }
+            }
+        }
+    }
+}
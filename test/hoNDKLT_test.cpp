@@ -0,0 +1,162 @@
+#include "hoNDKLT.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename T> class hoNDKLT_test : public ::testing::Test {
+protected:
+  typedef typename realType<T>::Type real_type;
+
+  /// exposes the one-shot covariance of hoNDKLT
+  class KLT : public hoNDKLT<T>
+  {
+  public:
+    using hoNDKLT<T>::compute_covariance;
+  };
+
+  virtual void SetUp()
+  {
+    M_ = 1000;
+    N_ = 8;
+    data_.create(M_, N_);
+
+    // correlated slots with a mean far from zero, which a one-pass sum of squares would not resolve
+    unsigned int seed = 1;
+    for (size_t n = 0; n < N_; n++)
+    {
+      for (size_t m = 0; m < M_; m++)
+      {
+        seed = seed * 1103515245u + 12345u;
+        real_type a = (real_type)((seed >> 8) & 0xFFFF) / 65536 - (real_type)0.5;
+        seed = seed * 1103515245u + 12345u;
+        real_type b = (real_type)((seed >> 8) & 0xFFFF) / 65536 - (real_type)0.5;
+
+        real_type common = (real_type)std::sin(0.05 * m);
+        data_(m, n) = make_value(100 + n + (n + 1) * common + a, (real_type)(n % 3) * common + b);
+      }
+    }
+  }
+
+  static T make_value(real_type re, real_type im)
+  {
+    return make_value(re, im, (T*)0);
+  }
+
+  template <typename R> static R make_value(real_type re, real_type, R*) { return re; }
+  template <typename R> static std::complex<R> make_value(real_type re, real_type im, std::complex<R>*) { return std::complex<R>(re, im); }
+
+  double relative_error(const hoNDArray<T>& a, const hoNDArray<T>& ref)
+  {
+    double err = 0, m = 0;
+    for (size_t n = 0; n < ref.get_number_of_elements(); n++)
+    {
+      err += std::norm(a(n) - ref(n));
+      m += std::norm(ref(n));
+    }
+    return std::sqrt(err / m);
+  }
+
+  double tolerance()
+  {
+    return (sizeof(real_type) == sizeof(float)) ? 1e-4 : 1e-10;
+  }
+
+  size_t M_, N_;
+  hoNDArray<T> data_;
+};
+
+typedef Types<float, double, std::complex<float>, std::complex<double> > realAndComplexImplementations;
+
+TYPED_TEST_CASE(hoNDKLT_test, realAndComplexImplementations);
+
+TYPED_TEST(hoNDKLT_test, covariance_chunks)
+{
+  typename TestFixture::KLT klt;
+  std::vector<size_t> untransformed;
+  hoNDArray<TypeParam> ref;
+  klt.compute_covariance(this->data_, 1, untransformed, true, ref);
+
+  // one chunk, equal chunks, uneven chunks and single samples
+  std::vector< std::vector<size_t> > splits;
+  splits.push_back(std::vector<size_t>(1, this->M_));
+  splits.push_back(std::vector<size_t>(10, this->M_ / 10));
+
+  std::vector<size_t> uneven;
+  uneven.push_back(1);
+  uneven.push_back(7);
+  uneven.push_back(256);
+  uneven.push_back(3);
+  uneven.push_back(600);
+  uneven.push_back(this->M_ - 867);
+  splits.push_back(uneven);
+
+  std::vector<size_t> singles(20, 1);
+  singles.push_back(this->M_ - 20);
+  splits.push_back(singles);
+
+  for (size_t s = 0; s < splits.size(); s++)
+  {
+    hoNDKLTCovariance<TypeParam> acc(this->N_);
+
+    size_t start = 0;
+    for (size_t k = 0; k < splits[s].size(); k++)
+    {
+      // a window of the samples, with the leading dimension of the whole array
+      acc.add(this->data_.begin() + start, splits[s][k], this->M_);
+      start += splits[s][k];
+    }
+    ASSERT_EQ(this->M_, start);
+    EXPECT_EQ(this->M_, acc.number_of_samples());
+
+    hoNDArray<TypeParam> cov;
+    acc.covariance(cov);
+    ASSERT_EQ(this->N_, cov.get_size(0));
+    ASSERT_EQ(this->N_, cov.get_size(1));
+    EXPECT_LT(this->relative_error(cov, ref), this->tolerance()) << "split " << s;
+
+    hoNDArray<TypeParam> mean;
+    acc.mean(mean);
+    for (size_t n = 0; n < this->N_; n++)
+    {
+      TypeParam v(0);
+      for (size_t m = 0; m < this->M_; m++) v += this->data_(m, n);
+      v /= (typename TestFixture::real_type)this->M_;
+      EXPECT_LT(std::abs(mean(n) - v), this->tolerance() * std::abs(v)) << "split " << s << " slot " << n;
+    }
+  }
+}
+
+TYPED_TEST(hoNDKLT_test, prepare_covariance)
+{
+  // the transform from the accumulated covariance is the one of the data
+  hoNDKLTCovariance<TypeParam> acc(this->N_);
+  for (size_t start = 0; start < this->M_; start += 100)
+  {
+    hoNDArray<TypeParam> chunk(100, this->N_);
+    for (size_t n = 0; n < this->N_; n++)
+      for (size_t m = 0; m < 100; m++) chunk(m, n) = this->data_(start + m, n);
+    acc.add(chunk);
+  }
+
+  hoNDArray<TypeParam> cov;
+  acc.covariance(cov);
+
+  std::vector<size_t> untransformed;
+  hoNDKLT<TypeParam> streamed, one_shot;
+  streamed.method(KLT_COVARIANCE);
+  one_shot.method(KLT_COVARIANCE);
+  streamed.prepare_covariance(cov, untransformed, 0);
+  one_shot.prepare(this->data_, 1, (size_t)0);
+
+  hoNDArray<TypeParam> E_streamed, E_one_shot;
+  streamed.eigen_value(E_streamed);
+  one_shot.eigen_value(E_one_shot);
+
+  ASSERT_EQ(E_one_shot.get_number_of_elements(), E_streamed.get_number_of_elements());
+  EXPECT_LT(this->relative_error(E_streamed, E_one_shot), this->tolerance());
+}
@@ -152,3 +152,28 @@ TYPED_TEST(hoNDWavelet_test, hoNDRedundantWaveletTest3D)
     EXPECT_NEAR(v, 0, 0.001);
 }
 
+
+TYPED_TEST(hoNDWavelet_test, hoNDWaveletProximity)
+{
+    Gadgetron::hoNDRedundantWavelet< std::complex<TypeParam> > wav;
+    wav.compute_wavelet_filter("db2");
+
+    hoNDArray< std::complex<TypeParam> > r, rr, p, diff;
+
+    size_t WavDim = 3;
+    size_t level = 1;
+    TypeParam thres = 0.05;
+
+    wav.transform(this->Array, r, WavDim, level, true);
+    wav.shrink(r, WavDim, level, thres, false);
+    wav.transform(r, rr, WavDim, level, false);
+
+    wav.proximity(this->Array, p, WavDim, level, thres, false);
+
+    Gadgetron::subtract(p, rr, diff);
+
+    TypeParam v(0);
+    Gadgetron::norm2(diff, v);
+
+    EXPECT_NEAR(v, 0, 0.001);
+}
@@ -0,0 +1,104 @@
+#include "hoRandNormGenerator.h"
+
+#include <gtest/gtest.h>
+#include <complex>
+#include <vector>
+
+#ifdef USE_OMP
+    #include <omp.h>
+#endif // USE_OMP
+
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename T> class hoRandNormGenerator_Test : public ::testing::Test {
+protected:
+  virtual void SetUp() {
+    randn.seed(1234);
+    randn.setPara(0, 1);
+  }
+  RandNormGenerator<T> randn;
+};
+
+typedef Types<float, double> realImplementations;
+
+TYPED_TEST_CASE(hoRandNormGenerator_Test, realImplementations);
+
+TEST(Philox4x32Test, knownAnswer)
+{
+    // test vectors of the Random123 distribution
+    const uint32_t counter[4] = { 0, 0, 0, 0 };
+    const uint32_t key[2] = { 0, 0 };
+    uint32_t out[4];
+    Philox4x32::generate(counter, key, out);
+
+    EXPECT_EQ(0x6627e8d5u, out[0]);
+    EXPECT_EQ(0xe169c58du, out[1]);
+    EXPECT_EQ(0xbc57ac4cu, out[2]);
+    EXPECT_EQ(0x9b00dbd8u, out[3]);
+
+    const uint32_t counter_f[4] = { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
+    const uint32_t key_f[2] = { 0xffffffff, 0xffffffff };
+    Philox4x32::generate(counter_f, key_f, out);
+
+    EXPECT_EQ(0x408f276du, out[0]);
+    EXPECT_EQ(0x41c83b0eu, out[1]);
+    EXPECT_EQ(0xa20bc7c6u, out[2]);
+    EXPECT_EQ(0x6d5451fdu, out[3]);
+}
+
+TYPED_TEST(hoRandNormGenerator_Test, statistics)
+{
+    typedef TypeParam T;
+
+    hoNDArray<T> x(1000000);
+    this->randn.setPara(2, 3);
+    this->randn.gen(x, 7);
+
+    double mean = 0, var = 0;
+    for (size_t n = 0; n < x.get_number_of_elements(); n++) mean += x(n);
+    mean /= x.get_number_of_elements();
+    for (size_t n = 0; n < x.get_number_of_elements(); n++) var += (x(n) - mean)*(x(n) - mean);
+    var /= x.get_number_of_elements();
+
+    EXPECT_NEAR(2.0, mean, 0.01);
+    EXPECT_NEAR(9.0, var, 0.05);
+}
+
+TYPED_TEST(hoRandNormGenerator_Test, independentOfThreadsAndOffset)
+{
+    typedef TypeParam T;
+
+    hoNDArray< std::complex<T> > x(12345), y(12345);
+
+#ifdef USE_OMP
+    int num_threads = omp_get_max_threads();
+    omp_set_num_threads(1);
+#endif // USE_OMP
+    this->randn.gen(x, 3);
+#ifdef USE_OMP
+    omp_set_num_threads(4);
+#endif // USE_OMP
+    this->randn.gen(y, 3);
+#ifdef USE_OMP
+    omp_set_num_threads(num_threads);
+#endif // USE_OMP
+
+    for (size_t n = 0; n < x.get_number_of_elements(); n++) EXPECT_EQ(x(n), y(n));
+
+    // a part of the stream, starting in the middle of a block
+    hoNDArray< std::complex<T> > part(1031);
+    this->randn.gen(part, 3, 1001);
+    for (size_t n = 0; n < part.get_number_of_elements(); n++) EXPECT_EQ(x(n + 1001), part(n));
+
+    // adding to zero is generating
+    std::vector< std::complex<T> > z(x.get_number_of_elements(), std::complex<T>(0, 0));
+    this->randn.add(&z[0], z.size(), 3);
+    for (size_t n = 0; n < z.size(); n++) EXPECT_EQ(x(n), z[n]);
+
+    // other streams are different
+    this->randn.gen(y, 4);
+    size_t num_equal = 0;
+    for (size_t n = 0; n < x.get_number_of_elements(); n++) if (x(n) == y(n)) num_equal++;
+    EXPECT_EQ(0u, num_equal);
+}
@@ -0,0 +1,174 @@
+#include "mri_core_coil_map_estimation.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename T> class coil_map_Inati_fast_test : public ::testing::Test {
+protected:
+  typedef typename realType<T>::Type real_type;
+
+  /// smooth coil sensitivities times an object inside a sphere, with noise; [RO E1 E2 CHA]
+  void make_coil_images(hoNDArray<T>& x, size_t RO, size_t E1, size_t E2, size_t CHA)
+  {
+    x.create(RO, E1, E2, CHA);
+
+    unsigned int seed = 1;
+    for (size_t c = 0; c < CHA; c++)
+    {
+      real_type cx = (real_type)(c % 4) / 3, cy = (real_type)((c / 4) % 4) / 3, cz = (real_type)(c / 16);
+      for (size_t z = 0; z < E2; z++)
+        for (size_t y = 0; y < E1; y++)
+          for (size_t r = 0; r < RO; r++)
+          {
+            real_type px = (real_type)r / RO, py = (real_type)y / E1, pz = (E2 > 1) ? (real_type)z / E2 : (real_type)0.5;
+            real_type d2 = (px - cx)*(px - cx) + (py - cy)*(py - cy) + (pz - cz)*(pz - cz);
+            T sen = std::polar(std::exp(-2 * d2), 3 * px + 2 * c * py);
+
+            real_type ox = px - (real_type)0.5, oy = py - (real_type)0.5, oz = pz - (real_type)0.5;
+            T obj = (ox*ox + oy*oy + oz*oz < (real_type)0.16) ? std::polar(1 + (real_type)0.3*std::sin(20 * px), 2 * py) : T(0);
+
+            seed = seed * 1103515245u + 12345u;
+            real_type nr = (real_type)((seed >> 8) & 0xFFFF) / 65536 - (real_type)0.5;
+            seed = seed * 1103515245u + 12345u;
+            real_type ni = (real_type)((seed >> 8) & 0xFFFF) / 65536 - (real_type)0.5;
+
+            x(r + RO*(y + E1*(z + E2*c))) = sen*obj + (real_type)0.01*T(nr, ni);
+          }
+    }
+  }
+
+  /// l2 norm of the difference inside the object, relative to the reference; the phase of a coil map is arbitrary where there is only noise
+  double relative_error(const hoNDArray<T>& a, const hoNDArray<T>& ref, const hoNDArray<T>& im, size_t CHA)
+  {
+    size_t N = im.get_number_of_elements() / CHA;
+
+    std::vector<double> energy(N, 0);
+    double max_energy = 0;
+    for (size_t n = 0; n < N; n++)
+    {
+      for (size_t c = 0; c < CHA; c++) energy[n] += std::norm(im(n + c*N));
+      max_energy = std::max(max_energy, energy[n]);
+    }
+
+    double err = 0, m = 0;
+    for (size_t n = 0; n < N; n++)
+    {
+      if (energy[n] < 0.1*max_energy) continue;
+
+      for (size_t c = 0; c < CHA; c++)
+      {
+        err += std::norm(a(n + c*N) - ref(n + c*N));
+        m += std::norm(ref(n + c*N));
+      }
+    }
+    return std::sqrt(err / m);
+  }
+
+  /// float sums in a different order
+  double tolerance()
+  {
+    return (sizeof(real_type) == sizeof(float)) ? 1e-4 : 1e-9;
+  }
+};
+
+typedef Types< std::complex<float>, std::complex<double> > cpfloatImplementations;
+
+TYPED_TEST_CASE(coil_map_Inati_fast_test, cpfloatImplementations);
+
+TYPED_TEST(coil_map_Inati_fast_test, same_as_Inati_2D)
+{
+  size_t RO = 64, E1 = 56, CHA = 8;
+  hoNDArray<TypeParam> im;
+  this->make_coil_images(im, RO, E1, 1, CHA);
+  hoNDArray<TypeParam> im2(RO, E1, CHA, im.begin());
+
+  // odd and even kernel sizes
+  size_t ks[] = { 7, 5, 4 };
+  for (size_t k = 0; k < 3; k++)
+  {
+    hoNDArray<TypeParam> ref, fast;
+    coil_map_2d_Inati(im2, ref, ks[k], 3);
+    coil_map_2d_Inati_fast(im2, fast, ks[k], 3);
+
+    ASSERT_EQ(ref.get_number_of_elements(), fast.get_number_of_elements());
+    EXPECT_LT(this->relative_error(fast, ref, im2, CHA), this->tolerance()) << "ks " << ks[k];
+  }
+}
+
+TYPED_TEST(coil_map_Inati_fast_test, same_as_Inati_3D)
+{
+  size_t RO = 32, E1 = 30, E2 = 16, CHA = 6;
+  hoNDArray<TypeParam> im;
+  this->make_coil_images(im, RO, E1, E2, CHA);
+
+  hoNDArray<TypeParam> ref, fast;
+  coil_map_3d_Inati(im, ref, 5, 3, 3);
+  coil_map_3d_Inati_fast(im, fast, 5, 3, 3);
+
+  ASSERT_EQ(ref.get_number_of_elements(), fast.get_number_of_elements());
+  EXPECT_LT(this->relative_error(fast, ref, im, CHA), this->tolerance());
+}
+
+TYPED_TEST(coil_map_Inati_fast_test, same_as_Inati_batch)
+{
+  // [RO E1 E2 CHA N], the 2D estimation per N
+  size_t RO = 40, E1 = 36, CHA = 8, N = 2;
+  hoNDArray<TypeParam> im;
+  this->make_coil_images(im, RO, E1, 1, CHA*N);
+  hoNDArray<TypeParam> im5(RO, E1, 1, CHA, N, im.begin());
+
+  hoNDArray<TypeParam> ref, fast;
+  coil_map_Inati(im5, ref, 7, 5, 3);
+  coil_map_Inati_fast(im5, fast, 7, 5, 3);
+
+  ASSERT_EQ(ref.get_number_of_elements(), fast.get_number_of_elements());
+  for (size_t n = 0; n < N; n++)
+  {
+    size_t len = RO*E1*CHA;
+    hoNDArray<TypeParam> r(RO, E1, CHA, ref.begin() + n*len), f(RO, E1, CHA, fast.begin() + n*len), x(RO, E1, CHA, im5.begin() + n*len);
+    EXPECT_LT(this->relative_error(f, r, x, CHA), this->tolerance()) << "n " << n;
+  }
+}
+
+TYPED_TEST(coil_map_Inati_fast_test, step)
+{
+  // the maps are smooth, the interpolated estimate stays close to the full one
+  size_t RO = 64, E1 = 56, CHA = 8;
+  hoNDArray<TypeParam> im4;
+  this->make_coil_images(im4, RO, E1, 1, CHA);
+  hoNDArray<TypeParam> im(RO, E1, CHA, im4.begin());
+
+  hoNDArray<TypeParam> ref, fast;
+  coil_map_2d_Inati(im, ref, 7, 3);
+  coil_map_2d_Inati_fast(im, fast, 7, 3, 2);
+
+  ASSERT_EQ(ref.get_number_of_elements(), fast.get_number_of_elements());
+  EXPECT_LT(this->relative_error(fast, ref, im, CHA), 0.1);
+}
+
+TYPED_TEST(coil_map_Inati_fast_test, zero_pixels)
+{
+  // coil_map_2d_Inati divides by zero there
+  size_t RO = 24, E1 = 20, CHA = 4;
+  hoNDArray<TypeParam> im4;
+  this->make_coil_images(im4, RO, E1, 1, CHA);
+  hoNDArray<TypeParam> im(RO, E1, CHA, im4.begin());
+
+  // a band of rows without signal, wider than the kernel
+  for (size_t c = 0; c < CHA; c++)
+    for (size_t y = 5; y < 15; y++)
+      for (size_t r = 0; r < RO; r++) im(r + RO*(y + E1*c)) = TypeParam(0);
+
+  hoNDArray<TypeParam> fast;
+  coil_map_2d_Inati_fast(im, fast, 5, 3);
+
+  for (size_t n = 0; n < fast.get_number_of_elements(); n++)
+  {
+    ASSERT_TRUE(std::isfinite(std::real(fast(n))) && std::isfinite(std::imag(fast(n))));
+  }
+}
@@ -0,0 +1,186 @@
+#include "mri_core_image_conversion.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename T> class mri_core_image_conversion_test : public ::testing::Test {
+protected:
+  virtual void SetUp()
+  {
+    size_t RO = 192, E1 = 160;
+    im_.create(RO, E1);
+
+    // an object with noise and a few bright pixels, the auto scaling ignores them
+    unsigned int seed = 1;
+    for (size_t y = 0; y < E1; y++)
+      for (size_t r = 0; r < RO; r++)
+      {
+        float px = (float)r / RO - 0.5f, py = (float)y / E1 - 0.5f;
+
+        seed = seed * 1103515245u + 12345u;
+        float noise = (float)((seed >> 8) & 0xFFFF) / 65536;
+
+        float obj = (px*px + py*py < 0.16f) ? 300.0f*(1.0f + 0.5f*std::sin(30 * px)*std::cos(20 * py)) : 0.0f;
+        im_(r, y) = obj + 5.0f*noise;
+      }
+
+    for (size_t n = 0; n < 16; n++) im_(n*RO / 16 + RO*E1 / 2) = 5000.0f;
+  }
+
+  /// the histogram of AutoScaleGadget
+  float reference_percentile(const hoNDArray<float>& im, size_t histogram_bins)
+  {
+    size_t N = im.get_number_of_elements();
+    const float* d = im.begin();
+
+    float max = 0.0f;
+    for (size_t i = 0; i < N; i++) {
+      if (d[i] > max) max = d[i];
+    }
+
+    std::vector<size_t> histogram(histogram_bins, 0);
+    for (size_t i = 0; i < N; i++) {
+      size_t bin = static_cast<size_t>(std::floor((d[i] / max)*histogram_bins));
+      if (bin >= histogram_bins) bin = histogram_bins - 1;
+      histogram[bin]++;
+    }
+
+    long long cumsum = 0;
+    size_t counter = 0;
+    while (cumsum < (0.99*N)) {
+      cumsum += (long long)(histogram[counter++]);
+    }
+    return (counter + 1)*(max / histogram_bins);
+  }
+
+  /// the scaling of AutoScaleGadget, then the magnitude conversion of FloatToFixPointGadget
+  void reference_auto_scale(const hoNDArray<float>& im, size_t histogram_bins, float max_value, T min_intensity, T max_intensity, hoNDArray<T>& res)
+  {
+    hoNDArray<float> d(im);
+    float scale = max_value / reference_percentile(d, histogram_bins);
+    for (size_t i = 0; i < d.get_number_of_elements(); i++) d(i) *= scale;
+
+    res.create(im.get_dimensions());
+    for (size_t i = 0; i < d.get_number_of_elements(); i++)
+    {
+      float pix_val = std::abs(d(i));
+      if (pix_val < (float)min_intensity) pix_val = (float)min_intensity;
+      if (pix_val > (float)max_intensity) pix_val = (float)max_intensity;
+      res(i) = static_cast<T>(pix_val + 0.5);
+    }
+  }
+
+  /// the real and imag conversion of FloatToFixPointGadget
+  void reference_real(const hoNDArray<float>& im, T offset, T min_intensity, T max_intensity, hoNDArray<T>& res)
+  {
+    res.create(im.get_dimensions());
+    for (size_t i = 0; i < im.get_number_of_elements(); i++)
+    {
+      float pix_val = im(i);
+      pix_val = pix_val + offset;
+      if (pix_val < (float)min_intensity) pix_val = (float)min_intensity;
+      if (pix_val > (float)max_intensity) pix_val = (float)max_intensity;
+      res(i) = static_cast<T>(pix_val + 0.5);
+    }
+  }
+
+  /// the phase conversion of FloatToFixPointGadget
+  void reference_phase(const hoNDArray<float>& im, T offset, T min_intensity, T max_intensity, hoNDArray<T>& res)
+  {
+    res.create(im.get_dimensions());
+    for (size_t i = 0; i < im.get_number_of_elements(); i++)
+    {
+      float pix_val = im(i);
+      pix_val *= (float)(offset / 3.14159265);
+      pix_val += offset;
+      if (pix_val < (float)min_intensity) pix_val = (float)min_intensity;
+      if (pix_val > (float)max_intensity) pix_val = (float)max_intensity;
+      res(i) = static_cast<T>(pix_val);
+    }
+  }
+
+  size_t mismatch(const hoNDArray<T>& a, const hoNDArray<T>& b)
+  {
+    size_t n = 0;
+    for (size_t i = 0; i < a.get_number_of_elements(); i++) n += (a(i) != b(i));
+    return n;
+  }
+
+  hoNDArray<float> im_;
+};
+
+typedef Types<unsigned short, short, unsigned int, int> fixPointImplementations;
+
+TYPED_TEST_CASE(mri_core_image_conversion_test, fixPointImplementations);
+
+TYPED_TEST(mri_core_image_conversion_test, histogram_percentile)
+{
+  size_t bins[] = { 100, 37, 1000, 4096 };
+  for (size_t k = 0; k < sizeof(bins) / sizeof(bins[0]); k++)
+  {
+    EXPECT_EQ(this->reference_percentile(this->im_, bins[k]), compute_histogram_percentile(this->im_, bins[k], 0.99)) << "bins " << bins[k];
+  }
+
+  hoNDArray<float> zero(16, 16);
+  zero.fill(0);
+  EXPECT_EQ(0, compute_histogram_percentile(zero, 100, 0.99));
+}
+
+TYPED_TEST(mri_core_image_conversion_test, auto_scale)
+{
+  // AutoScaleGadget followed by FloatToFixPointGadget against FloatToFixPointGadget with auto_scale
+  size_t bins[] = { 100, 64, 1000 };
+  for (size_t k = 0; k < sizeof(bins) / sizeof(bins[0]); k++)
+  {
+    hoNDArray<TypeParam> ref, res;
+    this->reference_auto_scale(this->im_, bins[k], 2048.0f, 0, 4095, ref);
+
+    float scale = 2048.0f / compute_histogram_percentile(this->im_, bins[k], 0.99);
+    convert_to_fix_point(this->im_, scale, 0.0f, true, true, (TypeParam)0, (TypeParam)4095, res);
+
+    EXPECT_EQ(0, this->mismatch(ref, res)) << "bins " << bins[k];
+  }
+}
+
+TYPED_TEST(mri_core_image_conversion_test, real_and_phase)
+{
+  // signed values, the unsigned types clamp them at min_intensity
+  hoNDArray<float> im(this->im_);
+  for (size_t i = 0; i < im.get_number_of_elements(); i++) im(i) = (i % 2) ? im(i) - 300.0f : -im(i);
+
+  TypeParam lo = std::numeric_limits<TypeParam>::min();
+  TypeParam hi = 4095;
+
+  hoNDArray<TypeParam> ref, res;
+  this->reference_real(im, 2048, lo, hi, ref);
+  convert_to_fix_point(im, 1.0f, 2048.0f, false, true, lo, hi, res);
+  EXPECT_EQ(0, this->mismatch(ref, res));
+
+  hoNDArray<float> phase(im);
+  for (size_t i = 0; i < phase.get_number_of_elements(); i++) phase(i) = (float)(3.14159265 * std::sin(0.01 * i));
+
+  this->reference_phase(phase, 2048, lo, hi, ref);
+  convert_to_fix_point(phase, (float)(2048 / 3.14159265), 2048.0f, false, false, lo, hi, res);
+  EXPECT_EQ(0, this->mismatch(ref, res));
+}
+
+TYPED_TEST(mri_core_image_conversion_test, rounding)
+{
+  // the largest floats below k + 1/2, where a float addition of 1/2 rounds up to k + 1
+  hoNDArray<float> im(64);
+  for (size_t i = 0; i < im.get_number_of_elements(); i++)
+  {
+    float k = (float)(i * 67) + 0.5f;
+    im(i) = std::nextafter(k, 0.0f);
+  }
+
+  hoNDArray<TypeParam> ref, res;
+  this->reference_real(im, 0, 0, 4095, ref);
+  convert_to_fix_point(im, 1.0f, 0.0f, false, true, (TypeParam)0, (TypeParam)4095, res);
+  EXPECT_EQ(0, this->mismatch(ref, res));
+}
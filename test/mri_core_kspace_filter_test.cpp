@@ -0,0 +1,135 @@
+#include "hoNDFFT.h"
+#include "mri_core_kspace_filter.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <complex>
+#include <cstring>
+
+using namespace Gadgetron;
+using testing::Types;
+
+template <typename T> class mri_core_kspace_filter_test : public ::testing::Test {
+protected:
+  typedef std::complex<T> ValueType;
+
+  virtual void SetUp()
+  {
+    RO_ = 512;
+    CHA_ = 4;
+  }
+
+  /// kspace of a smooth object which covers the central fraction of the field of view, every channel with its own phase
+  void make_object(double fraction, hoNDArray<ValueType>& data)
+  {
+    data.create(RO_, CHA_);
+    for (size_t c = 0; c < CHA_; c++)
+    {
+      for (size_t n = 0; n < RO_; n++)
+      {
+        // u in [-1 1) over the oversampled field of view, which is twice the field of view
+        double u = ((double)n - RO_ / 2) / (RO_ / 2);
+        double w = 0.5*fraction;
+        double s = (std::abs(u) < w) ? std::cos(M_PI*u / (2 * w))*std::cos(M_PI*u / (2 * w))*(1 + 0.3*std::sin(20 * u)) : 0.0;
+        // the alternating sign puts the center of kspace at RO/2
+        if (n % 2) s = -s;
+        data(n, c) = ValueType((T)(s * std::cos(0.5 * c * u)), (T)(s * std::sin(0.5 * c * u)));
+      }
+    }
+
+    hoNDFFT<T>::instance()->fft(&data, 0);
+  }
+
+  /// white kspace, the object fills the field of view
+  void make_white(hoNDArray<ValueType>& data)
+  {
+    data.create(RO_, CHA_);
+    unsigned int seed = 1;
+    for (size_t n = 0; n < data.get_number_of_elements(); n++)
+    {
+      seed = seed * 1103515245u + 12345u;
+      T re = (T)((seed >> 8) & 0xFFFF) / 65536 - (T)0.5;
+      seed = seed * 1103515245u + 12345u;
+      T im = (T)((seed >> 8) & 0xFFFF) / 65536 - (T)0.5;
+      data(n) = ValueType(re, im);
+    }
+  }
+
+  /// the loop of RemoveROOversamplingGadget: ifft, copy of the central half and fft
+  void reference(const hoNDArray<ValueType>& data, hoNDArray<ValueType>& res)
+  {
+    hoNDArray<ValueType> im(data);
+    hoNDFFT<T>::instance()->ifft(&im, 0);
+
+    size_t M = RO_ / 2;
+    res.create(M, CHA_);
+    for (size_t c = 0; c < CHA_; c++) memcpy(res.begin() + c*M, im.begin() + c*RO_ + (RO_ - M) / 2, sizeof(ValueType)*M);
+
+    hoNDFFT<T>::instance()->fft(&res, 0);
+  }
+
+  double relative_error(const hoNDArray<ValueType>& a, const hoNDArray<ValueType>& ref)
+  {
+    double err = 0, m = 0;
+    for (size_t n = 0; n < ref.get_number_of_elements(); n++)
+    {
+      err += std::norm(a(n) - ref(n));
+      m += std::norm(ref(n));
+    }
+    return std::sqrt(err / m);
+  }
+
+  double tolerance()
+  {
+    return (sizeof(T) == sizeof(float)) ? 1e-5 : 1e-12;
+  }
+
+  size_t RO_, CHA_;
+};
+
+typedef Types<float, double> realImplementations;
+
+TYPED_TEST_CASE(mri_core_kspace_filter_test, realImplementations);
+
+TYPED_TEST(mri_core_kspace_filter_test, ro_oversampling_all_taps)
+{
+  // all taps without a window are the ifft, crop and fft
+  ROOversamplingFilter<TypeParam> filter;
+  generate_ro_oversampling_filter(this->RO_, this->RO_ / 2, 0, filter);
+  EXPECT_EQ(this->RO_ / 2, filter.taps.size());
+
+  hoNDArray< std::complex<TypeParam> > data, ref, res;
+
+  this->make_white(data);
+  this->reference(data, ref);
+  remove_ro_oversampling(data, filter, res);
+  ASSERT_EQ(this->RO_ / 2, res.get_size(0));
+  ASSERT_EQ(this->CHA_, res.get_size(1));
+  EXPECT_LT(this->relative_error(res, ref), this->tolerance());
+
+  this->make_object(0.6, data);
+  this->reference(data, ref);
+  remove_ro_oversampling(data, filter, res);
+  EXPECT_LT(this->relative_error(res, ref), this->tolerance());
+}
+
+TYPED_TEST(mri_core_kspace_filter_test, ro_oversampling_default_taps)
+{
+  // the defaults of RemoveROOversamplingGadget, 24 taps and beta 6
+  ROOversamplingFilter<TypeParam> filter;
+  generate_ro_oversampling_filter(this->RO_, 24, 6.0, filter);
+
+  hoNDArray< std::complex<TypeParam> > data, ref, res;
+
+  // an object in the central 60% of the field of view is away from the transition band
+  this->make_object(0.6, data);
+  this->reference(data, ref);
+  remove_ro_oversampling(data, filter, res);
+  EXPECT_LT(this->relative_error(res, ref), 1e-3);
+
+  // white kspace fills the field of view and has signal in the transition band at its edges, the error is about 8%
+  this->make_white(data);
+  this->reference(data, ref);
+  remove_ro_oversampling(data, filter, res);
+  EXPECT_LT(this->relative_error(res, ref), 0.1);
+}
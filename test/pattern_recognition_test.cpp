@@ -21,6 +21,104 @@ protected:
     }
 };
 
+/// the online update which recomputes the full [N K] del_cost after every move
+template <typename T>
+void reference_online_update(const hoNDArray<T>& X, size_t max_iter, std::vector<size_t>& IDX, hoNDArray<T>& C, T& sumD)
+{
+    size_t P = X.get_size(0);
+    size_t N = X.get_size(1);
+    size_t K = C.get_size(1);
+
+    hoNDArray<T> del_cost(N, K);
+
+    std::vector<size_t> num_pt_clusters(K, 0);
+    size_t n, p, k;
+    for (n = 0; n < N; n++) num_pt_clusters[IDX[n]]++;
+
+    size_t iter(0);
+    size_t lastmoved = 0;
+    std::vector<size_t> prevIDX, newIDX(IDX);
+
+    while (iter < max_iter)
+    {
+        for (k = 0; k < K; k++)
+        {
+            for (n = 0; n < N; n++)
+            {
+                T v;
+                if (IDX[n] == k)
+                    v = (num_pt_clusters[k] > 1) ? (T)num_pt_clusters[k] / (T)(num_pt_clusters[k] - 1) : 1;
+                else
+                    v = (T)num_pt_clusters[k] / (T)(num_pt_clusters[k] + 1);
+
+                T t(0), d = 0;
+                for (p = 0; p < P; p++)
+                {
+                    t = X(p, n) - C(p, k);
+                    d += t*t;
+                }
+
+                del_cost(n, k) = v * d;
+            }
+        }
+
+        prevIDX = IDX;
+
+        for (n = 0; n < N; n++)
+        {
+            newIDX[n] = 0;
+            T min_del_cost = del_cost(n, 0);
+            for (k = 1; k < K; k++)
+            {
+                if (del_cost(n, k) < min_del_cost)
+                {
+                    newIDX[n] = k;
+                    min_del_cost = del_cost(n, k);
+                }
+            }
+        }
+
+        std::vector<size_t> moved;
+        for (n = 0; n < N; n++)
+        {
+            if (prevIDX[n] != newIDX[n]) moved.push_back(n);
+        }
+
+        if (moved.empty()) break;
+
+        // the first candidate after the last moved point
+        size_t moved_ind = moved[0];
+        for (size_t ii = 0; ii < moved.size(); ii++)
+        {
+            if ((moved[ii] + N - lastmoved - 1) % N < (moved_ind + N - lastmoved - 1) % N) moved_ind = moved[ii];
+        }
+
+        if (moved_ind <= lastmoved)
+        {
+            iter++;
+            if (iter >= max_iter) break;
+        }
+
+        lastmoved = moved_ind;
+
+        size_t oidx = IDX[moved_ind];
+        size_t nidx = newIDX[moved_ind];
+
+        sumD = sumD + del_cost(moved_ind, nidx) - del_cost(moved_ind, oidx);
+
+        IDX[moved_ind] = nidx;
+
+        num_pt_clusters[oidx]--;
+        num_pt_clusters[nidx]++;
+
+        for (p = 0; p < P; p++)
+        {
+            C(p, nidx) = C(p, nidx) + (X(p, moved_ind) - C(p, nidx)) / num_pt_clusters[nidx];
+            C(p, oidx) = C(p, oidx) - (X(p, moved_ind) - C(p, oidx)) / num_pt_clusters[oidx];
+        }
+    }
+}
+
 typedef Types<float> realImplementations;
 TYPED_TEST_CASE(pattern_recognition_test, realImplementations);
 
@@ -185,3 +283,140 @@ TYPED_TEST(pattern_recognition_test, kmeans_test)
 
     EXPECT_LE( std::sqrt(sumD) / N, 2.0);
 }
+
+TYPED_TEST(pattern_recognition_test, kmeans_bounded_update_test)
+{
+    std::default_random_engine generator;
+    std::normal_distribution<float> distribution(0.0f, 1.0f);
+
+    // well separated clusters, so there are no ties between the plain and bounded update
+    size_t P = 8;
+    size_t N = 6000;
+    size_t K = 4;
+
+    hoNDArray<float> X;
+    X.create(P, N);
+
+    size_t n, p, k;
+    for (n = 0; n < N; n++)
+    {
+        k = n % K;
+        for (p = 0; p < P; p++)
+        {
+            X(p, n) = distribution(generator) + 10.0f * ((k + p) % K);
+        }
+    }
+
+    Gadgetron::kmeans<float> km;
+    km.max_iter_ = 100;
+    km.replicates_ = 6;
+    km.block_size_ = 1000;
+
+    hoNDArray<float> C_for_initial;
+    km.get_initial_guess_kmeansplusplus(X, K, C_for_initial);
+
+    std::vector<size_t> IDX, IDX_bounded;
+    hoNDArray<float> C, C_bounded;
+    std::vector<float> sumD_rep, sumD_rep_bounded;
+    float sumD, sumD_bounded;
+
+    km.perform_bounded_update_ = false;
+    km.perform_parallel_replicates_ = false;
+    km.run_replicates(X, K, C_for_initial, IDX, C, sumD_rep, sumD);
+
+    km.perform_bounded_update_ = true;
+    km.perform_parallel_replicates_ = true;
+    km.run_replicates(X, K, C_for_initial, IDX_bounded, C_bounded, sumD_rep_bounded, sumD_bounded);
+
+    ASSERT_EQ(IDX.size(), IDX_bounded.size());
+    for (n = 0; n < N; n++)
+    {
+        EXPECT_EQ(IDX[n], IDX_bounded[n]);
+    }
+
+    EXPECT_NEAR(sumD, sumD_bounded, 1e-3*sumD);
+
+    for (k = 0; k < K; k++)
+    {
+        for (p = 0; p < P; p++)
+        {
+            EXPECT_NEAR(C(p, k), C_bounded(p, k), 1e-3);
+        }
+    }
+}
+
+TYPED_TEST(pattern_recognition_test, kmeans_online_update_test)
+{
+    std::default_random_engine generator;
+    std::normal_distribution<float> distribution(0.0f, 1.0f);
+
+    // overlapping clusters, the online phase moves many points
+    size_t P = 4;
+    size_t N = 2000;
+    size_t K = 5;
+
+    hoNDArray<float> X;
+    X.create(P, N);
+
+    size_t n, p, k;
+    for (n = 0; n < N; n++)
+    {
+        k = n % K;
+        for (p = 0; p < P; p++)
+        {
+            X(p, n) = distribution(generator) + 0.5f * ((k + p) % K);
+        }
+    }
+
+    Gadgetron::kmeans<float> km;
+    km.max_iter_ = 100;
+
+    // start from the generating clusters, which the online phase improves on
+    std::vector<size_t> IDX(N);
+    for (n = 0; n < N; n++) IDX[n] = n % K;
+
+    hoNDArray<float> C(P, K);
+    std::vector<float> norm_C(K, 0);
+    km.update_centroid(X, IDX, C, norm_C);
+
+    float sumD = 0;
+    for (n = 0; n < N; n++)
+    {
+        for (p = 0; p < P; p++)
+        {
+            float t = X(p, n) - C(p, IDX[n]);
+            sumD += t*t;
+        }
+    }
+
+    std::vector<size_t> IDX_start(IDX), IDX_ref(IDX);
+    hoNDArray<float> C_ref(C);
+    float sumD_start = sumD, sumD_ref = sumD;
+
+    km.perform_online_update(X, IDX, C, sumD);
+    reference_online_update(X, km.max_iter_, IDX_ref, C_ref, sumD_ref);
+
+    size_t num_moved = 0;
+    for (n = 0; n < N; n++)
+    {
+        if (IDX_ref[n] != IDX_start[n]) num_moved++;
+    }
+    EXPECT_GT(num_moved, 0);
+    EXPECT_LT(sumD_ref, sumD_start);
+
+    ASSERT_EQ(IDX_ref.size(), IDX.size());
+    for (n = 0; n < N; n++)
+    {
+        EXPECT_EQ(IDX_ref[n], IDX[n]);
+    }
+
+    EXPECT_NEAR(sumD_ref, sumD, 1e-5*sumD_ref);
+
+    for (k = 0; k < K; k++)
+    {
+        for (p = 0; p < P; p++)
+        {
+            EXPECT_NEAR(C_ref(p, k), C(p, k), 1e-5);
+        }
+    }
+}
@@ -46,7 +46,12 @@ namespace Gadgetron
 	}
 	{
 	  std::unique_lock<std::mutex> lk(cloud_bus_->mtx_);
-	  deserialize(cloud_bus_->nodes_, buffer+4, msg_size-4);
+	  try {
+	    deserialize(cloud_bus_->nodes_, buffer+4, msg_size-4);
+	  } catch (std::runtime_error& e) {
+	    GERROR("Unable to read node list from relay: %s\n", e.what());
+	    cloud_bus_->nodes_.clear();
+	  }
 	  lk.unlock();
 	  cloud_bus_->node_list_condition_.notify_all();
 	}
@@ -111,6 +116,17 @@ namespace Gadgetron
     return node_info_.active_reconstructions;
   }
 
+  unsigned int CloudBus::compute_capability()
+  {
+    return node_info_.compute_capability;
+  }
+
+  unsigned int CloudBus::queue_length()
+  {
+    std::lock_guard<std::mutex> lk(queue_length_mtx_);
+    return node_info_.queue_length;
+  }
+
   unsigned int CloudBus::port()
   {
     return node_info_.port;
@@ -137,6 +153,27 @@ namespace Gadgetron
     send_node_info();
   }
 
+  void CloudBus::report_queue_length_change(int change)
+  {
+    bool send = false;
+    {
+      std::lock_guard<std::mutex> lk(queue_length_mtx_);
+      int queue_length = (int)node_info_.queue_length + change;
+      node_info_.queue_length = (queue_length > 0) ? queue_length : 0;
+
+      auto now = std::chrono::steady_clock::now();
+      if (now - queue_length_sent_ >= std::chrono::milliseconds(100)) {
+        queue_length_sent_ = now;
+        queue_length_changed_ = false;
+        send = true;
+      } else {
+        queue_length_changed_ = true;
+      }
+    }
+
+    if (send) send_node_info();
+  }
+
   
   int CloudBus::open(void*)
   {
@@ -200,6 +237,18 @@ namespace Gadgetron
               }
           }
       }
+      //Send queue length changes which were held back
+      if (connected_ && !query_mode_) {
+        bool send = false;
+        {
+          std::lock_guard<std::mutex> lk(queue_length_mtx_);
+          send = queue_length_changed_;
+          queue_length_changed_ = false;
+          if (send) queue_length_sent_ = std::chrono::steady_clock::now();
+        }
+        if (send) send_node_info();
+      }
+
       //Sleep for 5 seconds
       ACE_Time_Value tv (5);
       ACE_OS::sleep (tv);	  	
@@ -261,6 +310,7 @@ namespace Gadgetron
         n.rest_port = 9080;
         n.compute_capability = 1;
         n.active_reconstructions = 0;
+        n.queue_length = 0;
         n.last_recon = 0;
         nodes.clear();
         nodes.push_back(n);
@@ -299,6 +349,8 @@ namespace Gadgetron
     listener.get_local_addr (local_addr);
     node_info_.address = std::string(local_addr.get_host_name());
     node_info_.active_reconstructions = 0;
+    node_info_.queue_length = 0;
+    queue_length_changed_ = false;
     auto t = std::chrono::system_clock::now() - std::chrono::seconds(5*60);
     node_info_.last_recon = std::chrono::system_clock::to_time_t(t);
   }
@@ -92,11 +92,17 @@ namespace Gadgetron
     size_t get_number_of_nodes();
 
     unsigned int active_reconstructions();
+    unsigned int compute_capability();
+    unsigned int queue_length();
     unsigned int port();
     const char* uuid();
     
     void report_recon_start();
     void report_recon_end();
+
+    ///Change of the number of messages waiting in the gadget queues of a stream on this node.
+    ///Updates are sent to the relay at most every 100 ms, the rest with the next heartbeat.
+    void report_queue_length_change(int change);
     
   protected:
     ///Protected constructor. 
@@ -119,6 +125,10 @@ namespace Gadgetron
     
     std::mutex mtx_;
     std::condition_variable node_list_condition_;
+
+    std::mutex queue_length_mtx_;
+    bool queue_length_changed_;
+    std::chrono::steady_clock::time_point queue_length_sent_;
   
     /*
     ACE_Thread_Mutex mtx_;
@@ -6,9 +6,10 @@ namespace Gadgetron
   size_t calculate_node_info_length(GadgetronNodeInfo& n)
   {
     size_t len = 0;
+    len += 4; //version
     len += 4 + n.uuid.size();
     len += 4 + n.address.size();
-    len += 4*sizeof(uint32_t);
+    len += 5*sizeof(uint32_t);
     len += sizeof(std::time_t);
     return len;
   }
@@ -21,6 +22,8 @@ namespace Gadgetron
       throw std::runtime_error("Provided buffer is too short for serialization");
     }
     
+    *((uint32_t*)(buffer + pos)) = GADGETRON_CLOUDBUS_NODE_INFO_VERSION; pos += 4;
+
     *((uint32_t*)(buffer + pos)) = n.uuid.size(); pos += 4;
     memcpy ((buffer+pos), n.uuid.c_str(), n.uuid.size() ); pos += n.uuid.size();
 
@@ -31,6 +34,7 @@ namespace Gadgetron
     *((uint32_t*)(buffer + pos)) = n.rest_port; pos += 4;
     *((uint32_t*)(buffer + pos)) = n.compute_capability; pos += 4;
     *((uint32_t*)(buffer + pos)) = n.active_reconstructions; pos += 4;
+    *((uint32_t*)(buffer + pos)) = n.queue_length; pos += 4;
     *((std::time_t*)(buffer + pos)) = n.last_recon; pos += sizeof(std::time_t);
     
     return pos;
@@ -40,7 +44,12 @@ namespace Gadgetron
   {
     size_t pos = 0;
     
-    if (buf_len < 16) throw std::runtime_error("Provided buffer is too small to hold node info");
+    if (buf_len < 20) throw std::runtime_error("Provided buffer is too small to hold node info");
+
+    uint32_t version = *((uint32_t*)(buffer+pos)); pos += 4;
+    if (version != GADGETRON_CLOUDBUS_NODE_INFO_VERSION) {
+      throw std::runtime_error("Node info was serialized with a different cloudbus version");
+    }
 
     size_t uuid_size = *((uint32_t*)(buffer+pos)); pos += 4;
     n.uuid = std::string(buffer+pos,uuid_size); pos += uuid_size;
@@ -52,6 +61,7 @@ namespace Gadgetron
     n.rest_port = *((uint32_t*)(buffer+pos)); pos += 4;
     n.compute_capability = *((uint32_t*)(buffer+pos)); pos += 4;
     n.active_reconstructions = *((uint32_t*)(buffer+pos)); pos += 4;
+    n.queue_length = *((uint32_t*)(buffer+pos)); pos += 4;
     n.last_recon = *((std::time_t*)(buffer+pos)); pos += sizeof(std::time_t);
     return pos;
   }
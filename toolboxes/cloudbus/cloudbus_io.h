@@ -8,6 +8,7 @@
 #include <chrono>
 #include <ctime>
 #include <stdexcept>
+#include <cstdint>
 
 #include "cloudbus_export.h"
 
@@ -21,6 +22,9 @@ namespace Gadgetron
     GADGETRON_CLOUDBUS_NODE_LIST_REPLY = 3,
     GADGETRON_CLOUDBUS_MESSAGE_MAX
   };
+
+  //Written in front of every serialized node info, nodes with a different version are rejected
+  const uint32_t GADGETRON_CLOUDBUS_NODE_INFO_VERSION = 2;
   
   struct EXPORTCLOUDBUS GadgetronNodeInfo
   {
@@ -30,6 +34,7 @@ namespace Gadgetron
     uint32_t rest_port;
     uint32_t compute_capability;
     uint32_t active_reconstructions;
+    uint32_t queue_length; //Messages waiting in the gadget queues of the node
     std::time_t last_recon;
   };
 
@@ -68,8 +68,8 @@ namespace Gadgetron{
       auto t = std::chrono::system_clock::from_time_t(n.last_recon);
       std::chrono::duration<double> time_since_last_recon =
 	std::chrono::system_clock::now() - t;
-      GDEBUG("Adding node: %s, %s, %d, (active reconstructions: %d, last recon %f s)\n",
-	     n.uuid.c_str(), n.address.c_str(), n.port, n.active_reconstructions, time_since_last_recon.count());
+      GDEBUG("Adding node: %s, %s, %d, (active reconstructions: %d, queue length: %d, last recon %f s)\n",
+	     n.uuid.c_str(), n.address.c_str(), n.port, n.active_reconstructions, n.queue_length, time_since_last_recon.count());
       node_map_[c] = n;
       mtx_.release();
     }
@@ -165,7 +165,12 @@ namespace Gadgetron{
       switch (msg_id) {
       case (GADGETRON_CLOUDBUS_NODE_INFO):
 
-	deserialize(n,buffer+4,msg_size-4);
+	try {
+	  deserialize(n,buffer+4,msg_size-4);
+	} catch (std::runtime_error& e) {
+	  GERROR("Rejecting node info: %s\n", e.what());
+	  break;
+	}
 
 	//We will change the host name to the actually connected peer address since the relay host may not be able to resolve the host name
 	if (peer().get_remote_addr (peer_addr) == 0) {
@@ -312,6 +317,7 @@ int main(int argc, char** argv)
 				     out["nodes"][idx]["rest_port"] = n.rest_port;
 				     out["nodes"][idx]["compute_capability"] = n.compute_capability;
 				     out["nodes"][idx]["active_reconstructions"] = n.active_reconstructions;
+				     out["nodes"][idx]["queue_length"] = n.queue_length;
 				     auto t = std::chrono::system_clock::from_time_t(n.last_recon);
 				     std::chrono::duration<double> time_since_last_recon =
 				       std::chrono::system_clock::now() - t;
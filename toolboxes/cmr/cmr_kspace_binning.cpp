@@ -103,6 +103,8 @@ CmrKSpaceBinning<T>::CmrKSpaceBinning()
     respiratory_navigator_patch_step_size_RO_ = 10;
     respiratory_navigator_patch_step_size_E1_ = 10;
 
+    pipeline_binning_recon_ = true;
+
     kspace_binning_interpolate_heart_beat_images_ = true;
 
     kspace_binning_navigator_acceptance_window_ = 0.65;
@@ -158,6 +160,11 @@ void CmrKSpaceBinning<T>::process_binning_recon()
 
         if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace, debug_folder_ + "binning_kspace");
 
+        stage_timing_.clear();
+
+        Gadgetron::GadgetronTimer timer_total(false);
+        if ( this->perform_timing_ ) { timer_total.start("process_binning_recon ... "); }
+
         // -----------------------------------------------------
         // perform the raw data recon
         // -----------------------------------------------------
@@ -165,7 +172,7 @@ void CmrKSpaceBinning<T>::process_binning_recon()
 
         this->perform_raw_data_recon();
 
-        if ( this->perform_timing_ ) { gt_timer_.stop(); }
+        if ( this->perform_timing_ ) { this->add_stage_timing("raw data recon", gt_timer_.stop()); }
 
         if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(binning_obj_.full_kspace_raw_, debug_folder_ + "full_kspace_raw");
         if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(binning_obj_.complex_image_raw_, debug_folder_ + "complex_image_raw");
@@ -182,7 +189,7 @@ void CmrKSpaceBinning<T>::process_binning_recon()
 
         this->estimate_time_stamps();
 
-        if ( this->perform_timing_ ) { gt_timer_.stop(); }
+        if ( this->perform_timing_ ) { this->add_stage_timing("estimate time stamps", gt_timer_.stop()); }
 
         if ( !debug_folder_.empty() ) gt_exporter_.export_array(binning_obj_.time_stamp_, debug_folder_ + "time_stamp");
         if ( !debug_folder_.empty() ) gt_exporter_.export_array(binning_obj_.cpt_time_stamp_, debug_folder_ + "cpt_time_stamp");
@@ -207,13 +214,15 @@ void CmrKSpaceBinning<T>::process_binning_recon()
                 Gadgetron::fill(binning_obj_.navigator_, 1.0f);
             }
         }
-        if ( this->perform_timing_ ) { gt_timer_.stop(); }
+        if ( this->perform_timing_ ) { this->add_stage_timing("estimate respiratory navigator", gt_timer_.stop()); }
 
         if ( !debug_folder_.empty() ) gt_exporter_.export_array(binning_obj_.navigator_, debug_folder_ + "respiratory_navigator");
 
         // -----------------------------------------------------
         // find the best heart beat from the respiratory navigator
         // -----------------------------------------------------
+        if ( this->perform_timing_ ) { gt_timer_.start("find best heart beat ... "); }
+
         std::vector<size_t> bestHB;
         this->find_best_heart_beat(bestHB);
 
@@ -222,6 +231,8 @@ void CmrKSpaceBinning<T>::process_binning_recon()
         // -----------------------------------------------------
         this->reject_irregular_heart_beat();
 
+        if ( this->perform_timing_ ) { this->add_stage_timing("find best heart beat", gt_timer_.stop()); }
+
         // -----------------------------------------------------
         // release some memory to reduce peak RAM usage
         // -----------------------------------------------------
@@ -233,13 +244,34 @@ void CmrKSpaceBinning<T>::process_binning_recon()
         // all time stamps and raw full kspace is filled now
         // binning can be performed
         std::vector<size_t> slices_not_processing;
-        this->compute_kspace_binning(bestHB, slices_not_processing);
-        if(binning_obj_.full_kspace_raw_.delete_data_on_destruct()) binning_obj_.full_kspace_raw_.clear();
 
-        // -----------------------------------------------------
-        // perform recon on the binned kspace 
-        // -----------------------------------------------------
-        this->perform_recon_binned_kspace(slices_not_processing);
+        if ( this->pipeline_binning_recon_ && this->kspace_binning_interpolate_heart_beat_images_ )
+        {
+            // binning of slice s overlaps the recon of slice s-1
+            this->perform_binning_recon_pipelined(bestHB, slices_not_processing);
+        }
+        else
+        {
+            this->compute_kspace_binning(bestHB, slices_not_processing);
+            if(binning_obj_.full_kspace_raw_.delete_data_on_destruct()) binning_obj_.full_kspace_raw_.clear();
+
+            // -----------------------------------------------------
+            // perform recon on the binned kspace 
+            // -----------------------------------------------------
+            this->perform_recon_binned_kspace(slices_not_processing);
+        }
+
+        if ( this->perform_timing_ )
+        {
+            double total = timer_total.stop();
+
+            GDEBUG_STREAM("CmrKSpaceBinning, time spent in every stage : ");
+            for (size_t ii=0; ii<stage_timing_.size(); ii++)
+            {
+                GDEBUG_STREAM("    " << stage_timing_[ii].first << " : " << stage_timing_[ii].second << " ms");
+            }
+            GDEBUG_STREAM("    total : " << total/1000.0 << " ms");
+        }
     }
     catch(...)
     {
@@ -1366,21 +1398,18 @@ void CmrKSpaceBinning<T>::compute_metrics_navigator_heart_beat(size_t s, size_t
 }
 
 template <typename T> 
-void CmrKSpaceBinning<T>::compute_kspace_binning(const std::vector<size_t>& bestHB, std::vector<size_t>& slices_not_processing)
+void CmrKSpaceBinning<T>::prepare_kspace_binning(hoNDArray<T>& mag)
 {
     try
     {
         ArrayType& full_kspace_raw = binning_obj_.full_kspace_raw_;
-        ArrayType& coil_map_raw = binning_obj_.coil_map_raw_;
         ArrayType& complex_image_raw = binning_obj_.complex_image_raw_;
 
         size_t RO = full_kspace_raw.get_size(0);
         size_t E1 = full_kspace_raw.get_size(1);
         size_t CHA = full_kspace_raw.get_size(2);
-        size_t N = full_kspace_raw.get_size(3);
         size_t S = full_kspace_raw.get_size(4);
 
-        hoNDArray<T> mag;
         Gadgetron::abs(complex_image_raw, mag);
 
         if ( !debug_folder_.empty() ) gt_exporter_.export_array(mag, debug_folder_ + "complex_image_raw_mag");
@@ -1397,345 +1426,388 @@ void CmrKSpaceBinning<T>::compute_kspace_binning(const std::vector<size_t>& best
 
         binning_obj_.kspace_binning_hit_count_.create(E1, dstN, S);
         Gadgetron::clear(binning_obj_.kspace_binning_hit_count_);
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::prepare_kspace_binning() ... ");
+    }
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::compute_kspace_binning(const std::vector<size_t>& bestHB, std::vector<size_t>& slices_not_processing)
+{
+    try
+    {
+        size_t S = binning_obj_.full_kspace_raw_.get_size(4);
+
+        hoNDArray<T> mag;
+        this->prepare_kspace_binning(mag);
 
         slices_not_processing.clear();
 
-        size_t e1, n, s, ii;
+        size_t s;
 
         if(this->kspace_binning_interpolate_heart_beat_images_)
         {
             for (s=0; s<S; s++)
             {
-                std::stringstream os;
-                os << "_S_" << s;
+                this->compute_kspace_binning_slice(s, bestHB[s], mag, slices_not_processing);
+            }
+        }
+        else
+        {
+            // to be implemented
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::compute_kspace_binning() ... ");
+    }
+}
 
-                size_t bestHB_S = bestHB[s];
+template <typename T> 
+void CmrKSpaceBinning<T>::compute_kspace_binning_slice(size_t s, size_t bestHB_S, const hoNDArray<T>& mag, std::vector<size_t>& slices_not_processing)
+{
+    try
+    {
+        ArrayType& full_kspace_raw = binning_obj_.full_kspace_raw_;
+        ArrayType& coil_map_raw = binning_obj_.coil_map_raw_;
+        ArrayType& complex_image_raw = binning_obj_.complex_image_raw_;
 
-                size_t startE1 = binning_obj_.starting_heart_beat_[s][bestHB_S].first;
-                size_t startN = binning_obj_.starting_heart_beat_[s][bestHB_S].second;
+        size_t RO = full_kspace_raw.get_size(0);
+        size_t E1 = full_kspace_raw.get_size(1);
+        size_t CHA = full_kspace_raw.get_size(2);
+        size_t N = full_kspace_raw.get_size(3);
 
-                size_t endE1 = binning_obj_.ending_heart_beat_[s][bestHB_S].first;
-                size_t endN = binning_obj_.ending_heart_beat_[s][bestHB_S].second;
+        size_t dstN = binning_obj_.output_N_;
 
-                size_t ori_endN = endN;
-                size_t ori_startN = endN;
+        size_t n, ii;
 
-                // avoid cross the RR wav
-                if ( binning_obj_.phs_cpt_time_stamp_(startN, s) > binning_obj_.phs_cpt_time_stamp_(startN+1, s) )
-                {
-                    startN++;
-                }
+        // local timer, the recon of the previous slice may be running
+        Gadgetron::GadgetronTimer timer(false);
 
-                if ( binning_obj_.phs_cpt_time_stamp_(endN, s) < binning_obj_.phs_cpt_time_stamp_(endN-1, s) )
-                {
-                    endN--;
-                }
+        std::stringstream os;
+        os << "_S_" << s;
 
-                if ( endN <= startN )
-                {
-                    GERROR_STREAM("KSpace binning for S " << s << " - endN <= startN - " << endN << " <= " << startN );
-                    GWARN_STREAM("Please consider to reduce temporal footprint of raw image series, if heart rate is too high ... " );
+        size_t startE1 = binning_obj_.starting_heart_beat_[s][bestHB_S].first;
+        size_t startN = binning_obj_.starting_heart_beat_[s][bestHB_S].second;
 
-                    endN = ori_endN;
-                    startN = ori_startN;
+        size_t endE1 = binning_obj_.ending_heart_beat_[s][bestHB_S].first;
+        size_t endN = binning_obj_.ending_heart_beat_[s][bestHB_S].second;
 
-                    if ( endN <= startN )
-                    {
-                        GERROR_STREAM("KSpace binning for S " << s << " - endN <= startN - " << endN << " <= " << startN );
-                        GERROR_STREAM("Slice " << s << " will not be processed ... ");
-                        slices_not_processing.push_back(s);
-                        continue;
-                    }
-                }
+        size_t ori_endN = endN;
+        size_t ori_startN = endN;
 
-                // ----------------------------------------
-                // get the best HB mag images
-                // ----------------------------------------
-                size_t num_images_bestHB = endN - startN + 1;
-                hoNDArray<T> mag_bestHB(RO, E1, num_images_bestHB, mag.begin()+s*RO*E1*N+startN*RO*E1);
+        // avoid cross the RR wav
+        if ( binning_obj_.phs_cpt_time_stamp_(startN, s) > binning_obj_.phs_cpt_time_stamp_(startN+1, s) )
+        {
+            startN++;
+        }
 
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array(mag_bestHB, debug_folder_ + "mag_bestHB" + os.str());
+        if ( binning_obj_.phs_cpt_time_stamp_(endN, s) < binning_obj_.phs_cpt_time_stamp_(endN-1, s) )
+        {
+            endN--;
+        }
 
-                // ----------------------------------------
-                // get the respiratory location of the best HB
-                // ----------------------------------------
-                float mean_resp_bestHB(0), var_resp_bestHB(0), min_resp_bestHB(0), max_resp_bestHB(0);
-                this->compute_metrics_navigator_heart_beat(s, bestHB[s], mean_resp_bestHB, var_resp_bestHB, min_resp_bestHB, max_resp_bestHB);
+        if ( endN <= startN )
+        {
+            GERROR_STREAM("KSpace binning for S " << s << " - endN <= startN - " << endN << " <= " << startN );
+            GWARN_STREAM("Please consider to reduce temporal footprint of raw image series, if heart rate is too high ... " );
 
-                float min_resp(0), max_resp(0);
+            endN = ori_endN;
+            startN = ori_startN;
 
-                hoNDArray<float> navigator_S(E1, N, binning_obj_.navigator_.begin()+s*E1*N);
-                min_resp = Gadgetron::min(&navigator_S);
-                max_resp = Gadgetron::max(&navigator_S);
+            if ( endN <= startN )
+            {
+                GERROR_STREAM("KSpace binning for S " << s << " - endN <= startN - " << endN << " <= " << startN );
+                GERROR_STREAM("Slice " << s << " will not be processed ... ");
+                slices_not_processing.push_back(s);
+                return;
+            }
+        }
 
-                // ----------------------------------------
-                // interpolate best HB images to desired cardiac time ratio
-                // ----------------------------------------
-                std::vector<float> cpt_time_ratio_bestHB(num_images_bestHB);
-                for ( n=startN; n<=endN; n++ )
-                {
-                    cpt_time_ratio_bestHB[n-startN] = binning_obj_.phs_cpt_time_ratio_(n, s);
-                }
+        // ----------------------------------------
+        // get the best HB mag images
+        // ----------------------------------------
+        size_t num_images_bestHB = endN - startN + 1;
+        hoNDArray<T> mag_bestHB(RO, E1, num_images_bestHB, const_cast<T*>(mag.begin())+s*RO*E1*N+startN*RO*E1);
 
-                hoNDArray<T> mag_bestHB_at_desired_cpt;
-                this->interpolate_best_HB_images(cpt_time_ratio_bestHB, mag_bestHB, binning_obj_.desired_cpt_, mag_bestHB_at_desired_cpt);
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array(mag_bestHB, debug_folder_ + "mag_bestHB" + os.str());
 
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array(mag_bestHB_at_desired_cpt, debug_folder_ + "mag_bestHB_at_desired_cpt" + os.str());
+        // ----------------------------------------
+        // get the respiratory location of the best HB
+        // ----------------------------------------
+        float mean_resp_bestHB(0), var_resp_bestHB(0), min_resp_bestHB(0), max_resp_bestHB(0);
+        this->compute_metrics_navigator_heart_beat(s, bestHB_S, mean_resp_bestHB, var_resp_bestHB, min_resp_bestHB, max_resp_bestHB);
 
-                // ----------------------------------------
-                // compute acceptance range
-                // ----------------------------------------
-                float accepted_nav_wider[2];
+        float min_resp(0), max_resp(0);
 
-                float wider_nav_window = 1.3*this->kspace_binning_navigator_acceptance_window_;
-                if (wider_nav_window>= 0.85) wider_nav_window = 0.85;
+        hoNDArray<float> navigator_S(E1, N, binning_obj_.navigator_.begin()+s*E1*N);
+        min_resp = Gadgetron::min(&navigator_S);
+        max_resp = Gadgetron::max(&navigator_S);
 
-                accepted_nav_wider[0] = (float)(mean_resp_bestHB - 0.5*wider_nav_window*(max_resp-min_resp));
-                accepted_nav_wider[1] = (float)(mean_resp_bestHB + 0.5*wider_nav_window*(max_resp-min_resp));
+        // ----------------------------------------
+        // interpolate best HB images to desired cardiac time ratio
+        // ----------------------------------------
+        std::vector<float> cpt_time_ratio_bestHB(num_images_bestHB);
+        for ( n=startN; n<=endN; n++ )
+        {
+            cpt_time_ratio_bestHB[n-startN] = binning_obj_.phs_cpt_time_ratio_(n, s);
+        }
 
-                if ( accepted_nav_wider[0] < min_resp )
-                {
-                    float delta = min_resp-accepted_nav_wider[0];
-                    accepted_nav_wider[0] += delta;
-                    accepted_nav_wider[1] += delta;
-                }
+        hoNDArray<T> mag_bestHB_at_desired_cpt;
+        this->interpolate_best_HB_images(cpt_time_ratio_bestHB, mag_bestHB, binning_obj_.desired_cpt_, mag_bestHB_at_desired_cpt);
 
-                if ( accepted_nav_wider[1] > max_resp )
-                {
-                    float delta = accepted_nav_wider[1] - max_resp;
-                    accepted_nav_wider[0] -= delta;
-                    accepted_nav_wider[1] -= delta;
-                }
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array(mag_bestHB_at_desired_cpt, debug_folder_ + "mag_bestHB_at_desired_cpt" + os.str());
 
-                // ------------------------------------------------
+        // ----------------------------------------
+        // compute acceptance range
+        // ----------------------------------------
+        float accepted_nav_wider[2];
 
-                float accepted_nav[2];
-                accepted_nav[0] = (float)(mean_resp_bestHB - 0.5*this->kspace_binning_navigator_acceptance_window_*(max_resp-min_resp));
-                accepted_nav[1] = (float)(mean_resp_bestHB + 0.5*this->kspace_binning_navigator_acceptance_window_*(max_resp-min_resp));
+        float wider_nav_window = 1.3*this->kspace_binning_navigator_acceptance_window_;
+        if (wider_nav_window>= 0.85) wider_nav_window = 0.85;
 
-                if ( accepted_nav[0] < min_resp )
-                {
-                    float delta = min_resp-accepted_nav[0];
-                    accepted_nav[0] += delta;
-                    accepted_nav[1] += delta;
-                }
+        accepted_nav_wider[0] = (float)(mean_resp_bestHB - 0.5*wider_nav_window*(max_resp-min_resp));
+        accepted_nav_wider[1] = (float)(mean_resp_bestHB + 0.5*wider_nav_window*(max_resp-min_resp));
 
-                if ( accepted_nav[1] > max_resp )
-                {
-                    float delta = accepted_nav[1] - max_resp;
-                    accepted_nav[0] -= delta;
-                    accepted_nav[1] -= delta;
-                }
+        if ( accepted_nav_wider[0] < min_resp )
+        {
+            float delta = min_resp-accepted_nav_wider[0];
+            accepted_nav_wider[0] += delta;
+            accepted_nav_wider[1] += delta;
+        }
 
-                // ----------------------------------------
-                // for every destination N, compute images falling into its bin
-                // ----------------------------------------
-                std::vector < std::vector<size_t> > selected_images_wider(dstN);
-                std::vector < std::vector<size_t> > selected_images(dstN);
-                for (n=0; n<dstN; n++)
-                {
-                    float desired_cpt_time_ratio = binning_obj_.desired_cpt_[n];
+        if ( accepted_nav_wider[1] > max_resp )
+        {
+            float delta = accepted_nav_wider[1] - max_resp;
+            accepted_nav_wider[0] -= delta;
+            accepted_nav_wider[1] -= delta;
+        }
 
-                    std::vector<size_t> selected;
+        // ------------------------------------------------
 
-                    this->select_images_with_navigator(desired_cpt_time_ratio, accepted_nav_wider, n, s, selected);
-                    selected_images_wider[n] = selected;
+        float accepted_nav[2];
+        accepted_nav[0] = (float)(mean_resp_bestHB - 0.5*this->kspace_binning_navigator_acceptance_window_*(max_resp-min_resp));
+        accepted_nav[1] = (float)(mean_resp_bestHB + 0.5*this->kspace_binning_navigator_acceptance_window_*(max_resp-min_resp));
 
-                    // --------------------------
+        if ( accepted_nav[0] < min_resp )
+        {
+            float delta = min_resp-accepted_nav[0];
+            accepted_nav[0] += delta;
+            accepted_nav[1] += delta;
+        }
 
-                    size_t num = selected_images_wider[n].size();
-                    for (size_t jj=0; jj<num; jj++)
-                    {
-                        float nav = binning_obj_.navigator_(E1/2, selected_images_wider[n][jj], s);
+        if ( accepted_nav[1] > max_resp )
+        {
+            float delta = accepted_nav[1] - max_resp;
+            accepted_nav[0] -= delta;
+            accepted_nav[1] -= delta;
+        }
 
-                        if(nav>=accepted_nav[0] && nav<=accepted_nav[1])
-                        {
-                            selected_images[n].push_back(selected_images_wider[n][jj]);
-                        }
-                    }
+        // ----------------------------------------
+        // for every destination N, compute images falling into its bin
+        // ----------------------------------------
+        std::vector < std::vector<size_t> > selected_images_wider(dstN);
+        std::vector < std::vector<size_t> > selected_images(dstN);
+        for (n=0; n<dstN; n++)
+        {
+            float desired_cpt_time_ratio = binning_obj_.desired_cpt_[n];
+
+            std::vector<size_t> selected;
 
-                    GDEBUG_CONDITION_STREAM(this->verbose_, "num of images selected for [n, s] : [" << n << ", " << s << "] is " << selected_images[n].size() << " out of " << selected_images_wider[n].size());
+            this->select_images_with_navigator(desired_cpt_time_ratio, accepted_nav_wider, n, s, selected);
+            selected_images_wider[n] = selected;
+
+            // --------------------------
+
+            size_t num = selected_images_wider[n].size();
+            for (size_t jj=0; jj<num; jj++)
+            {
+                float nav = binning_obj_.navigator_(E1/2, selected_images_wider[n][jj], s);
+
+                if(nav>=accepted_nav[0] && nav<=accepted_nav[1])
+                {
+                    selected_images[n].push_back(selected_images_wider[n][jj]);
                 }
+            }
 
-                // ----------------------------------------
-                // perform motion correction to compute deformation fields
-                // ----------------------------------------
-                hoNDArray<T> mag_s(RO, E1, N, mag.begin()+s*RO*E1*N);
-                DeformationFieldContinerType deform[2];
+            GDEBUG_CONDITION_STREAM(this->verbose_, "num of images selected for [n, s] : [" << n << ", " << s << "] is " << selected_images[n].size() << " out of " << selected_images_wider[n].size());
+        }
 
-                if ( this->perform_timing_ ) { gt_timer_local_.start("perform_moco_selected_images_with_best_heart_beat ... "); }
-                this->perform_moco_selected_images_with_best_heart_beat(selected_images_wider, mag_s, mag_bestHB_at_desired_cpt, deform[0], deform[1]);
-                if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
+        // ----------------------------------------
+        // perform motion correction to compute deformation fields
+        // ----------------------------------------
+        hoNDArray<T> mag_s(RO, E1, N, const_cast<T*>(mag.begin())+s*RO*E1*N);
+        DeformationFieldContinerType deform[2];
 
-                // ----------------------------------------
-                // for every output N, warp the complex images
-                // ----------------------------------------
-                ArrayType complex_image(RO, E1, N, complex_image_raw.begin()+s*RO*E1*N);
-                std::vector<ArrayType> warpped_complex_images_wider;
+        if ( this->perform_timing_ ) { timer.start("perform_moco_selected_images_with_best_heart_beat ... "); }
+        this->perform_moco_selected_images_with_best_heart_beat(selected_images_wider, mag_s, mag_bestHB_at_desired_cpt, deform[0], deform[1]);
+        if ( this->perform_timing_ ) { this->add_stage_timing("kspace binning, moco", timer.stop()); }
 
-                if ( this->perform_timing_ ) { gt_timer_local_.start("perform_moco_warp_on_selected_images ... "); }
-                this->perform_moco_warp_on_selected_images(selected_images_wider, complex_image, deform, warpped_complex_images_wider);
-                if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
+        // ----------------------------------------
+        // for every output N, warp the complex images
+        // ----------------------------------------
+        ArrayType complex_image(RO, E1, N, complex_image_raw.begin()+s*RO*E1*N);
+        std::vector<ArrayType> warpped_complex_images_wider;
 
-                if ( !debug_folder_.empty() )
-                {
-                    for (n=0; n<dstN; n++)
-                    {
-                        std::stringstream os_local;
-                        os_local << "_N_" << n << "_S_" << s;
+        if ( this->perform_timing_ ) { timer.start("perform_moco_warp_on_selected_images ... "); }
+        this->perform_moco_warp_on_selected_images(selected_images_wider, complex_image, deform, warpped_complex_images_wider);
+        if ( this->perform_timing_ ) { this->add_stage_timing("kspace binning, warp", timer.stop()); }
 
-                        gt_exporter_.export_array_complex(warpped_complex_images_wider[n], debug_folder_ + "warpped_complex_images" + os_local.str());
-                    }
-                }
+        if ( !debug_folder_.empty() )
+        {
+            for (n=0; n<dstN; n++)
+            {
+                std::stringstream os_local;
+                os_local << "_N_" << n << "_S_" << s;
 
-                std::vector< std::vector<size_t> > loc_in_wider(dstN);
-                for (n=0; n<dstN; n++)
-                {
-                    size_t num_of_images = selected_images[n].size();
-                    size_t num_of_images_wider = selected_images_wider[n].size();
+                gt_exporter_.export_array_complex(warpped_complex_images_wider[n], debug_folder_ + "warpped_complex_images" + os_local.str());
+            }
+        }
 
-                    loc_in_wider[n].resize(num_of_images, 0);
+        std::vector< std::vector<size_t> > loc_in_wider(dstN);
+        for (n=0; n<dstN; n++)
+        {
+            size_t num_of_images = selected_images[n].size();
+            size_t num_of_images_wider = selected_images_wider[n].size();
 
-                    size_t ind;
-                    for (ii=0; ii<num_of_images; ii++)
+            loc_in_wider[n].resize(num_of_images, 0);
+
+            size_t ind;
+            for (ii=0; ii<num_of_images; ii++)
+            {
+                size_t jj;
+                for (jj=0; jj<num_of_images_wider; jj++)
+                {
+                    if(selected_images_wider[n][jj]==selected_images[n][ii])
                     {
-                        size_t jj;
-                        for (jj=0; jj<num_of_images_wider; jj++)
-                        {
-                            if(selected_images_wider[n][jj]==selected_images[n][ii])
-                            {
-                                loc_in_wider[n][ii] = jj;
-                                break;
-                            }
-                        }
+                        loc_in_wider[n][ii] = jj;
+                        break;
                     }
                 }
+            }
+        }
 
-                // ----------------------------------------
-                // go back to multi-channel and fill the binning kspace
-                // ----------------------------------------
-                ArrayType kspace_binning(RO, E1, CHA, dstN, binning_obj_.kspace_binning_.begin()+s*RO*E1*CHA*dstN);
-                ArrayType kspace_binning_wider(RO, E1, CHA, dstN, binning_obj_.kspace_binning_wider_.begin()+s*RO*E1*CHA*dstN);
-                ArrayType kspace_binning_image_domain_average(RO, E1, CHA, dstN, binning_obj_.kspace_binning_image_domain_average_.begin()+s*RO*E1*CHA*dstN);
-                hoNDArray< float > kspace_binning_hit_count(E1, dstN, binning_obj_.kspace_binning_hit_count_.begin()+s*E1*dstN);
+        // ----------------------------------------
+        // go back to multi-channel and fill the binning kspace
+        // ----------------------------------------
+        ArrayType kspace_binning(RO, E1, CHA, dstN, binning_obj_.kspace_binning_.begin()+s*RO*E1*CHA*dstN);
+        ArrayType kspace_binning_wider(RO, E1, CHA, dstN, binning_obj_.kspace_binning_wider_.begin()+s*RO*E1*CHA*dstN);
+        ArrayType kspace_binning_image_domain_average(RO, E1, CHA, dstN, binning_obj_.kspace_binning_image_domain_average_.begin()+s*RO*E1*CHA*dstN);
+        hoNDArray< float > kspace_binning_hit_count(E1, dstN, binning_obj_.kspace_binning_hit_count_.begin()+s*E1*dstN);
 
-                ArrayType coil_map(RO, E1, CHA, coil_map_raw.begin());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(coil_map, debug_folder_ + "coil_map" + os.str());
+        ArrayType coil_map(RO, E1, CHA, coil_map_raw.begin());
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(coil_map, debug_folder_ + "coil_map" + os.str());
 
-                ArrayType complexIm(RO, E1, CHA);
+        ArrayType complexIm(RO, E1, CHA);
 
-                ArrayType kspace_filled(RO, E1, CHA);
-                hoNDArray< float > hit_count(E1);
+        ArrayType kspace_filled(RO, E1, CHA);
+        hoNDArray< float > hit_count(E1);
 
-                for (n=0; n<dstN; n++)
-                {
-                    GDEBUG_CONDITION_STREAM(this->verbose_, "Perform binning on step = " << n << " out of " << dstN);
+        for (n=0; n<dstN; n++)
+        {
+            GDEBUG_CONDITION_STREAM(this->verbose_, "Perform binning on step = " << n << " out of " << dstN);
 
-                    ArrayType warpped_complex_images_multi_channel_wider;
-                    ArrayType warpped_complex_images_multi_channel_image_domain_average_wider;
+            ArrayType warpped_complex_images_multi_channel_wider;
+            ArrayType warpped_complex_images_multi_channel_image_domain_average_wider;
 
-                    size_t num_selected_image_wider = selected_images_wider[n].size();
+            size_t num_selected_image_wider = selected_images_wider[n].size();
 
-                    if(CHA>1)
-                    {
-                        // go back to multi-channel
-                        if ( this->perform_timing_ ) { gt_timer_local_.start("go back to multi-channel ... "); }
+            if(CHA>1)
+            {
+                // go back to multi-channel
+                if ( this->perform_timing_ ) { timer.start("go back to multi-channel ... "); }
 
-                        warpped_complex_images_multi_channel_wider.create(RO, E1, CHA, num_selected_image_wider);
+                warpped_complex_images_multi_channel_wider.create(RO, E1, CHA, num_selected_image_wider);
 
-                        for (size_t ii=0; ii<num_selected_image_wider; ii++)
-                        {
-                            ArrayType complexIm2D(RO, E1, warpped_complex_images_wider[n].begin()+ii*RO*E1);
-                            Gadgetron::multiply(coil_map, complexIm2D, complexIm);
-                            memcpy(warpped_complex_images_multi_channel_wider.begin()+ii*RO*E1*CHA, complexIm.begin(), complexIm.get_number_of_bytes());
-                        }
+                for (size_t ii=0; ii<num_selected_image_wider; ii++)
+                {
+                    ArrayType complexIm2D(RO, E1, warpped_complex_images_wider[n].begin()+ii*RO*E1);
+                    Gadgetron::multiply(coil_map, complexIm2D, complexIm);
+                    memcpy(warpped_complex_images_multi_channel_wider.begin()+ii*RO*E1*CHA, complexIm.begin(), complexIm.get_number_of_bytes());
+                }
 
-                        if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
-                    }
-                    else
-                    {
-                        warpped_complex_images_multi_channel_wider.create(RO, E1, 1, num_selected_image_wider);
+                if ( this->perform_timing_ ) { this->add_stage_timing("kspace binning, multi-channel", timer.stop()); }
+            }
+            else
+            {
+                warpped_complex_images_multi_channel_wider.create(RO, E1, 1, num_selected_image_wider);
 
-                        for (size_t ii=0; ii<num_selected_image_wider; ii++)
-                        {
-                            memcpy(warpped_complex_images_multi_channel_wider.begin()+ii*RO*E1, complex_image.begin() + selected_images_wider[n][ii]*RO*E1, complexIm.get_number_of_bytes());
-                        }
-                    }
+                for (size_t ii=0; ii<num_selected_image_wider; ii++)
+                {
+                    memcpy(warpped_complex_images_multi_channel_wider.begin()+ii*RO*E1, complex_image.begin() + selected_images_wider[n][ii]*RO*E1, complexIm.get_number_of_bytes());
+                }
+            }
 
-                    if ( !debug_folder_.empty() )
-                    {
-                        std::stringstream os_local;
-                        os_local << "_N_" << n << "_S_" << s;
+            if ( !debug_folder_.empty() )
+            {
+                std::stringstream os_local;
+                os_local << "_N_" << n << "_S_" << s;
 
-                        gt_exporter_.export_array_complex(warpped_complex_images_multi_channel_wider, debug_folder_ + "warpped_complex_images_multi_channel" + os_local.str());
-                    }
+                gt_exporter_.export_array_complex(warpped_complex_images_multi_channel_wider, debug_folder_ + "warpped_complex_images_multi_channel" + os_local.str());
+            }
 
-                    // average across all N
-                    Gadgetron::sum_over_dimension(warpped_complex_images_multi_channel_wider, warpped_complex_images_multi_channel_image_domain_average_wider, 3);
-                    Gadgetron::scal( (T)(1.0/num_selected_image_wider), warpped_complex_images_multi_channel_image_domain_average_wider);
+            // average across all N
+            Gadgetron::sum_over_dimension(warpped_complex_images_multi_channel_wider, warpped_complex_images_multi_channel_image_domain_average_wider, 3);
+            Gadgetron::scal( (T)(1.0/num_selected_image_wider), warpped_complex_images_multi_channel_image_domain_average_wider);
 
-                    if ( !debug_folder_.empty() )
-                    {
-                        std::stringstream os_local;
-                        os_local << "_N_" << n << "_S_" << s;
+            if ( !debug_folder_.empty() )
+            {
+                std::stringstream os_local;
+                os_local << "_N_" << n << "_S_" << s;
 
-                        gt_exporter_.export_array_complex(warpped_complex_images_multi_channel_image_domain_average_wider, debug_folder_ + "warpped_complex_images_multi_channel_image_domain_average" + os_local.str());
-                    }
+                gt_exporter_.export_array_complex(warpped_complex_images_multi_channel_image_domain_average_wider, debug_folder_ + "warpped_complex_images_multi_channel_image_domain_average" + os_local.str());
+            }
 
-                    // go back to kspace
-                    if ( this->perform_timing_ ) { gt_timer_local_.start("go back to kspace ... "); }
-                    Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(warpped_complex_images_multi_channel_wider);
-                    if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
+            // go back to kspace
+            if ( this->perform_timing_ ) { timer.start("go back to kspace ... "); }
+            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(warpped_complex_images_multi_channel_wider);
+            if ( this->perform_timing_ ) { this->add_stage_timing("kspace binning, fft", timer.stop()); }
 
-                    // fill the binned kspace
-                    if ( this->perform_timing_ ) { gt_timer_local_.start("fill the binned kspace ... "); }
-                    this->fill_binned_kspace(s, n, selected_images_wider[n], warpped_complex_images_multi_channel_wider, kspace_filled, hit_count);
-                    if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
+            // fill the binned kspace
+            if ( this->perform_timing_ ) { timer.start("fill the binned kspace ... "); }
+            this->fill_binned_kspace(s, n, selected_images_wider[n], warpped_complex_images_multi_channel_wider, kspace_filled, hit_count);
+            if ( this->perform_timing_ ) { this->add_stage_timing("kspace binning, fill", timer.stop()); }
 
-                    // copy results
-                    memcpy(kspace_binning_wider.begin()+n*RO*E1*CHA, kspace_filled.begin(), kspace_filled.get_number_of_bytes());
-                    memcpy(kspace_binning_image_domain_average.begin()+n*RO*E1*CHA, warpped_complex_images_multi_channel_image_domain_average_wider.begin(), warpped_complex_images_multi_channel_image_domain_average_wider.get_number_of_bytes());
+            // copy results
+            memcpy(kspace_binning_wider.begin()+n*RO*E1*CHA, kspace_filled.begin(), kspace_filled.get_number_of_bytes());
+            memcpy(kspace_binning_image_domain_average.begin()+n*RO*E1*CHA, warpped_complex_images_multi_channel_image_domain_average_wider.begin(), warpped_complex_images_multi_channel_image_domain_average_wider.get_number_of_bytes());
 
-                    // ---------------------------------------------
+            // ---------------------------------------------
 
-                    size_t num_of_images = selected_images[n].size();
+            size_t num_of_images = selected_images[n].size();
 
-                    ArrayType warpped_complex_images_multi_channel;
-                    warpped_complex_images_multi_channel.create(RO, E1, CHA, num_of_images);
+            ArrayType warpped_complex_images_multi_channel;
+            warpped_complex_images_multi_channel.create(RO, E1, CHA, num_of_images);
 
-                    for (ii=0; ii<num_of_images; ii++)
-                    {
-                        memcpy(warpped_complex_images_multi_channel.begin()+ii*RO*E1*CHA, 
-                            warpped_complex_images_multi_channel_wider.begin()+loc_in_wider[n][ii]*RO*E1*CHA, 
-                            sizeof(std::complex<T>)*RO*E1*CHA);
-                    }
+            for (ii=0; ii<num_of_images; ii++)
+            {
+                memcpy(warpped_complex_images_multi_channel.begin()+ii*RO*E1*CHA, 
+                    warpped_complex_images_multi_channel_wider.begin()+loc_in_wider[n][ii]*RO*E1*CHA, 
+                    sizeof(std::complex<T>)*RO*E1*CHA);
+            }
 
-                    this->fill_binned_kspace(s, n, selected_images[n], warpped_complex_images_multi_channel, kspace_filled, hit_count);
+            this->fill_binned_kspace(s, n, selected_images[n], warpped_complex_images_multi_channel, kspace_filled, hit_count);
 
-                    memcpy(kspace_binning.begin()+n*RO*E1*CHA, kspace_filled.begin(), kspace_filled.get_number_of_bytes());
-                    memcpy(kspace_binning_hit_count.begin()+n*E1, hit_count.begin(), hit_count.get_number_of_bytes());
+            memcpy(kspace_binning.begin()+n*RO*E1*CHA, kspace_filled.begin(), kspace_filled.get_number_of_bytes());
+            memcpy(kspace_binning_hit_count.begin()+n*E1, hit_count.begin(), hit_count.get_number_of_bytes());
 
-                    GDEBUG_CONDITION_STREAM(this->verbose_, "==================================================================");
-                }
+            GDEBUG_CONDITION_STREAM(this->verbose_, "==================================================================");
+        }
 
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning_image_domain_average, debug_folder_ + "kspace_binning_image_domain_average_IMAGE" + os.str());
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning_image_domain_average, debug_folder_ + "kspace_binning_image_domain_average_IMAGE" + os.str());
 
-                Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(kspace_binning_image_domain_average);
+        Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->fft2c(kspace_binning_image_domain_average);
 
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning, debug_folder_ + "kspace_binning" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning_wider, debug_folder_ + "kspace_binning_wider" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning_image_domain_average, debug_folder_ + "kspace_binning_image_domain_average" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array(kspace_binning_hit_count, debug_folder_ + "kspace_binning_hit_count" + os.str());
-            }
-        }
-        else
-        {
-            // to be implemented
-        }
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning, debug_folder_ + "kspace_binning" + os.str());
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning_wider, debug_folder_ + "kspace_binning_wider" + os.str());
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning_image_domain_average, debug_folder_ + "kspace_binning_image_domain_average" + os.str());
+        if ( !debug_folder_.empty() ) gt_exporter_.export_array(kspace_binning_hit_count, debug_folder_ + "kspace_binning_hit_count" + os.str());
     }
     catch(...)
     {
-        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::compute_kspace_binning() ... ");
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::compute_kspace_binning_slice() ... ");
     }
 }
 
@@ -1997,7 +2069,9 @@ void CmrKSpaceBinning<T>::perform_moco_selected_images_with_best_heart_beat(cons
 
         std::vector<unsigned int> key_frame(dstN, 0);
 
-        Gadgetron::hoImageRegContainer2DRegistration<hoNDImage<float, 2>, hoNDImage<float, 2>, float> reg;
+        // all phases are registered in one container, every [phase, image] pair runs in parallel
+        // the workspace is kept for the next slice
+        RegContainer2DType& reg = this->moco_reg_;
 
         GDEBUG_STREAM("Perform moco against best heart beat : " << this->kspace_binning_moco_reg_strength_);
         GDEBUG_STREAM("MOCO iterations : ");
@@ -2285,6 +2359,50 @@ void CmrKSpaceBinning<T>::fill_binned_kspace(size_t s, size_t dst_n, const std::
 
 template <typename T> 
 void CmrKSpaceBinning<T>::perform_recon_binned_kspace(const std::vector<size_t>& slices_not_processing)
+{
+    try
+    {
+        ArrayType& kspace_binning = binning_obj_.kspace_binning_;
+        ArrayType& complex_image_binning = binning_obj_.complex_image_binning_;
+
+        size_t RO = kspace_binning.get_size(0);
+        size_t E1 = kspace_binning.get_size(1);
+        size_t N = kspace_binning.get_size(3);
+        size_t S = kspace_binning.get_size(4);
+
+        complex_image_binning.create(RO, E1, 1, N, S);
+        Gadgetron::clear(complex_image_binning);
+
+        size_t s;
+        for (s=0; s<S; s++)
+        {
+            bool not_processing = false;
+            for (size_t kk=0; kk<slices_not_processing.size(); kk++)
+            {
+                if(slices_not_processing[kk] == s)
+                {
+                    not_processing = true;
+                    break;
+                }
+            }
+
+            if(not_processing)
+            {
+                GWARN_STREAM("Due to previously happened errors, slice " << s << " will not be processed ... ");
+                continue;
+            }
+
+            this->perform_recon_binned_kspace_slice(s);
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::perform_recon_binned_kspace() ... ");
+    }
+}
+
+template <typename T> 
+void CmrKSpaceBinning<T>::perform_recon_binned_kspace_slice(size_t s)
 {
     try
     {
@@ -2301,181 +2419,215 @@ void CmrKSpaceBinning<T>::perform_recon_binned_kspace(const std::vector<size_t>&
         size_t E1 = kspace_binning.get_size(1);
         size_t CHA = kspace_binning.get_size(2);
         size_t N = kspace_binning.get_size(3);
-        size_t S = kspace_binning.get_size(4);
 
-        complex_image_binning.create(RO, E1, 1, N, S);
-        Gadgetron::clear(complex_image_binning);
+        size_t e1, n;
+
+        std::stringstream os;
+        os << "_S_" << s;
 
-        size_t e1, cha, n, s;
+        // local timer, this function runs asynchronously in the pipelined recon
+        Gadgetron::GadgetronTimer timer(false);
 
         if(CHA==1)
         {
             // use the neighboring frames if there are holes in the binned kspace
-            for (s=0; s<S; s++)
+            for (n=0; n<N; n++)
             {
-                bool not_processing = false;
-                for (size_t kk=0; kk<slices_not_processing.size(); kk++)
+                for (e1=0; e1<E1; e1++)
                 {
-                    if(slices_not_processing[kk] == s)
+                    if(kspace_binning_hit_count(e1, n, s)==0)
                     {
-                        not_processing = true;
-                        break;
-                    }
-                }
+                        long long ind_left(0), n_left(n), ind_right(0), n_right(n);
 
-                if(not_processing)
-                {
-                    GWARN_STREAM("Due to previously happened errors, slice " << s << " will not be processed ... ");
-                    continue;
-                }
+                        ind_left = 0;
+                        while (kspace_binning_hit_count(e1, n_left, s)==0 && (ind_left<N))
+                        {
+                            n_left--;
+                            if(n_left<0) n_left += N;
+                            ind_left++;
+                        }
 
-                for (n=0; n<N; n++)
-                {
-                    for (e1=0; e1<E1; e1++)
-                    {
-                        if(kspace_binning_hit_count(e1, n, s)==0)
+                        ind_right = 0;
+                        while (kspace_binning_hit_count(e1, n_right, s)==0 && (ind_right<N))
                         {
-                            long long ind_left(0), n_left(n), ind_right(0), n_right(n);
-
-                            ind_left = 0;
-                            while (kspace_binning_hit_count(e1, n_left, s)==0 && (ind_left<N))
-                            {
-                                n_left--;
-                                if(n_left<0) n_left += N;
-                                ind_left++;
-                            }
-
-                            ind_right = 0;
-                            while (kspace_binning_hit_count(e1, n_right, s)==0 && (ind_right<N))
-                            {
-                                n_right++;
-                                if(n_right>=N) n_right -= N;
-                                ind_right++;
-                            }
-
-                            if(ind_left>=N && ind_right>=N)
-                            {
-                                // cannot fill the hole ...
-                            }
-                            else if(ind_left<N && ind_right>=N)
-                            {
-                                // use the left
-                                memcpy(&kspace_binning(0, e1, n, s), &kspace_binning(0, e1, n_left, s), sizeof(std::complex<T>)*RO);
-                            }
-                            else if(ind_left>=N && ind_right<N)
-                            {
-                                // use the right
-                                memcpy(&kspace_binning(0, e1, n, s), &kspace_binning(0, e1, n_right, s), sizeof(std::complex<T>)*RO);
-                            }
-                            else if(ind_left<N && ind_right<N)
-                            {
-                                ArrayType readout_left(RO);
-                                memcpy(readout_left.begin(), &kspace_binning(0, e1, n_left, s), sizeof(std::complex<T>)*RO);
-
-                                ArrayType readout_right(RO);
-                                memcpy(readout_right.begin(), &kspace_binning(0, e1, n_right, s), sizeof(std::complex<T>)*RO);
-
-                                T w_l = (T)(ind_right)/(ind_left+ind_right);
-                                T w_r = (T)(ind_left)/(ind_left+ind_right);
-
-                                Gadgetron::scal(w_l, readout_left);
-                                Gadgetron::scal(w_r, readout_right);
-
-                                Gadgetron::add(readout_left, readout_right, readout_left);
-
-                                memcpy(&kspace_binning(0, e1, n, s), readout_left.begin(), sizeof(std::complex<T>)*RO);
-                            }
+                            n_right++;
+                            if(n_right>=N) n_right -= N;
+                            ind_right++;
+                        }
+
+                        if(ind_left>=N && ind_right>=N)
+                        {
+                            // cannot fill the hole ...
+                        }
+                        else if(ind_left<N && ind_right>=N)
+                        {
+                            // use the left
+                            memcpy(&kspace_binning(0, e1, n, s), &kspace_binning(0, e1, n_left, s), sizeof(std::complex<T>)*RO);
+                        }
+                        else if(ind_left>=N && ind_right<N)
+                        {
+                            // use the right
+                            memcpy(&kspace_binning(0, e1, n, s), &kspace_binning(0, e1, n_right, s), sizeof(std::complex<T>)*RO);
+                        }
+                        else if(ind_left<N && ind_right<N)
+                        {
+                            ArrayType readout_left(RO);
+                            memcpy(readout_left.begin(), &kspace_binning(0, e1, n_left, s), sizeof(std::complex<T>)*RO);
+
+                            ArrayType readout_right(RO);
+                            memcpy(readout_right.begin(), &kspace_binning(0, e1, n_right, s), sizeof(std::complex<T>)*RO);
+
+                            T w_l = (T)(ind_right)/(ind_left+ind_right);
+                            T w_r = (T)(ind_left)/(ind_left+ind_right);
+
+                            Gadgetron::scal(w_l, readout_left);
+                            Gadgetron::scal(w_r, readout_right);
+
+                            Gadgetron::add(readout_left, readout_right, readout_left);
+
+                            memcpy(&kspace_binning(0, e1, n, s), readout_left.begin(), sizeof(std::complex<T>)*RO);
                         }
                     }
                 }
             }
 
-            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_binning, debug_folder_ + "kspace_binning_before_fft_recon");
+            ArrayType kspace(RO, E1, 1, N, kspace_binning.begin()+s*RO*E1*N);
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace, debug_folder_ + "kspace_binning_before_fft_recon" + os.str());
 
             // perform fft recon
-            ArrayType reconFFT(kspace_binning);
-            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft2c(kspace_binning, complex_image_binning);
+            if ( this->perform_timing_ ) { timer.start("fft recon on kspace binning ... "); }
+            ArrayType complexIm;
+            Gadgetron::hoNDFFT<typename realType<T>::Type>::instance()->ifft2c(kspace, complexIm);
+            memcpy(complex_image_binning.begin()+s*RO*E1*N, complexIm.begin(), complexIm.get_number_of_bytes());
+            if ( this->perform_timing_ ) { this->add_stage_timing("binned kspace recon, fft", timer.stop()); }
         }
         else
         {
-            for (s=0; s<S; s++)
+            ArrayType kspace(RO, E1, CHA, N, 1, kspace_binning.begin()+s*RO*E1*CHA*N);
+            ArrayType kspace_wider(RO, E1, CHA, N, 1, kspace_binning_wider.begin()+s*RO*E1*CHA*N);
+            ArrayType kspaceRef(RO, E1, CHA, N, 1, kspace_binning_image_domain_average.begin()+s*RO*E1*CHA*N);
+            ArrayType coilMap(RO, E1, CHA, coil_map.begin());
+
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace, debug_folder_ + "kspace_binning_linear_recon_kspace" + os.str());
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_wider, debug_folder_ + "kspace_binning_linear_recon_kspace_wider" + os.str());
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspaceRef, debug_folder_ + "kspace_binning_linear_recon_kspaceRef" + os.str());
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(coilMap, debug_folder_ + "kspace_binning_linear_recon_coilMap" + os.str());
+
+            // perform linear recon
+            ArrayType resKSpace, resIm, kernel, kernelIm;
+
+            if ( this->perform_timing_ ) { timer.start("perform linear recon on kspace binning ... "); }
+
+            if(this->use_nonlinear_binning_recon_)
             {
-                bool not_processing = false;
-                for (size_t kk=0; kk<slices_not_processing.size(); kk++)
-                {
-                    if(slices_not_processing[kk] == s)
-                    {
-                        not_processing = true;
-                        break;
-                    }
-                }
+                this->perform_linear_recon_on_kspace_binning(kspace_wider, kspaceRef, coilMap, resKSpace, resIm, kernel, kernelIm);
+            }
+            else
+            {
+                this->perform_linear_recon_on_kspace_binning(kspace, kspaceRef, coilMap, resKSpace, resIm, kernel, kernelIm);
+            }
+            if ( this->perform_timing_ ) { this->add_stage_timing("binned kspace recon, linear", timer.stop()); }
 
-                if(not_processing)
-                {
-                    GWARN_STREAM("Due to previously happened errors, slice " << s << " will not be processed ... ");
-                    continue;
-                }
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resKSpace, debug_folder_ + "kspace_binning_linear_recon_resKSpace" + os.str());
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resIm, debug_folder_ + "kspace_binning_linear_recon_resIm" + os.str());
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kernel, debug_folder_ + "kspace_binning_linear_recon_kernel" + os.str());
+            if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kernelIm, debug_folder_ + "kspace_binning_linear_recon_kernelIm" + os.str());
 
-                std::stringstream os;
-                os << "_S_" << s;
+            // perform nonlinear recon
+            if(this->use_nonlinear_binning_recon_)
+            {
+                ArrayType resKSpaceNonLinear, resImNonLinear;
 
-                ArrayType kspace(RO, E1, CHA, N, 1, kspace_binning.begin()+s*RO*E1*CHA*N);
-                ArrayType kspace_wider(RO, E1, CHA, N, 1, kspace_binning_wider.begin()+s*RO*E1*CHA*N);
-                ArrayType kspaceRef(RO, E1, CHA, N, 1, kspace_binning_image_domain_average.begin()+s*RO*E1*CHA*N);
-                ArrayType coilMap(RO, E1, CHA, coil_map.begin());
+                if ( this->perform_timing_ ) { timer.start("perform non-linear recon on kspace binning ... "); }
+                this->perform_non_linear_recon_on_kspace_binning(kspace, resKSpace, coilMap, kernel, kernelIm, resKSpaceNonLinear, resImNonLinear);
+                if ( this->perform_timing_ ) { this->add_stage_timing("binned kspace recon, non-linear", timer.stop()); }
 
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace, debug_folder_ + "kspace_binning_linear_recon_kspace" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspace_wider, debug_folder_ + "kspace_binning_linear_recon_kspace_wider" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kspaceRef, debug_folder_ + "kspace_binning_linear_recon_kspaceRef" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(coilMap, debug_folder_ + "kspace_binning_linear_recon_coilMap" + os.str());
+                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resKSpaceNonLinear, debug_folder_ + "kspace_binning_linear_recon_resKSpaceNonLinear" + os.str());
+                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resImNonLinear, debug_folder_ + "kspace_binning_linear_recon_resImNonLinear" + os.str());
 
-                // perform linear recon
-                ArrayType resKSpace, resIm, kernel, kernelIm;
+                memcpy(complex_image_binning.begin()+s*RO*E1*N, resImNonLinear.begin(), resImNonLinear.get_number_of_bytes());
+            }
+            else
+            {
+                memcpy(complex_image_binning.begin()+s*RO*E1*N, resIm.begin(), resIm.get_number_of_bytes());
+            }
+        }
+    }
+    catch(...)
+    {
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::perform_recon_binned_kspace_slice() ... ");
+    }
+}
 
-                if ( this->perform_timing_ ) { gt_timer_local_.start("perform linear recon on kspace binning ... "); }
+template <typename T> 
+void CmrKSpaceBinning<T>::perform_binning_recon_pipelined(const std::vector<size_t>& bestHB, std::vector<size_t>& slices_not_processing)
+{
+    try
+    {
+        hoNDArray<T> mag;
+        this->prepare_kspace_binning(mag);
 
-                if(this->use_nonlinear_binning_recon_)
-                {
-                    this->perform_linear_recon_on_kspace_binning(kspace_wider, kspaceRef, coilMap, resKSpace, resIm, kernel, kernelIm);
-                }
-                else
-                {
-                    this->perform_linear_recon_on_kspace_binning(kspace, kspaceRef, coilMap, resKSpace, resIm, kernel, kernelIm);
-                }
-                if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
+        ArrayType& kspace_binning = binning_obj_.kspace_binning_;
 
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resKSpace, debug_folder_ + "kspace_binning_linear_recon_resKSpace" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resIm, debug_folder_ + "kspace_binning_linear_recon_resIm" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kernel, debug_folder_ + "kspace_binning_linear_recon_kernel" + os.str());
-                if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(kernelIm, debug_folder_ + "kspace_binning_linear_recon_kernelIm" + os.str());
+        size_t RO = kspace_binning.get_size(0);
+        size_t E1 = kspace_binning.get_size(1);
+        size_t N = kspace_binning.get_size(3);
+        size_t S = kspace_binning.get_size(4);
 
-                // perform nonlinear recon
-                if(this->use_nonlinear_binning_recon_)
-                {
-                    ArrayType resKSpaceNonLinear, resImNonLinear;
+        binning_obj_.complex_image_binning_.create(RO, E1, 1, N, S);
+        Gadgetron::clear(binning_obj_.complex_image_binning_);
 
-                    if ( this->perform_timing_ ) { gt_timer_local_.start("perform non-linear recon on kspace binning ... "); }
-                    this->perform_non_linear_recon_on_kspace_binning(kspace, resKSpace, coilMap, kernel, kernelIm, resKSpaceNonLinear, resImNonLinear);
-                    if ( this->perform_timing_ ) { gt_timer_local_.stop(); }
+        slices_not_processing.clear();
 
-                    if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resKSpaceNonLinear, debug_folder_ + "kspace_binning_linear_recon_resKSpaceNonLinear" + os.str());
-                    if ( !debug_folder_.empty() ) gt_exporter_.export_array_complex(resImNonLinear, debug_folder_ + "kspace_binning_linear_recon_resImNonLinear" + os.str());
+        // every slice writes only its own part of the binned kspace and the binning images
+        // at most one recon runs besides the binning, to bound the memory and the number of threads
+        std::future<void> recon;
 
-                    memcpy(complex_image_binning.begin()+s*RO*E1*N, resImNonLinear.begin(), resImNonLinear.get_number_of_bytes());
-                }
-                else
-                {
-                    memcpy(complex_image_binning.begin()+s*RO*E1*N, resIm.begin(), resIm.get_number_of_bytes());
-                }
+        size_t s;
+        for (s=0; s<S; s++)
+        {
+            size_t num_not_processing = slices_not_processing.size();
+
+            this->compute_kspace_binning_slice(s, bestHB[s], mag, slices_not_processing);
+
+            if ( recon.valid() ) recon.get();
+
+            if ( slices_not_processing.size() > num_not_processing )
+            {
+                GWARN_STREAM("Due to previously happened errors, slice " << s << " will not be processed ... ");
+                continue;
             }
+
+            recon = std::async(std::launch::async, &Self::perform_recon_binned_kspace_slice, this, s);
         }
+
+        if(binning_obj_.full_kspace_raw_.delete_data_on_destruct()) binning_obj_.full_kspace_raw_.clear();
+
+        if ( recon.valid() ) recon.get();
     }
     catch(...)
     {
-        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::perform_recon_binned_kspace() ... ");
+        GADGET_THROW("Exceptions happened in CmrKSpaceBinning<T>::perform_binning_recon_pipelined() ... ");
     }
 }
 
+template <typename T> 
+void CmrKSpaceBinning<T>::add_stage_timing(const std::string& stage, double time_in_us)
+{
+    std::lock_guard<std::mutex> lock(stage_timing_mutex_);
+
+    for (size_t ii=0; ii<stage_timing_.size(); ii++)
+    {
+        if ( stage_timing_[ii].first == stage )
+        {
+            stage_timing_[ii].second += time_in_us/1000.0;
+            return;
+        }
+    }
+
+    stage_timing_.push_back(std::make_pair(stage, time_in_us/1000.0));
+}
+
 template <typename T> 
 void CmrKSpaceBinning<T>::perform_linear_recon_on_kspace_binning(const ArrayType& kspace, const ArrayType& kspaceInitial, const ArrayType& coilMap, ArrayType& resKSpace, ArrayType& resIm, ArrayType& kernel, ArrayType& kernelIm)
 {
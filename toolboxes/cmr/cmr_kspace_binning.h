@@ -16,6 +16,8 @@
 #endif // min
 
 #include <algorithm>
+#include <future>
+#include <mutex>
 #include "hoMatrix.h"
 
 #include "ismrmrd/ismrmrd.h"
@@ -184,6 +186,9 @@ namespace Gadgetron {
         // if false, user can supply external navigator by filling in binning_obj_.navigator_
         bool estimate_respiratory_navigator_;
 
+        // if true, the binned kspace of slice s is computed while the recon of slice s-1 is running
+        bool pipeline_binning_recon_;
+
         // ======================================================================================
         /// parameter for respiratory navigator estimation
         // ======================================================================================
@@ -293,6 +298,10 @@ namespace Gadgetron {
         std::string debug_folder_;
         bool perform_timing_;
 
+        // time in ms spent in every stage of the last process_binning_recon call, filled if perform_timing_ is true
+        // with the pipelined recon, stages of neighbouring slices overlap and the sum can exceed the total time
+        std::vector< std::pair<std::string, double> > stage_timing_;
+
         // clock for timing
         Gadgetron::GadgetronTimer gt_timer_local_;
         Gadgetron::GadgetronTimer gt_timer_;
@@ -335,9 +344,24 @@ namespace Gadgetron {
         /// perform recon on the binned kspace
         virtual void perform_recon_binned_kspace(const std::vector<size_t>& slices_not_processing);
 
+        /// compute kspace binning and recon slice by slice, the recon of a slice runs asynchronously while the next slice is binned
+        virtual void perform_binning_recon_pipelined(const std::vector<size_t>& bestHB, std::vector<size_t>& slices_not_processing);
+
         // ======================================================================================
         // implementation functions
         // ======================================================================================
+        /// allocate the binned kspace buffers and compute the magnitude of raw images, [RO E1 N S]
+        void prepare_kspace_binning(hoNDArray<T>& mag);
+
+        /// compute the binned kspace for slice s; if it cannot be processed, s is added to slices_not_processing
+        void compute_kspace_binning_slice(size_t s, size_t bestHB_S, const hoNDArray<T>& mag, std::vector<size_t>& slices_not_processing);
+
+        /// perform recon on the binned kspace of slice s and fill binning_obj_.complex_image_binning_
+        void perform_recon_binned_kspace_slice(size_t s);
+
+        /// add time in us to a stage of stage_timing_, can be called from the pipelined recon
+        void add_stage_timing(const std::string& stage, double time_in_us);
+
         /// if the alternativing acqusition is used, detect and flip the time stamps
         void detect_and_flip_alternating_order(const hoNDArray<float>& time_stamp, const hoNDArray<float>& cpt_time_stamp, hoNDArray<float>& cpt_time_stamp_flipped, std::vector<bool>& ascending);
 
@@ -376,5 +400,10 @@ namespace Gadgetron {
         void perform_linear_recon_on_kspace_binning(const ArrayType& underSampledKspace, const ArrayType& kspaceInitial, const ArrayType& coilMap, ArrayType& resKSpace, ArrayType& resIm, ArrayType& kernel, ArrayType& kernelIm);
         /// perform nonlinear recon for binning
         void perform_non_linear_recon_on_kspace_binning(const ArrayType& underSampledKspace, const ArrayType& kspaceLinear, const ArrayType& coilMap, const ArrayType& kernel, const ArrayType& kernelIm, ArrayType& resKSpace, ArrayType& resIm);
+
+        /// registration workspace of the binning moco, reused for every slice
+        RegContainer2DType moco_reg_;
+
+        std::mutex stage_timing_mutex_;
     };
 }
@@ -122,6 +122,17 @@ namespace Gadgetron
         T evaluateBSpline(const T* coeff, const std::vector<size_t>& dimension, unsigned int SplineDegree, 
                         bspline_float_type** weight, const std::vector<coord_type>& pos);
 
+        /// evaluate BSpline at N points, the coordinates are given in the structure-of-arrays layout
+        /// points are processed in tiles; for tiles away from the array boundary, the mirror boundary condition is skipped
+        /// and the weighted sum is computed for all points of the tile together, so it can be vectorized over points
+        void evaluateBSpline(const T* coeff, size_t sx, size_t sy, unsigned int SplineDegree, 
+                        unsigned int dx, unsigned int dy, 
+                        size_t N, const coord_type* x, const coord_type* y, T* res);
+
+        void evaluateBSpline(const T* coeff, size_t sx, size_t sy, size_t sz, unsigned int SplineDegree, 
+                        unsigned int dx, unsigned int dy, unsigned int dz, 
+                        size_t N, const coord_type* x, const coord_type* y, const coord_type* z, T* res);
+
         /// compute the BSpline based derivative for an ND array
         /// derivative indicates the order of derivatives for every dimension
         bool computeBSplineDerivative(const hoNDArray<T>& data, const hoNDArray<T>& coeff, unsigned int SplineDegree, const std::vector<unsigned int>& derivative, hoNDArray<T>& deriv);
@@ -141,6 +152,21 @@ namespace Gadgetron
                                                         bspline_float_type          Tolerance       /* admissible relative error */ 
                                                       );
 
+        /// the same as above for W lines at once, stored interleaved as c[n*W + w], W <= PREFILTER_BLOCK_SIZE
+        /// the inner loops run over the lines and can be vectorized
+        static void ConvertToInterpolationCoefficients(T c[], size_t DataLength, size_t W, bspline_float_type z[], long NbPoles, bspline_float_type Tolerance);
+
+        /// number of lines filtered together by computeBSplineCoefficientsAlongDimension
+        enum { PREFILTER_BLOCK_SIZE = 16 };
+
+        /// apply the BSpline prefilter in place along one dimension of an array
+        /// the array is seen as [stride len num], every line along len is filtered
+        /// blocks of lines are copied to an interleaved buffer and filtered together, blocks are processed in parallel
+        /// the causal initialization is truncated at the machine epsilon of bspline_float_type; for float, the truncation error
+        /// of the initial coefficient is below FLT_EPSILON/(1-|z|)*max|c| < 3*FLT_EPSILON*max|c| for spline degree 2 to 9,
+        /// which is at the level of the float rounding error of the recursion itself
+        void computeBSplineCoefficientsAlongDimension(T* coeff, size_t stride, size_t len, size_t num, bspline_float_type* pole, unsigned int NbPoles);
+
         static T InitialCausalCoefficient(
                                             T           c[],                /* coefficients */
                                             size_t      DataLength,         /* number of coefficients */
@@ -185,6 +211,22 @@ namespace Gadgetron
 
         /// compute BSpline interpolation locations and weights
         static void computeBSplineInterpolationLocationsAndWeights(size_t len, unsigned int SplineDegree, unsigned int dx, coord_type x, bspline_float_type* weight, long long* xIndex);
+
+        /// number of points in a tile for the batched evaluation
+        enum { BATCH_TILE_SIZE = 64 };
+
+        /// compute the interpolation weights of a tile of points along one dimension
+        /// weight is stored as [SplineDegree+1 num], start is the first interpolation location of every point
+        /// inside is false for points whose interpolation locations are not all in [0 len-1]; if accumulate is true, inside is and-ed with the current values
+        static void computeBSplineTileWeights(size_t len, unsigned int SplineDegree, size_t num, const coord_type* x, 
+                                            bspline_float_type* weight, long long* start, bool* inside, bool accumulate);
+
+        /// weighted sum of L*L or L*L*L coefficients for a tile of points, with L = SplineDegree+1
+        template <unsigned int L> static void evaluateBSplineTile(const T* coeff, size_t sx, size_t num, const long long* offset, 
+                                                                    const bspline_float_type* xWeight, const bspline_float_type* yWeight, T* res);
+
+        template <unsigned int L> static void evaluateBSplineTile(const T* coeff, size_t sx, size_t sy, size_t num, const long long* offset, 
+                                                                    const bspline_float_type* xWeight, const bspline_float_type* yWeight, const bspline_float_type* zWeight, T* res);
     };
 }
 
@@ -4,6 +4,7 @@
 */
 
 #include "hoNDBSpline.h"
+#include <limits>
 
 namespace Gadgetron
 {
@@ -84,107 +85,19 @@ namespace Gadgetron
 
             GADGET_CHECK_RETURN_FALSE(D==dimension.size());
 
-            hoNDArray<T> coeffBuf( const_cast<std::vector<size_t>&>(dimension), coeff, false);
-            memcpy(coeff, data, sizeof(T)*coeffBuf.get_number_of_elements());
-
+            size_t N = 1;
             unsigned int d;
+            for ( d=0; d<D; d++ ) N *= dimension[d];
+
+            if ( coeff != data ) memcpy(coeff, data, sizeof(T)*N);
+
+            size_t stride = 1;
             for ( d=0; d<D; d++ )
             {
-                long long ii;
-
                 size_t len = dimension[d];
-                size_t num = coeffBuf.get_number_of_elements()/len;
-
-                size_t i;
-                std::vector<size_t> dimUsed(D-1);
-                for( i = 0; i<D; i++ )
-                {
-                    if ( i < d)
-                    {
-                        dimUsed[i] = dimension[i];
-                    }
-                    else if ( i > d )
-                    {
-                        dimUsed[i-1] = dimension[i];
-                    }
-                }
-
-                std::vector<size_t> offsetFactor(D-1, 1);
-                hoNDArray<T>::calculate_offset_factors(dimUsed, offsetFactor);
-
-                //for( i = 0; i<D-1; i++ )
-                //{
-                //    size_t k = 1;
-                //    for( j = 0; j < i; j++ )
-                //    {
-                //        k *= dimUsed[j];
-                //    }
-                //    offsetFactor[i] = k;
-                //}
-
-                #pragma omp parallel private(ii) shared(coeff, coeffBuf, pole, NbPoles, dimension, num, len, offsetFactor, d)
-                {
-                    T* buf = new T[ len ];
-
-                    std::vector<size_t> ind(D, 0);
-                    std::vector<size_t> indUsed(D-1, 0);
-
-                    #pragma omp for 
-                    for ( ii=0; ii<num; ii++ )
-                    {
-                        if ( d == 0 )
-                        {
-                            memcpy(buf, coeff+ii*len, sizeof(T)*len);
-
-                            this->ConvertToInterpolationCoefficients(buf, len, pole, NbPoles, DBL_EPSILON);
-
-                            memcpy(coeff+ii*len, buf, sizeof(T)*len);
-                        }
-                        else
-                        {
-                            hoNDArray<T>::calculate_index(ii, offsetFactor, indUsed);
-
-                            long long i;
-
-                            //size_t offset = ii;
-                            //for( i=D-2; i>=0; i-- )
-                            //{
-                            //    indUsed[i] = offset / offsetFactor[i];
-                            //    offset %= offsetFactor[i];
-                            //}
-
-                            for ( i=0; i<D; i++ )
-                            {
-                                if ( i < d )
-                                {
-                                    ind[i] = indUsed[i];
-                                }
-                                else if ( i > d )
-                                {
-                                    ind[i] = indUsed[i-1];
-                                }
-                            }
-
-                            for ( i=0; i<len; i++ )
-                            {
-                                ind[d] = i;
-                                buf[i] = coeffBuf(ind);
-                            }
-
-                            this->ConvertToInterpolationCoefficients(buf, len, pole, NbPoles, DBL_EPSILON);
-
-                            for ( i=0; i<len; i++ )
-                            {
-                                ind[d] = i;
-                                coeffBuf(ind) = buf[i];
-                            }
-                        }
-                    }
-
-                    delete [] buf;
-                }
+                this->computeBSplineCoefficientsAlongDimension(coeff, stride, len, N/(stride*len), pole, NbPoles);
+                stride *= len;
             }
-
         }
         catch(...)
         {
@@ -204,8 +117,8 @@ namespace Gadgetron
             bspline_float_type pole[4];
             this->Pole(pole, SplineDegree, NbPoles);
 
-            memcpy(coeff, data, sizeof(T)*len);
-            this->ConvertToInterpolationCoefficients(coeff, len, pole, NbPoles, DBL_EPSILON);
+            if ( coeff != data ) memcpy(coeff, data, sizeof(T)*len);
+            this->ConvertToInterpolationCoefficients(coeff, len, pole, NbPoles, std::numeric_limits<bspline_float_type>::epsilon());
         }
         catch(...)
         {
@@ -225,51 +138,10 @@ namespace Gadgetron
             bspline_float_type pole[4];
             this->Pole(pole, SplineDegree, NbPoles);
 
-            // x
-            long long y;
-            #pragma omp parallel default(none) private(y) shared(data, coeff, pole, NbPoles, sx, sy)
-            {
-                T* buf = new T[sx];
-
-                #pragma omp for 
-                for ( y=0; y<sy; y++ )
-                {
-                    memcpy(buf, data+y*sx, sizeof(T)*sx);
-
-                    this->ConvertToInterpolationCoefficients(buf, sx, pole, NbPoles, DBL_EPSILON);
-
-                    memcpy(coeff+y*sx, buf, sizeof(T)*sx);
-                }
-
-                delete [] buf;
-            }
-
-            // y
-            long long x;
-            #pragma omp parallel default(none) private(x) shared(data, coeff, pole, NbPoles, sx, sy)
-            {
-                T* buf = new T[sy];
-
-                #pragma omp for 
-                for ( x=0; x<sx; x++ )
-                {
-                    size_t y;
+            if ( coeff != data ) memcpy(coeff, data, sizeof(T)*sx*sy);
 
-                    for ( y=0; y<sy; y++ )
-                    {
-                        buf[y] = coeff[x + y*sx];
-                    }
-
-                    this->ConvertToInterpolationCoefficients(buf, sy, pole, NbPoles, DBL_EPSILON);
-
-                    for ( y=0; y<sy; y++ )
-                    {
-                        coeff[x + y*sx] = buf[y];
-                    }
-                }
-
-                delete [] buf;
-            }
+            this->computeBSplineCoefficientsAlongDimension(coeff, 1, sx, sy, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx, sy, 1, pole, NbPoles);
         }
         catch(...)
         {
@@ -289,89 +161,11 @@ namespace Gadgetron
             bspline_float_type pole[4];
             this->Pole(pole, SplineDegree, NbPoles);
 
-            // x
-            long long z;
-            #pragma omp parallel default(none) private(z) shared(data, coeff, pole, NbPoles, sx, sy, sz)
-            {
-                T* buf = new T[sx];
-
-                #pragma omp for 
-                for ( z=0; z<sz; z++ )
-                {
-                    for ( size_t y=0; y<sy; y++ )
-                    {
-                        memcpy(buf, data+z*sx*sy+y*sx, sizeof(T)*sx);
-
-                        this->ConvertToInterpolationCoefficients(buf, sx, pole, NbPoles, DBL_EPSILON);
-
-                        memcpy(coeff+z*sx*sy+y*sx, buf, sizeof(T)*sx);
-                    }
-                }
-
-                delete [] buf;
-            }
-
-            // y
-            #pragma omp parallel default(none) private(z) shared(data, coeff, pole, NbPoles, sx, sy, sz)
-            {
-                T* buf = new T[sy];
-
-                #pragma omp for 
-                for ( z=0; z<sz; z++ )
-                {
-                    for ( size_t x=0; x<sx; x++ )
-                    {
-                        size_t y;
-
-                        size_t offset = x + z*sx*sy;
-
-                        for ( y=0; y<sy; y++ )
-                        {
-                            buf[y] = coeff[offset + y*sx];
-                        }
-
-                        this->ConvertToInterpolationCoefficients(buf, sy, pole, NbPoles, DBL_EPSILON);
-
-                        for ( y=0; y<sy; y++ )
-                        {
-                            coeff[offset + y*sx] = buf[y];
-                        }
-                    }
-                }
-
-                delete [] buf;
-            }
-
-            // z
-            long long x;
-            #pragma omp parallel default(none) private(x) shared(data, coeff, pole, NbPoles, sx, sy, sz)
-            {
-                T* buf = new T[sz];
-
-                #pragma omp for 
-                for ( x=0; x<sx; x++ )
-                {
-                    for ( size_t y=0; y<sy; y++ )
-                    {
-                        size_t z;
-                        size_t offset = x + y*sx;
-
-                        for ( z=0; z<sz; z++ )
-                        {
-                            buf[z] = coeff[offset + z*sx*sy];
-                        }
-
-                        this->ConvertToInterpolationCoefficients(buf, sz, pole, NbPoles, DBL_EPSILON);
-
-                        for ( z=0; z<sz; z++ )
-                        {
-                            coeff[offset + z*sx*sy] = buf[z];
-                        }
-                    }
-                }
+            if ( coeff != data ) memcpy(coeff, data, sizeof(T)*sx*sy*sz);
 
-                delete [] buf;
-            }
+            this->computeBSplineCoefficientsAlongDimension(coeff, 1, sx, sy*sz, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx, sy, sz, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx*sy, sz, 1, pole, NbPoles);
         }
         catch(...)
         {
@@ -391,131 +185,16 @@ namespace Gadgetron
             bspline_float_type pole[4];
             this->Pole(pole, SplineDegree, NbPoles);
 
-            long long x, y, z, t;
-
-            // x
-            #pragma omp parallel default(none) private(y, z, t) shared(data, coeff, pole, NbPoles, sx, sy, sz, st)
-            {
-                T* buf = new T[sx];
-
-                #pragma omp for 
-                for ( t=0; t<st; t++ )
-                {
-                    for ( z=0; z<sz; z++ )
-                    {
-                        for ( y=0; y<sy; y++ )
-                        {
-                            memcpy(buf, data+t*sx*sy*sz+z*sx*sy+y*sx, sizeof(T)*sx);
-
-                            this->ConvertToInterpolationCoefficients(buf, sx, pole, NbPoles, DBL_EPSILON);
-
-                            memcpy(coeff+t*sx*sy*sz+z*sx*sy+y*sx, buf, sizeof(T)*sx);
-                        }
-                    }
-                }
-
-                delete [] buf;
-            }
-
-            // y
-            #pragma omp parallel default(none) private(x, y, z, t) shared(data, coeff, pole, NbPoles, sx, sy, sz, st)
-            {
-                T* buf = new T[sy];
-
-                #pragma omp for 
-                for ( t=0; t<st; t++ )
-                {
-                    for ( z=0; z<sz; z++ )
-                    {
-                        for ( x=0; x<sx; x++ )
-                        {
-                            size_t offset = x + z*sx*sy + t*sx*sy*sz;
-
-                            for ( y=0; y<sy; y++ )
-                            {
-                                buf[y] = coeff[offset + y*sx];
-                            }
-
-                            this->ConvertToInterpolationCoefficients(buf, sy, pole, NbPoles, DBL_EPSILON);
-
-                            for ( y=0; y<sy; y++ )
-                            {
-                                coeff[offset + y*sx] = buf[y];
-                            }
-                        }
-                    }
-                }
-
-                delete [] buf;
-            }
-
-            // z
-            #pragma omp parallel default(none) private(x, y, z, t) shared(data, coeff, pole, NbPoles, sx, sy, sz, st)
-            {
-                T* buf = new T[sz];
-
-                #pragma omp for 
-                for ( t=0; t<st; t++ )
-                {
-                    for ( x=0; x<sx; x++ )
-                    {
-                        for ( y=0; y<sy; y++ )
-                        {
-                            size_t offset = x + y*sx + t*sx*sy*sz;
-
-                            for ( z=0; z<sz; z++ )
-                            {
-                                buf[z] = coeff[offset + z*sx*sy];
-                            }
-
-                            this->ConvertToInterpolationCoefficients(buf, sz, pole, NbPoles, DBL_EPSILON);
-
-                            for ( z=0; z<sz; z++ )
-                            {
-                                coeff[offset + z*sx*sy] = buf[z];
-                            }
-                        }
-                    }
-                }
-
-                delete [] buf;
-            }
-
-            // t
-            #pragma omp parallel default(none) private(x, y, z, t) shared(data, coeff, pole, NbPoles, sx, sy, sz, st)
-            {
-                T* buf = new T[st];
+            if ( coeff != data ) memcpy(coeff, data, sizeof(T)*sx*sy*sz*st);
 
-                #pragma omp for 
-                for ( x=0; x<sx; x++ )
-                {
-                    for ( y=0; y<sy; y++ )
-                    {
-                        for ( z=0; z<sz; z++ )
-                        {
-                            size_t offset = x + y*sx + z*sx*sy;
-
-                            for ( t=0; t<st; t++ )
-                            {
-                                buf[t] = coeff[offset + t*sx*sy*sz];
-                            }
-
-                            this->ConvertToInterpolationCoefficients(buf, st, pole, NbPoles, DBL_EPSILON);
-
-                            for ( t=0; t<st; t++ )
-                            {
-                                coeff[offset + t*sx*sy*sz] = buf[t];
-                            }
-                        }
-                    }
-                }
-
-                delete [] buf;
-            }
+            this->computeBSplineCoefficientsAlongDimension(coeff, 1, sx, sy*sz*st, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx, sy, sz*st, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx*sy, sz, st, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx*sy*sz, st, 1, pole, NbPoles);
         }
         catch(...)
         {
-            GERROR_STREAM("Error happened in hoNDBSpline<T, D>::computeBSplineCoefficients(const T* data, size_t sx, size_t sy, size_t sz, unsigned int SplineDegree, T* coeff) ... ");
+            GERROR_STREAM("Error happened in hoNDBSpline<T, D>::computeBSplineCoefficients(const T* data, size_t sx, size_t sy, size_t sz, size_t st, unsigned int SplineDegree, T* coeff) ... ");
             return false;
         }
 
@@ -531,182 +210,71 @@ namespace Gadgetron
             bspline_float_type pole[4];
             this->Pole(pole, SplineDegree, NbPoles);
 
-            long long x, y, z, t, p;
+            if ( coeff != data ) memcpy(coeff, data, sizeof(T)*sx*sy*sz*st*sp);
 
-            // x
-            #pragma omp parallel default(none) private(y, z, t, p) shared(data, coeff, pole, NbPoles, sx, sy, sz, st, sp)
-            {
-                T* buf = new T[sx];
-
-                #pragma omp for 
-                for ( p=0; p<sp; p++ )
-                {
-                    for ( t=0; t<st; t++ )
-                    {
-                        for ( z=0; z<sz; z++ )
-                        {
-                            for ( y=0; y<sy; y++ )
-                            {
-                                memcpy(buf, data+p*sx*sy*sz*st+t*sx*sy*sz+z*sx*sy+y*sx, sizeof(T)*sx);
-
-                                this->ConvertToInterpolationCoefficients(buf, sx, pole, NbPoles, DBL_EPSILON);
-
-                                memcpy(coeff+p*sx*sy*sz*st+t*sx*sy*sz+z*sx*sy+y*sx, buf, sizeof(T)*sx);
-                            }
-                        }
-                    }
-                }
-
-                delete [] buf;
-            }
-
-            // y
-            #pragma omp parallel default(none) private(x, y, z, t, p) shared(data, coeff, pole, NbPoles, sx, sy, sz, st, sp)
-            {
-                T* buf = new T[sy];
+            this->computeBSplineCoefficientsAlongDimension(coeff, 1, sx, sy*sz*st*sp, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx, sy, sz*st*sp, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx*sy, sz, st*sp, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx*sy*sz, st, sp, pole, NbPoles);
+            this->computeBSplineCoefficientsAlongDimension(coeff, sx*sy*sz*st, sp, 1, pole, NbPoles);
+        }
+        catch(...)
+        {
+            GERROR_STREAM("Error happened in hoNDBSpline<T, D>::computeBSplineCoefficients(const T* data, size_t sx, size_t sy, size_t sz, size_t st, size_t sp, unsigned int SplineDegree, T* coeff) ... ");
+            return false;
+        }
 
-                #pragma omp for 
-                for ( p=0; p<sp; p++ )
-                {
-                    for ( t=0; t<st; t++ )
-                    {
-                        for ( z=0; z<sz; z++ )
-                        {
-                            for ( x=0; x<sx; x++ )
-                            {
-                                size_t offset = x + z*sx*sy + t*sx*sy*sz + p*sx*sy*sz*st;
+        return true;
+    }
 
-                                for ( y=0; y<sy; y++ )
-                                {
-                                    buf[y] = coeff[offset + y*sx];
-                                }
+    template <typename T, unsigned int D> 
+    void hoNDBSpline<T, D>::computeBSplineCoefficientsAlongDimension(T* coeff, size_t stride, size_t len, size_t num, bspline_float_type* pole, unsigned int NbPoles)
+    {
+        if ( len <= 1 ) return;
 
-                                this->ConvertToInterpolationCoefficients(buf, sy, pole, NbPoles, DBL_EPSILON);
+        // lines are numbered with the index before the filtered dimension running fastest,
+        // so a block of lines starts at consecutive memory locations whenever stride>=PREFILTER_BLOCK_SIZE
+        const size_t numOfLines = stride*num;
+        const long long numOfBlocks = (long long)( (numOfLines+PREFILTER_BLOCK_SIZE-1)/PREFILTER_BLOCK_SIZE );
+        const bspline_float_type tolerance = std::numeric_limits<bspline_float_type>::epsilon();
 
-                                for ( y=0; y<sy; y++ )
-                                {
-                                    coeff[offset + y*sx] = buf[y];
-                                }
-                            }
-                        }
-                    }
-                }
+        long long b;
 
-                delete [] buf;
-            }
+        #pragma omp parallel default(none) private(b) shared(coeff, stride, len, num, pole, NbPoles, numOfLines, numOfBlocks, tolerance) if ( numOfLines*len > 64*1024 )
+        {
+            T* buf = new T[len*PREFILTER_BLOCK_SIZE];
+            size_t offset[PREFILTER_BLOCK_SIZE];
 
-            // z
-            #pragma omp parallel default(none) private(x, y, z, t, p) shared(data, coeff, pole, NbPoles, sx, sy, sz, st, sp)
+            #pragma omp for 
+            for ( b=0; b<numOfBlocks; b++ )
             {
-                T* buf = new T[sz];
+                size_t start = b*PREFILTER_BLOCK_SIZE;
+                size_t W = std::min( (size_t)PREFILTER_BLOCK_SIZE, numOfLines-start );
 
-                #pragma omp for 
-                for ( p=0; p<sp; p++ )
+                size_t n, w;
+                for ( w=0; w<W; w++ )
                 {
-                    for ( t=0; t<st; t++ )
-                    {
-                        for ( x=0; x<sx; x++ )
-                        {
-                            for ( y=0; y<sy; y++ )
-                            {
-                                size_t offset = x + y*sx + t*sx*sy*sz + p*sx*sy*sz*st;
-
-                                for ( z=0; z<sz; z++ )
-                                {
-                                    buf[z] = coeff[offset + z*sx*sy];
-                                }
-
-                                this->ConvertToInterpolationCoefficients(buf, sz, pole, NbPoles, DBL_EPSILON);
-
-                                for ( z=0; z<sz; z++ )
-                                {
-                                    coeff[offset + z*sx*sy] = buf[z];
-                                }
-                            }
-                        }
-                    }
+                    size_t line = start + w;
+                    offset[w] = (line%stride) + (line/stride)*stride*len;
                 }
 
-                delete [] buf;
-            }
-
-            // t
-            #pragma omp parallel default(none) private(x, y, z, t, p) shared(data, coeff, pole, NbPoles, sx, sy, sz, st, sp)
-            {
-                T* buf = new T[st];
-
-                #pragma omp for 
-                for ( p=0; p<sp; p++ )
+                for ( n=0; n<len; n++ )
                 {
-                    for ( x=0; x<sx; x++ )
-                    {
-                        for ( y=0; y<sy; y++ )
-                        {
-                            for ( z=0; z<sz; z++ )
-                            {
-                                size_t offset = x + y*sx + z*sx*sy + p*sx*sy*sz*st;
-
-                                for ( t=0; t<st; t++ )
-                                {
-                                    buf[t] = coeff[offset + t*sx*sy*sz];
-                                }
-
-                                this->ConvertToInterpolationCoefficients(buf, st, pole, NbPoles, DBL_EPSILON);
-
-                                for ( t=0; t<st; t++ )
-                                {
-                                    coeff[offset + t*sx*sy*sz] = buf[t];
-                                }
-                            }
-                        }
-                    }
+                    const T* c = coeff + n*stride;
+                    for ( w=0; w<W; w++ ) buf[n*W+w] = c[offset[w]];
                 }
 
-                delete [] buf;
-            }
-
-            // p
-            #pragma omp parallel default(none) private(x, y, z, t, p) shared(data, coeff, pole, NbPoles, sx, sy, sz, st, sp)
-            {
-                T* buf = new T[sp];
+                this->ConvertToInterpolationCoefficients(buf, len, W, pole, NbPoles, tolerance);
 
-                #pragma omp for 
-                for ( x=0; x<sx; x++ )
+                for ( n=0; n<len; n++ )
                 {
-                    for ( y=0; y<sy; y++ )
-                    {
-                        for ( z=0; z<sz; z++ )
-                        {
-                            for ( t=0; t<st; t++ )
-                            {
-                                size_t offset = x + y*sx + z*sx*sy + t*sx*sy*sz;
-
-                                for ( p=0; p<sp; p++ )
-                                {
-                                    buf[t] = coeff[offset + p*sx*sy*sz*st];
-                                }
-
-                                this->ConvertToInterpolationCoefficients(buf, sp, pole, NbPoles, DBL_EPSILON);
-
-                                for ( p=0; p<sp; p++ )
-                                {
-                                    coeff[offset + p*sx*sy*sz*st] = buf[t];
-                                }
-                            }
-                        }
-                    }
+                    T* c = coeff + n*stride;
+                    for ( w=0; w<W; w++ ) c[offset[w]] = buf[n*W+w];
                 }
-
-                delete [] buf;
             }
-        }
-        catch(...)
-        {
-            GERROR_STREAM("Error happened in hoNDBSpline<T, D>::computeBSplineCoefficients(const T* data, size_t sx, size_t sy, size_t sz, size_t st, size_t sp, unsigned int SplineDegree, T* coeff) ... ");
-            return false;
-        }
 
-        return true;
+            delete [] buf;
+        }
     }
 
     template <typename T, unsigned int D> 
@@ -1482,6 +1050,126 @@ namespace Gadgetron
         return this->evaluateBSpline(coeff, dimension, SplineDegree, weight, &pos[0]);
     }
 
+    template <typename T, unsigned int D> 
+    void hoNDBSpline<T, D>::evaluateBSpline(const T* coeff, size_t sx, size_t sy, unsigned int SplineDegree, 
+                                        unsigned int dx, unsigned int dy, 
+                                        size_t N, const coord_type* x, const coord_type* y, T* res)
+    {
+        if ( dx!=0 || dy!=0 || SplineDegree<2 || SplineDegree>9 )
+        {
+            for ( size_t n=0; n<N; n++ ) res[n] = this->evaluateBSpline(coeff, sx, sy, SplineDegree, dx, dy, x[n], y[n]);
+            return;
+        }
+
+        bspline_float_type xWeight[BATCH_TILE_SIZE*10];
+        bspline_float_type yWeight[BATCH_TILE_SIZE*10];
+        long long xStart[BATCH_TILE_SIZE];
+        long long yStart[BATCH_TILE_SIZE];
+        long long offset[BATCH_TILE_SIZE];
+        bool inside[BATCH_TILE_SIZE];
+
+        size_t n, i;
+        for ( n=0; n<N; n+=BATCH_TILE_SIZE )
+        {
+            size_t num = std::min(N-n, (size_t)BATCH_TILE_SIZE);
+
+            computeBSplineTileWeights(sx, SplineDegree, num, x+n, xWeight, xStart, inside, false);
+            computeBSplineTileWeights(sy, SplineDegree, num, y+n, yWeight, yStart, inside, true);
+
+            // points which need the mirror boundary condition are computed point-wise
+            size_t numInside = 0;
+            for ( i=0; i<num; i++ )
+            {
+                offset[i] = inside[i] ? xStart[i] + yStart[i]*(long long)sx : 0;
+                numInside += inside[i];
+            }
+
+            if ( numInside > 0 )
+            {
+                switch (SplineDegree)
+                {
+                    case 2: evaluateBSplineTile<3>(coeff, sx, num, offset, xWeight, yWeight, res+n); break;
+                    case 3: evaluateBSplineTile<4>(coeff, sx, num, offset, xWeight, yWeight, res+n); break;
+                    case 4: evaluateBSplineTile<5>(coeff, sx, num, offset, xWeight, yWeight, res+n); break;
+                    case 5: evaluateBSplineTile<6>(coeff, sx, num, offset, xWeight, yWeight, res+n); break;
+                    case 6: evaluateBSplineTile<7>(coeff, sx, num, offset, xWeight, yWeight, res+n); break;
+                    case 7: evaluateBSplineTile<8>(coeff, sx, num, offset, xWeight, yWeight, res+n); break;
+                    case 8: evaluateBSplineTile<9>(coeff, sx, num, offset, xWeight, yWeight, res+n); break;
+                    case 9: evaluateBSplineTile<10>(coeff, sx, num, offset, xWeight, yWeight, res+n); break;
+                }
+            }
+
+            if ( numInside < num )
+            {
+                for ( i=0; i<num; i++ )
+                {
+                    if ( !inside[i] ) res[n+i] = this->evaluateBSpline(coeff, sx, sy, SplineDegree, dx, dy, x[n+i], y[n+i]);
+                }
+            }
+        }
+    }
+
+    template <typename T, unsigned int D> 
+    void hoNDBSpline<T, D>::evaluateBSpline(const T* coeff, size_t sx, size_t sy, size_t sz, unsigned int SplineDegree, 
+                                        unsigned int dx, unsigned int dy, unsigned int dz, 
+                                        size_t N, const coord_type* x, const coord_type* y, const coord_type* z, T* res)
+    {
+        if ( dx!=0 || dy!=0 || dz!=0 || SplineDegree<2 || SplineDegree>9 )
+        {
+            for ( size_t n=0; n<N; n++ ) res[n] = this->evaluateBSpline(coeff, sx, sy, sz, SplineDegree, dx, dy, dz, x[n], y[n], z[n]);
+            return;
+        }
+
+        bspline_float_type xWeight[BATCH_TILE_SIZE*10];
+        bspline_float_type yWeight[BATCH_TILE_SIZE*10];
+        bspline_float_type zWeight[BATCH_TILE_SIZE*10];
+        long long xStart[BATCH_TILE_SIZE];
+        long long yStart[BATCH_TILE_SIZE];
+        long long zStart[BATCH_TILE_SIZE];
+        long long offset[BATCH_TILE_SIZE];
+        bool inside[BATCH_TILE_SIZE];
+
+        size_t n, i;
+        for ( n=0; n<N; n+=BATCH_TILE_SIZE )
+        {
+            size_t num = std::min(N-n, (size_t)BATCH_TILE_SIZE);
+
+            computeBSplineTileWeights(sx, SplineDegree, num, x+n, xWeight, xStart, inside, false);
+            computeBSplineTileWeights(sy, SplineDegree, num, y+n, yWeight, yStart, inside, true);
+            computeBSplineTileWeights(sz, SplineDegree, num, z+n, zWeight, zStart, inside, true);
+
+            size_t numInside = 0;
+            for ( i=0; i<num; i++ )
+            {
+                offset[i] = inside[i] ? xStart[i] + yStart[i]*(long long)sx + zStart[i]*(long long)(sx*sy) : 0;
+                numInside += inside[i];
+            }
+
+            if ( numInside > 0 )
+            {
+                switch (SplineDegree)
+                {
+                    case 2: evaluateBSplineTile<3>(coeff, sx, sy, num, offset, xWeight, yWeight, zWeight, res+n); break;
+                    case 3: evaluateBSplineTile<4>(coeff, sx, sy, num, offset, xWeight, yWeight, zWeight, res+n); break;
+                    case 4: evaluateBSplineTile<5>(coeff, sx, sy, num, offset, xWeight, yWeight, zWeight, res+n); break;
+                    case 5: evaluateBSplineTile<6>(coeff, sx, sy, num, offset, xWeight, yWeight, zWeight, res+n); break;
+                    case 6: evaluateBSplineTile<7>(coeff, sx, sy, num, offset, xWeight, yWeight, zWeight, res+n); break;
+                    case 7: evaluateBSplineTile<8>(coeff, sx, sy, num, offset, xWeight, yWeight, zWeight, res+n); break;
+                    case 8: evaluateBSplineTile<9>(coeff, sx, sy, num, offset, xWeight, yWeight, zWeight, res+n); break;
+                    case 9: evaluateBSplineTile<10>(coeff, sx, sy, num, offset, xWeight, yWeight, zWeight, res+n); break;
+                }
+            }
+
+            if ( numInside < num )
+            {
+                for ( i=0; i<num; i++ )
+                {
+                    if ( !inside[i] ) res[n+i] = this->evaluateBSpline(coeff, sx, sy, sz, SplineDegree, dx, dy, dz, x[n+i], y[n+i], z[n+i]);
+                }
+            }
+        }
+    }
+
     template <typename T, unsigned int D> 
     bool hoNDBSpline<T, D>::computeBSplineDerivative(const hoNDArray<T>& data, const hoNDArray<T>& coeff, unsigned int SplineDegree, const std::vector<unsigned int>& derivative, hoNDArray<T>& deriv)
     {
@@ -1731,6 +1419,96 @@ namespace Gadgetron
         return((z / (z * z - (bspline_float_type)1.0)) * (z * c[DataLength - 2L] + c[DataLength - 1L]));
     } /* end InitialAntiCausalCoefficient */
 
+    template <typename T, unsigned int D> 
+    void hoNDBSpline<T, D>::ConvertToInterpolationCoefficients(T c[], size_t DataLength, size_t W, bspline_float_type z[], long NbPoles, bspline_float_type Tolerance)
+    {
+        double Lambda = 1.0;
+        long long n;
+        long k;
+        size_t w;
+
+        if (DataLength == 1L)
+        {
+            return;
+        }
+
+        for (k = 0L; k < NbPoles; k++)
+        {
+            Lambda = Lambda * (1.0 - z[k]) * (1.0 - 1.0 / z[k]);
+        }
+
+        for (n = 0L; n < (long long)(DataLength*W); n++)
+        {
+            c[n] *= Lambda;
+        }
+
+        size_t Horizon = DataLength;
+
+        for (k = 0L; k < NbPoles; k++)
+        {
+            const bspline_float_type zk = z[k];
+
+            /* causal initialization, the same as InitialCausalCoefficient for every line */
+            if (Tolerance > 0.0)
+            {
+                Horizon = (size_t)std::ceil(log(Tolerance) / log(fabs(zk)));
+            }
+
+            T Sum[PREFILTER_BLOCK_SIZE];
+
+            if (Horizon < DataLength)
+            {
+                bspline_float_type zn = zk;
+                for (w = 0; w < W; w++) Sum[w] = c[w];
+                for (n = 1; n < (long long)Horizon; n++)
+                {
+                    for (w = 0; w < W; w++) Sum[w] += zn * c[n*W + w];
+                    zn *= zk;
+                }
+                for (w = 0; w < W; w++) c[w] = Sum[w];
+            }
+            else
+            {
+                bspline_float_type zn = zk;
+                bspline_float_type iz = (bspline_float_type)(1.0) / zk;
+                bspline_float_type z2n = pow(zk, (bspline_float_type)(DataLength - 1L));
+                for (w = 0; w < W; w++) Sum[w] = c[w] + z2n * c[(DataLength - 1L)*W + w];
+                z2n *= z2n * iz;
+                for (n = 1L; n <= (long long)DataLength - 2L; n++)
+                {
+                    for (w = 0; w < W; w++) Sum[w] += (zn + z2n) * c[n*W + w];
+                    zn *= zk;
+                    z2n *= iz;
+                }
+                for (w = 0; w < W; w++) c[w] = Sum[w] / (bspline_float_type)(1.0 - zn * zn);
+            }
+
+            /* causal recursion */
+            for (n = 1L; n < (long long)DataLength; n++)
+            {
+                T* cn = c + n*W;
+                const T* cp = cn - W;
+                for (w = 0; w < W; w++) cn[w] += zk * cp[w];
+            }
+
+            /* anticausal initialization */
+            T* cl = c + (DataLength - 1L)*W;
+            const T* cl2 = cl - W;
+            for (w = 0; w < W; w++)
+            {
+                cl[w] = (zk / (zk * zk - (bspline_float_type)1.0)) * (zk * cl2[w] + cl[w]);
+            }
+
+            /* anticausal recursion */
+            for (n = (long long)DataLength - 2L; 0 <= n; n--)
+            {
+                T* cn = c + n*W;
+                const T* cp = cn + W;
+                for (w = 0; w < W; w++) cn[w] = zk * (cp[w] - cn[w]);
+            }
+        }
+    }
+
     template <typename T, unsigned int D> 
     inline void hoNDBSpline<T, D>::Pole(bspline_float_type* Pole, unsigned int SplineDegree, unsigned int& NbPoles)
     {
@@ -2130,4 +1908,103 @@ namespace Gadgetron
 
         BSplineInterpolationMirrorBoundaryCondition(SplineDegree, xIndex, len);
     }
+
+    template <typename T, unsigned int D> 
+    inline void hoNDBSpline<T, D>::computeBSplineTileWeights(size_t len, unsigned int SplineDegree, size_t num, const coord_type* x, 
+                                                            bspline_float_type* weight, long long* start, bool* inside, bool accumulate)
+    {
+        bspline_float_type w[10];
+        long long xIndex[10];
+
+        size_t i;
+        unsigned int k;
+        for ( i=0; i<num; i++ )
+        {
+            if ( !(x[i]>=0) )
+            {
+                // negative locations always need the mirror boundary condition
+                inside[i] = false;
+                start[i] = 0;
+                continue;
+            }
+
+            // for x>=0, the truncation is the floor
+            long long i0 = (SplineDegree & 1) ? (long long)x[i] : (long long)(x[i] + 0.5);
+            for ( k=0; k<=SplineDegree; k++ ) xIndex[k] = i0 - (long long)(SplineDegree/2) + k;
+
+            BSplineDiscrete(x[i], SplineDegree, w, xIndex);
+
+            bool in = (xIndex[0]>=0) && (xIndex[SplineDegree]<(long long)len);
+            inside[i] = accumulate ? (inside[i] && in) : in;
+
+            start[i] = xIndex[0];
+            for ( k=0; k<=SplineDegree; k++ ) weight[i*(SplineDegree+1)+k] = w[k];
+        }
+    }
+
+    template <typename T, unsigned int D> 
+    template <unsigned int L> 
+    inline void hoNDBSpline<T, D>::evaluateBSplineTile(const T* coeff, size_t sx, size_t num, const long long* offset, 
+                                                        const bspline_float_type* xWeight, const bspline_float_type* yWeight, T* res)
+    {
+        // the sum is computed separably, the L row sums are independent and can be evaluated in parallel by the cpu
+        size_t i;
+        unsigned int ix, iy;
+        for ( i=0; i<num; i++ )
+        {
+            const T* c = coeff + offset[i];
+            const bspline_float_type* xw = xWeight + i*L;
+            const bspline_float_type* yw = yWeight + i*L;
+
+            T r[L];
+            for ( iy=0; iy<L; iy++ )
+            {
+                const T* cc = c + iy*sx;
+
+                r[iy] = cc[0] * xw[0];
+                for ( ix=1; ix<L; ix++ ) r[iy] += cc[ix] * xw[ix];
+            }
+
+            T v = r[0] * yw[0];
+            for ( iy=1; iy<L; iy++ ) v += r[iy] * yw[iy];
+
+            res[i] = v;
+        }
+    }
+
+    template <typename T, unsigned int D> 
+    template <unsigned int L> 
+    inline void hoNDBSpline<T, D>::evaluateBSplineTile(const T* coeff, size_t sx, size_t sy, size_t num, const long long* offset, 
+                                                        const bspline_float_type* xWeight, const bspline_float_type* yWeight, const bspline_float_type* zWeight, T* res)
+    {
+        size_t i;
+        unsigned int ix, iy, iz;
+        for ( i=0; i<num; i++ )
+        {
+            const T* c = coeff + offset[i];
+            const bspline_float_type* xw = xWeight + i*L;
+            const bspline_float_type* yw = yWeight + i*L;
+            const bspline_float_type* zw = zWeight + i*L;
+
+            T v = 0;
+            for ( iz=0; iz<L; iz++ )
+            {
+                T r[L];
+                for ( iy=0; iy<L; iy++ )
+                {
+                    const T* cc = c + iy*sx + iz*sx*sy;
+
+                    r[iy] = cc[0] * xw[0];
+                    for ( ix=1; ix<L; ix++ ) r[iy] += cc[ix] * xw[ix];
+                }
+
+                T p = r[0] * yw[0];
+                for ( iy=1; iy<L; iy++ ) p += r[iy] * yw[iy];
+
+                v += p * zw[iz];
+            }
+
+            res[i] = v;
+        }
+    }
 }
@@ -2,6 +2,8 @@
 
 #include "hoNDArray.h"
 #include "vector_td_utilities.h"
+#include <algorithm>
+#include <cstring>
 
 #ifdef USE_OMP
 #include <omp.h>
@@ -89,6 +91,199 @@ namespace Gadgetron {
     permute(in,out,&order);
   }
 
+  /**
+     Merges the dimensions of a permutation which stay neighbours and drops the dimensions of size 1.
+     The permutation of dims by order is the permutation of merged_dims by merged_order.
+  */
+  inline void
+  permute_merge_dimensions(const std::vector<size_t>& dims, const std::vector<size_t>& order, std::vector<size_t>& merged_dims, std::vector<size_t>& merged_order)
+  {
+    // the dimensions of size 1 are removed, the others renumbered
+    std::vector<size_t> rank(dims.size(), 0);
+    size_t num = 0;
+    for (size_t d = 0; d < dims.size(); d++) {
+      if (dims[d] > 1) rank[d] = num++;
+    }
+
+    // groups of input dimensions, in output order
+    std::vector<size_t> first, size;
+    size_t prev = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+      size_t d = order[i];
+      if (dims[d] == 1) continue;
+
+      if (!first.empty() && rank[d] == prev + 1) {
+        size.back() *= dims[d];
+      }
+      else {
+        first.push_back(rank[d]);
+        size.push_back(dims[d]);
+      }
+      prev = rank[d];
+    }
+
+    size_t G = first.size();
+    std::vector<size_t> input_order(G);
+    for (size_t g = 0; g < G; g++) input_order[g] = g;
+    std::sort(input_order.begin(), input_order.end(), [&first](size_t a, size_t b) { return first[a] < first[b]; });
+
+    merged_dims.resize(G);
+    merged_order.resize(G);
+    for (size_t r = 0; r < G; r++) {
+      merged_dims[r] = size[input_order[r]];
+      merged_order[input_order[r]] = r;
+    }
+  }
+
+  /**
+     Tiled, parallel permutation of the column major array in with dimensions dims into out: output dimension i is input dimension order[i].
+
+     If the first input dimension stays the first dimension, lines are copied. Otherwise the first input dimension and the first
+     output dimension are transposed in tiles of about 32 KB, so both arrays are accessed in whole cache lines.
+     The tiles and the remaining dimensions are distributed over the threads.
+  */
+  template<class T> void
+  permute_array(const T* in, T* out, const std::vector<size_t>& dims, const std::vector<size_t>& order)
+  {
+    std::vector<size_t> mdims, morder;
+    permute_merge_dimensions(dims, order, mdims, morder);
+
+    size_t R = mdims.size();
+    size_t N = 1;
+    for (size_t r = 0; r < R; r++) N *= mdims[r];
+
+    if (R <= 1) {
+      memcpy(out, in, sizeof(T)*N);
+      return;
+    }
+
+    std::vector<size_t> in_stride(R, 1), out_stride(R, 1);
+    for (size_t r = 1; r < R; r++) in_stride[r] = in_stride[r-1]*mdims[r-1];
+
+    size_t stride = 1;
+    for (size_t k = 0; k < R; k++) {
+      out_stride[morder[k]] = stride;
+      stride *= mdims[morder[k]];
+    }
+
+    const size_t n0 = mdims[0];
+    const size_t a = morder[0];
+
+    if (a == 0) {
+      // the first dimension is kept, lines of n0 elements are copied
+      long long l;
+#pragma omp parallel for private(l) if (N>64*1024)
+      for (l = 0; l < (long long)(N/n0); l++) {
+        size_t o = (size_t)l;
+        size_t offset_out = 0;
+        for (size_t r = 1; r < R; r++) {
+          offset_out += (o % mdims[r])*out_stride[r];
+          o /= mdims[r];
+        }
+        memcpy(out + offset_out, in + l*n0, sizeof(T)*n0);
+      }
+      return;
+    }
+
+    // the first input and output dimensions are transposed in tiles, the loop runs over the tiles and the other dimensions
+    std::vector<size_t> outer;
+    for (size_t r = 1; r < R; r++) {
+      if (r != a) outer.push_back(r);
+    }
+
+    size_t num_outer = 1;
+    for (size_t k = 0; k < outer.size(); k++) num_outer *= mdims[outer[k]];
+
+    const size_t tile = (sizeof(T) <= 8) ? 64 : 32;
+
+    const size_t na = mdims[a];
+    const size_t in_stride_a = in_stride[a];
+    const size_t out_stride_0 = out_stride[0];
+    const size_t num_tiles_a = (na + tile - 1) / tile;
+
+    long long u;
+#pragma omp parallel for private(u) if (N>64*1024)
+    for (u = 0; u < (long long)(num_outer*num_tiles_a); u++) {
+      size_t o = (size_t)u / num_tiles_a;
+      size_t ja = ((size_t)u % num_tiles_a) * tile;
+      size_t je = std::min(ja + tile, na);
+
+      size_t offset_in = 0, offset_out = 0;
+      for (size_t k = 0; k < outer.size(); k++) {
+        size_t ind = o % mdims[outer[k]];
+        o /= mdims[outer[k]];
+        offset_in += ind*in_stride[outer[k]];
+        offset_out += ind*out_stride[outer[k]];
+      }
+
+      const T* pIn = in + offset_in;
+      T* pOut = out + offset_out;
+
+      for (size_t i0 = 0; i0 < n0; i0 += tile) {
+        size_t ie = std::min(i0 + tile, n0);
+        for (size_t i = i0; i < ie; i++) {
+          T* po = pOut + i*out_stride_0;
+          const T* pi = pIn + i;
+          for (size_t j = ja; j < je; j++) po[j] = pi[j*in_stride_a];
+        }
+      }
+    }
+  }
+
+  /**
+     In-place permutation of an array whose permutation is a transpose of two equal dimensions, e.g. [RO E1 ...] -> [E1 RO ...] for a square
+     image, or a batch of such transposes. Returns false for other permutations.
+  */
+  template<class T> bool
+  permute_array_in_place(T* data, const std::vector<size_t>& dims, const std::vector<size_t>& order)
+  {
+    std::vector<size_t> mdims, morder;
+    permute_merge_dimensions(dims, order, mdims, morder);
+
+    size_t R = mdims.size();
+    if (R < 2) return true;
+
+    // the two transposed dimensions are the first ones, or they are neighbours inside the array
+    size_t a = 0;
+    while (a < R && morder[a] == a) a++;
+    if (a + 1 >= R || morder[a] != a + 1 || morder[a+1] != a || mdims[a] != mdims[a+1]) return false;
+    for (size_t r = a + 2; r < R; r++) {
+      if (morder[r] != r) return false;
+    }
+
+    size_t L = 1;
+    for (size_t r = 0; r < a; r++) L *= mdims[r];
+
+    const size_t n = mdims[a];
+    size_t num_batch = 1;
+    for (size_t r = a + 2; r < R; r++) num_batch *= mdims[r];
+
+    const size_t tile = (sizeof(T)*L <= 8) ? 64 : 32;
+    const size_t num_tiles = (n + tile - 1) / tile;
+
+    // tile pairs (ti, tj) with tj >= ti, each swapped with its mirror
+    long long u;
+#pragma omp parallel for private(u) if (num_batch*n*n*L>64*1024)
+    for (u = 0; u < (long long)(num_batch*num_tiles); u++) {
+      size_t b = (size_t)u / num_tiles;
+      size_t ti = ((size_t)u % num_tiles) * tile;
+      T* p = data + b*n*n*L;
+
+      for (size_t tj = ti; tj < n; tj += tile) {
+        for (size_t i = ti; i < std::min(ti + tile, n); i++) {
+          size_t j0 = (tj == ti) ? i + 1 : tj;
+          for (size_t j = j0; j < std::min(tj + tile, n); j++) {
+            T* x = p + (i + j*n)*L;
+            T* y = p + (j + i*n)*L;
+            for (size_t l = 0; l < L; l++) std::swap(x[l], y[l]);
+          }
+        }
+      }
+    }
+
+    return true;
+  }
+
   template<class T> boost::shared_ptr< hoNDArray<T> > 
   permute( hoNDArray<T> *in, std::vector<size_t> *dim_order, int shift_mode = 0) 
   {
@@ -99,12 +294,16 @@ namespace Gadgetron {
     std::vector<size_t> dims;
     for (size_t i = 0; i < dim_order->size(); i++)
       dims.push_back(in->get_dimensions()->at(dim_order->at(i)));
+    // the dimensions not in the order array follow
+    for (size_t i = 0; i < in->get_number_of_dimensions(); i++)
+      if (std::find(dim_order->begin(), dim_order->end(), i) == dim_order->end()) dims.push_back(in->get_size(i));
     boost::shared_ptr< hoNDArray<T> > out( new hoNDArray<T>() );    
     out->create(&dims);
     permute( in, out.get(), dim_order, shift_mode );
     return out;
   }
 
+  /// in may be out, the array is then permuted and reshaped; this is done without a copy for the transpose of two equal dimensions
   template<class T> void 
   permute( hoNDArray<T> *in, hoNDArray<T> *out, std::vector<size_t> *dim_order, int shift_mode = 0) 
   {
@@ -112,10 +311,6 @@ namespace Gadgetron {
       throw std::runtime_error("permute(): invalid pointer provided");;
     }    
 
-    if( in == out ){
-      throw std::runtime_error("permute(): in-place permutation not supported");;
-    }   
-
     // Check ordering array
     if (dim_order->size() > in->get_number_of_dimensions()) {
       throw std::runtime_error("hoNDArray::permute - Invalid length of dimension ordering array");;
@@ -141,12 +336,6 @@ namespace Gadgetron {
       dim_order_int.push_back((*dim_order)[i]);
     }
 
-    for (size_t i = 0; i < dim_order_int.size(); i++) {
-      if ((*in->get_dimensions())[dim_order_int[i]] != out->get_size(i)) {
-        throw std::runtime_error("permute(): dimensions of output array do not match the input array");;
-      }
-    }
-
     // Pad dimension order array with dimension not mentioned in order array
     if (dim_order_int.size() < in->get_number_of_dimensions()) {
       for (size_t i = 0; i < dim_count.size(); i++) {
@@ -156,68 +345,32 @@ namespace Gadgetron {
       }
     }
 
-    T* o = out->get_data_ptr();
-
-    // if memcpy can be used during permute
-    size_t stride = 1;
-    size_t num_dim_memcpy = 0;
-    for (size_t i = 0; i < dim_order_int.size(); i++) {
-        if (dim_order_int[i]==i){
-            stride *= in->get_size(i);
-            num_dim_memcpy = i;
-        }
-        else{
-            break;
-        }
-    }
-
-    if (stride == 1) {
-        // point by point assignment is needed
-        ArrayIterator it(in->get_dimensions().get(), &dim_order_int);
-        for (size_t i = 0; i < in->get_number_of_elements(); i++) {
-            o[i] = in->get_data_ptr()[it.get_current_idx()];
-            it.advance();
-        }
-    }
-    else {
-        // memcpy can be used
-
-        size_t nDim = in->get_number_of_dimensions();
-        size_t num_memcpy = in->get_number_of_elements() / stride;
-
-        if (num_dim_memcpy == nDim - 1){
-            memcpy(out->begin(), in->begin(), in->get_number_of_bytes());
-            return;
-        }
-
-        // for the array index calculation
-        std::vector<size_t> dim_permute(nDim-num_dim_memcpy-1);
-        for (size_t i = num_dim_memcpy+1; i < dim_order_int.size(); i++) {
-            dim_permute[i - num_dim_memcpy - 1] = in->get_size(i);
-        }
-
-        size_t n;
-
-        hoNDArray<T> permuteArray(dim_permute, in->begin(), false);
+    std::vector<size_t> dims = *in->get_dimensions();
 
-        // starting index for in and out array for every permute memcpy operation
-        std::vector<size_t> ind_permute_in(dim_permute.size(), 0), ind_in(nDim, 0), ind_out(nDim, 0);
+    if( in == out ){
+      std::vector<size_t> dims_out(dims.size());
+      for (size_t i = 0; i < dims.size(); i++) dims_out[i] = dims[dim_order_int[i]];
 
-        for (n = 0; n < num_memcpy; n++) {
-            permuteArray.calculate_index(n, ind_permute_in);
-            memcpy(&ind_in[0] + num_dim_memcpy + 1, &ind_permute_in[0], sizeof(size_t)*ind_permute_in.size());
+      if (!permute_array_in_place(in->begin(), dims, dim_order_int)) {
+        hoNDArray<T> tmp(*in);
+        permute_array(tmp.begin(), in->begin(), dims, dim_order_int);
+      }
 
-            // permute the indexes
-            for (size_t i = 0; i < nDim; i++) {
-                ind_out[i] = ind_in[dim_order_int[i]];
-            }
+      in->reshape(dims_out);
+      return;
+    }
 
-            size_t offset_in = in->calculate_offset(ind_in);
-            size_t offset_out = out->calculate_offset(ind_out);
+    for (size_t i = 0; i < dim_order->size(); i++) {
+      if (dims[dim_order_int[i]] != out->get_size(i)) {
+        throw std::runtime_error("permute(): dimensions of output array do not match the input array");;
+      }
+    }
 
-            memcpy(o + offset_out, in->begin() + offset_in, sizeof(T)*stride);
-        }
+    if (in->get_number_of_elements() != out->get_number_of_elements()) {
+      throw std::runtime_error("permute(): dimensions of output array do not match the input array");;
     }
+
+    permute_array(in->begin(), out->begin(), dims, dim_order_int);
   }
 
   // Expand array to new dimension
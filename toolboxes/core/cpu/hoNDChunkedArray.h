@@ -0,0 +1,375 @@
+/** \file       hoNDChunkedArray.h
+    \brief      N-dimensional array stored in chunks of a memory mapped file, for buffers larger than the memory
+
+                The array is split into chunks of a fixed shape; every chunk is stored contiguously, column major,
+                in the file. A chunk is available as an hoNDArray view, so the existing toolboxes process the array
+                chunk by chunk, e.g. with chunks of [RO E1 E2 CHA 1 1 1] a 3D FFT or coil combination runs on one
+                N/S slab at a time. The chunk shape should follow the iteration order of the recon.
+
+                Chunks are mapped when first used; prefetch() asks the OS to read a chunk ahead, release() writes it
+                back and unmaps it so its pages can be reclaimed:
+
+                    for (c = 0; c < a.get_number_of_chunks(); c++)
+                    {
+                        if (c + 1 < a.get_number_of_chunks()) a.prefetch(c + 1);
+                        a.get_chunk(c, slab);
+                        hoNDFFT<float>::instance()->fft3c(slab);
+                        a.release(c);
+                    }
+
+                If the chunks are whole slabs of the outer dimensions, the chunked layout is the column major layout
+                and get_array_view() gives the whole array as one hoNDArray.
+*/
+
+#pragma once
+
+#include "hoNDArray.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Gadgetron
+{
+    template <typename T>
+    class hoNDChunkedArray
+    {
+    public:
+
+        /**
+           Creates the file, its old content is lost.
+           chunk_dimensions has the size of dimensions, a chunk at the end of a dimension may be smaller.
+           If remove_file is true, the file is deleted by the destructor.
+        */
+        hoNDChunkedArray(const std::vector<size_t>& dimensions, const std::vector<size_t>& chunk_dimensions, const std::string& filename, bool remove_file = true);
+        ~hoNDChunkedArray();
+
+        const std::vector<size_t>& get_dimensions() const { return dimensions_; }
+        const std::vector<size_t>& get_chunk_dimensions() const { return chunk_dimensions_; }
+        size_t get_number_of_elements() const { return num_elements_; }
+        size_t get_number_of_chunks() const { return chunk_offsets_.size(); }
+
+        /// first element and extent of a chunk in the array
+        std::vector<size_t> get_chunk_start(size_t c) const;
+        std::vector<size_t> get_chunk_size(size_t c) const;
+
+        /// the chunk of an element
+        size_t get_chunk_index(const std::vector<size_t>& ind) const;
+
+        /// view of a chunk, valid until the chunk is released
+        void get_chunk(size_t c, hoNDArray<T>& view);
+
+        /// hint that the chunk will be used soon
+        void prefetch(size_t c);
+
+        /// writes the chunk to the file and unmaps it, views of the chunk become invalid
+        void release(size_t c);
+
+        /// writes all mapped chunks to the file
+        void flush();
+
+        /// the whole array as one view; false if the chunks are not in column major order
+        bool get_array_view(hoNDArray<T>& view);
+
+        /// element access, maps the chunk of the element
+        T& operator()(const std::vector<size_t>& ind);
+
+        /// copy between the chunked array and an array of the same dimensions, chunk by chunk
+        void copy_from(const hoNDArray<T>& x);
+        void copy_to(hoNDArray<T>& x);
+
+    protected:
+
+        typedef boost::interprocess::mapped_region MappedRegion;
+
+        T* map_chunk(size_t c);
+
+        /// copy the lines along the first dimension between a chunk and a column major array
+        void copy_chunk(size_t c, T* array, bool to_chunk);
+
+        std::vector<size_t> dimensions_;
+        std::vector<size_t> chunk_dimensions_;
+        std::vector<size_t> chunk_grid_;
+        size_t num_elements_;
+
+        /// element offset of every chunk in the file
+        std::vector<size_t> chunk_offsets_;
+
+        std::string filename_;
+        bool remove_file_;
+
+        boost::interprocess::file_mapping file_;
+        std::vector< std::unique_ptr<MappedRegion> > chunks_;
+        std::unique_ptr<MappedRegion> whole_;
+        std::mutex mutex_;
+    };
+
+    template <typename T>
+    hoNDChunkedArray<T>::hoNDChunkedArray(const std::vector<size_t>& dimensions, const std::vector<size_t>& chunk_dimensions, const std::string& filename, bool remove_file)
+        : dimensions_(dimensions), chunk_dimensions_(chunk_dimensions), filename_(filename), remove_file_(remove_file)
+    {
+        GADGET_CHECK_THROW(!dimensions_.empty() && dimensions_.size() == chunk_dimensions_.size());
+
+        size_t D = dimensions_.size();
+        size_t num_chunks = 1;
+        num_elements_ = 1;
+
+        chunk_grid_.resize(D);
+        for (size_t d = 0; d < D; d++)
+        {
+            GADGET_CHECK_THROW(dimensions_[d] > 0 && chunk_dimensions_[d] > 0);
+            if (chunk_dimensions_[d] > dimensions_[d]) chunk_dimensions_[d] = dimensions_[d];
+
+            chunk_grid_[d] = (dimensions_[d] + chunk_dimensions_[d] - 1) / chunk_dimensions_[d];
+            num_chunks *= chunk_grid_[d];
+            num_elements_ *= dimensions_[d];
+        }
+
+        chunk_offsets_.resize(num_chunks);
+        size_t offset = 0;
+        for (size_t c = 0; c < num_chunks; c++)
+        {
+            chunk_offsets_[c] = offset;
+
+            std::vector<size_t> size = this->get_chunk_size(c);
+            size_t n = 1;
+            for (size_t d = 0; d < D; d++) n *= size[d];
+            offset += n;
+        }
+
+        // a sparse file of the size of the array
+        {
+            std::filebuf fbuf;
+            if (!fbuf.open(filename_.c_str(), std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios_base::binary))
+            {
+                GADGET_THROW("hoNDChunkedArray, unable to create the file " + filename_);
+            }
+            fbuf.pubseekoff(num_elements_*sizeof(T) - 1, std::ios_base::beg);
+            fbuf.sputc(0);
+        }
+
+        file_ = boost::interprocess::file_mapping(filename_.c_str(), boost::interprocess::read_write);
+        chunks_.resize(num_chunks);
+    }
+
+    template <typename T>
+    hoNDChunkedArray<T>::~hoNDChunkedArray()
+    {
+        chunks_.clear();
+        whole_.reset();
+        file_ = boost::interprocess::file_mapping();
+
+        if (remove_file_) std::remove(filename_.c_str());
+    }
+
+    template <typename T>
+    std::vector<size_t> hoNDChunkedArray<T>::get_chunk_start(size_t c) const
+    {
+        std::vector<size_t> start(dimensions_.size());
+        for (size_t d = 0; d < dimensions_.size(); d++)
+        {
+            start[d] = (c % chunk_grid_[d]) * chunk_dimensions_[d];
+            c /= chunk_grid_[d];
+        }
+        return start;
+    }
+
+    template <typename T>
+    std::vector<size_t> hoNDChunkedArray<T>::get_chunk_size(size_t c) const
+    {
+        std::vector<size_t> start = this->get_chunk_start(c);
+        std::vector<size_t> size(dimensions_.size());
+        for (size_t d = 0; d < dimensions_.size(); d++)
+        {
+            size[d] = std::min(chunk_dimensions_[d], dimensions_[d] - start[d]);
+        }
+        return size;
+    }
+
+    template <typename T>
+    size_t hoNDChunkedArray<T>::get_chunk_index(const std::vector<size_t>& ind) const
+    {
+        size_t c = 0;
+        for (size_t d = dimensions_.size(); d-- > 0; )
+        {
+            c = c*chunk_grid_[d] + ind[d] / chunk_dimensions_[d];
+        }
+        return c;
+    }
+
+    template <typename T>
+    T* hoNDChunkedArray<T>::map_chunk(size_t c)
+    {
+        GADGET_CHECK_THROW(c < chunks_.size());
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (whole_) return reinterpret_cast<T*>(whole_->get_address()) + chunk_offsets_[c];
+
+        if (!chunks_[c])
+        {
+            size_t end = (c + 1 < chunk_offsets_.size()) ? chunk_offsets_[c + 1] : num_elements_;
+            chunks_[c].reset(new MappedRegion(file_, boost::interprocess::read_write, chunk_offsets_[c] * sizeof(T), (end - chunk_offsets_[c]) * sizeof(T)));
+        }
+
+        return reinterpret_cast<T*>(chunks_[c]->get_address());
+    }
+
+    template <typename T>
+    void hoNDChunkedArray<T>::get_chunk(size_t c, hoNDArray<T>& view)
+    {
+        std::vector<size_t> size = this->get_chunk_size(c);
+        view.create(size, this->map_chunk(c), false);
+    }
+
+    template <typename T>
+    void hoNDChunkedArray<T>::prefetch(size_t c)
+    {
+        this->map_chunk(c);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (chunks_[c]) chunks_[c]->advise(MappedRegion::advice_willneed);
+    }
+
+    template <typename T>
+    void hoNDChunkedArray<T>::release(size_t c)
+    {
+        GADGET_CHECK_THROW(c < chunks_.size());
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!chunks_[c]) return;
+
+        chunks_[c]->flush(0, 0, false);
+        chunks_[c].reset();
+    }
+
+    template <typename T>
+    void hoNDChunkedArray<T>::flush()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t c = 0; c < chunks_.size(); c++)
+        {
+            if (chunks_[c]) chunks_[c]->flush();
+        }
+        if (whole_) whole_->flush();
+    }
+
+    template <typename T>
+    bool hoNDChunkedArray<T>::get_array_view(hoNDArray<T>& view)
+    {
+        // full chunks up to a dimension k, single elements after it
+        size_t D = dimensions_.size();
+        size_t k = 0;
+        while (k < D && chunk_dimensions_[k] == dimensions_[k]) k++;
+        for (size_t d = k + 1; d < D; d++)
+        {
+            if (chunk_dimensions_[d] != 1) return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // the chunk mappings are replaced by one mapping of the file
+            for (size_t c = 0; c < chunks_.size(); c++)
+            {
+                if (chunks_[c])
+                {
+                    chunks_[c]->flush();
+                    chunks_[c].reset();
+                }
+            }
+
+            if (!whole_) whole_.reset(new MappedRegion(file_, boost::interprocess::read_write, 0, num_elements_ * sizeof(T)));
+        }
+
+        std::vector<size_t> dims = dimensions_;
+        view.create(dims, reinterpret_cast<T*>(whole_->get_address()), false);
+        return true;
+    }
+
+    template <typename T>
+    T& hoNDChunkedArray<T>::operator()(const std::vector<size_t>& ind)
+    {
+        size_t c = this->get_chunk_index(ind);
+        std::vector<size_t> start = this->get_chunk_start(c);
+        std::vector<size_t> size = this->get_chunk_size(c);
+
+        size_t offset = 0;
+        for (size_t d = dimensions_.size(); d-- > 0; )
+        {
+            offset = offset*size[d] + (ind[d] - start[d]);
+        }
+
+        return this->map_chunk(c)[offset];
+    }
+
+    template <typename T>
+    void hoNDChunkedArray<T>::copy_chunk(size_t c, T* array, bool to_chunk)
+    {
+        size_t D = dimensions_.size();
+        std::vector<size_t> start = this->get_chunk_start(c);
+        std::vector<size_t> size = this->get_chunk_size(c);
+        T* chunk = this->map_chunk(c);
+
+        size_t num_lines = 1;
+        for (size_t d = 1; d < D; d++) num_lines *= size[d];
+
+        std::vector<size_t> ind(D, 0);
+        for (size_t l = 0; l < num_lines; l++)
+        {
+            // array offset of the line
+            size_t offset = 0;
+            for (size_t d = D; d-- > 0; )
+            {
+                offset = offset*dimensions_[d] + start[d] + ind[d];
+            }
+
+            if (to_chunk)
+            {
+                memcpy(chunk + l*size[0], array + offset, sizeof(T)*size[0]);
+            }
+            else
+            {
+                memcpy(array + offset, chunk + l*size[0], sizeof(T)*size[0]);
+            }
+
+            for (size_t d = 1; d < D; d++)
+            {
+                if (++ind[d] < size[d]) break;
+                ind[d] = 0;
+            }
+        }
+    }
+
+    template <typename T>
+    void hoNDChunkedArray<T>::copy_from(const hoNDArray<T>& x)
+    {
+        GADGET_CHECK_THROW(x.get_number_of_elements() == num_elements_);
+        for (size_t c = 0; c < chunks_.size(); c++)
+        {
+            this->copy_chunk(c, const_cast<T*>(x.begin()), true);
+            if (!whole_) this->release(c);
+        }
+    }
+
+    template <typename T>
+    void hoNDChunkedArray<T>::copy_to(hoNDArray<T>& x)
+    {
+        std::vector<size_t> dims = dimensions_;
+        if (x.get_number_of_elements() != num_elements_) x.create(dims);
+
+        for (size_t c = 0; c < chunks_.size(); c++)
+        {
+            if (!whole_ && c + 1 < chunks_.size()) this->prefetch(c + 1);
+            this->copy_chunk(c, x.begin(), false);
+            if (!whole_) this->release(c);
+        }
+    }
+}
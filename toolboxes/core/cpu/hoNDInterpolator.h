@@ -125,8 +125,23 @@ namespace Gadgetron
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q ) = 0;
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q, coord_type u ) = 0;
 
+        /// interpolate N points in one call, the coordinates are given in the structure-of-arrays layout
+        /// res has N elements; the default implementation calls the point-wise operator() for every point
+        virtual void interpolate( size_t N, const coord_type* x, const coord_type* y, T* res )
+        {
+            for ( size_t n=0; n<N; n++ ) res[n] = this->operator()(x[n], y[n]);
+        }
+
+        virtual void interpolate( size_t N, const coord_type* x, const coord_type* y, const coord_type* z, T* res )
+        {
+            for ( size_t n=0; n<N; n++ ) res[n] = this->operator()(x[n], y[n], z[n]);
+        }
+
     protected:
 
+        /// number of points in a tile for the batched interpolation
+        enum { BATCH_TILE_SIZE = 64 };
+
         ArrayType* array_;
         T* data_;
         BoundHanlderType* bh_;
@@ -210,6 +225,10 @@ namespace Gadgetron
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q );
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q, coord_type u );
 
+        /// batched interpolation; tiles of points inside the array are computed without the boundary handler
+        virtual void interpolate( size_t N, const coord_type* x, const coord_type* y, T* res );
+        virtual void interpolate( size_t N, const coord_type* x, const coord_type* y, const coord_type* z, T* res );
+
     protected:
 
         using BaseClass::array_;
@@ -221,6 +240,8 @@ namespace Gadgetron
         using BaseClass::sz_;
         using BaseClass::st_;
 
+        using BaseClass::BATCH_TILE_SIZE;
+
         // number of points involved in interpolation
         unsigned int number_of_points_;
     };
@@ -257,6 +278,10 @@ namespace Gadgetron
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q );
         virtual T operator()( coord_type x, coord_type y, coord_type z, coord_type s, coord_type p, coord_type r, coord_type a, coord_type q, coord_type u );
 
+        /// batched interpolation; tiles of points inside the array are evaluated by hoNDBSpline without the boundary handler
+        virtual void interpolate( size_t N, const coord_type* x, const coord_type* y, T* res );
+        virtual void interpolate( size_t N, const coord_type* x, const coord_type* y, const coord_type* z, T* res );
+
      protected:
 
         using BaseClass::array_;
@@ -268,6 +293,8 @@ namespace Gadgetron
         using BaseClass::sz_;
         using BaseClass::st_;
 
+        using BaseClass::BATCH_TILE_SIZE;
+
         hoNDBSpline<T, D> bspline_;
         std::vector<size_t> dimension_;
         std::vector<unsigned int> derivative_;
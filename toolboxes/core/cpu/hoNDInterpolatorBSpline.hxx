@@ -32,7 +32,7 @@ namespace Gadgetron
     template <typename ArrayType, unsigned int D> 
     void hoNDInterpolatorBSpline<ArrayType, D>::setArray(ArrayType& a)
     {
-        this->array_ = &a;
+        BaseClass::setArray(a);
 
         dimension_.resize(D);
 
@@ -336,4 +336,87 @@ namespace Gadgetron
             return (*bh_)(anchor[0], anchor[1], anchor[2], anchor[3], anchor[4], anchor[5], anchor[6], anchor[7], anchor[8]);
         }
     }
+
+    template <typename ArrayType, unsigned int D> 
+    void hoNDInterpolatorBSpline<ArrayType, D>::interpolate( size_t N, const coord_type* x, const coord_type* y, T* res )
+    {
+        // for x>=0, floor(x)<sx-1 is the same as x<sx-1
+        const coord_type ex = (coord_type)( (long long)sx_-1 );
+        const coord_type ey = (coord_type)( (long long)sy_-1 );
+
+        bool inside[BATCH_TILE_SIZE];
+
+        size_t n, i, j;
+        for ( n=0; n<N; n+=BATCH_TILE_SIZE )
+        {
+            size_t num = std::min(N-n, (size_t)BATCH_TILE_SIZE);
+
+            const coord_type* px = x + n;
+            const coord_type* py = y + n;
+            T* pr = res + n;
+
+            for ( i=0; i<num; i++ )
+            {
+                inside[i] = (px[i]>=0) & (px[i]<ex) & (py[i]>=0) & (py[i]<ey);
+            }
+
+            // runs of points inside the array are evaluated together
+            for ( i=0; i<num; )
+            {
+                if ( !inside[i] )
+                {
+                    pr[i] = Self::operator()(px[i], py[i]);
+                    i++;
+                    continue;
+                }
+
+                for ( j=i; j<num && inside[j]; j++ ) {}
+
+                bspline_.evaluateBSpline(coeff_.begin(), dimension_[0], dimension_[1], order_, derivative_[0], derivative_[1], j-i, px+i, py+i, pr+i);
+                i = j;
+            }
+        }
+    }
+
+    template <typename ArrayType, unsigned int D> 
+    void hoNDInterpolatorBSpline<ArrayType, D>::interpolate( size_t N, const coord_type* x, const coord_type* y, const coord_type* z, T* res )
+    {
+        const coord_type ex = (coord_type)( (long long)sx_-1 );
+        const coord_type ey = (coord_type)( (long long)sy_-1 );
+        const coord_type ez = (coord_type)( (long long)sz_-1 );
+
+        bool inside[BATCH_TILE_SIZE];
+
+        size_t n, i, j;
+        for ( n=0; n<N; n+=BATCH_TILE_SIZE )
+        {
+            size_t num = std::min(N-n, (size_t)BATCH_TILE_SIZE);
+
+            const coord_type* px = x + n;
+            const coord_type* py = y + n;
+            const coord_type* pz = z + n;
+            T* pr = res + n;
+
+            for ( i=0; i<num; i++ )
+            {
+                inside[i] = (px[i]>=0) & (px[i]<ex) & (py[i]>=0) & (py[i]<ey) & (pz[i]>=0) & (pz[i]<ez);
+            }
+
+            for ( i=0; i<num; )
+            {
+                if ( !inside[i] )
+                {
+                    pr[i] = Self::operator()(px[i], py[i], pz[i]);
+                    i++;
+                    continue;
+                }
+
+                for ( j=i; j<num && inside[j]; j++ ) {}
+
+                bspline_.evaluateBSpline(coeff_.begin(), dimension_[0], dimension_[1], dimension_[2], 
+                    order_, derivative_[0], derivative_[1], derivative_[2], j-i, px+i, py+i, pz+i, pr+i);
+                i = j;
+            }
+        }
+    }
 }
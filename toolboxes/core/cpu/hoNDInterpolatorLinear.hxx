@@ -871,4 +871,129 @@ namespace Gadgetron
 
         return res;
     }
+
+    template <typename ArrayType> 
+    void hoNDInterpolatorLinear<ArrayType>::interpolate( size_t N, const coord_type* x, const coord_type* y, T* res )
+    {
+        const T* data = array_->begin();
+
+        // for x>=0, floor(x)<sx-1 is the same as x<sx-1
+        const coord_type ex = (coord_type)( (long long)sx_-1 );
+        const coord_type ey = (coord_type)( (long long)sy_-1 );
+
+        bool inside[BATCH_TILE_SIZE];
+
+        size_t n, i, j;
+        for ( n=0; n<N; n+=BATCH_TILE_SIZE )
+        {
+            size_t num = std::min(N-n, (size_t)BATCH_TILE_SIZE);
+
+            const coord_type* px = x + n;
+            const coord_type* py = y + n;
+            T* pr = res + n;
+
+            for ( i=0; i<num; i++ )
+            {
+                inside[i] = (px[i]>=0) & (px[i]<ex) & (py[i]>=0) & (py[i]<ey);
+            }
+
+            // runs of points inside the array are interpolated without the boundary handler
+            for ( i=0; i<num; )
+            {
+                if ( !inside[i] )
+                {
+                    pr[i] = Self::operator()(px[i], py[i]);
+                    i++;
+                    continue;
+                }
+
+                for ( j=i; j<num && inside[j]; j++ ) {}
+
+                for ( ; i<j; i++ )
+                {
+                    size_t ix = static_cast<size_t>(px[i]);
+                    size_t iy = static_cast<size_t>(py[i]);
+
+                    coord_type dx = px[i] - ix;
+                    coord_type dx_prime = coord_type(1.0)-dx;
+                    coord_type dy = py[i] - iy;
+                    coord_type dy_prime = coord_type(1.0)-dy;
+
+                    const T* d = data + ix + iy*sx_;
+
+                    pr[i] = (   (d[0]       *   dx_prime     *dy_prime
+                            +   d[1]        *   dx           *dy_prime)
+                            +   (d[sx_]     *   dx_prime     *dy
+                            +   d[sx_+1]    *   dx           *dy) );
+                }
+            }
+        }
+    }
+
+    template <typename ArrayType> 
+    void hoNDInterpolatorLinear<ArrayType>::interpolate( size_t N, const coord_type* x, const coord_type* y, const coord_type* z, T* res )
+    {
+        const T* data = array_->begin();
+
+        const coord_type ex = (coord_type)( (long long)sx_-1 );
+        const coord_type ey = (coord_type)( (long long)sy_-1 );
+        const coord_type ez = (coord_type)( (long long)sz_-1 );
+
+        const size_t sxy = sx_*sy_;
+
+        bool inside[BATCH_TILE_SIZE];
+
+        size_t n, i, j;
+        for ( n=0; n<N; n+=BATCH_TILE_SIZE )
+        {
+            size_t num = std::min(N-n, (size_t)BATCH_TILE_SIZE);
+
+            const coord_type* px = x + n;
+            const coord_type* py = y + n;
+            const coord_type* pz = z + n;
+            T* pr = res + n;
+
+            for ( i=0; i<num; i++ )
+            {
+                inside[i] = (px[i]>=0) & (px[i]<ex) & (py[i]>=0) & (py[i]<ey) & (pz[i]>=0) & (pz[i]<ez);
+            }
+
+            for ( i=0; i<num; )
+            {
+                if ( !inside[i] )
+                {
+                    pr[i] = Self::operator()(px[i], py[i], pz[i]);
+                    i++;
+                    continue;
+                }
+
+                for ( j=i; j<num && inside[j]; j++ ) {}
+
+                for ( ; i<j; i++ )
+                {
+                    size_t ix = static_cast<size_t>(px[i]);
+                    size_t iy = static_cast<size_t>(py[i]);
+                    size_t iz = static_cast<size_t>(pz[i]);
+
+                    coord_type dx = px[i] - ix;
+                    coord_type dx_prime = coord_type(1.0)-dx;
+                    coord_type dy = py[i] - iy;
+                    coord_type dy_prime = coord_type(1.0)-dy;
+                    coord_type dz = pz[i] - iz;
+                    coord_type dz_prime = coord_type(1.0)-dz;
+
+                    const T* d = data + ix + iy*sx_ + iz*sxy;
+
+                    pr[i] = (   (d[0]           *   dx_prime     *dy_prime   *dz_prime 
+                            +   d[1]            *   dx           *dy_prime   *dz_prime) 
+                            +   (d[sx_]         *   dx_prime     *dy         *dz_prime 
+                            +   d[sx_+1]        *   dx           *dy         *dz_prime) 
+                            +   (d[sxy]         *   dx_prime     *dy_prime   *dz 
+                            +   d[sxy+1]        *   dx           *dy_prime   *dz) 
+                            +   (d[sxy+sx_]     *   dx_prime     *dy         *dz 
+                            +   d[sxy+sx_+1]    *   dx           *dy         *dz) );
+                }
+            }
+        }
+    }
 }
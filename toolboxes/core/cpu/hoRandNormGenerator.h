@@ -0,0 +1,254 @@
+/** \file       hoRandNormGenerator.h
+    \brief      Counter based generator of normally distributed random numbers
+
+                The n-th number of a stream is computed from (seed, stream, n) with the Philox4x32-10
+                bijection (Salmon et al., Parallel random numbers: as easy as 1, 2, 3, SC 2011) and the
+                Box-Muller transform. No generator state is carried from one number to the next, so
+                arrays are filled in parallel blocks and the result does not depend on the number of threads.
+
+                Different streams of the same seed are independent, e.g. one stream per pseudo replica or per readout.
+*/
+
+#pragma once
+
+#include "hoNDArray.h"
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+
+#ifdef USE_OMP
+    #include <omp.h>
+#endif // USE_OMP
+
+namespace Gadgetron
+{
+    /// Philox4x32-10, maps a 128 bit counter and a 64 bit key to 128 random bits
+    struct Philox4x32
+    {
+        static inline void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo)
+        {
+            uint64_t p = (uint64_t)a * (uint64_t)b;
+            hi = (uint32_t)(p >> 32);
+            lo = (uint32_t)p;
+        }
+
+        static inline void generate(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4])
+        {
+            uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+            uint32_t k0 = key[0], k1 = key[1];
+
+            for (unsigned int r = 0; r < 10; r++)
+            {
+                uint32_t hi0, lo0, hi1, lo1;
+                mulhilo(0xD2511F53u, c0, hi0, lo0);
+                mulhilo(0xCD9E8D57u, c2, hi1, lo1);
+
+                c0 = hi1 ^ c1 ^ k0;
+                c1 = lo1;
+                c2 = hi0 ^ c3 ^ k1;
+                c3 = lo0;
+
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+
+            out[0] = c0;
+            out[1] = c1;
+            out[2] = c2;
+            out[3] = c3;
+        }
+    };
+
+    template <typename T>
+    class RandNormGenerator
+    {
+    public:
+
+        RandNormGenerator();
+        RandNormGenerator(long long seed, T mean = 0, T sigma = 1);
+        ~RandNormGenerator();
+
+        void seed(unsigned long long seed);
+        void setPara(T mean = 0, T sigma = 1);
+
+        /// fill the array with the numbers of stream 0, the next call continues the stream
+        void gen(hoNDArray<T>& randNum);
+        /// the real and imaginary parts are consecutive numbers of the stream
+        void gen(hoNDArray< std::complex<T> >& randNum);
+
+        /// fill the array with the numbers [offset, offset+N) of a stream
+        void gen(hoNDArray<T>& randNum, unsigned long long stream, unsigned long long offset = 0) const;
+        void gen(hoNDArray< std::complex<T> >& randNum, unsigned long long stream, unsigned long long offset = 0) const;
+
+        /// add the numbers [offset, offset+N) of a stream to the data, without a noise array
+        void add(T* data, size_t N, unsigned long long stream, unsigned long long offset = 0) const;
+        void add(std::complex<T>* data, size_t N, unsigned long long stream, unsigned long long offset = 0) const;
+
+        /// the number of random numbers of a parallel block
+        static const size_t block_size = 1024;
+
+    protected:
+
+        void fill(T* data, size_t N, unsigned long long stream, unsigned long long offset, bool accumulate) const;
+
+        /// standard normal numbers from pairs of random words, a branch free loop the compiler can vectorize
+        static void box_muller(const uint32_t* bits, size_t N, T* z);
+
+        uint32_t key_[2];
+        T mean_;
+        T sigma_;
+
+        /// position in stream 0 of the gen functions without a stream
+        unsigned long long position_;
+    };
+
+    template <typename T>
+    RandNormGenerator<T>::RandNormGenerator() : mean_(0), sigma_(1), position_(0)
+    {
+        this->seed(0);
+    }
+
+    template <typename T>
+    RandNormGenerator<T>::RandNormGenerator(long long s, T mean, T sigma) : position_(0)
+    {
+        this->seed((unsigned long long)s);
+        this->setPara(mean, sigma);
+    }
+
+    template <typename T>
+    RandNormGenerator<T>::~RandNormGenerator()
+    {
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::seed(unsigned long long s)
+    {
+        key_[0] = (uint32_t)s;
+        key_[1] = (uint32_t)(s >> 32);
+        position_ = 0;
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::setPara(T mean, T sigma)
+    {
+        mean_ = mean;
+        sigma_ = sigma;
+    }
+
+    template <typename T>
+    inline void RandNormGenerator<T>::box_muller(const uint32_t* bits, size_t N, T* z)
+    {
+        // u1 in (0, 1], log(u1) is finite
+        const T scale = (T)(1.0 / 4294967296.0);
+        const T two_pi = (T)6.283185307179586476925286766559;
+
+        size_t p;
+        for (p = 0; p < N / 2; p++)
+        {
+            T u1 = ((T)bits[2 * p] + (T)0.5) * scale;
+            T u2 = (T)bits[2 * p + 1] * scale;
+            u1 = (u1 > 1) ? (T)1 : u1;
+
+            T r = std::sqrt(-2 * std::log(u1));
+            T theta = two_pi * u2;
+
+            z[2 * p] = r * std::cos(theta);
+            z[2 * p + 1] = r * std::sin(theta);
+        }
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::fill(T* data, size_t N, unsigned long long stream, unsigned long long offset, bool accumulate) const
+    {
+        if (N == 0) return;
+
+        // blocks of 4 numbers of the counter, the first and last one may be partially used
+        unsigned long long first_block = offset / 4;
+        unsigned long long last_block = (offset + N - 1) / 4;
+        unsigned long long num_blocks = last_block - first_block + 1;
+
+        const unsigned long long blocks_per_chunk = block_size / 4;
+        long long num_chunks = (long long)((num_blocks + blocks_per_chunk - 1) / blocks_per_chunk);
+
+        long long c;
+#pragma omp parallel for private(c) if (num_chunks>1)
+        for (c = 0; c < num_chunks; c++)
+        {
+            uint32_t bits[block_size];
+            T z[block_size];
+
+            unsigned long long b_start = first_block + (unsigned long long)c * blocks_per_chunk;
+            unsigned long long b_end = b_start + blocks_per_chunk;
+            if (b_end > last_block + 1) b_end = last_block + 1;
+
+            // the counter of a block is (block, stream)
+            unsigned long long b;
+            for (b = b_start; b < b_end; b++)
+            {
+                const uint32_t counter[4] = { (uint32_t)b, (uint32_t)(b >> 32), (uint32_t)stream, (uint32_t)(stream >> 32) };
+                Philox4x32::generate(counter, key_, bits + 4 * (b - b_start));
+            }
+
+            box_muller(bits, (size_t)(4 * (b_end - b_start)), z);
+
+            // numbers [n_start, n_end) of the stream are in this chunk
+            unsigned long long n_start = 4 * b_start;
+            unsigned long long n_end = 4 * b_end;
+            if (n_start < offset) n_start = offset;
+            if (n_end > offset + N) n_end = offset + N;
+
+            const T* zc = z + (n_start - 4 * b_start);
+            T* x = data + (n_start - offset);
+            size_t len = (size_t)(n_end - n_start);
+
+            size_t n;
+            if (accumulate)
+            {
+                for (n = 0; n < len; n++) x[n] += mean_ + sigma_ * zc[n];
+            }
+            else
+            {
+                for (n = 0; n < len; n++) x[n] = mean_ + sigma_ * zc[n];
+            }
+        }
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::gen(hoNDArray<T>& randNum)
+    {
+        this->fill(randNum.begin(), randNum.get_number_of_elements(), 0, position_, false);
+        position_ += randNum.get_number_of_elements();
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::gen(hoNDArray< std::complex<T> >& randNum)
+    {
+        this->fill(reinterpret_cast<T*>(randNum.begin()), 2 * randNum.get_number_of_elements(), 0, position_, false);
+        position_ += 2 * randNum.get_number_of_elements();
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::gen(hoNDArray<T>& randNum, unsigned long long stream, unsigned long long offset) const
+    {
+        this->fill(randNum.begin(), randNum.get_number_of_elements(), stream, offset, false);
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::gen(hoNDArray< std::complex<T> >& randNum, unsigned long long stream, unsigned long long offset) const
+    {
+        this->fill(reinterpret_cast<T*>(randNum.begin()), 2 * randNum.get_number_of_elements(), stream, 2 * offset, false);
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::add(T* data, size_t N, unsigned long long stream, unsigned long long offset) const
+    {
+        this->fill(data, N, stream, offset, true);
+    }
+
+    template <typename T>
+    void RandNormGenerator<T>::add(std::complex<T>* data, size_t N, unsigned long long stream, unsigned long long offset) const
+    {
+        this->fill(reinterpret_cast<T*>(data), 2 * N, stream, 2 * offset, true);
+    }
+}
@@ -1020,7 +1020,7 @@ void heev(hoNDArray<T>& A, hoNDArray<typename realType<T>::Type>& eigenValue)
             hoNDArray<float> rwork(3*M);
             cheev_(&jobz, &uplo, &M, reinterpret_cast<lapack_complex_float*>(pA), &M, reinterpret_cast<float*>(pEV), reinterpret_cast<lapack_complex_float*>(work.begin()), &lwork, rwork.begin(), &info);
         }
-        else if ( (typeid(T)==typeid( std::complex<float> )) || (typeid(T)==typeid( complext<double> )) )
+        else if ( (typeid(T)==typeid( std::complex<double> )) || (typeid(T)==typeid( complext<double> )) )
         {
             hoNDArray< std::complex<double> > work(M, M);
             hoNDArray<double> rwork(3*M);
@@ -3,7 +3,7 @@
 
 namespace Gadgetron{
 
-template<typename T> 
+template<typename T>
 hoNDHarrWavelet<T>::hoNDHarrWavelet()
 {
 }
@@ -16,31 +16,27 @@ hoNDHarrWavelet<T>::~hoNDHarrWavelet()
 template<typename T>
 void hoNDHarrWavelet<T>::dwt1D(const T* const in, T* out, size_t RO, size_t level)
 {
-    memcpy(out, in, sizeof(T)*RO);
+    const value_type s = (value_type)(0.5);
 
     for (size_t n = 0; n < level; n++)
     {
+        const T* src = (n == 0) ? in : out;
+
         T* l = out;
         T* h = l + n * RO + RO;
 
-        T v1 = l[0];
+        T v1 = src[0];
         size_t ro;
         for (ro = 0; ro < RO - 1; ro++)
         {
-            const T& t = l[ro + 1];
-            h[ro] = l[ro] - t;
-            l[ro] += t;
+            const T t = src[ro + 1];
+            h[ro] = (src[ro] - t) * s;
+            l[ro] = (src[ro] + t) * s;
         }
 
         // periodic boundary condition
-        h[RO - 1] = l[RO - 1] - v1;
-        l[RO - 1] += v1;
-
-        for (ro = 0; ro < RO; ro++)
-        {
-            l[ro] *= (value_type)(0.5);
-            h[ro] *= (value_type)(0.5);
-        }
+        h[RO - 1] = (src[RO - 1] - v1) * s;
+        l[RO - 1] = (src[RO - 1] + v1) * s;
     }
 }
 
@@ -49,6 +45,8 @@ void hoNDHarrWavelet<T>::idwt1D(const T* const in, T* out, size_t RO, size_t lev
 {
     memcpy(out, in, sizeof(T)*RO);
 
+    const value_type s = (value_type)(0.5);
+
     long long n;
     for (n = (long long)level - 1; n >= 0; n--)
     {
@@ -60,81 +58,86 @@ void hoNDHarrWavelet<T>::idwt1D(const T* const in, T* out, size_t RO, size_t lev
         size_t ro;
         for (ro = RO - 1; ro > 0; ro--)
         {
-            l[ro] = (l[ro] + l[ro - 1]) + (h[ro] - h[ro - 1]);
+            l[ro] = ((l[ro] + l[ro - 1]) + (h[ro] - h[ro - 1])) * s;
         }
 
-        l[0] = (l[0] + v1) + (h[0] - h[RO - 1]);
-
-        for (ro = 0; ro < RO; ro++)
-        {
-            l[ro] *= (value_type)(0.5);
-        }
+        l[0] = ((l[0] + v1) + (h[0] - h[RO - 1])) * s;
     }
 }
 
 template<typename T>
-void hoNDHarrWavelet<T>::dwt2D(const T* const in, T* out, size_t RO, size_t E1, size_t level)
+void hoNDHarrWavelet<T>::dwt_row(const T* a, const T* b, size_t RO, T* ll, T* hl, T* lh, T* hh, T* bl, T* bh)
 {
-    value_type scaleFactor = 0.5;
+    const value_type s = (value_type)(0.5);
 
-    memcpy(out, in, sizeof(T)*RO*E1);
+    size_t ro;
+    for (ro = 0; ro < RO; ro++)
+    {
+        bl[ro] = (a[ro] + b[ro]) * s;
+        bh[ro] = (a[ro] - b[ro]) * s;
+    }
 
-    for (size_t n = 0; n<level; n++)
+    for (ro = 0; ro < RO - 1; ro++)
     {
-        T* LH = out + (3 * n + 1)*RO*E1;
+        ll[ro] = (bl[ro] + bl[ro + 1]) * s;
+        hl[ro] = (bl[ro] - bl[ro + 1]) * s;
+        lh[ro] = (bh[ro] + bh[ro + 1]) * s;
+        hh[ro] = (bh[ro] - bh[ro + 1]) * s;
+    }
 
-        long long ro;
-        for (ro = 0; ro<(long long)RO; ro++)
-        {
-            T v1 = out[ro];
+    ll[RO - 1] = (bl[RO - 1] + bl[0]) * s;
+    hl[RO - 1] = (bl[RO - 1] - bl[0]) * s;
+    lh[RO - 1] = (bh[RO - 1] + bh[0]) * s;
+    hh[RO - 1] = (bh[RO - 1] - bh[0]) * s;
+}
 
-            long long ii = ro, e1;
-            for (e1 = 0; e1<(long long)E1 - 1; e1++)
-            {
-                LH[ii] = out[ii] - out[ii + RO];
-                out[ii] += out[ii + RO];
-                ii += RO;
-            }
+template<typename T>
+void hoNDHarrWavelet<T>::idwt_row(const T* ll, const T* hl, const T* lh, const T* hh, size_t RO, T* x, T* t)
+{
+    const value_type s = (value_type)(0.5);
 
-            LH[ii] = out[ii] - v1;
-            out[ii] += v1;
-        }
+    for (size_t ro = 1; ro < RO; ro++)
+    {
+        x[ro] = (ll[ro] + ((ll[ro - 1] + hl[ro]) - hl[ro - 1])) * s;
+        t[ro] = (((lh[ro] + lh[ro - 1]) + hh[ro]) - hh[ro - 1]) * s;
+    }
 
-        this->apply_harr_scal(RO*E1, scaleFactor, out);
-        this->apply_harr_scal(RO*E1, scaleFactor, LH);
+    x[0] = (ll[0] + ((ll[RO - 1] + hl[0]) - hl[RO - 1])) * s;
+    t[0] = (((lh[0] + lh[RO - 1]) + hh[0]) - hh[RO - 1]) * s;
+}
 
-        T* HL = LH + RO*E1;
-        T* HH = HL + RO*E1;
+template<typename T>
+void hoNDHarrWavelet<T>::dwt2D(const T* const in, T* out, size_t RO, size_t E1, size_t level)
+{
+    size_t N2D = RO*E1;
 
-        long long e1;
-        for (e1 = 0; e1<(long long)E1; e1++)
-        {
-            T v1 = out[e1*RO];
-            T v2 = LH[e1*RO];
+    // the approximation of level n overwrites the approximation of level n-1 row by row,
+    // so the first row of every level is kept for the periodic boundary of the next level
+    std::vector<T> buf((2 + level)*RO);
+    T* bl = &buf[0];
+    T* bh = bl + RO;
+    T* first = bh + RO;
 
-            size_t ii = e1*RO;
-            for (long long ro = 0; ro<(long long)RO - 1; ro++)
-            {
-                HH[ii] = LH[ii] - LH[ii + 1];
-                LH[ii] += LH[ii + 1];
+    long long step, n;
+    for (step = 0; step < (long long)(E1 + level - 1); step++)
+    {
+        for (n = 0; n < (long long)level; n++)
+        {
+            long long e1 = step - n;
+            if (e1 < 0 || e1 >= (long long)E1) continue;
 
-                HL[ii] = out[ii] - out[ii + 1];
-                out[ii] += out[ii + 1];
+            const T* a = ((n == 0) ? in : out) + e1*RO;
+            const T* b = a + RO;
+            if (e1 == (long long)E1 - 1) b = (n == 0) ? in : first + n*RO;
 
-                ii++;
-            }
+            T* LH = out + (3 * n + 1)*N2D + e1*RO;
+            T* HL = LH + N2D;
+            T* HH = HL + N2D;
 
-            HH[ii] = LH[ii] - v2;
-            LH[ii] += v2;
+            this->dwt_row(a, b, RO, out + e1*RO, HL, LH, HH, bl, bh);
 
-            HL[ii] = out[ii] - v1;
-            out[ii] += v1;
+            if (e1 == 0 && n + 1 < (long long)level) memcpy(first + (n + 1)*RO, out, sizeof(T)*RO);
         }
-
-        this->apply_harr_scal(RO*E1, scaleFactor, out);
-        this->apply_harr_scal(RO*E1, scaleFactor, LH);
-        this->apply_harr_scal(RO*E1, scaleFactor, HL);
-        this->apply_harr_scal(RO*E1, scaleFactor, HH);
     }
 }
 
@@ -143,253 +146,177 @@ void hoNDHarrWavelet<T>::idwt2D(const T* const in, T* out, size_t RO, size_t E1,
 {
     memcpy(out, in, sizeof(T)*RO*E1);
 
-    hoNDArray<T> tmp(RO*E1);
-    T* pTmp = tmp.begin();
+    size_t N2D = RO*E1;
+    const value_type s = (value_type)(0.5);
 
-    value_type scaleFactor = 0.5;
+    // levels are processed from level-1 to 0 and rows from E1-1 to 0; row e1 needs the RO transform of rows e1 and e1-1,
+    // for every level the RO transform of the last row (periodic boundary) and of the two most recent rows are buffered
+    std::vector<T> buf(6 * RO*level);
 
-    long long n;
-    for (n = (long long)level - 1; n >= 0; n--)
+    long long step, k;
+    for (step = 0; step < (long long)(E1 + level - 1); step++)
     {
-        const T* const LH = in + (3 * n + 1)*RO*E1;
-        const T* const HL = LH + RO*E1;
-        const T* const HH = HL + RO*E1;
-
-        long long e1;
-        for (e1 = 0; e1<(long long)E1; e1++)
+        for (k = 0; k < (long long)level; k++)
         {
-            size_t ii = e1*RO + RO - 1;
+            long long e1 = (long long)E1 - 1 - (step - k);
+            if (step < k || e1 < 0) continue;
 
-            T vLL = out[ii];
-            T vLH = LH[ii];
-            T vHL = HL[ii];
-            T vHH = HH[ii];
+            long long n = (long long)level - 1 - k;
 
-            for (long long ro = RO - 1; ro>0; ro--)
-            {
-                out[ii] += out[ii - 1] + HL[ii] - HL[ii - 1];
-                pTmp[ii] = LH[ii] + LH[ii - 1] + HH[ii] - HH[ii - 1];
+            const T* const LH = in + (3 * n + 1)*N2D;
+            const T* const HL = LH + N2D;
+            const T* const HH = HL + N2D;
 
-                ii--;
-            }
+            T* xLast = &buf[6 * RO*k];
+            T* tLast = xLast + RO;
+            T* x[2] = { tLast + RO, tLast + 3 * RO };
+            T* t[2] = { tLast + 2 * RO, tLast + 4 * RO };
 
-            out[ii] += vLL + HL[ii] - vHL;
-            pTmp[ii] = LH[ii] + vLH + HH[ii] - vHH;
-        }
+            if (e1 == (long long)E1 - 1)
+            {
+                this->idwt_row(out + e1*RO, HL + e1*RO, LH + e1*RO, HH + e1*RO, RO, x[e1 % 2], t[e1 % 2]);
+                memcpy(xLast, x[e1 % 2], sizeof(T)*RO);
+                memcpy(tLast, t[e1 % 2], sizeof(T)*RO);
+            }
 
-        this->apply_harr_scal(RO*E1, scaleFactor, out);
-        this->apply_harr_scal(RO*E1, scaleFactor, pTmp);
+            const T* xc = x[e1 % 2];
+            const T* tc = t[e1 % 2];
+            const T* xp = xLast;
+            const T* tp = tLast;
 
-        long long ro;
-        for (ro = 0; ro<(long long)RO; ro++)
-        {
-            size_t ii = (E1 - 1)*RO + ro;
-            T vLL = out[ii];
-            T vLH = pTmp[ii];
-
-            for (long long e1 = E1 - 1; e1>0; e1--)
+            if (e1 > 0)
             {
-                out[ii] += pTmp[ii] + out[ii - RO] - pTmp[ii - RO];
-                ii -= RO;
+                size_t p = (e1 - 1) * RO;
+                this->idwt_row(out + p, HL + p, LH + p, HH + p, RO, x[(e1 - 1) % 2], t[(e1 - 1) % 2]);
+                xp = x[(e1 - 1) % 2];
+                tp = t[(e1 - 1) % 2];
             }
 
-            out[ro] += pTmp[ro] + vLL - vLH;
+            T* r = out + e1*RO;
+            for (size_t ro = 0; ro < RO; ro++)
+            {
+                r[ro] = (xc[ro] + ((tc[ro] + xp[ro]) - tp[ro])) * s;
+            }
         }
-
-        this->apply_harr_scal(RO*E1, scaleFactor, out);
     }
 }
 
 template<typename T>
-void hoNDHarrWavelet<T>::dwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level)
+void hoNDHarrWavelet<T>::dwt_plane(const T* a, const T* b, size_t RO, size_t E1, T* lll, T* llh, T* lhl, T* lhh, T* hll, T* hlh, T* hhl, T* hhh, T* pl, T* ph)
 {
-    try
-    {
-        memcpy(out, in, sizeof(T)*RO*E1*E2);
+    const value_type s = (value_type)(0.5);
 
-        long long N2D = RO*E1;
-        long long N3D = RO*E1*E2;
+    long long N2D = RO*E1;
 
-        // process order E2, E1, RO
-
-        for (size_t n = 0; n<level; n++)
-        {
-            T* lll = out;
-            T* llh = lll + n * 7 * N3D + N3D;
-            T* lhl = llh + N3D;
-            T* lhh = lhl + N3D;
-            T* hll = lhh + N3D;
-            T* hlh = hll + N3D;
-            T* hhl = hlh + N3D;
-            T* hhh = hhl + N3D;
-
-            // ------------------------------------------
-            // E2
-            // ------------------------------------------
-            long long e1;
-#pragma omp parallel for default(none) private(e1) shared(RO, E1, E2, N2D, lll, hll)
-            for (e1 = 0; e1<(long long)E1; e1++)
-            {
-                for (size_t ro = 0; ro<RO; ro++)
-                {
-                    size_t ind = ro + e1*RO;
-
-                    T v1 = lll[ind];
-                    for (size_t e2 = 0; e2<E2 - 1; e2++)
-                    {
-                        size_t ind3d = ind + e2*N2D;
-
-                        const T& t = lll[ind3d + N2D];
-                        hll[ind3d] = lll[ind3d] - t;
-                        lll[ind3d] += t;
-                    }
-
-                    if (E2 > 1)
-                    {
-                        size_t ind3d = ind + (E2 - 1)*N2D;
-
-                        hll[ind3d] = lll[ind3d] - v1;
-                        lll[ind3d] += v1;
-                    }
-                }
-            }
-
-            this->apply_harr_scal(N3D, (value_type)(0.5), lll);
-            this->apply_harr_scal(N3D, (value_type)(0.5), hll);
-
-            // ------------------------------------------
-            // E1
-            // ------------------------------------------
+    long long ii;
+    for (ii = 0; ii < N2D; ii++)
+    {
+        pl[ii] = (a[ii] + b[ii]) * s;
+        ph[ii] = (a[ii] - b[ii]) * s;
+    }
 
-            long long e2;
+    long long e1;
+#pragma omp parallel default(none) private(e1) shared(RO, E1, lll, llh, lhl, lhh, hll, hlh, hhl, hhh, pl, ph) if(RO*E1>64*1024)
+    {
+        std::vector<T> buf(2 * RO);
 
-#pragma omp parallel for default(none) private(e2) shared(RO, E1, E2, N2D, lll, lhl, hll, hhl)
-            for (e2 = 0; e2<(long long)E2; e2++)
-            {
-                size_t ind3D = e2*N2D;
-                for (size_t ro = 0; ro<RO; ro++)
-                {
-                    T v1 = lll[ro + ind3D];
-                    T v2 = hll[ro + ind3D];
+#pragma omp for
+        for (e1 = 0; e1 < (long long)E1; e1++)
+        {
+            size_t c = e1*RO;
+            size_t nx = (e1 + 1 < (long long)E1) ? c + RO : 0;
 
-                    size_t ind;
-                    for (size_t e1 = 0; e1<E1 - 1; e1++)
-                    {
-                        ind = ro + ind3D + e1*RO;
+            this->dwt_row(pl + c, pl + nx, RO, lll + c, llh + c, lhl + c, lhh + c, &buf[0], &buf[RO]);
+            this->dwt_row(ph + c, ph + nx, RO, hll + c, hlh + c, hhl + c, hhh + c, &buf[0], &buf[RO]);
+        }
+    }
+}
 
-                        const T& t1 = lll[ind + RO];
-                        lhl[ind] = lll[ind] - t1;
-                        lll[ind] += t1;
+template<typename T>
+void hoNDHarrWavelet<T>::idwt_plane(const T* lll, const T* llh, const T* lhl, const T* lhh, const T* hll, const T* hlh, const T* hhl, const T* hhh, size_t RO, size_t E1, T* pLL, T* pHL, T* buf)
+{
+    const value_type s = (value_type)(0.5);
 
-                        const T& t2 = hll[ind + RO];
-                        hhl[ind] = hll[ind] - t2;
-                        hll[ind] += t2;
-                    }
+    long long N2D = RO*E1;
 
-                    ind = ro + ind3D + (E1 - 1)*RO;
+    T* pX[4] = { buf, buf + N2D, buf + 2 * N2D, buf + 3 * N2D };
+    const T* pl[4] = { lll, lhl, hll, hhl };
+    const T* ph[4] = { llh, lhh, hlh, hhh };
 
-                    lhl[ind] = lll[ind] - v1;
-                    lll[ind] += v1;
+    long long e1;
+#pragma omp parallel for default(none) private(e1) shared(RO, E1, N2D, pX, pl, ph, s) if(N2D>64*1024)
+    for (e1 = 0; e1 < (long long)E1; e1++)
+    {
+        size_t c = e1*RO;
 
-                    hhl[ind] = hll[ind] - v2;
-                    hll[ind] += v2;
-                }
-            }
+        for (size_t b = 0; b < 4; b++)
+        {
+            const T* l = pl[b] + c;
+            const T* h = ph[b] + c;
+            T* x = pX[b] + c;
 
-#pragma omp parallel sections
+            for (size_t ro = 1; ro < RO; ro++)
             {
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), lll);
-
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), lhl);
-
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), hll);
-
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), hhl);
+                x[ro] = ((l[ro] + l[ro - 1]) + (h[ro] - h[ro - 1])) * s;
             }
 
-            // ------------------------------------------
-            // RO
-            // ------------------------------------------
-
-#pragma omp parallel for default(none) private(e2) shared(RO, E1, E2, N2D, lll, hll, lhl, hhl, llh, hlh, lhh, hhh)
-            for (e2 = 0; e2<(long long)E2; e2++)
-            {
-                for (size_t e1 = 0; e1<E1; e1++)
-                {
-                    size_t ind3D = e1*RO + e2*N2D;
-
-                    T v1 = lll[ind3D];
-                    T v2 = lhl[ind3D];
-                    T v3 = hll[ind3D];
-                    T v4 = hhl[ind3D];
-
-                    size_t ind;
-                    for (size_t ro = 0; ro<RO - 1; ro++)
-                    {
-                        ind = ind3D + ro;
-
-                        const T& t1 = lll[ind + 1];
-                        llh[ind] = lll[ind] - t1;
-                        lll[ind] += t1;
-
-                        const T& t2 = lhl[ind + 1];
-                        lhh[ind] = lhl[ind] - t2;
-                        lhl[ind] += t2;
-
-                        const T& t3 = hll[ind + 1];
-                        hlh[ind] = hll[ind] - t3;
-                        hll[ind] += t3;
-
-                        const T& t4 = hhl[ind + 1];
-                        hhh[ind] = hhl[ind] - t4;
-                        hhl[ind] += t4;
-                    }
-
-                    ind = ind3D + RO - 1;
-
-                    llh[ind] = lll[ind] - v1;
-                    lll[ind] += v1;
+            x[0] = ((l[0] + l[RO - 1]) + (h[0] - h[RO - 1])) * s;
+        }
+    }
 
-                    lhh[ind] = lhl[ind] - v2;
-                    lhl[ind] += v2;
+#pragma omp parallel for default(none) private(e1) shared(RO, E1, N2D, pX, pLL, pHL, s) if(N2D>64*1024)
+    for (e1 = 0; e1 < (long long)E1; e1++)
+    {
+        size_t c = e1*RO;
+        size_t p = (e1 > 0) ? c - RO : (E1 - 1)*RO;
 
-                    hlh[ind] = hll[ind] - v3;
-                    hll[ind] += v3;
+        for (size_t ro = 0; ro < RO; ro++)
+        {
+            pLL[c + ro] = ((pX[0][c + ro] + pX[0][p + ro]) + (pX[1][c + ro] - pX[1][p + ro])) * s;
+            pHL[c + ro] = ((pX[2][c + ro] + pX[2][p + ro]) + (pX[3][c + ro] - pX[3][p + ro])) * s;
+        }
+    }
+}
 
-                    hhh[ind] = hhl[ind] - v4;
-                    hhl[ind] += v4;
-                }
-            }
+template<typename T>
+void hoNDHarrWavelet<T>::dwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level)
+{
+    try
+    {
+        size_t N2D = RO*E1;
+        size_t N3D = RO*E1*E2;
 
-#pragma omp parallel sections
+        // process order E2, E1, RO
+        // same scheme as dwt2D, with planes along E2 instead of rows along E1
+        std::vector<T> buf((2 + level)*N2D);
+        T* pl = &buf[0];
+        T* ph = pl + N2D;
+        T* first = ph + N2D;
+
+        long long step, n;
+        for (step = 0; step < (long long)(E2 + level - 1); step++)
+        {
+            for (n = 0; n < (long long)level; n++)
             {
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), lll);
-
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), llh);
+                long long e2 = step - n;
+                if (e2 < 0 || e2 >= (long long)E2) continue;
 
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), lhl);
+                const T* a = ((n == 0) ? in : out) + e2*N2D;
+                const T* b = a + N2D;
+                if (e2 == (long long)E2 - 1) b = (n == 0) ? in : first + n*N2D;
 
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), lhh);
+                T* lll = out + e2*N2D;
+                T* llh = out + n * 7 * N3D + N3D + e2*N2D;
+                T* lhl = llh + N3D;
+                T* lhh = lhl + N3D;
+                T* hll = lhh + N3D;
+                T* hlh = hll + N3D;
+                T* hhl = hlh + N3D;
+                T* hhh = hhl + N3D;
 
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), hll);
+                this->dwt_plane(a, b, RO, E1, lll, llh, lhl, lhh, hll, hlh, hhl, hhh, pl, ph);
 
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), hlh);
-
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), hhl);
-
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), hhh);
+                if (e2 == 0 && n + 1 < (long long)level) memcpy(first + (n + 1)*N2D, out, sizeof(T)*N2D);
             }
         }
     }
@@ -406,138 +333,67 @@ void hoNDHarrWavelet<T>::idwt3D(const T* const in, T* out, size_t RO, size_t E1,
     {
         memcpy(out, in, sizeof(T)*RO*E1*E2);
 
-        long long N2D = RO*E1;
-        long long N3D = RO*E1*E2;
-
-        hoNDArray<T> LL(N3D);
-        T* pLL = LL.begin();
-
-        hoNDArray<T> HL(N3D);
-        T* pHL = HL.begin();
+        size_t N2D = RO*E1;
+        size_t N3D = RO*E1*E2;
 
-        hoNDArray<T> LH(N3D);
-        T* pLH = LH.begin();
+        const value_type s = (value_type)(0.5);
 
-        hoNDArray<T> HH(N3D);
-        T* pHH = HH.begin();
+        // same scheme as idwt2D, with planes along E2 instead of rows along E1
+        // for every level, the E2 low and high pass planes of the last plane and of the two most recent planes are buffered
+        std::vector<T> buf(4 * N2D + 6 * N2D*level);
+        T* pX = &buf[0];
 
-        long long n;
-        for (n = (long long)level - 1; n >= 0; n--)
+        long long step, k;
+        for (step = 0; step < (long long)(E2 + level - 1); step++)
         {
-            T* lll = out;
-            const T* const llh = in + n * 7 * N3D + N3D;
-            const T* const lhl = llh + N3D;
-            const T* const lhh = lhl + N3D;
-            const T* const hll = lhh + N3D;
-            const T* const hlh = hll + N3D;
-            const T* const hhl = hlh + N3D;
-            const T* const hhh = hhl + N3D;
-
-            // ------------------------------------------
-            // RO
-            // ------------------------------------------
-
-            long long e2;
-
-#pragma omp parallel for private(e2) shared(RO, E1, E2, N2D, pLL, pHL, pLH, pHH) 
-            for (e2 = 0; e2<(long long)E2; e2++)
+            for (k = 0; k < (long long)level; k++)
             {
-                for (size_t e1 = 0; e1<E1; e1++)
+                long long e2 = (long long)E2 - 1 - (step - k);
+                if (step < k || e2 < 0) continue;
+
+                long long n = (long long)level - 1 - k;
+
+                T* lll = out;
+                const T* const llh = in + n * 7 * N3D + N3D;
+                const T* const lhl = llh + N3D;
+                const T* const lhh = lhl + N3D;
+                const T* const hll = lhh + N3D;
+                const T* const hlh = hll + N3D;
+                const T* const hhl = hlh + N3D;
+                const T* const hhh = hhl + N3D;
+
+                T* pLLLast = pX + 4 * N2D + 6 * N2D*k;
+                T* pHLLast = pLLLast + N2D;
+                T* pLL[2] = { pHLLast + N2D, pHLLast + 3 * N2D };
+                T* pHL[2] = { pHLLast + 2 * N2D, pHLLast + 4 * N2D };
+
+                if (e2 == (long long)E2 - 1)
                 {
-                    size_t ind3D = e1*RO + e2*N2D;
-
-                    size_t ind;
-                    for (size_t ro = RO - 1; ro>0; ro--)
-                    {
-                        ind = ind3D + ro;
-                        pLL[ind] = (lll[ind] + lll[ind - 1]) + (llh[ind] - llh[ind - 1]);
-                        pLH[ind] = (lhl[ind] + lhl[ind - 1]) + (lhh[ind] - lhh[ind - 1]);
-                        pHL[ind] = (hll[ind] + hll[ind - 1]) + (hlh[ind] - hlh[ind - 1]);
-                        pHH[ind] = (hhl[ind] + hhl[ind - 1]) + (hhh[ind] - hhh[ind - 1]);
-                    }
-
-                    ind = ind3D + RO - 1;
-
-                    pLL[ind3D] = (lll[ind3D] + lll[ind]) + (llh[ind3D] - llh[ind]);
-                    pLH[ind3D] = (lhl[ind3D] + lhl[ind]) + (lhh[ind3D] - lhh[ind]);
-                    pHL[ind3D] = (hll[ind3D] + hll[ind]) + (hlh[ind3D] - hlh[ind]);
-                    pHH[ind3D] = (hhl[ind3D] + hhl[ind]) + (hhh[ind3D] - hhh[ind]);
+                    size_t c = e2*N2D;
+                    this->idwt_plane(lll + c, llh + c, lhl + c, lhh + c, hll + c, hlh + c, hhl + c, hhh + c, RO, E1, pLL[e2 % 2], pHL[e2 % 2], pX);
+                    memcpy(pLLLast, pLL[e2 % 2], sizeof(T)*N2D);
+                    memcpy(pHLLast, pHL[e2 % 2], sizeof(T)*N2D);
                 }
-            }
-
-#pragma omp parallel sections
-            {
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), pLL);
-
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), pLH);
 
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), pHL);
+                const T* lc = pLL[e2 % 2];
+                const T* hc = pHL[e2 % 2];
+                const T* lp = pLLLast;
+                const T* hp = pHLLast;
 
-#pragma omp section
-                this->apply_harr_scal(N3D, (value_type)(0.5), pHH);
-            }
-
-            // ------------------------------------------
-            // E1
-            // ------------------------------------------
-
-#pragma omp parallel for default(none) private(e2) shared(RO, E1, E2, N2D, pLL, pHL, pLH, pHH) 
-            for (e2 = 0; e2<(long long)E2; e2++)
-            {
-                size_t ind3D = e2*N2D;
-                for (size_t ro = 0; ro<RO; ro++)
+                if (e2 > 0)
                 {
-                    size_t ind = ro + (E1 - 1)* RO + ind3D;
-
-                    T v1 = pLL[ind];
-                    T v2 = pHL[ind];
-
-                    for (size_t e1 = E1 - 1; e1>0; e1--)
-                    {
-                        ind = ro + e1*RO + ind3D;
-                        pLL[ind] = (pLL[ind] + pLL[ind - RO]) + (pLH[ind] - pLH[ind - RO]);
-                        pHL[ind] = (pHL[ind] + pHL[ind - RO]) + (pHH[ind] - pHH[ind - RO]);
-                    }
-
-                    ind = ro + ind3D;
-
-                    pLL[ind] = (pLL[ind] + v1) + (pLH[ind] - pLH[ind + (E1 - 1)* RO]);
-                    pHL[ind] = (pHL[ind] + v2) + (pHH[ind] - pHH[ind + (E1 - 1)* RO]);
+                    size_t c = (e2 - 1)*N2D;
+                    this->idwt_plane(lll + c, llh + c, lhl + c, lhh + c, hll + c, hlh + c, hhl + c, hhh + c, RO, E1, pLL[(e2 - 1) % 2], pHL[(e2 - 1) % 2], pX);
+                    lp = pLL[(e2 - 1) % 2];
+                    hp = pHL[(e2 - 1) % 2];
                 }
-            }
-
-            this->apply_harr_scal(N3D, (value_type)(0.5), pLL);
-            this->apply_harr_scal(N3D, (value_type)(0.5), pHL);
-
-            // ------------------------------------------
-            // E2
-            // ------------------------------------------
-
-            long long e1;
 
-#pragma omp parallel for default(none) private(e1) shared(RO, E1, E2, N2D, pLL,pHL, out) 
-            for (e1 = 0; e1<(long long)E1; e1++)
-            {
-                for (size_t ro = 0; ro<RO; ro++)
+                T* r = out + e2*N2D;
+                for (size_t ii = 0; ii < N2D; ii++)
                 {
-                    size_t ind2D = ro + e1*RO;
-
-                    size_t ind;
-                    for (size_t e2 = E2 - 1; e2>0; e2--)
-                    {
-                        ind = ind2D + e2*N2D;
-                        out[ind] = (pLL[ind] + pLL[ind - N2D]) + (pHL[ind] - pHL[ind - N2D]);
-                    }
-
-                    ind = ind2D + (E2 - 1)*N2D;
-                    out[ind2D] = (pLL[ind2D] + pLL[ind]) + (pHL[ind2D] - pHL[ind]);
+                    r[ii] = ((lc[ii] + lp[ii]) + (hc[ii] - hp[ii])) * s;
                 }
             }
-
-            this->apply_harr_scal(N3D, (value_type)(0.5), out);
         }
     }
     catch (...)
@@ -41,6 +41,26 @@ namespace Gadgetron{
         /// in: [RO 1+7*level] array
         virtual void idwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level);
 
+        /// the multi-level 2D and 3D transforms are computed in one pass over the rows (2D) or planes (3D)
+        /// level n processes a row/plane as soon as level n-1 has computed the rows/planes it depends on,
+        /// so the data of all levels is touched while it is still in cache
+
+        /// forward transform of one row along E1 and RO
+        /// a: current row, b: next row along E1 (periodic boundary)
+        /// ll, hl: E1 low pass, RO low and high pass; lh, hh: E1 high pass, RO low and high pass
+        /// bl, bh: buffers of RO elements
+        void dwt_row(const T* a, const T* b, size_t RO, T* ll, T* hl, T* lh, T* hh, T* bl, T* bh);
+        /// inverse transform along RO of one row of the 2D bands
+        /// x: RO inverse of ll and hl, t: RO inverse of lh and hh
+        void idwt_row(const T* ll, const T* hl, const T* lh, const T* hh, size_t RO, T* x, T* t);
+
+        /// forward transform of one plane along E1 and RO, a and b are the current and next plane along E2
+        /// pl, ph: buffers of RO*E1 elements
+        void dwt_plane(const T* a, const T* b, size_t RO, size_t E1, T* lll, T* llh, T* lhl, T* lhh, T* hll, T* hlh, T* hhl, T* hhh, T* pl, T* ph);
+        /// inverse transform along RO and E1 of one plane of the 3D bands
+        /// pLL, pHL: E2 low and high pass plane; buf: buffer of 4*RO*E1 elements
+        void idwt_plane(const T* lll, const T* llh, const T* lhl, const T* lhh, const T* hll, const T* hlh, const T* hhl, const T* hhh, size_t RO, size_t E1, T* pLL, T* pHL, T* buf);
+
         /// utility functions
         template <typename T2> 
         void apply_harr_scal(size_t N, T2 a, T2* x)
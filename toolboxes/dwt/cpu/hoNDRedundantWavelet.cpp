@@ -5,7 +5,7 @@
 namespace Gadgetron{
 
 template<typename T> 
-hoNDRedundantWavelet<T>::hoNDRedundantWavelet()
+hoNDRedundantWavelet<T>::hoNDRedundantWavelet() : real_filter_(false)
 {
 }
 
@@ -51,6 +51,8 @@ void hoNDRedundantWavelet<T>::compute_wavelet_filter(const std::vector<T>& s)
         {
             fh_r_[n] = -fh_r_[n];
         }
+
+        this->compute_real_filter();
     }
     catch (...)
     {
@@ -133,206 +135,348 @@ void hoNDRedundantWavelet<T>::set_wavelet_filter(const std::vector<T>& fl_d, con
     fh_d_ = fh_d;
     fl_r_ = fl_r;
     fh_r_ = fh_r;
+
+    this->compute_real_filter();
 }
 
 template<typename T>
-void hoNDRedundantWavelet<T>::filter_d(const T* const in, size_t len_in, size_t stride_in, T* out_l, T* out_h, size_t stride_out)
+void hoNDRedundantWavelet<T>::compute_real_filter()
 {
     size_t len = fl_d_.size();
 
-    size_t n, m;
-    for (n = 0; n < len_in-len+1; n++)
+    fl_d_real_.resize(len);
+    fh_d_real_.resize(len);
+    fl_r_real_.resize(len);
+    fh_r_real_.resize(len);
+
+    real_filter_ = true;
+
+    const std::vector<T>* f[4] = { &fl_d_, &fh_d_, &fl_r_, &fh_r_ };
+    std::vector<value_type>* fr[4] = { &fl_d_real_, &fh_d_real_, &fl_r_real_, &fh_r_real_ };
+
+    for (size_t k = 0; k < 4; k++)
     {
-        T vl = 0;
-        T vh = 0;
-        for (m = 0; m < len; m++)
+        for (size_t n = 0; n < len; n++)
         {
-            vl += in[(n + m)*stride_in] * fl_d_[len - m - 1];
-            vh += in[(n + m)*stride_in] * fh_d_[len - m - 1];
-        }
+            const value_type* pv = reinterpret_cast<const value_type*>(&(*f[k])[n]);
+            (*fr[k])[n] = pv[0];
 
-        out_l[n*stride_out] = vl;
-        out_h[n*stride_out] = vh;
+            if (sizeof(T) > sizeof(value_type) && pv[1] != 0) real_filter_ = false;
+        }
     }
+}
 
-    for (n = len_in - len + 1; n < len_in; n++)
+template<typename T>
+template<typename F>
+void hoNDRedundantWavelet<T>::filter_d(const T* const in, size_t len_in, size_t stride, size_t N, size_t start, size_t end, const F* fl, const F* fh, T* out_l, T* out_h)
+{
+    size_t len = fl_d_.size();
+
+    size_t n, m, ii;
+    for (n = start; n < end; n++)
     {
-        T vl = 0;
-        T vh = 0;
-        for (m = 0; m < len; m++)
+        T* vl = out_l + (n - start)*stride;
+        T* vh = out_h + (n - start)*stride;
+
+        for (ii = 0; ii < N; ii++)
         {
-            size_t k = n + m;
-            if (k >= len_in) k -= len_in;
-            vl += in[k*stride_in] * fl_d_[len - m - 1];
-            vh += in[k*stride_in] * fh_d_[len - m - 1];
+            vl[ii] = T(0);
+            vh[ii] = T(0);
         }
 
-        out_l[n*stride_out] = vl;
-        out_h[n*stride_out] = vh;
+        for (m = 0; m < len; m++)
+        {
+            const T* x = in + ((n + m) % len_in)*stride;
+            const F a = fl[len - m - 1];
+            const F b = fh[len - m - 1];
+
+            for (ii = 0; ii < N; ii++)
+            {
+                vl[ii] += x[ii] * a;
+                vh[ii] += x[ii] * b;
+            }
+        }
     }
 }
 
 template<typename T>
-void hoNDRedundantWavelet<T>::filter_r(const T* const in_l, const T* const in_h, size_t len_in, size_t stride_in, T* out, size_t stride_out)
+template<typename F>
+void hoNDRedundantWavelet<T>::filter_r(const T* const in_l, const T* const in_h, size_t len_in, size_t stride, size_t N, size_t start, size_t end, const F* fl, const F* fh, T* out)
 {
-    long long len = fl_r_.size();
+    size_t len = fl_r_.size();
 
-    long long n, m;
-    for (n = len-1; n < (long long)len_in; n++)
+    size_t n, m, ii;
+    for (n = start; n < end; n++)
     {
-        T v = 0;
+        T* v = out + (n - start)*stride;
+
+        for (ii = 0; ii < N; ii++)
+        {
+            v[ii] = T(0);
+        }
+
         for (m = 0; m < len; m++)
         {
-            size_t k = (n + m + 1 - len)*stride_in;
-            v += (in_l[k] * fl_r_[len - m - 1]) + (in_h[k] * fh_r_[len - m - 1]);
+            size_t k = ((n + m + len*len_in + 1 - len) % len_in)*stride;
+            const T* xl = in_l + k;
+            const T* xh = in_h + k;
+            const F a = fl[len - m - 1];
+            const F b = fh[len - m - 1];
+
+            for (ii = 0; ii < N; ii++)
+            {
+                v[ii] += (xl[ii] * a) + (xh[ii] * b);
+            }
         }
+    }
+}
 
-        out[n*stride_out] = v;
+template<typename T>
+template<typename F>
+void hoNDRedundantWavelet<T>::filter_d(const T* const in, size_t len_in, const F* fl, const F* fh, T* out_l, T* out_h, T* buf)
+{
+    size_t len = fl_d_.size();
+
+    // periodic extension, so that the inner loop has no boundary condition
+    size_t n, m;
+    for (n = 0; n < len_in + len - 1; n++)
+    {
+        buf[n] = in[n % len_in];
     }
 
-    for (n = 0; n < len -1; n++)
+    for (n = 0; n < len_in; n++)
     {
-        T v = 0;
-        for (m = 0; m < len; m++)
+        out_l[n] = T(0);
+        out_h[n] = T(0);
+    }
+
+    for (m = 0; m < len; m++)
+    {
+        const T* x = buf + m;
+        const F a = fl[len - m - 1];
+        const F b = fh[len - m - 1];
+
+        for (n = 0; n < len_in; n++)
         {
-            long long k = (n + m + 1 - len);
-            if (k < 0) k += len_in;
-            v += (in_l[k*stride_in] * fl_r_[len - m - 1]) + (in_h[k*stride_in] * fh_r_[len - m - 1]);
+            out_l[n] += x[n] * a;
+            out_h[n] += x[n] * b;
         }
+    }
+}
+
+template<typename T>
+template<typename F>
+void hoNDRedundantWavelet<T>::filter_r(const T* const in_l, const T* const in_h, size_t len_in, const F* fl, const F* fh, T* out, T* buf)
+{
+    size_t len = fl_r_.size();
 
-        out[n*stride_out] = v;
+    T* bl = buf;
+    T* bh = buf + len_in + len - 1;
+
+    size_t n, m;
+    for (n = 0; n < len_in + len - 1; n++)
+    {
+        size_t k = (n + len*len_in + 1 - len) % len_in;
+        bl[n] = in_l[k];
+        bh[n] = in_h[k];
+    }
+
+    for (n = 0; n < len_in; n++)
+    {
+        out[n] = T(0);
+    }
+
+    for (m = 0; m < len; m++)
+    {
+        const T* xl = bl + m;
+        const T* xh = bh + m;
+        const F a = fl[len - m - 1];
+        const F b = fh[len - m - 1];
+
+        for (n = 0; n < len_in; n++)
+        {
+            out[n] += (xl[n] * a) + (xh[n] * b);
+        }
     }
 }
 
 template<typename T>
 void hoNDRedundantWavelet<T>::dwt1D(const T* const in, T* out, size_t RO, size_t level)
 {
-    memcpy(out, in, sizeof(T)*RO);
+    if (real_filter_)
+        this->dwt1D_impl(in, out, RO, level, &fl_d_real_[0], &fh_d_real_[0]);
+    else
+        this->dwt1D_impl(in, out, RO, level, &fl_d_[0], &fh_d_[0]);
+}
 
-    std::vector<T> buf_ro(RO);
+template<typename T>
+void hoNDRedundantWavelet<T>::idwt1D(const T* const in, T* out, size_t RO, size_t level)
+{
+    if (real_filter_)
+        this->idwt1D_impl(in, out, RO, level, &fl_r_real_[0], &fh_r_real_[0]);
+    else
+        this->idwt1D_impl(in, out, RO, level, &fl_r_[0], &fh_r_[0]);
+}
+
+template<typename T>
+void hoNDRedundantWavelet<T>::dwt2D(const T* const in, T* out, size_t RO, size_t E1, size_t level)
+{
+    if (real_filter_)
+        this->dwt2D_impl(in, out, RO, E1, level, &fl_d_real_[0], &fh_d_real_[0]);
+    else
+        this->dwt2D_impl(in, out, RO, E1, level, &fl_d_[0], &fh_d_[0]);
+}
+
+template<typename T>
+void hoNDRedundantWavelet<T>::idwt2D(const T* const in, T* out, size_t RO, size_t E1, size_t level)
+{
+    if (real_filter_)
+        this->idwt2D_impl(in, out, RO, E1, level, &fl_r_real_[0], &fh_r_real_[0]);
+    else
+        this->idwt2D_impl(in, out, RO, E1, level, &fl_r_[0], &fh_r_[0]);
+}
+
+template<typename T>
+void hoNDRedundantWavelet<T>::dwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level)
+{
+    if (real_filter_)
+        this->dwt3D_impl(in, out, RO, E1, E2, level, &fl_d_real_[0], &fh_d_real_[0]);
+    else
+        this->dwt3D_impl(in, out, RO, E1, E2, level, &fl_d_[0], &fh_d_[0]);
+}
+
+template<typename T>
+void hoNDRedundantWavelet<T>::idwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level)
+{
+    if (real_filter_)
+        this->idwt3D_impl(in, out, RO, E1, E2, level, &fl_r_real_[0], &fh_r_real_[0]);
+    else
+        this->idwt3D_impl(in, out, RO, E1, E2, level, &fl_r_[0], &fh_r_[0]);
+}
+
+template<typename T>
+template<typename F>
+void hoNDRedundantWavelet<T>::dwt1D_impl(const T* const in, T* out, size_t RO, size_t level, const F* fl, const F* fh)
+{
+    std::vector<T> buf(RO + fl_d_.size());
 
     for (size_t n = 0; n < level; n++)
     {
-        T* l = out;
-        T* h = l + n * RO + RO;
+        const T* l = (n == 0) ? in : out;
+        T* h = out + n * RO + RO;
 
-        this->filter_d(l, RO, 1, &buf_ro[0], h, 1);
-
-        memcpy(out, &buf_ro[0], sizeof(T)*RO);
+        this->filter_d(l, RO, fl, fh, out, h, &buf[0]);
     }
 }
 
 template<typename T>
-void hoNDRedundantWavelet<T>::idwt1D(const T* const in, T* out, size_t RO, size_t level)
+template<typename F>
+void hoNDRedundantWavelet<T>::idwt1D_impl(const T* const in, T* out, size_t RO, size_t level, const F* fl, const F* fh)
 {
     memcpy(out, in, sizeof(T)*RO);
 
-    std::vector<T> buf_ro(RO);
+    std::vector<T> buf(2 * (RO + fl_r_.size()));
 
     long long n;
     for (n = (long long)level - 1; n >= 0; n--)
     {
-        T* l = out;
         const T* const h = in + n * RO + RO;
 
-        this->filter_r(l, h, RO, 1, &buf_ro[0], 1);
-        memcpy(out, &buf_ro[0], sizeof(T)*RO);
+        this->filter_r(out, h, RO, fl, fh, out, &buf[0]);
     }
 }
 
 template<typename T>
-void hoNDRedundantWavelet<T>::dwt2D(const T* const in, T* out, size_t RO, size_t E1, size_t level)
+template<typename F>
+void hoNDRedundantWavelet<T>::dwt2D_impl(const T* const in, T* out, size_t RO, size_t E1, size_t level, const F* fl, const F* fh)
 {
-    memcpy(out, in, sizeof(T)*RO*E1);
+    size_t N2D = RO*E1;
 
-    std::vector<T> buf_l(E1), buf_h(E1), buf_ro(RO);
+    std::vector<T> buf(2 * N2D + RO + fl_d_.size());
+    T* pL = &buf[0];
+    T* pH = pL + N2D;
+    T* pExt = pH + N2D;
 
     for (size_t n = 0; n<level; n++)
     {
-        T* LH = out + (3 * n + 1)*RO*E1;
+        const T* src = (n == 0) ? in : out;
 
-        size_t ro, e1;
-        // along E1
-        for (ro = 0; ro < RO; ro++)
-        {
-            this->filter_d(out + ro, E1, RO, &buf_l[0], &buf_h[0], 1);
+        T* LH = out + (3 * n + 1)*N2D;
+        T* HL = LH + N2D;
+        T* HH = HL + N2D;
 
-            for (e1 = 0; e1<E1; e1++)
-            {
-                out[ro + e1*RO] = buf_l[e1];
-                LH[ro + e1*RO] = buf_h[e1];
-            }
-        }
-
-        T* HL = LH + RO*E1;
-        T* HH = HL + RO*E1;
+        // along E1, all RO columns at once
+        this->filter_d(src, E1, RO, RO, 0, E1, fl, fh, pL, pH);
 
         // along RO
-        for (e1 = 0; e1<E1; e1++)
+        for (size_t e1 = 0; e1<E1; e1++)
         {
-            this->filter_d(out + e1*RO, RO, 1, &buf_ro[0], HL + e1*RO, 1);
-            memcpy(out + e1*RO, &buf_ro[0], sizeof(T)*RO);
-
-            this->filter_d(LH + e1*RO, RO, 1, &buf_ro[0], HH + e1*RO, 1);
-            memcpy(LH + e1*RO, &buf_ro[0], sizeof(T)*RO);
+            size_t r = e1*RO;
+            this->filter_d(pL + r, RO, fl, fh, out + r, HL + r, pExt);
+            this->filter_d(pH + r, RO, fl, fh, LH + r, HH + r, pExt);
         }
     }
 }
 
 template<typename T>
-void hoNDRedundantWavelet<T>::idwt2D(const T* const in, T* out, size_t RO, size_t E1, size_t level)
+template<typename F>
+void hoNDRedundantWavelet<T>::idwt2D_impl(const T* const in, T* out, size_t RO, size_t E1, size_t level, const F* fl, const F* fh)
 {
-    memcpy(out, in, sizeof(T)*RO*E1);
+    size_t N2D = RO*E1;
 
-    std::vector<T> buf_ro(RO), buf_e1(E1);
+    memcpy(out, in, sizeof(T)*N2D);
 
-    hoNDArray<T> tmp(RO*E1);
-    T* pTmp = tmp.begin();
+    std::vector<T> buf(2 * N2D + 2 * (RO + fl_r_.size()));
+    T* pX = &buf[0];
+    T* pTmp = pX + N2D;
+    T* pExt = pTmp + N2D;
 
     long long n;
     for (n = (long long)level - 1; n >= 0; n--)
     {
-        const T* const LH = in + (3 * n + 1)*RO*E1;
-        const T* const HL = LH + RO*E1;
-        const T* const HH = HL + RO*E1;
+        const T* const LH = in + (3 * n + 1)*N2D;
+        const T* const HL = LH + N2D;
+        const T* const HH = HL + N2D;
 
-        size_t ro, e1;
         // along RO
-        for (e1 = 0; e1<E1; e1++)
+        for (size_t e1 = 0; e1<E1; e1++)
         {
-            this->filter_r(out + e1*RO, HL + e1*RO, RO, 1, &buf_ro[0], 1);
-            memcpy(out + e1*RO, &buf_ro[0], sizeof(T)*RO);
-
-            this->filter_r(LH + e1*RO, HH + e1*RO, RO, 1, pTmp + e1*RO, 1);
+            size_t r = e1*RO;
+            this->filter_r(out + r, HL + r, RO, fl, fh, pX + r, pExt);
+            this->filter_r(LH + r, HH + r, RO, fl, fh, pTmp + r, pExt);
         }
 
-        // along e1
-        for (ro = 0; ro<RO; ro++)
-        {
-            this->filter_r(out + ro, pTmp + ro, E1, RO, &buf_e1[0], 1);
-
-            for (e1 = 0; e1<E1; e1++)
-            {
-                out[ro + e1*RO] = buf_e1[e1];
-            }
-        }
+        // along E1, all RO columns at once
+        this->filter_r(pX, pTmp, E1, RO, RO, 0, E1, fl, fh, out);
     }
 }
 
 template<typename T>
-void hoNDRedundantWavelet<T>::dwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level)
+template<typename F>
+void hoNDRedundantWavelet<T>::dwt3D_impl(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level, const F* fl, const F* fh)
 {
     try
     {
-        memcpy(out, in, sizeof(T)*RO*E1*E2);
-
         long long N2D = RO*E1;
         long long N3D = RO*E1*E2;
 
+        size_t len = fl_d_.size();
+
+        // approximation of the previous level, so that the planes can be processed in parallel
+        hoNDArray<T> LL;
+        if (level > 1) LL.create(N3D);
+
         // process order E2, E1, RO
 
         for (size_t n = 0; n<level; n++)
         {
+            const T* src = in;
+            if (n > 0)
+            {
+                memcpy(LL.begin(), out, sizeof(T)*N3D);
+                src = LL.begin();
+            }
+
             T* lll = out;
             T* llh = lll + n * 7 * N3D + N3D;
             T* lhl = llh + N3D;
@@ -342,103 +486,40 @@ void hoNDRedundantWavelet<T>::dwt3D(const T* const in, T* out, size_t RO, size_t
             T* hhl = hlh + N3D;
             T* hhh = hhl + N3D;
 
-            // ------------------------------------------
-            // E2
-            // ------------------------------------------
-            long long e1;
-#pragma omp parallel private(e1) shared(RO, E1, E2, N2D, lll, hll)
-            {
-                std::vector<T> buf_e2(E2), buf_l(E2), buf_h(E2);
-#pragma omp for
-                for (e1 = 0; e1 < (long long)E1; e1++)
-                {
-                    for (size_t ro = 0; ro < RO; ro++)
-                    {
-                        size_t ind = ro + e1*RO;
-
-                        for (size_t e2 = 0; e2 < E2; e2++)
-                        {
-                            size_t ind3d = ind + e2*N2D;
-                            buf_e2[e2] = lll[ind3d];
-                        }
-
-                        this->filter_d(&buf_e2[0], E2, 1, &buf_l[0], &buf_h[0], 1);
-
-                        for (size_t e2 = 0; e2 < E2; e2++)
-                        {
-                            size_t ind3d = ind + e2*N2D;
-                            lll[ind3d] = buf_l[e2];
-                            hll[ind3d] = buf_h[e2];
-                        }
-                    }
-                }
-            }
-
-            // ------------------------------------------
-            // E1
-            // ------------------------------------------
-
             long long e2;
 
-#pragma omp parallel private(e2) shared(RO, E1, E2, N2D, lll, lhl, hll, hhl)
+#pragma omp parallel default(none) private(e2) shared(RO, E1, E2, N2D, len, src, fl, fh, lll, llh, lhl, lhh, hll, hlh, hhl, hhh)
             {
-                std::vector<T> buf_e1(E1), buf_l(E1), buf_h(E1);
-                std::vector<T> buf_e1_2(E1), buf_l_2(E1), buf_h_2(E1);
+                std::vector<T> buf(4 * N2D + RO + len);
+                T* pl = &buf[0];
+                T* ph = pl + N2D;
+                T* pL = ph + N2D;
+                T* pH = pL + N2D;
+                T* pExt = pH + N2D;
+
 #pragma omp for
                 for (e2 = 0; e2 < (long long)E2; e2++)
                 {
-                    size_t ind3D = e2*N2D;
-                    for (size_t ro = 0; ro < RO; ro++)
-                    {
-                        size_t ind;
-                        for (size_t e1 = 0; e1 < E1; e1++)
-                        {
-                            ind = ro + ind3D + e1*RO;
-                            buf_e1[e1] = lll[ind];
-                            buf_e1_2[e1] = hll[ind];
-                        }
-
-                        this->filter_d(&buf_e1[0], E1, 1, &buf_l[0], &buf_h[0], 1);
-                        this->filter_d(&buf_e1_2[0], E1, 1, &buf_l_2[0], &buf_h_2[0], 1);
-
-                        for (size_t e1 = 0; e1 < E1; e1++)
-                        {
-                            ind = ro + ind3D + e1*RO;
-                            lll[ind] = buf_l[e1];
-                            lhl[ind] = buf_h[e1];
-
-                            hll[ind] = buf_l_2[e1];
-                            hhl[ind] = buf_h_2[e1];
-                        }
-                    }
-                }
-            }
+                    size_t c = e2*N2D;
 
-            // ------------------------------------------
-            // RO
-            // ------------------------------------------
+                    // along E2, all RO*E1 columns at once
+                    this->filter_d(src, E2, N2D, N2D, e2, e2 + 1, fl, fh, pl, ph);
 
-#pragma omp parallel private(e2) shared(RO, E1, E2, N2D, lll, hll, lhl, hhl, llh, hlh, lhh, hhh)
-            {
-                std::vector<T> buf_l(RO);
-#pragma omp for
-                for (e2 = 0; e2 < (long long)E2; e2++)
-                {
+                    // along E1 and RO, for the E2 low and high pass
+                    this->filter_d(pl, E1, RO, RO, 0, E1, fl, fh, pL, pH);
                     for (size_t e1 = 0; e1 < E1; e1++)
                     {
-                        size_t ind3D = e1*RO + e2*N2D;
-
-                        this->filter_d(lll + ind3D, RO, 1, &buf_l[0], llh + ind3D, 1);
-                        memcpy(lll + ind3D, &buf_l[0], sizeof(T)*RO);
-
-                        this->filter_d(lhl + ind3D, RO, 1, &buf_l[0], lhh + ind3D, 1);
-                        memcpy(lhl + ind3D, &buf_l[0], sizeof(T)*RO);
-
-                        this->filter_d(hll + ind3D, RO, 1, &buf_l[0], hlh + ind3D, 1);
-                        memcpy(hll + ind3D, &buf_l[0], sizeof(T)*RO);
+                        size_t r = e1*RO;
+                        this->filter_d(pL + r, RO, fl, fh, lll + c + r, llh + c + r, pExt);
+                        this->filter_d(pH + r, RO, fl, fh, lhl + c + r, lhh + c + r, pExt);
+                    }
 
-                        this->filter_d(hhl + ind3D, RO, 1, &buf_l[0], hhh + ind3D, 1);
-                        memcpy(hhl + ind3D, &buf_l[0], sizeof(T)*RO);
+                    this->filter_d(ph, E1, RO, RO, 0, E1, fl, fh, pL, pH);
+                    for (size_t e1 = 0; e1 < E1; e1++)
+                    {
+                        size_t r = e1*RO;
+                        this->filter_d(pL + r, RO, fl, fh, hll + c + r, hlh + c + r, pExt);
+                        this->filter_d(pH + r, RO, fl, fh, hhl + c + r, hhh + c + r, pExt);
                     }
                 }
             }
@@ -451,7 +532,8 @@ void hoNDRedundantWavelet<T>::dwt3D(const T* const in, T* out, size_t RO, size_t
 }
 
 template<typename T>
-void hoNDRedundantWavelet<T>::idwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level)
+template<typename F>
+void hoNDRedundantWavelet<T>::idwt3D_impl(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level, const F* fl, const F* fh)
 {
     try
     {
@@ -460,18 +542,14 @@ void hoNDRedundantWavelet<T>::idwt3D(const T* const in, T* out, size_t RO, size_
         long long N2D = RO*E1;
         long long N3D = RO*E1*E2;
 
+        size_t len = fl_r_.size();
+
         hoNDArray<T> LL(N3D);
         T* pLL = LL.begin();
 
         hoNDArray<T> HL(N3D);
         T* pHL = HL.begin();
 
-        hoNDArray<T> LH(N3D);
-        T* pLH = LH.begin();
-
-        hoNDArray<T> HH(N3D);
-        T* pHH = HH.begin();
-
         long long n;
         for (n = (long long)level - 1; n >= 0; n--)
         {
@@ -485,49 +563,35 @@ void hoNDRedundantWavelet<T>::idwt3D(const T* const in, T* out, size_t RO, size_
             const T* const hhh = hhl + N3D;
 
             // ------------------------------------------
-            // RO
+            // RO and E1
             // ------------------------------------------
 
             long long e2;
-#pragma omp parallel for private(e2) shared(RO, E1, E2, N2D, pLL, pHL, pLH, pHH) 
-            for (e2 = 0; e2<(long long)E2; e2++)
+#pragma omp parallel default(none) private(e2) shared(RO, E1, E2, N2D, len, fl, fh, lll, llh, lhl, lhh, hll, hlh, hhl, hhh, pLL, pHL)
             {
-                for (size_t e1 = 0; e1<E1; e1++)
-                {
-                    size_t ind3D = e1*RO + e2*N2D;
-
-                    this->filter_r(lll + ind3D, llh + ind3D, RO, 1, pLL + ind3D, 1);
-                    this->filter_r(lhl + ind3D, lhh + ind3D, RO, 1, pLH + ind3D, 1);
-                    this->filter_r(hll + ind3D, hlh + ind3D, RO, 1, pHL + ind3D, 1);
-                    this->filter_r(hhl + ind3D, hhh + ind3D, RO, 1, pHH + ind3D, 1);
-                }
-            }
-
-            // ------------------------------------------
-            // E1
-            // ------------------------------------------
+                std::vector<T> buf(4 * N2D + 2 * (RO + len));
+                T* pX1 = &buf[0];
+                T* pX2 = pX1 + N2D;
+                T* pX3 = pX2 + N2D;
+                T* pX4 = pX3 + N2D;
+                T* pExt = pX4 + N2D;
 
-#pragma omp parallel private(e2) shared(RO, E1, E2, N2D, pLL, pHL, pLH, pHH)
-            {
-                std::vector<T> buf_l(E1), buf_l_2(E1);
 #pragma omp for
                 for (e2 = 0; e2 < (long long)E2; e2++)
                 {
-                    size_t ind3D = e2*N2D;
-                    for (size_t ro = 0; ro < RO; ro++)
-                    {
-                        size_t ind = ro + ind3D;
+                    size_t c = e2*N2D;
 
-                        this->filter_r(pLL + ind, pLH + ind, E1, RO, &buf_l[0], 1);
-                        this->filter_r(pHL + ind, pHH + ind, E1, RO, &buf_l_2[0], 1);
-
-                        for (size_t e1 = 0; e1 < E1; e1++)
-                        {
-                            ind = ro + e1*RO + ind3D;
-                            pLL[ind] = buf_l[e1];
-                            pHL[ind] = buf_l_2[e1];
-                        }
+                    for (size_t e1 = 0; e1 < E1; e1++)
+                    {
+                        size_t r = e1*RO;
+                        this->filter_r(lll + c + r, llh + c + r, RO, fl, fh, pX1 + r, pExt);
+                        this->filter_r(lhl + c + r, lhh + c + r, RO, fl, fh, pX2 + r, pExt);
+                        this->filter_r(hll + c + r, hlh + c + r, RO, fl, fh, pX3 + r, pExt);
+                        this->filter_r(hhl + c + r, hhh + c + r, RO, fl, fh, pX4 + r, pExt);
                     }
+
+                    this->filter_r(pX1, pX2, E1, RO, RO, 0, E1, fl, fh, pLL + c);
+                    this->filter_r(pX3, pX4, E1, RO, RO, 0, E1, fl, fh, pHL + c);
                 }
             }
 
@@ -535,16 +599,10 @@ void hoNDRedundantWavelet<T>::idwt3D(const T* const in, T* out, size_t RO, size_
             // E2
             // ------------------------------------------
 
-            long long e1;
-
-#pragma omp parallel for private(e1) shared(RO, E1, E2, N2D, pLL,pHL, out) 
-            for (e1 = 0; e1<(long long)E1; e1++)
+#pragma omp parallel for default(none) private(e2) shared(E2, N2D, fl, fh, pLL, pHL, out)
+            for (e2 = 0; e2 < (long long)E2; e2++)
             {
-                for (size_t ro = 0; ro<RO; ro++)
-                {
-                    size_t ind2D = ro + e1*RO;
-                    this->filter_r(pLL + ind2D, pHL + ind2D, E2, N2D, out+ind2D, N2D);
-                }
+                this->filter_r(pLL, pHL, E2, N2D, N2D, e2, e2 + 1, fl, fh, out + e2*N2D);
             }
         }
     }
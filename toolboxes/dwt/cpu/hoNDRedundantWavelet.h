@@ -22,7 +22,7 @@ namespace Gadgetron{
         virtual ~hoNDRedundantWavelet();
 
         /// these compute_wavelet_filter should be called first before calling transform
-        /// transform is NOT thread-safe, since some class member variables are used as buffer for computation
+        /// once the filters are set, transform can be called from multiple threads, since all buffers are allocated per call
 
         /// utility function to compute wavelet filter from commonly used wavelet scale functions
         /// wav_name : "db2", "db3", "db4", "db5"
@@ -44,6 +44,16 @@ namespace Gadgetron{
         std::vector<T> fl_r_;
         std::vector<T> fh_r_;
 
+        /// real valued copies of the filters, used if all filter coefficients are real
+        std::vector<value_type> fl_d_real_;
+        std::vector<value_type> fh_d_real_;
+        std::vector<value_type> fl_r_real_;
+        std::vector<value_type> fh_r_real_;
+        bool real_filter_;
+
+        /// fill the real valued filters
+        void compute_real_filter();
+
         /// implementation for 1D dwt and idwt
         /// out: [RO 1+level] array
         virtual void dwt1D(const T* const in, T* out, size_t RO, size_t level);
@@ -62,10 +72,27 @@ namespace Gadgetron{
         /// in: [RO 1+7*level] array
         virtual void idwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level);
 
-        /// perform decomposition filter
-        void filter_d(const T* const in, size_t len_in, size_t stride_in, T* out_l, T* out_h, size_t stride_out);
-        /// perform reconstruction filter
-        void filter_r(const T* const in_l, const T* const in_h, size_t len_in, size_t stride_in, T* out, size_t stride_out);
+        /// implementation of the transforms for filter coefficients of type F
+        template <typename F> void dwt1D_impl(const T* const in, T* out, size_t RO, size_t level, const F* fl, const F* fh);
+        template <typename F> void idwt1D_impl(const T* const in, T* out, size_t RO, size_t level, const F* fl, const F* fh);
+        template <typename F> void dwt2D_impl(const T* const in, T* out, size_t RO, size_t E1, size_t level, const F* fl, const F* fh);
+        template <typename F> void idwt2D_impl(const T* const in, T* out, size_t RO, size_t E1, size_t level, const F* fl, const F* fh);
+        template <typename F> void dwt3D_impl(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level, const F* fl, const F* fh);
+        template <typename F> void idwt3D_impl(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level, const F* fl, const F* fh);
+
+        /// perform decomposition filter along a dimension with the given stride
+        /// the filter is applied to N contiguous columns at once and outputs are computed for positions [start, end)
+        /// out_l and out_h point to the output of position start and have the same stride as in
+        template <typename F> void filter_d(const T* const in, size_t len_in, size_t stride, size_t N, size_t start, size_t end, const F* fl, const F* fh, T* out_l, T* out_h);
+        /// perform reconstruction filter along a dimension with the given stride
+        template <typename F> void filter_r(const T* const in_l, const T* const in_h, size_t len_in, size_t stride, size_t N, size_t start, size_t end, const F* fl, const F* fh, T* out);
+
+        /// perform decomposition filter along the contiguous dimension
+        /// buf: len_in + filter length elements
+        template <typename F> void filter_d(const T* const in, size_t len_in, const F* fl, const F* fh, T* out_l, T* out_h, T* buf);
+        /// perform reconstruction filter along the contiguous dimension
+        /// buf: 2*(len_in + filter length) elements
+        template <typename F> void filter_r(const T* const in_l, const T* const in_h, size_t len_in, const F* fl, const F* fh, T* out, T* buf);
     };
 }
 
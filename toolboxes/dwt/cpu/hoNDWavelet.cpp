@@ -153,6 +153,111 @@ void hoNDWavelet<T>::transform(const hoNDArray<T>& in, hoNDArray<T>& out, size_t
     }
 }
 
+template<typename T>
+void hoNDWavelet<T>::shrink(hoNDArray<T>& coeff, size_t NDim, size_t level, value_type thres, bool with_approx_coeff)
+{
+    try
+    {
+        GADGET_CHECK_THROW(NDim >= 1 && NDim <= 3);
+        GADGET_CHECK_THROW(coeff.get_number_of_dimensions() > NDim);
+
+        size_t N = 1;
+        for (size_t ii = 0; ii < NDim; ii++) N *= coeff.get_size(ii);
+
+        size_t W = coeff.get_size(NDim);
+        GADGET_CHECK_THROW(W == 1 + ((1 << NDim) - 1) * level);
+
+        size_t startW = (with_approx_coeff ? 0 : 1);
+        if (W <= startW) return;
+
+        // every detail band of every block is thresholded independently
+        long long numW = W - startW;
+        long long num = (long long)(coeff.get_number_of_elements() / (N*W)) * numW;
+
+        T* pCoeff = coeff.begin();
+
+        long long n;
+#pragma omp parallel for default(none) private(n) shared(num, numW, N, W, startW, thres, pCoeff) if(num>1)
+        for (n = 0; n < num; n++)
+        {
+            size_t b = n / numW;
+            size_t w = startW + n % numW;
+            this->apply_soft_thres(N, thres, pCoeff + (b*W + w)*N);
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDWavelet<T>::shrink(...) ... ");
+    }
+}
+
+template<typename T>
+void hoNDWavelet<T>::proximity(const hoNDArray<T>& in, hoNDArray<T>& out, size_t NDim, size_t level, value_type thres, bool with_approx_coeff)
+{
+    try
+    {
+        GADGET_CHECK_THROW(NDim >= 1 && NDim <= 3);
+        GADGET_CHECK_THROW(in.get_number_of_dimensions() >= NDim);
+
+        if (!out.dimensions_equal(&in))
+        {
+            out.create(in.get_dimensions());
+        }
+
+        size_t RO = in.get_size(0);
+        size_t E1 = (NDim > 1) ? in.get_size(1) : 1;
+        size_t E2 = (NDim > 2) ? in.get_size(2) : 1;
+
+        size_t N = RO*E1*E2;
+        size_t NOut = (1 + ((1 << NDim) - 1) * level) * N;
+        size_t startN = (with_approx_coeff ? 0 : N);
+
+        if (level == 0)
+        {
+            memcpy(out.begin(), in.begin(), in.get_number_of_bytes());
+            if (with_approx_coeff) this->apply_soft_thres(out.get_number_of_elements(), thres, out.begin());
+            return;
+        }
+
+        long long num = in.get_number_of_elements() / N;
+
+        const T* pIn = in.begin();
+        T* pOut = out.begin();
+
+        long long n;
+
+#pragma omp parallel default(none) private(n) shared(num, N, NOut, startN, RO, E1, E2, NDim, level, thres, pIn, pOut) if(num>1)
+        {
+            // coefficients of one block, reused for all blocks of this thread
+            hoNDArray<T> coeff(NOut);
+
+#pragma omp for
+            for (n = 0; n < num; n++)
+            {
+                if (NDim == 1)
+                    this->dwt1D(pIn + n*N, coeff.begin(), RO, level);
+                else if (NDim == 2)
+                    this->dwt2D(pIn + n*N, coeff.begin(), RO, E1, level);
+                else
+                    this->dwt3D(pIn + n*N, coeff.begin(), RO, E1, E2, level);
+
+                this->apply_soft_thres(NOut - startN, thres, coeff.begin() + startN);
+
+                if (NDim == 1)
+                    this->idwt1D(coeff.begin(), pOut + n*N, RO, level);
+                else if (NDim == 2)
+                    this->idwt2D(coeff.begin(), pOut + n*N, RO, E1, level);
+                else
+                    this->idwt3D(coeff.begin(), pOut + n*N, RO, E1, E2, level);
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDWavelet<T>::proximity(...) ... ");
+    }
+}
+
 // ------------------------------------------------------------
 // Instantiation
 // ------------------------------------------------------------
@@ -37,6 +37,18 @@ namespace Gadgetron{
         /// if forward==false, the role of in and out is switched and inverse wavelet transform is performed
         virtual void transform(const hoNDArray<T>& in, hoNDArray<T>& out, size_t NDim, size_t level, bool forward);
 
+        /// soft thresholding of wavelet coefficients, in place
+        /// coeff: [RO 1+level ...], [RO E1 1+3*level ...] or [RO E1 E2 1+7*level ...] array, as computed by transform
+        /// every coefficient v is replaced by v*max(|v|-thres, 0)/|v|
+        /// if with_approx_coeff==false, the approximation coefficients are not changed
+        virtual void shrink(hoNDArray<T>& coeff, size_t NDim, size_t level, value_type thres, bool with_approx_coeff = false);
+
+        /// fused proximal operator of the L1 norm of wavelet coefficients
+        /// out = inverse( shrink( forward(in) ) ); the coefficients are only kept in a buffer per transformed block
+        /// best suited to many small blocks (e.g. 2D images of a series), where the coefficients stay in cache
+        /// in and out have the same size [RO E1 E2 ...]
+        virtual void proximity(const hoNDArray<T>& in, hoNDArray<T>& out, size_t NDim, size_t level, value_type thres, bool with_approx_coeff = false);
+
     protected:
 
         /// implementation for 1D dwt and idwt
@@ -56,6 +68,50 @@ namespace Gadgetron{
         virtual void dwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level) = 0;
         /// in: [RO 1+7*level] array
         virtual void idwt3D(const T* const in, T* out, size_t RO, size_t E1, size_t E2, size_t level) = 0;
+
+        /// soft thresholding of N coefficients
+        template <typename T2>
+        static void apply_soft_thres(size_t N, T2 thres, T2* x)
+        {
+            for (size_t n = 0; n < N; n++)
+            {
+                const T2 v = x[n];
+                const T2 m = std::abs(v);
+                x[n] = (m > thres) ? v*((m - thres) / m) : T2(0);
+            }
+        }
+
+        template <typename T2>
+        static void apply_soft_thres(size_t N, T2 thres, std::complex<T2>* x)
+        {
+            for (size_t n = 0; n < N; n++)
+            {
+                T2* pv = reinterpret_cast<T2*>(x + n);
+                const T2 re = pv[0];
+                const T2 im = pv[1];
+                const T2 m = std::sqrt(re*re + im*im);
+                const T2 a = (m > thres) ? (m - thres) / m : T2(0);
+
+                pv[0] = re*a;
+                pv[1] = im*a;
+            }
+        }
+
+        template <typename T2>
+        static void apply_soft_thres(size_t N, T2 thres, complext<T2>* x)
+        {
+            for (size_t n = 0; n < N; n++)
+            {
+                T2* pv = reinterpret_cast<T2*>(x + n);
+                const T2 re = pv[0];
+                const T2 im = pv[1];
+                const T2 m = std::sqrt(re*re + im*im);
+                const T2 a = (m > thres) ? (m - thres) / m : T2(0);
+
+                pv[0] = re*a;
+                pv[1] = im*a;
+            }
+        }
     };
 }
 
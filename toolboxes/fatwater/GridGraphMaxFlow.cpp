@@ -0,0 +1,341 @@
+#include "GridGraphMaxFlow.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Gadgetron
+{
+    GridGraphMaxFlow::GridGraphMaxFlow(size_t X, size_t Y, size_t Z)
+    : X_(X), Y_(Y), Z_(Z), time_(0), flow_(0)
+    {
+        PX_ = X_ + 2;
+        PY_ = Y_ + 2;
+        PZ_ = (Z_ > 1) ? Z_ + 2 : 1;
+        num_dir_ = (Z_ > 1) ? 6 : 4;
+
+        offset_[0] = 1;
+        offset_[1] = -1;
+        offset_[2] = (long long)PX_;
+        offset_[3] = -(long long)PX_;
+        offset_[4] = (long long)(PX_*PY_);
+        offset_[5] = -(long long)(PX_*PY_);
+
+        size_t N = PX_*PY_*PZ_;
+        cap_.resize(N*num_dir_);
+        tr_cap_.resize(N);
+        tree_.resize(N);
+        parent_.resize(N);
+        is_active_.resize(N);
+        ts_.resize(N);
+        dist_.resize(N);
+
+        is_node_.assign(N, 0);
+        for (size_t n = 0; n < num_nodes(); n++) is_node_[padded(n)] = 1;
+
+        this->reset();
+    }
+
+    void GridGraphMaxFlow::reset()
+    {
+        std::fill(cap_.begin(), cap_.end(), cap_type(0));
+        std::fill(tr_cap_.begin(), tr_cap_.end(), cap_type(0));
+        flow_ = 0;
+    }
+
+    void GridGraphMaxFlow::add_terminal_weights(size_t n, cap_type source_set_cost, cap_type sink_set_cost)
+    {
+        // being in the sink set cuts the edge from the source
+        tr_cap_[padded(n)] += sink_set_cost - source_set_cost;
+    }
+
+    void GridGraphMaxFlow::add_edge(size_t n, unsigned int d, cap_type cap, cap_type rev_cap)
+    {
+        size_t p = padded(n);
+        size_t q = (size_t)neighbour(p, d);
+        if (!is_node_[q]) return;
+
+        cap_[p*num_dir_ + d] += cap;
+        cap_[q*num_dir_ + (d ^ 1)] += rev_cap;
+    }
+
+    void GridGraphMaxFlow::add_pairwise(size_t n, unsigned int d, cap_type E00, cap_type E01, cap_type E10, cap_type E11)
+    {
+        size_t p = padded(n);
+        size_t q = (size_t)neighbour(p, d);
+        if (!is_node_[q]) return;
+
+        // E = E00 + (E10-E00) x_p + (E11-E10) x_q + (E01+E10-E00-E11) (1-x_p) x_q
+        tr_cap_[p] += E10 - E00;
+        tr_cap_[q] += E11 - E10;
+
+        cap_type c = E01 + E10 - E00 - E11;
+        if (c > 0) cap_[p*num_dir_ + d] += c;
+    }
+
+    void GridGraphMaxFlow::set_active(size_t p)
+    {
+        if (!is_active_[p])
+        {
+            is_active_[p] = 1;
+            active_.push_back(p);
+        }
+    }
+
+    double GridGraphMaxFlow::maxflow()
+    {
+        size_t N = tree_.size();
+        size_t p;
+
+        active_.clear();
+        orphans_.clear();
+        time_ = 0;
+
+        for (p = 0; p < N; p++)
+        {
+            is_active_[p] = 0;
+            ts_[p] = 0;
+            dist_[p] = 0;
+            parent_[p] = NO_PARENT;
+            tree_[p] = FREE;
+
+            if (!is_node_[p] || tr_cap_[p] == 0) continue;
+
+            tree_[p] = (tr_cap_[p] > 0) ? SOURCE_TREE : SINK_TREE;
+            parent_[p] = TERMINAL;
+            dist_[p] = 1;
+            set_active(p);
+        }
+
+        const unsigned int ND = num_dir_;
+
+        while (!active_.empty())
+        {
+            p = active_.front();
+            active_.pop_front();
+            is_active_[p] = 0;
+
+            if (tree_[p] == FREE) continue;
+
+            // grow the tree of p until it touches the other tree
+            bool found = false;
+            size_t s = 0, t = 0;
+            unsigned int ds = 0;
+
+            for (unsigned int d = 0; d < ND; d++)
+            {
+                size_t q = (size_t)neighbour(p, d);
+
+                // residual capacity from the source side to the sink side
+                cap_type c = (tree_[p] == SOURCE_TREE) ? cap_[p*ND + d] : cap_[q*ND + (d ^ 1)];
+                if (c <= 0) continue;
+
+                if (tree_[q] == FREE)
+                {
+                    tree_[q] = tree_[p];
+                    parent_[q] = (int8_t)(d ^ 1);
+                    ts_[q] = ts_[p];
+                    dist_[q] = dist_[p] + 1;
+                    set_active(q);
+                }
+                else if (tree_[q] != tree_[p])
+                {
+                    if (tree_[p] == SOURCE_TREE)
+                    {
+                        s = p; t = q; ds = d;
+                    }
+                    else
+                    {
+                        s = q; t = p; ds = d ^ 1;
+                    }
+                    found = true;
+                    break;
+                }
+                else if (ts_[q] <= ts_[p] && dist_[q] > dist_[p])
+                {
+                    // q is reached by a shorter path through p
+                    parent_[q] = (int8_t)(d ^ 1);
+                    ts_[q] = ts_[p];
+                    dist_[q] = dist_[p] + 1;
+                }
+            }
+
+            if (!found) continue;
+
+            // p may have more paths to the other tree
+            if (!is_active_[p])
+            {
+                is_active_[p] = 1;
+                active_.push_front(p);
+            }
+
+            time_++;
+            augment(s, t, ds);
+
+            while (!orphans_.empty())
+            {
+                size_t o = orphans_.front();
+                orphans_.pop_front();
+                process_orphan(o);
+            }
+        }
+
+        return flow_;
+    }
+
+    void GridGraphMaxFlow::augment(size_t s, size_t t, unsigned int d)
+    {
+        const unsigned int ND = num_dir_;
+        size_t v, u;
+        int8_t pd;
+
+        // bottleneck
+        cap_type b = cap_[s*ND + d];
+
+        for (v = s; (pd = parent_[v]) != TERMINAL; v = u)
+        {
+            u = (size_t)neighbour(v, pd);
+            b = std::min(b, cap_[u*ND + (pd ^ 1)]);
+        }
+        b = std::min(b, tr_cap_[v]);
+
+        for (v = t; (pd = parent_[v]) != TERMINAL; v = u)
+        {
+            u = (size_t)neighbour(v, pd);
+            b = std::min(b, cap_[v*ND + pd]);
+        }
+        b = std::min(b, -tr_cap_[v]);
+
+        // push the flow
+        size_t q = (size_t)neighbour(s, d);
+        cap_[s*ND + d] -= b;
+        cap_[q*ND + (d ^ 1)] += b;
+
+        for (v = s; (pd = parent_[v]) != TERMINAL; v = u)
+        {
+            u = (size_t)neighbour(v, pd);
+            cap_[v*ND + pd] += b;
+            cap_[u*ND + (pd ^ 1)] -= b;
+            if (cap_[u*ND + (pd ^ 1)] <= 0)
+            {
+                parent_[v] = ORPHAN;
+                orphans_.push_front(v);
+            }
+        }
+        tr_cap_[v] -= b;
+        if (tr_cap_[v] <= 0)
+        {
+            parent_[v] = ORPHAN;
+            orphans_.push_front(v);
+        }
+
+        for (v = t; (pd = parent_[v]) != TERMINAL; v = u)
+        {
+            u = (size_t)neighbour(v, pd);
+            cap_[u*ND + (pd ^ 1)] += b;
+            cap_[v*ND + pd] -= b;
+            if (cap_[v*ND + pd] <= 0)
+            {
+                parent_[v] = ORPHAN;
+                orphans_.push_front(v);
+            }
+        }
+        tr_cap_[v] += b;
+        if (tr_cap_[v] >= 0)
+        {
+            parent_[v] = ORPHAN;
+            orphans_.push_front(v);
+        }
+
+        flow_ += b;
+    }
+
+    void GridGraphMaxFlow::process_orphan(size_t p)
+    {
+        const unsigned int ND = num_dir_;
+        const unsigned int INFINITE_D = std::numeric_limits<unsigned int>::max();
+
+        int8_t best = NO_PARENT;
+        unsigned int d_min = INFINITE_D;
+
+        // a node of the same tree with a residual edge to p and a path to the terminal
+        for (unsigned int d = 0; d < ND; d++)
+        {
+            size_t q = (size_t)neighbour(p, d);
+            if (tree_[q] != tree_[p]) continue;
+
+            cap_type c = (tree_[p] == SOURCE_TREE) ? cap_[q*ND + (d ^ 1)] : cap_[p*ND + d];
+            if (c <= 0) continue;
+
+            unsigned int dist = 0;
+            size_t j = q;
+            while (true)
+            {
+                if (ts_[j] == time_)
+                {
+                    dist += dist_[j];
+                    break;
+                }
+                int8_t pd = parent_[j];
+                dist++;
+                if (pd == TERMINAL)
+                {
+                    ts_[j] = time_;
+                    dist_[j] = 1;
+                    break;
+                }
+                if (pd == ORPHAN || pd == NO_PARENT)
+                {
+                    dist = INFINITE_D;
+                    break;
+                }
+                j = (size_t)neighbour(j, pd);
+            }
+
+            if (dist == INFINITE_D) continue;
+
+            if (dist < d_min)
+            {
+                best = (int8_t)d;
+                d_min = dist;
+            }
+
+            // mark the path for the next searches
+            for (j = q; ts_[j] != time_; j = (size_t)neighbour(j, parent_[j]))
+            {
+                ts_[j] = time_;
+                dist_[j] = dist--;
+            }
+        }
+
+        if (best != NO_PARENT)
+        {
+            parent_[p] = best;
+            ts_[p] = time_;
+            dist_[p] = d_min + 1;
+            return;
+        }
+
+        // no parent, p becomes free and its children orphans
+        uint8_t tree = tree_[p];
+        tree_[p] = FREE;
+        parent_[p] = NO_PARENT;
+
+        for (unsigned int d = 0; d < ND; d++)
+        {
+            size_t q = (size_t)neighbour(p, d);
+            if (tree_[q] != tree) continue;
+
+            cap_type c = (tree == SOURCE_TREE) ? cap_[q*ND + (d ^ 1)] : cap_[p*ND + d];
+            if (c > 0) set_active(q);
+
+            int8_t pd = parent_[q];
+            if (pd == TERMINAL || pd == ORPHAN || pd == NO_PARENT) continue;
+
+            if ((size_t)neighbour(q, pd) == p)
+            {
+                parent_[q] = ORPHAN;
+                orphans_.push_back(q);
+            }
+        }
+    }
+}
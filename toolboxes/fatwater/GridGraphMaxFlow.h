@@ -0,0 +1,115 @@
+#ifndef GRIDGRAPHMAXFLOW_H
+#define GRIDGRAPHMAXFLOW_H
+
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+
+#include "fatwater_export.h"
+
+namespace Gadgetron
+{
+
+    /**
+       Max-flow/min-cut on a 2D or 3D grid with 4 or 6 neighbours, as used for the binary moves of the graph cut field map.
+
+       This is the Boykov-Kolmogorov algorithm (An experimental comparison of min-cut/max-flow algorithms
+       for energy minimization in vision, PAMI 2004) with the timestamp heuristic of its reference implementation.
+       The graph is implicit: the grid is padded with a border of isolated nodes, so the neighbour of a node
+       is a constant offset away and the edge capacities are stored per node and direction.
+
+       Directions are +x, -x, +y, -y, +z, -z; the reverse of direction d is d^1.
+     */
+    class EXPORTFATWATER GridGraphMaxFlow
+    {
+    public:
+
+        typedef float cap_type;
+
+        /// Z == 1 for a 2D grid
+        GridGraphMaxFlow(size_t X, size_t Y, size_t Z = 1);
+
+        size_t num_nodes() const { return X_*Y_*Z_; }
+        unsigned int num_directions() const { return num_dir_; }
+
+        /// index of the node (x,y,z) in the grid without the border
+        size_t node(size_t x, size_t y, size_t z = 0) const { return x + X_*(y + Y_*z); }
+
+        /// remove all capacities
+        void reset();
+
+        /// cost of the node being in the source set and in the sink set, may be negative
+        void add_terminal_weights(size_t n, cap_type source_set_cost, cap_type sink_set_cost);
+
+        /// capacity of the edge from node n to its neighbour in direction d, and of the reverse edge
+        void add_edge(size_t n, unsigned int d, cap_type cap, cap_type rev_cap);
+
+        /**
+           Pairwise term of a binary energy, the label of a node in the source set is 0, 1 in the sink set.
+           E(0,0) + E(1,1) <= E(0,1) + E(1,0) is required.
+         */
+        void add_pairwise(size_t n, unsigned int d, cap_type E00, cap_type E01, cap_type E10, cap_type E11);
+
+        /// computes the maximal flow, the value of the flow is returned
+        double maxflow();
+
+        /// true if the node is in the sink set of the minimal cut
+        bool in_sink_set(size_t n) const { return tree_[padded(n)] == SINK_TREE; }
+
+    protected:
+
+        enum { FREE = 0, SOURCE_TREE = 1, SINK_TREE = 2 };
+
+        /// parent values besides the directions
+        static const int8_t TERMINAL = 6;
+        static const int8_t ORPHAN = 7;
+        static const int8_t NO_PARENT = 8;
+
+        size_t padded(size_t n) const
+        {
+            size_t x = n % X_;
+            size_t y = (n / X_) % Y_;
+            size_t z = n / (X_*Y_);
+            return (x + 1) + PX_*((y + 1) + PY_*(z + (Z_>1 ? 1 : 0)));
+        }
+
+        long long neighbour(size_t p, unsigned int d) const { return (long long)p + offset_[d]; }
+
+        /// residual capacity of the edge from the tree to the node, i.e. from parent to child in the source tree
+        cap_type tree_cap(size_t parent, size_t child, unsigned int d_child_to_parent) const
+        {
+            return (tree_[parent] == SOURCE_TREE) ? cap_[parent*num_dir_ + (d_child_to_parent ^ 1)] : cap_[child*num_dir_ + d_child_to_parent];
+        }
+
+        void set_active(size_t p);
+        void augment(size_t s, size_t t, unsigned int d);
+        void process_orphan(size_t p);
+
+        size_t X_, Y_, Z_;
+        size_t PX_, PY_, PZ_;
+        unsigned int num_dir_;
+        long long offset_[6];
+
+        /// per node: residual capacity to the neighbours, source minus sink capacity
+        std::vector<cap_type> cap_;
+        std::vector<cap_type> tr_cap_;
+
+        std::vector<uint8_t> tree_;
+        std::vector<int8_t> parent_;
+        std::vector<uint8_t> is_active_;
+        std::vector<uint8_t> is_node_;
+
+        /// timestamp and distance to the terminal
+        std::vector<unsigned int> ts_;
+        std::vector<unsigned int> dist_;
+        unsigned int time_;
+
+        std::deque<size_t> active_;
+        std::deque<size_t> orphans_;
+
+        double flow_;
+    };
+}
+
+#endif //GRIDGRAPHMAXFLOW_H
@@ -1,88 +1,133 @@
 #include "fatwater.h"
+#include "GridGraphMaxFlow.h"
 
 #include "hoMatrix.h"
 #include "hoNDArray_linalg.h"
 #include "hoNDArray_utils.h"
 #include "hoNDArray_elemwise.h"
-#include "hoNDArray_reductions.h"
-#include "hoArmadillo.h"
-
-#include <boost/config.hpp>
-#include <boost/graph/push_relabel_max_flow.hpp>
-#include <boost/graph/adjacency_list.hpp>
-#include <boost/graph/read_dimacs.hpp>
-#include <boost/graph/graph_utility.hpp>
-#include <boost/graph/boykov_kolmogorov_max_flow.hpp>
-#include <boost/graph/edmonds_karp_max_flow.hpp>
-#include <boost/timer/timer.hpp>
-
-// Curve fitting includes (from Hui's example)
-//#include "hoNDHarrWavelet.h"
-//#include "hoNDRedundantWavelet.h"
-#include "hoNDArray_math.h"
-#include "simplexLagariaSolver.h"
-#include "twoParaExpDecayOperator.h"
-#include "curveFittingCostFunction.h"
-#include <boost/random.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef USE_OMP
+    #include <omp.h>
+#endif // USE_OMP
 
 #define GAMMABAR 42.576 // MHz/T
 #define PI 3.141592
 
-using namespace boost;
- 
-typedef int EdgeWeightType;
- 
-typedef adjacency_list_traits < vecS, vecS, directedS > Traits;
-typedef adjacency_list < vecS, vecS, directedS,
-			 property < vertex_name_t, std::string,
-				    property < vertex_index_t, long,
-			 property < vertex_color_t, boost::default_color_type,
-			 property < vertex_distance_t, long,
-			 property < vertex_predecessor_t, Traits::edge_descriptor > > > > >,
-			 property < edge_capacity_t, EdgeWeightType,
-			 property < edge_residual_capacity_t, EdgeWeightType,
-			 property < edge_reverse_t, Traits::edge_descriptor > > > > Graph;
-
-/*
-Traits::edge_descriptor AddEdge(Traits::vertex_descriptor &v1,
-				Traits::vertex_descriptor &v2,
-				property_map < Graph, edge_reverse_t >::type &rev,
-				const double capacity,
-				Graph &g);
-*/
-
-void AddEdge(Traits::vertex_descriptor &v1, Traits::vertex_descriptor &v2, property_map < Graph, edge_reverse_t >::type &rev, const double capacity, Graph &g)
-{
-  Traits::edge_descriptor e1 = add_edge(v1, v2, g).first;
-  Traits::edge_descriptor e2 = add_edge(v2, v1, g).first;
-  put(edge_capacity, g, e1, capacity);
-  put(edge_capacity, g, e2, 0*capacity);
-  
-  rev[e1] = e2;
-  rev[e2] = e1;
-}
-
 namespace Gadgetron {
+
+    namespace {
+
+        typedef std::complex<double> ComplexD;
+
+        /// number of rows (pixels times contrasts) of the matrix product of a block
+        const size_t residual_block_rows = 1024;
+
+        /**
+           Orthonormal basis Q and pseudo inverse of the species matrix psi [nte, nspecies], by modified Gram-Schmidt.
+           A species not separable from the others at these echo times gets a zero column and zero amplitude.
+        */
+        void orthonormalize(const hoMatrix<ComplexD>& psi, hoMatrix<ComplexD>& Q, hoMatrix<ComplexD>& pinv)
+        {
+            size_t nte = psi.rows();
+            size_t nspecies = psi.cols();
+
+            Q = psi;
+            hoMatrix<ComplexD> R(nspecies, nspecies);
+            size_t k1, k2, k3;
+            for (k1 = 0; k1 < nspecies; k1++)
+                for (k2 = 0; k2 < nspecies; k2++)
+                    R(k1, k2) = 0;
+
+            double tol = 0;
+            for (k1 = 0; k1 < nte; k1++)
+                for (k2 = 0; k2 < nspecies; k2++)
+                    tol = std::max(tol, std::abs(psi(k1, k2)));
+            tol *= 1e-6;
+
+            for (k2 = 0; k2 < nspecies; k2++) {
+                for (k3 = 0; k3 < k2; k3++) {
+                    ComplexD r = 0;
+                    for (k1 = 0; k1 < nte; k1++) r += std::conj(Q(k1, k3))*Q(k1, k2);
+                    R(k3, k2) = r;
+                    for (k1 = 0; k1 < nte; k1++) Q(k1, k2) -= r*Q(k1, k3);
+                }
+
+                double norm = 0;
+                for (k1 = 0; k1 < nte; k1++) norm += std::norm(Q(k1, k2));
+                norm = std::sqrt(norm);
+
+                R(k2, k2) = (norm > tol) ? norm : 0;
+                for (k1 = 0; k1 < nte; k1++) Q(k1, k2) = (norm > tol) ? Q(k1, k2) / norm : ComplexD(0);
+            }
+
+            // pinv = R^-1 Q^H by back substitution
+            pinv.createMatrix(nspecies, nte);
+            for (k1 = 0; k1 < nte; k1++) {
+                for (k2 = nspecies; k2-- > 0; ) {
+                    if (R(k2, k2) == ComplexD(0)) {
+                        pinv(k2, k1) = 0;
+                        continue;
+                    }
+
+                    ComplexD v = std::conj(Q(k1, k2));
+                    for (k3 = k2 + 1; k3 < nspecies; k3++) v -= R(k2, k3)*pinv(k3, k1);
+                    pinv(k2, k1) = v / R(k2, k2);
+                }
+            }
+        }
+
+        /// a field map candidate of a voxel, with the residual and R2* index minimizing it
+        struct Candidate
+        {
+            uint16_t fm;
+            uint16_t r2star;
+            float residual;
+        };
+
+        bool is_local_minimum(const float* r, size_t F, size_t j)
+        {
+            bool lower = (j == 0) || (r[j] <= r[j - 1]);
+            bool upper = (j == F - 1) || (r[j] <= r[j + 1]);
+            return lower && upper;
+        }
+
+        /// next local minimum after f in the direction dir among the local minima c[0..M), sorted by field map; f if there is none
+        size_t next_local_minimum(const Candidate* c, size_t M, size_t f, int dir)
+        {
+            if (dir > 0) {
+                for (size_t m = 0; m < M; m++) {
+                    if (c[m].fm > f) return c[m].fm;
+                }
+            } else {
+                for (size_t m = M; m-- > 0; ) {
+                    if (c[m].fm < f) return c[m].fm;
+                }
+            }
+            return f;
+        }
+    }
+
     hoNDArray< std::complex<float> > fatwater_separation(hoNDArray< std::complex<float> >& data, FatWaterParameters p, FatWaterAlgorithm a)
     {
 
 	//Get some data parameters
 	//7D, fixed order [X, Y, Z, CHA, N, S, LOC]
-        uint16_t X = data.get_size(0);
-        uint16_t Y = data.get_size(1);
-        uint16_t Z = data.get_size(2);
-        uint16_t CHA = data.get_size(3);
-        uint16_t N = data.get_size(4);
-        uint16_t S = data.get_size(5);
-        uint16_t LOC = data.get_size(6);
-
-	GDEBUG("Size of my array: %d, %d, %d .\n", X,Y,Z);
+        size_t X = data.get_size(0);
+        size_t Y = data.get_size(1);
+        size_t Z = data.get_size(2);
+        size_t CHA = data.get_size(3);
+        size_t N = data.get_size(4);
+        size_t S = data.get_size(5);
+        size_t LOC = data.get_size(6);
 
-	hoNDArray< std::complex<float> > out(X,Y,Z,CHA,N,2,LOC); // S dimension gets replaced by water/fat stuff
+	GDEBUG("Size of my array: %zu, %zu, %zu .\n", X,Y,Z);
 
 	float fieldStrength = p.fieldStrengthT_;
         std::vector<float> echoTimes = p.echoTimes_;
-	bool precessionIsClockwise = p.precessionIsClockwise_;
         for (auto& te: echoTimes) {
           te = te*0.001; // Echo times in seconds rather than milliseconds
         }
@@ -91,366 +136,274 @@ namespace Gadgetron {
         for (auto& te: echoTimes) {
 	  GDEBUG("In toolbox - Echo time: %f seconds \n", te);
         }
-	GDEBUG("In toolbox - PrecessionIsClockwise: %d \n", precessionIsClockwise);
+	GDEBUG("In toolbox - PrecessionIsClockwise: %d \n", p.precessionIsClockwise_);
 
-	//Get or set some algorithm parameters
-	//Gadgetron::ChemicalSpecies w = a.species_[0];
-	//Gadgetron::ChemicalSpecies f = a.species_[1];
+	size_t nspecies = a.species_.size();
+	size_t nte = echoTimes.size();
+	GDEBUG("In toolbox - NTE: %zu \n", nte);
 
-	//	GDEBUG("In toolbox - Fat peaks: %f  \n", f.ampFreq_[0].first);
-	//	GDEBUG("In toolbox - Fat peaks 2: %f  \n", f.ampFreq_[0].second);
-
-	// Set some initial parameters so we can get going
-	// These will have to be specified in the XML file eventually
-	std::pair<float,float> range_r2star = std::make_pair(0.0,0.0);
-	uint16_t num_r2star = 1;
-	std::pair<float,float> range_fm = std::make_pair(-80.0,80.0);
-	uint16_t num_fm = 101;
-	uint16_t num_iterations = 40;
-	uint16_t subsample = 1;
-	float lmap_power = 2.0;
-	float lambda = 0.02;
-	float lambda_extra = 0.02;
-
-	//Check that we have reasonable data for fat-water separation
+	if (nte != S) {
+	  GADGET_THROW("fatwater_separation, the number of echo times is not the size of the S dimension");
+	}
+	if (nspecies == 0 || a.num_fm_ == 0 || a.num_r2star_ == 0) {
+	  GADGET_THROW("fatwater_separation, no species or no field map / R2* candidates");
+	}
 
+	hoNDArray< std::complex<float> > out(X,Y,Z,CHA,N,nspecies,LOC); // S dimension gets replaced by water/fat stuff
+	Gadgetron::clear(out);
 
-	//Calculate residual
-	//
+	//Signal model of the species
 	float relAmp, freq_hz;
-	uint16_t npeaks;
-	uint16_t nspecies = a.species_.size();
-	uint16_t nte = echoTimes.size();
-	GDEBUG("In toolbox - NTE: %d \n", nte);
-
-	hoMatrix< std::complex<float> > phiMatrix(nte,nspecies);
-	for( int k1=0;k1<nte;k1++) {
-	  for( int k2=0;k2<nspecies;k2++) {
+	hoMatrix<ComplexD> phiMatrix(nte,nspecies);
+	size_t k1, k2, k3;
+	for( k1=0;k1<nte;k1++) {
+	  for( k2=0;k2<nspecies;k2++) {
 	    phiMatrix(k1,k2) = 0.0;
-	    npeaks = a.species_[k2].ampFreq_.size();
-	    for( int k3=0;k3<npeaks;k3++) {
+	    for( k3=0;k3<a.species_[k2].ampFreq_.size();k3++) {
 	      relAmp = a.species_[k2].ampFreq_[k3].first;
 	      freq_hz = fieldStrength*GAMMABAR*a.species_[k2].ampFreq_[k3].second;
-	      phiMatrix(k1,k2) += relAmp*std::complex<float>(cos(2*PI*echoTimes[k1]*freq_hz),sin(2*PI*echoTimes[k1]*freq_hz));
+	      phiMatrix(k1,k2) += (double)relAmp*ComplexD(cos(2*PI*echoTimes[k1]*freq_hz),sin(2*PI*echoTimes[k1]*freq_hz));
 	    }
-	    GDEBUG("Cur value phiMatrix = (%f,%f) \n", phiMatrix(k1,k2).real(), phiMatrix(k1,k2).imag());
-	  }
-	}
-	//auto a_phiMatrix = as_arma_matrix(&phiMatrix);
-	//auto mymat2 = mymat.t()*mymat;
-
-	for(int ka=0;ka<phiMatrix.get_size(0);ka++) {
-	  for(int kb=0;kb<phiMatrix.get_size(1);kb++) {
-	    GDEBUG("Check phiMatrix(%d,%d) = %f + i %f \n", ka,kb,phiMatrix(ka,kb).real(),phiMatrix(ka,kb).imag());
 	  }
 	}
 
-
-
-
-	hoMatrix< std::complex<float> > IdentMat(nte,nte);
-	for( int k1=0;k1<nte;k1++) {
-	  for( int k2=0;k2<nte;k2++) {
-	    if( k1==k2 ) {
-	      IdentMat(k1,k2) = std::complex<float>(1.0,0.0);
-	    } else {
-	      IdentMat(k1,k2) = std::complex<float>(0.0,0.0);
-	    }
-	  }
-	}
-	//	auto a_phiMatrix = as_arma_matrix(&IdentMat);
-
-	float fm;
+	size_t num_fm = a.num_fm_;
 	std::vector<float> fms(num_fm);
-	fms[0] = range_fm.first;
-	for(int k1=1;k1<num_fm;k1++) {
-	  fms[k1] = range_fm.first + k1*(range_fm.second-range_fm.first)/(num_fm-1);
+	for( k1=0;k1<num_fm;k1++) {
+	  fms[k1] = (num_fm > 1) ? a.range_fm_.first + k1*(a.range_fm_.second-a.range_fm_.first)/(num_fm-1) : a.range_fm_.first;
 	}
 
-	float r2star;
-    std::vector<float> r2stars(num_r2star);
-	r2stars[0] = range_r2star.first;
-	for(int k2=1;k2<num_r2star;k2++) {
-	  r2stars[k2] = range_r2star.first + k2*(range_r2star.second-range_r2star.first)/(num_r2star-1);
+	size_t num_r2star = a.num_r2star_;
+	std::vector<float> r2stars(num_r2star);
+	for( k2=0;k2<num_r2star;k2++) {
+	  r2stars[k2] = (num_r2star > 1) ? a.range_r2star_.first + k2*(a.range_r2star_.second-a.range_r2star_.first)/(num_r2star-1) : a.range_r2star_.first;
 	}
 
-
-	std::complex<float> curModulation;
-	hoMatrix< std::complex<float> > tempM1(nspecies,nspecies);
-	hoMatrix< std::complex<float> > tempM2(nspecies,nte);
-	hoMatrix< std::complex<float> > psiMatrix(nte,nspecies);
-	hoNDArray< std::complex<float> > Ps(nte,nte,num_fm,num_r2star);
-	hoMatrix< std::complex<float> > P1(nte,nte);
-	hoMatrix< std::complex<float> > P(nte,nte);
-
-	for(int k3=0;k3<num_fm;k3++) {
-	  fm = fms[k3];
-	  for(int k4=0;k4<num_r2star;k4++) {
-	    r2star = r2stars[k4];
-
-
-	    for( int k1=0;k1<nte;k1++) {
-	      curModulation = exp(-r2star*echoTimes[k1])*std::complex<float>(cos(2*PI*echoTimes[k1]*fm),sin(2*PI*echoTimes[k1]*fm));
-	      for( int k2=0;k2<nspecies;k2++) {
-		psiMatrix(k1,k2) = phiMatrix(k1,k2)*curModulation;
+	//For every candidate k = fm*num_r2star + r2star: the conjugated orthonormal basis of its species matrix,
+	//the residual of a signal s is |s|^2 - |Q^H s|^2, and the pseudo inverse for the final amplitudes
+	size_t K = num_fm*num_r2star;
+	hoNDArray< std::complex<float> > Qc(nte, K*nspecies);
+	hoNDArray< std::complex<float> > pinvs(nspecies, nte, K);
+
+	hoMatrix<ComplexD> psiMatrix(nte,nspecies), Q, pinv;
+	for( k1=0;k1<num_fm;k1++) {
+	  for( k2=0;k2<num_r2star;k2++) {
+	    size_t k = k1*num_r2star + k2;
+
+	    for( k3=0;k3<nte;k3++) {
+	      ComplexD curModulation = exp(-(double)r2stars[k2]*echoTimes[k3])*ComplexD(cos(2*PI*echoTimes[k3]*fms[k1]),sin(2*PI*echoTimes[k3]*fms[k1]));
+	      for( size_t sp=0;sp<nspecies;sp++) {
+		psiMatrix(k3,sp) = phiMatrix(k3,sp)*curModulation;
 	      }
 	    }
 
-	    herk( tempM1, psiMatrix, 'L', true );
-	    //	    tempM1.copyLowerTriToUpper();
-	    for (int ka=0;ka<tempM1.get_size(0);ka++ ) {
-	      for (int kb=ka+1;kb<tempM1.get_size(1);kb++ ) {
-		tempM1(ka,kb) = conj(tempM1(kb,ka));
-	      }
-	    }
+	    orthonormalize(psiMatrix, Q, pinv);
 
-	    if(k3==50) {
-	      for(int ka=0;ka<tempM1.get_size(0);ka++) {
-		for(int kb=0;kb<tempM1.get_size(1);kb++) {
-		  GDEBUG(" tempM1(%d,%d) = %f + i %f \n", ka,kb,tempM1(ka,kb).real(),tempM1(ka,kb).imag());
-		}
+	    for( size_t sp=0;sp<nspecies;sp++) {
+	      for( k3=0;k3<nte;k3++) {
+		Qc(k3, k*nspecies+sp) = std::complex<float>(std::conj(Q(k3,sp)));
+		pinvs(sp, k3, k) = std::complex<float>(pinv(sp,k3));
 	      }
 	    }
+	  }
+	}
 
+	size_t V = X*Y*Z;
+	size_t stride_n = V*CHA;
+	size_t stride_s = V*CHA*N;
 
-	    potri(tempM1);
-	    for (int ka=0;ka<tempM1.get_size(0);ka++ ) {
-	      for (int kb=ka+1;kb<tempM1.get_size(1);kb++ ) {
-		tempM1(ka,kb) = conj(tempM1(kb,ka));
-	      }
-	    }
+	// voxels per block of the matrix product
+	size_t block = std::max((size_t)1, residual_block_rows / N);
+	long long num_blocks = (long long)((V + block - 1) / block);
 
-	    if(k3==50) {
-	      for(int ka=0;ka<tempM1.get_size(0);ka++) {
-		for(int kb=0;kb<tempM1.get_size(1);kb++) {
-		  GDEBUG(" inv tempM1(%d,%d) = %f + i %f \n", ka,kb,tempM1(ka,kb).real(),tempM1(ka,kb).imag());
-		}
+	//The graph cut starts from the candidate closest to 0 Hz and only moves to local minima of the residual curve of a voxel,
+	//so the residuals of the other field maps are not kept: a voxel stores its start candidate and its local minima.
+	//The minima of a block of voxels are stored together, starting at minimaStart of the voxel.
+	size_t f0 = 0;
+	for (k1 = 1; k1 < num_fm; k1++) {
+	  if (std::abs(fms[k1]) < std::abs(fms[f0])) f0 = k1;
+	}
+
+	std::vector< std::vector<Candidate> > minima(num_blocks);
+	std::vector<uint32_t> minimaStart(V);
+	std::vector<uint16_t> numMinima(V);
+	std::vector<Candidate> start(V);
+	std::vector<float> blockMax(num_blocks);
+
+	std::vector<uint16_t> fmIndex(V), proposal(V);
+	std::vector<float> lmap(V);
+
+	// residual and R2* index of the field map f of voxel n, f is the start candidate or one of its local minima
+	auto candidate = [&](size_t n, size_t f) -> const Candidate& {
+	  if (f == f0) return start[n];
+	  const Candidate* c = &minima[n / block][minimaStart[n]];
+	  size_t m = 0;
+	  while (c[m].fm != f) m++;
+	  return c[m];
+	};
+
+	for (size_t loc = 0; loc < LOC; loc++) {
+
+	  const std::complex<float>* pData = data.begin() + loc*stride_s*S;
+
+	  //Residual of all candidates, the minimum over R2* for every field map
+	  long long b;
+#pragma omp parallel for private(b)
+	  for (b = 0; b < num_blocks; b++) {
+	    size_t v0 = b*block;
+	    size_t B = std::min(block, V - v0);
+	    size_t rows = B*N;
+
+	    hoNDArray< std::complex<float> > D(rows, nte), C(rows, K*nspecies);
+	    std::vector<float> signal(B, 0.0f), projection(B*K, 0.0f);
+	    std::vector<float> r(num_fm);
+	    std::vector<uint16_t> ri(num_fm);
+
+	    size_t n, t, v, k, sp;
+	    for (t = 0; t < nte; t++) {
+	      for (n = 0; n < N; n++) {
+		const std::complex<float>* src = pData + v0 + n*stride_n + t*stride_s;
+		memcpy(D.begin() + t*rows + n*B, src, sizeof(std::complex<float>)*B);
+		for (v = 0; v < B; v++) signal[v] += std::norm(src[v]);
 	      }
 	    }
 
+	    Gadgetron::gemm(C, D, Qc);
 
-	    //GDEBUG(" (%d,%d) = (%d,%d) X (%d,%d) \n", tempM2.get_size(0),tempM2.get_size(1),tempM1.get_size(0),tempM1.get_size(1),psiMatrix.get_size(1),psiMatrix.get_size(0));
-	    gemm( tempM2, tempM1, false, psiMatrix, true );
-
-	    if(k3==50) {
-	      for(int ka=0;ka<tempM2.get_size(0);ka++) {
-		for(int kb=0;kb<tempM2.get_size(1);kb++) {
-		  GDEBUG(" tempM2(%d,%d) = %f + i %f \n", ka,kb,tempM2(ka,kb).real(),tempM2(ka,kb).imag());
+	    for (k = 0; k < K; k++) {
+	      float* proj = &projection[k*B];
+	      for (sp = 0; sp < nspecies; sp++) {
+		const std::complex<float>* pC = C.begin() + (k*nspecies + sp)*rows;
+		for (n = 0; n < N; n++) {
+		  for (v = 0; v < B; v++) proj[v] += std::norm(pC[n*B + v]);
 		}
 	      }
 	    }
 
-	    //GDEBUG(" (%d,%d) = (%d,%d) X (%d,%d) \n", P1.get_size(0),P1.get_size(1),psiMatrix.get_size(0),psiMatrix.get_size(1),tempM2.get_size(0),tempM2.get_size(1));
-	    gemm( P1, psiMatrix, false, tempM2, false );
-
-	    if(k3==50) {
-	      for(int ka=0;ka<P1.get_size(0);ka++) {
-		for(int kb=0;kb<P1.get_size(1);kb++) {
-		  GDEBUG(" P1(%d,%d) = %f + i %f \n", ka,kb,P1(ka,kb).real(),P1(ka,kb).imag());
+	    std::vector<Candidate>& blockMinima = minima[b];
+	    blockMinima.clear();
+	    blockMax[b] = 0;
+
+	    for (v = 0; v < B; v++) {
+	      for (size_t f = 0; f < num_fm; f++) {
+		float minResidual = 0;
+		uint16_t minIndex = 0;
+		for (size_t r2 = 0; r2 < num_r2star; r2++) {
+		  float curResidual = std::sqrt(std::max(signal[v] - projection[(f*num_r2star + r2)*B + v], 0.0f));
+		  if (r2 == 0 || curResidual < minResidual) {
+		    minResidual = curResidual;
+		    minIndex = (uint16_t)r2;
+		  }
 		}
+		r[f] = minResidual;
+		ri[f] = minIndex;
 	      }
-	    }
-
 
-	    subtract(IdentMat,P1,P);
+	      size_t vox = v0 + v;
+	      start[vox].fm = (uint16_t)f0;
+	      start[vox].r2star = ri[f0];
+	      start[vox].residual = r[f0];
 
-	    if(k3==50) {
-	      for(int ka=0;ka<P.get_size(0);ka++) {
-		for(int kb=0;kb<P.get_size(1);kb++) {
-		  GDEBUG(" P(%d,%d) = %f + i %f \n", ka,kb,P(ka,kb).real(),P(ka,kb).imag());
+	      minimaStart[vox] = (uint32_t)blockMinima.size();
+	      for (size_t f = 0; f < num_fm; f++) {
+		if (is_local_minimum(&r[0], num_fm, f)) {
+		  Candidate c = { (uint16_t)f, ri[f], r[f] };
+		  blockMinima.push_back(c);
 		}
 	      }
+	      numMinima[vox] = (uint16_t)(blockMinima.size() - minimaStart[vox]);
 
+	      // the range of the residual curve, the smoothness weight once the largest residual is known
+	      float rmin = *std::min_element(r.begin(), r.end());
+	      float rmaxv = *std::max_element(r.begin(), r.end());
+	      lmap[vox] = rmaxv - rmin;
+	      blockMax[b] = std::max(blockMax[b], rmaxv);
 	    }
+	  }
 
+	  //Field map by graph cuts, starting from the candidate closest to 0 Hz
+	  std::fill(fmIndex.begin(), fmIndex.end(), (uint16_t)f0);
 
+	  float rmax = *std::max_element(blockMax.begin(), blockMax.end());
+	  float scale = (rmax > 0) ? 1.0f / rmax : 1.0f;
 
-
-
-	    // Keep all projector matrices together
-	    for( int k1=0;k1<nte;k1++) {
-	      for( int k2=0;k2<nte;k2++) {
-		Ps(k1,k2,k3,k4) = P(k1,k2);
-	      }
-	    }
+	  //The smoothness is weighted by how well the residual curve determines the field map
+	  long long v;
+#pragma omp parallel for private(v)
+	  for (v = 0; v < (long long)V; v++) {
+	    lmap[v] = std::pow(lmap[v]*scale, a.lmap_power_);
 	  }
-	}
 
+	  GridGraphMaxFlow graph(X, Y, Z);
+	  unsigned int num_dir = graph.num_directions();
+	  size_t unchanged = 0;
 
-	// Need to check that S = nte
-	// N should be the number of contrasts (eg: for PSIR)
-	hoMatrix< std::complex<float> > tempResVector(S,N);
-	hoMatrix< std::complex<float> > tempSignal(S,N);
-	hoNDArray<float> residual(num_fm,X,Y);
-	hoNDArray<uint16_t> r2starIndex(X,Y,num_fm);
-	hoNDArray<uint16_t> fmIndex(X,Y);
-	float curResidual, minResidual, minResidual2;
-	for( int k1=0;k1<X;k1++) {
-	  for( int k2=0;k2<Y;k2++) {
-	    // Get current signal
-	    for( int k4=0;k4<N;k4++) {
-	      for( int k5=0;k5<S;k5++) {
-		tempSignal(k5,k4) = data(k1,k2,0,0,k4,k5,0);
-		if (k1==107 && k2==144) {
-		  tempSignal(k5,k4) = std::complex<float>(1000.0,0.0);;
-		  GDEBUG(" (%d,%d) -->  %f + i %f \n",k5,k4, tempSignal(k5,k4).real(),tempSignal(k5,k4).imag());
-		}
+	  for (size_t it = 0; it < a.num_iterations_ && unchanged < 2; it++) {
+	    int dir = (it % 2 == 0) ? 1 : -1;
 
-	      }
+	    size_t num_moves = 0;
+	    for (size_t n = 0; n < V; n++) {
+	      proposal[n] = (uint16_t)next_local_minimum(&minima[n / block][minimaStart[n]], numMinima[n], fmIndex[n], dir);
+	      if (proposal[n] != fmIndex[n]) num_moves++;
 	    }
 
-	    minResidual2 = 1.0 + nrm2(&tempSignal);
-
-	    for(int k3=0;k3<num_fm;k3++) {
-
-	      minResidual = 1.0 + nrm2(&tempSignal);
+	    if (num_moves == 0) {
+	      unchanged++;
+	      continue;
+	    }
 
-	      for(int k4=0;k4<num_r2star;k4++) {
-		// Get current projector matrix
-		for( int k5=0;k5<nte;k5++) {
-		  for( int k6=0;k6<nte;k6++) {
-		    P(k5,k6) = Ps(k5,k6,k3,k4);
+	    graph.reset();
+	    for (size_t z = 0; z < Z; z++) {
+	      for (size_t y = 0; y < Y; y++) {
+		for (size_t x = 0; x < X; x++) {
+		  size_t n = graph.node(x, y, z);
+		  graph.add_terminal_weights(n, candidate(n, fmIndex[n]).residual*scale, candidate(n, proposal[n]).residual*scale);
+
+		  // all moves are in the same direction, so the pairwise terms are submodular
+		  size_t nb[3] = { (x + 1 < X) ? n + 1 : V, (y + 1 < Y) ? n + X : V, (z + 1 < Z) ? n + X*Y : V };
+		  for (unsigned int d = 0; 2*d < num_dir; d++) {
+		    size_t m = nb[d];
+		    if (m == V) continue;
+
+		    float w = a.lambda_*std::min(lmap[n], lmap[m]);
+		    float fi0 = fmIndex[n], fi1 = proposal[n], fj0 = fmIndex[m], fj1 = proposal[m];
+		    graph.add_pairwise(n, 2*d, w*(fi0-fj0)*(fi0-fj0), w*(fi0-fj1)*(fi0-fj1), w*(fi1-fj0)*(fi1-fj0), w*(fi1-fj1)*(fi1-fj1));
 		  }
 		}
-
-		// Apply projector
-		gemm( tempResVector, P, false, tempSignal, false );
-
-		curResidual = nrm2(&tempResVector);
-
-		if (curResidual < minResidual) {
-		  minResidual = curResidual;
-		  r2starIndex(k1,k2,k3) = k4;
-		}
-	      }
-	      residual(k3,k1,k2) = minResidual;
-
-	      if (minResidual < minResidual2) {
-		minResidual2 = minResidual;
-		fmIndex(k1,k2) = k3;
-	      }
-
-	      if (k1==107 && k2==144) {
-		GDEBUG(" %f -->  %f \n",fms[k3],minResidual);
 	      }
 	    }
-	  }
-	}
-
-
-
-	//arma::Mat< std::complex<float> > arma_phiMatrix = as_arma_matrix( phiMatrix );
-
-
-	//Do graph cut iterations
-	using namespace boost;
-
-	// create a typedef for the Graph type
-	typedef adjacency_list<vecS, vecS, bidirectionalS> Graph;
 
-	// Make convenient labels for the vertices
-	enum { A, B, C, D, E };
-	const int num_vertices = 5;
-	const char* name = "ABCDE";
+	    graph.maxflow();
 
-	// writing out the edges in the graph
-	typedef std::pair<int, int> Edge;
-	Edge edge_array[] =
-	  { Edge(A,B), Edge(A,D), Edge(C,A), Edge(D,C),
-	    Edge(C,E), Edge(B,D), Edge(D,E) };
-	const int num_edges = sizeof(edge_array)/sizeof(edge_array[0]);
-
-	// declare a graph object
-	Graph g(edge_array, edge_array + sizeof(edge_array) / sizeof(Edge), num_vertices);
-
-
-	/*
-	property_map<Graph, edge_capacity_t>::type
-	  capacity = get(edge_capacity, g);
-	property_map<Graph, edge_reverse_t>::type
-	  rev = get(edge_reverse, g);
-	property_map<Graph, edge_residual_capacity_t>::type
-	  residual_capacity = get(edge_residual_capacity, g);
-
-	Traits::vertex_descriptor s, t;
-	read_dimacs_max_flow(g, capacity, rev, s, t);
-
-	long flow;
-#if defined(BOOST_MSVC) && BOOST_MSVC <= 1300
-	// Use non-named parameter version
-	property_map<Graph, vertex_index_t>::type
-	  indexmap = get(vertex_index, g);
-	flow = push_relabel_max_flow(g, s, t, capacity, residual_capacity, rev, indexmap);
-#else
-	flow = push_relabel_max_flow(g, s, t);
-#endif
-
-	std::cout << "c  The total flow:" << std::endl;
-	std::cout << "s " << flow << std::endl << std::endl;
-
-	std::cout << "c flow values:" << std::endl;
-	graph_traits<Graph>::vertex_iterator u_iter, u_end;
-	graph_traits<Graph>::out_edge_iterator ei, e_end;
-	for (boost::tie(u_iter, u_end) = vertices(g); u_iter != u_end; ++u_iter)
-	  for (boost::tie(ei, e_end) = out_edges(*u_iter, g); ei != e_end; ++ei)
-	    if (capacity[*ei] > 0)
-	      std::cout << "f " << *u_iter << " " << target(*ei, g) << " "
-			<< (capacity[*ei] - residual_capacity[*ei]) << std::endl;
-
-	*/
-
-
-
-
-
-	//Do final calculations once the field map is done
-	hoMatrix< std::complex<float> > curWaterFat(2,N);
-	hoMatrix< std::complex<float> > AhA(2,2);
-	// Do fat-water separation with current field map and R2* estimates
-	for( int k1=0;k1<X;k1++) {
-	  for( int k2=0;k2<Y;k2++) {
-
-	    // Get current signal
-	    for( int k4=0;k4<N;k4++) {
-	      for( int k5=0;k5<S;k5++) {
-		tempSignal(k5,k4) = data(k1,k2,0,0,k4,k5,0);
-	      }
-	    }
-	    // Get current Psi matrix
-	    fm = fms[fmIndex(k1,k2)];
-	    r2star = r2stars[r2starIndex(k1,k2,fmIndex(k1,k2))];
-	    for( int k3=0;k3<nte;k3++) {
-	      curModulation = exp(-r2star*echoTimes[k3])*std::complex<float>(cos(2*PI*echoTimes[k3]*fm),sin(2*PI*echoTimes[k3]*fm));
-	      for( int k4=0;k4<nspecies;k4++) {
-		psiMatrix(k3,k4) = phiMatrix(k3,k4)*curModulation;
+	    num_moves = 0;
+	    for (size_t n = 0; n < V; n++) {
+	      if (graph.in_sink_set(n) && proposal[n] != fmIndex[n]) {
+		fmIndex[n] = proposal[n];
+		num_moves++;
 	      }
 	    }
+	    unchanged = (num_moves == 0) ? unchanged + 1 : 0;
 
-	    // Solve for water and fat
-	    gemm( curWaterFat, psiMatrix, true, tempSignal, false );
-	    herk( AhA, psiMatrix, 'L', true );
-	    //	    AhA.copyLowerTriToUpper();
-	    for (int ka=0;ka<AhA.get_size(0);ka++ ) {
-	      for (int kb=ka+1;kb<AhA.get_size(1);kb++ ) {
-		AhA(ka,kb) = conj(AhA(kb,ka));
-	      }
-	    }
+	    GDEBUG("In toolbox - graph cut iteration %zu, %zu voxels moved \n", it, num_moves);
+	  }
 
-	    hesv(AhA,curWaterFat);
-	    for ( int k4=0;k4<N;k4++ ) {
-	      for ( int k5=0;k5<2;k5++ ) { // 2 elements for water and fat currently
-		out(k1,k2,0,0,k4,k5,0) = curWaterFat(k5,k4);
+	  //Do fat-water separation with current field map and R2* estimates
+	  std::complex<float>* pOut = out.begin() + loc*stride_n*N*nspecies;
+#pragma omp parallel for private(v)
+	  for (v = 0; v < (long long)V; v++) {
+	    size_t f = fmIndex[v];
+	    const std::complex<float>* pinv = &pinvs(0, 0, f*num_r2star + candidate(v, f).r2star);
+
+	    for (size_t n = 0; n < N; n++) {
+	      for (size_t sp = 0; sp < nspecies; sp++) {
+		std::complex<float> w(0);
+		for (size_t t = 0; t < nte; t++) w += pinv[sp + t*nspecies]*pData[v + n*stride_n + t*stride_s];
+		pOut[v + n*stride_n + sp*stride_n*N] = w;
 	      }
 	    }
-
 	  }
 	}
 
-
-
-	//Clean up as needed
-
-
         return out;
     }
 }
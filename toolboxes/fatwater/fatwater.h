@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <utility>
+#include <string>
+#include <cstdint>
 
 #include "fatwater_export.h"
 #include "hoNDArray.h"
@@ -38,13 +40,39 @@ namespace Gadgetron
     
     struct FatWaterAlgorithm
     {
+        FatWaterAlgorithm()
+        : range_fm_(-80.0f, 80.0f)
+        , num_fm_(101)
+        , range_r2star_(0.0f, 0.0f)
+        , num_r2star_(1)
+        , num_iterations_(40)
+        , lambda_(0.02f)
+        , lmap_power_(2.0f)
+        {}
+
         std::vector<ChemicalSpecies> species_;
+
+        /// field map (Hz) and R2* (1/s) candidates of the residual search
+        std::pair<float,float> range_fm_;
+        uint16_t num_fm_;
+        std::pair<float,float> range_r2star_;
+        uint16_t num_r2star_;
+
+        /// graph cut iterations, weight of the field map smoothness and power of the regularization map
+        uint16_t num_iterations_;
+        float lambda_;
+        float lmap_power_;
     };
 
     /**
        Main interface for water fat separation.
 
-       data array is assumed to be a 7D array [X, Y, Z, CHA, N, S, LOC]
+       data array is assumed to be a 7D array [X, Y, Z, CHA, N, S, LOC], the output is [X, Y, Z, CHA, N, species, LOC]
+
+       The residual of every field map and R2* candidate is computed for all pixels with one matrix product per
+       block of pixels, in parallel. The field map is the minimum of the residual plus a smoothness term over the
+       4 (Z==1) or 6 neighbours, found by graph cuts of local minimum moves (Hernando et al., MRM 63:79-90, 2010).
+       Only the first channel is separated.
 
      */
     EXPORTFATWATER hoNDArray< std::complex<float> > fatwater_separation(hoNDArray< std::complex<float> >& data, FatWaterParameters p, FatWaterAlgorithm a);
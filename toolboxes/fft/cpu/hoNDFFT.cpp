@@ -761,6 +761,8 @@ inline void hoNDFFT<T>::ifft1(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::fft1c(hoNDArray< ComplexType >& a)
 {
+	if (fftc(a, a, 1, true)) return;
+
 	ifftshift1D(a);
 	fft1(a);
 	fftshift1D(a);
@@ -769,6 +771,8 @@ inline void hoNDFFT<T>::fft1c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::ifft1c(hoNDArray< ComplexType >& a)
 {
+	if (fftc(a, a, 1, false)) return;
+
 	ifftshift1D(a);
 	ifft1(a);
 	fftshift1D(a);
@@ -777,6 +781,8 @@ inline void hoNDFFT<T>::ifft1c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::fft1c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if (fftc(a, r, 1, true)) return;
+
 	ifftshift1D(a, r);
 	fft1(r);
 	fftshift1D(r);
@@ -786,6 +792,8 @@ inline void hoNDFFT<T>::fft1c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft1c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if (fftc(a, r, 1, false)) return;
+
 	ifftshift1D(a, r);
 	ifft1(r);
 	fftshift1D(r);
@@ -794,6 +802,8 @@ inline void hoNDFFT<T>::ifft1c(const hoNDArray< ComplexType >& a, hoNDArray< Com
 template<typename T>
 inline void hoNDFFT<T>::fft1c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if (fftc(a, r, 1, true)) return;
+
 	ifftshift1D(a, r);
 	fft1(r, buf);
 	fftshift1D(buf, r);
@@ -802,6 +812,8 @@ inline void hoNDFFT<T>::fft1c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft1c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if (fftc(a, r, 1, false)) return;
+
 	ifftshift1D(a, r);
 	ifft1(r, buf);
 	fftshift1D(buf, r);
@@ -851,6 +863,8 @@ inline void hoNDFFT<T>::ifft2(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::fft2c(hoNDArray< ComplexType >& a)
 {
+	if (fftc(a, a, 2, true)) return;
+
 	ifftshift2D(a);
 	fft2(a);
 	fftshift2D(a);
@@ -860,6 +874,8 @@ inline void hoNDFFT<T>::fft2c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::ifft2c(hoNDArray< ComplexType >& a)
 {
+	if (fftc(a, a, 2, false)) return;
+
 	ifftshift2D(a);
 	ifft2(a);
 	fftshift2D(a);
@@ -868,6 +884,8 @@ inline void hoNDFFT<T>::ifft2c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::fft2c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if (fftc(a, r, 2, true)) return;
+
 	ifftshift2D(a, r);
 	fft2(r);
 	fftshift2D(r);
@@ -876,6 +894,8 @@ inline void hoNDFFT<T>::fft2c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft2c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if (fftc(a, r, 2, false)) return;
+
 	ifftshift2D(a, r);
 	ifft2(r);
 	fftshift2D(r);
@@ -884,6 +904,8 @@ inline void hoNDFFT<T>::ifft2c(const hoNDArray< ComplexType >& a, hoNDArray< Com
 template<typename T>
 inline void hoNDFFT<T>::fft2c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if (fftc(a, r, 2, true)) return;
+
 	ifftshift2D(a, r);
 	fft2(r, buf);
 	fftshift2D(buf, r);
@@ -892,6 +914,8 @@ inline void hoNDFFT<T>::fft2c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft2c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if (fftc(a, r, 2, false)) return;
+
 	ifftshift2D(a, r);
 	ifft2(r, buf);
 	fftshift2D(buf, r);
@@ -940,6 +964,8 @@ inline void hoNDFFT<T>::ifft3(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::fft3c(hoNDArray< ComplexType >& a)
 {
+	if (fftc(a, a, 3, true)) return;
+
 	ifftshift3D(a);
 	fft3(a);
 	fftshift3D(a);
@@ -948,6 +974,8 @@ inline void hoNDFFT<T>::fft3c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::ifft3c(hoNDArray< ComplexType >& a)
 {
+	if (fftc(a, a, 3, false)) return;
+
 	ifftshift3D(a);
 	ifft3(a);
 	fftshift3D(a);
@@ -956,6 +984,8 @@ inline void hoNDFFT<T>::ifft3c(hoNDArray< ComplexType >& a)
 template<typename T>
 inline void hoNDFFT<T>::fft3c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if (fftc(a, r, 3, true)) return;
+
 	ifftshift3D(a, r);
 	fft3(r);
 	fftshift3D(r);
@@ -964,6 +994,8 @@ inline void hoNDFFT<T>::fft3c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft3c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r)
 {
+	if (fftc(a, r, 3, false)) return;
+
 	ifftshift3D(a, r);
 	ifft3(r);
 	fftshift3D(r);
@@ -972,6 +1004,8 @@ inline void hoNDFFT<T>::ifft3c(const hoNDArray< ComplexType >& a, hoNDArray< Com
 template<typename T>
 inline void hoNDFFT<T>::fft3c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if (fftc(a, r, 3, true)) return;
+
 	ifftshift3D(a, r);
 	fft3(r, buf);
 	fftshift3D(buf, r);
@@ -980,6 +1014,8 @@ inline void hoNDFFT<T>::fft3c(const hoNDArray< ComplexType >& a, hoNDArray< Comp
 template<typename T>
 inline void hoNDFFT<T>::ifft3c(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, hoNDArray< ComplexType >& buf)
 {
+	if (fftc(a, r, 3, false)) return;
+
 	ifftshift3D(a, r);
 	ifft3(r, buf);
 	fftshift3D(buf, r);
@@ -1198,6 +1234,90 @@ void hoNDFFT<T>::fft3(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r,
 	r *= fftRatio;
 
 }
+template<typename T>
+void hoNDFFT<T>::checkerboard(const ComplexType* a, ComplexType* r, size_t n0, size_t n1, size_t n2, T scale)
+{
+	size_t x, y, z;
+	for ( z=0; z<n2; z++ )
+	{
+		for ( y=0; y<n1; y++ )
+		{
+			T s = ((y+z)%2==0) ? scale : -scale;
+			const ComplexType* pa = a + (y+z*n1)*n0;
+			ComplexType* pr = r + (y+z*n1)*n0;
+
+			for ( x=0; x<n0; x+=2 )
+			{
+				pr[x] = s*pa[x];
+				pr[x+1] = -s*pa[x+1];
+			}
+		}
+	}
+}
+
+template<typename T>
+bool hoNDFFT<T>::fftc(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, size_t rank, bool forward)
+{
+	if ( a.get_number_of_dimensions() < rank ) return false;
+
+	size_t d;
+	size_t n[3] = {1, 1, 1};
+	size_t N = 1, sum_half = 0;
+	for ( d=0; d<rank; d++ )
+	{
+		n[d] = a.get_size(d);
+		if ( n[d]%2 != 0 ) return false;
+		N *= n[d];
+		sum_half += n[d]/2;
+	}
+
+	if ( !r.dimensions_equal(&a) )
+	{
+		r.create(a.get_dimensions());
+	}
+
+	long long num = (long long)(a.get_number_of_elements()/N);
+
+	int num_thr = 1;
+	if ( rank == 1 ) num_thr = get_num_threads_fft1(n[0], num);
+	if ( rank == 2 ) num_thr = get_num_threads_fft2(n[1], n[0], num);
+	if ( rank == 3 ) num_thr = get_num_threads_fft3(n[2], n[1], n[0], num);
+
+	// the fftw dimensions are in row major order
+	int fftw_n[3];
+	for ( d=0; d<rank; d++ ) fftw_n[d] = (int)n[rank-1-d];
+
+	typename fftw_types<T>::plan * p;
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		p = fftw_plan_many_dft_((int)rank, fftw_n, 1,
+				r.begin(), NULL, 1, (int)N,
+				r.begin(), NULL, 1, (int)N,
+				forward ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+	}
+
+	T fftRatio = T(1.0/std::sqrt( T(N) ));
+	T post = (sum_half%2==0) ? fftRatio : -fftRatio;
+
+	// one transform at a time, the modulations run on the data in cache
+	long long k;
+#pragma omp parallel for private(k) if (num_thr > 1) num_threads(num_thr)
+	for ( k=0; k<num; k++ )
+	{
+		ComplexType* pr = r.begin() + k*N;
+		checkerboard(a.begin() + k*N, pr, n[0], n[1], n[2], T(1));
+		fftw_execute_dft_(p, pr, pr);
+		checkerboard(pr, pr, n[0], n[1], n[2], post);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(mutex_);
+		fftw_destroy_plan_(p);
+	}
+
+	return true;
+}
+
 // TODO: implement more optimized threading strategy
 template<typename T>
 inline int hoNDFFT<T>::get_num_threads_fft1(size_t n0, size_t num)
@@ -265,6 +265,16 @@ template<> struct fftw_types<double>{
         void fft2(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, bool forward);
         void fft3(hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, bool forward);
 
+        /**
+         * Centered fft of the first rank dimensions, batched over the others. For even sizes the shifts are a
+         * checkerboard modulation, (-1)^(sum n) before and (-1)^(sum k + sum N/2) after the transform, which is applied
+         * with the scaling while the data of a transform is in cache. Returns false if a size is odd.
+         */
+        bool fftc(const hoNDArray< ComplexType >& a, hoNDArray< ComplexType >& r, size_t rank, bool forward);
+
+        /// r = scale * (-1)^(x+y+z) * a for one [n0 n1 n2] volume, n0 is even
+        void checkerboard(const ComplexType* a, ComplexType* r, size_t n0, size_t n1, size_t n2, T scale);
+
         // get the number of threads used for fft
         int get_num_threads_fft1(size_t n0, size_t num);
         int get_num_threads_fft2(size_t n0, size_t n1, size_t num);
@@ -24,6 +24,7 @@ namespace Gadgetron{
   WriterTask(ACE_SOCK_Stream* socket)
     : inherited()
       , socket_(socket)
+      , meta_format_(GADGET_META_FORMAT_XML)
     {
     }
 
@@ -43,9 +44,21 @@ namespace Gadgetron{
     }
 
     int register_writer(size_t slot, GadgetMessageWriter* writer) {
+      writer->set_meta_format(meta_format_);
       return writers_.insert( (unsigned int)slot,writer);
     }
 
+    /**
+       Passes the meta attribute format negotiated with the client on to the writers,
+       also to those registered later. Must be called before messages are written.
+     */
+    void set_meta_format(ACE_UINT32 format) {
+      meta_format_ = format;
+      for (size_t i = 0; i < writers_.size(); i++) {
+	writers_.at(i)->set_meta_format(format);
+      }
+    }
+
     virtual int close(unsigned long flags)
     {
       int rval = 0;
@@ -110,6 +123,7 @@ namespace Gadgetron{
   protected:
     ACE_SOCK_Stream* socket_;
     GadgetronSlotContainer<GadgetMessageWriter> writers_;
+    ACE_UINT32 meta_format_;
   };
 
   class EXPORTGADGETTOOLS GadgetronConnector: public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_MT_SYNCH> {
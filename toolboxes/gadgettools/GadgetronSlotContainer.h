@@ -35,6 +35,15 @@ public:
 		  return 0;
 	  }
 
+	  size_t size() const {
+		  return items_.size();
+	  }
+
+	  /// the item at position i, in the order of insertion
+	  T* at(size_t i) {
+		  return items_[i];
+	  }
+
 	  int clear()
 	  {
 		  for (unsigned int i = 0; i < items_.size(); i++) {
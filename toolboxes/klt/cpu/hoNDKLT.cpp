@@ -5,27 +5,94 @@
 #include "hoNDArray_linalg.h"
 #include "hoNDArray_utils.h"
 
+#include <random>
+
 namespace Gadgetron{
 
+/// number of rows accumulated together in the covariance computation
+static const size_t KLT_COVARIANCE_TILE_SIZE = 1024;
+/// number of extra basis vectors and power iterations for the truncated eigen decomposition
+static const size_t KLT_TRUNCATED_OVERSAMPLING = 10;
+static const size_t KLT_TRUNCATED_POWER_ITERATIONS = 4;
+
+namespace
+{
+    template <typename T> inline void klt_random(std::mt19937& gen, std::normal_distribution<T>& dis, T& v)
+    {
+        v = dis(gen);
+    }
+
+    template <typename T> inline void klt_random(std::mt19937& gen, std::normal_distribution<T>& dis, std::complex<T>& v)
+    {
+        T re = dis(gen);
+        T im = dis(gen);
+        v = std::complex<T>(re, im);
+    }
+
+    /// orthonormalize the columns of Q with twice modified Gram-Schmidt
+    /// columns depending on the previous ones are set to zero
+    template <typename T> void klt_orthonormalize(hoNDArray<T>& Q)
+    {
+        typedef typename realType<T>::Type value_type;
+
+        size_t L = Q.get_size(0);
+        size_t K = Q.get_size(1);
+
+        size_t k, j, l, pass;
+        for (k = 0; k < K; k++)
+        {
+            T* pQk = &Q(0, k);
+
+            value_type norm_k = 0;
+            for (l = 0; l < L; l++) norm_k += std::norm(pQk[l]);
+
+            for (pass = 0; pass < 2; pass++)
+            {
+                for (j = 0; j < k; j++)
+                {
+                    const T* pQj = &Q(0, j);
+
+                    T v = 0;
+                    for (l = 0; l < L; l++) v += conj(pQj[l]) * pQk[l];
+                    for (l = 0; l < L; l++) pQk[l] -= v * pQj[l];
+                }
+            }
+
+            value_type norm = 0;
+            for (l = 0; l < L; l++) norm += std::norm(pQk[l]);
+
+            if (norm <= norm_k * std::numeric_limits<value_type>::epsilon() || norm <= std::numeric_limits<value_type>::min())
+            {
+                for (l = 0; l < L; l++) pQk[l] = 0;
+            }
+            else
+            {
+                value_type s = (value_type)(1.0 / std::sqrt(norm));
+                for (l = 0; l < L; l++) pQk[l] *= s;
+            }
+        }
+    }
+}
+
 template<typename T> 
-hoNDKLT<T>::hoNDKLT()
+hoNDKLT<T>::hoNDKLT() : output_length_(0), method_(KLT_SVD)
 {
 }
 
 template<typename T>
-hoNDKLT<T>::hoNDKLT(const hoNDArray<T>& data, size_t dim, size_t output_length)
+hoNDKLT<T>::hoNDKLT(const hoNDArray<T>& data, size_t dim, size_t output_length) : output_length_(0), method_(KLT_SVD)
 {
     this->prepare(data, dim, output_length);
 }
 
 template<typename T>
-hoNDKLT<T>::hoNDKLT(const hoNDArray<T>& data, size_t dim, value_type thres)
+hoNDKLT<T>::hoNDKLT(const hoNDArray<T>& data, size_t dim, value_type thres) : output_length_(0), method_(KLT_SVD)
 {
     this->prepare(data, dim, thres);
 }
 
 template<typename T>
-hoNDKLT<T>::hoNDKLT(const Self& v)
+hoNDKLT<T>::hoNDKLT(const Self& v) : output_length_(0), method_(KLT_SVD)
 {
     *this = v;
 }
@@ -43,6 +110,7 @@ hoNDKLT<T>& hoNDKLT<T>::operator=(const Self& v)
     this->V_ = v.V_;
     this->E_ = v.E_;
     this->output_length_ = v.output_length_;
+    this->method_ = v.method_;
 
     size_t N = this->V_.get_size(0);
     this->M_.create(N, this->output_length_, V_.begin());
@@ -165,6 +233,254 @@ void hoNDKLT<T>::compute_eigen_vector(const hoNDArray<T>& data, bool remove_mean
     }
 }
 
+template<typename T>
+void hoNDKLT<T>::compute_covariance(const hoNDArray<T>& data, size_t dim, const std::vector<size_t>& untransformed, bool remove_mean, hoNDArray<T>& cov)
+{
+    try
+    {
+        size_t NDim = data.get_number_of_dimensions();
+        GADGET_CHECK_THROW(dim < NDim);
+
+        std::vector<size_t> dims;
+        data.get_dimensions(dims);
+
+        size_t N = dims[dim];
+
+        // data is seen as [A N B], every one of M = A*B samples has N slots
+        size_t A = 1;
+        size_t d;
+        for (d = 0; d < dim; d++) A *= dims[d];
+
+        size_t M = data.get_number_of_elements() / N;
+
+        // slots taking part in the transform
+        std::vector<size_t> slots;
+        size_t n;
+        for (n = 0; n < N; n++)
+        {
+            if (std::find(untransformed.begin(), untransformed.end(), n) == untransformed.end())
+            {
+                slots.push_back(n);
+            }
+        }
+
+        size_t L = slots.size();
+        GADGET_CHECK_THROW(L > 0);
+
+        const T* pData = data.begin();
+
+        // the first sample is subtracted before accumulation, to reduce the cancellation when removing the mean
+        std::vector<T> shift(L, T(0));
+        size_t l;
+        if (remove_mean)
+        {
+            for (l = 0; l < L; l++) shift[l] = pData[slots[l] * A];
+        }
+
+        cov.create(L, L);
+        Gadgetron::clear(cov);
+
+        std::vector<T> sum(L, T(0));
+
+        size_t tile_size = KLT_COVARIANCE_TILE_SIZE;
+        long long num_tiles = (long long)((M + tile_size - 1) / tile_size);
+
+#pragma omp parallel default(none) shared(num_tiles, tile_size, M, A, N, L, slots, shift, pData, cov, sum)
+        {
+            hoNDArray<T> buf(tile_size, L);
+            hoNDArray<T> cov_tile(L, L);
+
+            hoNDArray<T> cov_local(L, L);
+            Gadgetron::clear(cov_local);
+
+            std::vector<T> sum_local(L, T(0));
+
+            long long tile;
+
+#pragma omp for schedule(dynamic)
+            for (tile = 0; tile < num_tiles; tile++)
+            {
+                size_t start = (size_t)tile * tile_size;
+                size_t num = ((start + tile_size) > M) ? (M - start) : tile_size;
+
+                hoNDArray<T> buf_tile(num, L, buf.begin());
+
+                size_t r, c;
+                for (c = 0; c < L; c++)
+                {
+                    T* pBuf = buf.begin() + c*num;
+                    T s = shift[c];
+
+                    size_t a = start % A;
+                    size_t b = start / A;
+                    const T* pSrc = pData + slots[c] * A + b*A*N;
+
+                    T v(0);
+                    for (r = 0; r < num; r++)
+                    {
+                        pBuf[r] = pSrc[a] - s;
+                        v += pBuf[r];
+
+                        a++;
+                        if (a == A)
+                        {
+                            a = 0;
+                            pSrc += A*N;
+                        }
+                    }
+
+                    sum_local[c] += v;
+                }
+
+                Gadgetron::herk(cov_tile, buf_tile, 'L', true);
+
+                for (c = 0; c < L; c++)
+                {
+                    for (r = c; r < L; r++)
+                    {
+                        cov_local(r, c) += cov_tile(r, c);
+                    }
+                }
+            }
+
+#pragma omp critical
+            {
+                size_t r, c;
+                for (c = 0; c < L; c++)
+                {
+                    for (r = c; r < L; r++)
+                    {
+                        cov(r, c) += cov_local(r, c);
+                    }
+
+                    sum[c] += sum_local[c];
+                }
+            }
+        }
+
+        size_t r, c;
+
+        if (remove_mean)
+        {
+            // sum_m (x_m - mean)^H (x_m - mean) = sum_m x_m^H x_m - M * mean^H mean
+            for (c = 0; c < L; c++)
+            {
+                for (r = c; r < L; r++)
+                {
+                    cov(r, c) -= conj(sum[r]) * sum[c] / (value_type)M;
+                }
+            }
+        }
+
+        for (c = 0; c < L; c++)
+        {
+            for (r = c + 1; r < L; r++)
+            {
+                cov(c, r) = conj(cov(r, c));
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDKLT<T>::compute_covariance(...) ... ");
+    }
+}
+
+template<typename T>
+void hoNDKLT<T>::compute_eigen_vector_covariance(const hoNDArray<T>& data, size_t dim, const std::vector<size_t>& untransformed, size_t num_modes, bool remove_mean)
+{
+    try
+    {
+        hoNDArray<T> cov;
+        this->compute_covariance(data, dim, untransformed, remove_mean, cov);
+        this->compute_eigen_vector_from_covariance(cov, num_modes);
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDKLT<T>::compute_eigen_vector_covariance(...) ... ");
+    }
+}
+
+template<typename T>
+void hoNDKLT<T>::compute_eigen_vector_from_covariance(hoNDArray<T>& cov, size_t num_modes)
+{
+    try
+    {
+        size_t L = cov.get_size(0);
+        GADGET_CHECK_THROW(cov.get_size(1) == L);
+
+        V_.create(L, L);
+        E_.create(L, 1);
+        Gadgetron::clear(V_);
+        Gadgetron::clear(E_);
+
+        size_t n;
+
+        if ((method_ == KLT_TRUNCATED) && (num_modes > 0) && (num_modes < L))
+        {
+            // randomized subspace iteration for the leading modes
+            size_t num_basis = num_modes + KLT_TRUNCATED_OVERSAMPLING;
+            if (num_basis > L) num_basis = L;
+
+            hoNDArray<T> Q(L, num_basis), Y(L, num_basis);
+
+            // fixed seed so that the transform is reproducible
+            std::mt19937 gen(3571);
+            std::normal_distribution<value_type> dis(0, 1);
+
+            T* pQ = Q.begin();
+            for (n = 0; n < Q.get_number_of_elements(); n++)
+            {
+                klt_random(gen, dis, pQ[n]);
+            }
+
+            klt_orthonormalize(Q);
+
+            size_t iter;
+            for (iter = 0; iter < KLT_TRUNCATED_POWER_ITERATIONS; iter++)
+            {
+                Gadgetron::gemm(Y, cov, false, Q, false);
+                klt_orthonormalize(Y);
+                Q = Y;
+            }
+
+            // Rayleigh-Ritz projection
+            Gadgetron::gemm(Y, cov, false, Q, false);
+
+            hoNDArray<T> B;
+            Gadgetron::gemm(B, Q, true, Y, false);
+
+            hoNDArray<value_type> ev;
+            Gadgetron::heev(B, ev);
+
+            hoNDArray<T> W;
+            Gadgetron::gemm(W, Q, false, B, false);
+
+            // heev sorts eigen values in the ascending order
+            for (n = 0; n < num_modes; n++)
+            {
+                memcpy(&V_(0, n), &W(0, num_basis - 1 - n), sizeof(T)*L);
+                E_(n) = (T)ev(num_basis - 1 - n);
+            }
+        }
+        else
+        {
+            hoNDArray<value_type> ev;
+            Gadgetron::heev(cov, ev);
+
+            for (n = 0; n < L; n++)
+            {
+                memcpy(&V_(0, n), &cov(0, L - 1 - n), sizeof(T)*L);
+                E_(n) = (T)ev(L - 1 - n);
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDKLT<T>::compute_eigen_vector_from_covariance(...) ... ");
+    }
+}
+
 template<typename T>
 void hoNDKLT<T>::prepare(const hoNDArray<T>& data, size_t dim, size_t output_length, bool remove_mean)
 {
@@ -190,7 +506,12 @@ void hoNDKLT<T>::prepare(const hoNDArray<T>& data, size_t dim, size_t output_len
         size_t K = 1;
         for (size_t n = dim + 1; n < NDim; n++) K *= dimD[n];
 
-        if (dim == NDim - 1)
+        if (method_ != KLT_SVD)
+        {
+            std::vector<size_t> untransformed;
+            this->compute_eigen_vector_covariance(data, dim, untransformed, output_length_, remove_mean);
+        }
+        else if (dim == NDim - 1)
         {
             this->compute_eigen_vector(data, remove_mean);
         }
@@ -433,18 +754,31 @@ void hoNDKLT<T>::prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_
 
         if (unN > 0)
         {
-            // crop the data to exclude untransformed slots
-            hoNDArray<T> dataCropped;
-            this->exclude_untransformed(data, dim, untransformed, dataCropped);
-
-            // compute the transform
-            if (output_length > 0)
+            if (method_ != KLT_SVD)
             {
-                this->prepare(dataCropped, dim, output_length - unN, remove_mean);
+                // untransformed slots are skipped while accumulating the covariance
+                size_t num_transformed = N - unN;
+
+                output_length_ = num_transformed;
+                if (output_length > unN) output_length_ = output_length - unN;
+
+                this->compute_eigen_vector_covariance(data, dim, untransformed, output_length_, remove_mean);
             }
             else
             {
-                this->prepare(dataCropped, dim, (size_t)0, remove_mean);
+                // crop the data to exclude untransformed slots
+                hoNDArray<T> dataCropped;
+                this->exclude_untransformed(data, dim, untransformed, dataCropped);
+
+                // compute the transform
+                if (output_length > 0)
+                {
+                    this->prepare(dataCropped, dim, output_length - unN, remove_mean);
+                }
+                else
+                {
+                    this->prepare(dataCropped, dim, (size_t)0, remove_mean);
+                }
             }
 
             // adjust the eigen vector matrix
@@ -489,6 +823,71 @@ void hoNDKLT<T>::prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_
     }
 }
 
+template<typename T>
+void hoNDKLT<T>::prepare_covariance(const hoNDArray<T>& cov, std::vector<size_t>& untransformed, size_t output_length)
+{
+    try
+    {
+        GADGET_CHECK_THROW(cov.get_number_of_dimensions() >= 2);
+
+        size_t N = cov.get_size(0);
+        GADGET_CHECK_THROW(cov.get_size(1) == N);
+
+        size_t unN = untransformed.size();
+        GADGET_CHECK_THROW(unN < N);
+        if (output_length > 0)
+        {
+            GADGET_CHECK_THROW(output_length >= unN);
+        }
+
+        size_t d;
+        for (d = 0; d < unN; d++)
+        {
+            GADGET_CHECK_THROW(untransformed[d] < N);
+        }
+
+        // covariance of the transformed slots
+        std::vector<size_t> slots;
+        size_t n;
+        for (n = 0; n < N; n++)
+        {
+            if (std::find(untransformed.begin(), untransformed.end(), n) == untransformed.end())
+            {
+                slots.push_back(n);
+            }
+        }
+
+        size_t L = slots.size();
+
+        hoNDArray<T> covL(L, L);
+        size_t r, c;
+        for (c = 0; c < L; c++)
+        {
+            for (r = 0; r < L; r++)
+            {
+                covL(r, c) = cov(slots[r], slots[c]);
+            }
+        }
+
+        output_length_ = L;
+        if (output_length > unN && output_length - unN < L) output_length_ = output_length - unN;
+
+        this->compute_eigen_vector_from_covariance(covL, output_length_);
+
+        if (unN > 0)
+        {
+            this->copy_and_reset_transform(N, untransformed);
+            output_length_ += unN;
+        }
+
+        M_.create(N, output_length_, V_.begin());
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDKLT<T>::prepare_covariance(...) ... ");
+    }
+}
+
 template<typename T>
 void hoNDKLT<T>::transform(const hoNDArray<T>& in, hoNDArray<T>& out, size_t dim) const
 {
@@ -724,6 +1123,155 @@ void hoNDKLT<T>::eigen_value(hoNDArray<T>& E) const
     E = E_;
 }
 
+template<typename T>
+void hoNDKLT<T>::method(KLTMethod m)
+{
+    method_ = m;
+}
+
+template<typename T>
+KLTMethod hoNDKLT<T>::method() const
+{
+    return method_;
+}
+
+// ------------------------------------------------------------
+// hoNDKLTCovariance
+// ------------------------------------------------------------
+
+template<typename T>
+hoNDKLTCovariance<T>::hoNDKLTCovariance() : N_(0), num_samples_(0)
+{
+}
+
+template<typename T>
+hoNDKLTCovariance<T>::hoNDKLTCovariance(size_t N) : N_(0), num_samples_(0)
+{
+    this->reset(N);
+}
+
+template<typename T>
+hoNDKLTCovariance<T>::~hoNDKLTCovariance()
+{
+}
+
+template<typename T>
+void hoNDKLTCovariance<T>::reset(size_t N)
+{
+    N_ = N;
+    num_samples_ = 0;
+
+    mean_.assign(N, T(0));
+
+    cov_.create(N, N);
+    Gadgetron::clear(cov_);
+}
+
+template<typename T>
+void hoNDKLTCovariance<T>::add(const T* data, size_t M, size_t ld)
+{
+    try
+    {
+        if (M == 0) return;
+        GADGET_CHECK_THROW(N_ > 0);
+        GADGET_CHECK_THROW(ld >= M);
+
+        size_t N = N_;
+
+        if (buf_.get_size(0) != M || buf_.get_size(1) != N) buf_.create(M, N);
+
+        // mean of the block, then the centered block
+        std::vector<T> mean_block(N);
+
+        size_t m, n;
+        for (n = 0; n < N; n++)
+        {
+            const T* pSrc = data + n*ld;
+            T* pBuf = buf_.begin() + n*M;
+
+            T v(0);
+            for (m = 0; m < M; m++) v += pSrc[m];
+            v /= (value_type)M;
+
+            for (m = 0; m < M; m++) pBuf[m] = pSrc[m] - v;
+
+            mean_block[n] = v;
+        }
+
+        Gadgetron::herk(cov_block_, buf_, 'L', true);
+
+        // merge the block into the running statistics
+        value_type na = (value_type)num_samples_;
+        value_type nb = (value_type)M;
+        value_type w = na*nb / (na + nb);
+
+        std::vector<T> delta(N);
+        for (n = 0; n < N; n++) delta[n] = mean_block[n] - mean_[n];
+
+        size_t r, c;
+        for (c = 0; c < N; c++)
+        {
+            for (r = c; r < N; r++)
+            {
+                cov_(r, c) += cov_block_(r, c) + w * conj(delta[r]) * delta[c];
+            }
+        }
+
+        for (n = 0; n < N; n++) mean_[n] += delta[n] * (nb / (na + nb));
+
+        num_samples_ += M;
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in hoNDKLTCovariance<T>::add(...) ... ");
+    }
+}
+
+template<typename T>
+void hoNDKLTCovariance<T>::add(const hoNDArray<T>& data)
+{
+    size_t NDim = data.get_number_of_dimensions();
+    GADGET_CHECK_THROW(data.get_size(NDim - 1) == N_);
+
+    size_t M = data.get_number_of_elements() / N_;
+    this->add(data.begin(), M, M);
+}
+
+template<typename T>
+size_t hoNDKLTCovariance<T>::number_of_slots() const
+{
+    return N_;
+}
+
+template<typename T>
+size_t hoNDKLTCovariance<T>::number_of_samples() const
+{
+    return num_samples_;
+}
+
+template<typename T>
+void hoNDKLTCovariance<T>::mean(hoNDArray<T>& m) const
+{
+    m.create(N_);
+    for (size_t n = 0; n < N_; n++) m(n) = mean_[n];
+}
+
+template<typename T>
+void hoNDKLTCovariance<T>::covariance(hoNDArray<T>& cov) const
+{
+    cov.create(N_, N_);
+
+    size_t r, c;
+    for (c = 0; c < N_; c++)
+    {
+        for (r = c; r < N_; r++)
+        {
+            cov(r, c) = cov_(r, c);
+            cov(c, r) = conj(cov_(r, c));
+        }
+    }
+}
+
 // ------------------------------------------------------------
 // Instantiation
 // ------------------------------------------------------------
@@ -732,4 +1280,9 @@ template class EXPORTCPUKLT hoNDKLT<float>;
 template class EXPORTCPUKLT hoNDKLT<double>;
 template class EXPORTCPUKLT hoNDKLT< std::complex<float> >;
 template class EXPORTCPUKLT hoNDKLT< std::complex<double> >;
+
+template class EXPORTCPUKLT hoNDKLTCovariance<float>;
+template class EXPORTCPUKLT hoNDKLTCovariance<double>;
+template class EXPORTCPUKLT hoNDKLTCovariance< std::complex<float> >;
+template class EXPORTCPUKLT hoNDKLTCovariance< std::complex<double> >;
 }
@@ -15,6 +15,18 @@
 
 namespace Gadgetron{
 
+    /// method to compute the KL transform
+    /// KLT_SVD : svd of the data matrix, all modes are computed
+    /// KLT_COVARIANCE : the covariance matrix is accumulated in one parallel pass over the data, followed by a full eigen decomposition
+    /// KLT_TRUNCATED : as KLT_COVARIANCE, but only the leading output_length modes are computed with the randomized subspace iteration;
+    ///                 the other columns of eigen vector matrix and eigen values are set to zero
+    enum KLTMethod
+    {
+        KLT_SVD = 0,
+        KLT_COVARIANCE,
+        KLT_TRUNCATED
+    };
+
     /*
         After calling perpare, the KL transformation is computed
         The eigen values are in the descending order, 
@@ -53,6 +65,10 @@ namespace Gadgetron{
         void prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, size_t output_length = 0, bool remove_mean = true);
         void prepare(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, value_type thres = (value_type)0.001, bool remove_mean = true);
 
+        /// prepare from a [N N] covariance matrix of all slots, e.g. accumulated with hoNDKLTCovariance
+        /// rows and columns of the untransformed slots are ignored; the eigen decomposition follows method()
+        void prepare_covariance(const hoNDArray<T>& cov, std::vector<size_t>& untransformed, size_t output_length = 0);
+
         /// apply the transform
         /// The input array size must meet in.get_size(dim) == M.get_size(0)
         /// out array will have out.get_size(dim)==out_length
@@ -77,6 +93,11 @@ namespace Gadgetron{
         /// get the eigen values
         void eigen_value(hoNDArray<T>& E) const;
 
+        /// set/get the method to compute the transform, default is KLT_SVD
+        /// it must be set before calling prepare
+        void method(KLTMethod m);
+        KLTMethod method() const;
+
     protected:
 
         /// KL tranformation matrix
@@ -87,10 +108,22 @@ namespace Gadgetron{
         hoNDArray<T> E_;
         /// length of output dimension
         size_t output_length_;
+        /// method to compute the transform
+        KLTMethod method_;
 
         /// compute eigen vector and values
         void compute_eigen_vector(const hoNDArray<T>& data, bool remove_mean);
 
+        /// compute the covariance matrix along dim, excluding the untransformed slots, without copying the data
+        void compute_covariance(const hoNDArray<T>& data, size_t dim, const std::vector<size_t>& untransformed, bool remove_mean, hoNDArray<T>& cov);
+
+        /// compute eigen vector and values from the covariance matrix
+        /// if method_ is KLT_TRUNCATED and 0<num_modes<number of transformed slots, only num_modes modes are computed
+        void compute_eigen_vector_covariance(const hoNDArray<T>& data, size_t dim, const std::vector<size_t>& untransformed, size_t num_modes, bool remove_mean);
+
+        /// compute eigen vector and values of the covariance matrix, cov is overwritten
+        void compute_eigen_vector_from_covariance(hoNDArray<T>& cov, size_t num_modes);
+
         /// exclude untransformed data
         void exclude_untransformed(const hoNDArray<T>& data, size_t dim, std::vector<size_t>& untransformed, hoNDArray<T>& dataCropped);
 
@@ -100,6 +133,54 @@ namespace Gadgetron{
         /// compute number of kept channels
         void compute_num_kept(value_type thres);
     };
+
+    /*
+        Running covariance of N slots, for data which arrive over time, e.g. readouts of a scan.
+        Every call of add merges a block of samples into the mean and the covariance (Chan's update of
+        the Welford algorithm), the samples themselves are not kept.
+        The covariance is the sum over samples of (x-mean)^H (x-mean), as in hoNDKLT, without normalization.
+    */
+    template <typename T> class EXPORTCPUKLT hoNDKLTCovariance
+    {
+    public:
+
+        typedef typename realType<T>::Type value_type;
+
+        hoNDKLTCovariance();
+        hoNDKLTCovariance(size_t N);
+        ~hoNDKLTCovariance();
+
+        /// start over with N slots
+        void reset(size_t N);
+
+        /// add M samples, slot n of sample m is data[m + n*ld]
+        /// e.g. a window of M samples of a [RO CHA] readout has data = readout.begin() + offset and ld = RO
+        void add(const T* data, size_t M, size_t ld);
+        /// add the samples of a [M N] array
+        void add(const hoNDArray<T>& data);
+
+        size_t number_of_slots() const;
+        size_t number_of_samples() const;
+
+        /// [N] mean of the samples
+        void mean(hoNDArray<T>& m) const;
+        /// [N N] covariance matrix
+        void covariance(hoNDArray<T>& cov) const;
+
+    protected:
+
+        size_t N_;
+        size_t num_samples_;
+
+        /// running mean
+        std::vector<T> mean_;
+        /// running covariance, lower triangle
+        hoNDArray<T> cov_;
+
+        /// centered block and its covariance
+        hoNDArray<T> buf_;
+        hoNDArray<T> cov_block_;
+    };
 }
 
 #endif //hoNDKLT_H
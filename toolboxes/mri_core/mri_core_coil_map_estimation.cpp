@@ -10,6 +10,10 @@
 #include "hoNDArray_elemwise.h"
 #include "hoNDArray_reductions.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #ifdef USE_OMP
     #include <omp.h>
 #endif // USE_OMP
@@ -737,6 +741,578 @@ template<typename T> void coil_map_Inati_Iter(const hoNDArray<T>& data, hoNDArra
 template EXPORTMRICORE void coil_map_Inati_Iter(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t kz, size_t iterNum, float thres);
 template EXPORTMRICORE void coil_map_Inati_Iter(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t kz, size_t iterNum, double thres);
 
+// ------------------------------------------------------------------------
+
+namespace
+{
+    // positions the coil map is estimated at along a dimension, the last sample is always included
+    std::vector<size_t> coil_map_Inati_fast_grid(size_t N, size_t step)
+    {
+        std::vector<size_t> grid;
+        for (size_t n = 0; n < N; n += step) grid.push_back(n);
+        if (grid.back() != N - 1) grid.push_back(N - 1);
+        return grid;
+    }
+
+    // sum of a along RO over the kernel, out[x] = a[x] + ... + a[x+ks-1], the input is padded by ks-1 samples
+    template<typename value_type>
+    inline void coil_map_Inati_fast_box(const value_type* a, long long RO, long long ks, value_type* out)
+    {
+        value_type s = 0;
+        for (long long k = 0; k < ks; k++) s += a[k];
+        out[0] = s;
+
+        for (long long x = 1; x < RO; x++)
+        {
+            s += a[x + ks - 1] - a[x - 1];
+            out[x] = s;
+        }
+    }
+
+    // box sums along RO of a row r of the plane e2, summed over the kz planes around it:
+    // the upper triangle of the correlation conj(a_i)*a_j in the order (0,0), (0,1), ..., (1,1), ..., then the channels a_c
+    // H is [RO 2 M], real and imaginary parts; pad is [RO+ks-1 2 CHA kz]; prod is [RO+ks-1 2]
+    template<typename T>
+    void coil_map_Inati_fast_row(const T* pData, long long RO, long long E1, long long E2, long long CHA,
+        long long r, long long e2, long long halfKs, long long halfKz,
+        typename realType<T>::Type* pad, typename realType<T>::Type* prod, typename realType<T>::Type* H)
+    {
+        typedef typename realType<T>::Type value_type;
+
+        long long ks = 2 * halfKs + 1;
+        long long kz = 2 * halfKz + 1;
+        long long W = RO + ks - 1;
+
+        long long y = r % E1;
+        if (y < 0) y += E1;
+
+        long long c, x, dz;
+        for (dz = 0; dz < kz; dz++)
+        {
+            long long z = (e2 + dz - halfKz) % E2;
+            if (z < 0) z += E2;
+
+            for (c = 0; c < CHA; c++)
+            {
+                const T* pRow = pData + c*RO*E1*E2 + z*RO*E1 + y*RO;
+                value_type* pr = pad + (dz*CHA + c) * 2 * W;
+                value_type* pi = pr + W;
+
+                for (x = 0; x < W; x++)
+                {
+                    long long dx = x - halfKs;
+                    if (dx < 0) dx += RO;
+                    if (dx >= RO) dx -= RO;
+
+                    pr[x] = pRow[dx].real();
+                    pi[x] = pRow[dx].imag();
+                }
+            }
+        }
+
+        value_type* prod_r = prod;
+        value_type* prod_i = prod + W;
+
+        long long i, j, m = 0;
+        for (i = 0; i < CHA; i++)
+        {
+            for (j = i; j < CHA; j++)
+            {
+                for (x = 0; x < W; x++)
+                {
+                    prod_r[x] = 0;
+                    prod_i[x] = 0;
+                }
+
+                for (dz = 0; dz < kz; dz++)
+                {
+                    const value_type* ar = pad + (dz*CHA + i) * 2 * W;
+                    const value_type* ai = ar + W;
+                    const value_type* br = pad + (dz*CHA + j) * 2 * W;
+                    const value_type* bi = br + W;
+
+                    for (x = 0; x < W; x++)
+                    {
+                        prod_r[x] += ar[x] * br[x] + ai[x] * bi[x];
+                        prod_i[x] += ar[x] * bi[x] - ai[x] * br[x];
+                    }
+                }
+
+                coil_map_Inati_fast_box(prod_r, RO, ks, H + 2 * m*RO);
+                coil_map_Inati_fast_box(prod_i, RO, ks, H + (2 * m + 1)*RO);
+                m++;
+            }
+        }
+
+        for (c = 0; c < CHA; c++)
+        {
+            for (x = 0; x < W; x++)
+            {
+                prod_r[x] = 0;
+                prod_i[x] = 0;
+            }
+
+            for (dz = 0; dz < kz; dz++)
+            {
+                const value_type* ar = pad + (dz*CHA + c) * 2 * W;
+                const value_type* ai = ar + W;
+
+                for (x = 0; x < W; x++)
+                {
+                    prod_r[x] += ar[x];
+                    prod_i[x] += ai[x];
+                }
+            }
+
+            coil_map_Inati_fast_box(prod_r, RO, ks, H + 2 * m*RO);
+            coil_map_Inati_fast_box(prod_i, RO, ks, H + (2 * m + 1)*RO);
+            m++;
+        }
+    }
+
+    // power iterations for n pixels at once, R is [n 2 M] as computed by coil_map_Inati_fast_row
+    // the coil map [n 2 CHA] is written to v; w is [n 2 CHA], nrm is [n 2]
+    template<typename value_type>
+    void coil_map_Inati_fast_power(const value_type* R, long long n, long long CHA, size_t power,
+        value_type* v, value_type* w, value_type* nrm)
+    {
+        long long P = CHA*(CHA + 1) / 2;
+        long long i, j, m, x;
+
+        // v = v / |v|
+        auto normalize = [&](value_type* a)
+        {
+            for (x = 0; x < n; x++) nrm[x] = 0;
+            for (i = 0; i < CHA; i++)
+            {
+                const value_type* ar = a + 2 * i*n;
+                const value_type* ai = ar + n;
+                for (x = 0; x < n; x++) nrm[x] += ar[x] * ar[x] + ai[x] * ai[x];
+            }
+
+            for (x = 0; x < n; x++) nrm[x] = (nrm[x] > 0) ? (value_type)1.0 / std::sqrt(nrm[x]) : 0;
+
+            for (i = 0; i < 2 * CHA; i++)
+            {
+                value_type* ai = a + i*n;
+                for (x = 0; x < n; x++) ai[x] *= nrm[x];
+            }
+        };
+
+        // the sum of the data over the kernel is the first estimate, as in coil_map_2d_Inati
+        memcpy(v, R + 2 * P*n, sizeof(value_type) * 2 * CHA*n);
+        normalize(v);
+
+        size_t po;
+        for (po = 0; po < power; po++)
+        {
+            memset(w, 0, sizeof(value_type) * 2 * CHA*n);
+
+            m = 0;
+            for (i = 0; i < CHA; i++)
+            {
+                value_type* wir = w + 2 * i*n;
+                value_type* wii = wir + n;
+                const value_type* vir = v + 2 * i*n;
+                const value_type* vii = vir + n;
+
+                for (j = i; j < CHA; j++)
+                {
+                    const value_type* rr = R + 2 * m*n;
+                    const value_type* ri = rr + n;
+
+                    value_type* wjr = w + 2 * j*n;
+                    value_type* wji = wjr + n;
+                    const value_type* vjr = v + 2 * j*n;
+                    const value_type* vji = vjr + n;
+
+                    // w_i += R_ij v_j
+                    for (x = 0; x < n; x++)
+                    {
+                        wir[x] += rr[x] * vjr[x] - ri[x] * vji[x];
+                        wii[x] += rr[x] * vji[x] + ri[x] * vjr[x];
+                    }
+
+                    // w_j += conj(R_ij) v_i
+                    if (j != i)
+                    {
+                        for (x = 0; x < n; x++)
+                        {
+                            wjr[x] += rr[x] * vir[x] + ri[x] * vii[x];
+                            wji[x] += rr[x] * vii[x] - ri[x] * vir[x];
+                        }
+                    }
+
+                    m++;
+                }
+            }
+
+            std::swap(v, w);
+            normalize(v);
+        }
+
+        // the result goes to the buffer of the caller
+        if (power % 2 == 1)
+        {
+            memcpy(w, v, sizeof(value_type) * 2 * CHA*n);
+            std::swap(v, w);
+        }
+
+        // phase of the sum of U1 = D V1 over the kernel, i.e. of the sum of the data times V1
+        value_type* phr = nrm;
+        value_type* phi = nrm + n;
+        for (x = 0; x < n; x++)
+        {
+            phr[x] = 0;
+            phi[x] = 0;
+        }
+
+        for (i = 0; i < CHA; i++)
+        {
+            const value_type* sr = R + 2 * (P + i)*n;
+            const value_type* si = sr + n;
+            const value_type* vr = v + 2 * i*n;
+            const value_type* vi = vr + n;
+
+            for (x = 0; x < n; x++)
+            {
+                phr[x] += sr[x] * vr[x] - si[x] * vi[x];
+                phi[x] += sr[x] * vi[x] + si[x] * vr[x];
+            }
+        }
+
+        for (x = 0; x < n; x++)
+        {
+            value_type a = std::sqrt(phr[x] * phr[x] + phi[x] * phi[x]);
+            if (a > 0)
+            {
+                phr[x] /= a;
+                phi[x] /= a;
+            }
+            else
+            {
+                phr[x] = 1;
+                phi[x] = 0;
+            }
+        }
+
+        // put the mean object phase to coil map, conj(V1)*phase
+        for (i = 0; i < CHA; i++)
+        {
+            value_type* vr = v + 2 * i*n;
+            value_type* vi = vr + n;
+
+            for (x = 0; x < n; x++)
+            {
+                value_type a = vr[x];
+                value_type b = vi[x];
+                vr[x] = a*phr[x] + b*phi[x];
+                vi[x] = a*phi[x] - b*phr[x];
+            }
+        }
+    }
+
+    // data: [RO E1 E2 CHA]
+    template<typename T>
+    void coil_map_Inati_fast_impl(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t power, size_t step)
+    {
+        typedef typename realType<T>::Type value_type;
+
+        long long RO = data.get_size(0);
+        long long E1 = data.get_size(1);
+        long long E2 = data.get_size(2);
+        long long CHA = data.get_size(3);
+
+        if (ks % 2 != 1) ks++;
+        if (kz % 2 != 1) kz++;
+        if (E2 == 1) kz = 1;
+        if (step < 1) step = 1;
+
+        // the kernel wraps around the image once, as in coil_map_2d_Inati
+        GADGET_CHECK_THROW((long long)ks <= RO && (long long)ks <= E1 && (long long)kz <= E2);
+
+        long long halfKs = (long long)ks / 2;
+        long long halfKz = (long long)kz / 2;
+        long long M = CHA*(CHA + 1) / 2 + CHA;
+        long long W = RO + (long long)ks - 1;
+
+        const T* pData = data.begin();
+        T* pSen = coilMap.begin();
+
+        std::vector<size_t> gx = coil_map_Inati_fast_grid(RO, step);
+        std::vector<size_t> gy = coil_map_Inati_fast_grid(E1, step);
+        std::vector<size_t> gz = coil_map_Inati_fast_grid(E2, step);
+
+        long long Kx = gx.size();
+        long long Ky = gy.size();
+        long long Kz = gz.size();
+
+        // index of a row on the grid, -1 if it is not on the grid
+        std::vector<long long> grid_row(E1, -1);
+        for (long long k = 0; k < Ky; k++) grid_row[gy[k]] = k;
+
+        // the coil map on the grid, the output itself without downsampling
+        hoNDArray<T> gridMap;
+        T* pG = pSen;
+        if (step > 1)
+        {
+            gridMap.create(Kx, Ky, Kz, CHA);
+            pG = gridMap.begin();
+        }
+
+        // every chunk of rows starts its running sums from the box sums of ks rows
+        int num_threads = 1;
+#ifdef USE_OMP
+        num_threads = omp_get_max_threads();
+#endif // USE_OMP
+
+        long long chunks = num_threads / Kz;
+        if (chunks > E1 / (long long)ks) chunks = E1 / (long long)ks;
+        if (chunks < 1) chunks = 1;
+
+        long long num_tasks = Kz*chunks;
+
+        long long task;
+#pragma omp parallel for private(task) schedule(dynamic) if(num_tasks>1)
+        for (task = 0; task < num_tasks; task++)
+        {
+            long long iz = task / chunks;
+            long long chunk = task % chunks;
+            long long e2 = gz[iz];
+
+            long long e1_start = chunk*E1 / chunks;
+            long long e1_end = (chunk + 1)*E1 / chunks;
+
+            std::vector<value_type> pad(W * 2 * CHA*kz), prod(W * 2);
+            std::vector<value_type> ring((size_t)ks * 2 * M*RO), V(2 * M*RO);
+            std::vector<value_type> Rg, v(2 * CHA*Kx), w(2 * CHA*Kx), nrm(2 * Kx);
+            if (step > 1) Rg.resize(2 * M*Kx);
+
+            const long long len = 2 * M*RO;
+
+            long long r, n, e1;
+            for (r = e1_start - halfKs; r <= e1_start + halfKs; r++)
+            {
+                value_type* H = &ring[0] + (((r % (long long)ks) + ks) % ks)*len;
+                coil_map_Inati_fast_row(pData, RO, E1, E2, CHA, r, e2, halfKs, halfKz, &pad[0], &prod[0], H);
+                if (r == e1_start - halfKs)
+                    memcpy(&V[0], H, sizeof(value_type)*len);
+                else
+                    for (n = 0; n < len; n++) V[n] += H[n];
+            }
+
+            for (e1 = e1_start; e1 < e1_end; e1++)
+            {
+                if (e1 > e1_start)
+                {
+                    // the row leaving the kernel and the one entering it share the slot of the ring
+                    r = e1 + halfKs;
+                    value_type* H = &ring[0] + (((r % (long long)ks) + ks) % ks)*len;
+
+                    for (n = 0; n < len; n++) V[n] -= H[n];
+                    coil_map_Inati_fast_row(pData, RO, E1, E2, CHA, r, e2, halfKs, halfKz, &pad[0], &prod[0], H);
+                    for (n = 0; n < len; n++) V[n] += H[n];
+                }
+
+                long long iy = grid_row[e1];
+                if (iy < 0) continue;
+
+                const value_type* R = &V[0];
+                if (step > 1)
+                {
+                    for (n = 0; n < 2 * M; n++)
+                    {
+                        for (long long k = 0; k < Kx; k++) Rg[n*Kx + k] = V[n*RO + gx[k]];
+                    }
+                    R = &Rg[0];
+                }
+
+                coil_map_Inati_fast_power(R, Kx, CHA, power, &v[0], &w[0], &nrm[0]);
+
+                for (long long c = 0; c < CHA; c++)
+                {
+                    T* pOut = pG + c*Kx*Ky*Kz + iz*Kx*Ky + iy*Kx;
+                    const value_type* vr = &v[0] + 2 * c*Kx;
+                    const value_type* vi = vr + Kx;
+                    for (long long k = 0; k < Kx; k++) pOut[k] = T(vr[k], vi[k]);
+                }
+            }
+        }
+
+        if (step == 1) return;
+
+        // linear interpolation of the grid, the coil map is normalized again
+        std::vector<long long> ix(RO), iy(E1), iz(E2);
+        std::vector<value_type> fx(RO), fy(E1), fz(E2);
+
+        auto interval = [](const std::vector<size_t>& grid, std::vector<long long>& ind, std::vector<value_type>& frac)
+        {
+            size_t k = 0;
+            for (size_t n = 0; n < ind.size(); n++)
+            {
+                while (k + 2 < grid.size() && grid[k + 1] <= n) k++;
+                ind[n] = k;
+                frac[n] = (grid.size() == 1) ? 0 : (value_type)((double)n - grid[k]) / (value_type)(grid[k + 1] - grid[k]);
+            }
+        };
+
+        interval(gx, ix, fx);
+        interval(gy, iy, fy);
+        interval(gz, iz, fz);
+
+        long long yz;
+#pragma omp parallel for private(yz) if(E1*E2>16)
+        for (yz = 0; yz < E1*E2; yz++)
+        {
+            long long e1 = yz % E1;
+            long long e2 = yz / E1;
+
+            long long y0 = iy[e1], y1 = (Ky > 1) ? y0 + 1 : y0;
+            long long z0 = iz[e2], z1 = (Kz > 1) ? z0 + 1 : z0;
+            value_type wy = fy[e1], wz = fz[e2];
+
+            std::vector<value_type> nrm(RO, 0);
+
+            for (long long c = 0; c < CHA; c++)
+            {
+                const T* g = pG + c*Kx*Ky*Kz;
+                const T* g00 = g + z0*Kx*Ky + y0*Kx;
+                const T* g01 = g + z0*Kx*Ky + y1*Kx;
+                const T* g10 = g + z1*Kx*Ky + y0*Kx;
+                const T* g11 = g + z1*Kx*Ky + y1*Kx;
+
+                T* pOut = pSen + c*RO*E1*E2 + e2*RO*E1 + e1*RO;
+
+                for (long long x = 0; x < RO; x++)
+                {
+                    long long x0 = ix[x], x1 = (Kx > 1) ? x0 + 1 : x0;
+                    value_type wx = fx[x];
+
+                    T a = (1 - wy)*((1 - wx)*g00[x0] + wx*g00[x1]) + wy*((1 - wx)*g01[x0] + wx*g01[x1]);
+                    T b = (1 - wy)*((1 - wx)*g10[x0] + wx*g10[x1]) + wy*((1 - wx)*g11[x0] + wx*g11[x1]);
+                    T s = (1 - wz)*a + wz*b;
+
+                    pOut[x] = s;
+                    nrm[x] += s.real()*s.real() + s.imag()*s.imag();
+                }
+            }
+
+            for (long long x = 0; x < RO; x++) nrm[x] = (nrm[x] > 0) ? (value_type)1.0 / std::sqrt(nrm[x]) : 0;
+
+            for (long long c = 0; c < CHA; c++)
+            {
+                T* pOut = pSen + c*RO*E1*E2 + e2*RO*E1 + e1*RO;
+                for (long long x = 0; x < RO; x++) pOut[x] *= nrm[x];
+            }
+        }
+    }
+}
+
+template<typename T>
+void coil_map_2d_Inati_fast(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t power, size_t step)
+{
+    try
+    {
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t CHA = data.get_size(2);
+
+        GADGET_CHECK_THROW(data.get_number_of_elements() == RO*E1*CHA);
+
+        if (!data.dimensions_equal(&coilMap))
+        {
+            coilMap = data;
+        }
+
+        hoNDArray<T> im(RO, E1, 1, CHA, const_cast<T*>(data.begin()));
+        hoNDArray<T> cmap(RO, E1, 1, CHA, coilMap.begin());
+
+        coil_map_Inati_fast_impl(im, cmap, ks, 1, power, step);
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Errors in coil_map_2d_Inati_fast(...) ... ");
+        throw;
+    }
+}
+
+template EXPORTMRICORE void coil_map_2d_Inati_fast(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t power, size_t step);
+template EXPORTMRICORE void coil_map_2d_Inati_fast(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t power, size_t step);
+
+// ------------------------------------------------------------------------
+
+template<typename T>
+void coil_map_3d_Inati_fast(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t power, size_t step)
+{
+    try
+    {
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t E2 = data.get_size(2);
+        size_t CHA = data.get_size(3);
+
+        GADGET_CHECK_THROW(data.get_number_of_elements() == RO*E1*E2*CHA);
+
+        if (!data.dimensions_equal(&coilMap))
+        {
+            coilMap = data;
+        }
+
+        coil_map_Inati_fast_impl(data, coilMap, ks, kz, power, step);
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Errors in coil_map_3d_Inati_fast(...) ... ");
+        throw;
+    }
+}
+
+template EXPORTMRICORE void coil_map_3d_Inati_fast(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t kz, size_t power, size_t step);
+template EXPORTMRICORE void coil_map_3d_Inati_fast(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t kz, size_t power, size_t step);
+
+// ------------------------------------------------------------------------
+
+template<typename T> void coil_map_Inati_fast(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks, size_t kz, size_t power, size_t step)
+{
+    try
+    {
+        size_t RO = data.get_size(0);
+        size_t E1 = data.get_size(1);
+        size_t E2 = data.get_size(2);
+        size_t CHA = data.get_size(3);
+
+        if (!data.dimensions_equal(&coilMap))
+        {
+            coilMap = data;
+        }
+
+        if (CHA <= 1)
+        {
+            GWARN_STREAM("coil_map_Inati_fast, CHA <= 1");
+            return;
+        }
+
+        size_t num = data.get_number_of_elements() / (RO*E1*E2*CHA);
+
+        // every coil map is computed in parallel
+        long long n;
+        for (n = 0; n < (long long)num; n++)
+        {
+            hoNDArray<T> im(RO, E1, E2, CHA, const_cast<T*>(data.begin() + n*RO*E1*E2*CHA));
+            hoNDArray<T> cmap(RO, E1, E2, CHA, coilMap.begin() + n*RO*E1*E2*CHA);
+
+            coil_map_Inati_fast_impl(im, cmap, ks, kz, power, step);
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors happened in coil_map_Inati_fast(...) ... ")
+    }
+}
+
+template EXPORTMRICORE void coil_map_Inati_fast(const hoNDArray< std::complex<float> >& data, hoNDArray< std::complex<float> >& coilMap, size_t ks, size_t kz, size_t power, size_t step);
+template EXPORTMRICORE void coil_map_Inati_fast(const hoNDArray< std::complex<double> >& data, hoNDArray< std::complex<double> >& coilMap, size_t ks, size_t kz, size_t power, size_t step);
+
 
 // ------------------------------------------------------------------------
 
@@ -54,6 +54,18 @@ namespace Gadgetron
     // data: [RO E1 E2 CHA N S SLC ...], if E2==1, the 2D coil map estimation is assumed
     template<typename T> EXPORTMRICORE void coil_map_Inati_Iter(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks=7, size_t kz=5, size_t iterNum=5, typename realType<T>::Type thres=0.001);
 
+    // the Souheil method, with the local correlation matrices computed by running box sums
+    // the cost per pixel does not depend on ks (on kz in 3D), the power iterations run on a row of pixels at once
+    // step: if > 1, the coil map is estimated every step pixels along each dimension and linearly interpolated
+    // data: [RO E1 CHA]
+    template<typename T> EXPORTMRICORE void coil_map_2d_Inati_fast(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t power = 3, size_t step = 1);
+
+    // data: [RO E1 E2 CHA]
+    template<typename T> EXPORTMRICORE void coil_map_3d_Inati_fast(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t kz = 5, size_t power = 3, size_t step = 1);
+
+    // data: [RO E1 E2 CHA N S SLC ...], if E2==1, the 2D coil map estimation is assumed
+    template<typename T> EXPORTMRICORE void coil_map_Inati_fast(const hoNDArray<T>& data, hoNDArray<T>& coilMap, size_t ks = 7, size_t kz = 5, size_t power = 3, size_t step = 1);
+
     // coil combination
     // the cha_dim = 2 for 2D case, e.g.
     // data: in image domain, at least 3D [RO E1 CHA ...]
@@ -0,0 +1,183 @@
+
+/** \file   mri_core_image_conversion.cpp
+    \brief  Conversion of float images to the fix point formats sent to the scanner, with auto scaling
+*/
+
+#include "mri_core_image_conversion.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace Gadgetron
+{
+
+namespace
+{
+    // the bin indexes are computed for a block of pixels at a time, so that this loop vectorizes
+    const size_t histogram_block = 256;
+
+    // the truncation of the clamped value is the floor, without a call to floor
+    void histogram_block_bins(const float* d, size_t N, float max_value, float bins, int* bin)
+    {
+        float last = bins - 1;
+
+        for (size_t i = 0; i < N; i++)
+        {
+            float b = (d[i] / max_value) * bins;
+            b = std::min(std::max(b, 0.0f), last);
+            bin[i] = (int)b;
+        }
+    }
+
+    // eight independent lanes, so that the comparisons do not wait for each other
+    float block_max(const float* d, size_t N)
+    {
+        float m[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+        size_t i;
+        for (i = 0; i + 8 <= N; i += 8)
+        {
+            for (size_t l = 0; l < 8; l++) m[l] = (d[i + l] > m[l]) ? d[i + l] : m[l];
+        }
+
+        for (; i < N; i++) m[0] = (d[i] > m[0]) ? d[i] : m[0];
+
+        float r = m[0];
+        for (size_t l = 1; l < 8; l++) r = std::max(r, m[l]);
+        return r;
+    }
+
+    // the rounding is added in double as in the gadgets, in float the largest values below k + 1/2 would round up to k + 1
+    template <bool magnitude, typename T>
+    void convert_block(const float* src, T* dst, size_t N, float scale, float offset, float lo, float hi, double rounding)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            float v = (magnitude ? std::abs(src[i]) : src[i]) * scale + offset;
+            v = std::min(std::max(v, lo), hi);
+            dst[i] = static_cast<T>(v + rounding);
+        }
+    }
+}
+
+float compute_histogram_percentile(const hoNDArray<float>& im, size_t histogram_bins, double fraction)
+{
+    const float* d = im.begin();
+    long long N = (long long)im.get_number_of_elements();
+
+    if (N == 0 || histogram_bins == 0) return 0;
+
+    long long numOfBlocks = (N + histogram_block - 1) / histogram_block;
+    long long b;
+
+    float max_value = 0;
+
+#pragma omp parallel if(N > 256*1024)
+    {
+        float m = 0;
+
+#pragma omp for private(b)
+        for (b = 0; b < numOfBlocks; b++)
+        {
+            size_t start = b*histogram_block;
+            size_t end = std::min((size_t)N, start + histogram_block);
+
+            m = std::max(m, block_max(d + start, end - start));
+        }
+
+#pragma omp critical
+        {
+            if (m > max_value) max_value = m;
+        }
+    }
+
+    if (!(max_value > 0)) return 0;
+
+    std::vector<size_t> histogram(histogram_bins, 0);
+
+#pragma omp parallel if(N > 256*1024)
+    {
+        std::vector<size_t> local(4 * histogram_bins, 0);
+        int bin[histogram_block];
+
+#pragma omp for private(b)
+        for (b = 0; b < numOfBlocks; b++)
+        {
+            size_t start = b*histogram_block;
+            size_t len = std::min((size_t)N - start, histogram_block);
+
+            histogram_block_bins(d + start, len, max_value, (float)histogram_bins, bin);
+
+            // neighbouring pixels mostly fall into the same bin, four copies of the histogram
+            // avoid waiting for the previous increment of the same counter
+            size_t i;
+            for (i = 0; i + 4 <= len; i += 4)
+            {
+                local[bin[i]]++;
+                local[histogram_bins + bin[i + 1]]++;
+                local[2 * histogram_bins + bin[i + 2]]++;
+                local[3 * histogram_bins + bin[i + 3]]++;
+            }
+            for (; i < len; i++) local[bin[i]]++;
+        }
+
+#pragma omp critical
+        {
+            for (size_t k = 0; k < histogram_bins; k++)
+            {
+                histogram[k] += local[k] + local[histogram_bins + k] + local[2 * histogram_bins + k] + local[3 * histogram_bins + k];
+            }
+        }
+    }
+
+    long long cumsum = 0;
+    size_t counter = 0;
+    while (counter < histogram_bins && cumsum < (fraction*N))
+    {
+        cumsum += (long long)(histogram[counter++]);
+    }
+
+    return (counter + 1)*(max_value / histogram_bins);
+}
+
+template <typename T>
+void convert_to_fix_point(const hoNDArray<float>& im, float scale, float offset, bool magnitude, bool rounding, T min_value, T max_value, hoNDArray<T>& res)
+{
+    if (!res.dimensions_equal(&im))
+    {
+        res.create(im.get_dimensions());
+    }
+
+    const float* src = im.begin();
+    T* dst = res.begin();
+
+    long long N = (long long)im.get_number_of_elements();
+
+    float lo = (float)min_value;
+    float hi = (float)max_value;
+    double r = rounding ? 0.5 : 0.0;
+
+    const long long block = 16*1024;
+    long long numOfBlocks = (N + block - 1) / block;
+    long long b;
+
+#pragma omp parallel for private(b) if(numOfBlocks > 4)
+    for (b = 0; b < numOfBlocks; b++)
+    {
+        long long start = b*block;
+        size_t len = (size_t)std::min(N - start, block);
+
+        if (magnitude)
+            convert_block<true>(src + start, dst + start, len, scale, offset, lo, hi, r);
+        else
+            convert_block<false>(src + start, dst + start, len, scale, offset, lo, hi, r);
+    }
+}
+
+template EXPORTMRICORE void convert_to_fix_point(const hoNDArray<float>& im, float scale, float offset, bool magnitude, bool rounding, unsigned short min_value, unsigned short max_value, hoNDArray<unsigned short>& res);
+template EXPORTMRICORE void convert_to_fix_point(const hoNDArray<float>& im, float scale, float offset, bool magnitude, bool rounding, short min_value, short max_value, hoNDArray<short>& res);
+template EXPORTMRICORE void convert_to_fix_point(const hoNDArray<float>& im, float scale, float offset, bool magnitude, bool rounding, unsigned int min_value, unsigned int max_value, hoNDArray<unsigned int>& res);
+template EXPORTMRICORE void convert_to_fix_point(const hoNDArray<float>& im, float scale, float offset, bool magnitude, bool rounding, int min_value, int max_value, hoNDArray<int>& res);
+
+}
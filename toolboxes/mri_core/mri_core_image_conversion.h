@@ -0,0 +1,30 @@
+
+/** \file   mri_core_image_conversion.h
+    \brief  Conversion of float images to the fix point formats sent to the scanner, with auto scaling
+*/
+
+#pragma once
+
+#include "mri_core_export.h"
+#include "hoNDArray.h"
+
+namespace Gadgetron
+{
+    /// ------------------------------------------------------------------------
+    /// auto scaling
+    /// ------------------------------------------------------------------------
+    /// intensity at the given fraction of the histogram of a magnitude image, as computed by AutoScaleGadget
+    /// the histogram has histogram_bins bins between 0 and the maximum of the image
+    /// the upper bound of the bin where the cumulative count reaches fraction*N, plus one bin width, is returned
+    /// if the maximum is not positive, 0 is returned
+    EXPORTMRICORE float compute_histogram_percentile(const hoNDArray<float>& im, size_t histogram_bins = 100, double fraction = 0.99);
+
+    /// ------------------------------------------------------------------------
+    /// fix point conversion
+    /// ------------------------------------------------------------------------
+    /// res = clamp( scale*(magnitude ? |im| : im) + offset, min_value, max_value ), converted to T
+    /// if rounding is true, the value is rounded to the nearest integer; otherwise it is truncated
+    /// scaling, clamping and conversion are done in one pass over the image
+    /// T: unsigned short, short, unsigned int, int
+    template <typename T> EXPORTMRICORE void convert_to_fix_point(const hoNDArray<float>& im, float scale, float offset, bool magnitude, bool rounding, T min_value, T max_value, hoNDArray<T>& res);
+}
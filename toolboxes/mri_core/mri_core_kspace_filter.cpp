@@ -1066,4 +1066,176 @@ void compute_filter_SNR_unit_scale_factor(const hoNDArray< std::complex<double>
 
 // ------------------------------------------------------------------------
 
+namespace
+{
+    /// modified Bessel function of the first kind, order 0
+    double bessel_i0(double x)
+    {
+        double sum = 1, term = 1;
+        double x2 = x*x / 4;
+
+        for (size_t k = 1; k < 100; k++)
+        {
+            term *= x2 / (double)(k*k);
+            sum += term;
+            if (term < sum*1e-16) break;
+        }
+
+        return sum;
+    }
+}
+
+template <typename T>
+void generate_ro_oversampling_filter(size_t len, size_t num_taps, double beta, ROOversamplingFilter<T>& filter)
+{
+    try
+    {
+        GADGET_CHECK_THROW(len >= 2 && len % 2 == 0);
+
+        size_t M = len / 2;
+        if (num_taps == 0 || num_taps > M) num_taps = M;
+
+        filter.len = len;
+        filter.taps.resize(num_taps);
+
+        // scaling of the ifft and fft
+        double norm = 1.0 / std::sqrt((double)len*M);
+        filter.center = (T)(M*norm);
+
+        // h(d) = norm * i * (-i)^d * exp(-i*pi*d/len) / sin(pi*d/len) for odd d
+        // the phase exp(-i*pi*(n-2m)/len) is split into pre and post, leaving real taps which are symmetric in d
+        double w0 = bessel_i0(beta);
+
+        size_t j;
+        for (j = 1; j <= num_taps; j++)
+        {
+            double d = (double)(2 * j - 1);
+            double r = ((j % 2) ? 1.0 : -1.0) / std::sin(M_PI*d / len);
+
+            double t = d / (2.0*num_taps);
+            double w = bessel_i0(beta*std::sqrt(1.0 - t*t)) / w0;
+
+            filter.taps[j - 1] = (T)(r*w*norm);
+        }
+
+        filter.pre.create(M);
+        filter.post.create(M);
+
+        size_t k;
+        for (k = 0; k < M; k++)
+        {
+            double a = -M_PI*(2 * k + 1) / len;
+            filter.pre(k) = std::complex<T>((T)std::cos(a), (T)std::sin(a));
+
+            double b = 2 * M_PI*k / len;
+            filter.post(k) = std::complex<T>((T)std::cos(b), (T)std::sin(b));
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in generate_ro_oversampling_filter(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void generate_ro_oversampling_filter(size_t len, size_t num_taps, double beta, ROOversamplingFilter<float>& filter);
+template EXPORTMRICORE void generate_ro_oversampling_filter(size_t len, size_t num_taps, double beta, ROOversamplingFilter<double>& filter);
+
+// ------------------------------------------------------------------------
+
+template <typename T>
+void remove_ro_oversampling(const hoNDArray< std::complex<T> >& data, const ROOversamplingFilter<T>& filter, hoNDArray< std::complex<T> >& res)
+{
+    try
+    {
+        size_t RO = data.get_size(0);
+        GADGET_CHECK_THROW(RO == filter.len);
+        GADGET_CHECK_THROW(data.begin() != res.begin());
+
+        size_t M = RO / 2;
+        size_t L = filter.taps.size();
+        size_t N = data.get_number_of_elements() / RO;
+
+        std::vector<size_t> dim;
+        data.get_dimensions(dim);
+        dim[0] = M;
+        res.create(dim);
+
+        const std::complex<T>* pData = data.begin();
+        std::complex<T>* pRes = res.begin();
+
+        const T* taps = &filter.taps[0];
+        const std::complex<T>* pre = filter.pre.begin();
+        const std::complex<T>* post = filter.post.begin();
+        T center = filter.center;
+
+        long long n;
+
+#pragma omp parallel default(none) private(n) shared(N, M, L, RO, pData, pRes, taps, pre, post, center) if(N*RO > 64*1024)
+        {
+            // odd samples with the pre phase, with L zeros on both sides, and the filtered odd samples
+            // real and imaginary parts are kept apart so that the tap loop is a plain loop over floats
+            std::vector<T> odd_re(M + 2 * L, 0), odd_im(M + 2 * L, 0);
+            std::vector<T> acc_re(M), acc_im(M);
+
+#pragma omp for
+            for (n = 0; n < (long long)N; n++)
+            {
+                const std::complex<T>* x = pData + n*RO;
+                std::complex<T>* y = pRes + n*M;
+
+                size_t k, m, j;
+                for (k = 0; k < M; k++)
+                {
+                    T a = x[2 * k + 1].real();
+                    T b = x[2 * k + 1].imag();
+                    odd_re[L + k] = a*pre[k].real() - b*pre[k].imag();
+                    odd_im[L + k] = a*pre[k].imag() + b*pre[k].real();
+                }
+
+                for (m = 0; m < M; m++)
+                {
+                    acc_re[m] = 0;
+                    acc_im[m] = 0;
+                }
+
+                T* pAccRe = &acc_re[0];
+                T* pAccIm = &acc_im[0];
+
+                // tap j pairs the odd samples m+j-1 and m-j
+                for (j = 1; j <= L; j++)
+                {
+                    T h = taps[j - 1];
+
+                    const T* pRe1 = &odd_re[L + j - 1];
+                    const T* pRe2 = &odd_re[L - j];
+                    const T* pIm1 = &odd_im[L + j - 1];
+                    const T* pIm2 = &odd_im[L - j];
+
+                    for (m = 0; m < M; m++)
+                    {
+                        pAccRe[m] += h * (pRe1[m] + pRe2[m]);
+                        pAccIm[m] += h * (pIm1[m] + pIm2[m]);
+                    }
+                }
+
+                for (m = 0; m < M; m++)
+                {
+                    T re = center*x[2 * m].real() + post[m].real()*pAccRe[m] - post[m].imag()*pAccIm[m];
+                    T im = center*x[2 * m].imag() + post[m].real()*pAccIm[m] + post[m].imag()*pAccRe[m];
+                    y[m] = std::complex<T>(re, im);
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        GADGET_THROW("Errors in remove_ro_oversampling(...) ... ");
+    }
+}
+
+template EXPORTMRICORE void remove_ro_oversampling(const hoNDArray< std::complex<float> >& data, const ROOversamplingFilter<float>& filter, hoNDArray< std::complex<float> >& res);
+template EXPORTMRICORE void remove_ro_oversampling(const hoNDArray< std::complex<double> >& data, const ROOversamplingFilter<double>& filter, hoNDArray< std::complex<double> >& res);
+
+// ------------------------------------------------------------------------
+
 }
@@ -91,4 +91,38 @@ namespace Gadgetron
 
     /// compute the filter SNR unit scale factor
     template <typename T> EXPORTMRICORE void compute_filter_SNR_unit_scale_factor(const hoNDArray<T>& filter, T& scalFactor);
+
+    /// ------------------------------------------------------------------------
+    /// readout oversampling removal
+    /// ------------------------------------------------------------------------
+    /// removing 2x readout oversampling with ifft along RO, cropping the central half of the image and fft back
+    /// is, in kspace, a half-band filter followed by decimation: y[m] = sum_n x[n] h(n-2m)
+    /// apart from the center, only the odd taps of h are non-zero; they decay as 1/|n-2m|
+    /// the filter keeps num_taps odd taps on each side of the center, tapered with a Kaiser window
+    /// num_taps >= RO/2 and beta = 0 give the fft result; fewer taps leave a transition band at the edges of the field of view
+    template <typename T>
+    struct ROOversamplingFilter
+    {
+        ROOversamplingFilter() : len(0), center(0) {}
+
+        /// length of the oversampled readout
+        size_t len;
+        /// odd taps 1, 3, ..., 2*num_taps-1, real and symmetric
+        std::vector<T> taps;
+        /// weight of the center tap
+        T center;
+        /// [len/2] phase applied to the odd samples before the filter
+        hoNDArray< std::complex<T> > pre;
+        /// [len/2] phase applied to the filtered odd samples
+        hoNDArray< std::complex<T> > post;
+    };
+
+    /// len: length of the oversampled readout, must be even
+    /// num_taps: number of odd taps on each side, 0 means all taps
+    /// beta: Kaiser window parameter
+    template <typename T> EXPORTMRICORE void generate_ro_oversampling_filter(size_t len, size_t num_taps, double beta, ROOversamplingFilter<T>& filter);
+
+    /// data: [RO ...] readouts in kspace, RO == filter.len
+    /// res: [RO/2 ...]
+    template <typename T> EXPORTMRICORE void remove_ro_oversampling(const hoNDArray< std::complex<T> >& data, const ROOversamplingFilter<T>& filter, hoNDArray< std::complex<T> >& res);
 }
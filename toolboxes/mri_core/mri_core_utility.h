@@ -40,7 +40,8 @@ namespace Gadgetron
     /// if average_N==true or average_S==true, data will first be averaged along N or S
     /// if coil_compression_thres>0 or compression_num_modesKept>0, the number of kept channels is determine; compression_num_modesKept has the priority if it is set
     /// for all N, S and SLC, the same number of channels is kept. This number is either set by compression_num_modesKept or automatically determined in the first KLT prepare call
-    template <typename T> EXPORTMRICORE void compute_eigen_channel_coefficients(const hoNDArray<T>& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT<T> > > >& KLT);
+    /// method selects how the KLT is computed, see hoNDKLT.h
+    template <typename T> EXPORTMRICORE void compute_eigen_channel_coefficients(const hoNDArray<T>& data, bool average_N, bool average_S, bool count_sampling_freq, size_t N, size_t S, double coil_compression_thres, size_t compression_num_modesKept, std::vector< std::vector< std::vector< hoNDKLT<T> > > >& KLT, KLTMethod method = KLT_SVD);
 
     /// apply eigen channel coefficients
     /// apply KLT coefficients to data for every N, S, and SLC
@@ -633,6 +633,16 @@ void hoWavelet2DTOperator<T>::proximity(hoNDArray<T>& wavCoeff, value_type thres
 {
     try
     {
+        if (!this->proximity_across_cha_
+            && std::abs(scale_factor_first_dimension_ - 1.0) <= 1e-6
+            && std::abs(scale_factor_second_dimension_ - 1.0) <= 1e-6
+            && std::abs(scale_factor_third_dimension_ - 1.0) <= 1e-6)
+        {
+            // same threshold for all coefficients, soft thresholding in one pass
+            p_active_wav_->shrink(wavCoeff, 3, num_of_wav_levels_, thres, with_approx_coeff_);
+            return;
+        }
+
         if (this->proximity_across_cha_)
         {
             this->L1Norm(wavCoeff, wav_coeff_norm_);
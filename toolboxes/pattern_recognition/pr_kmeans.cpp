@@ -23,6 +23,9 @@ kmeans<T>::kmeans()
     max_iter_ = 100;
     replicates_ = 10;
     perform_online_update_ = true;
+    perform_bounded_update_ = true;
+    block_size_ = 4096;
+    perform_parallel_replicates_ = true;
 
     verbose_ = false;
     perform_timing_ = false;
@@ -341,26 +344,51 @@ void kmeans<T>::run_replicates(const ArrayType& X, size_t K, const ArrayType& C_
         sumD_rep.resize(R, 0);
 
         size_t r;
-        for (r=0; r<R; r++)
+
+        if (this->perform_parallel_replicates_ && R>1)
         {
-            std::stringstream outs;
-            outs << "-----> Kmeans, replicate " << r << " out of " << R;
+            // run() sets replicates_ to the number of replicates in its initial centroids, which is 1 here
+            this->replicates_ = 1;
 
-            if (this->verbose_)
+            long long rr;
+
+#pragma omp parallel for default(none) private(rr) shared(R, P, K, X, C_for_initial, IDX_rep, C_rep, sumD_rep) schedule(dynamic, 1)
+            for (rr=0; rr<(long long)R; rr++)
             {
-                GDEBUG_STREAM(outs.str());
+                ArrayType curr_C_initial;
+                curr_C_initial.create(P, K, const_cast<T*>(&C_for_initial(0, 0, rr)) );
+
+                this->run(X, K, curr_C_initial, IDX_rep[rr], C_rep[rr], sumD_rep[rr]);
+
+                if(this->verbose_)
+                {
+                    GDEBUG_STREAM("Kmeans, replicate " << rr << " out of " << R << " - " << sumD_rep[rr]);
+                }
             }
+        }
+        else
+        {
+            for (r=0; r<R; r++)
+            {
+                std::stringstream outs;
+                outs << "-----> Kmeans, replicate " << r << " out of " << R;
 
-            ArrayType curr_C_initial;
-            curr_C_initial.create(P, K, const_cast<T*>(&C_for_initial(0, 0, r)) );
+                if (this->verbose_)
+                {
+                    GDEBUG_STREAM(outs.str());
+                }
 
-            if (this->perform_timing_) timer.start(outs.str().c_str());
-            this->run(X, K, curr_C_initial, IDX_rep[r], C_rep[r], sumD_rep[r]);
-            if (this->perform_timing_) timer.stop();
+                ArrayType curr_C_initial;
+                curr_C_initial.create(P, K, const_cast<T*>(&C_for_initial(0, 0, r)) );
 
-            if(this->verbose_)
-            {
-                GDEBUG_STREAM("Kmeans, replicate " << r << " out of " << R << " - " << sumD_rep[r]);
+                if (this->perform_timing_) timer.start(outs.str().c_str());
+                this->run(X, K, curr_C_initial, IDX_rep[r], C_rep[r], sumD_rep[r]);
+                if (this->perform_timing_) timer.stop();
+
+                if(this->verbose_)
+                {
+                    GDEBUG_STREAM("Kmeans, replicate " << r << " out of " << R << " - " << sumD_rep[r]);
+                }
             }
         }
 
@@ -398,7 +426,7 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
         GADGET_CHECK_THROW(C_for_initial.get_size(0) == P);
         GADGET_CHECK_THROW(C_for_initial.get_size(1) == K);
 
-        this->replicates_ = C_for_initial.get_size(2);
+        if (this->replicates_ != C_for_initial.get_size(2)) this->replicates_ = C_for_initial.get_size(2);
 
         IDX.resize(N, 0);
         C.create(P, K);
@@ -421,8 +449,38 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
             norm_C[k] = v;
         }
 
+        // norm of samples and distance bounds for the bounded update
+        VectorType norm_X, upper, lower;
+        ArrayType prev_C;
+        bool bounds_valid = false;
+
         // first round of clustering
-        this->update_IDX(X, C, norm_C, IDX);
+        if (this->perform_bounded_update_)
+        {
+            norm_X.resize(N, 0);
+
+            const T* pX = X.begin();
+
+            long long n;
+#pragma omp parallel for default(none) private(n, p) shared(N, P, pX, norm_X)
+            for (n=0; n<(long long)N; n++)
+            {
+                T v = 0;
+                for (p=0; p<P; p++)
+                {
+                    v += pX[p + n*P] * pX[p + n*P];
+                }
+
+                norm_X[n] = v;
+            }
+
+            this->update_IDX_blocked(X, norm_X, C, norm_C, IDX, upper, lower);
+            bounds_valid = true;
+        }
+        else
+        {
+            this->update_IDX(X, C, norm_C, IDX);
+        }
 
         ClusterType prev_IDX;
         ArrayType D, D_norm;
@@ -436,10 +494,22 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
         {
             prev_IDX = IDX;
 
+            if (this->perform_bounded_update_)
+            {
+                prev_C = C;
+            }
+
             // update the centroid
             this->update_centroid(X, IDX, C, norm_C);
             // update clustering
-            this->update_IDX(X, C, norm_C, IDX);
+            if (this->perform_bounded_update_)
+            {
+                this->update_IDX_bounded(X, norm_X, C, prev_C, norm_C, IDX, upper, lower, bounds_valid);
+            }
+            else
+            {
+                this->update_IDX(X, C, norm_C, IDX);
+            }
 
             this->compute_dist(X, IDX, C, D);
             this->compute_norm_dist(D, D_norm);
@@ -473,6 +543,9 @@ void kmeans<T>::run(const ArrayType& X, size_t K, const ArrayType& C_for_initial
                     this->compute_dist(X, IDX, C, D);
                     this->compute_norm_dist(D, D_norm);
                 }
+
+                // centroids were moved outside the batch update, bounds must be recomputed
+                bounds_valid = false;
             }
 
             sumD = 0;
@@ -639,6 +712,250 @@ void kmeans<T>::update_IDX(const ArrayType& X, const ArrayType& C, const VectorT
     }
 }
 
+template <typename T>
+void kmeans<T>::update_IDX_blocked(const ArrayType& X, const VectorType& norm_X, const ArrayType& C, const VectorType& norm_C, ClusterType& IDX, VectorType& upper, VectorType& lower)
+{
+    try
+    {
+        size_t P = X.get_size(0);
+        size_t N = X.get_size(1);
+
+        size_t K = C.get_size(1);
+
+        GADGET_CHECK_THROW(norm_X.size() == N);
+        GADGET_CHECK_THROW(norm_C.size() >= K);
+
+        IDX.resize(N);
+        upper.resize(N);
+        lower.resize(N);
+
+        size_t block_size = this->block_size_;
+        if (block_size == 0 || block_size > N) block_size = N;
+
+        long long num_blocks = (long long)((N + block_size - 1) / block_size);
+
+        T max_norm_C = 0;
+        size_t k;
+        for (k = 0; k < K; k++)
+        {
+            if (norm_C[k] > max_norm_C) max_norm_C = norm_C[k];
+        }
+
+        // |x|^2 - 2<c,x> + |c|^2 suffers from cancellation, so the lower bound is reduced by its rounding error
+        T margin = (T)(2 * P + 8) * std::numeric_limits<T>::epsilon();
+
+        const T* pX = X.begin();
+        const T* pC = C.begin();
+
+        long long b;
+
+#pragma omp parallel for default(none) private(b) shared(num_blocks, block_size, N, P, K, C, pX, pC, norm_X, norm_C, IDX, upper, lower, margin, max_norm_C)
+        for (b = 0; b < num_blocks; b++)
+        {
+            size_t start = b*block_size;
+            size_t num = ((start + block_size) > N) ? (N - start) : block_size;
+
+            ArrayType Xb;
+            Xb.create(P, num, const_cast<T*>(pX + start*P));
+
+            ArrayType CX;
+            Gadgetron::gemm(CX, C, true, Xb, false);
+
+            const T* pCX = CX.begin();
+
+            size_t t, s, p;
+            for (t = 0; t < num; t++)
+            {
+                size_t n = start + t;
+
+                size_t best = 0;
+                T best_v = norm_C[0] - 2 * pCX[t*K];
+                T second_v = std::numeric_limits<T>::max();
+
+                for (s = 1; s < K; s++)
+                {
+                    T v = norm_C[s] - 2 * pCX[s + t*K];
+                    if (v < best_v)
+                    {
+                        second_v = best_v;
+                        best_v = v;
+                        best = s;
+                    }
+                    else if (v < second_v)
+                    {
+                        second_v = v;
+                    }
+                }
+
+                IDX[n] = best;
+
+                // exact distance to its own centroid
+                T d = 0;
+                for (p = 0; p < P; p++)
+                {
+                    T v = pX[p + n*P] - pC[p + best*P];
+                    d += v*v;
+                }
+                upper[n] = std::sqrt(d);
+
+                if (K > 1)
+                {
+                    T d2 = second_v + norm_X[n] - margin * (norm_X[n] + max_norm_C);
+                    lower[n] = (d2 > 0) ? std::sqrt(d2) : 0;
+                }
+                else
+                {
+                    lower[n] = std::numeric_limits<T>::max();
+                }
+            }
+        }
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Exceptions happened in kmeans<T>::update_IDX_blocked(...) ... ");
+    }
+}
+
+template <typename T>
+void kmeans<T>::update_IDX_bounded(const ArrayType& X, const VectorType& norm_X, const ArrayType& C, const ArrayType& prev_C, const VectorType& norm_C, ClusterType& IDX, VectorType& upper, VectorType& lower, bool& bounds_valid)
+{
+    try
+    {
+        size_t P = X.get_size(0);
+        size_t N = X.get_size(1);
+
+        size_t K = C.get_size(1);
+
+        if (!bounds_valid || IDX.size() != N || upper.size() != N || lower.size() != N || prev_C.get_number_of_elements() != C.get_number_of_elements())
+        {
+            this->update_IDX_blocked(X, norm_X, C, norm_C, IDX, upper, lower);
+            bounds_valid = true;
+            return;
+        }
+
+        const T* pX = X.begin();
+        const T* pC = C.begin();
+        const T* pPrevC = prev_C.begin();
+
+        size_t k, j, p;
+
+        // how far every centroid moved
+        VectorType delta(K, 0);
+        for (k = 0; k < K; k++)
+        {
+            T d = 0;
+            for (p = 0; p < P; p++)
+            {
+                T v = pC[p + k*P] - pPrevC[p + k*P];
+                d += v*v;
+            }
+            delta[k] = std::sqrt(d);
+        }
+
+        // largest and second largest move
+        size_t k_max = 0;
+        T delta_max = 0, delta_second = 0;
+        for (k = 0; k < K; k++)
+        {
+            if (delta[k] > delta_max)
+            {
+                delta_second = delta_max;
+                delta_max = delta[k];
+                k_max = k;
+            }
+            else if (delta[k] > delta_second)
+            {
+                delta_second = delta[k];
+            }
+        }
+
+        // half distance from every centroid to its closest other centroid
+        VectorType half_dist(K, std::numeric_limits<T>::max());
+        for (k = 0; k < K; k++)
+        {
+            for (j = k + 1; j < K; j++)
+            {
+                T d = 0;
+                for (p = 0; p < P; p++)
+                {
+                    T v = pC[p + k*P] - pC[p + j*P];
+                    d += v*v;
+                }
+                d = std::sqrt(d) / 2;
+
+                if (d < half_dist[k]) half_dist[k] = d;
+                if (d < half_dist[j]) half_dist[j] = d;
+            }
+        }
+
+        long long n;
+
+#pragma omp parallel for default(none) private(n, k, p) shared(N, P, K, pX, pC, IDX, upper, lower, delta, k_max, delta_max, delta_second, half_dist)
+        for (n = 0; n < (long long)N; n++)
+        {
+            size_t a = IDX[n];
+
+            upper[n] += delta[a];
+            lower[n] -= (a == k_max) ? delta_second : delta_max;
+
+            T m = (half_dist[a] > lower[n]) ? half_dist[a] : lower[n];
+            if (upper[n] <= m) continue;
+
+            // tighten the upper bound
+            T d = 0;
+            for (p = 0; p < P; p++)
+            {
+                T v = pX[p + n*P] - pC[p + a*P];
+                d += v*v;
+            }
+            upper[n] = std::sqrt(d);
+            if (upper[n] <= m) continue;
+
+            // bounds failed, compute distances to all centroids
+            size_t best = 0;
+            T best_d = std::numeric_limits<T>::max();
+            T second_d = std::numeric_limits<T>::max();
+
+            for (k = 0; k < K; k++)
+            {
+                if (k == a)
+                {
+                    d = upper[n];
+                }
+                else
+                {
+                    d = 0;
+                    for (p = 0; p < P; p++)
+                    {
+                        T v = pX[p + n*P] - pC[p + k*P];
+                        d += v*v;
+                    }
+                    d = std::sqrt(d);
+                }
+
+                if (d < best_d)
+                {
+                    second_d = best_d;
+                    best_d = d;
+                    best = k;
+                }
+                else if (d < second_d)
+                {
+                    second_d = d;
+                }
+            }
+
+            IDX[n] = best;
+            upper[n] = best_d;
+            lower[n] = second_d;
+        }
+    }
+    catch (...)
+    {
+        GERROR_STREAM("Exceptions happened in kmeans<T>::update_IDX_bounded(...) ... ");
+    }
+}
+
 template <typename T>
 void kmeans<T>::update_centroid(const ArrayType& X, const ClusterType& IDX, ArrayType& C, VectorType& norm_C)
 {
@@ -847,49 +1164,95 @@ void kmeans<T>::perform_online_update(const ArrayType& X, ClusterType& IDX, Arra
         size_t nummoved = 0;
         ClusterType prevIDX, newIDX(IDX);
 
+        // a move only changes the centroids and sizes of the two clusters involved,
+        // so only their columns of del_cost need to be recomputed
+        std::vector<size_t> clusters_to_update(K);
+        for (k = 0; k < K; k++) clusters_to_update[k] = k;
+
+        // minimal del_cost of every point, kept together with newIDX
+        VectorType min_del_cost(N, 0);
+
+        long long nn;
+
         while (iter < this->max_iter_)
         {
             // for every cluster K and every point N
             // compute change of delta sum cost
-            for (k = 0; k < K; k++)
+            for (size_t ik = 0; ik < clusters_to_update.size(); ik++)
             {
-                for (n = 0; n < N; n++)
+                k = clusters_to_update[ik];
+                const T* pC = &C(0, k);
+                size_t num_pt = num_pt_clusters[k];
+
+#pragma omp parallel for default(none) private(nn, p) shared(N, P, k, pX, pC, num_pt, IDX, del_cost)
+                for (nn = 0; nn < (long long)N; nn++)
                 {
                     T v;
-                    if (IDX[n] == k)
+                    if (IDX[nn] == k)
                     {
-                        if (num_pt_clusters[k] > 1)
-                            v = (T)num_pt_clusters[k] / (T)(num_pt_clusters[k] - 1);
+                        if (num_pt > 1)
+                            v = (T)num_pt / (T)(num_pt - 1);
                         else
                             v = 1;
                     }
                     else
-                        v = (T)num_pt_clusters[k] / (T)(num_pt_clusters[k] + 1);
+                        v = (T)num_pt / (T)(num_pt + 1);
 
                     T t(0), d = 0;
                     for (p = 0; p < P; p++)
                     {
-                        t = X(p, n) - C(p, k);
+                        t = pX[p + nn*P] - pC[p];
                         d += t*t;
                     }
 
-                    del_cost(n, k) = v * d;
+                    del_cost(nn, k) = v * d;
                 }
             }
 
             prevIDX = IDX;
 
             // get the new IDX
-            for (n = 0; n < N; n++)
+            // if the current minimum of a point is not in an updated cluster, only the updated clusters need to be compared
+            bool full_search = (clusters_to_update.size() == K);
+            size_t num_update = clusters_to_update.size();
+
+#pragma omp parallel for default(none) private(nn, k) shared(N, K, newIDX, min_del_cost, del_cost, full_search, num_update, clusters_to_update)
+            for (nn = 0; nn < (long long)N; nn++)
             {
-                newIDX[n] = 0;
-                T min_del_cost = del_cost(n, 0);
-                for (k = 1; k < K; k++)
+                size_t ik;
+
+                bool search_all = full_search;
+                if (!search_all)
+                {
+                    for (ik = 0; ik < num_update; ik++)
+                    {
+                        if (newIDX[nn] == clusters_to_update[ik]) search_all = true;
+                    }
+                }
+
+                if (search_all)
+                {
+                    newIDX[nn] = 0;
+                    min_del_cost[nn] = del_cost(nn, 0);
+                    for (k = 1; k < K; k++)
+                    {
+                        if(del_cost(nn, k) < min_del_cost[nn])
+                        {
+                            newIDX[nn] = k;
+                            min_del_cost[nn] = del_cost(nn, k);
+                        }
+                    }
+                }
+                else
                 {
-                    if(del_cost(n, k) < min_del_cost)
+                    for (ik = 0; ik < num_update; ik++)
                     {
-                        newIDX[n] = k;
-                        min_del_cost = del_cost(n, k);
+                        k = clusters_to_update[ik];
+                        if ( (del_cost(nn, k) < min_del_cost[nn]) || (del_cost(nn, k) == min_del_cost[nn] && k < newIDX[nn]) )
+                        {
+                            newIDX[nn] = k;
+                            min_del_cost[nn] = del_cost(nn, k);
+                        }
                     }
                 }
             }
@@ -911,24 +1274,19 @@ void kmeans<T>::perform_online_update(const ArrayType& X, ClusterType& IDX, Arra
                 break;
             }
 
-            // pick a point to move
-            int moved_ind = N+1;
-            int tt(0);
+            // pick the first candidate after the last moved point, cyclically
+            size_t moved_ind = moved[0];
+            size_t min_offset = N;
             for (size_t ii = 0; ii < moved.size(); ii++)
             {
-                tt = (int)moved[ii] - (int)lastmoved - 1;
-                if (tt < 0) tt += N;
-                if (tt >= N) tt -= N;
-
-                tt += lastmoved;
-
-                if (tt < moved_ind) moved_ind = tt;
+                size_t offset = (moved[ii] + N - lastmoved - 1) % N;
+                if (offset < min_offset)
+                {
+                    min_offset = offset;
+                    moved_ind = moved[ii];
+                }
             }
 
-            if (tt < 0) tt += N;
-            if (tt >= N) tt -= N;
-            moved_ind = (size_t)(tt);
-
             if(moved_ind<=lastmoved)
             {
                 iter++;
@@ -954,6 +1312,10 @@ void kmeans<T>::perform_online_update(const ArrayType& X, ClusterType& IDX, Arra
                 C(p, nidx) = C(p, nidx) + (X(p, moved_ind) - C(p, nidx)) / num_pt_clusters[nidx];
                 C(p, oidx) = C(p, oidx) - (X(p, moved_ind) - C(p, oidx)) / num_pt_clusters[oidx];
             }
+
+            clusters_to_update.resize(2);
+            clusters_to_update[0] = oidx;
+            clusters_to_update[1] = nidx;
         }
     }
     catch (...)
@@ -29,6 +29,11 @@ namespace Gadgetron {
 // online update: the kmeans can optionally use the so-called "online" update. In this process, every data point is reallocated to all clusters and the
 // delta change of adding or removing this point is computed; those moves which will reduce the total sum cost will be performed.
 //
+// bounded update: the batch iterations can optionally use the bounds from G. Hamerly, Making k-means even faster, SDM 2010;
+// every point keeps an upper bound of the distance to its own centroid and a lower bound of the distance to the second closest centroid;
+// distances are only recomputed for points whose bounds can no longer prove the current assignment. The full assignment is computed
+// blockwise with gemm. The clustering results are the same as the plain batch iterations, except for rounding in near ties.
+//
 // output
 // IDX : [N 1] array, indicating to which clusters every data sample belongs (first cluster has index 0)
 // C : [P K], K centroids
@@ -65,6 +70,15 @@ public:
     // whether to perform on-line update
     bool perform_online_update_;
 
+    // whether to use the triangle inequality bounds to skip distance computations in batch iterations
+    bool perform_bounded_update_;
+
+    // number of samples in one block of the gemm distance computation
+    size_t block_size_;
+
+    // whether to run the replicates in parallel
+    bool perform_parallel_replicates_;
+
     // ======================================================================================
     /// parameter for debugging
     // ======================================================================================
@@ -109,6 +123,16 @@ public:
     /// norm_C is the norm of centroid, dot(C,C,1)
     void update_IDX(const ArrayType& X, const ArrayType& C, const VectorType& norm_C, ClusterType& IDX);
 
+    /// given the current centroids, update the IDX with blocked gemm
+    /// norm_X is the norm of samples, dot(X,X,1)
+    /// upper: distance from every point to its own centroid
+    /// lower: lower bound of distance from every point to its second closest centroid
+    void update_IDX_blocked(const ArrayType& X, const VectorType& norm_X, const ArrayType& C, const VectorType& norm_C, ClusterType& IDX, VectorType& upper, VectorType& lower);
+
+    /// given the current and previous centroids, update the IDX using the bounds
+    /// if bounds_valid is false, the bounds are recomputed with update_IDX_blocked
+    void update_IDX_bounded(const ArrayType& X, const VectorType& norm_X, const ArrayType& C, const ArrayType& prev_C, const VectorType& norm_C, ClusterType& IDX, VectorType& upper, VectorType& lower, bool& bounds_valid);
+
     /// update centroids, given the IDX
     void update_centroid(const ArrayType& X, const ClusterType& IDX, ArrayType& C, VectorType& norm_C);
 
@@ -50,6 +50,7 @@ namespace Gadgetron {
         typedef Target2DType Source3DType;
 
         typedef hoNDInterpolator<SourceType> InterpolatorType;
+        typedef typename InterpolatorType::coord_type interp_coord_type;
 
         typedef hoImageRegTransformation<CoordType, DIn, DOut> TransformationType;
         typedef hoImageRegDeformationField<CoordType, DIn> DeformTransformationType;
@@ -176,9 +177,15 @@ namespace Gadgetron {
                     {
                         coord_type px, py, px_source, py_source, ix_source, iy_source;
 
+                        std::vector<interp_coord_type> xs(sx), ys(sx);
+                        std::vector<ValueType> vals(sx);
+                        std::vector<size_t> ind(sx);
+
                         // #pragma omp for 
                         for ( y=0; y<(long long)sy; y++ )
                         {
+                            size_t num = 0;
+
                             for ( size_t x=0; x<sx; x++ )
                             {
                                 size_t offset = x + y*sx;
@@ -194,10 +201,15 @@ namespace Gadgetron {
                                     // world to source
                                     source.world_to_image(px_source, py_source, ix_source, iy_source);
 
-                                    // interpolate the source
-                                    warped( offset ) = (*interp_)(ix_source, iy_source);
+                                    xs[num] = ix_source;
+                                    ys[num] = iy_source;
+                                    ind[num++] = offset;
                                 }
                             }
+
+                            // interpolate the source for all warped pixels of this row
+                            interp_->interpolate(num, &xs[0], &ys[0], &vals[0]);
+                            for ( size_t n=0; n<num; n++ ) warped( ind[n] ) = vals[n];
                         }
                     }
                 }
@@ -207,9 +219,15 @@ namespace Gadgetron {
                     {
                         coord_type ix_source, iy_source;
 
+                        std::vector<interp_coord_type> xs(sx), ys(sx);
+                        std::vector<ValueType> vals(sx);
+                        std::vector<size_t> ind(sx);
+
                         // #pragma omp for 
                         for ( y=0; y<(long long)sy; y++ )
                         {
+                            size_t num = 0;
+
                             for ( size_t x=0; x<sx; x++ )
                             {
                                 size_t offset = x + y*sx;
@@ -219,10 +237,15 @@ namespace Gadgetron {
                                     // transform the point
                                     transform_->transform(x, size_t(y), ix_source, iy_source);
 
-                                    // interpolate the source
-                                    warped( offset ) = (*interp_)(ix_source, iy_source);
+                                    xs[num] = ix_source;
+                                    ys[num] = iy_source;
+                                    ind[num++] = offset;
                                 }
                             }
+
+                            // interpolate the source for all warped pixels of this row
+                            interp_->interpolate(num, &xs[0], &ys[0], &vals[0]);
+                            for ( size_t n=0; n<num; n++ ) warped( ind[n] ) = vals[n];
                         }
                     }
                 }
@@ -241,12 +264,17 @@ namespace Gadgetron {
                     {
                         coord_type px, py, pz, px_source, py_source, pz_source, ix_source, iy_source, iz_source;
 
+                        std::vector<interp_coord_type> xs(sx), ys(sx), zs(sx);
+                        std::vector<ValueType> vals(sx);
+                        std::vector<size_t> ind(sx);
+
                         #pragma omp for 
                         for ( z=0; z<(long long)sz; z++ )
                         {
                             for ( size_t y=0; y<sy; y++ )
                             {
                                 size_t offset = y*sx + z*sx*sy;
+                                size_t num = 0;
 
                                 for ( size_t x=0; x<sx; x++ )
                                 {
@@ -261,10 +289,16 @@ namespace Gadgetron {
                                         // world to source
                                         source.world_to_image(px_source, py_source, pz_source, ix_source, iy_source, iz_source);
 
-                                        // interpolate the source
-                                        warped( x+offset ) = (*interp_)(ix_source, iy_source, iz_source);
+                                        xs[num] = ix_source;
+                                        ys[num] = iy_source;
+                                        zs[num] = iz_source;
+                                        ind[num++] = x+offset;
                                     }
                                 }
+
+                                // interpolate the source for all warped pixels of this row
+                                interp_->interpolate(num, &xs[0], &ys[0], &zs[0], &vals[0]);
+                                for ( size_t n=0; n<num; n++ ) warped( ind[n] ) = vals[n];
                             }
                         }
                     }
@@ -275,12 +309,17 @@ namespace Gadgetron {
                     {
                         coord_type ix_source, iy_source, iz_source;
 
+                        std::vector<interp_coord_type> xs(sx), ys(sx), zs(sx);
+                        std::vector<ValueType> vals(sx);
+                        std::vector<size_t> ind(sx);
+
                         #pragma omp for 
                         for ( z=0; z<(long long)sz; z++ )
                         {
                             for ( size_t y=0; y<sy; y++ )
                             {
                                 size_t offset = y*sx + z*sx*sy;
+                                size_t num = 0;
 
                                 for ( size_t x=0; x<sx; x++ )
                                 {
@@ -289,10 +328,16 @@ namespace Gadgetron {
                                         // transform the point
                                         transform_->transform(x, y, size_t(z), ix_source, iy_source, iz_source);
 
-                                        // interpolate the source
-                                        warped( x+offset ) = (*interp_)(ix_source, iy_source, iz_source);
+                                        xs[num] = ix_source;
+                                        ys[num] = iy_source;
+                                        zs[num] = iz_source;
+                                        ind[num++] = x+offset;
                                     }
                                 }
+
+                                // interpolate the source for all warped pixels of this row
+                                interp_->interpolate(num, &xs[0], &ys[0], &zs[0], &vals[0]);
+                                for ( size_t n=0; n<num; n++ ) warped( ind[n] ) = vals[n];
                             }
                         }
                     }
@@ -398,9 +443,15 @@ namespace Gadgetron {
                 {
                     coord_type px, py, dx, dy, ix_source, iy_source;
 
+                    std::vector<interp_coord_type> xs(sx), ys(sx);
+                    std::vector<ValueType> vals(sx);
+                    std::vector<size_t> ind(sx);
+
                     // #pragma omp for 
                     for ( y=0; y<(long long)sy; y++ )
                     {
+                        size_t num = 0;
+
                         for ( size_t x=0; x<sx; x++ )
                         {
                             size_t offset = x + y*sx;
@@ -416,10 +467,15 @@ namespace Gadgetron {
                                 // world to source
                                 source.world_to_image(px+dx, py+dy, ix_source, iy_source);
 
-                                // interpolate the source
-                                warped( offset ) = (*interp_)(ix_source, iy_source);
+                                xs[num] = ix_source;
+                                ys[num] = iy_source;
+                                ind[num++] = offset;
                             }
                         }
+
+                        // interpolate the source for all warped pixels of this row
+                        interp_->interpolate(num, &xs[0], &ys[0], &vals[0]);
+                        for ( size_t n=0; n<num; n++ ) warped( ind[n] ) = vals[n];
                     }
                 }
             }
@@ -435,12 +491,17 @@ namespace Gadgetron {
                 {
                     coord_type px, py, pz, dx, dy, dz, ix_source, iy_source, iz_source;
 
+                    std::vector<interp_coord_type> xs(sx), ys(sx), zs(sx);
+                    std::vector<ValueType> vals(sx);
+                    std::vector<size_t> ind(sx);
+
                     #pragma omp for 
                     for ( z=0; z<(long long)sz; z++ )
                     {
                         for ( size_t y=0; y<sy; y++ )
                         {
                             size_t offset = y*sx + z*sx*sy;
+                            size_t num = 0;
 
                             for ( size_t x=0; x<sx; x++ )
                             {
@@ -455,10 +516,16 @@ namespace Gadgetron {
                                     // world to source
                                     source.world_to_image(px+dx, py+dy, pz+dz, ix_source, iy_source, iz_source);
 
-                                    // interpolate the source
-                                    warped( x+offset ) = (*interp_)(ix_source, iy_source, iz_source);
+                                    xs[num] = ix_source;
+                                    ys[num] = iy_source;
+                                    zs[num] = iz_source;
+                                    ind[num++] = x+offset;
                                 }
                             }
+
+                            // interpolate the source for all warped pixels of this row
+                            interp_->interpolate(num, &xs[0], &ys[0], &zs[0], &vals[0]);
+                            for ( size_t n=0; n<num; n++ ) warped( ind[n] ) = vals[n];
                         }
                     }
                 }